@@ -3,6 +3,8 @@
 #include <climits>
 #include <cstdlib>
 #include <filesystem>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <sys/stat.h>
 
@@ -34,13 +36,33 @@ std::filesystem::path detectHomepath () {
     return path;
 }
 
-std::filesystem::path Steam::FileSystem::workshopDirectory (int appID, const std::string& contentID) {
-    auto homepath = detectHomepath ();
+/**
+ * @return The workshop folders of the app that exist, looked up once per app so big playlists only check the items
+ */
+const std::vector<std::filesystem::path>& workshopRoots (int appID) {
+    static std::mutex mutex;
+    static std::map<int, std::vector<std::filesystem::path>> roots;
 
-    for (const auto& current : workshopDirectoryPaths) {
-        auto currentpath = std::filesystem::path (homepath) / current / std::to_string (appID) / contentID;
+    std::scoped_lock lock (mutex);
 
-        if (!std::filesystem::exists (currentpath) || !std::filesystem::is_directory (currentpath))
+    if (const auto it = roots.find (appID); it != roots.end ())
+        return it->second;
+
+    const auto homepath = detectHomepath ();
+    auto& result = roots [appID];
+
+    for (const auto& current : workshopDirectoryPaths)
+        if (auto root = homepath / current / std::to_string (appID); std::filesystem::is_directory (root))
+            result.push_back (std::move (root));
+
+    return result;
+}
+
+std::filesystem::path Steam::FileSystem::workshopDirectory (int appID, const std::string& contentID) {
+    for (const auto& root : workshopRoots (appID)) {
+        auto currentpath = root / contentID;
+
+        if (!std::filesystem::is_directory (currentpath))
             continue;
 
         return currentpath;
@@ -379,9 +379,26 @@ void ApplicationContext::loadSettingsFromArgv () {
     auto& performanceGroup = program.add_group ("Performance options");
 
         performanceGroup.add_argument ("-f", "--fps")
-            .help ("Limits the FPS to the given number, useful to keep battery consumption low")
-            .default_value (30)
-            .store_into(this->settings.render.maximumFPS);
+            .help ("Limits the FPS to the given number, useful to keep battery consumption low. After --screen-root it only applies to that screen on Wayland, other outputs use the last value given")
+            .action ([this, &lastScreen](const std::string& value) -> void {
+                const int fps = static_cast<int> (strtol (value.c_str (), nullptr, 10));
+
+                if (fps <= 0) {
+                    sLog.exception ("Invalid FPS limit: ", value);
+                }
+
+                this->settings.render.maximumFPS = fps;
+
+                if (!lastScreen.empty ()) {
+                    this->settings.general.screenFPS [lastScreen] = fps;
+                }
+            })
+            .append ();
+
+        performanceGroup.add_argument ("--adaptive-fps")
+            .help ("Measures how fast every wallpaper's image changes and renders slow ones at fewer FPS, down to 10, with --fps as the limit")
+            .flag ()
+            .store_into (this->settings.render.adaptiveFPS);
 
         performanceGroup.add_argument ("--no-fullscreen-pause")
             .help ("Prevents the background pausing when an app is fullscreen")
@@ -390,6 +407,13 @@ void ApplicationContext::loadSettingsFromArgv () {
                 this->settings.render.pauseOnFullscreen = false;
             });
 
+        performanceGroup.add_argument ("--no-maximized-pause")
+            .help ("Keeps rendering screens covered by maximized windows, for setups with transparent windows")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.render.pauseOnMaximized = false;
+            });
+
         performanceGroup.add_argument ("--fullscreen-pause-only-active")
             .help ("Wayland only: pause only when a fullscreen window is active (activated)")
             .flag ()
@@ -406,6 +430,109 @@ void ApplicationContext::loadSettingsFromArgv () {
             })
             .append ();
 
+        performanceGroup.add_argument ("--gpu-particles")
+            .help ("Simulates particle systems on the GPU when all their operators support it")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.render.gpuParticles = true;
+            });
+
+        performanceGroup.add_argument ("--particle-seed")
+            .help ("Seeds the particle systems with the given number so every run looks the same")
+            .action ([this](const std::string& value) -> void {
+                this->settings.render.particleSeed = std::stoull (value);
+            });
+
+        performanceGroup.add_argument ("--particle-rate")
+            .help ("Simulates particles at a fixed rate in Hz regardless of the FPS, 0 simulates once per frame")
+            .default_value <uint32_t> (60)
+            .store_into (this->settings.render.particleRate);
+
+        performanceGroup.add_argument ("--particle-depth-sort")
+            .help ("Draws the particles of translucent systems back to front instead of in the order they were spawned, "
+                   "for 3D scenes where they overlap the wrong way around")
+            .flag ()
+            .store_into (this->settings.render.particleDepthSort);
+
+        performanceGroup.add_argument ("--render-scale")
+            .help ("Renders scenes at the given fraction of their size (0.25 to 2), auto matches the biggest screen")
+            .action ([this](const std::string& value) -> void {
+                if (value == "auto") {
+                    this->settings.render.renderScale = 0.0f;
+                    return;
+                }
+
+                const float scale = std::stof (value);
+
+                if (scale < 0.25f || scale > 2.0f)
+                    sLog.exception ("Render scale must be between 0.25 and 2, or auto");
+
+                this->settings.render.renderScale = scale;
+            });
+
+        performanceGroup.add_argument ("--accelerated-web-paint")
+            .help ("Lets Chromium paint web backgrounds on the GPU and imports the frames without copying them through "
+                   "the CPU, needs an EGL context (Wayland) with EGL_EXT_image_dma_buf_import")
+            .flag ()
+            .store_into (this->settings.render.acceleratedWebPaint);
+
+        performanceGroup.add_argument ("--gpu")
+            .help ("GPU to render on for hybrid graphics machines: intel, amd, nvidia or a device node like "
+                   "/dev/dri/renderD128 or /dev/dri/card1")
+            .default_value (std::string (""))
+            .store_into (this->settings.render.gpu);
+
+        performanceGroup.add_argument ("--x11-output")
+            .help ("How backgrounds reach the screen on X11: window draws into a desktop window, root copies every "
+                   "frame into the root window's pixmap through the CPU, auto uses window when a compositor is running")
+            .choices ("auto", "window", "root")
+            .default_value (std::string ("auto"))
+            .store_into (this->settings.render.x11Output);
+
+        performanceGroup.add_argument ("--web-pause")
+            .help ("What web backgrounds do while paused: suspend stops their scripts and painting, tick keeps them "
+                   "running at 1 FPS")
+            .choices ("suspend", "tick")
+            .default_value (std::string ("tick"))
+            .action ([this](const std::string& value) -> void {
+                this->settings.render.suspendPausedWeb = value == "suspend";
+            });
+
+        performanceGroup.add_argument ("--hwdec")
+            .help ("Hardware decoding mode mpv uses for video backgrounds (auto, vaapi, nvdec, no...), the default "
+                   "prefers decoders whose frames are shown without copying them back to the CPU")
+            .default_value (std::string ("auto"))
+            .store_into (this->settings.render.hwdec);
+
+        performanceGroup.add_argument ("--video-size")
+            .help ("Size video backgrounds render at: screen renders them no bigger than the biggest screen showing "
+                   "them, native at the video's own size")
+            .choices ("screen", "native")
+            .default_value (std::string ("screen"))
+            .action ([this](const std::string& value) -> void {
+                this->settings.render.nativeVideoSize = value == "native";
+            });
+
+        performanceGroup.add_argument ("--video-downscale")
+            .help ("Scales decoded video frames down to the size they're rendered at right after decoding (on the GPU "
+                   "with vaapi and nvdec), saves video memory and bandwidth on videos bigger than the screen")
+            .flag ()
+            .store_into (this->settings.render.downscaleVideo);
+
+        performanceGroup.add_argument ("--video-unload-after")
+            .help ("Seconds a video background stays paused before it's unloaded to free its decoder and video "
+                   "memory, it resumes at the same position. 0 keeps it loaded")
+            .default_value (60)
+            .store_into (this->settings.render.videoUnloadDelay);
+
+        performanceGroup.add_argument ("--worker-priority")
+            .help ("Priority of the threads that load backgrounds, decode textures and translate shaders: low runs "
+                   "them at nice 10 with the lowest I/O priority, idle only when nothing else needs the CPU or disk. "
+                   "The render thread keeps the process' own")
+            .choices ("normal", "low", "idle")
+            .default_value (std::string ("normal"))
+            .store_into (this->settings.render.workerPriority);
+
     auto& audioGroup = program.add_group ("Sound settings");
     auto& audioSettingsGroup = audioGroup.add_mutually_exclusive_group (false);
 
@@ -435,6 +562,40 @@ void ApplicationContext::loadSettingsFromArgv () {
                 this->settings.audio.audioprocessing = false;
             });
 
+        audioGroup.add_argument ("--audio-capture")
+            .help ("Where audio processing captures what's playing from: pulseaudio, or pipewire to read the buffers "
+                   "straight from PipeWire at a lower latency (if built with PipeWire support)")
+            .choices ("pulseaudio", "pipewire")
+            .default_value (std::string ("pulseaudio"))
+            .action ([this](const std::string& value) -> void {
+                this->settings.audio.pipewireCapture = value == "pipewire";
+            });
+
+        audioGroup.add_argument ("--audio-cache")
+            .help ("Sounds up to this many seconds long are decoded once when loaded and shared by everything playing "
+                   "them instead of being streamed. 0 streams every sound")
+            .default_value (10)
+            .store_into (this->settings.audio.cacheSeconds);
+
+        audioGroup.add_argument ("--audio-resampler")
+            .help ("How sounds are converted to the output's sample rate: fast uses linear interpolation, soxr is the "
+                   "highest quality (if ffmpeg was built with it). Cached sounds are only ever converted once")
+            .choices ("fast", "default", "soxr")
+            .default_value (std::string ("default"))
+            .store_into (this->settings.audio.resampler);
+
+        audioGroup.add_argument ("--audio-buffer")
+            .help ("Sample frames mixed per audio callback, smaller buffers cut the latency but underrun sooner. "
+                   "--stats-socket reports the underruns")
+            .default_value (4096)
+            .store_into (this->settings.audio.bufferSize);
+
+        audioGroup.add_argument ("--audio-realtime")
+            .help ("Runs the audio mixing thread with real-time priority (SCHED_FIFO, or through rtkit when not "
+                   "allowed to), so small buffers don't underrun when the system is busy")
+            .flag ()
+            .store_into (this->settings.audio.realtime);
+
     auto& screenshotGroup = program.add_group ("Screenshot options");
 
         screenshotGroup.add_argument ("--screenshot")
@@ -450,6 +611,50 @@ void ApplicationContext::loadSettingsFromArgv () {
             .default_value <uint32_t> (5)
             .store_into (this->settings.screenshot.delay);
 
+        screenshotGroup.add_argument ("--previews")
+            .help ("Renders a preview image of every background listed in the given file, one id or path per line, "
+                   "all of them in one process without showing anything")
+            .action ([this](const std::string& value) -> void {
+                std::ifstream list (value);
+
+                if (!list.is_open ())
+                    sLog.exception ("Cannot open the preview list ", value);
+
+                for (std::string line; std::getline (list, line);) {
+                    // trailing spaces and carriage returns from lists written on other systems
+                    line.erase (line.find_last_not_of (" \t\r") + 1);
+
+                    if (!line.empty ())
+                        this->settings.screenshot.previews.push_back (translateBackground (line));
+                }
+
+                if (this->settings.screenshot.previews.empty ())
+                    sLog.exception ("The preview list ", value, " has no backgrounds");
+            });
+
+        screenshotGroup.add_argument ("--preview-dir")
+            .help ("Folder the preview images are written to, named after the background's folder")
+            .default_value (".")
+            .action ([this](const std::string& value) -> void {
+                this->settings.screenshot.previewDirectory = value;
+            });
+
+        screenshotGroup.add_argument ("--preview-size")
+            .help ("Width of the preview images in pixels, the height keeps the background's aspect ratio")
+            .default_value <uint32_t> (512)
+            .store_into (this->settings.screenshot.previewWidth);
+
+        screenshotGroup.add_argument ("--preview-time")
+            .help ("Seconds every background is simulated for at a fixed timestep before its preview is taken")
+            .action ([this](const std::string& value) -> void {
+                const float time = std::stof (value);
+
+                if (time < 0.0f)
+                    sLog.exception ("Preview time cannot be negative");
+
+                this->settings.screenshot.previewTime = time;
+            });
+
     auto& contentGroup = program.add_group ("Content options");
 
         contentGroup.add_argument ("--assets-dir")
@@ -468,6 +673,112 @@ void ApplicationContext::loadSettingsFromArgv () {
                 this->settings.general.disableParticles = true;
             });
 
+        configurationGroup.add_argument ("--particle-budget")
+            .help ("Maximum particles alive at once, systems emit less when the background goes over it")
+            .default_value <uint32_t> (0)
+            .store_into (this->settings.general.particleBudget);
+
+        configurationGroup.add_argument ("--particle-time-budget")
+            .help ("Maximum microseconds spent simulating particles every frame, systems emit less when it's exceeded")
+            .default_value <uint32_t> (0)
+            .store_into (this->settings.general.particleTimeBudget);
+
+        configurationGroup.add_argument ("--particle-prewarm")
+            .help ("Simulates the particle systems for the given seconds while loading so they don't start empty")
+            .default_value <uint32_t> (0)
+            .store_into (this->settings.general.particlePrewarm);
+
+        configurationGroup.add_argument ("--particle-cache")
+            .help ("Stores the pre-warmed particles on disk so later launches restore them instead of simulating again")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.general.particleCache = true;
+            });
+
+        configurationGroup.add_argument ("--no-shader-cache")
+            .help ("Builds every shader from scratch instead of reusing the ones stored on disk by previous launches")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.general.shaderCache = false;
+            });
+
+        configurationGroup.add_argument ("--no-json-cache")
+            .help ("Parses every scene, material and effect file from scratch instead of reusing the parsed copies stored on disk by previous launches")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.general.jsonCache = false;
+            });
+
+        configurationGroup.add_argument ("--spirv")
+            .help ("Hands shaders the driver can't compile as they are to it as SPIR-V (GL_ARB_gl_spirv) instead of translating them back to GLSL")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.general.spirv = true;
+            });
+
+        configurationGroup.add_argument ("--no-shader-optimization")
+            .help ("Translates shaders the driver can't compile as they are back to GLSL without running SPIRV-Tools' optimizer on them first")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.general.optimizeShaders = false;
+            });
+
+        configurationGroup.add_argument ("--compress-textures")
+            .help ("Compresses large uncompressed textures to BC7 (or DXT5) on first use and keeps them on disk, cutting their video memory use to a quarter")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.general.textureCompression = true;
+            });
+
+        configurationGroup.add_argument ("--cook")
+            .help ("Loads the backgrounds offscreen once, storing their parsed files, built shaders and (with --compress-textures) "
+                   "compressed textures on disk so later launches only read and upload them, then exits")
+            .flag ()
+            .store_into (this->settings.general.cook);
+
+        configurationGroup.add_argument ("--repack")
+            .help ("Like --cook, then writes the backgrounds' scene.pkg again with their files in the order the load "
+                   "read them, each starting at a page, so later loads read it front to back")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.general.cook = true;
+                this->settings.general.repack = true;
+            });
+
+        configurationGroup.add_argument ("--texture-budget")
+            .help ("Megabytes of video memory cached textures can take before the ones no background uses are evicted, 0 evicts them right away")
+            .default_value <uint32_t> (256)
+            .store_into (this->settings.general.textureBudget);
+
+        configurationGroup.add_argument ("--texture-max-size")
+            .help ("Largest side in pixels a texture may take in video memory, bigger ones use their first mipmap that fits "
+                   "or are scaled down when loaded. 0 only scales down the ones over what the GPU can take")
+            .default_value <uint32_t> (0)
+            .store_into (this->settings.general.textureMaxSize);
+
+        configurationGroup.add_argument ("--shared-assets")
+            .help ("Maps the files in the assets folder instead of reading them, so every instance running shares the same copy in memory")
+            .flag ()
+            .action ([this](const std::string& value) -> void {
+                this->settings.general.sharedAssets = true;
+            });
+
+        configurationGroup.add_argument ("--warm-browser")
+            .help ("Starts the browser right away when a playlist or the preview list has web backgrounds, so switching to one doesn't wait for it")
+            .flag ()
+            .store_into (this->settings.general.warmBrowser);
+
+        configurationGroup.add_argument ("--power-profiles")
+            .help ("Lowers the FPS, render scale, particle budget and bloom while on battery or running hot, and "
+                   "goes back once plugged in and cool again")
+            .flag ()
+            .store_into (this->settings.general.powerProfiles);
+
+        configurationGroup.add_argument ("--power-pause-video")
+            .help ("Pauses video and web backgrounds too while --power-profiles lowers the render settings")
+            .flag ()
+            .store_into (this->settings.general.powerPauseVideo);
+
         configurationGroup.add_argument ("--disable-mouse")
             .help ("Disables mouse interaction with the backgrounds")
             .flag ()
@@ -482,7 +793,8 @@ void ApplicationContext::loadSettingsFromArgv () {
             });
 
         configurationGroup.add_argument ("-l", "--list-properties")
-            .help ("List all the available properties and their configuration")
+            .help ("List all the available properties and their configuration and exit, together with --dump-structure "
+                   "also prints the structure without rendering anything")
             .flag ()
             .store_into (this->settings.general.onlyListProperties);
 
@@ -499,12 +811,71 @@ void ApplicationContext::loadSettingsFromArgv () {
             })
             .append ();
 
+        configurationGroup.add_argument ("--control-socket")
+            .help ("Takes commands while running on the given unix socket, one per line: name=value like "
+                   "--set-property, wallpaper <screen> <path>, pause, resume or stats")
+            .action ([this] (const std::string& value) -> void { this->settings.general.controlSocket = value; });
+
     auto& debuggingGroup = program.add_group ("Debugging options");
 
         debuggingGroup.add_argument ("-z", "--dump-structure")
-            .help ("Dumps the structure of the backgrounds")
+            .help ("Dumps the structure of the backgrounds, and the video memory they take once loaded")
             .flag ()
             .store_into (this->settings.general.dumpStructure);
+        debuggingGroup.add_argument ("--profile")
+            .help ("Measures the GPU time and draws of every object and logs them every few seconds")
+            .flag ()
+            .store_into (this->settings.general.profile);
+        debuggingGroup.add_argument ("--profile-alloc")
+            .help ("Counts the heap allocations the render thread does per frame and logs where the most come from "
+                   "every few seconds")
+            .flag ()
+            .store_into (this->settings.general.profileAllocations);
+        debuggingGroup.add_argument ("--load-report")
+            .help ("Logs the time, count and bytes of every stage of loading the backgrounds once they are ready, "
+                   "from parsing their JSON to compiling shaders and uploading textures")
+            .flag ()
+            .store_into (this->settings.general.loadReport);
+        debuggingGroup.add_argument ("--benchmark")
+            .help ("Renders the given number of frames offscreen as fast as possible at a fixed timestep of 1/fps "
+                   "seconds, then prints the load time, frame times and memory use as JSON")
+            .default_value <uint32_t> (0)
+            .store_into (this->settings.general.benchmarkFrames);
+        debuggingGroup.add_argument ("--stats-socket")
+            .help ("Serves the FPS, frame times, draws, particles and video memory of the last second as JSON on the "
+                   "given unix socket, every connection gets one line")
+            .action ([this] (const std::string& value) -> void { this->settings.general.statsSocket = value; });
+        debuggingGroup.add_argument ("--metrics")
+            .help ("Serves the frame times, GPU time, memory, particles, load times and pause state in the "
+                   "OpenMetrics format over HTTP on the given port, or address:port, for Prometheus to scrape")
+            .action ([this] (const std::string& value) -> void { this->settings.general.metrics = value; });
+        debuggingGroup.add_argument ("--record-input")
+            .help ("Records the time, mouse, audio spectrum and property changes of every frame and the random seeds "
+                   "to the given file, so the same run can be played back with --replay-input")
+            .action ([this] (const std::string& value) -> void { this->settings.general.recordInput = value; });
+        debuggingGroup.add_argument ("--replay-input")
+            .help ("Plays back a recording made with --record-input instead of the real clock, mouse and audio, "
+                   "and stops once it's over. Use it with --benchmark or --trace to compare builds like-for-like")
+            .action ([this] (const std::string& value) -> void { this->settings.general.replayInput = value; });
+        debuggingGroup.add_argument ("--watch")
+            .help ("Reloads a background whenever the files in its folder change, reusing the shaders and textures "
+                   "that didn't, for authoring backgrounds")
+            .flag ()
+            .store_into (this->settings.general.watch);
+#if TRACING
+        debuggingGroup.add_argument ("--trace")
+            .help ("Records the time spent on every part of the frame and writes it to the given file when closing, "
+                   "it can be opened with chrome://tracing or ui.perfetto.dev")
+            .action ([this] (const std::string& value) -> void { this->settings.general.trace = value; });
+        debuggingGroup.add_argument ("--hitch-traces")
+            .help ("Keeps the last seconds of tracing in memory and writes them to a file in the given folder every "
+                   "time a frame takes longer than --hitch-threshold")
+            .action ([this] (const std::string& value) -> void { this->settings.general.hitchTraces = value; });
+        debuggingGroup.add_argument ("--hitch-threshold")
+            .help ("Milliseconds a frame has to take to be written out by --hitch-traces")
+            .default_value <uint32_t> (150)
+            .store_into (this->settings.general.hitchThreshold);
+#endif /* TRACING */
 
     program.add_epilog (
         "Usage examples:\n"
@@ -521,6 +892,10 @@ void ApplicationContext::loadSettingsFromArgv () {
     try {
         program.parse_known_args (this->m_argc, this->m_argv);
 
+        // the first background of the batch is loaded like any other, the rest follow as the previews are taken
+        if (!this->settings.screenshot.previews.empty ())
+            this->settings.general.defaultBackground = this->settings.screenshot.previews.front ();
+
         if (this->settings.general.defaultBackground.empty ()) {
             throw std::runtime_error ("At least one background ID must be specified");
         }
@@ -550,6 +925,53 @@ void ApplicationContext::loadSettingsFromArgv () {
         this->state.audio.volume = this->settings.audio.volume;
         this->state.mouse.enabled = this->settings.mouse.enabled;
 
+        if (this->settings.general.benchmarkFrames > 0) {
+            if (this->settings.render.mode == DESKTOP_BACKGROUND)
+                sLog.exception ("Benchmarks render offscreen and cannot be used with --screen-root");
+
+            // nothing on the desktop should change what's measured
+            this->settings.render.pauseOnFullscreen = false;
+            this->settings.screenshot.take = false;
+        }
+
+        if (this->settings.general.cook) {
+            if (this->settings.render.mode == DESKTOP_BACKGROUND)
+                sLog.exception ("Cooking renders offscreen and cannot be used with --screen-root");
+            if (this->settings.general.benchmarkFrames > 0 || !this->settings.screenshot.previews.empty ())
+                sLog.exception ("Cooking cannot run together with benchmarks or previews");
+
+            // the caches are what's left of the run, nothing can be seen or heard
+            this->settings.general.shaderCache = true;
+            this->settings.general.jsonCache = true;
+            this->settings.render.pauseOnFullscreen = false;
+            this->settings.screenshot.take = false;
+            this->state.audio.enabled = false;
+        }
+
+        if (!this->settings.screenshot.previews.empty ()) {
+            if (this->settings.render.mode == DESKTOP_BACKGROUND)
+                sLog.exception ("Previews render offscreen and cannot be used with --screen-root");
+            if (this->settings.general.benchmarkFrames > 0)
+                sLog.exception ("Previews and benchmarks cannot run at the same time");
+            if (this->settings.screenshot.previewWidth == 0)
+                sLog.exception ("Preview size must be at least one pixel");
+
+            // nothing can be seen or heard, and every background of the batch gets its own image
+            this->settings.render.pauseOnFullscreen = false;
+            this->settings.screenshot.take = false;
+            this->settings.general.defaultPlaylist = std::nullopt;
+            this->state.audio.enabled = false;
+
+            std::filesystem::create_directories (this->settings.screenshot.previewDirectory);
+        }
+
+        if (!this->settings.general.hitchTraces.empty ()) {
+            if (this->settings.general.hitchThreshold == 0)
+                sLog.exception ("Hitch threshold must be at least one millisecond");
+
+            std::filesystem::create_directories (this->settings.general.hitchTraces);
+        }
+
 #if DEMOMODE
         sLog.error ("WARNING: RUNNING IN DEMO MODE WILL STOP WALLPAPERS AFTER 5 SECONDS SO VIDEO CAN BE RECORDED");
         // special settings for demomode
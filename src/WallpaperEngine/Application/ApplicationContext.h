@@ -63,8 +63,66 @@ class ApplicationContext {
             bool onlyListProperties;
             /** If the user requested a dump of the background structure */
             bool dumpStructure;
+            /** If the GPU time of every object should be measured and logged */
+            bool profile;
+            /** If the render thread's heap allocations per frame and their call sites should be logged */
+            bool profileAllocations;
+            /** If the time spent on every stage of loading the backgrounds should be logged once they are ready */
+            bool loadReport;
+            /** Where the CPU trace is written to, empty if it shouldn't be recorded. Only used with TRACING builds */
+            std::filesystem::path trace;
+            /** Folder the traces around hitches are written to, empty to not look for them. Only used with TRACING builds */
+            std::filesystem::path hitchTraces;
+            /** Milliseconds a frame has to take to count as a hitch */
+            uint32_t hitchThreshold;
+            /** Frames to render offscreen and time with --benchmark, 0 to run normally */
+            uint32_t benchmarkFrames;
+            /** Unix socket the frame stats are served on, empty if they shouldn't be counted */
+            std::filesystem::path statsSocket;
+            /** Port, optionally after an IPv4 address, the OpenMetrics endpoint listens on, empty to not serve it */
+            std::string metrics;
+            /** Where the inputs of every frame are recorded to with --record-input, empty if they shouldn't be */
+            std::filesystem::path recordInput;
+            /** Recording the inputs of every frame are replayed from with --replay-input, empty to run normally */
+            std::filesystem::path replayInput;
+            /** If the backgrounds shown are reloaded whenever the files in their folders change */
+            bool watch;
             /** If the user requested the particles to be deactivated */
             bool disableParticles;
+            /** Maximum particles alive across all the particle systems of a background, 0 for no limit */
+            uint32_t particleBudget;
+            /** Maximum microseconds spent simulating particles every frame, 0 for no limit */
+            uint32_t particleTimeBudget;
+            /** Seconds the particle systems are simulated for while the background loads, 0 to start them empty */
+            uint32_t particlePrewarm;
+            /** If the pre-warmed particle state should be stored on disk and restored on later launches */
+            bool particleCache;
+            /** If built shader programs should be stored on disk so later launches skip translating and linking them */
+            bool shaderCache;
+            /** If big scene, material and effect files should be stored parsed on disk so later launches skip parsing them */
+            bool jsonCache;
+            /** If shaders the driver can't compile as they are should be given to it as SPIR-V when supported */
+            bool spirv;
+            /** If shaders translated back to GLSL should be optimized on the way, when built with SPIRV-Tools */
+            bool optimizeShaders;
+            /** If large RGBA8 textures should be compressed by the driver and kept compressed on disk for later launches */
+            bool textureCompression;
+            /** If the backgrounds should only be loaded offscreen to fill the on-disk caches, then exit */
+            bool cook;
+            /** If the packages of the backgrounds should be written again in the order a load reads them, implies cook */
+            bool repack;
+            /** Megabytes of video memory textures no background uses anymore can keep before being evicted */
+            uint32_t textureBudget;
+            /** Largest side a texture may take in video memory, bigger ones are scaled down. 0 for the GPU's limit */
+            uint32_t textureMaxSize;
+            /** If files in the assets folder should be mapped instead of read, sharing their memory with other instances */
+            bool sharedAssets;
+            /** If the browser should be started with the app when a playlist or preview list has web backgrounds */
+            bool warmBrowser;
+            /** If the render settings should be lowered while on battery or running hot */
+            bool powerProfiles;
+            /** If video and web backgrounds should be paused too while the render settings are lowered */
+            bool powerPauseVideo;
             /** The path to the assets folder */
             std::filesystem::path assets;
             /** Background to load (provided as the final argument) as fallback for multi-screen setups */
@@ -73,10 +131,14 @@ class ApplicationContext {
             std::map<std::string, std::filesystem::path> screenBackgrounds;
             /** Properties to change values for */
             std::map<std::string, std::string> properties;
+            /** Unix socket property changes are taken on while running, empty if they shouldn't be */
+            std::filesystem::path controlSocket;
             /** The scaling mode for different screens */
             std::map<std::string, WallpaperEngine::Render::WallpaperState::TextureUVsScaling> screenScalings;
             /** The clamping mode for different screens */
             std::map<std::string, TextureFlags> screenClamps;
+            /** FPS limit for different screens, the ones without one use render.maximumFPS */
+            std::map<std::string, int> screenFPS;
             /** Playlists selected per screen */
             std::map<std::string, PlaylistDefinition> screenPlaylists;
             /** Playlist used in window mode */
@@ -91,8 +153,12 @@ class ApplicationContext {
             WINDOW_MODE mode;
             /** Maximum FPS */
             int maximumFPS;
+            /** If wallpapers whose image changes slowly should render fewer frames than maximumFPS */
+            bool adaptiveFPS;
             /** Indicates if pausing should happen when something goes fullscreen */
             bool pauseOnFullscreen;
+            /** Indicates if screens covered by maximized windows stop rendering too */
+            bool pauseOnMaximized;
             /**
              * Wayland-only: if true, only consider fullscreen toplevels that are also activated.
              * Useful for compositors with "virtual" fullscreen windows (e.g. scrollable tiling).
@@ -103,6 +169,34 @@ class ApplicationContext {
              * Example: "firefox" will match "org.mozilla.firefox".
              */
             std::vector<std::string> fullscreenPauseIgnoreAppIds;
+            /** If particle systems should be simulated on the GPU when they support it */
+            bool gpuParticles;
+            /** Seed for every particle system's random generator, random on every run if not set */
+            std::optional<uint64_t> particleSeed;
+            /** Fixed rate particles are simulated at (in Hz), 0 steps them once per rendered frame */
+            uint32_t particleRate;
+            /** If translucent particles are drawn back to front instead of in the order they were spawned */
+            bool particleDepthSort;
+            /** Size scenes render at relative to their authored size, 0 matches the biggest screen */
+            float renderScale;
+            /** If web backgrounds should have Chromium paint on the GPU and hand over their frames as dmabufs */
+            bool acceleratedWebPaint;
+            /** If paused web backgrounds are hidden from Chromium entirely instead of ticking at 1 FPS */
+            bool suspendPausedWeb;
+            /** GPU to render on, a vendor (intel, amd or nvidia) or a /dev/dri node, empty uses the system's default */
+            std::string gpu;
+            /** How X11 backgrounds reach the screen: window, root or auto to pick window under a compositor */
+            std::string x11Output;
+            /** mpv's hwdec mode for video backgrounds */
+            std::string hwdec;
+            /** If videos render at their own size instead of only as big as the biggest screen showing them */
+            bool nativeVideoSize;
+            /** If decoded video frames are scaled down to the render size by mpv's filters, before rendering */
+            bool downscaleVideo;
+            /** Seconds a video has to stay paused before its file is unloaded to free the decoder, 0 never does */
+            int videoUnloadDelay;
+            /** How the loader threads are scheduled against other programs: normal, low or idle */
+            std::string workerPriority;
 
             struct {
                 /** The window size used in explicit window */
@@ -124,6 +218,16 @@ class ApplicationContext {
             bool automute;
             /** If audio processing can be enabled or not */
             bool audioprocessing;
+            /** Capture the audio processing reads from PipeWire directly instead of through PulseAudio */
+            bool pipewireCapture;
+            /** Sounds up to this many seconds long are decoded once and kept in memory, 0 streams everything */
+            int cacheSeconds;
+            /** Resampler quality: fast (linear interpolation), default (ffmpeg's own) or soxr */
+            std::string resampler;
+            /** Sample frames the device is asked to play per callback, smaller means less latency */
+            int bufferSize;
+            /** Asks for real-time scheduling (SCHED_FIFO, through rtkit if needed) for the mixing thread */
+            bool realtime;
         } audio;
 
         /**
@@ -146,26 +250,81 @@ class ApplicationContext {
             uint32_t delay;
             /** The path to where the screenshot must be saved */
             std::filesystem::path path;
+            /** Backgrounds to render a preview image of one after another with --previews, empty to run normally */
+            std::vector<std::filesystem::path> previews;
+            /** The folder the preview images are written to */
+            std::filesystem::path previewDirectory;
+            /** Width of the preview images, the height follows the background's aspect ratio */
+            uint32_t previewWidth;
+            /** Seconds every background is simulated for before its preview is taken */
+            float previewTime;
         } screenshot;
     } settings = {
         .general = {
             .onlyListProperties = false,
             .dumpStructure = false,
+            .profile = false,
+            .profileAllocations = false,
+            .loadReport = false,
+            .trace = "",
+            .hitchTraces = "",
+            .hitchThreshold = 150,
+            .benchmarkFrames = 0,
+            .statsSocket = "",
+            .metrics = "",
+            .recordInput = "",
+            .replayInput = "",
+            .watch = false,
+            .particleBudget = 0,
+            .particleTimeBudget = 0,
+            .particlePrewarm = 0,
+            .particleCache = false,
+            .shaderCache = true,
+            .jsonCache = true,
+            .spirv = false,
+            .optimizeShaders = true,
+            .textureCompression = false,
+            .cook = false,
+            .repack = false,
+            .textureBudget = 256,
+            .textureMaxSize = 0,
+            .sharedAssets = false,
+            .warmBrowser = false,
+            .powerProfiles = false,
+            .powerPauseVideo = false,
             .assets = "",
             .defaultBackground = "",
             .screenBackgrounds = {},
             .properties = {},
+            .controlSocket = "",
             .screenScalings = {},
             .screenClamps = {},
+            .screenFPS = {},
             .screenPlaylists = {},
             .defaultPlaylist = std::nullopt,
         },
         .render = {
             .mode = NORMAL_WINDOW,
             .maximumFPS = 30,
+            .adaptiveFPS = false,
             .pauseOnFullscreen = true,
+            .pauseOnMaximized = true,
             .pauseOnFullscreenOnlyWhenActive = false,
             .fullscreenPauseIgnoreAppIds = {},
+            .gpuParticles = false,
+            .particleSeed = std::nullopt,
+            .particleRate = 60,
+            .particleDepthSort = false,
+            .renderScale = 1.0f,
+            .acceleratedWebPaint = false,
+            .suspendPausedWeb = false,
+            .gpu = "",
+            .x11Output = "auto",
+            .hwdec = "auto",
+            .nativeVideoSize = false,
+            .downscaleVideo = false,
+            .videoUnloadDelay = 60,
+            .workerPriority = "normal",
             .window = {
                 .geometry = {},
                 .clamp = TextureFlags_ClampUVs,
@@ -177,6 +336,11 @@ class ApplicationContext {
             .volume = 15,
             .automute = true,
             .audioprocessing = true,
+            .pipewireCapture = false,
+            .cacheSeconds = 10,
+            .resampler = "default",
+            .bufferSize = 4096,
+            .realtime = false,
         },
         .mouse = {
             .enabled = true,
@@ -186,6 +350,10 @@ class ApplicationContext {
             .take = false,
             .delay = 5,
             .path = "",
+            .previews = {},
+            .previewDirectory = ".",
+            .previewWidth = 512,
+            .previewTime = 3.0f,
         },
     };
 
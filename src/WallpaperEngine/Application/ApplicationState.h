@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "ApplicationContext.h"
 
 namespace WallpaperEngine::Application {
@@ -20,5 +22,20 @@ class ApplicationState {
     struct {
         bool enabled;
     } mouse {};
+
+    /**
+     * What --power-profiles lowers while on battery or running hot, stays at the defaults otherwise
+     */
+    struct {
+        bool reduced = false;
+        /** what the FPS limits are multiplied by */
+        float fpsScale = 1.0f;
+        /** what the render scale of scenes is multiplied by */
+        float renderScale = 1.0f;
+        /** most particles alive in a background, 0 leaves --particle-budget as is */
+        uint32_t particleBudget = 0;
+        /** most levels the bloom chain goes down, 0 for all of them */
+        uint32_t bloomLevels = 0;
+    } power {};
 };
 } // namespace WallpaperEngine::Application
\ No newline at end of file
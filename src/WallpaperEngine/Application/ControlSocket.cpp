@@ -0,0 +1,213 @@
+#include "ControlSocket.h"
+
+#include <cerrno>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+/** Longest line a client can send, anything longer is dropped along with the connection */
+#define CONTROL_SOCKET_MAX_LINE 4096
+
+using namespace WallpaperEngine::Application;
+
+ControlSocket::ControlSocket (const Render::FrameStats& stats, std::filesystem::path path) :
+    m_stats (stats),
+    m_path (std::move (path)) {}
+
+ControlSocket::~ControlSocket () {
+    this->stop ();
+}
+
+void ControlSocket::start () {
+    if (this->m_socket != -1)
+        return;
+
+    sockaddr_un address = {};
+    const std::string path = this->m_path.string ();
+
+    if (path.size () >= sizeof (address.sun_path)) {
+        sLog.error ("Cannot create the control socket, the path is too long: ", path);
+        return;
+    }
+
+    address.sun_family = AF_UNIX;
+    std::memcpy (address.sun_path, path.c_str (), path.size () + 1);
+
+    // a socket left behind by an instance that didn't close properly
+    unlink (path.c_str ());
+
+    this->m_socket = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (this->m_socket == -1 ||
+        bind (this->m_socket, reinterpret_cast<const sockaddr*> (&address), sizeof (address)) == -1 ||
+        listen (this->m_socket, 4) == -1 || pipe2 (this->m_wakeup, O_CLOEXEC) == -1) {
+        sLog.error ("Cannot create the control socket ", path, ": ", strerror (errno));
+        this->stop ();
+        return;
+    }
+
+    sLog.out ("Taking commands on ", path);
+
+    this->m_thread = std::thread (&ControlSocket::run, this);
+}
+
+void ControlSocket::stop () {
+    if (this->m_thread.joinable ()) {
+        const char wakeup = 0;
+
+        std::ignore = write (this->m_wakeup [1], &wakeup, 1);
+        this->m_thread.join ();
+    }
+
+    for (int& fd : this->m_wakeup) {
+        if (fd != -1)
+            close (fd);
+
+        fd = -1;
+    }
+
+    if (this->m_socket != -1) {
+        close (this->m_socket);
+        unlink (this->m_path.c_str ());
+    }
+
+    this->m_socket = -1;
+}
+
+std::vector<ControlSocket::Command> ControlSocket::takeCommands () {
+    std::lock_guard lock (this->m_commandsMutex);
+
+    return std::exchange (this->m_commands, {});
+}
+
+void ControlSocket::run () {
+    pollfd fds [2] = {
+        {.fd = this->m_socket, .events = POLLIN, .revents = 0},
+        {.fd = this->m_wakeup [0], .events = POLLIN, .revents = 0},
+    };
+
+    while (true) {
+        if (poll (fds, 2, -1) == -1) {
+            if (errno == EINTR)
+                continue;
+
+            sLog.error ("Control socket stopped: ", strerror (errno));
+            return;
+        }
+
+        if (fds [1].revents != 0)
+            return;
+
+        if ((fds [0].revents & POLLIN) == 0)
+            continue;
+
+        const int client = accept4 (this->m_socket, nullptr, nullptr, SOCK_CLOEXEC);
+
+        if (client == -1)
+            continue;
+
+        this->serve (client);
+        close (client);
+    }
+}
+
+void ControlSocket::serve (const int client) {
+    pollfd fds [2] = {
+        {.fd = client, .events = POLLIN, .revents = 0},
+        {.fd = this->m_wakeup [0], .events = POLLIN, .revents = 0},
+    };
+    std::string buffer;
+    char chunk [512];
+
+    while (true) {
+        // stopping doesn't wait for clients that keep the connection open
+        if (poll (fds, 2, -1) == -1) {
+            if (errno == EINTR)
+                continue;
+
+            return;
+        }
+
+        if (fds [1].revents != 0)
+            return;
+
+        const ssize_t received = recv (client, chunk, sizeof (chunk), 0);
+
+        if (received <= 0)
+            break;
+
+        buffer.append (chunk, received);
+
+        std::string::size_type newline;
+
+        while ((newline = buffer.find ('\n')) != std::string::npos) {
+            std::string line = buffer.substr (0, newline);
+
+            buffer.erase (0, newline + 1);
+
+            if (!line.empty () && line.back () == '\r')
+                line.pop_back ();
+
+            if (line.empty ())
+                continue;
+
+            const std::string answer = this->handle (line) + "\n";
+
+            // clients that went away already are no reason to take the whole process down with SIGPIPE
+            std::ignore = send (client, answer.data (), answer.size (), MSG_NOSIGNAL);
+        }
+
+        if (buffer.size () > CONTROL_SOCKET_MAX_LINE) {
+            sLog.error ("Control socket client sent a line that's too long, closing the connection");
+            return;
+        }
+    }
+}
+
+std::string ControlSocket::handle (const std::string& line) {
+    Command command;
+
+    if (line == "stats") {
+        return this->m_stats.getSnapshot ();
+    } else if (line == "pause") {
+        command = {.type = Command::Pause, .name = {}, .value = {}};
+    } else if (line == "resume") {
+        command = {.type = Command::Resume, .name = {}, .value = {}};
+    } else if (line.starts_with ("wallpaper ")) {
+        // the path is everything after the screen, spaces included
+        const std::string::size_type screenStart = line.find_first_not_of (' ', 10);
+        const std::string::size_type screenEnd = line.find (' ', screenStart);
+        const std::string::size_type pathStart =
+            screenEnd == std::string::npos ? std::string::npos : line.find_first_not_of (' ', screenEnd);
+
+        if (pathStart == std::string::npos)
+            return "error: expected wallpaper <screen> <path>";
+
+        command = {
+            .type = Command::SetWallpaper,
+            .name = line.substr (screenStart, screenEnd - screenStart),
+            .value = line.substr (pathStart),
+        };
+    } else if (const std::string::size_type equals = line.find ('='); equals == 0) {
+        return "error: missing property name";
+    } else if (equals == std::string::npos) {
+        // same format as --set-property, properties without value are treated as booleans
+        command = {.type = Command::SetProperty, .name = line, .value = "1"};
+    } else {
+        command = {.type = Command::SetProperty, .name = line.substr (0, equals), .value = line.substr (equals + 1)};
+    }
+
+    std::lock_guard lock (this->m_commandsMutex);
+
+    this->m_commands.push_back (std::move (command));
+
+    return "ok";
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "WallpaperEngine/Render/FrameStats.h"
+
+namespace WallpaperEngine::Application {
+/**
+ * Unix socket that controls the running instance
+ *
+ * Every line a client sends is a command and is answered with `ok` or the reason it was rejected:
+ *  - `name=value` changes a property, the same thing --set-property takes. `name` alone sets it to 1
+ *  - `wallpaper <screen> <path>` switches the screen to another background, `default` in window mode
+ *  - `pause` and `resume` stop and restart rendering
+ *  - `stats` answers with the last FrameStats snapshot as one line of JSON instead of `ok`
+ *
+ * A property named like one of the commands has to be given a value. Commands are only collected here, the render
+ * loop takes them with takeCommands () at the start of a frame and applies them in order, so
+ * `echo bloom=1 | socat - UNIX:<path>` is enough. Clients are served one at a time on a thread of their own, the
+ * render loop never waits for one
+ */
+class ControlSocket {
+  public:
+    struct Command {
+        enum Type {
+            SetProperty = 0,
+            SetWallpaper = 1,
+            Pause = 2,
+            Resume = 3,
+        };
+
+        Type type;
+        /** the property's name, or the screen for SetWallpaper */
+        std::string name;
+        /** the property's value, or the background's path for SetWallpaper */
+        std::string value;
+    };
+
+    /**
+     * @param stats Where the answer to `stats` comes from, it has to outlive the socket
+     * @param path Where the socket is created, anything already there is replaced
+     */
+    ControlSocket (const Render::FrameStats& stats, std::filesystem::path path);
+    ~ControlSocket ();
+
+    ControlSocket (const ControlSocket&) = delete;
+    ControlSocket& operator= (const ControlSocket&) = delete;
+
+    /**
+     * Creates the socket and starts answering connections, logs an error and does nothing if it can't be created
+     */
+    void start ();
+    /**
+     * Stops answering connections and removes the socket
+     */
+    void stop ();
+    /**
+     * @return The commands received since the last call, in the order they came in
+     */
+    [[nodiscard]] std::vector<Command> takeCommands ();
+
+  private:
+    void run ();
+    /**
+     * Reads the client's lines until it closes the connection, answering each one
+     */
+    void serve (int client);
+    /**
+     * Queues the command in the line
+     *
+     * @return The answer for the client
+     */
+    std::string handle (const std::string& line);
+
+    const Render::FrameStats& m_stats;
+    std::filesystem::path m_path;
+    int m_socket = -1;
+    /** written to when stopping, wakes the thread up from poll () */
+    int m_wakeup [2] = {-1, -1};
+    std::thread m_thread;
+    std::mutex m_commandsMutex;
+    std::vector<Command> m_commands;
+};
+} // namespace WallpaperEngine::Application
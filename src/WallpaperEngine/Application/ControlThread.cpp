@@ -0,0 +1,91 @@
+#include "ControlThread.h"
+
+#include <chrono>
+
+using namespace WallpaperEngine::Application;
+
+ControlThread::ControlThread (
+    Render::Drivers::Detectors::FullScreenDetector& detector,
+    Audio::Drivers::Detectors::AudioPlayingDetector& audioDetector, const std::vector<std::string>& screens
+) :
+    m_detector (detector),
+    m_audioDetector (audioDetector) {
+    for (const auto& screen : screens)
+        this->m_visible.try_emplace (screen, true);
+}
+
+ControlThread::~ControlThread () {
+    this->stop ();
+}
+
+void ControlThread::start () {
+    if (this->m_running)
+        return;
+
+    this->check ();
+    this->m_running = true;
+    this->m_thread = std::thread (&ControlThread::run, this);
+}
+
+void ControlThread::stop () {
+    this->m_running = false;
+
+    if (this->m_thread.joinable ())
+        this->m_thread.join ();
+}
+
+bool ControlThread::anythingFullscreen () const {
+    return this->m_anythingFullscreen.load (std::memory_order_relaxed);
+}
+
+bool ControlThread::isVisible (const std::string& screen) const {
+    const auto it = this->m_visible.find (screen);
+
+    if (it == this->m_visible.end ())
+        return !this->anythingFullscreen ();
+
+    return it->second.load (std::memory_order_relaxed);
+}
+
+void ControlThread::waitForChange (const float timeout) {
+    std::unique_lock lock (this->m_mutex);
+    const uint64_t changes = this->m_changes;
+
+    this->m_changed.wait_for (lock, std::chrono::duration<float> (timeout), [this, changes] () {
+        return this->m_changes != changes;
+    });
+}
+
+void ControlThread::run () {
+    while (this->m_running) {
+        // wakes up as soon as windows change, the interval is only a fallback for window servers without events
+        this->m_detector.waitForChange (CHECK_INTERVAL);
+
+        if (!this->check ())
+            continue;
+
+        {
+            std::lock_guard lock (this->m_mutex);
+            this->m_changes++;
+        }
+
+        this->m_changed.notify_all ();
+    }
+}
+
+bool ControlThread::check () {
+    const bool fullscreen = this->m_detector.anythingFullscreen ();
+    bool changed = this->m_anythingFullscreen.exchange (fullscreen, std::memory_order_relaxed) != fullscreen;
+
+    for (auto& [screen, visible] : this->m_visible) {
+        const bool current = this->m_detector.isVisible (screen);
+
+        changed = visible.exchange (current, std::memory_order_relaxed) != current || changed;
+    }
+
+    // the audio detector follows PulseAudio on its own, but it asks the fullscreen detector too, which only happens
+    // on this thread
+    this->m_audioDetector.update ();
+
+    return changed;
+}
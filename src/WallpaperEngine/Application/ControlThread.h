@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "WallpaperEngine/Audio/Drivers/Detectors/AudioPlayingDetector.h"
+#include "WallpaperEngine/Render/Drivers/Detectors/FullScreenDetector.h"
+
+namespace WallpaperEngine::Application {
+/**
+ * Thread that runs the fullscreen and audio detectors away from the render loop
+ *
+ * Asking the window server what's fullscreen means a round-trip to it, which used to delay every frame it happened
+ * on. The detectors are only touched from this thread once it's started, the render thread only reads the answers
+ * of the last check, kept in atomics
+ */
+class ControlThread {
+  public:
+    /**
+     * @param detector
+     * @param audioDetector
+     * @param screens Screens with a background, the visibility of each of them is kept
+     */
+    ControlThread (
+        Render::Drivers::Detectors::FullScreenDetector& detector,
+        Audio::Drivers::Detectors::AudioPlayingDetector& audioDetector, const std::vector<std::string>& screens);
+    ~ControlThread ();
+
+    ControlThread (const ControlThread&) = delete;
+    ControlThread& operator= (const ControlThread&) = delete;
+
+    /**
+     * Runs the first check on the calling thread, so there's an answer for the first frame, and starts the thread
+     */
+    void start ();
+    /**
+     * Stops the thread, the detectors can be used from the calling thread again after this
+     */
+    void stop ();
+    /**
+     * @return If anything was fullscreen on the last check
+     */
+    [[nodiscard]] bool anythingFullscreen () const;
+    /**
+     * @param screen
+     *
+     * @return If the background of the screen could be seen on the last check, screens not given to the constructor
+     *         are visible while nothing is fullscreen
+     */
+    [[nodiscard]] bool isVisible (const std::string& screen) const;
+    /**
+     * Blocks until a check changes what's visible
+     *
+     * @param timeout Maximum seconds to wait for
+     */
+    void waitForChange (float timeout);
+
+  private:
+    void run ();
+    /**
+     * Asks the detectors and publishes what they answered
+     *
+     * @return If anything changed since the last check
+     */
+    bool check ();
+
+    /** how long the thread waits for the window server before checking again anyway */
+    static constexpr float CHECK_INTERVAL = 0.1f;
+
+    Render::Drivers::Detectors::FullScreenDetector& m_detector;
+    Audio::Drivers::Detectors::AudioPlayingDetector& m_audioDetector;
+    /** the keys never change after the constructor, so looking them up needs no lock */
+    std::map<std::string, std::atomic<bool>> m_visible = {};
+    std::atomic<bool> m_anythingFullscreen = false;
+    std::atomic<bool> m_running = false;
+    std::thread m_thread;
+    /** wakes up the render thread waiting on waitForChange () */
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    uint64_t m_changes = 0;
+};
+} // namespace WallpaperEngine::Application
@@ -0,0 +1,160 @@
+#include "MetricsServer.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <sstream>
+#include <tuple>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Application;
+
+MetricsServer::MetricsServer (const Render::FrameStats& stats, std::string address) :
+    m_stats (stats),
+    m_address (std::move (address)) {}
+
+MetricsServer::~MetricsServer () {
+    this->stop ();
+}
+
+void MetricsServer::start () {
+    if (this->m_socket != -1)
+        return;
+
+    const auto separator = this->m_address.rfind (':');
+    const std::string host = separator == std::string::npos ? "127.0.0.1" : this->m_address.substr (0, separator);
+    const std::string port = separator == std::string::npos ? this->m_address : this->m_address.substr (separator + 1);
+    sockaddr_in address = {};
+    uint16_t number = 0;
+
+    address.sin_family = AF_INET;
+
+    if (const auto [end, error] = std::from_chars (port.data (), port.data () + port.size (), number);
+        error != std::errc {} || end != port.data () + port.size () || number == 0 ||
+        inet_pton (AF_INET, host.c_str (), &address.sin_addr) != 1) {
+        sLog.error ("Cannot serve metrics, ", this->m_address, " is not a port or an IPv4 address and port");
+        return;
+    }
+
+    address.sin_port = htons (number);
+
+    this->m_socket = socket (AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    constexpr int reuse = 1;
+
+    // restarting right after stopping would otherwise wait for the old connections to time out
+    if (this->m_socket != -1)
+        setsockopt (this->m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof (reuse));
+
+    if (this->m_socket == -1 ||
+        bind (this->m_socket, reinterpret_cast<const sockaddr*> (&address), sizeof (address)) == -1 ||
+        listen (this->m_socket, 4) == -1 || pipe2 (this->m_wakeup, O_CLOEXEC) == -1) {
+        sLog.error ("Cannot serve metrics on ", this->m_address, ": ", strerror (errno));
+        this->stop ();
+        return;
+    }
+
+    sLog.out ("Serving metrics on http://", host, ":", number, "/metrics");
+
+    this->m_thread = std::thread (&MetricsServer::run, this);
+}
+
+void MetricsServer::stop () {
+    if (this->m_thread.joinable ()) {
+        const char wakeup = 0;
+
+        std::ignore = write (this->m_wakeup [1], &wakeup, 1);
+        this->m_thread.join ();
+    }
+
+    for (int& fd : this->m_wakeup) {
+        if (fd != -1)
+            close (fd);
+
+        fd = -1;
+    }
+
+    if (this->m_socket != -1)
+        close (this->m_socket);
+
+    this->m_socket = -1;
+}
+
+void MetricsServer::run () {
+    // scrapes are never urgent, they only get the CPU when nothing else wants it
+    constexpr sched_param param = {.sched_priority = 0};
+
+    if (pthread_setschedparam (pthread_self (), SCHED_IDLE, &param) != 0)
+        sLog.debug ("Cannot lower the priority of the metrics thread");
+
+    pollfd fds [2] = {
+        {.fd = this->m_socket, .events = POLLIN, .revents = 0},
+        {.fd = this->m_wakeup [0], .events = POLLIN, .revents = 0},
+    };
+
+    while (true) {
+        if (poll (fds, 2, -1) == -1) {
+            if (errno == EINTR)
+                continue;
+
+            sLog.error ("Metrics server stopped: ", strerror (errno));
+            return;
+        }
+
+        if (fds [1].revents != 0)
+            return;
+
+        if ((fds [0].revents & POLLIN) == 0)
+            continue;
+
+        const int client = accept4 (this->m_socket, nullptr, nullptr, SOCK_CLOEXEC);
+
+        if (client == -1)
+            continue;
+
+        this->answer (client);
+        close (client);
+    }
+}
+
+void MetricsServer::answer (const int client) const {
+    char request [1024];
+    std::string received;
+    pollfd fd = {.fd = client, .events = POLLIN, .revents = 0};
+
+    // the request itself doesn't matter, but closing before reading it makes some clients see a reset
+    while (received.find ("\r\n\r\n") == std::string::npos && received.size () < 8192) {
+        if (poll (&fd, 1, REQUEST_TIMEOUT) <= 0)
+            break;
+
+        const ssize_t length = recv (client, request, sizeof (request), 0);
+
+        if (length <= 0)
+            break;
+
+        received.append (request, length);
+    }
+
+    std::ostringstream body;
+
+    this->m_stats.writeMetrics (body);
+
+    const std::string content = body.str ();
+    const std::string response = "HTTP/1.1 200 OK\r\n"
+                                 "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                                 "Content-Length: " + std::to_string (content.size ()) + "\r\n"
+                                 "Connection: close\r\n\r\n" + content;
+
+    // clients that went away already are no reason to take the whole process down with SIGPIPE
+    std::ignore = send (client, response.data (), response.size (), MSG_NOSIGNAL);
+}
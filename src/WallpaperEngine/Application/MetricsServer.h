@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <thread>
+
+#include "WallpaperEngine/Render/FrameStats.h"
+
+namespace WallpaperEngine::Application {
+/**
+ * Plain HTTP endpoint that serves the FrameStats totals in the OpenMetrics text format, for Prometheus to scrape
+ *
+ * Every request gets the metrics whatever its path and the connection is closed right after. Requests are answered on
+ * a thread of their own running with idle priority, the render loop never waits for a scrape
+ */
+class MetricsServer {
+  public:
+    /**
+     * @param stats Where the metrics come from, it has to outlive the server
+     * @param address Port to listen on, optionally after the IPv4 address to bind to (127.0.0.1 by default)
+     */
+    MetricsServer (const Render::FrameStats& stats, std::string address);
+    ~MetricsServer ();
+
+    MetricsServer (const MetricsServer&) = delete;
+    MetricsServer& operator= (const MetricsServer&) = delete;
+
+    /**
+     * Starts listening and answering requests, logs an error and does nothing if the address cannot be used
+     */
+    void start ();
+    /**
+     * Stops answering requests and closes the socket
+     */
+    void stop ();
+
+  private:
+    /** how long a client gets to send its request before it's answered anyway */
+    static constexpr int REQUEST_TIMEOUT = 1000;
+
+    void run ();
+    void answer (int client) const;
+
+    const Render::FrameStats& m_stats;
+    std::string m_address;
+    int m_socket = -1;
+    /** written to when stopping, wakes the thread up from poll () */
+    int m_wakeup [2] = {-1, -1};
+    std::thread m_thread;
+};
+} // namespace WallpaperEngine::Application
@@ -0,0 +1,102 @@
+#include "PowerMonitor.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Application;
+
+bool PowerMonitor::update () {
+    const auto now = std::chrono::steady_clock::now ();
+
+    if (now < this->m_nextCheck)
+        return false;
+
+    this->m_nextCheck = now + CHECK_INTERVAL;
+
+    const float temperature = hottestZone ();
+
+    // a gap between both limits so a zone hovering around one doesn't switch profiles back and forth
+    if (temperature >= THERMAL_LIMIT)
+        this->m_hot = true;
+    else if (temperature < THERMAL_RECOVERY)
+        this->m_hot = false;
+
+    Profile profile = Profile_Normal;
+
+    if (onBattery ())
+        profile = Profile_Battery;
+    else if (this->m_hot)
+        profile = Profile_Thermal;
+
+    if (profile == this->m_profile)
+        return false;
+
+    this->m_profile = profile;
+
+    if (profile == Profile_Battery)
+        sLog.out ("Running on battery, lowering the render settings");
+    else if (profile == Profile_Thermal)
+        sLog.out ("Running hot at ", temperature, "C, lowering the render settings");
+    else
+        sLog.out ("Back to the normal render settings");
+
+    return true;
+}
+
+PowerMonitor::Profile PowerMonitor::getProfile () const {
+    return this->m_profile;
+}
+
+bool PowerMonitor::onBattery () {
+    std::error_code ec;
+    bool discharging = false;
+
+    for (const auto& entry : std::filesystem::directory_iterator ("/sys/class/power_supply", ec)) {
+        const std::string type = readLine (entry.path () / "type");
+
+        if (type == "Battery") {
+            discharging = readLine (entry.path () / "status") == "Discharging" || discharging;
+        } else if (readLine (entry.path () / "online") == "1") {
+            // mains, usb-c and the like, anything online means the battery isn't what's powering the machine
+            return false;
+        }
+    }
+
+    return discharging;
+}
+
+float PowerMonitor::hottestZone () {
+    std::error_code ec;
+    float hottest = 0.0f;
+
+    for (const auto& entry : std::filesystem::directory_iterator ("/sys/class/thermal", ec)) {
+        if (!entry.path ().filename ().string ().starts_with ("thermal_zone"))
+            continue;
+
+        const std::string temperature = readLine (entry.path () / "temp");
+
+        if (temperature.empty ())
+            continue;
+
+        try {
+            // in millidegrees
+            hottest = std::max (hottest, static_cast<float> (std::stol (temperature)) / 1000.0f);
+        } catch (const std::exception&) {
+            // zones that can't be read right now (like a sensor that's turned off) answer with an error
+        }
+    }
+
+    return hottest;
+}
+
+std::string PowerMonitor::readLine (const std::filesystem::path& path) {
+    std::ifstream file (path);
+    std::string line;
+
+    std::getline (file, line);
+
+    return line;
+}
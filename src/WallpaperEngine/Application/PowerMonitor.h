@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+namespace WallpaperEngine::Application {
+/**
+ * Follows the power supplies and thermal zones the kernel exposes to tell when rendering should cost less
+ *
+ * Reads /sys/class/power_supply and /sys/class/thermal, the same files UPower reads, so there's no need for a
+ * D-Bus connection. The files are small but reading them is still a handful of syscalls, so it's only done every
+ * few seconds no matter how often update () is called
+ */
+class PowerMonitor {
+  public:
+    enum Profile {
+        /** plugged in and cool enough */
+        Profile_Normal = 0,
+        /** running on battery */
+        Profile_Battery = 1,
+        /** plugged in, but the hottest thermal zone is over the limit */
+        Profile_Thermal = 2,
+    };
+
+    /**
+     * Checks the power supplies and thermal zones again if it's been long enough since the last time
+     *
+     * @return If the profile changed
+     */
+    bool update ();
+    [[nodiscard]] Profile getProfile () const;
+
+  private:
+    /**
+     * @return If no power supply is online and a battery is discharging, machines without battery are never on it
+     */
+    static bool onBattery ();
+    /**
+     * @return Temperature of the hottest thermal zone in degrees celsius, 0 if there are none
+     */
+    static float hottestZone ();
+    /**
+     * @return The first line of the file, empty if it can't be read
+     */
+    static std::string readLine (const std::filesystem::path& path);
+
+    /** how often the files are read again */
+    static constexpr std::chrono::seconds CHECK_INTERVAL {5};
+    /** degrees the hottest zone has to reach to lower the cost, and to go under to go back to normal */
+    static constexpr float THERMAL_LIMIT = 85.0f;
+    static constexpr float THERMAL_RECOVERY = 75.0f;
+
+    Profile m_profile = Profile_Normal;
+    bool m_hot = false;
+    std::chrono::steady_clock::time_point m_nextCheck {};
+};
+} // namespace WallpaperEngine::Application
@@ -0,0 +1,86 @@
+#include "PreviewWriter.h"
+
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <stb_image_write.h>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Application;
+
+PreviewWriter::PreviewWriter (std::filesystem::path directory, const uint32_t width) :
+    m_directory (std::move (directory)),
+    m_width (width) {}
+
+PreviewWriter::~PreviewWriter () {
+    this->wait ();
+}
+
+void PreviewWriter::capture (const Render::CWallpaper& wallpaper, const std::string& name) {
+    const auto fbo = wallpaper.getFBO ();
+    const uint32_t width = fbo->getRealWidth ();
+    const uint32_t height = fbo->getRealHeight ();
+    std::vector<uint8_t> pixels (static_cast<size_t> (width) * height * 4);
+
+    glBindFramebuffer (GL_READ_FRAMEBUFFER, wallpaper.getWallpaperFramebuffer ());
+    glPixelStorei (GL_PACK_ALIGNMENT, 4);
+    glReadPixels (0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data ());
+
+    if (const GLenum error = glGetError (); error != GL_NO_ERROR) {
+        sLog.error ("Cannot read the preview of ", name, ". OpenGL error: ", error);
+        return;
+    }
+
+    sJobPool.submit (this->m_jobs, [this, pixels = std::move (pixels), width, height,
+                                    path = this->m_directory / (name + ".png")] {
+        this->write (pixels, width, height, path);
+    });
+}
+
+void PreviewWriter::wait () {
+    sJobPool.wait (this->m_jobs);
+}
+
+void PreviewWriter::write (
+    const std::vector<uint8_t>& pixels, const uint32_t width, const uint32_t height,
+    const std::filesystem::path& path
+) const {
+    // previews are never bigger than what was rendered
+    const uint32_t targetWidth = std::min (this->m_width, width);
+    const uint32_t targetHeight = std::max<uint32_t> (1, static_cast<uint64_t> (height) * targetWidth / width);
+    std::vector<uint8_t> image (static_cast<size_t> (targetWidth) * targetHeight * 3);
+
+    // the scene's framebuffer already stores the top row first, so no flip is needed
+    for (uint32_t y = 0; y < targetHeight; y++) {
+        const uint32_t top = y * height / targetHeight;
+        const uint32_t bottom = std::max (top + 1, (y + 1) * height / targetHeight);
+
+        for (uint32_t x = 0; x < targetWidth; x++) {
+            const uint32_t left = x * width / targetWidth;
+            const uint32_t right = std::max (left + 1, (x + 1) * width / targetWidth);
+            uint64_t sum [3] = {0, 0, 0};
+
+            for (uint32_t sy = top; sy < bottom; sy++) {
+                const uint8_t* pixel = &pixels [(static_cast<size_t> (sy) * width + left) * 4];
+
+                for (uint32_t sx = left; sx < right; sx++, pixel += 4) {
+                    sum [0] += pixel [0];
+                    sum [1] += pixel [1];
+                    sum [2] += pixel [2];
+                }
+            }
+
+            const uint64_t count = static_cast<uint64_t> (bottom - top) * (right - left);
+            uint8_t* target = &image [(static_cast<size_t> (y) * targetWidth + x) * 3];
+
+            for (int channel = 0; channel < 3; channel++)
+                target [channel] = static_cast<uint8_t> (sum [channel] / count);
+        }
+    }
+
+    if (stbi_write_png (path.c_str (), targetWidth, targetHeight, 3, image.data (), targetWidth * 3) == 0)
+        sLog.error ("Cannot write preview ", path);
+    else
+        sLog.out ("Wrote preview ", path);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "WallpaperEngine/Render/CWallpaper.h"
+#include "WallpaperEngine/Threading/JobPool.h"
+
+namespace WallpaperEngine::Application {
+/**
+ * Writes the preview images taken with --previews
+ *
+ * The wallpaper's framebuffer is read back on the render thread, downscaling and PNG encoding happen on the JobPool
+ * so the next background can start loading and simulating right away
+ */
+class PreviewWriter {
+  public:
+    /**
+     * @param directory Folder the images are written to
+     * @param width Width of the images, the height keeps the framebuffer's aspect ratio
+     */
+    PreviewWriter (std::filesystem::path directory, uint32_t width);
+    ~PreviewWriter ();
+
+    PreviewWriter (const PreviewWriter&) = delete;
+    PreviewWriter& operator= (const PreviewWriter&) = delete;
+
+    /**
+     * Reads the last frame the wallpaper rendered and queues writing it as <name>.png
+     *
+     * @param wallpaper
+     * @param name
+     */
+    void capture (const Render::CWallpaper& wallpaper, const std::string& name);
+    /**
+     * Waits for every image queued to be written
+     */
+    void wait ();
+
+  private:
+    /**
+     * Box filters the RGBA pixels down to the preview's size and writes them out
+     */
+    void write (
+        const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, const std::filesystem::path& path) const;
+
+    std::filesystem::path m_directory;
+    uint32_t m_width;
+    Threading::JobPool::Group m_jobs = {};
+};
+} // namespace WallpaperEngine::Application
@@ -0,0 +1,180 @@
+#include "ProjectWatcher.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ranges>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Application;
+
+namespace {
+constexpr uint32_t EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+/**
+ * @return If the file is one editors keep next to the ones being edited (swap files, backups and such)
+ */
+bool isScratchFile (const std::string& name) {
+    return name.empty () || name.front () == '.' || name.back () == '~' || name.ends_with (".swp") ||
+           name.ends_with (".tmp");
+}
+} // namespace
+
+ProjectWatcher::ProjectWatcher () {
+    this->m_fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+
+    if (this->m_fd == -1)
+        sLog.error ("Cannot watch the backgrounds for changes: ", strerror (errno));
+}
+
+ProjectWatcher::~ProjectWatcher () {
+    // closing the descriptor removes every watch with it
+    if (this->m_fd != -1)
+        close (this->m_fd);
+}
+
+void ProjectWatcher::watch (const std::string& screen, const std::filesystem::path& directory) {
+    if (this->m_fd == -1)
+        return;
+
+    std::error_code ec;
+    const auto absolute = std::filesystem::absolute (directory, ec).lexically_normal ();
+
+    if (const auto current = this->m_screens.find (screen);
+        current != this->m_screens.end () && current->second.directory == absolute)
+        return;
+
+    this->m_screens.insert_or_assign (screen, Screen {.directory = absolute, .changed = {}, .lastChange = {}});
+    this->addDirectory (absolute);
+    this->prune ();
+
+    sLog.debug ("Watching ", absolute, " for changes to the background on ", screen);
+}
+
+std::map<std::string, ProjectWatcher::Changes> ProjectWatcher::takeChanges () {
+    std::map<std::string, Changes> result;
+
+    if (this->m_fd == -1)
+        return result;
+
+    this->readEvents ();
+
+    const auto now = std::chrono::steady_clock::now ();
+
+    for (auto& [screen, watched] : this->m_screens) {
+        if (watched.changed.empty () || now - watched.lastChange < SETTLE_TIME)
+            continue;
+
+        result.emplace (screen, Changes {.directory = watched.directory, .files = std::move (watched.changed)});
+        watched.changed.clear ();
+    }
+
+    return result;
+}
+
+void ProjectWatcher::addDirectory (const std::filesystem::path& directory) {
+    // the same folder gets the same descriptor back, screens showing the same background share it
+    const int descriptor = inotify_add_watch (this->m_fd, directory.c_str (), EVENTS | IN_ONLYDIR);
+
+    if (descriptor == -1) {
+        sLog.error ("Cannot watch ", directory, " for changes: ", strerror (errno));
+        return;
+    }
+
+    this->m_descriptors [descriptor] = directory;
+
+    std::error_code ec;
+
+    for (const auto& entry : std::filesystem::directory_iterator (directory, ec))
+        if (entry.is_directory (ec) && !isScratchFile (entry.path ().filename ().string ()))
+            this->addDirectory (entry.path ());
+}
+
+void ProjectWatcher::prune () {
+    for (auto it = this->m_descriptors.begin (); it != this->m_descriptors.end ();) {
+        const auto& directory = it->second;
+        bool used = false;
+
+        for (const auto& watched : this->m_screens | std::views::values) {
+            const auto relative = directory.lexically_relative (watched.directory);
+
+            if (!relative.empty () && *relative.begin () != "..") {
+                used = true;
+                break;
+            }
+        }
+
+        if (used) {
+            ++it;
+            continue;
+        }
+
+        inotify_rm_watch (this->m_fd, it->first);
+        it = this->m_descriptors.erase (it);
+    }
+}
+
+void ProjectWatcher::readEvents () {
+    alignas (inotify_event) char buffer [4096];
+
+    while (true) {
+        const ssize_t length = read (this->m_fd, buffer, sizeof (buffer));
+
+        if (length <= 0)
+            return;
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*> (buffer + offset);
+
+            offset += static_cast<ssize_t> (sizeof (inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                sLog.error ("Too many changes to the backgrounds at once, some of them might not be reloaded");
+                continue;
+            }
+
+            const auto directory = this->m_descriptors.find (event->wd);
+
+            if (directory == this->m_descriptors.end ())
+                continue;
+
+            // the folder itself is gone, its descriptor will never be used again
+            if (event->mask & IN_IGNORED) {
+                this->m_descriptors.erase (directory);
+                continue;
+            }
+
+            const std::string name = event->len > 0 ? event->name : "";
+
+            if (isScratchFile (name))
+                continue;
+
+            const auto path = directory->second / name;
+
+            if (event->mask & IN_ISDIR) {
+                // new folders are followed too, the files copied into them before the watch are not seen though
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    this->addDirectory (path);
+
+                continue;
+            }
+
+            // files are only counted as changed once written, not when they're first created empty
+            if (event->mask & IN_CREATE)
+                continue;
+
+            for (auto& watched : this->m_screens | std::views::values) {
+                const auto relative = path.lexically_relative (watched.directory);
+
+                if (relative.empty () || *relative.begin () == "..")
+                    continue;
+
+                watched.changed.insert (relative);
+                watched.lastChange = std::chrono::steady_clock::now ();
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+
+namespace WallpaperEngine::Application {
+/**
+ * Follows the folders the backgrounds on screen were loaded from so they can be reloaded while they're being edited
+ *
+ * Uses inotify on every folder under the background's, new ones are followed as they're created. Editors tend to
+ * write a file in several steps (or several files at once when saving everything), so a background only counts as
+ * changed once its files were left alone for SETTLE_TIME. Nothing blocks, takeChanges () only reads the events
+ * already queued
+ */
+class ProjectWatcher {
+  public:
+    /** What changed in a background's folder */
+    struct Changes {
+        std::filesystem::path directory;
+        /** files written, moved in or removed, relative to the folder */
+        std::set<std::filesystem::path> files;
+    };
+
+    ProjectWatcher ();
+    ~ProjectWatcher ();
+
+    ProjectWatcher (const ProjectWatcher&) = delete;
+    ProjectWatcher& operator= (const ProjectWatcher&) = delete;
+
+    /**
+     * Follows the folder for the screen, replacing whatever it was following for it before. Calling it again with
+     * the same folder does nothing
+     */
+    void watch (const std::string& screen, const std::filesystem::path& directory);
+    /**
+     * @return The screens whose background's files changed and settled since the last call
+     */
+    std::map<std::string, Changes> takeChanges ();
+
+  private:
+    /** how long a folder has to be left alone before its changes are handed out */
+    static constexpr std::chrono::milliseconds SETTLE_TIME {50};
+
+    struct Screen {
+        std::filesystem::path directory;
+        std::set<std::filesystem::path> changed;
+        std::chrono::steady_clock::time_point lastChange;
+    };
+
+    /**
+     * Adds a watch for the folder and every folder under it
+     */
+    void addDirectory (const std::filesystem::path& directory);
+    /**
+     * Removes the watches no screen's folder needs anymore
+     */
+    void prune ();
+    /**
+     * Reads the events queued so far and adds them to the screens they belong to
+     */
+    void readEvents ();
+
+    int m_fd = -1;
+    /** watch descriptor to the absolute folder it follows */
+    std::map<int, std::filesystem::path> m_descriptors {};
+    std::map<std::string, Screen> m_screens {};
+};
+} // namespace WallpaperEngine::Application
@@ -0,0 +1,114 @@
+#include "StatsSocket.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <tuple>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Application;
+
+StatsSocket::StatsSocket (const Render::FrameStats& stats, std::filesystem::path path) :
+    m_stats (stats),
+    m_path (std::move (path)) {}
+
+StatsSocket::~StatsSocket () {
+    this->stop ();
+}
+
+void StatsSocket::start () {
+    if (this->m_socket != -1)
+        return;
+
+    sockaddr_un address = {};
+    const std::string path = this->m_path.string ();
+
+    if (path.size () >= sizeof (address.sun_path)) {
+        sLog.error ("Cannot create the stats socket, the path is too long: ", path);
+        return;
+    }
+
+    address.sun_family = AF_UNIX;
+    std::memcpy (address.sun_path, path.c_str (), path.size () + 1);
+
+    // a socket left behind by an instance that didn't close properly
+    unlink (path.c_str ());
+
+    this->m_socket = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (this->m_socket == -1 ||
+        bind (this->m_socket, reinterpret_cast<const sockaddr*> (&address), sizeof (address)) == -1 ||
+        listen (this->m_socket, 4) == -1 || pipe2 (this->m_wakeup, O_CLOEXEC) == -1) {
+        sLog.error ("Cannot create the stats socket ", path, ": ", strerror (errno));
+        this->stop ();
+        return;
+    }
+
+    sLog.out ("Serving frame stats on ", path);
+
+    this->m_thread = std::thread (&StatsSocket::run, this);
+}
+
+void StatsSocket::stop () {
+    if (this->m_thread.joinable ()) {
+        const char wakeup = 0;
+
+        std::ignore = write (this->m_wakeup [1], &wakeup, 1);
+        this->m_thread.join ();
+    }
+
+    for (int& fd : this->m_wakeup) {
+        if (fd != -1)
+            close (fd);
+
+        fd = -1;
+    }
+
+    if (this->m_socket != -1) {
+        close (this->m_socket);
+        unlink (this->m_path.c_str ());
+    }
+
+    this->m_socket = -1;
+}
+
+void StatsSocket::run () {
+    pollfd fds [2] = {
+        {.fd = this->m_socket, .events = POLLIN, .revents = 0},
+        {.fd = this->m_wakeup [0], .events = POLLIN, .revents = 0},
+    };
+
+    while (true) {
+        if (poll (fds, 2, -1) == -1) {
+            if (errno == EINTR)
+                continue;
+
+            sLog.error ("Stats socket stopped: ", strerror (errno));
+            return;
+        }
+
+        if (fds [1].revents != 0)
+            return;
+
+        if ((fds [0].revents & POLLIN) == 0)
+            continue;
+
+        const int client = accept4 (this->m_socket, nullptr, nullptr, SOCK_CLOEXEC);
+
+        if (client == -1)
+            continue;
+
+        const std::string snapshot = this->m_stats.getSnapshot () + '\n';
+
+        // clients that went away already are no reason to take the whole process down with SIGPIPE
+        std::ignore = send (client, snapshot.data (), snapshot.size (), MSG_NOSIGNAL);
+        close (client);
+    }
+}
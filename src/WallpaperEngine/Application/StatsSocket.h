@@ -0,0 +1,47 @@
+#pragma once
+
+#include <filesystem>
+#include <thread>
+
+#include "WallpaperEngine/Render/FrameStats.h"
+
+namespace WallpaperEngine::Application {
+/**
+ * Unix socket that hands out the last FrameStats snapshot to whoever connects
+ *
+ * Every connection gets the snapshot as one line of JSON and is closed right after, so `socat - UNIX:<path>` or a
+ * status bar script can poll it. Connections are answered on a thread of their own, the render loop never waits
+ * for a client
+ */
+class StatsSocket {
+  public:
+    /**
+     * @param stats Where the snapshots come from, it has to outlive the socket
+     * @param path Where the socket is created, anything already there is replaced
+     */
+    StatsSocket (const Render::FrameStats& stats, std::filesystem::path path);
+    ~StatsSocket ();
+
+    StatsSocket (const StatsSocket&) = delete;
+    StatsSocket& operator= (const StatsSocket&) = delete;
+
+    /**
+     * Creates the socket and starts answering connections, logs an error and does nothing if it can't be created
+     */
+    void start ();
+    /**
+     * Stops answering connections and removes the socket
+     */
+    void stop ();
+
+  private:
+    void run ();
+
+    const Render::FrameStats& m_stats;
+    std::filesystem::path m_path;
+    int m_socket = -1;
+    /** written to when stopping, wakes the thread up from poll () */
+    int m_wakeup [2] = {-1, -1};
+    std::thread m_thread;
+};
+} // namespace WallpaperEngine::Application
@@ -4,29 +4,47 @@
 #include "WallpaperEngine/Application/ApplicationState.h"
 #include "WallpaperEngine/Assets/AssetLoadException.h"
 #include "WallpaperEngine/Audio/Drivers/Detectors/PulseAudioPlayingDetector.h"
+#include "WallpaperEngine/FileSystem/Adapters/Directory.h"
 #include "WallpaperEngine/FileSystem/Container.h"
 #include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/Drivers/GPUSelection.h"
+#include "WallpaperEngine/Render/GPUResources.h"
 #include "WallpaperEngine/Render/Drivers/VideoFactories.h"
 #include "WallpaperEngine/Render/RenderContext.h"
+#include "WallpaperEngine/Render/Wallpapers/CScene.h"
+#include "WallpaperEngine/Render/Wallpapers/CVideo.h"
+#include "WallpaperEngine/Render/Wallpapers/CWeb.h"
 
 #include "WallpaperEngine/Data/Dumpers/StringPrinter.h"
 #include "WallpaperEngine/Data/Parsers/ProjectParser.h"
 
 #include "WallpaperEngine/Data/Model/Property.h"
 #include "WallpaperEngine/Data/Model/Wallpaper.h"
+#include "WallpaperEngine/Debugging/AllocationProfiler.h"
 #include "WallpaperEngine/Debugging/CallStack.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
+
+#ifdef ENABLE_PIPEWIRE
+#include "WallpaperEngine/Audio/Drivers/Recorders/PipeWirePlaybackRecorder.h"
+#endif /* ENABLE_PIPEWIRE */
 
 #if DEMOMODE
 #include "recording.h"
 #endif /* DEMOMODE */
 
 #include <algorithm>
+#include <exception>
+#include <fstream>
 #include <numeric>
+#include <ranges>
+#include <sstream>
 #include <unistd.h>
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
-#define FULLSCREEN_CHECK_WAIT_TIME 250
+/** seconds to wait for the fullscreen state to change before checking it again */
+#define FULLSCREEN_CHECK_WAIT_TIME 1.0f
 
 float g_Time;
 float g_TimeLast;
@@ -69,144 +87,70 @@ WallpaperApplication::WallpaperApplication (ApplicationContext& context) :
     m_context (context) {
     this->loadBackgrounds ();
     this->setupProperties ();
+
+    if (this->m_context.settings.general.dumpStructure)
+        this->dumpStructure ();
+
+    // nothing is rendered when only listing properties, so no browser, playlists or GL context are needed
+    if (this->m_context.settings.general.onlyListProperties)
+        return;
+
+    // the seed has to be settled before any playlist is shuffled or particle system created
+    this->setupInputRecording ();
+
+    // before the browser starts, its GPU process and every GL context after it should land on the selected GPU
+    if (const auto gpu = Render::Drivers::GPUSelection::selected (this->m_context.settings.render.gpu); gpu.has_value ())
+        Render::Drivers::GPUSelection::apply (*gpu);
+
     this->setupBrowser();
     this->initializePlaylists ();
 }
 
+WallpaperApplication::~WallpaperApplication () {
+    // the jobs use the preflight cache
+    sJobPool.wait (this->m_preflightJobs);
+
+    for (const auto& preload : this->m_preloads | std::views::values)
+        sJobPool.wait (preload->job);
+}
+
 AssetLocatorUniquePtr WallpaperApplication::setupAssetLocator (const std::string& bg) const {
     auto container = std::make_unique <Container> ();
 
     const std::filesystem::path path = bg;
 
-    container->mount (path, "/");
-    try {
-        container->mount (path / "scene.pkg", "/");
-    } catch (std::runtime_error&) { }
+    const auto directory = container->mount (path, "/");
 
-    try {
-        container->mount (path / "gifscene.pkg", "/");
-    } catch (std::runtime_error&) { }
+    // like scene.pkg the background's own files are mapped, web backgrounds stream big videos straight out of them.
+    // Not when watching them though, editors truncate the files they save and reading those maps would crash
+    if (const auto adapter = std::dynamic_pointer_cast<DirectoryAdapter> (directory); adapter != nullptr)
+        adapter->mapFiles = !this->m_context.settings.general.watch;
+
+    for (const auto* name : {"scene.pkg", "gifscene.pkg"}) {
+        try {
+            const auto package = container->mount (path / name, "/");
+
+            if (const auto adapter = std::dynamic_pointer_cast<PackageAdapter> (package);
+                adapter != nullptr && this->m_context.settings.general.repack) {
+                std::scoped_lock lock (this->m_packagesMutex);
+
+                this->m_packages.emplace_back (adapter, path / name);
+            }
+        } catch (std::runtime_error&) { }
+    }
 
     try {
-        container->mount (this->m_context.settings.general.assets, "/");
+        const auto assets = container->mount (this->m_context.settings.general.assets, "/");
+
+        if (const auto directory = std::dynamic_pointer_cast<DirectoryAdapter> (assets);
+            directory != nullptr && this->m_context.settings.general.sharedAssets)
+            directory->mapFiles = true;
     } catch (std::runtime_error&) {
         sLog.exception ("Cannot find a valid assets folder, resolved to ", this->m_context.settings.general.assets);
     }
 
     auto& vfs = container->getVFS ();
 
-    //
-    // Had to get a little creative with the effects to achieve the same bloom effect without any custom code
-    // these virtual files are loaded by an image in the scene that takes current _rt_FullFrameBuffer and
-    // applies the bloom effect to render it out to the screen
-    //
-
-    // add the effect file for screen bloom
-
-    // add some model for the image element even if it's going to waste rendering cycles
-    vfs.add (
-        "effects/wpenginelinux/bloomeffect.json",
-        {
-            {"name", "camerabloom_wpengine_linux"},
-            {"group", "wpengine_linux_camera"},
-            {"dependencies", JSON::array ()},
-            {"passes",
-                JSON::array (
-                    {
-                        {
-                            {"material", "materials/util/downsample_quarter_bloom.json"},
-                            {"target", "_rt_4FrameBuffer"},
-                            {
-                                "bind",
-                                JSON::array (
-                                    {
-                                        {
-                                            {"name", "_rt_FullFrameBuffer"},
-                                            {"index", 0}
-                                        }
-                                    }
-                                )
-                            }
-                        },
-                        {
-                            {"material", "materials/util/downsample_eighth_blur_v.json"},
-                            {"target", "_rt_8FrameBuffer"},
-                            {
-                                "bind",
-                                JSON::array (
-                                    {
-                                        {
-                                            {"name", "_rt_4FrameBuffer"},
-                                            {"index", 0}
-                                        }
-                                    }
-                                )
-                            }
-                        },
-                        {
-                            {"material", "materials/util/blur_h_bloom.json"},
-                            {"target", "_rt_Bloom"},
-                            {
-                                "bind",
-                                JSON::array (
-                                    {
-                                        {
-                                            {"name", "_rt_8FrameBuffer"},
-                                            {"index", 0}
-                                        }
-                                    }
-                                )
-                            }
-                        },
-                        {
-                            {"material", "materials/util/combine.json"},
-                            {"target", "_rt_FullFrameBuffer"},
-                            {
-                                "bind",
-                                JSON::array (
-                                    {
-                                        {
-                                            {"name", "_rt_imageLayerComposite_-1_a"},
-                                            {"index", 0}
-                                        },
-                                        {
-                                            {"name", "_rt_Bloom"},
-                                            {"index", 1}
-                                        }
-                                    }
-                                )
-                            }
-                        }
-                    }
-               ),
-            }
-        }
-    );
-
-    vfs.add (
-        "models/wpenginelinux.json",
-        {
-            {"material","materials/wpenginelinux.json"}
-        }
-    );
-
-    vfs.add(
-        "materials/wpenginelinux.json",
-        {
-            {"passes", JSON::array (
-                {
-                    {
-                        {"blending", "normal"},
-                        {"cullmode", "nocull"},
-                        {"depthtest", "disabled"},
-                        {"depthwrite", "disabled"},
-                        {"shader", "genericimage2"},
-                        {"textures", JSON::array ({"_rt_FullFrameBuffer"})}
-                    }
-                }
-            )}}
-    );
-
     vfs.add(
         "shaders/commands/copy.frag",
         "uniform sampler2D g_Texture0;\n"
@@ -226,10 +170,12 @@ AssetLocatorUniquePtr WallpaperApplication::setupAssetLocator (const std::string
         "}"
     );
 
-    return std::make_unique <AssetLocator> (std::move (container));
+    return std::make_unique <AssetLocator> (std::move (container), this->m_context.settings.general.jsonCache);
 }
 
 void WallpaperApplication::loadBackgrounds () {
+    TRACE_SCOPE ("WallpaperApplication::loadBackgrounds");
+
     if (this->m_context.settings.render.mode == ApplicationContext::NORMAL_WINDOW ||
         this->m_context.settings.render.mode == ApplicationContext::EXPLICIT_WINDOW) {
         auto path = this->m_context.settings.general.defaultBackground;
@@ -243,21 +189,88 @@ void WallpaperApplication::loadBackgrounds () {
         return;
     }
 
+    struct PendingLoad {
+        ProjectSharedPtr project;
+        std::exception_ptr error;
+    };
+
+    // screens with no background use the default
+    const auto backgroundFor = [this] (const std::filesystem::path& path) -> const std::filesystem::path& {
+        return path.empty () ? this->m_context.settings.general.defaultBackground : path;
+    };
+
+    // every distinct background is parsed once on its own job, screens showing the same one share the project
+    std::map<std::filesystem::path, PendingLoad> loads;
+    Threading::JobPool::Group group;
+
+    for (const auto& path : this->m_context.settings.general.screenBackgrounds | std::views::values)
+        loads.try_emplace (backgroundFor (path));
+
+    for (auto& [path, load] : loads) {
+        sJobPool.submit (group, [this, &path, &load] {
+            try {
+                load.project = this->loadBackground (path.string ());
+            } catch (...) {
+                load.error = std::current_exception ();
+            }
+        });
+    }
+
+    sJobPool.wait (group);
+
     for (const auto& [screen, path] : this->m_context.settings.general.screenBackgrounds) {
-        // screens with no screen should use the default
-        if (path.empty ()) {
-            this->m_backgrounds [screen] = this->loadBackground (this->m_context.settings.general.defaultBackground);
-        } else {
-            this->m_backgrounds [screen] = this->loadBackground (path);
+        const auto& load = loads.at (backgroundFor (path));
+
+        if (load.error != nullptr)
+            std::rethrow_exception (load.error);
+
+        this->m_backgrounds [screen] = load.project;
+    }
+}
+
+void WallpaperApplication::repackPackages () const {
+    std::scoped_lock lock (this->m_packagesMutex);
+
+    for (const auto& [adapter, path] : this->m_packages) {
+        try {
+            adapter->repack (path);
+            sLog.out ("Repacked ", path, " in the order its files were read");
+        } catch (std::exception& e) {
+            sLog.error ("Cannot repack ", path, ": ", e.what ());
         }
     }
 }
 
 ProjectUniquePtr WallpaperApplication::loadBackground (const std::string& bg) {
+    const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_Background);
+    const auto start = std::chrono::steady_clock::now ();
     auto container = this->setupAssetLocator (bg);
-    auto json = WallpaperEngine::Data::JSON::JSON::parse (container->readString ("project.json"));
+    const auto contents = container->readString ("project.json");
+    auto json = [&contents] {
+        const Debugging::LoadReport::Scope parse (Debugging::LoadReport::Stage_Json, contents.size ());
+
+        return WallpaperEngine::Data::JSON::JSON::parse (contents);
+    } ();
+
+    // the wallpaper itself is only needed to render it or print its structure
+    const bool metadataOnly =
+        this->m_context.settings.general.onlyListProperties && !this->m_context.settings.general.dumpStructure;
+
+    auto project = WallpaperEngine::Data::Parsers::ProjectParser::parse (json, std::move(container), metadataOnly);
 
-    return WallpaperEngine::Data::Parsers::ProjectParser::parse (json, std::move(container));
+    project->path = bg;
+
+    {
+        // the first backgrounds are loaded before there are any stats to add them to
+        std::scoped_lock lock (this->m_loadTimesMutex);
+
+        if (this->m_renderContext != nullptr)
+            this->m_renderContext->getStats ().addLoad (std::chrono::steady_clock::now () - start);
+        else
+            this->m_loadTimes.push_back (std::chrono::steady_clock::now () - start);
+    }
+
+    return project;
 }
 
 std::vector<std::size_t> WallpaperApplication::buildPlaylistOrder (
@@ -309,6 +322,7 @@ void WallpaperApplication::initializePlaylists () {
         state.nextSwitch = now + std::chrono::minutes (delayMinutes);
         state.lastUpdate = now;
 
+        this->queuePreflight (state);
         this->m_activePlaylists.insert_or_assign (key, std::move (state));
     };
 
@@ -354,14 +368,62 @@ bool WallpaperApplication::makeAnyViewportCurrent () const {
 }
 
 bool WallpaperApplication::preflightWallpaper (const std::string& path) {
+    return this->indexWallpaper (path).valid;
+}
+
+WorkshopIndex::Item WallpaperApplication::indexWallpaper (const std::filesystem::path& path) const {
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time (path / "project.json", ec).time_since_epoch ().count ();
+
+    if (!ec)
+        if (auto item = this->m_workshopIndex.find (path, modified); item.has_value ())
+            return *item;
+
+    WorkshopIndex::Item item {.modified = modified, .valid = false, .type = ""};
+
+    item.valid = this->validateWallpaper (path, item.type);
+
+    // a project.json that cannot be found now might show up later, only keep the ones on disk
+    if (!ec)
+        this->m_workshopIndex.update (path, item);
+
+    return item;
+}
+
+std::string WallpaperApplication::readProjectFile (const std::filesystem::path& path) const {
+    if (std::ifstream file (path / "project.json"); file) {
+        std::stringstream buffer;
+        buffer << file.rdbuf ();
+        return buffer.str ();
+    }
+
+    // avoid mutating state, just ensure project.json can be read
+    return this->setupAssetLocator (path.string ())->readString ("project.json");
+}
+
+bool WallpaperApplication::validateWallpaper (const std::filesystem::path& path, std::string& type) const {
     try {
-        // avoid mutating state, just ensure project.json parses
-        auto container = this->setupAssetLocator (path);
-        const auto json = WallpaperEngine::Data::JSON::JSON::parse (container->readString ("project.json"));
-        if (!json.contains ("type") || !json.contains ("file")) {
+        const auto json = WallpaperEngine::Data::JSON::JSON::parse (this->readProjectFile (path));
+
+        if (json.contains ("type") && json ["type"].is_string ()) {
+            type = json ["type"].get<std::string> ();
+            std::ranges::transform (type, type.begin (), tolower);
+        }
+
+        if (!json.contains ("type") || !json.contains ("file") || !json ["file"].is_string ()) {
             sLog.error ("Preflight failed for ", path, ": missing required fields");
             return false;
         }
+
+        // scenes keep their main file in the package
+        const std::filesystem::path main = json ["file"].get<std::string> ();
+
+        if (!std::filesystem::exists (path / main) && !std::filesystem::exists (path / "scene.pkg") &&
+            !std::filesystem::exists (path / "gifscene.pkg")) {
+            sLog.error ("Preflight failed for ", path, ": cannot find ", main);
+            return false;
+        }
+
         return true;
     } catch (const std::exception& e) {
         sLog.error ("Preflight failed for ", path, ": ", e.what ());
@@ -369,6 +431,81 @@ bool WallpaperApplication::preflightWallpaper (const std::string& path) {
     }
 }
 
+void WallpaperApplication::queuePreload (const std::string& screen, const ActivePlaylist& playlist) {
+    const auto nextIndex = (playlist.orderIndex + 1) % playlist.order.size ();
+
+    // a random playlist is shuffled again when it wraps around, there's no knowing what comes next
+    if (nextIndex == 0 && playlist.definition.settings.order == "random")
+        return;
+
+    const auto next = playlist.order [nextIndex];
+
+    if (playlist.failedIndices.contains (next))
+        return;
+
+    this->queuePreload (screen, playlist.definition.items [next]);
+}
+
+void WallpaperApplication::queuePreload (const std::string& screen, const std::filesystem::path& path) {
+    if (const auto current = this->m_preloads.find (screen); current != this->m_preloads.end ()) {
+        if (current->second->path == path)
+            return;
+
+        sJobPool.wait (current->second->job);
+    }
+
+    auto preload = std::make_unique<Preload> ();
+    auto& target = *preload;
+
+    preload->path = path;
+
+    sJobPool.submit (preload->job, [this, &target] {
+        try {
+            target.project = this->loadBackground (target.path.string ());
+        } catch (const std::exception& e) {
+            target.error = e.what ();
+        }
+    });
+
+    this->m_preloads.insert_or_assign (screen, std::move (preload));
+}
+
+ProjectUniquePtr WallpaperApplication::takePreload (const std::string& screen, const std::filesystem::path& path) {
+    const auto it = this->m_preloads.find (screen);
+
+    if (it == this->m_preloads.end ())
+        return this->loadBackground (path.string ());
+
+    const auto preload = std::move (it->second);
+
+    this->m_preloads.erase (it);
+    // usually done long ago, otherwise it's still quicker than starting over
+    sJobPool.wait (preload->job);
+
+    if (preload->path != path)
+        return this->loadBackground (path.string ());
+    if (preload->project == nullptr)
+        throw std::runtime_error (preload->error);
+
+    sLog.debug ("Switching to preloaded background ", path);
+
+    return std::move (preload->project);
+}
+
+void WallpaperApplication::queuePreflight (const ActivePlaylist& playlist) {
+    if (playlist.order.size () < 2)
+        return;
+
+    const auto next = playlist.order [(playlist.orderIndex + 1) % playlist.order.size ()];
+
+    if (playlist.failedIndices.contains (next))
+        return;
+
+    sJobPool.submit (this->m_preflightJobs, [this, path = playlist.definition.items [next].string ()] {
+        this->preflightWallpaper (path);
+    });
+}
+
 bool WallpaperApplication::selectNextCandidate (ActivePlaylist& playlist, std::size_t& outOrderIndex) {
     if (playlist.order.empty ())
         return false;
@@ -432,40 +569,7 @@ void WallpaperApplication::advancePlaylist (
     bool loaded = false;
 
     try {
-        if (!this->makeAnyViewportCurrent ()) {
-            sLog.error ("Cannot switch playlist on ", screen, ": no active viewport");
-            throw std::runtime_error ("No viewport available");
-        }
-
-        auto project = this->loadBackground (nextPath.string ());
-
-        this->setupPropertiesForProject (*project);
-        this->ensureBrowserForProject (*project);
-
-        this->m_backgrounds [screen] = std::move (project);
-
-        const auto scalingIt = this->m_context.settings.general.screenScalings.find (screen);
-        const auto clampIt = this->m_context.settings.general.screenClamps.find (screen);
-        const auto scaling = scalingIt != this->m_context.settings.general.screenScalings.end ()
-                                 ? scalingIt->second
-                                 : this->m_context.settings.render.window.scalingMode;
-        const auto clamp = clampIt != this->m_context.settings.general.screenClamps.end ()
-                               ? clampIt->second
-                               : this->m_context.settings.render.window.clamp;
-
-        if (this->m_renderContext) {
-            this->m_renderContext->setWallpaper (
-                screen,
-                WallpaperEngine::Render::CWallpaper::fromWallpaper (
-                    *this->m_backgrounds [screen]->wallpaper,
-                    *this->m_renderContext, *this->m_audioContext, this->m_browserContext.get (),
-                    scaling,
-                    clamp
-                )
-            );
-        }
-
-        this->m_context.settings.general.screenBackgrounds [screen] = nextPath;
+        this->switchWallpaper (screen, nextPath);
         loaded = true;
     } catch (const std::exception& e) {
         sLog.error ("Failed to advance playlist on ", screen, ": ", e.what ());
@@ -480,6 +584,8 @@ void WallpaperApplication::advancePlaylist (
 
     const uint32_t delayMinutes = std::max<uint32_t> (1, playlist.definition.settings.delayMinutes);
     playlist.nextSwitch = now + std::chrono::minutes (delayMinutes);
+
+    this->queuePreflight (playlist);
 }
 
 void WallpaperApplication::updatePlaylists () {
@@ -497,6 +603,9 @@ void WallpaperApplication::updatePlaylists () {
         if (playlist.definition.items.size () <= 1)
             continue;
 
+        if (now + PRELOAD_LEAD >= playlist.nextSwitch)
+            this->queuePreload (screen, playlist);
+
         if (now < playlist.nextSwitch)
             continue;
 
@@ -505,6 +614,9 @@ void WallpaperApplication::updatePlaylists () {
 }
 
 void WallpaperApplication::setupPropertiesForProject (const Project& project) {
+    // every override is applied before anything connected to the properties hears about them
+    DynamicValue::Batch batch;
+
     // show properties if required
     for (const auto& [key, cur] : project.properties) {
         // update the value of the property
@@ -520,21 +632,345 @@ void WallpaperApplication::setupPropertiesForProject (const Project& project) {
             sLog.out (cur->dump ());
         }
     }
+
+    // the wallpaper is built right after this, so it can't wait for the next frame
+    DynamicValue::flush ();
+}
+
+void WallpaperApplication::switchWallpaper (
+    const std::string& screen, const std::filesystem::path& path, const std::set<std::filesystem::path>* changed
+) {
+    if (!this->makeAnyViewportCurrent ()) {
+        sLog.error ("Cannot switch the wallpaper on ", screen, ": no active viewport");
+        throw std::runtime_error ("No viewport available");
+    }
+
+    // a reload keeps the screen's preload, the background after this one is still coming
+    auto project = changed != nullptr ? this->loadBackground (path.string ()) : this->takePreload (screen, path);
+
+    this->setupPropertiesForProject (*project);
+    this->ensureBrowserForProject (*project);
+
+    const auto scalingIt = this->m_context.settings.general.screenScalings.find (screen);
+    const auto clampIt = this->m_context.settings.general.screenClamps.find (screen);
+    const auto scaling = scalingIt != this->m_context.settings.general.screenScalings.end ()
+                             ? scalingIt->second
+                             : this->m_context.settings.render.window.scalingMode;
+    const auto clamp = clampIt != this->m_context.settings.general.screenClamps.end ()
+                           ? clampIt->second
+                           : this->m_context.settings.render.window.clamp;
+
+    // the old background stays until the new one is built, its wallpaper keeps using it
+    if (this->m_renderContext) {
+        if (const auto current = this->m_backgrounds.find (screen);
+            changed != nullptr && current != this->m_backgrounds.end ())
+            this->m_renderContext->getTextureCache ().carryOver (*current->second, *project, *changed);
+
+        auto wallpaper = WallpaperEngine::Render::CWallpaper::fromWallpaper (
+            *project->wallpaper, *this->m_renderContext, *this->m_audioContext, this->m_browserContext.get (),
+            scaling, clamp, false);
+
+        // a switch that's still being built is replaced by the newer one
+        this->m_loading.insert_or_assign (
+            screen, Loading {.path = path, .project = std::move (project), .wallpaper = std::move (wallpaper)});
+        return;
+    }
+
+    this->m_backgrounds [screen] = std::move (project);
+
+    // window mode has no screens, the default background stays the one it started with
+    if (const auto it = this->m_context.settings.general.screenBackgrounds.find (screen);
+        it != this->m_context.settings.general.screenBackgrounds.end ())
+        it->second = path;
+}
+
+void WallpaperApplication::updateLoading () {
+    if (this->m_loading.empty () || !this->makeAnyViewportCurrent ())
+        return;
+
+    const auto deadline = std::chrono::steady_clock::now () + LOAD_SLICE;
+
+    for (auto it = this->m_loading.begin (); it != this->m_loading.end ();) {
+        auto& [screen, loading] = *it;
+
+        try {
+            if (!loading.wallpaper->load (deadline)) {
+                ++it;
+                continue;
+            }
+        } catch (const std::exception& e) {
+            sLog.error ("Cannot switch the wallpaper on ", screen, " to ", loading.path, ": ", e.what ());
+            it = this->m_loading.erase (it);
+            continue;
+        }
+
+        this->m_renderContext->setWallpaper (screen, std::move (loading.wallpaper));
+        this->m_backgrounds [screen] = std::move (loading.project);
+
+        // window mode has no screens, the default background stays the one it started with
+        if (const auto background = this->m_context.settings.general.screenBackgrounds.find (screen);
+            background != this->m_context.settings.general.screenBackgrounds.end ())
+            background->second = loading.path;
+
+        it = this->m_loading.erase (it);
+    }
+}
+
+void WallpaperApplication::reloadChangedBackgrounds () {
+    if (!this->m_projectWatcher)
+        return;
+
+    // switches and playlists change the folders to follow
+    for (const auto& [screen, project] : this->m_backgrounds)
+        this->m_projectWatcher->watch (screen, project->path);
+
+    for (const auto& [screen, changes] : this->m_projectWatcher->takeChanges ()) {
+        sLog.out ("Reloading the background on ", screen, ", ", changes.files.size (), " files changed");
+
+        try {
+            this->switchWallpaper (screen, changes.directory, &changes.files);
+        } catch (const std::exception& e) {
+            // half saved files are common while editing, the current one stays until the next save
+            sLog.error ("Cannot reload the background on ", screen, ": ", e.what ());
+        }
+    }
+}
+
+void WallpaperApplication::applyControlCommands () {
+    if (this->m_controlSocket == nullptr)
+        return;
+
+    std::vector<std::pair<std::string, std::string>> changes = {};
+    std::vector<std::pair<std::string, std::filesystem::path>> switches = {};
+
+    for (auto& command : this->m_controlSocket->takeCommands ()) {
+        switch (command.type) {
+            case ControlSocket::Command::SetProperty:
+                changes.emplace_back (std::move (command.name), std::move (command.value));
+                break;
+            case ControlSocket::Command::SetWallpaper:
+                switches.emplace_back (std::move (command.name), std::move (command.value));
+                break;
+            case ControlSocket::Command::Pause:
+                sLog.out ("Paused by the control socket");
+                this->m_userPaused = true;
+                break;
+            case ControlSocket::Command::Resume:
+                sLog.out ("Resumed by the control socket");
+                this->m_userPaused = false;
+                break;
+        }
+    }
+
+    this->applyPropertyChanges (changes);
+
+    // the new backgrounds come from the same render context, so shaders, textures and base assets are still cached
+    for (const auto& [screen, path] : switches) {
+        if (!this->m_renderContext->getWallpapers ().contains (screen)) {
+            sLog.error ("Cannot switch the wallpaper on ", screen, ", there's no such screen");
+            continue;
+        }
+
+        // picking a background by hand ends the screen's playlist
+        this->m_activePlaylists.erase (screen);
+
+        try {
+            this->switchWallpaper (screen, path);
+            sLog.out ("Switching the wallpaper on ", screen, " to ", path);
+        } catch (const std::exception& e) {
+            sLog.error ("Cannot switch the wallpaper on ", screen, " to ", path, ": ", e.what ());
+        }
+    }
+
+    if (!switches.empty ())
+        DynamicValue::flush ();
+}
+
+void WallpaperApplication::applyPropertyChanges (const std::vector<std::pair<std::string, std::string>>& changes) {
+    if (changes.empty ())
+        return;
+
+    if (this->m_inputRecording != nullptr && !this->m_inputRecording->isReplaying ())
+        this->m_inputFrame.properties.insert (this->m_inputFrame.properties.end (), changes.begin (), changes.end ());
+
+    {
+        // several changes sent together only reach the values connected to them once
+        DynamicValue::Batch batch;
+
+        for (const auto& [name, value] : changes) {
+            bool found = false;
+
+            for (const auto& [screen, project] : this->m_backgrounds) {
+                const auto property = project->properties.find (name);
+
+                if (property == project->properties.end ())
+                    continue;
+
+                found = true;
+
+                try {
+                    property->second->update (value);
+                } catch (const std::exception& e) {
+                    sLog.error ("Cannot set property ", name, " to ", value, ": ", e.what ());
+                }
+            }
+
+            if (!found) {
+                sLog.error ("Cannot change property ", name, ", no background has it");
+                continue;
+            }
+
+            sLog.out ("Changed property ", name, " to ", value);
+
+            // backgrounds loaded later on, like the next one in a playlist, get it too
+            this->m_context.settings.general.properties [name] = value;
+        }
+    }
+
+    DynamicValue::flush ();
+
+    // uniforms follow the new values by themselves, things like effects being shown or hidden need the wallpaper
+    // built again
+    this->rebuildWallpapers ();
+}
+
+void WallpaperApplication::rebuildWallpapers () {
+    // the project isn't parsed again and the shaders and textures come from the render context's caches
+    std::map<const Render::CWallpaper*, std::shared_ptr<Render::CWallpaper>> rebuilt = {};
+    std::vector<std::pair<std::string, std::shared_ptr<Render::CWallpaper>>> replacements = {};
+
+    for (const auto& [screen, wallpaper] : this->m_renderContext->getWallpapers ()) {
+        const auto project = this->m_backgrounds.find (screen);
+
+        if (project == this->m_backgrounds.end ())
+            continue;
+
+        // screens sharing a wallpaper keep sharing the new one
+        if (const auto existing = rebuilt.find (wallpaper.get ()); existing != rebuilt.end ()) {
+            if (existing->second != nullptr)
+                replacements.emplace_back (screen, existing->second);
+
+            continue;
+        }
+
+        if (!wallpaper->takeRebuildRequest ())
+            continue;
+
+        auto& replacement = rebuilt [wallpaper.get ()];
+
+        try {
+            if (!this->makeAnyViewportCurrent ())
+                throw std::runtime_error ("No viewport available");
+
+            const auto scalingIt = this->m_context.settings.general.screenScalings.find (screen);
+            const auto clampIt = this->m_context.settings.general.screenClamps.find (screen);
+
+            replacement = WallpaperEngine::Render::CWallpaper::fromWallpaper (
+                *project->second->wallpaper, *this->m_renderContext, *this->m_audioContext,
+                this->m_browserContext.get (),
+                scalingIt != this->m_context.settings.general.screenScalings.end ()
+                    ? scalingIt->second
+                    : this->m_context.settings.render.window.scalingMode,
+                clampIt != this->m_context.settings.general.screenClamps.end ()
+                    ? clampIt->second
+                    : this->m_context.settings.render.window.clamp
+            );
+            replacements.emplace_back (screen, replacement);
+        } catch (const std::exception& e) {
+            sLog.error ("Cannot rebuild the wallpaper on ", screen, ", keeping the current one: ", e.what ());
+        }
+    }
+
+    // not while going through the wallpapers, setWallpaper changes the map
+    for (const auto& [screen, wallpaper] : replacements) {
+        sLog.out ("Rebuilding the wallpaper on ", screen);
+        this->m_renderContext->setWallpaper (screen, wallpaper);
+    }
+}
+
+void WallpaperApplication::applyPowerProfile () {
+    auto& power = this->m_context.state.power;
+    const bool reduced = this->m_powerMonitor->getProfile () != PowerMonitor::Profile_Normal;
+
+    if (power.reduced == reduced)
+        return;
+
+    power.reduced = reduced;
+    // the frame pacers pick the FPS up on the next frame, the rest is only read when a scene is built
+    power.fpsScale = reduced ? 0.5f : 1.0f;
+    power.renderScale = reduced ? 0.75f : 1.0f;
+    power.particleBudget = reduced ? 5000 : 0;
+    power.bloomLevels = reduced ? 3 : 0;
+
+    // before the first frame there's nothing built yet
+    if (this->m_renderContext == nullptr)
+        return;
+
+    for (const auto& wallpaper : this->m_renderContext->getWallpapers () | std::views::values)
+        if (wallpaper->is<Render::Wallpapers::CScene> ())
+            wallpaper->requestRebuild ();
+
+    this->rebuildWallpapers ();
+}
+
+void WallpaperApplication::applyPowerPause () const {
+    if (!this->m_context.settings.general.powerPauseVideo)
+        return;
+
+    // every frame so backgrounds switched to or resumed after a pause are caught too, it does nothing if it's the same
+    for (const auto& wallpaper : this->m_renderContext->getWallpapers () | std::views::values)
+        if (wallpaper->is<Render::Wallpapers::CVideo> () || wallpaper->is<Render::Wallpapers::CWeb> ())
+            wallpaper->setPause (this->m_context.state.power.reduced);
 }
 
 void WallpaperApplication::setupProperties () {
-    for (const auto& [background, info] : this->m_backgrounds)
-        this->setupPropertiesForProject (*info);
+    std::set<const Project*> done;
+
+    // screens sharing a project only apply its overrides once
+    for (const auto& info : this->m_backgrounds | std::views::values)
+        if (done.insert (info.get ()).second)
+            this->setupPropertiesForProject (*info);
+}
+
+void WallpaperApplication::dumpStructure () const {
+    // printed from the parsed model, so nothing has to be loaded into the GPU for it
+    auto prettyPrinter = Data::Dumpers::StringPrinter (std::cout);
+
+    for (const auto& [background, project] : this->m_backgrounds)
+        prettyPrinter.printWallpaper (*project->wallpaper);
+
+    std::cout << std::endl;
+}
+
+bool WallpaperApplication::anyWebBackgroundQueued () const {
+    std::vector<std::filesystem::path> paths = this->m_context.settings.screenshot.previews;
+
+    if (this->m_context.settings.general.defaultPlaylist.has_value ())
+        paths.insert (
+            paths.end (), this->m_context.settings.general.defaultPlaylist->items.begin (),
+            this->m_context.settings.general.defaultPlaylist->items.end ());
+
+    for (const auto& playlist : this->m_context.settings.general.screenPlaylists | std::views::values)
+        paths.insert (paths.end (), playlist.items.begin (), playlist.items.end ());
+
+    // the index knows the type of everything preflighted before, only new or changed items are parsed
+    return std::ranges::any_of (paths, [this] (const std::filesystem::path& path) {
+        return this->indexWallpaper (path).type == "web";
+    });
 }
 
 void WallpaperApplication::setupBrowser () {
     bool anyWebProject = std::any_of (
         this->m_backgrounds.begin (), this->m_backgrounds.end (),
-        [](const std::pair<const std::string, ProjectUniquePtr>& pair) -> bool {
+        [](const std::pair<const std::string, ProjectSharedPtr>& pair) -> bool {
             return pair.second->wallpaper->is<Web> ();
         }
     );
 
+    // starting CEF takes a while, better now than when the playlist switches to a web background
+    if (!anyWebProject && this->m_context.settings.general.warmBrowser)
+        anyWebProject = this->anyWebBackgroundQueued ();
+
     // do not perform any initialization if no web background is present
     if (!anyWebProject || this->m_browserContext) {
         return;
@@ -609,6 +1045,61 @@ void WallpaperApplication::takeScreenshot (const std::filesystem::path& filename
     delete [] bitmap;
 }
 
+void WallpaperApplication::updatePreviews () {
+    const auto& settings = this->m_context.settings;
+    const auto frames = std::max<uint32_t> (
+        1, static_cast<uint32_t> (settings.screenshot.previewTime * static_cast<float> (settings.render.maximumFPS)));
+
+    // the preview should show the real textures, not the placeholders
+    if (++this->m_previewFrames < frames || this->m_renderContext->isStreaming ())
+        return;
+
+    // backgrounds given as folders with a trailing slash have no filename of their own
+    const auto name = (settings.screenshot.previews [this->m_previewIndex] / "").parent_path ().filename ();
+
+    this->m_previewWriter->capture (*this->m_renderContext->getWallpapers ().at ("default"), name.string ());
+    this->startNextPreview ();
+}
+
+void WallpaperApplication::startNextPreview () {
+    const auto& previews = this->m_context.settings.screenshot.previews;
+
+    while (++this->m_previewIndex < previews.size ()) {
+        const auto& path = previews [this->m_previewIndex];
+
+        try {
+            auto project = this->takePreload ("default", path);
+
+            // parsing the one after this overlaps with simulating this one
+            if (this->m_previewIndex + 1 < previews.size ())
+                this->queuePreload ("default", previews [this->m_previewIndex + 1]);
+
+            this->setupPropertiesForProject (*project);
+            this->ensureBrowserForProject (*project);
+
+            // shaders, textures and the base assets stay cached in the render context from the backgrounds before
+            this->m_renderContext->setWallpaper (
+                "default",
+                WallpaperEngine::Render::CWallpaper::fromWallpaper (
+                    *project->wallpaper, *this->m_renderContext, *this->m_audioContext, this->m_browserContext.get (),
+                    this->m_context.settings.render.window.scalingMode, this->m_context.settings.render.window.clamp
+                )
+            );
+            this->m_backgrounds ["default"] = std::move (project);
+            this->m_previewFrames = 0;
+            return;
+        } catch (const std::exception& e) {
+            sLog.error ("Cannot render the preview of ", path, ": ", e.what ());
+
+            // a failed load doesn't get to queue the one after it
+            if (this->m_previewIndex + 1 < previews.size ())
+                this->queuePreload ("default", previews [this->m_previewIndex + 1]);
+        }
+    }
+
+    this->m_context.state.general.keepRunning = false;
+}
+
 void WallpaperApplication::setupOutput () {
     const char* XDG_SESSION_TYPE = getenv ("XDG_SESSION_TYPE");
 
@@ -626,19 +1117,80 @@ void WallpaperApplication::setupOutput () {
     this->m_videoDriver = sVideoFactories.createVideoDriver (
         this->m_context.settings.render.mode, XDG_SESSION_TYPE, this->m_context, *this);
     this->m_fullScreenDetector = sVideoFactories.createFullscreenDetector (XDG_SESSION_TYPE, this->m_context, *this->m_videoDriver);
+
+    if (this->m_inputRecording != nullptr && this->m_inputRecording->isReplaying ())
+        this->m_videoDriver->getInputContext ().setMouseInput (this->m_replayMouse);
+
+    // the driver left its context current, so this is the GPU that ended up doing the work
+    const auto renderer = reinterpret_cast<const char*> (glGetString (GL_RENDERER));
+    sLog.out ("Rendering on ", renderer != nullptr ? renderer : "an unknown GPU");
+}
+
+void WallpaperApplication::setupInputRecording () {
+    const auto& general = this->m_context.settings.general;
+    auto& particleSeed = this->m_context.settings.render.particleSeed;
+
+    if (!general.replayInput.empty ()) {
+        this->m_inputRecording = std::make_unique <Debugging::InputRecording> (general.replayInput);
+    } else if (!general.recordInput.empty ()) {
+        std::random_device device;
+        // without --particle-seed the run gets a random one, it's stored so the replay gets the same
+        const uint64_t seed = particleSeed.value_or ((static_cast<uint64_t> (device ()) << 32) | device ());
+
+        this->m_inputRecording = std::make_unique <Debugging::InputRecording> (general.recordInput, seed);
+    } else {
+        return;
+    }
+
+    particleSeed = this->m_inputRecording->getSeed ();
+    this->m_playlistRng.seed (this->m_inputRecording->getSeed ());
+}
+
+bool WallpaperApplication::replayInputFrame () {
+    if (!this->m_inputRecording->read (this->m_inputFrame))
+        return false;
+
+    g_Time = this->m_inputFrame.time;
+    g_Daytime = this->m_inputFrame.daytime;
+    this->m_replayMouse.set (this->m_inputFrame.mouse, this->m_inputFrame.leftClick, this->m_inputFrame.rightClick);
+
+    return true;
+}
+
+void WallpaperApplication::recordInputFrame () {
+    const auto& mouse = this->m_videoDriver->getInputContext ().getMouseInput ();
+
+    this->m_inputFrame.time = g_Time;
+    this->m_inputFrame.daytime = g_Daytime;
+    this->m_inputFrame.mouse = mouse.position ();
+    this->m_inputFrame.leftClick = mouse.leftClick ();
+    this->m_inputFrame.rightClick = mouse.rightClick ();
+    Debugging::InputRecording::captureSpectrum (this->m_audioDriver->getRecorder (), this->m_inputFrame);
+
+    this->m_inputRecording->write (this->m_inputFrame);
 }
 
 void WallpaperApplication::setupAudio () {
     // ensure audioprocessing is required by any background, and we have it enabled
     const bool audioProcessingRequired = std::ranges::any_of (
         this->m_backgrounds,
-        [](const std::pair<const std::string, ProjectUniquePtr>& pair) -> bool {
+        [](const std::pair<const std::string, ProjectSharedPtr>& pair) -> bool {
             return pair.second->supportsAudioProcessing;
         }
     );
 
     if (audioProcessingRequired && this->m_context.settings.audio.audioprocessing) {
+#ifdef ENABLE_PIPEWIRE
+        if (this->m_context.settings.audio.pipewireCapture)
+            this->m_audioRecorder = std::make_unique <WallpaperEngine::Audio::Drivers::Recorders::PipeWirePlaybackRecorder> ();
+        else
+            this->m_audioRecorder = std::make_unique <WallpaperEngine::Audio::Drivers::Recorders::PulseAudioPlaybackRecorder> ();
+#else
+        if (this->m_context.settings.audio.pipewireCapture)
+            sLog.error ("Built without PipeWire support, audio processing captures through PulseAudio instead");
+
         this->m_audioRecorder = std::make_unique <WallpaperEngine::Audio::Drivers::Recorders::PulseAudioPlaybackRecorder> ();
+#endif /* ENABLE_PIPEWIRE */
     } else {
         this->m_audioRecorder = std::make_unique <WallpaperEngine::Audio::Drivers::Recorders::PlaybackRecorder> ();
     }
@@ -655,10 +1207,40 @@ void WallpaperApplication::setupAudio () {
     m_audioContext = std::make_unique <WallpaperEngine::Audio::AudioContext> (*m_audioDriver);
 }
 
+void WallpaperApplication::setupControlThread () {
+    std::vector<std::string> screens = {};
+
+    for (const auto& screen : this->m_context.settings.general.screenBackgrounds | std::views::keys)
+        screens.push_back (screen);
+
+    this->m_controlThread = std::make_unique <ControlThread> (*this->m_fullScreenDetector, *this->m_audioDetector, screens);
+    this->m_controlThread->start ();
+}
+
 void WallpaperApplication::prepareOutputs () {
     // initialize render context
-    m_renderContext = std::make_unique <WallpaperEngine::Render::RenderContext> (*m_videoDriver, *this);
-    // create a new background for each screen
+    {
+        std::scoped_lock lock (this->m_loadTimesMutex);
+
+        m_renderContext = std::make_unique <WallpaperEngine::Render::RenderContext> (*m_videoDriver, *this);
+
+        for (const auto& time : this->m_loadTimes)
+            m_renderContext->getStats ().addLoad (time);
+
+        this->m_loadTimes.clear ();
+    }
+    // create a new background for each screen, screens showing the same background at the same size and scaling
+    // share one so the scene is only rendered once and every screen just draws the result
+    struct Shared {
+        std::filesystem::path path;
+        WallpaperEngine::Render::WallpaperState::TextureUVsScaling scaling;
+        uint32_t clamp;
+        glm::ivec2 size;
+        std::shared_ptr <WallpaperEngine::Render::CWallpaper> wallpaper;
+    };
+
+    std::vector<Shared> shared = {};
+    const auto& viewports = m_renderContext->getOutput ().getViewports ();
 
     // set all the specific wallpapers required
     for (const auto& [background, info] : this->m_backgrounds) {
@@ -670,15 +1252,45 @@ void WallpaperApplication::prepareOutputs () {
         const auto clamp = clampIt != this->m_context.settings.general.screenClamps.end ()
                                ? clampIt->second
                                : this->m_context.settings.render.window.clamp;
+        const auto pathIt = this->m_context.settings.general.screenBackgrounds.find (background);
+        const auto viewport = viewports.find (background);
+        std::filesystem::path path = this->m_context.settings.general.defaultBackground;
 
-        m_renderContext->setWallpaper (
-            background,
+        if (pathIt != this->m_context.settings.general.screenBackgrounds.end () && !pathIt->second.empty ())
+            path = pathIt->second;
+
+        if (viewport == viewports.end ()) {
+            m_renderContext->setWallpaper (
+                background,
+                WallpaperEngine::Render::CWallpaper::fromWallpaper (
+                    *info->wallpaper, *m_renderContext, *m_audioContext, m_browserContext.get (),
+                    scaling,
+                    clamp
+                )
+            );
+            continue;
+        }
+
+        const glm::ivec2 size = {viewport->second->viewport.z, viewport->second->viewport.w};
+        const auto existing = std::ranges::find_if (shared, [&] (const Shared& entry) {
+            return entry.path == path && entry.scaling == scaling && entry.clamp == clamp && entry.size == size;
+        });
+
+        if (existing != shared.end ()) {
+            sLog.out ("Screen ", background, " mirrors the wallpaper of another screen, sharing its render");
+            m_renderContext->setWallpaper (background, existing->wallpaper);
+            continue;
+        }
+
+        std::shared_ptr <WallpaperEngine::Render::CWallpaper> wallpaper =
             WallpaperEngine::Render::CWallpaper::fromWallpaper (
                 *info->wallpaper, *m_renderContext, *m_audioContext, m_browserContext.get (),
                 scaling,
                 clamp
-            )
-        );
+            );
+
+        shared.push_back ({path, scaling, clamp, size, wallpaper});
+        m_renderContext->setWallpaper (background, wallpaper);
     }
 }
 
@@ -691,38 +1303,83 @@ void WallpaperApplication::setupOpenGLDebugging () {
 
 
 void WallpaperApplication::show () {
-    this->setupOutput ();
-    this->setupAudio ();
-    this->prepareOutputs ();
-    this->setupOpenGLDebugging ();
+    {
+        TRACE_SCOPE ("WallpaperApplication::setup");
+
+        this->setupOutput ();
+        this->setupAudio ();
+        this->setupControlThread ();
+
+        // the first scenes are already built with the right settings
+        if (this->m_context.settings.general.powerProfiles) {
+            this->m_powerMonitor = std::make_unique <PowerMonitor> ();
+            this->m_powerMonitor->update ();
+            this->applyPowerProfile ();
+        }
 
-    static time_t seconds;
-    static struct tm* timeinfo;
+        this->prepareOutputs ();
+        this->setupOpenGLDebugging ();
+
+        if (!this->m_context.settings.general.statsSocket.empty ()) {
+            this->m_statsSocket = std::make_unique <StatsSocket> (
+                this->m_renderContext->getStats (), this->m_context.settings.general.statsSocket);
+            this->m_statsSocket->start ();
+        }
+
+        if (!this->m_context.settings.general.metrics.empty ()) {
+            this->m_metricsServer = std::make_unique <MetricsServer> (
+                this->m_renderContext->getStats (), this->m_context.settings.general.metrics);
+            this->m_metricsServer->start ();
+        }
 
-    if (this->m_context.settings.general.dumpStructure) {
-        auto prettyPrinter = Data::Dumpers::StringPrinter ();
+        if (this->m_context.settings.general.watch)
+            this->m_projectWatcher = std::make_unique <ProjectWatcher> ();
 
-        for (const auto& [background, info] : this->m_renderContext->getWallpapers ()) {
-            prettyPrinter.printWallpaper (info->getWallpaperData ());
+        if (!this->m_context.settings.general.controlSocket.empty ()) {
+            this->m_controlSocket = std::make_unique <ControlSocket> (
+                this->m_renderContext->getStats (), this->m_context.settings.general.controlSocket);
+            this->m_controlSocket->start ();
         }
 
-        std::cout << prettyPrinter.str () << std::endl;
+        if (const auto& previews = this->m_context.settings.screenshot.previews; !previews.empty ()) {
+            this->m_previewWriter = std::make_unique <PreviewWriter> (
+                this->m_context.settings.screenshot.previewDirectory, this->m_context.settings.screenshot.previewWidth);
+
+            if (previews.size () > 1)
+                this->queuePreload ("default", previews [1]);
+        }
     }
 
+    static time_t seconds;
+    static struct tm* timeinfo;
+
 #if DEMOMODE
     // ensure only one background is running so everything can be properly caught
     if (this->m_renderContext->getWallpapers ().size () > 1) {
         sLog.exception ("Demo mode only supports one background");
     }
 
-    int width = this->m_renderContext->getWallpapers ().begin ()->second->getWidth ();
-    int height = this->m_renderContext->getWallpapers ().begin ()->second->getHeight ();
-    std::vector<uint8_t> pixels(width * height * 3);
     bool initialized = false;
     int frame = 0;
 #endif /* DEMOMODE */
 
+    const bool profileAllocations = this->m_context.settings.general.profileAllocations;
+
+    if (profileAllocations)
+        Debugging::AllocationProfiler::start ();
+
+    const bool detectHitches = !this->m_context.settings.general.hitchTraces.empty ();
+
+    if (detectHitches)
+        sTracer.startRing (HITCH_WINDOW);
+
     while (this->m_context.state.general.keepRunning) {
+        TRACE_SCOPE ("WallpaperApplication::show");
+
+        // the frames skip ahead in a few places, so the previous one is closed here instead
+        if (profileAllocations)
+            Debugging::AllocationProfiler::endFrame ();
+
         // update g_Daytime
         time (&seconds);
         timeinfo = localtime (&seconds);
@@ -732,13 +1389,55 @@ void WallpaperApplication::show () {
         g_TimeLast = g_Time;
         // calculate the current time value
         g_Time = m_videoDriver->getRenderTime ();
-        // update audio recorder
-        m_audioDriver->update ();
+
+        const bool replaying = this->m_inputRecording != nullptr && this->m_inputRecording->isReplaying ();
+        const bool recording = this->m_inputRecording != nullptr && !replaying;
+
+        // the clock, daytime and mouse are the recorded run's
+        if (replaying && !this->replayInputFrame ()) {
+            sLog.out ("The input recording is over");
+            this->m_context.state.general.keepRunning = false;
+            continue;
+        }
+
+        m_renderContext->beginFrame ();
+        this->applyControlCommands ();
+
+        if (replaying)
+            this->applyPropertyChanges (this->m_inputFrame.properties);
+
+        if (this->m_powerMonitor != nullptr && this->m_powerMonitor->update ())
+            this->applyPowerProfile ();
+
+        // property changes batched since the last frame reach the values connected to them before anything renders
+        DynamicValue::flush ();
+        {
+            TRACE_SCOPE ("AudioDriver::update");
+            Render::FrameStats::Scope stats (m_renderContext->getStats (), Render::FrameStats::Phase_Audio);
+
+            // update audio recorder
+            m_audioDriver->update ();
+
+            // whatever is playing now is replaced with what was playing back then
+            if (replaying)
+                Debugging::InputRecording::applySpectrum (this->m_inputFrame, m_audioDriver->getRecorder ());
+
+            m_renderContext->getStats ().setAudio (
+                m_audioDriver->getBufferTime (), m_audioDriver->getUnderruns (), m_audioDriver->getLateCallbacks (),
+                m_audioDriver->isRealtime ());
+        }
         // update input information
         m_videoDriver->getInputContext ().update ();
+
+        if (recording)
+            this->recordInputFrame ();
+
         // process driver events
         m_videoDriver->dispatchEventQueue ();
 
+        if (detectHitches)
+            this->checkHitch ();
+
         if (m_videoDriver->closeRequested()) {
             sLog.out ("Stop requested by driver");
             this->m_context.state.general.keepRunning = false;
@@ -749,19 +1448,18 @@ void WallpaperApplication::show () {
         // this gives some extra time for video and web decoders to set themselves up
         // because of size changes
         if (m_videoDriver->getFrameCounter () > (uint32_t) this->m_context.settings.render.maximumFPS) {
+            const auto& wallpaper = this->m_renderContext->getWallpapers ().begin ()->second;
+
             if (!initialized) {
-                width = this->m_renderContext->getWallpapers ().begin ()->second->getWidth ();
-                height = this->m_renderContext->getWallpapers ().begin ()->second->getHeight ();
-                pixels.reserve(width * height * 3);
-                init_encoder ("output.webm", width, height);
+                // the framebuffer's own size, with a render scale it's not the scene's
+                const auto fbo = wallpaper->getFBO ();
+
+                init_encoder ("output.webm", fbo->getRealWidth (), fbo->getRealHeight ());
                 initialized = true;
             }
 
-            glBindFramebuffer (GL_FRAMEBUFFER, this->m_renderContext->getWallpapers ().begin ()->second->getWallpaperFramebuffer());
-
-            glPixelStorei (GL_PACK_ALIGNMENT, 1);
-            glReadPixels (0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data ());
-            write_video_frame (pixels.data ());
+            // only queues the readback, the frame is encoded on another thread once it's back
+            capture_video_frame (wallpaper->getWallpaperFramebuffer ());
             frame ++;
 
             // stop after the given framecount
@@ -771,14 +1469,21 @@ void WallpaperApplication::show () {
         }
 #endif /* DEMOMODE */
         // check for fullscreen windows and wait until there's none fullscreen
-        if (this->m_fullScreenDetector->anythingFullscreen () && this->m_context.state.general.keepRunning) {
+        if ((this->m_userPaused || this->nothingVisible ()) && this->m_context.state.general.keepRunning) {
             this->m_isPaused = true;
             this->m_pauseStart = std::chrono::steady_clock::now ();
 
             m_renderContext->setPause (true);
-            while (this->m_fullScreenDetector->anythingFullscreen () && this->m_context.state.general.keepRunning)
-                usleep (FULLSCREEN_CHECK_WAIT_TIME);
+            m_renderContext->getStats ().setPaused (true);
+            // the control thread wakes this up as soon as something becomes visible
+            while ((this->m_userPaused || this->nothingVisible ()) && this->m_context.state.general.keepRunning) {
+                this->m_controlThread->waitForChange (FULLSCREEN_CHECK_WAIT_TIME);
+                m_renderContext->updatePaused ();
+                // resume comes through the control socket too
+                this->applyControlCommands ();
+            }
             m_renderContext->setPause (false);
+            m_renderContext->getStats ().setPaused (false);
 
             // account for paused duration in playlist timers
             const auto pausedNow = std::chrono::steady_clock::now ();
@@ -792,19 +1497,68 @@ void WallpaperApplication::show () {
             }
 
             this->m_isPaused = false;
+            // the time paused is no hitch
+            this->m_lastPresent = {};
         }
 
+        this->applyPowerPause ();
+
         this->updatePlaylists ();
+        this->reloadChangedBackgrounds ();
+        this->updateLoading ();
+
+        // the video memory taken is only known once everything is loaded, the model is printed before that
+        if (this->m_context.settings.general.dumpStructure && !this->m_resourcesDumped &&
+            !m_renderContext->isStreaming ()) {
+            sGPUResources.dump (std::cout);
+            this->m_resourcesDumped = true;
+        }
+
+        // the programs are built by the first frame, so once nothing streams anymore the backgrounds are ready
+        if (Debugging::LoadReport::isEnabled () && sLoadReport.isPending () && !m_renderContext->isStreaming ())
+            sLoadReport.print (this->describeBackgrounds ());
+
+        // every texture streamed in means every pass was drawn with its real inputs, so its program is built
+        if (this->m_context.settings.general.cook && !m_renderContext->isStreaming ()) {
+            sLog.out ("Backgrounds cooked, later launches load them from the cache");
+
+            if (this->m_context.settings.general.repack)
+                this->repackPackages ();
+
+            this->m_context.state.general.keepRunning = false;
+            continue;
+        }
+
+        if (this->m_previewWriter != nullptr) {
+            this->updatePreviews ();
+            continue;
+        }
 
         if (!this->m_context.settings.screenshot.take || m_videoDriver->getFrameCounter () < this->m_context.settings.screenshot.delay)
             continue;
 
+        // the screenshot should show the real textures, not the placeholders
+        if (m_renderContext->isStreaming ())
+            continue;
+
         this->takeScreenshot (this->m_context.settings.screenshot.path);
         this->m_context.settings.screenshot.take = false;
     }
 
+    if (profileAllocations)
+        Debugging::AllocationProfiler::stop ();
+
+    if (this->m_stopSignal != 0)
+        sLog.out ("Stop requested by signal ", static_cast<int> (this->m_stopSignal));
+
     sLog.out ("Stopping");
 
+    this->m_controlThread->stop ();
+
+    // the last images might still be on their way to disk
+    if (this->m_previewWriter != nullptr)
+        this->m_previewWriter->wait ();
+
 #if DEMOMODE
     close_encoder ();
 #endif /* DEMOMODE */
@@ -812,17 +1566,73 @@ void WallpaperApplication::show () {
     SDL_Quit ();
 }
 
-void WallpaperApplication::update (Render::Drivers::Output::OutputViewport* viewport) {
+bool WallpaperApplication::update (Render::Drivers::Output::OutputViewport* viewport) {
     // render the scene
-    m_renderContext->render (viewport);
+    const bool presented = m_renderContext->render (viewport);
+
+    this->m_framePresented = this->m_framePresented || presented;
+
+    return presented;
+}
+
+void WallpaperApplication::checkHitch () {
+    const auto now = std::chrono::steady_clock::now ();
+    const auto threshold = std::chrono::milliseconds (this->m_context.settings.general.hitchThreshold);
+
+    // frames that present nothing wait for input or a timeout afterwards, only the time between two presented frames
+    // is all work and frame pacing
+    if (!this->m_framePresented) {
+        this->m_lastPresent = {};
+    } else {
+        if (this->m_lastPresent != std::chrono::steady_clock::time_point {} && now - this->m_lastPresent > threshold) {
+            sLog.error (
+                "Frame took ", std::chrono::duration_cast<std::chrono::milliseconds> (now - this->m_lastPresent).count (),
+                "ms");
+
+            // hitches right after another one end up in the same trace
+            if (this->m_pendingHitch == std::chrono::steady_clock::time_point {})
+                this->m_pendingHitch = now;
+        }
+
+        this->m_lastPresent = now;
+    }
+
+    this->m_framePresented = false;
+
+    // the trace covers a bit of what happened after the hitch too
+    if (this->m_pendingHitch == std::chrono::steady_clock::time_point {} || now - this->m_pendingHitch < HITCH_AFTER)
+        return;
+
+    this->m_pendingHitch = {};
+
+    const auto stamp = std::chrono::duration_cast<std::chrono::milliseconds> (
+        std::chrono::system_clock::now ().time_since_epoch ()).count ();
+    const auto path = this->m_context.settings.general.hitchTraces / ("hitch-" + std::to_string (stamp) + ".json");
+
+    if (sTracer.dumpRing (path, now, this->describeBackgrounds ()))
+        sLog.out ("Hitch trace written to ", path);
+}
+
+std::string WallpaperApplication::describeBackgrounds () const {
+    std::string result;
+
+    for (const auto& [screen, project] : this->m_backgrounds) {
+        if (!result.empty ())
+            result += ", ";
+
+        result += screen + ": " + project->title + " (" + project->workshopId + ")";
+    }
+
+    return result;
 }
 
 void WallpaperApplication::signal (int signal) {
-    sLog.out ("Stop requested by signal ", signal);
+    // logging takes the log's lock, which the interrupted thread might be holding, so it waits for the loop to end
+    this->m_stopSignal = signal;
     this->m_context.state.general.keepRunning = false;
 }
 
-const std::map<std::string, ProjectUniquePtr>& WallpaperApplication::getBackgrounds () const {
+const std::map<std::string, ProjectSharedPtr>& WallpaperApplication::getBackgrounds () const {
     return this->m_backgrounds;
 }
 
@@ -830,6 +1640,27 @@ ApplicationContext& WallpaperApplication::getContext () const {
     return this->m_context;
 }
 
+WallpaperEngine::Render::RenderContext& WallpaperApplication::getRenderContext () const {
+    return *this->m_renderContext;
+}
+
 const WallpaperEngine::Render::Drivers::Output::Output& WallpaperApplication::getOutput () const {
     return this->m_renderContext->getOutput ();
 }
+
+bool WallpaperApplication::isVisible (const std::string& screen) const {
+    return this->m_controlThread->isVisible (screen);
+}
+
+bool WallpaperApplication::nothingVisible () const {
+    const auto& screens = this->m_context.settings.general.screenBackgrounds;
+
+    // window mode has no screens to tell apart
+    if (screens.empty ())
+        return this->m_controlThread->anythingFullscreen ();
+
+    // the drivers stop the hidden screens by themselves while others can still be seen
+    return std::ranges::none_of (screens | std::views::keys, [this] (const std::string& screen) {
+        return this->m_controlThread->isVisible (screen);
+    });
+}
@@ -1,10 +1,23 @@
 #pragma once
 
 #include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <mutex>
 #include <random>
 
 #include "WallpaperEngine/Application/ApplicationContext.h"
+#include "WallpaperEngine/Application/ControlSocket.h"
+#include "WallpaperEngine/Application/ControlThread.h"
+#include "WallpaperEngine/Application/PowerMonitor.h"
+#include "WallpaperEngine/Application/MetricsServer.h"
+#include "WallpaperEngine/Application/PreviewWriter.h"
+#include "WallpaperEngine/Application/ProjectWatcher.h"
+#include "WallpaperEngine/Application/StatsSocket.h"
+#include "WallpaperEngine/Application/WorkshopIndex.h"
 #include "WallpaperEngine/Assets/AssetLocator.h"
+#include "WallpaperEngine/Debugging/InputRecording.h"
+#include "WallpaperEngine/FileSystem/Adapters/Package.h"
 
 #include "WallpaperEngine/Render/CWallpaper.h"
 #include "WallpaperEngine/Render/Drivers/Detectors/FullScreenDetector.h"
@@ -14,13 +27,19 @@
 
 #include "WallpaperEngine/Audio/Drivers/SDLAudioDriver.h"
 
+#include "WallpaperEngine/Input/Drivers/ReplayMouseInput.h"
 #include "WallpaperEngine/Input/InputContext.h"
 #include "WallpaperEngine/WebBrowser/WebBrowserContext.h"
 
 #include "WallpaperEngine/Data/Model/Types.h"
+#include "WallpaperEngine/Threading/JobPool.h"
 
 #include <set>
 
+namespace WallpaperEngine::Testing::Harnesses {
+class RenderHarness;
+} // namespace WallpaperEngine::Testing::Harnesses
+
 namespace WallpaperEngine::Application {
 using namespace WallpaperEngine::Assets;
 using namespace WallpaperEngine::Data::Model;
@@ -28,8 +47,12 @@ using namespace WallpaperEngine::Data::Model;
  * Small wrapper class over the actual wallpaper's main application skeleton
  */
 class WallpaperApplication {
+    /** renders through its own driver, so it does the setup show () would */
+    friend class WallpaperEngine::Testing::Harnesses::RenderHarness;
+
   public:
     explicit WallpaperApplication (ApplicationContext& context);
+    ~WallpaperApplication ();
 
     /**
      * Shows the application until it's closed
@@ -44,19 +67,31 @@ class WallpaperApplication {
     /**
      * @return Maps screens to loaded backgrounds
      */
-    [[nodiscard]] const std::map<std::string, ProjectUniquePtr>& getBackgrounds () const;
+    [[nodiscard]] const std::map<std::string, ProjectSharedPtr>& getBackgrounds () const;
     /**
      * @return The current application context
      */
     [[nodiscard]] ApplicationContext& getContext () const;
+    /**
+     * @return The render context the wallpapers are drawn with
+     */
+    [[nodiscard]] WallpaperEngine::Render::RenderContext& getRenderContext () const;
     /**
      * Renders a frame
+     *
+     * @return If the frame changed and was presented
      */
-    void update (Render::Drivers::Output::OutputViewport* viewport);
+    bool update (Render::Drivers::Output::OutputViewport* viewport);
     /**
      * Gets the output
      */
     [[nodiscard]] const WallpaperEngine::Render::Drivers::Output::Output& getOutput () const;
+    /**
+     * @param screen
+     *
+     * @return If the background on the screen can be seen, as of the last check of the ControlThread
+     */
+    [[nodiscard]] bool isVisible (const std::string& screen) const;
 
   private:
     /**
@@ -66,7 +101,11 @@ class WallpaperApplication {
      */
     AssetLocatorUniquePtr setupAssetLocator (const std::string& bg) const;
     /**
-     * Loads projects based off the settings
+     * Writes every package the backgrounds were loaded from again, in the order their files were read, for --repack
+     */
+    void repackPackages () const;
+    /**
+     * Loads projects based off the settings, the different backgrounds are parsed in parallel
      */
     void loadBackgrounds ();
     /**
@@ -86,6 +125,51 @@ class WallpaperApplication {
      * @param project
      */
     void setupPropertiesForProject (const Project& project);
+    /**
+     * Runs the commands received on the control socket since the last frame
+     */
+    void applyControlCommands ();
+    /**
+     * Applies the property changes to every background that has them, rebuilding the wallpapers that can't follow a
+     * change on their own
+     *
+     * @param changes
+     */
+    void applyPropertyChanges (const std::vector<std::pair<std::string, std::string>>& changes);
+    /**
+     * Opens the recording for --record-input or --replay-input, the run takes the recording's seed
+     */
+    void setupInputRecording ();
+    /**
+     * Takes the time, daytime and mouse of the next frame from the recording played back
+     *
+     * @return If there was a frame left to play back
+     */
+    bool replayInputFrame ();
+    /**
+     * Writes the time, daytime, mouse, spectrum and property changes of this frame to the recording
+     */
+    void recordInputFrame ();
+    /**
+     * Builds again the wallpapers that requested it, keeping the current one on screens where it fails
+     */
+    void rebuildWallpapers ();
+    /**
+     * Lowers or restores the render settings for the power monitor's profile, rebuilding the scenes if it changed
+     */
+    void applyPowerProfile ();
+    /**
+     * Keeps video and web backgrounds paused while the render settings are lowered, with --power-pause-video
+     */
+    void applyPowerPause () const;
+    /**
+     * Prints the structure of the loaded backgrounds as it goes through them
+     */
+    void dumpStructure () const;
+    /**
+     * @return If a background in the playlists or the preview list is a web one
+     */
+    [[nodiscard]] bool anyWebBackgroundQueued () const;
     /**
      * Prepares CEF browser to be used
      */
@@ -98,6 +182,10 @@ class WallpaperApplication {
      * Prepares all audio-related things (like detector, output, etc)
      */
     void setupAudio ();
+    /**
+     * Starts the thread that runs the fullscreen and audio detectors
+     */
+    void setupControlThread ();
     /**
      * Prepares the render-context of all the backgrounds so they can be displayed on the screen
      */
@@ -112,6 +200,24 @@ class WallpaperApplication {
      * @param filename
      */
     void takeScreenshot (const std::filesystem::path& filename) const;
+    /**
+     * Looks at the time since the last frame presented for --hitch-traces, writing out the tracer's ring a little after
+     * one took longer than the threshold
+     */
+    void checkHitch ();
+    /**
+     * @return The screens and the title and workshop id of what's on them, for the reports about them
+     */
+    [[nodiscard]] std::string describeBackgrounds () const;
+    /**
+     * Takes the preview of the current background once it simulated for long enough and moves on to the next one,
+     * stops the application after the last
+     */
+    void updatePreviews ();
+    /**
+     * Switches to the next background in the preview list that loads, stops the application if there's none left
+     */
+    void startNextPreview ();
 
     struct ActivePlaylist {
         ApplicationContext::PlaylistDefinition definition;
@@ -124,10 +230,78 @@ class WallpaperApplication {
 
     void initializePlaylists ();
     void updatePlaylists ();
+    /**
+     * @return If no screen with a background can be seen (covered or turned off), so nothing is worth rendering
+     */
+    [[nodiscard]] bool nothingVisible () const;
     void advancePlaylist (const std::string& screen, ActivePlaylist& playlist,
                           const std::chrono::steady_clock::time_point& now);
     bool selectNextCandidate (ActivePlaylist& playlist, std::size_t& outOrderIndex);
+    /**
+     * Replaces the screen's wallpaper with the background at the path, throws if it can't be loaded
+     *
+     * The new wallpaper is built a slice every frame by updateLoading (), the old one stays on screen until then
+     *
+     * @param screen
+     * @param path
+     * @param changed When reloading the screen's background, the files changed since it was loaded. The textures
+     * not read from them are reused instead of being loaded again
+     */
+    void switchWallpaper (
+        const std::string& screen, const std::filesystem::path& path,
+        const std::set<std::filesystem::path>* changed = nullptr);
+    /**
+     * Builds the wallpapers switched to for up to LOAD_SLICE, the ones that are done replace the screens' wallpapers
+     */
+    void updateLoading ();
+    /**
+     * Reloads the backgrounds whose files changed since the last call, only with --watch
+     */
+    void reloadChangedBackgrounds ();
+    /**
+     * @return If the background looks loadable, the answer is kept until its project.json changes
+     */
     bool preflightWallpaper (const std::string& path);
+    /**
+     * @return What preflighting the background finds, from the WorkshopIndex when its project.json didn't change
+     */
+    WorkshopIndex::Item indexWallpaper (const std::filesystem::path& path) const;
+    /**
+     * Checks the project.json of the background without mounting it, falls back to the asset locator when the
+     * file is not in the background's folder
+     *
+     * @param path
+     * @param type Filled in with the project's type, lowercase, when it has one
+     *
+     * @return If the project has a type and a main file that can be found
+     */
+    bool validateWallpaper (const std::filesystem::path& path, std::string& type) const;
+    /**
+     * @return The contents of the background's project.json, read from the asset locator if it's not in its folder
+     */
+    [[nodiscard]] std::string readProjectFile (const std::filesystem::path& path) const;
+    /**
+     * Preflights the item the playlist switches to next on the JobPool, so the switch finds the answer ready
+     */
+    void queuePreflight (const ActivePlaylist& playlist);
+    /**
+     * Starts parsing the background the playlist will switch to next on the JobPool
+     *
+     * @param screen
+     * @param playlist
+     */
+    void queuePreload (const std::string& screen, const ActivePlaylist& playlist);
+    /**
+     * Starts parsing the given background on the JobPool, see takePreload ()
+     *
+     * @param screen
+     * @param path
+     */
+    void queuePreload (const std::string& screen, const std::filesystem::path& path);
+    /**
+     * @return The background at the path, taken from the screen's preload when it's the one that was preloaded
+     */
+    ProjectUniquePtr takePreload (const std::string& screen, const std::filesystem::path& path);
     std::vector<std::size_t> buildPlaylistOrder (const ApplicationContext::PlaylistDefinition& definition);
     void ensureBrowserForProject (const Project& project);
     bool makeAnyViewportCurrent () const;
@@ -135,7 +309,7 @@ class WallpaperApplication {
     /** The application context that contains the current app settings */
     ApplicationContext& m_context;
     /** Maps screens to backgrounds */
-    std::map<std::string, ProjectUniquePtr> m_backgrounds {};
+    std::map<std::string, ProjectSharedPtr> m_backgrounds {};
     std::map<std::string, ActivePlaylist> m_activePlaylists {};
 
     std::unique_ptr <WallpaperEngine::Audio::Drivers::Detectors::AudioPlayingDetector> m_audioDetector = nullptr;
@@ -146,8 +320,80 @@ class WallpaperApplication {
     std::unique_ptr <WallpaperEngine::Render::Drivers::VideoDriver> m_videoDriver = nullptr;
     std::unique_ptr <WallpaperEngine::Render::Drivers::Detectors::FullScreenDetector> m_fullScreenDetector = nullptr;
     std::unique_ptr <WallpaperEngine::WebBrowser::WebBrowserContext> m_browserContext = nullptr;
+    /** runs the detectors, has to go before them */
+    std::unique_ptr <ControlThread> m_controlThread = nullptr;
+    /** these read the render context's stats, have to go before it */
+    std::unique_ptr <StatsSocket> m_statsSocket = nullptr;
+    std::unique_ptr <MetricsServer> m_metricsServer = nullptr;
+    std::unique_ptr <ControlSocket> m_controlSocket = nullptr;
+    /** only with --power-profiles */
+    std::unique_ptr <PowerMonitor> m_powerMonitor = nullptr;
+    /** only with --watch */
+    std::unique_ptr <ProjectWatcher> m_projectWatcher = nullptr;
+    /** only with --record-input or --replay-input */
+    std::unique_ptr <Debugging::InputRecording> m_inputRecording = nullptr;
+    /** the frame being recorded or played back */
+    Debugging::InputRecording::Frame m_inputFrame {};
+    /** the driver's mouse is swapped for this one while playing back */
+    WallpaperEngine::Input::Drivers::ReplayMouseInput m_replayMouse {};
+    /** signal that asked to stop, logged once the loop is out */
+    volatile sig_atomic_t m_stopSignal = 0;
     std::mt19937 m_playlistRng {std::random_device {} ()};
+
+    /** preflight results of every background checked, by this launch or earlier ones */
+    mutable WorkshopIndex m_workshopIndex {};
+    Threading::JobPool::Group m_preflightJobs {};
+
+    struct Preload {
+        std::filesystem::path path;
+        Threading::JobPool::Group job;
+        ProjectUniquePtr project;
+        /** why loading the background failed, empty if it didn't */
+        std::string error;
+    };
+
+    /** how long before the switch the next background starts loading */
+    static constexpr std::chrono::seconds PRELOAD_LEAD {15};
+    /** background being loaded in the background for every screen with a playlist */
+    std::map<std::string, std::unique_ptr<Preload>> m_preloads {};
+    struct Loading {
+        std::filesystem::path path;
+        ProjectUniquePtr project;
+        std::shared_ptr<WallpaperEngine::Render::CWallpaper> wallpaper;
+    };
+
+    /** how long a frame spends building wallpapers switched to, every other screen keeps animating meanwhile */
+    static constexpr std::chrono::milliseconds LOAD_SLICE {4};
+    /** wallpaper being built for every screen that's switching, these use the render context so they go before it */
+    std::map<std::string, Loading> m_loading {};
+    /** writes the images taken with --previews, nullptr otherwise */
+    std::unique_ptr<PreviewWriter> m_previewWriter = nullptr;
+    /** background of the preview list being rendered */
+    std::size_t m_previewIndex = 0;
+    /** frames the current preview background has simulated so far */
+    uint32_t m_previewFrames = 0;
     bool m_isPaused = false;
+    /** paused through the control socket, stays paused until resumed there */
+    bool m_userPaused = false;
     std::chrono::steady_clock::time_point m_pauseStart {};
+    /** how far after a hitch the trace written for it goes, the rest of the ring is what led up to it */
+    static constexpr std::chrono::seconds HITCH_AFTER {1};
+    /** how much of the tracer's ring goes into the trace of a hitch */
+    static constexpr std::chrono::seconds HITCH_WINDOW {4};
+    /** if any viewport presented a frame since the last checkHitch () */
+    bool m_framePresented = false;
+    /** when the last presented frame was checked, unset after frames that presented nothing or a pause */
+    std::chrono::steady_clock::time_point m_lastPresent {};
+    /** when the hitch waiting to be written out happened, unset if there's none */
+    std::chrono::steady_clock::time_point m_pendingHitch {};
+    /** if the video memory the backgrounds take was printed for --dump-structure */
+    bool m_resourcesDumped = false;
+    /** packages mounted so far and where they are, kept for --repack */
+    mutable std::vector<std::pair<std::shared_ptr<FileSystem::Adapters::PackageAdapter>, std::filesystem::path>>
+        m_packages {};
+    mutable std::mutex m_packagesMutex {};
+    /** how long the backgrounds loaded before the render context took, they go to its stats once it's there */
+    std::vector<std::chrono::steady_clock::duration> m_loadTimes {};
+    std::mutex m_loadTimesMutex {};
 };
 } // namespace WallpaperEngine::Application
@@ -0,0 +1,148 @@
+#include "WorkshopIndex.h"
+
+#include <fstream>
+#include <vector>
+
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/Utils/CacheDirectory.h"
+
+using namespace WallpaperEngine::Application;
+
+namespace {
+/** no path or type is anywhere near this long, anything bigger is a broken file */
+constexpr uint32_t MAX_STRING = 4096;
+
+template <typename T> void writeValue (std::ostream& out, const T& value) {
+    out.write (reinterpret_cast<const char*> (&value), sizeof (value));
+}
+
+template <typename T> T readValue (std::istream& in) {
+    T value {};
+
+    in.read (reinterpret_cast<char*> (&value), sizeof (value));
+
+    return value;
+}
+
+void writeString (std::ostream& out, const std::string& value) {
+    writeValue<uint32_t> (out, static_cast<uint32_t> (value.size ()));
+    out.write (value.data (), static_cast<std::streamsize> (value.size ()));
+}
+
+bool readString (std::istream& in, std::string& value) {
+    const auto size = readValue<uint32_t> (in);
+
+    if (!in || size > MAX_STRING)
+        return false;
+
+    value.resize (size);
+
+    return static_cast<bool> (in.read (value.data (), size));
+}
+} // namespace
+
+WorkshopIndex::WorkshopIndex () {
+    if (const auto cache = Render::Utils::getCacheDirectory (); !cache.empty ())
+        this->m_path = cache / "workshop.index";
+
+    this->load ();
+}
+
+WorkshopIndex::~WorkshopIndex () {
+    if (this->m_changed)
+        this->store ();
+}
+
+std::optional<WorkshopIndex::Item> WorkshopIndex::find (const std::filesystem::path& path, const int64_t modified) const {
+    std::scoped_lock lock (this->m_mutex);
+
+    const auto it = this->m_items.find (path.string ());
+
+    if (it == this->m_items.end () || it->second.modified != modified)
+        return std::nullopt;
+
+    return it->second;
+}
+
+void WorkshopIndex::update (const std::filesystem::path& path, Item item) {
+    std::scoped_lock lock (this->m_mutex);
+
+    this->m_items.insert_or_assign (path.string (), std::move (item));
+    this->m_changed = true;
+}
+
+void WorkshopIndex::load () {
+    if (this->m_path.empty ())
+        return;
+
+    std::ifstream in (this->m_path, std::ios::binary);
+
+    if (!in)
+        return;
+
+    if (readValue<uint32_t> (in) != MAGIC || readValue<uint32_t> (in) != VERSION)
+        return;
+
+    const auto count = readValue<uint32_t> (in);
+
+    for (uint32_t index = 0; in && index < count; index++) {
+        std::string path;
+        Item item {};
+
+        if (!readString (in, path))
+            break;
+
+        item.modified = readValue<int64_t> (in);
+        item.valid = readValue<uint8_t> (in) != 0;
+
+        if (!readString (in, item.type))
+            break;
+
+        this->m_items.insert_or_assign (std::move (path), std::move (item));
+    }
+}
+
+void WorkshopIndex::store () const {
+    if (this->m_path.empty ())
+        return;
+
+    std::error_code ec;
+
+    std::filesystem::create_directories (this->m_path.parent_path (), ec);
+
+    if (ec) {
+        sLog.error ("Cannot create workshop index directory ", this->m_path.parent_path (), ": ", ec.message ());
+        return;
+    }
+
+    // other instances might be reading the index, never let them see a partial one
+    std::filesystem::path temporary = this->m_path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream out (temporary, std::ios::binary | std::ios::trunc);
+
+        writeValue<uint32_t> (out, MAGIC);
+        writeValue<uint32_t> (out, VERSION);
+        writeValue<uint32_t> (out, static_cast<uint32_t> (this->m_items.size ()));
+
+        for (const auto& [path, item] : this->m_items) {
+            writeString (out, path);
+            writeValue<int64_t> (out, item.modified);
+            writeValue<uint8_t> (out, item.valid ? 1 : 0);
+            writeString (out, item.type);
+        }
+
+        if (!out) {
+            sLog.error ("Cannot write workshop index ", temporary);
+            out.close ();
+            std::filesystem::remove (temporary, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename (temporary, this->m_path, ec);
+
+    if (ec)
+        sLog.error ("Cannot store workshop index ", this->m_path, ": ", ec.message ());
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace WallpaperEngine::Application {
+/**
+ * On-disk index of what preflighting every background found, so big playlists don't parse thousands of
+ * project.json on every launch
+ *
+ * Entries are keyed on the background's folder and remember when its project.json was modified, a newer file
+ * simply misses and is checked again. Safe to use from any thread
+ */
+class WorkshopIndex {
+  public:
+    struct Item {
+        /** when project.json was modified as the background was checked */
+        int64_t modified;
+        bool valid;
+        /** the project's type, lowercase, empty if it has none */
+        std::string type;
+    };
+
+    /**
+     * Reads the index stored by previous launches, starts empty if there's none
+     */
+    WorkshopIndex ();
+    /**
+     * Stores the index if anything changed
+     */
+    ~WorkshopIndex ();
+
+    WorkshopIndex (const WorkshopIndex&) = delete;
+    WorkshopIndex& operator= (const WorkshopIndex&) = delete;
+
+    /**
+     * @param path The background's folder
+     * @param modified When its project.json was modified
+     *
+     * @return The entry for the background, if it was checked with the same project.json
+     */
+    [[nodiscard]] std::optional<Item> find (const std::filesystem::path& path, int64_t modified) const;
+    /**
+     * Adds or replaces the entry of the background
+     */
+    void update (const std::filesystem::path& path, Item item);
+
+  private:
+    void load ();
+    void store () const;
+
+    static constexpr uint32_t MAGIC = 0x4957574c; // "LWWI"
+    static constexpr uint32_t VERSION = 1;
+
+    /** where the index is kept, empty if there's no cache directory */
+    std::filesystem::path m_path;
+    std::map<std::string, Item> m_items = {};
+    bool m_changed = false;
+    mutable std::mutex m_mutex = {};
+};
+} // namespace WallpaperEngine::Application
@@ -1,10 +1,16 @@
 #include "AssetLocator.h"
 
 #include "AssetLoadException.h"
+#include "JsonCache.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
+
+#include <system_error>
 
 using namespace WallpaperEngine::Assets;
 
-AssetLocator::AssetLocator (ContainerUniquePtr filesystem) : m_filesystem (std::move (filesystem)) {}
+AssetLocator::AssetLocator (ContainerUniquePtr filesystem, const bool jsonCache) :
+    m_filesystem (std::move (filesystem)),
+    m_jsonCache (jsonCache) {}
 
 std::string AssetLocator::shader (const std::filesystem::path& filename) const {
     try {
@@ -17,16 +23,16 @@ std::string AssetLocator::shader (const std::filesystem::path& filename) const {
             if (++it != shader.end ()) {
                 const std::filesystem::path& shaderfile = *it;
 
-                try {
-                    shader = std::filesystem::path ("zcompat") / "scene" / "shaders" / workshopId / shaderfile;
+                shader = std::filesystem::path ("zcompat") / "scene" / "shaders" / workshopId / shaderfile;
+
+                // the replacement file might not exist
+                if (this->m_filesystem->exists (shader)) {
                     // replace the old path with the new one
                     std::string contents = this->m_filesystem->readString (shader);
 
                     sLog.out ("Replaced ", filename, " with compat ", shader);
 
                     return contents;
-                } catch (std::filesystem::filesystem_error&) {
-                    // these exceptions can be ignored because the replacement file might not exist
                 }
             }
         }
@@ -58,7 +64,21 @@ std::string AssetLocator::includeShader (const std::filesystem::path& filename)
 
     final.replace_extension ("h");
 
-    return this->shader (final);
+    std::scoped_lock lock (this->m_includesMutex);
+
+    if (const auto it = this->m_includes.find (final); it != this->m_includes.end ())
+        return it->second;
+
+    if (this->m_missingIncludes.contains (final))
+        throw AssetLoadException (
+            "Cannot find include file", final, std::make_error_code (std::errc::no_such_file_or_directory));
+
+    try {
+        return this->m_includes.emplace (final, this->shader (final)).first->second;
+    } catch (AssetLoadException&) {
+        this->m_missingIncludes.emplace (final);
+        throw;
+    }
 }
 
 std::string AssetLocator::readString (const std::filesystem::path& filename) const {
@@ -69,9 +89,23 @@ std::string AssetLocator::readString (const std::filesystem::path& filename) con
     }
 }
 
+JSON AssetLocator::readJSON (const std::filesystem::path& filename) const {
+    const std::string contents = this->readString (filename);
+    const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_Json, contents.size ());
+
+    return this->m_jsonCache ? JsonCache::parse (contents) : JSON::parse (contents);
+}
+
+std::filesystem::path AssetLocator::texturePath (const std::filesystem::path& filename) {
+    return std::filesystem::path("materials") / filename.string ().append (".tex");
+}
+
+bool AssetLocator::hasTexture (const std::filesystem::path& filename) const {
+    return this->m_filesystem->exists (texturePath (filename));
+}
 
 ReadStreamSharedPtr AssetLocator::texture (const std::filesystem::path& filename) const {
-    const auto final = std::filesystem::path("materials") / filename.string ().append (".tex");
+    const auto final = texturePath (filename);
 
     try {
         return this->m_filesystem->read (final);
@@ -88,6 +122,17 @@ ReadStreamSharedPtr AssetLocator::read (const std::filesystem::path& path) const
     }
 }
 
+void AssetLocator::prefetchTexture (const std::filesystem::path& filename) const {
+    this->m_filesystem->prefetch (texturePath (filename));
+}
+
+void AssetLocator::prefetchShader (const std::filesystem::path& filename) const {
+    auto final = "shaders" / filename;
+
+    this->m_filesystem->prefetch (final.replace_extension ("vert"));
+    this->m_filesystem->prefetch (final.replace_extension ("frag"));
+}
+
 std::filesystem::path AssetLocator::physicalPath (const std::filesystem::path& path) const {
     try {
         return this->m_filesystem->physicalPath (path);
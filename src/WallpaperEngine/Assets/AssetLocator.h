@@ -1,5 +1,9 @@
 #pragma once
 
+#include <map>
+#include <mutex>
+#include <set>
+
 #include "WallpaperEngine/FileSystem/Container.h"
 
 namespace WallpaperEngine::Assets {
@@ -7,20 +11,53 @@ using namespace WallpaperEngine::FileSystem;
 using namespace WallpaperEngine::Data::Model;
 class AssetLocator {
   public:
-    explicit AssetLocator (ContainerUniquePtr filesystem);
+    /**
+     * @param filesystem
+     * @param jsonCache If readJSON () should go through the JsonCache
+     */
+    explicit AssetLocator (ContainerUniquePtr filesystem, bool jsonCache = false);
 
     std::string vertexShader (const std::filesystem::path& filename) const;
     std::string fragmentShader (const std::filesystem::path& filename) const;
+    /**
+     * Include files are shared by most shaders (common.h and friends), their contents are read once and kept
+     */
     std::string includeShader (const std::filesystem::path& filename) const;
     ReadStreamSharedPtr texture (const std::filesystem::path& filename) const;
+    /**
+     * @return If texture () would find the file, without throwing when it doesn't
+     */
+    bool hasTexture (const std::filesystem::path& filename) const;
     std::string readString (const std::filesystem::path& filename) const;
+    /**
+     * Reads and parses the given JSON file
+     */
+    JSON readJSON (const std::filesystem::path& filename) const;
     ReadStreamSharedPtr read (const std::filesystem::path& path) const;
     std::filesystem::path physicalPath (const std::filesystem::path& path) const;
+    /**
+     * Starts reading the files texture () would open in the background
+     */
+    void prefetchTexture (const std::filesystem::path& filename) const;
+    /**
+     * Starts reading the files vertexShader () and fragmentShader () would open in the background
+     */
+    void prefetchShader (const std::filesystem::path& filename) const;
+    /**
+     * @return Where texture () looks for the texture, relative to the container's root
+     */
+    static std::filesystem::path texturePath (const std::filesystem::path& filename);
 
   private:
     std::string shader (const std::filesystem::path& filename) const;
 
     ContainerUniquePtr m_filesystem;
+    bool m_jsonCache;
+    /** contents of the include files read so far */
+    mutable std::map<std::filesystem::path, std::string> m_includes = {};
+    /** include files that do not exist, commented out includes end up here */
+    mutable std::set<std::filesystem::path> m_missingIncludes = {};
+    mutable std::mutex m_includesMutex = {};
 };
 
 using AssetLocatorUniquePtr = std::unique_ptr<AssetLocator>;
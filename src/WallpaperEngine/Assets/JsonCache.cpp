@@ -0,0 +1,139 @@
+#include "JsonCache.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/Utils/CacheDirectory.h"
+
+using namespace WallpaperEngine::Assets;
+
+namespace {
+/** the CBOR of a document is never much bigger than its text */
+constexpr size_t MAX_RATIO = 4;
+
+template <typename T> void writeValue (std::ostream& out, const T& value) {
+    out.write (reinterpret_cast<const char*> (&value), sizeof (value));
+}
+
+template <typename T> T readValue (std::istream& in) {
+    T value {};
+
+    in.read (reinterpret_cast<char*> (&value), sizeof (value));
+
+    return value;
+}
+} // namespace
+
+JSON JsonCache::parse (const std::string& contents) {
+    if (contents.size () < MIN_SIZE)
+        return JSON::parse (contents);
+
+    const auto path = getPath (contents);
+
+    if (path.empty ())
+        return JSON::parse (contents);
+
+    JSON document;
+
+    if (load (path, contents, document))
+        return document;
+
+    document = JSON::parse (contents);
+    store (path, contents, document);
+
+    return document;
+}
+
+std::filesystem::path JsonCache::getPath (const std::string& contents) {
+    const std::filesystem::path cache = Render::Utils::getCacheDirectory ();
+
+    if (cache.empty ())
+        return {};
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (const char c : contents) {
+        hash ^= static_cast<uint8_t> (c);
+        hash *= 0x100000001b3ULL;
+    }
+
+    std::ostringstream name;
+
+    name << std::hex << std::setw (16) << std::setfill ('0') << hash << ".cbor";
+
+    return cache / "json" / name.str ();
+}
+
+bool JsonCache::load (const std::filesystem::path& path, const std::string& contents, JSON& document) {
+    std::ifstream in (path, std::ios::binary);
+
+    if (!in)
+        return false;
+
+    if (readValue<uint32_t> (in) != MAGIC || readValue<uint32_t> (in) != VERSION)
+        return false;
+
+    // a hash collision would have to match the length too
+    if (readValue<uint64_t> (in) != contents.size ())
+        return false;
+
+    const auto size = readValue<uint64_t> (in);
+
+    if (!in || size > contents.size () * MAX_RATIO)
+        return false;
+
+    std::vector<uint8_t> cbor (size);
+
+    if (!in.read (reinterpret_cast<char*> (cbor.data ()), static_cast<std::streamsize> (size)))
+        return false;
+
+    try {
+        document = JSON::from_cbor (cbor);
+    } catch (nlohmann::json::exception&) {
+        return false;
+    }
+
+    return true;
+}
+
+void JsonCache::store (const std::filesystem::path& path, const std::string& contents, const JSON& document) {
+    std::error_code ec;
+
+    std::filesystem::create_directories (path.parent_path (), ec);
+
+    if (ec) {
+        sLog.error ("Cannot create JSON cache directory ", path.parent_path (), ": ", ec.message ());
+        return;
+    }
+
+    const std::vector<uint8_t> cbor = JSON::to_cbor (document);
+
+    // other instances might be reading the same entry, never let them see a partial one
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream out (temporary, std::ios::binary | std::ios::trunc);
+
+        writeValue<uint32_t> (out, MAGIC);
+        writeValue<uint32_t> (out, VERSION);
+        writeValue<uint64_t> (out, contents.size ());
+        writeValue<uint64_t> (out, cbor.size ());
+        out.write (reinterpret_cast<const char*> (cbor.data ()), static_cast<std::streamsize> (cbor.size ()));
+
+        if (!out) {
+            sLog.error ("Cannot write JSON cache entry ", temporary);
+            out.close ();
+            std::filesystem::remove (temporary, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename (temporary, path, ec);
+
+    if (ec)
+        sLog.error ("Cannot store JSON cache entry ", path, ": ", ec.message ());
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "WallpaperEngine/Data/JSON.h"
+
+namespace WallpaperEngine::Assets {
+using JSON = WallpaperEngine::Data::JSON::JSON;
+
+/**
+ * On-disk cache of parsed JSON documents
+ *
+ * Documents are stored as CBOR, which nlohmann reads back several times faster than the text it came from.
+ * Entries are keyed on a hash of the text, so an edited file simply misses and the same material in different
+ * backgrounds shares one entry. Small documents parse faster than their entry can be opened and are left alone
+ */
+class JsonCache {
+  public:
+    /**
+     * @param contents The JSON text
+     *
+     * @return The parsed document, from the cache when an earlier launch stored it
+     */
+    static JSON parse (const std::string& contents);
+
+  private:
+    /**
+     * @return Where the entry for the contents is stored, empty if there's no cache directory
+     */
+    static std::filesystem::path getPath (const std::string& contents);
+    static bool load (const std::filesystem::path& path, const std::string& contents, JSON& document);
+    static void store (const std::filesystem::path& path, const std::string& contents, const JSON& document);
+
+    static constexpr uint32_t MAGIC = 0x434a574c; // "LWJC"
+    static constexpr uint32_t VERSION = 1;
+    /** documents smaller than this are parsed every time */
+    static constexpr size_t MIN_SIZE = 16 * 1024;
+};
+} // namespace WallpaperEngine::Assets
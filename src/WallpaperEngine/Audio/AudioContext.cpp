@@ -1,13 +1,53 @@
 #include "AudioContext.h"
+#include "WallpaperEngine/Audio/AudioStream.h"
 #include "WallpaperEngine/Audio/Drivers/AudioDriver.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
+#include "WallpaperEngine/Logging/Log.h"
 
 namespace WallpaperEngine::Audio {
-AudioContext::AudioContext (Drivers::AudioDriver& driver) : m_driver (driver) {}
+// decoding is cheap next to playback, two threads keep up with plenty of sounds while one is slow to seek or loop
+AudioContext::AudioContext (Drivers::AudioDriver& driver) : m_driver (driver), m_decoders (2) {}
+
+void AudioContext::addStream (AudioStream* stream) {
+    if (stream->isStreaming ())
+        this->m_decoders.add (stream);
 
-void AudioContext::addStream (AudioStream* stream) const {
     this->m_driver.addStream (stream);
 }
 
+void AudioContext::removeStream (AudioStream* stream) {
+    this->m_driver.removeStream (stream);
+    this->m_decoders.remove (stream);
+}
+
+AudioStream* AudioContext::createStream (const void* owner, const std::string& name,
+                                        const Data::Utils::ReadStreamSharedPtr& buffer) {
+    const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_Audio);
+    const int cacheSeconds = this->getApplicationContext ().settings.audio.cacheSeconds;
+    const auto key = std::make_pair (owner, name);
+
+    if (cacheSeconds <= 0)
+        return new AudioStream (*this, buffer);
+
+    if (const auto it = this->m_decoded.find (key); it != this->m_decoded.end ()) {
+        if (auto samples = it->second.lock (); samples != nullptr)
+            return new AudioStream (*this, std::move (samples));
+    }
+
+    if (auto samples = AudioStream::decode (*this, buffer, cacheSeconds); samples != nullptr) {
+        sLog.debug ("Decoded ", name, " to memory, ", samples->size (), " bytes");
+
+        this->m_decoded [key] = samples;
+        return new AudioStream (*this, std::move (samples));
+    }
+
+    // too long to keep decoded, stream it from the start instead
+    buffer->clear ();
+    buffer->seekg (0, std::ios_base::beg);
+
+    return new AudioStream (*this, buffer);
+}
+
 AVSampleFormat AudioContext::getFormat () const {
     return this->m_driver.getFormat ();
 }
@@ -1,10 +1,15 @@
 #pragma once
 
 #include <libavutil/samplefmt.h>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "WallpaperEngine/Application/ApplicationContext.h"
+#include "WallpaperEngine/Audio/DecoderPool.h"
 #include "WallpaperEngine/Audio/Drivers/Recorders/PulseAudioPlaybackRecorder.h"
+#include "WallpaperEngine/Data/Utils/BinaryReader.h"
 
 namespace WallpaperEngine {
 namespace Application {
@@ -27,11 +32,29 @@ class AudioContext {
     explicit AudioContext (Drivers::AudioDriver& driver);
 
     /**
-     * Registers the given stream in the driver for playing
+     * Registers the given stream in the driver for playing, streaming ones start decoding too
      *
      * @param stream
      */
-    void addStream (AudioStream* stream) const;
+    void addStream (AudioStream* stream);
+    /**
+     * Stops playing and decoding the stream, it can be deleted afterwards
+     *
+     * @param stream
+     */
+    void removeStream (AudioStream* stream);
+    /**
+     * Creates a stream for the given sound. Sounds short enough for --audio-cache are decoded only once, every
+     * stream playing them shares the samples and none of them has a decoder or read thread
+     *
+     * @param owner Whatever the name is relative to, so equally named sounds of different backgrounds don't mix
+     * @param name
+     * @param buffer The sound's data, only read if it's not decoded already
+     *
+     * @return The new stream, owned by the caller
+     */
+    [[nodiscard]] AudioStream* createStream (const void* owner, const std::string& name,
+                                             const Data::Utils::ReadStreamSharedPtr& buffer);
 
     /**
      * TODO: MAYBE THIS SHOULD BE OUR OWN DEFINITIONS INSTEAD OF LIBRARY SPECIFIC ONES?
@@ -59,6 +82,10 @@ class AudioContext {
   private:
     /** The audio driver in use */
     Drivers::AudioDriver& m_driver;
+    /** Threads decoding every streaming sound */
+    DecoderPool m_decoders;
+    /** Decoded sounds, kept only while a stream still plays them */
+    std::map<std::pair<const void*, std::string>, std::weak_ptr<const std::vector<uint8_t>>> m_decoded = {};
 };
 } // namespace Audio
 } // namespace WallpaperEngine
\ No newline at end of file
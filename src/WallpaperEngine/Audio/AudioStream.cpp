@@ -1,64 +1,13 @@
 #include "AudioStream.h"
 #include "WallpaperEngine/Logging/Log.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 
-// maximum size of the queue to prevent reading too much data
-
 using namespace WallpaperEngine::Audio;
 
-int audio_read_thread (void* arg) {
-    SDL_mutex* waitMutex = SDL_CreateMutex ();
-    auto* stream = static_cast<AudioStream*> (arg);
-    AVPacket* packet = av_packet_alloc ();
-    int ret = 0;
-
-    if (waitMutex == nullptr)
-        sLog.exception ("Cannot create mutex for audio playback waiting");
-
-    while (ret >= 0 && stream->getAudioContext ().getApplicationContext ().state.general.keepRunning) {
-        // give the cpu some time to play the queued frames if there's enough info there
-        if (stream->getQueueSize () >= MAX_QUEUE_SIZE ||
-            (stream->getQueuePacketCount () > MIN_FRAMES &&
-             (av_q2d (stream->getTimeBase ()) * stream->getQueueDuration () > 1.0))) {
-            SDL_LockMutex (waitMutex);
-            SDL_CondWaitTimeout (stream->getWaitCondition (), waitMutex, 10);
-            SDL_UnlockMutex (waitMutex);
-            continue;
-        }
-
-        ret = av_read_frame (stream->getFormatContext (), packet);
-
-        if (ret == AVERROR_EOF) {
-            // seek to the beginning of the file again
-            avformat_seek_file (stream->getFormatContext (), stream->getAudioStream (), 0, 0, 0, ~AVSEEK_FLAG_FRAME);
-            avcodec_flush_buffers (stream->getContext ());
-
-            // ensure the thread is not killed if audio has to be looped
-            if (stream->isRepeat ())
-                ret = 0;
-
-            continue;
-        }
-
-        // TODO: PROPERLY IMPLEMENT THIS
-        if (packet->stream_index == stream->getAudioStream ())
-            stream->queuePacket (packet);
-        else
-            av_packet_unref (packet);
-
-        if (!stream->isInitialized ())
-            break;
-    }
-
-    // stop the audio too just in case
-    stream->stop ();
-    SDL_DestroyMutex (waitMutex);
-
-    return 0;
-}
-
 static int audio_read_data_callback (void* streamarg, uint8_t* buffer, int buffer_size) {
     const auto stream = static_cast<AudioStream*> (streamarg);
 
@@ -107,6 +56,57 @@ AudioStream::AudioStream (AudioContext& context, const std::string& filename) :
 
 AudioStream::AudioStream (AudioContext& context, const ReadStreamSharedPtr& buffer) :
     m_audioContext (context) {
+    this->openBuffer (buffer);
+}
+
+AudioStream::AudioStream (AudioContext& context, const ReadStreamSharedPtr& buffer, std::vector<uint8_t>& target) :
+    m_audioContext (context),
+    m_decodeTarget (&target) {
+    this->openBuffer (buffer);
+}
+
+AudioStream::AudioStream (AudioContext& audioContext, AVCodecContext* context) :
+    m_audioContext (audioContext),
+    m_context (context) {
+    this->initialize ();
+}
+
+AudioStream::AudioStream (AudioContext& context, DecodedSamples samples) :
+    m_audioContext (context),
+    m_decoded (std::move (samples)) {
+    // only needed to skip, the samples are in the driver's format already
+    this->m_bytesPerSecond = static_cast<size_t> (this->m_audioContext.getSampleRate ()) *
+                             this->m_audioContext.getChannels () *
+                             av_get_bytes_per_sample (this->m_audioContext.getFormat ());
+    this->m_initialized = true;
+}
+
+AudioStream::~AudioStream () {
+    if (this->m_swrctx != nullptr && swr_is_initialized (this->m_swrctx) == true)
+        swr_close (this->m_swrctx);
+    if (this->m_swrctx != nullptr)
+        swr_free (&this->m_swrctx);
+    if (this->m_decodeFrame != nullptr)
+        av_frame_free (&this->m_decodeFrame);
+    if (this->m_readPacket != nullptr)
+        av_packet_free (&this->m_readPacket);
+    if (this->m_formatContext != nullptr) {
+        // ffmpeg leaves custom io contexts to whoever allocated them
+        AVIOContext* io = this->m_buffer != nullptr ? this->m_formatContext->pb : nullptr;
+
+        // this frees the streams and the context itself too
+        avformat_close_input (&this->m_formatContext);
+
+        if (io != nullptr) {
+            av_freep (&io->buffer);
+            avio_context_free (&io);
+        }
+    }
+    if (this->m_context != nullptr)
+        avcodec_free_context (&this->m_context);
+}
+
+void AudioStream::openBuffer (const ReadStreamSharedPtr& buffer) {
     // setup a custom context first
     this->m_formatContext = avformat_alloc_context ();
 
@@ -126,41 +126,21 @@ AudioStream::AudioStream (AudioContext& context, const ReadStreamSharedPtr& buff
     this->loadCustomContent ();
 }
 
-AudioStream::AudioStream (AudioContext& audioContext, AVCodecContext* context) :
-    m_audioContext (audioContext),
-    m_context (context),
-    m_queue (new PacketQueue) {
-    this->initialize ();
-}
+DecodedSamples AudioStream::decode (AudioContext& context, const ReadStreamSharedPtr& buffer, const double maxSeconds) {
+    auto samples = std::make_shared<std::vector<uint8_t>> ();
+    AudioStream stream (context, buffer, *samples);
+    const int64_t duration = stream.m_formatContext->duration;
 
-AudioStream::~AudioStream () {
-    if (this->m_swrctx != nullptr && swr_is_initialized (this->m_swrctx) == true)
-        swr_close (this->m_swrctx);
-    if (this->m_swrctx != nullptr)
-        swr_free (&this->m_swrctx);
-    if (this->m_decodePacket != nullptr)
-        av_packet_free (&this->m_decodePacket);
-    if (this->m_decodeFrame != nullptr)
-        av_frame_free (&this->m_decodeFrame);
-    if (this->m_queue != nullptr && this->m_queue->packetList != nullptr) {
-#if FF_API_FIFO_OLD_API
-        av_fifo_free (this->m_queue->packetList);
-        this->m_queue->packetList = nullptr;
-#else
-        av_fifo_freep2 (&this->m_queue->packetList);
-#endif /* FF_API_FIFO_OLD_API */
-    }
+    if (duration == AV_NOPTS_VALUE || duration > maxSeconds * AV_TIME_BASE)
+        return nullptr;
 
-    delete this->m_queue;
+    samples->reserve (duration * stream.m_bytesPerSecond / AV_TIME_BASE);
 
-    if (this->m_formatContext != nullptr)
-        avformat_close_input (&this->m_formatContext);
-    if (this->m_context != nullptr)
-        avcodec_free_context (&this->m_context);
-    if (this->m_audioStream != NO_AUDIO_STREAM)
-        av_freep (&this->m_formatContext->streams [this->m_audioStream]);
-    if (this->m_formatContext != nullptr)
-        avformat_free_context (this->m_formatContext);
+    // without a ring everything goes into samples, so this only returns once the whole sound is decoded
+    stream.fill ();
+    samples->shrink_to_fit ();
+
+    return samples;
 }
 
 void AudioStream::loadCustomContent (const char* filename) {
@@ -198,22 +178,11 @@ void AudioStream::loadCustomContent (const char* filename) {
 
     // initialize default data
     this->m_context = avCodecContext;
-    this->m_queue = new PacketQueue;
 
     this->initialize ();
-
-    // initialize an SDL thread to read the file
-    SDL_CreateThread (audio_read_thread, filename, this);
 }
 
 void AudioStream::initialize () {
-// allocate the FIFO buffer
-#if FF_API_FIFO_OLD_API
-    this->m_queue->packetList = av_fifo_alloc (sizeof (MyAVPacketList));
-#else
-    this->m_queue->packetList = av_fifo_alloc2 (1, sizeof (MyAVPacketList), AV_FIFO_FLAG_AUTO_GROW);
-#endif
-
 #if FF_API_OLD_CHANNEL_LAYOUT
     int64_t out_channel_layout;
 
@@ -250,103 +219,233 @@ void AudioStream::initialize () {
     if (this->m_swrctx == nullptr)
         sLog.exception ("Cannot initialize swrctx for audio resampling");
 
-    // initialize the context
-    if (swr_init (this->m_swrctx) < 0)
-        sLog.exception ("Failed to initialize the resampling context.");
+    this->configureResampler ();
+
+    // initialize the context, ffmpeg might have been built without soxr
+    if (swr_init (this->m_swrctx) < 0) {
+        av_opt_set_int (this->m_swrctx, "resampler", SWR_ENGINE_SWR, 0);
+
+        if (swr_init (this->m_swrctx) < 0)
+            sLog.exception ("Failed to initialize the resampling context.");
+
+        sLog.debug ("soxr is not available, resampling with ffmpeg's own resampler");
+    }
+
+    // the ring is allocated once here, the driver's callback only ever copies out of it
+    this->m_bytesPerSecond = static_cast<size_t> (this->m_audioContext.getSampleRate ()) *
+                             this->m_audioContext.getChannels () *
+                             av_get_bytes_per_sample (this->m_audioContext.getFormat ());
 
-    // setup the queue information
-    this->m_queue->mutex = SDL_CreateMutex ();
-    this->m_queue->cond = SDL_CreateCond ();
-    this->m_queue->wait = SDL_CreateCond ();
+    // decode () collects everything in one go, the ring is only needed while streaming
+    if (this->m_decodeTarget == nullptr)
+        this->m_samples = std::make_unique<SampleRing> (this->m_bytesPerSecond * SAMPLE_RING_SECONDS);
 
     this->m_decodeFrame = av_frame_alloc ();
-    this->m_decodePacket = av_packet_alloc ();
+    this->m_readPacket = av_packet_alloc ();
 
     if (!this->m_decodeFrame) {
         sLog.exception ("Could not allocate AVFrame.\n");
     }
-    if (!this->m_decodePacket) {
+    if (!this->m_readPacket) {
         sLog.exception ("Could not allocate AVPacket.\n");
     }
 
     this->m_initialized = true;
 }
 
-void AudioStream::queuePacket (AVPacket* pkt) {
-    // clone the packet
-    AVPacket* clone = av_packet_alloc ();
+bool AudioStream::fill () {
+    while (this->isInitialized () && this->m_audioContext.getApplicationContext ().state.general.keepRunning) {
+        // only marked done once the ring is cleared, so the driver never plays what was decoded before the jump
+        if (const int64_t skip = this->m_skip.load (std::memory_order_acquire); skip > 0) {
+            this->seekAhead (skip);
+            this->m_skip.fetch_sub (skip, std::memory_order_release);
+            continue;
+        }
+
+        // whatever didn't fit last time goes first, a full ring means there's nothing to do for now
+        if (!this->flushPending ())
+            return true;
 
-    if (clone == nullptr) {
-        av_packet_unref (clone);
-        return;
+        int ret = avcodec_receive_frame (this->m_context, this->m_decodeFrame);
+
+        if (ret == 0) {
+            const int size = this->resampleAudio ();
+
+            this->m_pendingSize = std::max (size, 0);
+            this->m_pendingOffset = 0;
+            this->m_decodedTime += static_cast<double> (this->m_pendingSize) / this->m_bytesPerSecond;
+
+            av_frame_unref (this->m_decodeFrame);
+            continue;
+        }
+
+        if (ret == AVERROR_EOF) {
+            // the decoder played out everything up to the end of the file
+            if (!this->m_repeat) {
+                if (this->m_drained)
+                    break;
+
+                // the resampler still holds the very end of the sound, repeating sounds keep it for the next loop
+                this->m_pendingSize = std::max (this->drainResampler (), 0);
+                this->m_pendingOffset = 0;
+                this->m_drained = true;
+                continue;
+            }
+
+            // seek to the beginning of the file again
+            avformat_seek_file (this->m_formatContext, this->m_audioStream, 0, 0, 0, ~AVSEEK_FLAG_FRAME);
+            avcodec_flush_buffers (this->m_context);
+            this->m_decodedTime = 0.0;
+            continue;
+        }
+
+        if (ret != AVERROR (EAGAIN))
+            break;
+
+        // the decoder needs more data
+        ret = av_read_frame (this->m_formatContext, this->m_readPacket);
+
+        if (ret == AVERROR_EOF) {
+            // drain the decoder so the end of the file is played too
+            avcodec_send_packet (this->m_context, nullptr);
+            continue;
+        }
+
+        if (ret < 0)
+            break;
+
+        // broken packets are skipped, the next ones might still decode fine
+        if (this->m_readPacket->stream_index == this->m_audioStream)
+            avcodec_send_packet (this->m_context, this->m_readPacket);
+
+        av_packet_unref (this->m_readPacket);
     }
 
-    av_packet_move_ref (clone, pkt);
+    this->stop ();
 
-    SDL_LockMutex (this->m_queue->mutex);
-    const bool gotQueued = this->doQueue (clone);
-    SDL_UnlockMutex (this->m_queue->mutex);
+    return false;
+}
+
+bool AudioStream::flushPending () {
+    if (this->m_pendingOffset >= this->m_pendingSize)
+        return true;
+
+    const uint8_t* data = this->m_resampled.data () + this->m_pendingOffset;
+    const size_t size = this->m_pendingSize - this->m_pendingOffset;
 
-    if (!gotQueued)
-        av_packet_free (&pkt);
+    if (this->m_decodeTarget != nullptr) {
+        this->m_decodeTarget->insert (this->m_decodeTarget->end (), data, data + size);
+        this->m_pendingOffset = this->m_pendingSize;
+    } else {
+        this->m_pendingOffset += this->m_samples->write (data, size);
+    }
+
+    return this->m_pendingOffset >= this->m_pendingSize;
 }
 
-bool AudioStream::doQueue (AVPacket* pkt) {
-    MyAVPacketList entry {pkt};
+void AudioStream::seekAhead (const int64_t nanoseconds) {
+    // streams without a file of their own can't seek, they just play on from where they were
+    if (this->m_formatContext == nullptr)
+        return;
+
+    const int64_t length = this->m_formatContext->duration;
+    const double duration = length == AV_NOPTS_VALUE ? 0.0 : static_cast<double> (length) / AV_TIME_BASE;
+    // the driver didn't play what's still in the ring or waiting to go in, playback is that far behind the decoder
+    const double unplayed =
+        static_cast<double> (this->m_samples->available () + this->m_pendingSize - this->m_pendingOffset) /
+        this->m_bytesPerSecond;
+    double target = this->m_decodedTime - unplayed + static_cast<double> (nanoseconds) / 1000000000.0;
+
+    if (duration > 0.0) {
+        if (target >= duration && !this->m_repeat) {
+            this->stop ();
+            return;
+        }
 
-#if FF_API_FIFO_OLD_API
-    if (av_fifo_space (this->m_queue->packetList) < static_cast <int> (sizeof (entry)))
-        if (av_fifo_grow (this->m_queue->packetList, sizeof (entry)) < 0)
-            return false;
+        // the ring can hold the end of the last loop while the decoder is already at the start of the next
+        target = std::fmod (target + duration, duration);
+    }
 
-    av_fifo_generic_write (this->m_queue->packetList, &entry, sizeof (entry), nullptr);
-#else
-    // write the entry if possible
-    if (av_fifo_write (this->m_queue->packetList, &entry, 1) < 0)
-        return false;
-#endif
+    target = std::max (target, 0.0);
 
-    this->m_queue->nb_packets++;
-    this->m_queue->size += entry.packet->size + sizeof (entry);
-    this->m_queue->duration += entry.packet->duration;
+    const int64_t timestamp = av_rescale_q (
+        static_cast<int64_t> (target * AV_TIME_BASE), AVRational {1, AV_TIME_BASE}, this->getTimeBase ());
 
-    SDL_CondSignal (this->m_queue->cond);
+    avformat_seek_file (this->m_formatContext, this->m_audioStream, INT64_MIN, timestamp, timestamp, 0);
+    avcodec_flush_buffers (this->m_context);
 
-    return true;
+    this->m_pendingSize = 0;
+    this->m_pendingOffset = 0;
+    this->m_drained = false;
+    this->m_decodedTime = target;
+    this->m_samples->clear ();
 }
 
-void AudioStream::dequeuePacket () {
-    MyAVPacketList entry{};
+bool AudioStream::isStreaming () const {
+    return this->m_samples != nullptr;
+}
 
-    SDL_LockMutex (this->m_queue->mutex);
+double AudioStream::getBufferedTime () const {
+    if (this->m_samples == nullptr || this->isSkipping ())
+        return 0.0;
 
-    while (this->m_audioContext.getApplicationContext ().state.general.keepRunning) {
-#if FF_API_FIFO_OLD_API
-        int ret = -1;
+    return static_cast<double> (this->m_samples->available ()) / this->m_bytesPerSecond;
+}
 
-        if (av_fifo_size (this->m_queue->packetList) >= static_cast <int> (sizeof (entry)))
-            ret = av_fifo_generic_read (this->m_queue->packetList, &entry, sizeof (entry), nullptr);
-#else
-        const int ret = av_fifo_read (this->m_queue->packetList, &entry, 1);
-#endif
+void AudioStream::skip (const std::chrono::steady_clock::duration duration) {
+    this->m_skip.fetch_add (
+        std::chrono::duration_cast<std::chrono::nanoseconds> (duration).count (), std::memory_order_release);
+}
+
+bool AudioStream::isSkipping () const {
+    return this->m_skip.load (std::memory_order_acquire) > 0;
+}
 
-        // enough data available, read it
-        if (ret >= 0) {
-            this->m_queue->nb_packets--;
-            this->m_queue->size -= entry.packet->size + sizeof (entry);
-            this->m_queue->duration -= entry.packet->duration;
+size_t AudioStream::readSamples (uint8_t* audioBuffer, const size_t bufferSize) {
+    if (this->m_decoded != nullptr)
+        return this->readDecoded (audioBuffer, bufferSize);
 
-            // move the reference and free the old one
-            av_packet_move_ref (this->m_decodePacket, entry.packet);
-            av_packet_free (&entry.packet);
-            break;
+    // the ring still has what was decoded before the jump, silence is better than the wrong part of the sound
+    if (this->isSkipping ())
+        return 0;
+
+    return this->m_samples->read (audioBuffer, bufferSize);
+}
+
+size_t AudioStream::readDecoded (uint8_t* audioBuffer, const size_t bufferSize) {
+    const size_t size = this->m_decoded->size ();
+    size_t copied = 0;
+
+    // nothing to decode, the position just moves on. Whole sample frames only so the channels don't swap
+    if (const int64_t skip = this->m_skip.exchange (0, std::memory_order_acquire); skip > 0 && size > 0) {
+        const size_t frameSize = this->m_bytesPerSecond / this->m_audioContext.getSampleRate ();
+        const size_t frames = static_cast<size_t> (
+            static_cast<double> (skip) / 1000000000.0 * this->m_audioContext.getSampleRate ());
+        const size_t position = this->m_decodedPosition + frames * frameSize;
+
+        this->m_decodedPosition = this->m_repeat ? position % size : std::min (position, size);
+    }
+
+    while (copied < bufferSize && size > 0) {
+        if (this->m_decodedPosition >= size) {
+            // one-shots stop once played, just like streams do at the end of their file
+            if (!this->m_repeat) {
+                this->stop ();
+                break;
+            }
+
+            this->m_decodedPosition = 0;
         }
 
-        // make the thread wait if nothing was available
-        SDL_CondWait (this->m_queue->cond, this->m_queue->mutex);
+        const size_t count = std::min (bufferSize - copied, size - this->m_decodedPosition);
+
+        memcpy (audioBuffer + copied, this->m_decoded->data () + this->m_decodedPosition, count);
+
+        copied += count;
+        this->m_decodedPosition += count;
     }
 
-    SDL_UnlockMutex (this->m_queue->mutex);
+    return copied;
 }
 
 AVCodecContext* AudioStream::getContext () const {
@@ -373,20 +472,16 @@ bool AudioStream::isRepeat () const {
     return this->m_repeat;
 }
 
-ReadStreamSharedPtr& AudioStream::getBuffer () {
-    return this->m_buffer;
-}
-
-SDL_cond* AudioStream::getWaitCondition () const {
-    return this->m_queue->wait;
+void AudioStream::setVolume (const float volume) {
+    this->m_volume = std::max (volume, 0.0f);
 }
 
-size_t AudioStream::getQueueSize () const {
-    return this->m_queue->size;
+float AudioStream::getVolume () const {
+    return this->m_volume;
 }
 
-int AudioStream::getQueuePacketCount () const {
-    return this->m_queue->nb_packets;
+ReadStreamSharedPtr& AudioStream::getBuffer () {
+    return this->m_buffer;
 }
 
 AVRational AudioStream::getTimeBase () const {
@@ -397,18 +492,6 @@ AVRational AudioStream::getTimeBase () const {
     return this->m_formatContext->streams [this->m_audioStream]->time_base;
 }
 
-int64_t AudioStream::getQueueDuration () const {
-    return this->m_queue->duration;
-}
-
-bool AudioStream::isQueueEmpty () const {
-    return this->m_queue->nb_packets == 0;
-}
-
-SDL_mutex* AudioStream::getMutex () const {
-    return this->m_queue->mutex;
-}
-
 void AudioStream::stop () {
     if (!this->isInitialized ())
         return;
@@ -417,14 +500,7 @@ void AudioStream::stop () {
     this->m_initialized = false;
 }
 
-int AudioStream::resampleAudio (uint8_t* out_buf, const int out_size) {
-    int out_linesize = 0;
-    int ret;
-    int out_nb_channels;
-    int out_nb_samples;
-    uint8_t** resampled_data = nullptr;
-    int resampled_data_size;
-
+int AudioStream::resampleAudio () {
     // retrieve number of audio samples (per channel)
     const int in_nb_samples = this->m_decodeFrame->nb_samples;
     if (in_nb_samples <= 0) {
@@ -432,40 +508,8 @@ int AudioStream::resampleAudio (uint8_t* out_buf, const int out_size) {
         return -1;
     }
 
-    int max_out_nb_samples = out_nb_samples = av_rescale_rnd (in_nb_samples, this->m_audioContext.getSampleRate (),
-                                                              this->getContext ()->sample_rate, AV_ROUND_UP);
-
-    // check rescaling was successful
-    if (max_out_nb_samples <= 0) {
-        sLog.error ("av_rescale_rnd error.");
-        return -1;
-    }
-
-    // get number of output audio channels
-#if FF_API_OLD_CHANNEL_LAYOUT
-    int64_t out_channel_layout;
-
-    // set output audio channels based on the input audio channels
-    switch (this->m_audioContext.getChannels ()) {
-        case 1: out_channel_layout = AV_CH_LAYOUT_MONO; break;
-        case 2: out_channel_layout = AV_CH_LAYOUT_STEREO; break;
-        default: out_channel_layout = AV_CH_LAYOUT_SURROUND; break;
-    }
-
-    out_nb_channels = av_get_channel_layout_nb_channels (out_channel_layout);
-#else
-    out_nb_channels = this->getContext ()->ch_layout.nb_channels;
-#endif
-    ret = av_samples_alloc_array_and_samples (&resampled_data, &out_linesize, out_nb_channels, out_nb_samples,
-                                              this->m_audioContext.getFormat (), 0);
-
-    if (ret < 0) {
-        sLog.error ("av_samples_alloc_array_and_samples() error: Could not allocate destination samples.");
-        return -1;
-    }
-
     // retrieve output samples number taking into account the progressive delay
-    out_nb_samples =
+    const int out_nb_samples =
         av_rescale_rnd (swr_get_delay (this->m_swrctx, this->getContext ()->sample_rate) + in_nb_samples,
                         this->m_audioContext.getSampleRate (), this->getContext ()->sample_rate, AV_ROUND_UP);
 
@@ -475,26 +519,21 @@ int AudioStream::resampleAudio (uint8_t* out_buf, const int out_size) {
         return -1;
     }
 
-    if (out_nb_samples > max_out_nb_samples) {
-        // free memory block and set pointer to NULL
-        av_freep (&resampled_data [0]);
+    const int out_nb_channels = this->m_audioContext.getChannels ();
+    const int bytesPerSample = av_get_bytes_per_sample (this->m_audioContext.getFormat ());
 
-        // Allocate a samples buffer for out_nb_samples samples
-        ret = av_samples_alloc (resampled_data, &out_linesize, out_nb_channels, out_nb_samples,
-                                this->m_audioContext.getFormat (), 1);
+    // the output buffer only ever grows, so it settles after the first few frames
+    if (const size_t required = static_cast<size_t> (out_nb_samples) * out_nb_channels * bytesPerSample;
+        this->m_resampled.size () < required)
+        this->m_resampled.resize (required);
 
-        // check samples buffer correctly allocated
-        if (ret < 0) {
-            sLog.error ("av_samples_alloc failed.");
-            return -1;
-        }
-
-        max_out_nb_samples = out_nb_samples;
-    }
+    // the driver's formats are all packed, so everything goes into one plane
+    uint8_t* out = this->m_resampled.data ();
 
     // do the actual audio data resampling
-    ret = swr_convert (this->m_swrctx, resampled_data, max_out_nb_samples,
-    const_cast<const uint8_t**> (this->m_decodeFrame->data), this->m_decodeFrame->nb_samples);
+    const int ret = swr_convert (this->m_swrctx, &out, out_nb_samples,
+                                 const_cast<const uint8_t**> (this->m_decodeFrame->data),
+                                 this->m_decodeFrame->nb_samples);
 
     // check audio conversion was successful
     if (ret < 0) {
@@ -502,78 +541,46 @@ int AudioStream::resampleAudio (uint8_t* out_buf, const int out_size) {
         return -1;
     }
 
-    // Get the required buffer size for the given audio parameters
-    resampled_data_size =
-        av_samples_get_buffer_size (&out_linesize, out_nb_channels, ret, this->m_audioContext.getFormat (), 1);
-
-    // check audio buffer size
-    if (resampled_data_size < 0) {
-        sLog.error ("av_samples_get_buffer_size error.");
-        return -1;
-    }
-
-    // copy the resampled data to the output buffer up to out_size bytes
-    memcpy (out_buf, resampled_data [0], std::min(resampled_data_size, out_size));
+    return ret * out_nb_channels * bytesPerSample;
+}
 
-    // memory cleanup
-    if (resampled_data) {
-        // free memory block and set pointer to NULL
-        av_freep (&resampled_data [0]);
+void AudioStream::configureResampler () {
+    const std::string& quality = this->m_audioContext.getApplicationContext ().settings.audio.resampler;
+
+    if (quality == "fast") {
+        // the shortest filter there is, interpolated linearly between its phases
+        av_opt_set_int (this->m_swrctx, "filter_size", 1, 0);
+        av_opt_set_int (this->m_swrctx, "phase_shift", 0, 0);
+        av_opt_set_int (this->m_swrctx, "linear_interp", 1, 0);
+    } else if (quality == "soxr") {
+        av_opt_set_int (this->m_swrctx, "resampler", SWR_ENGINE_SOXR, 0);
+        av_opt_set_int (this->m_swrctx, "precision", 28, 0);
     }
-
-    av_freep (&resampled_data);
-
-    return resampled_data_size;
 }
 
-int AudioStream::decodeFrame (uint8_t* audioBuffer, const int bufferSize) {
-    static int audio_pkt_size = 0;
+int AudioStream::drainResampler () {
+    const int out_nb_samples = swr_get_out_samples (this->m_swrctx, 0);
 
-    // block until there's any data in the buffers
-    while (this->m_audioContext.getApplicationContext ().state.general.keepRunning) {
-        while (audio_pkt_size > 0 && this->m_audioContext.getApplicationContext ().state.general.keepRunning) {
-            int got_frame = 0;
-            int ret = avcodec_receive_frame (this->getContext (), this->m_decodeFrame);
+    if (out_nb_samples <= 0)
+        return 0;
 
-            if (ret == 0)
-                got_frame = 1;
-            if (ret == AVERROR (EAGAIN))
-                ret = 0;
-            if (ret == 0)
-                ret = avcodec_send_packet (this->getContext (), this->m_decodePacket);
-            if (ret < 0 && ret != AVERROR (EAGAIN))
-                return -1;
+    const int out_nb_channels = this->m_audioContext.getChannels ();
+    const int bytesPerSample = av_get_bytes_per_sample (this->m_audioContext.getFormat ());
 
-            if (this->m_decodePacket->size < 0) {
-                // if error, skip frame
-                audio_pkt_size = 0;
-                break;
-            }
+    if (const size_t required = static_cast<size_t> (out_nb_samples) * out_nb_channels * bytesPerSample;
+        this->m_resampled.size () < required)
+        this->m_resampled.resize (required);
 
-            audio_pkt_size -= this->m_decodePacket->size;
-            int data_size = 0;
+    uint8_t* out = this->m_resampled.data ();
+    // no input means flush whatever the filter is still holding
+    const int ret = swr_convert (this->m_swrctx, &out, out_nb_samples, nullptr, 0);
 
-            if (got_frame) {
-                // audio resampling
-                data_size = this->resampleAudio (audioBuffer, bufferSize);
-            }
-            if (data_size <= 0) {
-                // no data found, keep waiting
-                continue;
-            }
-            // some data was found
-            return data_size;
-        }
-
-        if (this->m_decodePacket->data)
-            av_packet_unref (this->m_decodePacket);
-
-        this->dequeuePacket ();
-
-        audio_pkt_size = this->m_decodePacket->size;
+    if (ret < 0) {
+        sLog.error ("swr_convert_error.");
+        return -1;
     }
 
-    return 0;
+    return ret * out_nb_channels * bytesPerSample;
 }
 
 AudioContext& AudioStream::getAudioContext () const {
@@ -1,31 +1,31 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
+#include <vector>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
-#include <libavutil/fifo.h>
 #include <libavutil/opt.h>
 #include <libswresample/swresample.h>
 #include <libswscale/swscale.h>
 }
 
 #include <SDL.h>
-#include <SDL_thread.h>
 
 #include "WallpaperEngine/Audio/AudioContext.h"
+#include "WallpaperEngine/Audio/SampleRing.h"
 
 // TODO: FIND A BETTER PLACE TO DO THIS? OLD_API MIGHT EXIST BUT THIS DEFINE MIGHT NOT BE DEFINED...
-#ifndef FF_API_FIFO_OLD_API
-#define 	FF_API_FIFO_OLD_API   (LIBAVUTIL_VERSION_MAJOR < 59)
-#endif
 #ifndef FF_API_OLD_CHANNEL_LAYOUT
 #define 	FF_API_OLD_CHANNEL_LAYOUT   (LIBAVUTIL_VERSION_MAJOR < 59)
 #endif
 
-#define MAX_QUEUE_SIZE (5 * 1024 * 1024)
-#define MIN_FRAMES (25)
+/** Seconds of decoded audio kept ready for the audio driver */
+#define SAMPLE_RING_SECONDS (0.5)
 #define NO_AUDIO_STREAM (-1)
 
 namespace WallpaperEngine::Audio {
@@ -33,6 +33,9 @@ class AudioContext;
 
 using namespace WallpaperEngine::FileSystem;
 
+/** A whole sound decoded to the audio driver's format */
+using DecodedSamples = std::shared_ptr<const std::vector<uint8_t>>;
+
 /**
  * Represents a playable audio stream for the audio driver
  */
@@ -41,18 +44,53 @@ class AudioStream {
     AudioStream (AudioContext& context, const std::string& filename);
     AudioStream (AudioContext& context, const ReadStreamSharedPtr& buffer);
     AudioStream (AudioContext& audioContext, AVCodecContext* context);
+    /**
+     * Plays already decoded samples, without any decoder or read thread of its own
+     *
+     * @param context
+     * @param samples
+     */
+    AudioStream (AudioContext& context, DecodedSamples samples);
     ~AudioStream ();
 
-    void queuePacket (AVPacket* pkt);
+    /**
+     * Decodes the whole sound to the driver's format at once
+     *
+     * @param context
+     * @param buffer
+     * @param maxSeconds Longest sound to decode
+     *
+     * @return The samples, nullptr if the sound is longer than maxSeconds or its length is unknown
+     */
+    [[nodiscard]] static DecodedSamples decode (
+        AudioContext& context, const ReadStreamSharedPtr& buffer, double maxSeconds);
 
     /**
-     * Gets the next packet in the queue
+     * Decodes until the sample ring is full, never waits for the driver to make space. Only one thread may call it
+     * at a time, usually one of the DecoderPool's
      *
-     * WARNING: BLOCKS UNTIL SOME DATA IS READ FROM IT
+     * @return If the stream still has something to play, false once it ended or failed and got stopped
+     */
+    bool fill ();
+    /**
+     * @return If the stream decodes into a sample ring and needs fill () to be called
+     */
+    [[nodiscard]] bool isStreaming () const;
+    /**
+     * @return Seconds of decoded audio waiting for the driver, 0 while a skip () is pending as none of it will play
+     */
+    [[nodiscard]] double getBufferedTime () const;
+    /**
+     * Moves playback ahead as if the stream kept playing, used for the time the driver was muted. Streams seek
+     * once on their decoder thread instead of decoding through it, sounds that end in the meantime are stopped
      *
-     * @return
+     * @param duration
      */
-    void dequeuePacket ();
+    void skip (std::chrono::steady_clock::duration duration);
+    /**
+     * @return If a skip () didn't happen yet, the stream plays nothing until it did
+     */
+    [[nodiscard]] bool isSkipping () const;
 
     /**
      * @return The audio context in use for this audio stream
@@ -84,54 +122,62 @@ class AudioStream {
      */
     [[nodiscard]] bool isRepeat () const;
     /**
-     * Stops decoding and playbak of the stream
-     */
-    void stop ();
-    /**
-     * @return The file data buffer
-     */
-    [[nodiscard]] ReadStreamSharedPtr& getBuffer ();
-    /**
-     * @return The SDL_cond used to signal waiting for data
+     * @param volume Volume of this stream in the mix, 0 skips mixing it altogether
      */
-    [[nodiscard]] SDL_cond* getWaitCondition () const;
+    void setVolume (float volume);
     /**
-     * @return The data queue size
+     * @return Volume of this stream in the mix
      */
-    [[nodiscard]] size_t getQueueSize () const;
+    [[nodiscard]] float getVolume () const;
     /**
-     * @return The amount of packets ready to be converted and played
+     * Stops decoding and playbak of the stream
      */
-    [[nodiscard]] int getQueuePacketCount () const;
+    void stop ();
     /**
-     * @return The duration (in seconds) of the queued data to be played
+     * @return The file data buffer
      */
-    [[nodiscard]] int64_t getQueueDuration () const;
+    [[nodiscard]] ReadStreamSharedPtr& getBuffer ();
     /**
      * @return Time unit used for packet playback
      */
     [[nodiscard]] AVRational getTimeBase () const;
+
+    /**
+     * Copies decoded audio, already in the driver's format, out of the sample ring
+     *
+     * Never blocks, locks or allocates, so it's safe to call from the driver's real-time callback
+     *
+     * @param audioBuffer
+     * @param bufferSize
+     *
+     * @return The amount of bytes copied, less than bufferSize if the decoder fell behind
+     */
+    size_t readSamples (uint8_t* audioBuffer, size_t bufferSize);
+
+  private:
     /**
-     * @return If the data queue is empty or not
+     * Opens the buffer only to decode it all into target, used by decode ()
+     *
+     * @param context
+     * @param buffer
+     * @param target
      */
-    [[nodiscard]] bool isQueueEmpty () const;
+    AudioStream (AudioContext& context, const ReadStreamSharedPtr& buffer, std::vector<uint8_t>& target);
     /**
-     * @return The SDL_mutex used for thread synchronization
+     * Sets up ffmpeg to read its data off the buffer
+     *
+     * @param buffer
      */
-    [[nodiscard]] SDL_mutex* getMutex () const;
-
+    void openBuffer (const ReadStreamSharedPtr& buffer);
     /**
-     * Reads a frame from the audio stream, resamples it to the driver's settings
-     * and returns the data ready to be played
+     * Copies the decoded samples out, from where the last call left off
      *
      * @param audioBuffer
      * @param bufferSize
      *
-     * @return The amount of bytes available or < 0 for error
+     * @return The amount of bytes copied
      */
-    int decodeFrame (uint8_t* audioBuffer, int bufferSize);
-
-  private:
+    size_t readDecoded (uint8_t* audioBuffer, size_t bufferSize);
     /**
      * Initializes ffmpeg to read the given file
      *
@@ -139,32 +185,48 @@ class AudioStream {
      */
     void loadCustomContent (const char* filename = nullptr);
     /**
-     * Converts the audio frame from the original format to one supported by the audio driver
+     * Converts the audio frame from the original format to one supported by the audio driver into m_resampled
+     *
+     * @return The amount of bytes converted or < 0 for error
+     */
+    int resampleAudio ();
+    /**
+     * Moves what's left of m_resampled to the sample ring, or to the decode target
      *
-     * @param out_buf
-     * @return
+     * @return If everything was moved
      */
-    int resampleAudio (uint8_t* out_buf, const int out_size);
+    bool flushPending ();
     /**
-     * Queues a packet into the play queue
+     * Seeks the file to where playback would be after the given time, dropping everything decoded before
      *
-     * @param pkt
-     * @return
+     * @param nanoseconds
      */
-    bool doQueue (AVPacket* pkt);
+    void seekAhead (int64_t nanoseconds);
     /**
-     * Initializes queues and ffmpeg resampling
+     * Initializes the sample ring and ffmpeg resampling
      */
     void initialize ();
+    /**
+     * Applies the --audio-resampler quality to the resampling context, before it's initialized
+     */
+    void configureResampler ();
+    /**
+     * Takes what's still in the resampler's delay line at the end of the sound into m_resampled
+     *
+     * @return Bytes written to m_resampled
+     */
+    int drainResampler ();
 
     /** The SwrContext that handles resampling */
     SwrContext* m_swrctx = nullptr;
     /** The audio context this stream will be played under */
     AudioContext& m_audioContext;
-    /** If this stream was properly initialized or not */
-    bool m_initialized = false;
+    /** If this stream was properly initialized or not, read by the audio driver's thread too */
+    std::atomic<bool> m_initialized = false;
     /** Repeat enabled? */
     bool m_repeat = false;
+    /** Volume of the stream in the mix, read by the audio driver's thread */
+    std::atomic<float> m_volume = 1.0f;
     /** The codec context that contains the original audio format information */
     AVCodecContext* m_context = nullptr;
     /** The format context that controls how data is read off the file */
@@ -176,30 +238,31 @@ class AudioStream {
     /** The length of the file data pointer */
     uint32_t m_length = 0;
 
-    struct MyAVPacketList {
-        AVPacket* packet;
-    };
-
-    /** The packet used while decoding this stream */
-    AVPacket* m_decodePacket = nullptr;
     /** The AV frame used while decoding this stream */
     AVFrame* m_decodeFrame = nullptr;
-
-    /**
-     * Packet queue information
-     */
-    struct PacketQueue {
-#if FF_API_FIFO_OLD_API
-        AVFifoBuffer* packetList = nullptr;
-#else
-        AVFifo* packetList = nullptr;
-#endif
-        int nb_packets = 0;
-        size_t size = 0;
-        int64_t duration = 0;
-        SDL_mutex* mutex = nullptr;
-        SDL_cond* wait = nullptr;
-        SDL_cond* cond = nullptr;
-    }* m_queue {};
+    /** The packet read off the file before it's sent to the decoder */
+    AVPacket* m_readPacket = nullptr;
+    /** Output of the resampler, only touched by whoever is calling fill () */
+    std::vector<uint8_t> m_resampled = {};
+    /** Bytes of m_resampled that are valid */
+    size_t m_pendingSize = 0;
+    /** Bytes of m_resampled already moved to the sample ring */
+    size_t m_pendingOffset = 0;
+    /** The resampler gave out its last samples, the sound can end */
+    bool m_drained = false;
+    /** Decoded samples waiting for the audio driver */
+    std::unique_ptr<SampleRing> m_samples = nullptr;
+    /** Bytes the audio driver plays every second */
+    size_t m_bytesPerSecond = 0;
+    /** Seconds into the file the last resampled sample is, only touched by whoever is calling fill () */
+    double m_decodedTime = 0.0;
+    /** Nanoseconds of playback skip () asked to jump over */
+    std::atomic<int64_t> m_skip = 0;
+    /** Where decode () collects the samples, nullptr when playing */
+    std::vector<uint8_t>* m_decodeTarget = nullptr;
+    /** Samples played instead of decoding, shared with every other stream of the same sound */
+    DecodedSamples m_decoded = nullptr;
+    /** Position in m_decoded, only touched by the audio driver's thread */
+    size_t m_decodedPosition = 0;
 };
 } // namespace WallpaperEngine::Audio
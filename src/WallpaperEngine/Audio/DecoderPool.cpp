@@ -0,0 +1,96 @@
+#include "DecoderPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "AudioStream.h"
+
+using namespace WallpaperEngine::Audio;
+
+namespace {
+/** Rings with less than this many seconds buffered get filled */
+constexpr double REFILL_BELOW = SAMPLE_RING_SECONDS / 2.0;
+/** Longest a thread sleeps without checking the rings, bounds how late a resumed stream starts */
+constexpr auto MAXIMUM_SLEEP = std::chrono::milliseconds (100);
+} // namespace
+
+DecoderPool::DecoderPool (const unsigned int threads) {
+    for (unsigned int i = 0; i < std::max (threads, 1u); i++)
+        this->m_threads.emplace_back (&DecoderPool::work, this);
+}
+
+DecoderPool::~DecoderPool () {
+    {
+        std::lock_guard lock (this->m_mutex);
+        this->m_running = false;
+    }
+
+    this->m_condition.notify_all ();
+
+    for (auto& thread : this->m_threads)
+        thread.join ();
+}
+
+void DecoderPool::add (AudioStream* stream) {
+    {
+        std::lock_guard lock (this->m_mutex);
+        this->m_streams.push_back (stream);
+    }
+
+    // the ring is empty, it should start filling right away
+    this->m_condition.notify_one ();
+}
+
+void DecoderPool::remove (AudioStream* stream) {
+    std::unique_lock lock (this->m_mutex);
+
+    this->m_condition.wait (lock, [this, stream] { return !this->m_busy.contains (stream); });
+
+    std::erase (this->m_streams, stream);
+}
+
+void DecoderPool::work () {
+    std::unique_lock lock (this->m_mutex);
+
+    while (this->m_running) {
+        AudioStream* next = nullptr;
+        double lowest = REFILL_BELOW;
+        // time until the fullest ring not being filled needs it
+        double sleep = std::chrono::duration<double> (MAXIMUM_SLEEP).count ();
+
+        for (AudioStream* stream : this->m_streams) {
+            if (this->m_busy.contains (stream))
+                continue;
+
+            const double buffered = stream->getBufferedTime ();
+
+            if (buffered < lowest) {
+                lowest = buffered;
+                next = stream;
+            }
+
+            sleep = std::min (sleep, buffered - REFILL_BELOW);
+        }
+
+        if (next == nullptr) {
+            this->m_condition.wait_for (
+                lock, std::chrono::duration<double> (std::max (sleep, 0.001)));
+            continue;
+        }
+
+        this->m_busy.insert (next);
+        lock.unlock ();
+
+        const bool alive = next->fill ();
+
+        lock.lock ();
+        this->m_busy.erase (next);
+
+        // streams that ended have nothing left to decode
+        if (!alive)
+            std::erase (this->m_streams, next);
+
+        // remove () might be waiting on this stream
+        this->m_condition.notify_all ();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace WallpaperEngine::Audio {
+class AudioStream;
+
+/**
+ * A few threads that keep the sample rings of every streaming AudioStream filled
+ *
+ * The emptiest ring is always filled first. While every ring has enough buffered the threads sleep until the first
+ * one runs low, so paused or muted streams (whose rings never empty) cost nothing
+ */
+class DecoderPool {
+  public:
+    /**
+     * @param threads
+     */
+    explicit DecoderPool (unsigned int threads);
+    ~DecoderPool ();
+
+    DecoderPool (const DecoderPool&) = delete;
+    DecoderPool& operator= (const DecoderPool&) = delete;
+
+    /**
+     * Starts decoding the stream, until it ends or is removed
+     *
+     * @param stream
+     */
+    void add (AudioStream* stream);
+    /**
+     * Stops decoding the stream, waits for a thread that's still decoding it
+     *
+     * @param stream
+     */
+    void remove (AudioStream* stream);
+
+  private:
+    void work ();
+
+    std::mutex m_mutex;
+    /** Signaled when streams are added or a thread finished filling one */
+    std::condition_variable m_condition;
+    std::vector<AudioStream*> m_streams = {};
+    /** Streams a thread is filling right now */
+    std::set<AudioStream*> m_busy = {};
+    std::vector<std::thread> m_threads = {};
+    bool m_running = true;
+};
+} // namespace WallpaperEngine::Audio
@@ -10,8 +10,8 @@ AudioDriver::AudioDriver (
     m_recorder (recorder) {}
 
 void AudioDriver::update () {
+    // the detector is updated by the ControlThread, it waits on PulseAudio
     this->m_recorder.update ();
-    this->m_detector.update ();
 }
 
 Application::ApplicationContext& AudioDriver::getApplicationContext () const {
@@ -40,6 +40,12 @@ class AudioDriver {
      * @param stream
      */
     virtual void addStream (AudioStream* stream) = 0;
+    /**
+     * Stops playing the given stream, once this returns the driver doesn't touch it anymore
+     *
+     * @param stream
+     */
+    virtual void removeStream (AudioStream* stream) = 0;
 
     /**
      * Updates status of the different audio settings
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "WallpaperEngine/Application/ApplicationContext.h"
 #include "WallpaperEngine/Render/Drivers/Detectors/FullScreenDetector.h"
 
@@ -52,7 +54,8 @@ class AudioPlayingDetector {
     [[nodiscard]] const Render::Drivers::Detectors::FullScreenDetector& getFullscreenDetector () const;
 
   private:
-    bool m_isPlaying = false;
+    /** written by the control thread, read by the streams */
+    std::atomic<bool> m_isPlaying = false;
 
     Application::ApplicationContext& m_applicationContext;
     const Render::Drivers::Detectors::FullScreenDetector& m_fullscreenDetector;
@@ -1,34 +1,11 @@
 #include "PulseAudioPlayingDetector.h"
 #include "WallpaperEngine/Logging/Log.h"
 
+#include <algorithm>
+#include <ranges>
 #include <unistd.h>
 
 namespace WallpaperEngine::Audio::Drivers::Detectors {
-void sinkInputInfoCallback (pa_context* context, const pa_sink_input_info* info, int eol, void* userdata) {
-    auto* detector = static_cast<PulseAudioPlayingDetector*> (userdata);
-
-    if (info == nullptr)
-        return;
-
-    if (info->proplist == nullptr)
-        return;
-
-    // get processid
-    const char* value = pa_proplist_gets (info->proplist, PA_PROP_APPLICATION_PROCESS_ID);
-
-    if (value && strtol (value, nullptr, 10) != getpid () && pa_cvolume_avg (&info->volume) != PA_VOLUME_MUTED)
-        detector->setIsPlaying (true);
-}
-
-void defaultSinkInfoCallback (pa_context* context, const pa_server_info* info, void* userdata) {
-    if (info == nullptr)
-        return;
-
-    pa_operation* op = pa_context_get_sink_input_info_list (context, sinkInputInfoCallback, userdata);
-
-    pa_operation_unref (op);
-}
-
 PulseAudioPlayingDetector::PulseAudioPlayingDetector (
     Application::ApplicationContext& appContext,
     const Render::Drivers::Detectors::FullScreenDetector& fullscreenDetector) :
@@ -37,14 +14,34 @@ PulseAudioPlayingDetector::PulseAudioPlayingDetector (
     this->m_mainloopApi = pa_mainloop_get_api (this->m_mainloop);
     this->m_context = pa_context_new (this->m_mainloopApi, "wallpaperengine");
 
-    pa_context_connect (this->m_context, nullptr, PA_CONTEXT_NOFLAGS, nullptr);
+    pa_context_set_state_callback (this->m_context, &PulseAudioPlayingDetector::onContextState, this);
+
+    if (pa_context_connect (this->m_context, nullptr, PA_CONTEXT_NOFLAGS, nullptr) < 0) {
+        sLog.error ("PulseAudio connection failed! Automute is disabled");
+        return;
+    }
+
+    // lock until pulseaudio allows connection, the streams playing already are listed once it does
+    while (pa_context_get_state (this->m_context) != PA_CONTEXT_READY) {
+        if (!PA_CONTEXT_IS_GOOD (pa_context_get_state (this->m_context))) {
+            sLog.error ("PulseAudio context initialization failed. Automute is disabled");
+            return;
+        }
 
-    // lock until pulseaudio allows connection
-    while (pa_context_get_state (this->m_context) != PA_CONTEXT_READY)
         pa_mainloop_iterate (this->m_mainloop, 1, nullptr);
+    }
+
+    // from here on the main loop only runs on this thread
+    this->m_thread = std::thread (&PulseAudioPlayingDetector::run, this);
 }
 
 PulseAudioPlayingDetector::~PulseAudioPlayingDetector () {
+    if (this->m_thread.joinable ()) {
+        this->m_running = false;
+        pa_mainloop_wakeup (this->m_mainloop);
+        this->m_thread.join ();
+    }
+
     if (this->m_context) {
         pa_context_disconnect (this->m_context);
         pa_context_unref (this->m_context);
@@ -54,22 +51,87 @@ PulseAudioPlayingDetector::~PulseAudioPlayingDetector () {
         pa_mainloop_free (this->m_mainloop);
 }
 
-void PulseAudioPlayingDetector::update () {
-    if (!this->getApplicationContext ().settings.audio.automute)
-        return this->setIsPlaying (false);
-    if (this->getFullscreenDetector ().anythingFullscreen ())
-        return this->setIsPlaying (true);
+void PulseAudioPlayingDetector::onContextState (pa_context* context, void* userdata) {
+    if (pa_context_get_state (context) != PA_CONTEXT_READY)
+        return;
 
-    // reset playing state
-    this->setIsPlaying (false);
+    pa_context_set_subscribe_callback (context, &PulseAudioPlayingDetector::onSubscription, userdata);
 
-    // start discovery of sinks
-    pa_operation* op = pa_context_get_server_info (this->m_context, defaultSinkInfoCallback, this);
+    if (pa_operation* op = pa_context_subscribe (context, PA_SUBSCRIPTION_MASK_SINK_INPUT, nullptr, nullptr))
+        pa_operation_unref (op);
 
-    // wait until all the operations are done
-    while (pa_operation_get_state (op) == PA_OPERATION_RUNNING)
-        pa_mainloop_iterate (this->m_mainloop, 1, nullptr);
+    // events only come for what changes from now on
+    pa_operation* op = pa_context_get_sink_input_info_list (context, &PulseAudioPlayingDetector::onSinkInputInfo, userdata);
+
+    if (op)
+        pa_operation_unref (op);
+}
 
-    pa_operation_unref (op);
+void PulseAudioPlayingDetector::onSubscription (
+    pa_context* context, const pa_subscription_event_type_t type, const uint32_t index, void* userdata
+) {
+    auto* detector = static_cast<PulseAudioPlayingDetector*> (userdata);
+
+    if ((type & PA_SUBSCRIPTION_EVENT_FACILITY_MASK) != PA_SUBSCRIPTION_EVENT_SINK_INPUT)
+        return;
+
+    if ((type & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE) {
+        detector->m_streams.erase (index);
+        detector->streamsChanged ();
+        return;
+    }
+
+    // new streams and changes (corking, volume...) need the stream's info to know if it makes sound
+    pa_operation* op =
+        pa_context_get_sink_input_info (context, index, &PulseAudioPlayingDetector::onSinkInputInfo, userdata);
+
+    if (op)
+        pa_operation_unref (op);
+}
+
+void PulseAudioPlayingDetector::onSinkInputInfo (
+    pa_context* context, const pa_sink_input_info* info, int eol, void* userdata
+) {
+    auto* detector = static_cast<PulseAudioPlayingDetector*> (userdata);
+
+    if (info == nullptr || info->proplist == nullptr)
+        return;
+
+    // get processid
+    const char* value = pa_proplist_gets (info->proplist, PA_PROP_APPLICATION_PROCESS_ID);
+
+    // our own sounds don't count
+    if (value == nullptr || strtol (value, nullptr, 10) == getpid ())
+        return;
+
+    detector->m_streams.insert_or_assign (
+        info->index, !info->corked && !info->mute && pa_cvolume_avg (&info->volume) != PA_VOLUME_MUTED);
+    detector->streamsChanged ();
+}
+
+void PulseAudioPlayingDetector::run () {
+    while (this->m_running)
+        if (pa_mainloop_iterate (this->m_mainloop, 1, nullptr) < 0)
+            break;
+}
+
+void PulseAudioPlayingDetector::streamsChanged () {
+    this->m_othersPlaying = std::ranges::any_of (this->m_streams | std::views::values, std::identity {});
+    this->publish ();
+}
+
+void PulseAudioPlayingDetector::publish () {
+    std::lock_guard lock (this->m_publishMutex);
+
+    if (!this->getApplicationContext ().settings.audio.automute)
+        return this->setIsPlaying (false);
+
+    this->setIsPlaying (this->m_fullscreen || this->m_othersPlaying);
+}
+
+void PulseAudioPlayingDetector::update () {
+    // the streams are followed by the PulseAudio thread, only the fullscreen state has to be picked up here
+    this->m_fullscreen = this->getFullscreenDetector ().anythingFullscreen ();
+    this->publish ();
 }
-} // namespace WallpaperEngine::Audio::Drivers::Detectors
\ No newline at end of file
+} // namespace WallpaperEngine::Audio::Drivers::Detectors
@@ -1,11 +1,19 @@
 #pragma once
 
 #include "AudioPlayingDetector.h"
-#include <condition_variable>
+#include <atomic>
+#include <map>
 #include <mutex>
+#include <thread>
 #include <pulse/pulseaudio.h>
 
 namespace WallpaperEngine::Audio::Drivers::Detectors {
+/**
+ * Follows the sink inputs of other applications through PulseAudio's subscription events on a thread of its own
+ *
+ * Every stream added, removed, corked or muted updates a cached answer, so update () never has to ask PulseAudio
+ * anything and auto-mute reacts as soon as the event comes in
+ */
 class PulseAudioPlayingDetector final : public AudioPlayingDetector {
   public:
     explicit PulseAudioPlayingDetector (
@@ -15,8 +23,31 @@ class PulseAudioPlayingDetector final : public AudioPlayingDetector {
     void update () override;
 
   private:
+    static void onContextState (pa_context* context, void* userdata);
+    static void onSubscription (pa_context* context, pa_subscription_event_type_t type, uint32_t index, void* userdata);
+    static void onSinkInputInfo (pa_context* context, const pa_sink_input_info* info, int eol, void* userdata);
+
+    /** Runs PulseAudio's main loop until the detector goes away */
+    void run ();
+    /** Updates m_othersPlaying after m_streams changed and publishes it, only called from the PulseAudio thread */
+    void streamsChanged ();
+    /** Works out if anything is playing from the cached streams and the last fullscreen state */
+    void publish ();
+
     pa_mainloop* m_mainloop = nullptr;
     pa_mainloop_api* m_mainloopApi = nullptr;
     pa_context* m_context = nullptr;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running = true;
+
+    /** Sink inputs of other applications and whether they make any sound, only touched from the PulseAudio thread */
+    std::map<uint32_t, bool> m_streams = {};
+    /** Any of m_streams makes sound */
+    std::atomic<bool> m_othersPlaying = false;
+    /** Last answer of the fullscreen detector, which is only asked from update () */
+    std::atomic<bool> m_fullscreen = false;
+    /** Both threads publish, this keeps an older answer from overwriting a newer one */
+    std::mutex m_publishMutex;
 };
 } // namespace WallpaperEngine::Audio::Drivers::Detectors
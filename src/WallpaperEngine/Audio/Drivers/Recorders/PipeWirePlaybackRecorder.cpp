@@ -0,0 +1,142 @@
+#include "PipeWirePlaybackRecorder.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <algorithm>
+#include <spa/param/audio/format-utils.h>
+
+namespace WallpaperEngine::Audio::Drivers::Recorders {
+PipeWirePlaybackRecorder::PipeWirePlaybackRecorder () {
+    pw_init (nullptr, nullptr);
+
+    this->m_loop = pw_thread_loop_new ("wallpaperengine-audioprocessing", nullptr);
+
+    if (this->m_loop == nullptr || pw_thread_loop_start (this->m_loop) < 0)
+        sLog.error ("PipeWire initialization failed. Audio processing is disabled");
+}
+
+PipeWirePlaybackRecorder::~PipeWirePlaybackRecorder () {
+    if (this->m_loop != nullptr) {
+        pw_thread_loop_lock (this->m_loop);
+        this->disconnect ();
+        pw_thread_loop_unlock (this->m_loop);
+
+        pw_thread_loop_stop (this->m_loop);
+        pw_thread_loop_destroy (this->m_loop);
+    }
+
+    pw_deinit ();
+}
+
+void PipeWirePlaybackRecorder::setRecording (const bool recording) {
+    if (this->m_loop == nullptr)
+        return;
+
+    // the process callback runs with the loop locked, so the stream can't go away under it
+    pw_thread_loop_lock (this->m_loop);
+
+    if (recording)
+        this->connect ();
+    else
+        this->disconnect ();
+
+    pw_thread_loop_unlock (this->m_loop);
+}
+
+void PipeWirePlaybackRecorder::connect () {
+    static const pw_stream_events events = {
+        .version = PW_VERSION_STREAM_EVENTS,
+        .state_changed = &PipeWirePlaybackRecorder::onStateChanged,
+        .process = &PipeWirePlaybackRecorder::onProcess,
+    };
+
+    if (this->m_stream != nullptr)
+        return;
+
+    pw_properties* props = pw_properties_new (
+        PW_KEY_MEDIA_TYPE, "Audio",
+        PW_KEY_MEDIA_CATEGORY, "Capture",
+        PW_KEY_MEDIA_ROLE, "Music",
+        // the monitor of the default sink instead of a microphone
+        PW_KEY_STREAM_CAPTURE_SINK, "true",
+        PW_KEY_NODE_LATENCY, PIPEWIRE_CAPTURE_LATENCY,
+        nullptr);
+
+    this->m_stream = pw_stream_new_simple (
+        pw_thread_loop_get_loop (this->m_loop), "wallpaperengine-audioprocessing", props, &events, this);
+
+    if (this->m_stream == nullptr) {
+        sLog.error ("Cannot create PipeWire stream for capture. Audio processing is disabled");
+        return;
+    }
+
+    spa_audio_info_raw info {};
+
+    info.format = SPA_AUDIO_FORMAT_F32;
+    info.rate = SPECTRUM_SAMPLE_RATE;
+    info.channels = 2;
+    info.position [0] = SPA_AUDIO_CHANNEL_FL;
+    info.position [1] = SPA_AUDIO_CHANNEL_FR;
+
+    uint8_t buffer [1024];
+    spa_pod_builder builder {};
+
+    spa_pod_builder_init (&builder, buffer, sizeof (buffer));
+
+    const spa_pod* params [1] = {spa_format_audio_raw_build (&builder, SPA_PARAM_EnumFormat, &info)};
+
+    // mapped buffers are read in place by onProcess
+    if (pw_stream_connect (
+            this->m_stream, PW_DIRECTION_INPUT, PW_ID_ANY,
+            static_cast<pw_stream_flags> (PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_MAP_BUFFERS), params, 1) < 0) {
+        sLog.error ("Failed to connect to input for recording");
+        this->disconnect ();
+    }
+}
+
+void PipeWirePlaybackRecorder::disconnect () {
+    if (this->m_stream == nullptr)
+        return;
+
+    pw_stream_destroy (this->m_stream);
+    this->m_stream = nullptr;
+
+    // the next capture starts from silence instead of whatever was playing before
+    this->resetCapture ();
+}
+
+void PipeWirePlaybackRecorder::onStateChanged (
+    void* userdata, pw_stream_state old, const pw_stream_state state, const char* error
+) {
+    switch (state) {
+        case PW_STREAM_STATE_ERROR:
+            sLog.error ("Cannot open stream for capture: ", error ? error : "unknown error",
+                        ". Audio processing is disabled");
+            break;
+        case PW_STREAM_STATE_STREAMING: sLog.debug ("Capture stream ready"); break;
+        default: break;
+    }
+}
+
+void PipeWirePlaybackRecorder::onProcess (void* userdata) {
+    auto* recorder = static_cast<PipeWirePlaybackRecorder*> (userdata);
+    pw_buffer* buffer = pw_stream_dequeue_buffer (recorder->m_stream);
+
+    if (buffer == nullptr)
+        return;
+
+    const spa_data& data = buffer->buffer->datas [0];
+
+    // the chunk says which part of the mapped memory holds this quantum's samples
+    if (data.data != nullptr && data.chunk != nullptr) {
+        const uint32_t offset = std::min (data.chunk->offset, data.maxsize);
+        const uint32_t size = std::min (data.chunk->size, data.maxsize - offset);
+
+        recorder->capture (
+            reinterpret_cast<const float*> (static_cast<const uint8_t*> (data.data) + offset),
+            size / (2 * sizeof (float)));
+    }
+
+    pw_stream_queue_buffer (recorder->m_stream, buffer);
+}
+
+} // namespace WallpaperEngine::Audio::Drivers::Recorders
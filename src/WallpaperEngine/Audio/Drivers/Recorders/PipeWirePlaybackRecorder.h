@@ -0,0 +1,39 @@
+#pragma once
+
+#include "SpectrumPlaybackRecorder.h"
+#include <pipewire/pipewire.h>
+
+/** Quantum asked for, a hop of the analysis so every buffer completes one */
+#define PIPEWIRE_CAPTURE_LATENCY "512/44100"
+
+namespace WallpaperEngine::Audio::Drivers::Recorders {
+/**
+ * Records what the default sink plays in float stereo straight from PipeWire and analyzes it on PipeWire's thread
+ *
+ * The samples are read from PipeWire's own buffers, nothing is copied before the analysis. The session manager moves
+ * the stream along when the default sink changes, so it's never rebuilt. The stream only exists while a consumer that
+ * is not paused is registered
+ */
+class PipeWirePlaybackRecorder final : public SpectrumPlaybackRecorder {
+  public:
+    PipeWirePlaybackRecorder ();
+    ~PipeWirePlaybackRecorder () override;
+
+  protected:
+    void setRecording (bool recording) override;
+
+  private:
+    /** Called by PipeWire on its thread when a buffer is ready to read */
+    static void onProcess (void* userdata);
+    /** Logs when the stream fails, called by PipeWire on its thread */
+    static void onStateChanged (void* userdata, pw_stream_state old, pw_stream_state state, const char* error);
+
+    /** Creates and connects the capture stream, the loop has to be locked */
+    void connect ();
+    /** Destroys the capture stream, the loop has to be locked */
+    void disconnect ();
+
+    pw_thread_loop* m_loop = nullptr;
+    pw_stream* m_stream = nullptr;
+};
+} // namespace WallpaperEngine::Audio::Drivers::Recorders
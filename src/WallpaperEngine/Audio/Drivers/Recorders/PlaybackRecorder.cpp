@@ -1,6 +1,55 @@
 #include "PlaybackRecorder.h"
 
+#include <algorithm>
+#include <ranges>
+
 namespace WallpaperEngine::Audio::Drivers::Recorders {
 void PlaybackRecorder::update () {}
 
-} // namespace WallpaperEngine::Audio::Drivers::Recorders
\ No newline at end of file
+void PlaybackRecorder::setConsumer (const void* consumer, const bool paused) {
+    this->m_consumers.insert_or_assign (consumer, paused);
+    this->updateRecording ();
+}
+
+void PlaybackRecorder::removeConsumer (const void* consumer) {
+    this->m_consumers.erase (consumer);
+    this->updateRecording ();
+}
+
+bool PlaybackRecorder::isRecording () const {
+    return this->m_recording;
+}
+
+uint64_t PlaybackRecorder::getGeneration () const {
+    return this->m_generation;
+}
+
+void PlaybackRecorder::nextGeneration () {
+    this->m_generation++;
+}
+
+void PlaybackRecorder::setRecording (bool recording) {}
+
+void PlaybackRecorder::updateRecording () {
+    const bool recording = std::ranges::any_of (
+        this->m_consumers | std::views::values, [] (const bool paused) { return !paused; });
+
+    if (this->m_recording == recording)
+        return;
+
+    this->m_recording = recording;
+
+    // whoever starts reading the spectrum again shouldn't see what was playing back then
+    if (!recording) {
+        std::ranges::fill (this->audio16Left, 0.0f);
+        std::ranges::fill (this->audio16Right, 0.0f);
+        std::ranges::fill (this->audio32Left, 0.0f);
+        std::ranges::fill (this->audio32Right, 0.0f);
+        std::ranges::fill (this->audio64Left, 0.0f);
+        std::ranges::fill (this->audio64Right, 0.0f);
+    }
+
+    this->setRecording (recording);
+}
+
+} // namespace WallpaperEngine::Audio::Drivers::Recorders
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <map>
+
 namespace WallpaperEngine::Audio::Drivers::Recorders {
 class PlaybackRecorder {
   public:
@@ -7,8 +10,46 @@ class PlaybackRecorder {
 
     virtual void update ();
 
-    float audio16 [16] = {0};
-    float audio32 [32] = {0};
-    float audio64 [64] = {0};
+    /**
+     * Registers or updates something that reads the spectrum, it's only recorded while a consumer is not paused
+     *
+     * @param consumer Anything that identifies the consumer
+     * @param paused
+     */
+    void setConsumer (const void* consumer, bool paused);
+    /**
+     * @param consumer
+     */
+    void removeConsumer (const void* consumer);
+    /** @return If any consumer wants the spectrum right now */
+    [[nodiscard]] bool isRecording () const;
+    /** @return Bumped whenever update () picks up a new analysis, consumers can skip frames where it's the same */
+    [[nodiscard]] uint64_t getGeneration () const;
+
+    float audio16Left [16] = {0};
+    float audio16Right [16] = {0};
+    float audio32Left [32] = {0};
+    float audio32Right [32] = {0};
+    float audio64Left [64] = {0};
+    float audio64Right [64] = {0};
+
+  protected:
+    /** Backends call this from update () when the spectrum is heading towards a new analysis */
+    void nextGeneration ();
+    /**
+     * Called whenever isRecording () changes, so the capture can be started or stopped
+     *
+     * @param recording
+     */
+    virtual void setRecording (bool recording);
+
+  private:
+    /** Works out if anything wants the spectrum and notifies setRecording () when that changes */
+    void updateRecording ();
+
+    /** Consumers and whether they are paused */
+    std::map<const void*, bool> m_consumers = {};
+    bool m_recording = false;
+    uint64_t m_generation = 0;
 };
-} // namespace WallpaperEngine::Audio::Drivers::Recorders
\ No newline at end of file
+} // namespace WallpaperEngine::Audio::Drivers::Recorders
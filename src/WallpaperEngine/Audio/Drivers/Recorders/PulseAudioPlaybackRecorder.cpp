@@ -1,15 +1,5 @@
 #include "PulseAudioPlaybackRecorder.h"
 #include "WallpaperEngine/Logging/Log.h"
-#include <cmath>
-#include <cstring>
-#include <glm/common.hpp>
-
-float movetowards (float current, float target, float maxDelta) {
-    if (abs (target - current) <= maxDelta)
-        return target;
-
-    return current + glm::sign (target - current) * maxDelta;
-}
 
 namespace WallpaperEngine::Audio::Drivers::Recorders {
 void pa_stream_notify_cb (pa_stream* stream, void* /*userdata*/) {
@@ -25,9 +15,9 @@ void pa_stream_read_cb (pa_stream* stream, const size_t /*nbytes*/, void* userda
 
     // Careful when to pa_stream_peek() and pa_stream_drop()!
     // c.f. https://www.freedesktop.org/software/pulseaudio/doxygen/stream_8h.html#ac2838c449cde56e169224d7fe3d00824
-    const uint8_t* data = nullptr;
+    const void* data = nullptr;
     size_t currentSize;
-    if (pa_stream_peek (stream, reinterpret_cast<const void**> (&data), &currentSize) != 0) {
+    if (pa_stream_peek (stream, &data, &currentSize) != 0) {
         sLog.error ("Failed to peek at stream data...");
         return;
     }
@@ -37,46 +27,9 @@ void pa_stream_read_cb (pa_stream* stream, const size_t /*nbytes*/, void* userda
         return;
     }
 
-    if (data == nullptr && currentSize > 0) {
-        // Hole in the buffer. We must drop it.
-        if (pa_stream_drop (stream) != 0) {
-            sLog.error ("Failed to drop a hole while capturing!");
-            return;
-        }
-    } else if (currentSize > 0 && data) {
-        const size_t dataToCopy = std::min (currentSize, WAVE_BUFFER_SIZE - recorder->currentWritePointer);
-
-        // depending on the amount of data available, we might want to read one or multiple frames
-        const size_t end = recorder->currentWritePointer + dataToCopy;
-
-        // this packet will fill the buffer, perform some extra checks for extra full buffers and get the latest one
-        if (end == WAVE_BUFFER_SIZE) {
-            if (const size_t numberOfFullBuffers = (currentSize - dataToCopy) / WAVE_BUFFER_SIZE;
-                numberOfFullBuffers > 0) {
-                // calculate the start of the last block (we need the end of the previous block, hence the - 1)
-                const size_t startOfLastBuffer = std::max(dataToCopy + (numberOfFullBuffers - 1) * WAVE_BUFFER_SIZE, currentSize - WAVE_BUFFER_SIZE);
-                // copy directly into the final buffer
-                memcpy (recorder->audioBuffer, &data [startOfLastBuffer], WAVE_BUFFER_SIZE * sizeof (uint8_t));
-                // copy whatever is left to the read/write buffer
-                recorder->currentWritePointer = currentSize - startOfLastBuffer - WAVE_BUFFER_SIZE;
-                memcpy (recorder->audioBufferTmp, &data [startOfLastBuffer + WAVE_BUFFER_SIZE], recorder->currentWritePointer * sizeof (uint8_t));
-            } else {
-                // okay, no full extra packets available, copy the rest of the data and flip the buffers
-                memcpy (&recorder->audioBufferTmp [recorder->currentWritePointer], data, dataToCopy * sizeof (uint8_t));
-                uint8_t* tmp = recorder->audioBuffer;
-                recorder->audioBuffer = recorder->audioBufferTmp;
-                recorder->audioBufferTmp = tmp;
-                // reset write pointer
-                recorder->currentWritePointer = 0;
-            }
-
-            // signal a new frame is ready
-            recorder->fullFrameReady = true;
-        } else {
-            // copy over available data to the tmp buffer and everything should be set
-            memcpy (&recorder->audioBufferTmp [recorder->currentWritePointer], data, dataToCopy * sizeof (uint8_t));
-            recorder->currentWritePointer += dataToCopy;
-        }
+    // holes (no data but a size) are just dropped
+    if (data != nullptr && currentSize > 0) {
+        recorder->recorder->capture (static_cast<const float*> (data), currentSize / (2 * sizeof (float)));
     }
 
     if (pa_stream_drop (stream) != 0) {
@@ -87,12 +40,17 @@ void pa_stream_read_cb (pa_stream* stream, const size_t /*nbytes*/, void* userda
 void pa_server_info_cb (pa_context* ctx, const pa_server_info* info, void* userdata) {
     auto* recorder = static_cast<PulseAudioPlaybackRecorder::PulseAudioData*> (userdata);
 
+    // sink changes only matter while something wants the spectrum
+    if (!recorder->capturing)
+        return;
+
     pa_sample_spec spec;
-    spec.format = PA_SAMPLE_U8;
-    spec.rate = 44100;
-    spec.channels = 1;
+    spec.format = PA_SAMPLE_FLOAT32NE;
+    spec.rate = SPECTRUM_SAMPLE_RATE;
+    spec.channels = 2;
 
     if (recorder->captureStream) {
+        pa_stream_disconnect (recorder->captureStream);
         pa_stream_unref (recorder->captureStream);
     }
 
@@ -135,9 +93,6 @@ void pa_context_notify_cb (pa_context* ctx, void* userdata) {
             if (o)
                 pa_operation_unref (o);
 
-            // context being ready means to fetch the sink too
-            pa_context_get_server_info (ctx, &pa_server_info_cb, userdata);
-
             break;
         }
         case PA_CONTEXT_FAILED:
@@ -149,10 +104,10 @@ void pa_context_notify_cb (pa_context* ctx, void* userdata) {
 }
 
 PulseAudioPlaybackRecorder::PulseAudioPlaybackRecorder () :
-    m_captureData({
-        .kisscfg = kiss_fftr_alloc (WAVE_BUFFER_SIZE, 0, nullptr, nullptr),
-        .audioBuffer = new uint8_t [WAVE_BUFFER_SIZE],
-        .audioBufferTmp = new uint8_t [WAVE_BUFFER_SIZE]
+    m_captureData ({
+        .recorder = this,
+        .captureStream = nullptr,
+        .capturing = false,
     }) {
     this->m_mainloop = pa_mainloop_new ();
     this->m_mainloopApi = pa_mainloop_get_api (this->m_mainloop);
@@ -166,67 +121,73 @@ PulseAudioPlaybackRecorder::PulseAudioPlaybackRecorder () :
     }
 
     // wait until the context is ready
-    while (pa_context_get_state (this->m_context) != PA_CONTEXT_READY)
+    while (pa_context_get_state (this->m_context) != PA_CONTEXT_READY) {
+        if (!PA_CONTEXT_IS_GOOD (pa_context_get_state (this->m_context)))
+            return;
+
         pa_mainloop_iterate (this->m_mainloop, 1, nullptr);
+    }
+
+    // from here on the main loop, and with it the capture and analysis, only runs on this thread.
+    // The stream itself is opened once a consumer shows up
+    this->m_thread = std::thread (&PulseAudioPlaybackRecorder::run, this);
 }
 
 PulseAudioPlaybackRecorder::~PulseAudioPlaybackRecorder () {
+    if (this->m_thread.joinable ()) {
+        this->m_running = false;
+        pa_mainloop_wakeup (this->m_mainloop);
+        this->m_thread.join ();
+    }
+
     if (m_captureData.captureStream) {
+        pa_stream_disconnect (m_captureData.captureStream);
         pa_stream_unref (m_captureData.captureStream);
     }
 
-    delete [] this->m_captureData.audioBufferTmp;
-    delete [] this->m_captureData.audioBuffer;
-    free (this->m_captureData.kisscfg);
-
     pa_context_disconnect (this->m_context);
     pa_mainloop_free (this->m_mainloop);
 }
 
-void PulseAudioPlaybackRecorder::update () {
-    pa_mainloop_iterate (this->m_mainloop, 0, nullptr);
-
-    // interpolate current values to the destination
-    for (int i = 0; i < 64; i++) {
-        this->audio64 [i] = movetowards (this->audio64 [i], this->m_FFTdestination64 [i], 0.3f);
-        if (i >= 32)
-            continue;
-        this->audio32 [i] = movetowards (this->audio32 [i], this->m_FFTdestination32 [i], 0.3f);
-        if (i >= 16)
-            continue;
-        this->audio16 [i] = movetowards (this->audio16 [i], this->m_FFTdestination16 [i], 0.3f);
+void PulseAudioPlaybackRecorder::run () {
+    while (this->m_running) {
+        this->syncCapture ();
+
+        if (pa_mainloop_iterate (this->m_mainloop, 1, nullptr) < 0)
+            break;
     }
+}
 
-    if (!this->m_captureData.fullFrameReady)
-        return;
+void PulseAudioPlaybackRecorder::setRecording (const bool recording) {
+    this->m_wanted = recording;
+    // the capture thread could be waiting on PulseAudio for a long time
+    pa_mainloop_wakeup (this->m_mainloop);
+}
 
-    this->m_captureData.fullFrameReady = false;
+void PulseAudioPlaybackRecorder::syncCapture () {
+    const bool wanted = this->m_wanted;
 
-    // convert audio data to deltas so the fft library can properly handle it
-    for (int i = 0; i < WAVE_BUFFER_SIZE; i ++) {
-        this->m_audioFFTbuffer [i] = (this->m_captureData.audioBuffer[i] - 128) / 128.0f;
-    }
+    if (this->m_captureData.capturing == wanted)
+        return;
 
-    // perform full fft pass
-    kiss_fftr (this->m_captureData.kisscfg, this->m_audioFFTbuffer, this->m_FFTinfo);
+    this->m_captureData.capturing = wanted;
 
-    // now reduce to the different bands
-    // use just one for loop to produce all 3
-    for (int band = 0; band < 64; band ++) {
-        int index = band * 2;
-        float f1 = this->m_FFTinfo[index].r;
-        float f2 = this->m_FFTinfo[index].i;
-        f2 = f1 * f1 + f2 * f2; // magnitude
-        f1 = 0.0f;
+    if (wanted) {
+        // the stream is opened on the default sink's monitor, so that has to be looked up first
+        if (pa_operation* o = pa_context_get_server_info (this->m_context, &pa_server_info_cb, &this->m_captureData))
+            pa_operation_unref (o);
 
-        if (f2 > 0.0f) {
-            f1 = 0.35f * log10 (f2);
-        }
+        return;
+    }
 
-        this->m_FFTdestination64 [band] = fmin (1.0f, f1 * static_cast<float> (2.0f - pow (M_E, (1.0f - band / 63.0f) * 1.0f - 0.5f)));
-        this->m_FFTdestination32 [band >> 1] = fmin (1.0f, f1 * static_cast<float> (2.0f - pow (M_E, (1.0f - band / 31.0f) * 1.0f - 0.5f)));
-        this->m_FFTdestination16 [band >> 2] = fmin (1.0f, f1 * static_cast<float> (2.0f - pow (M_E, (1.0f - band / 15.0f) * 1.0f - 0.5f)));
+    if (this->m_captureData.captureStream) {
+        pa_stream_disconnect (this->m_captureData.captureStream);
+        pa_stream_unref (this->m_captureData.captureStream);
+        this->m_captureData.captureStream = nullptr;
     }
+
+    // the next capture starts from silence instead of whatever was playing before
+    this->resetCapture ();
 }
 
-} // namespace WallpaperEngine::Audio::Drivers::Recorders
\ No newline at end of file
+} // namespace WallpaperEngine::Audio::Drivers::Recorders
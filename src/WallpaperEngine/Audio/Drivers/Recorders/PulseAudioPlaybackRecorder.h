@@ -1,45 +1,50 @@
 #pragma once
 
-#include "PlaybackRecorder.h"
-#include "kiss_fftr.h"
-#include <pulse/pulseaudio.h>
+#include <atomic>
+#include <thread>
 
-#define WAVE_BUFFER_SIZE 1024
+#include "SpectrumPlaybackRecorder.h"
+#include <pulse/pulseaudio.h>
 
 namespace WallpaperEngine::Audio::Drivers::Recorders {
-class PlaybackRecorder;
-
-class PulseAudioPlaybackRecorder final : public PlaybackRecorder {
+/**
+ * Records the default sink's monitor in float stereo through PulseAudio and analyzes it on a thread of its own
+ *
+ * PulseAudio's main loop runs on that thread too. The capture stream only exists while a consumer that is not paused
+ * is registered
+ */
+class PulseAudioPlaybackRecorder final : public SpectrumPlaybackRecorder {
   public:
     /**
      * Struct that contains all the required data for the PulseAudio callbacks
      */
     struct PulseAudioData {
-        kiss_fftr_cfg kisscfg;
-        uint8_t* audioBuffer;
-        uint8_t* audioBufferTmp;
-        size_t currentWritePointer;
-        bool fullFrameReady;
+        PulseAudioPlaybackRecorder* recorder;
         pa_stream* captureStream;
+        /** The capture stream should be open, only touched from the capture thread */
+        bool capturing;
     };
 
     PulseAudioPlaybackRecorder ();
     ~PulseAudioPlaybackRecorder () override;
 
-    void update () override;
+  protected:
+    void setRecording (bool recording) override;
 
   private:
+    /** Runs PulseAudio's main loop until the recorder goes away */
+    void run ();
+    /** Opens or closes the capture stream to match m_wanted, only called from the capture thread */
+    void syncCapture ();
+
     pa_mainloop* m_mainloop;
     pa_mainloop_api* m_mainloopApi;
     pa_context* m_context;
     PulseAudioData m_captureData;
 
-    float m_audioFFTbuffer [WAVE_BUFFER_SIZE] = {0.0f};
-    kiss_fft_cpx m_FFTinfo [WAVE_BUFFER_SIZE / 2 + 1] = {
-        {.r = 0.0f, .i = 0.0f}
-    };
-    float m_FFTdestination64 [64] = {0};
-    float m_FFTdestination32 [32] = {0};
-    float m_FFTdestination16 [16] = {0};
+    std::thread m_thread;
+    std::atomic<bool> m_running = true;
+    /** Set by setRecording (), picked up by the capture thread */
+    std::atomic<bool> m_wanted = false;
 };
 } // namespace WallpaperEngine::Audio::Drivers::Recorders
@@ -0,0 +1,130 @@
+#include "SpectrumPlaybackRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <glm/common.hpp>
+
+float movetowards (float current, float target, float maxDelta) {
+    if (abs (target - current) <= maxDelta)
+        return target;
+
+    return current + glm::sign (target - current) * maxDelta;
+}
+
+namespace WallpaperEngine::Audio::Drivers::Recorders {
+SpectrumPlaybackRecorder::SpectrumPlaybackRecorder () :
+    m_kisscfg (kiss_fftr_alloc (WAVE_BUFFER_SIZE, 0, nullptr, nullptr)) {
+    // the window scaled by 2 keeps the levels where they were with the unwindowed FFT
+    for (int i = 0; i < WAVE_BUFFER_SIZE; i++)
+        this->m_window [i] = 1.0f - cosf (2.0f * static_cast<float> (M_PI) * i / (WAVE_BUFFER_SIZE - 1));
+
+    layoutBands (this->m_ranges16, 16);
+    layoutBands (this->m_ranges32, 32);
+    layoutBands (this->m_ranges64, 64);
+}
+
+SpectrumPlaybackRecorder::~SpectrumPlaybackRecorder () {
+    free (this->m_kisscfg);
+}
+
+void SpectrumPlaybackRecorder::layoutBands (BandRange* ranges, const int count) {
+    for (int band = 0; band < count; band++) {
+        BandRange& range = ranges [band];
+
+        range.first = 1 + band * SPECTRUM_BINS / count;
+        range.last = 1 + (band + 1) * SPECTRUM_BINS / count;
+        range.inverseCount = 1.0f / static_cast<float> (range.last - range.first);
+        // lifts the higher bands, which carry less energy
+        range.gain = 2.0f - expf ((1.0f - band / static_cast<float> (count - 1)) - 0.5f);
+    }
+}
+
+void SpectrumPlaybackRecorder::capture (const float* samples, const size_t frames) {
+    for (size_t frame = 0; frame < frames; frame++) {
+        this->m_history [0][this->m_historyPosition] = samples [frame * 2];
+        this->m_history [1][this->m_historyPosition] = samples [frame * 2 + 1];
+        this->m_historyPosition = (this->m_historyPosition + 1) % WAVE_BUFFER_SIZE;
+
+        if (++this->m_sinceAnalysis < WAVE_HOP_SIZE)
+            continue;
+
+        this->m_sinceAnalysis = 0;
+        this->analyze ();
+    }
+}
+
+void SpectrumPlaybackRecorder::resetCapture () {
+    for (auto& channel : this->m_history)
+        std::ranges::fill (channel, 0.0f);
+
+    this->m_historyPosition = 0;
+    this->m_sinceAnalysis = 0;
+}
+
+void SpectrumPlaybackRecorder::reduceBands (const BandRange* ranges, const int count, float* out) const {
+    for (int band = 0; band < count; band++) {
+        const BandRange& range = ranges [band];
+        float power = 0.0f;
+
+        for (int bin = range.first; bin < range.last; bin++)
+            power += this->m_power [bin];
+
+        power *= range.inverseCount;
+
+        out [band] = power > 0.0f ? std::clamp (0.35f * log10f (power) * range.gain, 0.0f, 1.0f) : 0.0f;
+    }
+}
+
+void SpectrumPlaybackRecorder::analyze () {
+    Bands& bands = this->m_bands [this->m_back];
+
+    for (int channel = 0; channel < 2; channel++) {
+        // oldest frame first
+        for (int i = 0; i < WAVE_BUFFER_SIZE; i++)
+            this->m_audioFFTbuffer [i] =
+                this->m_history [channel][(this->m_historyPosition + i) % WAVE_BUFFER_SIZE] * this->m_window [i];
+
+        kiss_fftr (this->m_kisscfg, this->m_audioFFTbuffer, this->m_FFTinfo);
+
+        for (int bin = 0; bin <= SPECTRUM_BINS; bin++)
+            this->m_power [bin] =
+                this->m_FFTinfo [bin].r * this->m_FFTinfo [bin].r + this->m_FFTinfo [bin].i * this->m_FFTinfo [bin].i;
+
+        this->reduceBands (this->m_ranges16, 16, bands.band16 [channel]);
+        this->reduceBands (this->m_ranges32, 32, bands.band32 [channel]);
+        this->reduceBands (this->m_ranges64, 64, bands.band64 [channel]);
+    }
+
+    // publish the new bands and take whatever update () isn't using as the next ones to write
+    this->m_back = this->m_middle.exchange (this->m_back | BANDS_FRESH, std::memory_order_acq_rel) & BANDS_INDEX;
+}
+
+void SpectrumPlaybackRecorder::update () {
+    // nothing reads the spectrum, the values stay at zero
+    if (!this->isRecording ())
+        return;
+
+    // pick up the latest analysis if there's a new one
+    if (this->m_middle.load (std::memory_order_relaxed) & BANDS_FRESH) {
+        this->m_front = this->m_middle.exchange (this->m_front, std::memory_order_acq_rel) & BANDS_INDEX;
+        this->nextGeneration ();
+    }
+
+    const Bands& target = this->m_bands [this->m_front];
+
+    // interpolate current values to the destination
+    for (int i = 0; i < 64; i++) {
+        this->audio64Left [i] = movetowards (this->audio64Left [i], target.band64 [0][i], 0.3f);
+        this->audio64Right [i] = movetowards (this->audio64Right [i], target.band64 [1][i], 0.3f);
+        if (i >= 32)
+            continue;
+        this->audio32Left [i] = movetowards (this->audio32Left [i], target.band32 [0][i], 0.3f);
+        this->audio32Right [i] = movetowards (this->audio32Right [i], target.band32 [1][i], 0.3f);
+        if (i >= 16)
+            continue;
+        this->audio16Left [i] = movetowards (this->audio16Left [i], target.band16 [0][i], 0.3f);
+        this->audio16Right [i] = movetowards (this->audio16Right [i], target.band16 [1][i], 0.3f);
+    }
+}
+
+} // namespace WallpaperEngine::Audio::Drivers::Recorders
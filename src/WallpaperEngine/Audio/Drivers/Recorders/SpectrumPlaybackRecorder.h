@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "PlaybackRecorder.h"
+#include "kiss_fftr.h"
+
+#define WAVE_BUFFER_SIZE 1024
+/** Frames between the start of two analysis windows, so they overlap by half */
+#define WAVE_HOP_SIZE (WAVE_BUFFER_SIZE / 2)
+/** The bands are spread over these lowest FFT bins, the DC bin left aside */
+#define SPECTRUM_BINS 128
+/** Rate the recorders capture at */
+#define SPECTRUM_SAMPLE_RATE 44100
+
+namespace WallpaperEngine::Audio::Drivers::Recorders {
+/**
+ * Analyzes float stereo captured by the backends on a thread of their own
+ *
+ * Every WAVE_HOP_SIZE frames both channels go through a Hann windowed FFT and the resulting bands are published for
+ * update (), which eases the spectrum towards them
+ */
+class SpectrumPlaybackRecorder : public PlaybackRecorder {
+  public:
+    SpectrumPlaybackRecorder ();
+    ~SpectrumPlaybackRecorder () override;
+
+    void update () override;
+
+    /**
+     * Adds interleaved stereo frames to the analysis window, only called from the capture thread
+     *
+     * @param samples
+     * @param frames
+     */
+    void capture (const float* samples, size_t frames);
+
+  protected:
+    /** Forgets the captured frames so the next capture starts from silence, only called from the capture thread */
+    void resetCapture ();
+
+  private:
+    /** Spectrum of both channels, 0 is left and 1 right */
+    struct Bands {
+        float band16 [2][16] = {};
+        float band32 [2][32] = {};
+        float band64 [2][64] = {};
+    };
+
+    /** FFT bins a band covers and what their mean power is scaled by */
+    struct BandRange {
+        int first;
+        int last;
+        float inverseCount;
+        float gain;
+    };
+
+    /** Analyzes the last WAVE_BUFFER_SIZE frames and publishes the bands */
+    void analyze ();
+    /**
+     * Precomputes the bin ranges and gains for the given amount of bands
+     *
+     * @param ranges
+     * @param count
+     */
+    static void layoutBands (BandRange* ranges, int count);
+    /**
+     * Reduces the power spectrum to bands
+     *
+     * @param ranges
+     * @param count
+     * @param out
+     */
+    void reduceBands (const BandRange* ranges, int count, float* out) const;
+
+    kiss_fftr_cfg m_kisscfg;
+
+    /** Last WAVE_BUFFER_SIZE frames of every channel, m_historyPosition is the oldest */
+    float m_history [2][WAVE_BUFFER_SIZE] = {};
+    size_t m_historyPosition = 0;
+    /** Frames captured since the last analysis */
+    size_t m_sinceAnalysis = 0;
+
+    /** Hann window, scaled to make up for the energy it takes away */
+    float m_window [WAVE_BUFFER_SIZE] = {};
+    float m_audioFFTbuffer [WAVE_BUFFER_SIZE] = {0.0f};
+    kiss_fft_cpx m_FFTinfo [WAVE_BUFFER_SIZE / 2 + 1] = {
+        {.r = 0.0f, .i = 0.0f}
+    };
+    float m_power [SPECTRUM_BINS + 1] = {};
+
+    BandRange m_ranges16 [16] = {};
+    BandRange m_ranges32 [32] = {};
+    BandRange m_ranges64 [64] = {};
+
+    /**
+     * Triple buffer between the capture thread and update (), neither side ever waits for the other.
+     * The capture thread owns m_back, update () owns m_front and m_middle holds the last published one
+     */
+    Bands m_bands [3] = {};
+    static constexpr uint32_t BANDS_INDEX = 3;
+    static constexpr uint32_t BANDS_FRESH = 4;
+    uint32_t m_back = 0;
+    std::atomic<uint32_t> m_middle = 1;
+    uint32_t m_front = 2;
+};
+} // namespace WallpaperEngine::Audio::Drivers::Recorders
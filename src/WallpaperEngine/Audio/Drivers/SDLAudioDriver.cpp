@@ -1,14 +1,21 @@
 #include "SDLAudioDriver.h"
-#include "WallpaperEngine/Logging/Log.h"
 
-#define SDL_AUDIO_BUFFER_SIZE 4096
-#define MAX_AUDIO_FRAME_SIZE 192000
+#include <algorithm>
+#include <sched.h>
+
+#include "WallpaperEngine/Audio/MixKernels.h"
+#include "WallpaperEngine/Logging/Log.h"
 
 using namespace WallpaperEngine::Audio;
 using namespace WallpaperEngine::Audio::Drivers;
 
 void audio_callback (void* userdata, uint8_t* streamData, int length) {
     auto* driver = static_cast<SDLAudioDriver*> (userdata);
+    // the device is always opened as float32, SDL converts the finished mix to the hardware's format
+    auto* mix = reinterpret_cast<float*> (streamData);
+    const size_t sampleCount = length / sizeof (float);
+
+    driver->beginCallback ();
 
     memset (streamData, 0, length);
 
@@ -16,52 +23,56 @@ void audio_callback (void* userdata, uint8_t* streamData, int length) {
     if (driver->getAudioDetector ().anythingPlaying ())
         return;
 
-    for (const auto& buffer : driver->getStreams ()) {
-        uint8_t* streamDataPointer = streamData;
-        int streamLength = length;
+    const float masterVolume =
+        static_cast<float> (driver->getApplicationContext ().state.audio.volume) / SDL_MIX_MAXVOLUME;
+
+    if (masterVolume <= 0.0f)
+        return;
+
+    bool mixed = false;
+    bool starved = false;
 
+    // the streams' read threads keep their sample rings filled, this only copies and mixes, no locks, allocations
+    // or decoding on the audio thread
+    for (const auto& buffer : driver->getStreams ()) {
         // sound is not initialized or stopped and is not in loop mode
         // ignore mixing it in
         if (!buffer->stream->isInitialized ())
             continue;
 
-        // check if queue is empty and signal the read thread
-        if (buffer->stream->isQueueEmpty ()) {
-            SDL_CondSignal (buffer->stream->getWaitCondition ());
+        const float volume = buffer->stream->getVolume () * masterVolume;
+
+        // silent streams aren't even read, their read threads just wait until they're audible again
+        if (volume <= 0.0f)
             continue;
-        }
 
-        while (streamLength > 0 && driver->getApplicationContext ().state.general.keepRunning) {
-            if (buffer->audio_buf_index >= buffer->audio_buf_size) {
-                // get more data to fill the buffer
-                int audio_size = buffer->stream->decodeFrame (buffer->audio_buf, sizeof (buffer->audio_buf));
+        size_t offset = 0;
 
-                if (audio_size < 0) {
-                    // fallback for errors, silence
-                    buffer->audio_buf_size = 1024;
-                    memset (buffer->audio_buf, 0, buffer->audio_buf_size);
-                } else {
-                    buffer->audio_buf_size = audio_size;
-                }
+        while (offset < sampleCount) {
+            const size_t read = buffer->stream->readSamples (
+                reinterpret_cast<uint8_t*> (buffer->audio_buf),
+                std::min (sampleCount - offset, std::size (buffer->audio_buf)) * sizeof (float)) / sizeof (float);
 
-                buffer->audio_buf_index = 0;
+            // the decoder fell behind, the rest stays silent. Streams that ended are stopped by then
+            if (read == 0) {
+                starved = (buffer->stream->isStreaming () && buffer->stream->isInitialized () &&
+                           !buffer->stream->isSkipping ()) ||
+                          starved;
+                break;
             }
 
-            int len1 = buffer->audio_buf_size - buffer->audio_buf_index;
-
-            if (len1 > streamLength)
-                len1 = streamLength;
+            Kernels::accumulate (mix + offset, buffer->audio_buf, read, volume);
 
-            // mix the audio
-            SDL_MixAudioFormat (
-                streamDataPointer, &buffer->audio_buf [buffer->audio_buf_index], driver->getSpec ().format,
-                len1, driver->getApplicationContext ().state.audio.volume);
-
-            streamLength -= len1;
-            streamDataPointer += len1;
-            buffer->audio_buf_index += len1;
+            offset += read;
+            mixed = true;
         }
     }
+
+    if (starved)
+        driver->countUnderrun ();
+
+    if (mixed)
+        Kernels::clip (mix, sampleCount);
 }
 
 SDLAudioDriver::SDLAudioDriver (
@@ -77,23 +88,42 @@ SDLAudioDriver::SDLAudioDriver (
         return;
     }
 
+    const auto& settings = applicationContext.settings.audio;
+
+#ifdef SDL_HINT_THREAD_FORCE_REALTIME_TIME_CRITICAL
+    // SDL already asks for time critical priority for its audio thread, these turn that into real-time scheduling,
+    // going through rtkit when the process isn't allowed to set it itself
+    if (settings.realtime) {
+        SDL_SetHint (SDL_HINT_THREAD_PRIORITY_POLICY, "fifo");
+        SDL_SetHint (SDL_HINT_THREAD_FORCE_REALTIME_TIME_CRITICAL, "1");
+    }
+#else
+    if (settings.realtime)
+        sLog.error ("SDL is too old to set real-time priorities, the audio thread keeps the default one");
+#endif /* SDL_HINT_THREAD_FORCE_REALTIME_TIME_CRITICAL */
+
     const SDL_AudioSpec requestedSpec = {
         .freq = 48000,
         .format = AUDIO_F32,
         .channels = 2,
-        .samples = SDL_AUDIO_BUFFER_SIZE,
+        .samples = static_cast<Uint16> (std::clamp (settings.bufferSize, 64, 32768)),
         .callback = audio_callback,
         .userdata = this
     };
 
-    this->m_deviceID =
-        SDL_OpenAudioDevice (nullptr, false, &requestedSpec, &this->m_audioSpec, SDL_AUDIO_ALLOW_ANY_CHANGE);
+    // keep float32 so streams are mixed in it, SDL converts the mix to whatever the device wants in one go
+    this->m_deviceID = SDL_OpenAudioDevice (
+        nullptr, false, &requestedSpec, &this->m_audioSpec, SDL_AUDIO_ALLOW_ANY_CHANGE & ~SDL_AUDIO_ALLOW_FORMAT_CHANGE);
 
     if (this->m_deviceID == 0) {
         sLog.error ("SDL_OpenAudioDevice: ", SDL_GetError ());
         return;
     }
 
+    // pick the mixing kernels now so the audio thread doesn't have to
+    sLog.debug ("Mixing audio with ", Kernels::getInstructionSet ());
+    sLog.debug ("Audio buffer of ", this->m_audioSpec.samples, " frames (", this->getBufferTime (), "ms)");
+
     SDL_PauseAudioDevice (this->m_deviceID, 0);
 
     this->m_initialized = true;
@@ -111,7 +141,65 @@ SDLAudioDriver::~SDLAudioDriver () {
 }
 
 void SDLAudioDriver::addStream (AudioStream* stream) {
-    this->m_streams.push_back (new SDLAudioBuffer {stream});
+    auto* buffer = new SDLAudioBuffer {stream, std::chrono::steady_clock::now ()};
+
+    // keeps the callback from running while the list changes, the callback itself never waits on anything
+    SDL_LockAudioDevice (this->m_deviceID);
+    this->m_streams.push_back (buffer);
+    SDL_UnlockAudioDevice (this->m_deviceID);
+}
+
+void SDLAudioDriver::removeStream (AudioStream* stream) {
+    SDLAudioBuffer* removed = nullptr;
+
+    SDL_LockAudioDevice (this->m_deviceID);
+
+    if (const auto it = std::find_if (this->m_streams.begin (), this->m_streams.end (),
+                                      [stream] (const SDLAudioBuffer* buffer) { return buffer->stream == stream; });
+        it != this->m_streams.end ()) {
+        removed = *it;
+        this->m_streams.erase (it);
+    }
+
+    SDL_UnlockAudioDevice (this->m_deviceID);
+
+    delete removed;
+}
+
+void SDLAudioDriver::update () {
+    AudioDriver::update ();
+
+    if (!this->m_initialized)
+        return;
+
+    const bool muted =
+        this->getAudioDetector ().anythingPlaying () || this->getApplicationContext ().state.audio.volume <= 0;
+
+    if (muted == this->m_muted)
+        return;
+
+    const auto now = std::chrono::steady_clock::now ();
+
+    this->m_muted = muted;
+
+    if (muted) {
+        // the callback doesn't run anymore, so the rings stay full and the decoders have nothing to do
+        SDL_PauseAudioDevice (this->m_deviceID, 1);
+        this->m_mutedSince = now;
+        return;
+    }
+
+    SDL_LockAudioDevice (this->m_deviceID);
+
+    // the sounds went on in the meantime, like they would have if they were only silent
+    for (const auto* buffer : this->m_streams)
+        buffer->stream->skip (now - std::max (this->m_mutedSince, buffer->added));
+
+    // the pause isn't the callback being late
+    this->m_lastCallback = {};
+
+    SDL_UnlockAudioDevice (this->m_deviceID);
+    SDL_PauseAudioDevice (this->m_deviceID, 0);
 }
 
 const std::vector<SDLAudioBuffer*>& SDLAudioDriver::getStreams () {
@@ -149,4 +237,43 @@ int SDLAudioDriver::getChannels () const {
 
 const SDL_AudioSpec& SDLAudioDriver::getSpec () const {
     return this->m_audioSpec;
-}
\ No newline at end of file
+}
+
+void SDLAudioDriver::beginCallback () {
+    const auto now = std::chrono::steady_clock::now ();
+
+    if (this->m_lastCallback == std::chrono::steady_clock::time_point {}) {
+        const int policy = sched_getscheduler (0);
+
+        this->m_realtime = policy == SCHED_FIFO || policy == SCHED_RR;
+    } else if (std::chrono::duration<double, std::milli> (now - this->m_lastCallback).count () >
+               this->getBufferTime () * 1.5) {
+        // half a buffer later than expected, the device most likely played silence in between
+        this->m_lateCallbacks.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    this->m_lastCallback = now;
+}
+
+void SDLAudioDriver::countUnderrun () {
+    this->m_underruns.fetch_add (1, std::memory_order_relaxed);
+}
+
+uint64_t SDLAudioDriver::getUnderruns () const {
+    return this->m_underruns.load (std::memory_order_relaxed);
+}
+
+uint64_t SDLAudioDriver::getLateCallbacks () const {
+    return this->m_lateCallbacks.load (std::memory_order_relaxed);
+}
+
+double SDLAudioDriver::getBufferTime () const {
+    if (this->m_audioSpec.freq <= 0)
+        return 0.0;
+
+    return 1000.0 * this->m_audioSpec.samples / this->m_audioSpec.freq;
+}
+
+bool SDLAudioDriver::isRealtime () const {
+    return this->m_realtime;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <vector>
 
@@ -8,7 +10,8 @@
 
 #include <SDL.h>
 
-#define MAX_AUDIO_FRAME_SIZE 192000
+/** Frames the streams are read in at most at once, the device's buffer is set with --audio-buffer */
+#define SDL_AUDIO_BUFFER_SIZE 4096
 
 namespace WallpaperEngine::Audio::Drivers {
 /**
@@ -16,9 +19,10 @@ namespace WallpaperEngine::Audio::Drivers {
  */
 struct SDLAudioBuffer {
     AudioStream* stream = nullptr;
-    uint8_t audio_buf [(MAX_AUDIO_FRAME_SIZE * 3) / 2] = {0};
-    unsigned int audio_buf_size = 0;
-    unsigned int audio_buf_index = 0;
+    /** Streams added while muted only skip the time since then */
+    std::chrono::steady_clock::time_point added = {};
+    /** Scratch space the stream's float samples are copied into before mixing them */
+    float audio_buf [SDL_AUDIO_BUFFER_SIZE * 2] = {0};
 };
 
 /**
@@ -33,6 +37,13 @@ class SDLAudioDriver final : public AudioDriver {
 
     /** @inheritdoc */
     void addStream (AudioStream* stream) override;
+    /** @inheritdoc */
+    void removeStream (AudioStream* stream) override;
+    /**
+     * Stops the device while nothing can be heard (something else is playing or the volume is 0) so no stream is
+     * read or decoded, and skips the streams ahead by the time it was stopped once it starts again
+     */
+    void update () override;
     /**
      * @return All the registered audio streams
      */
@@ -48,15 +59,49 @@ class SDLAudioDriver final : public AudioDriver {
      * @return The SDL's audio driver settings
      */
     [[nodiscard]] const SDL_AudioSpec& getSpec () const;
+    /**
+     * Keeps track of how late the callbacks come, only called from the audio thread when a callback starts
+     */
+    void beginCallback ();
+    /**
+     * Counts a callback where a stream ran out of decoded samples, only called from the audio thread
+     */
+    void countUnderrun ();
+    /**
+     * @return Callbacks where a stream ran out of decoded samples so far
+     */
+    [[nodiscard]] uint64_t getUnderruns () const;
+    /**
+     * @return Callbacks that came too late to keep the device's buffer filled so far
+     */
+    [[nodiscard]] uint64_t getLateCallbacks () const;
+    /**
+     * @return Milliseconds of sound in the device's buffer
+     */
+    [[nodiscard]] double getBufferTime () const;
+    /**
+     * @return If the mixing thread got real-time scheduling
+     */
+    [[nodiscard]] bool isRealtime () const;
 
   private:
     /** The device's ID */
-    SDL_AudioDeviceID m_deviceID;
+    SDL_AudioDeviceID m_deviceID = 0;
     /** If the driver is initialized or not */
     bool m_initialized = false;
     /** The sound output configuration */
     SDL_AudioSpec m_audioSpec {};
     /** All the playable steams */
     std::vector<SDLAudioBuffer*> m_streams {};
+    /** Read from other threads by the stats */
+    std::atomic<uint64_t> m_underruns = 0;
+    std::atomic<uint64_t> m_lateCallbacks = 0;
+    std::atomic<bool> m_realtime = false;
+    /** When the last callback started, only touched from the audio thread or while the device is stopped */
+    std::chrono::steady_clock::time_point m_lastCallback = {};
+    /** If the device is stopped because nothing could be heard */
+    bool m_muted = false;
+    /** When the device was stopped */
+    std::chrono::steady_clock::time_point m_mutedSince = {};
 };
 } // namespace WallpaperEngine::Audio::Drivers
\ No newline at end of file
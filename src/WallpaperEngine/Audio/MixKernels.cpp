@@ -0,0 +1,155 @@
+#include "MixKernels.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIX_KERNELS_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define MIX_KERNELS_NEON 1
+#endif
+
+using namespace WallpaperEngine::Audio;
+
+namespace {
+// ========== SCALAR ==========
+
+void accumulateScalar (float* mix, const float* samples, size_t start, size_t n, float volume) {
+    for (size_t i = start; i < n; i++)
+        mix [i] += samples [i] * volume;
+}
+
+void clipScalar (float* samples, size_t start, size_t n) {
+    for (size_t i = start; i < n; i++)
+        samples [i] = std::clamp (samples [i], -1.0f, 1.0f);
+}
+
+void accumulateScalarEntry (float* mix, const float* samples, size_t n, float volume) {
+    accumulateScalar (mix, samples, 0, n, volume);
+}
+
+void clipScalarEntry (float* samples, size_t n) {
+    clipScalar (samples, 0, n);
+}
+
+#if MIX_KERNELS_X86
+// ========== SSE ==========
+
+__attribute__ ((target ("sse"))) void accumulateSSE (float* mix, const float* samples, size_t n, float volume) {
+    const __m128 vvolume = _mm_set1_ps (volume);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps (mix + i, _mm_add_ps (_mm_loadu_ps (mix + i), _mm_mul_ps (_mm_loadu_ps (samples + i), vvolume)));
+
+    accumulateScalar (mix, samples, i, n, volume);
+}
+
+__attribute__ ((target ("sse"))) void clipSSE (float* samples, size_t n) {
+    const __m128 low = _mm_set1_ps (-1.0f);
+    const __m128 high = _mm_set1_ps (1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps (samples + i, _mm_min_ps (_mm_max_ps (_mm_loadu_ps (samples + i), low), high));
+
+    clipScalar (samples, i, n);
+}
+
+// ========== AVX ==========
+
+__attribute__ ((target ("avx"))) void accumulateAVX (float* mix, const float* samples, size_t n, float volume) {
+    const __m256 vvolume = _mm256_set1_ps (volume);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps (
+            mix + i, _mm256_add_ps (_mm256_loadu_ps (mix + i), _mm256_mul_ps (_mm256_loadu_ps (samples + i), vvolume)));
+
+    accumulateScalar (mix, samples, i, n, volume);
+}
+
+__attribute__ ((target ("avx"))) void clipAVX (float* samples, size_t n) {
+    const __m256 low = _mm256_set1_ps (-1.0f);
+    const __m256 high = _mm256_set1_ps (1.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps (samples + i, _mm256_min_ps (_mm256_max_ps (_mm256_loadu_ps (samples + i), low), high));
+
+    clipScalar (samples, i, n);
+}
+#endif /* MIX_KERNELS_X86 */
+
+#if MIX_KERNELS_NEON
+// ========== NEON ==========
+
+void accumulateNEON (float* mix, const float* samples, size_t n, float volume) {
+    const float32x4_t vvolume = vdupq_n_f32 (volume);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32 (mix + i, vmlaq_f32 (vld1q_f32 (mix + i), vld1q_f32 (samples + i), vvolume));
+
+    accumulateScalar (mix, samples, i, n, volume);
+}
+
+void clipNEON (float* samples, size_t n) {
+    const float32x4_t low = vdupq_n_f32 (-1.0f);
+    const float32x4_t high = vdupq_n_f32 (1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32 (samples + i, vminq_f32 (vmaxq_f32 (vld1q_f32 (samples + i), low), high));
+
+    clipScalar (samples, i, n);
+}
+#endif /* MIX_KERNELS_NEON */
+
+struct KernelTable {
+    void (*accumulate) (float*, const float*, size_t, float);
+    void (*clip) (float*, size_t);
+    const char* name;
+};
+
+KernelTable selectKernels () {
+#if MIX_KERNELS_X86
+    __builtin_cpu_init ();
+
+    if (__builtin_cpu_supports ("avx"))
+        return {accumulateAVX, clipAVX, "AVX"};
+    if (__builtin_cpu_supports ("sse"))
+        return {accumulateSSE, clipSSE, "SSE"};
+#elif MIX_KERNELS_NEON
+    return {accumulateNEON, clipNEON, "NEON"};
+#endif
+
+    return {accumulateScalarEntry, clipScalarEntry, "scalar"};
+}
+
+const KernelTable& kernels () {
+    static const KernelTable table = [] {
+        const KernelTable selected = selectKernels ();
+
+        sLog.debug ("Audio mixing kernels using ", selected.name);
+
+        return selected;
+    }();
+
+    return table;
+}
+} // namespace
+
+void Kernels::accumulate (float* mix, const float* samples, const size_t count, const float volume) {
+    kernels ().accumulate (mix, samples, count, volume);
+}
+
+void Kernels::clip (float* samples, const size_t count) {
+    kernels ().clip (samples, count);
+}
+
+const char* Kernels::getInstructionSet () {
+    return kernels ().name;
+}
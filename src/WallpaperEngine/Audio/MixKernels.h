@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+namespace WallpaperEngine::Audio::Kernels {
+/**
+ * Adds the samples to the mix scaled by volume, mix [i] += samples [i] * volume
+ */
+void accumulate (float* mix, const float* samples, size_t count, float volume);
+
+/**
+ * Clamps the mixed samples back into [-1, 1] so loud streams adding up don't wrap around in the device's format
+ */
+void clip (float* samples, size_t count);
+
+/**
+ * @return The name of the instruction set the kernels were dispatched to
+ */
+const char* getInstructionSet ();
+} // namespace WallpaperEngine::Audio::Kernels
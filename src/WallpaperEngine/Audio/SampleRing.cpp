@@ -0,0 +1,63 @@
+#include "SampleRing.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+using namespace WallpaperEngine::Audio;
+
+SampleRing::SampleRing (const size_t capacity) :
+    m_data (std::bit_ceil (std::max<size_t> (capacity, 1))),
+    m_mask (this->m_data.size () - 1) {}
+
+size_t SampleRing::write (const uint8_t* data, const size_t size) {
+    const size_t head = this->m_head.load (std::memory_order_relaxed);
+    const size_t tail = this->m_tail.load (std::memory_order_acquire);
+    const size_t count = std::min (size, this->m_data.size () - (head - tail));
+    const size_t offset = head & this->m_mask;
+    const size_t first = std::min (count, this->m_data.size () - offset);
+
+    memcpy (&this->m_data [offset], data, first);
+    memcpy (this->m_data.data (), data + first, count - first);
+
+    // publish the samples only once they're in place
+    this->m_head.store (head + count, std::memory_order_release);
+
+    return count;
+}
+
+size_t SampleRing::read (uint8_t* data, const size_t size) {
+    const size_t tail = std::max (
+        this->m_tail.load (std::memory_order_relaxed), this->m_cleared.load (std::memory_order_acquire));
+    const size_t head = this->m_head.load (std::memory_order_acquire);
+    const size_t count = std::min (size, head - tail);
+    const size_t offset = tail & this->m_mask;
+    const size_t first = std::min (count, this->m_data.size () - offset);
+
+    memcpy (data, &this->m_data [offset], first);
+    memcpy (data + first, this->m_data.data (), count - first);
+
+    // hand the space back to the writer once the samples are copied out
+    this->m_tail.store (tail + count, std::memory_order_release);
+
+    return count;
+}
+
+void SampleRing::clear () {
+    this->m_cleared.store (this->m_head.load (std::memory_order_relaxed), std::memory_order_release);
+}
+
+size_t SampleRing::available () const {
+    return this->m_head.load (std::memory_order_acquire) -
+           std::max (this->m_tail.load (std::memory_order_acquire), this->m_cleared.load (std::memory_order_acquire));
+}
+
+size_t SampleRing::space () const {
+    // cleared bytes the reader didn't skip yet might still be being copied out, they're only free once it did
+    return this->m_data.size () - (this->m_head.load (std::memory_order_acquire) -
+                                   this->m_tail.load (std::memory_order_acquire));
+}
+
+size_t SampleRing::capacity () const {
+    return this->m_data.size ();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace WallpaperEngine::Audio {
+/**
+ * Lock-free ring of decoded samples between one writer and one reader thread
+ *
+ * The writer is the stream's decode thread, the reader the audio driver's callback. Neither side ever blocks, takes
+ * a lock or allocates memory, the reader just gets less data if the writer fell behind
+ */
+class SampleRing {
+  public:
+    /**
+     * @param capacity Minimum amount of bytes the ring holds, rounded up to a power of two
+     */
+    explicit SampleRing (size_t capacity);
+
+    SampleRing (const SampleRing&) = delete;
+    SampleRing& operator= (const SampleRing&) = delete;
+
+    /**
+     * Copies as much of the data as fits in the ring, only to be called by the writer
+     *
+     * @param data
+     * @param size
+     *
+     * @return The amount of bytes written
+     */
+    size_t write (const uint8_t* data, size_t size);
+    /**
+     * Copies up to size bytes out of the ring, only to be called by the reader
+     *
+     * @param data
+     * @param size
+     *
+     * @return The amount of bytes read
+     */
+    size_t read (uint8_t* data, size_t size);
+    /**
+     * Drops everything written so far, only to be called by the writer. The reader skips it on its next read
+     */
+    void clear ();
+
+    /** @return Bytes ready to be read */
+    [[nodiscard]] size_t available () const;
+    /** @return Bytes that can be written */
+    [[nodiscard]] size_t space () const;
+    /** @return Size of the ring in bytes */
+    [[nodiscard]] size_t capacity () const;
+
+  private:
+    std::vector<uint8_t> m_data;
+    size_t m_mask;
+    /** Total bytes written, only changed by the writer. Apart from the tail so both don't share a cache line */
+    alignas (64) std::atomic<size_t> m_head = 0;
+    /** Total bytes read, only changed by the reader */
+    alignas (64) std::atomic<size_t> m_tail = 0;
+    /** Head as of the last clear (), the reader moves its tail past it */
+    std::atomic<size_t> m_cleared = 0;
+};
+} // namespace WallpaperEngine::Audio
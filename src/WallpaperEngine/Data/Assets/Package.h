@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 
 namespace WallpaperEngine::Data::Assets {
 using namespace WallpaperEngine::Data::Utils;
@@ -16,8 +17,12 @@ struct FileEntry {
 };
 
 struct Package {
+    /** version string the package starts with, PKGV followed by four digits */
+    std::string header;
     BinaryReaderUniquePtr file;
     FileEntryList files;
+    /** the entries in files by their path, normalized */
+    std::unordered_map<std::string, const FileEntry*> index;
     uint32_t baseOffset;
 };
 }
\ No newline at end of file
@@ -107,9 +107,9 @@ struct Mipmap {
     int uncompressedSize = 0;
     /** Compress size of the mipmap */
     int compressedSize = 0;
-    /** Pointer to the compressed data */
+    /** Pointer to the compressed data, freed once decompressed */
     std::unique_ptr<char[]> compressedData = nullptr;
-    /** Pointer to the uncompressed data */
+    /** Pointer to the uncompressed data, freed once the texture is uploaded */
     std::unique_ptr<char[]> uncompressedData = nullptr;
     /** JSON data */
     std::string json {};
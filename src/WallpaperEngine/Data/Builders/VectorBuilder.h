@@ -1,7 +1,8 @@
 #pragma once
 
-#include <cstring>
-#include <string>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
 #include <glm/detail/qualifier.hpp>
 #include <glm/detail/type_vec1.hpp>
 
@@ -13,15 +14,56 @@ using namespace WallpaperEngine::Data::Utils::SFINAE;
 
 class VectorBuilder {
     /**
-     * Convert template that calls the proper std::strto* function
-     * based on the incoming type
+     * @param c
+     * @return If the character separates two values
+     */
+    static bool isSeparator (const char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    static const char* skipSeparators (const char* cursor, const char* end) {
+        while (cursor != end && isSeparator (*cursor))
+            cursor++;
+
+        return cursor;
+    }
+
+    static const char* skipValue (const char* cursor, const char* end) {
+        while (cursor != end && !isSeparator (*cursor))
+            cursor++;
+
+        return cursor;
+    }
+
+    /**
+     * Converts a single value with std::from_chars, no locale, allocations or copies involved. Anything after the
+     * number that is not a separator is ignored and values that aren't numbers are 0, like std::strto* did
      *
      * @tparam type
-     * @param str
+     * @param begin
+     * @param end
      * @return
      */
     template <typename type>
-    static type convert (const char* str);
+    static type convert (const char* begin, const char* end) {
+        // from_chars doesn't take the leading plus sign strto* used to
+        if (begin != end && *begin == '+')
+            begin++;
+
+        if constexpr (std::is_same_v<type, bool>) {
+            unsigned long value = 0;
+
+            std::from_chars (begin, end, value);
+
+            return value > 0;
+        } else {
+            type value {};
+
+            std::from_chars (begin, end, value);
+
+            return value;
+        }
+    }
 
   public:
     /**
@@ -32,31 +74,25 @@ class VectorBuilder {
      * @param str
      * @return
      */
-    static int preparseSize (const std::string& str) {
-        const char* p = str.c_str ();
-        const char* first = strchr (p, ' ');
-        const char* second = first ? strchr (first + 1, ' ') : nullptr;
-        const char* third = second ? strchr (second + 1, ' ') : nullptr;
-
-        if (first == nullptr) {
-            sLog.exception ("Invalid vector format: " + str + " (too few values, expected: 2, 3 or 4)");
-        }
+    static int preparseSize (const std::string_view str) {
+        const char* end = str.data () + str.size ();
+        int count = 0;
 
-        if (second == nullptr) {
-            return 2;
-        }
+        for (const char* cursor = skipSeparators (str.data (), end); cursor != end && count < 4;
+             cursor = skipSeparators (skipValue (cursor, end), end))
+            count++;
 
-        if (third == nullptr) {
-            return 3;
+        if (count < 2) {
+            sLog.exception ("Invalid vector format: ", str, " (too few values, expected: 2, 3 or 4)");
         }
 
-        return 4;
+        return count;
     }
 
     /**
      * Takes a string value and parses it into a glm::vec.
-     * This particular parsing uses spaces as separators and basic std::strto* functions
-     * for the actual parsing of the values.
+     * The values are separated by whitespace and converted in the same pass that splits them, so nothing is
+     * allocated or scanned twice
      *
      * @tparam length Vector length
      * @tparam type Vector storage type
@@ -67,70 +103,33 @@ class VectorBuilder {
      * @return
      */
     template <int length, typename type, glm::qualifier qualifier>
-    [[nodiscard]] static glm::vec<length, type, qualifier> parse (const std::string& str) {
+    [[nodiscard]] static glm::vec<length, type, qualifier> parse (const std::string_view str) {
         // ensure a valid type is used, only 1 to 4 vectors are supported
         static_assert (length >= 1 && length <= 4, "Invalid vector length");
 
-        const char* p = str.c_str ();
+        glm::vec<length, type, qualifier> result {};
+        const char* end = str.data () + str.size ();
+        int count = 0;
 
-        // get up to 4 spaces
-        const char* first = strchr (p, ' ');
-        const char* second = first ? strchr (first + 1, ' ') : nullptr;
-        const char* third = second ? strchr (second + 1, ' ') : nullptr;
+        for (const char* cursor = skipSeparators (str.data (), end); cursor != end;) {
+            const char* valueEnd = skipValue (cursor, end);
 
-        // validate lengths against what was found in the strings
-        if constexpr (length == 1) {
-            if (first != nullptr) {
-                sLog.exception ("Invalid vector format: " + str + " (too many values, expected: ", length, ")");
-            }
-        } else if constexpr (length == 2) {
-            if (first == nullptr) {
-                sLog.exception ("Invalid vector format: " + str + " (too few values, expected: ", length, ")");
+            if (count == length) {
+                sLog.exception ("Invalid vector format: ", str, " (too many values, expected: ", length, ")");
             }
 
-            if (second != nullptr) {
-                sLog.exception ("Invalid vector format: " + str + " (too many values, expected: ", length, ")");
-            }
-        } else if constexpr (length == 3) {
-            if (first == nullptr || second == nullptr) {
-                sLog.exception ("Invalid vector format: " + str + " (too few values, expected: ", length, ")");
-            }
-            if (third != nullptr) {
-                sLog.exception ("Invalid vector format: " + str + " (too many values, expected: ", length, ")");
-            }
-        } else if constexpr (length == 4) {
-            if (first == nullptr || second == nullptr || third == nullptr) {
-                sLog.exception ("Invalid vector format: " + str + " (too few values, expected: ", length, ")");
-            }
+            result [count++] = convert <type> (cursor, valueEnd);
+            cursor = skipSeparators (valueEnd, end);
         }
 
-        // lengths validated, values can be used directly without issues
-        if constexpr (length == 1) {
-            return {
-                convert <type> (p)
-            };
-        } else if constexpr (length == 2) {
-            return {
-                convert <type> (p),
-                convert <type> (first + 1)
-            };
-        } else if constexpr (length == 3) {
-            return {
-                convert <type> (p),
-                convert <type> (first + 1),
-                convert <type> (second + 1)
-            };
-        } else if constexpr (length == 4) {
-            return {
-                convert <type> (p),
-                convert <type> (first + 1),
-                convert <type> (second + 1),
-                convert <type> (third + 1)
-            };
+        if (count != length) {
+            sLog.exception ("Invalid vector format: ", str, " (too few values, expected: ", length, ")");
         }
+
+        return result;
     }
     template <typename T, typename std::enable_if_t<is_glm_vec<T>::value, int> = 0>
-    [[nodiscard]] static T parse (const std::string& str) {
+    [[nodiscard]] static T parse (const std::string_view str) {
         constexpr int length = GlmVecTraits<T>::length;
         constexpr glm::qualifier qualifier = GlmVecTraits<T>::qualifier;
 
@@ -139,59 +138,4 @@ class VectorBuilder {
     }
 };
 
-template <>
-inline float VectorBuilder::convert<float> (const char* str) {
-    return std::strtof (str, nullptr);
-}
-
-template <>
-inline int VectorBuilder::convert<int> (const char* str) {
-    return std::stoi (str);
-}
-
-template <>
-inline unsigned int VectorBuilder::convert<unsigned int> (const char* str) {
-    return std::strtoul (str, nullptr, 10);
-}
-
-template <>
-inline double VectorBuilder::convert<double> (const char* str) {
-    return std::strtod (str, nullptr);
-}
-
-template <>
-inline uint8_t VectorBuilder::convert<uint8_t> (const char* str) {
-    return std::strtoul (str, nullptr, 10);
-}
-
-template <>
-inline uint16_t VectorBuilder::convert<uint16_t> (const char* str) {
-    return std::strtoul (str, nullptr, 10);
-}
-
-template <>
-inline uint64_t VectorBuilder::convert<uint64_t> (const char* str) {
-    return std::strtoull (str, nullptr, 10);
-}
-
-template <>
-inline int8_t VectorBuilder::convert<int8_t> (const char* str) {
-    return std::strtol (str, nullptr, 10);
-}
-
-template <>
-inline int16_t VectorBuilder::convert<int16_t> (const char* str) {
-    return std::strtol (str, nullptr, 10);
-}
-
-template <>
-inline int64_t VectorBuilder::convert<int64_t> (const char* str) {
-    return std::strtoll (str, nullptr, 10);
-}
-
-template <>
-inline bool VectorBuilder::convert<bool> (const char* str) {
-    return std::strtoul (str, nullptr, 10) > 0;
-}
-
 } // namespace WallpaperEngine::Data::Parsers
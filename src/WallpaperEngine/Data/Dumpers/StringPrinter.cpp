@@ -11,6 +11,10 @@ StringPrinter::StringPrinter (std::string indentationCharacter) :
     m_out (&this->m_buffer),
     m_indentationCharacter (std::move(indentationCharacter)) { }
 
+StringPrinter::StringPrinter (std::ostream& out, std::string indentationCharacter) :
+    m_out (out.rdbuf ()),
+    m_indentationCharacter (std::move(indentationCharacter)) { }
+
 void StringPrinter::printWallpaper (const Wallpaper& wallpaper) {
     const bool isScene = wallpaper.is <Scene> ();
     const bool isVideo = wallpaper.is <Video> ();
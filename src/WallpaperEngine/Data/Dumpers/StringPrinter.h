@@ -11,6 +11,14 @@ using namespace WallpaperEngine::Data::Model;
 class StringPrinter {
   public:
     explicit StringPrinter (std::string indentationCharacter = "\t");
+    /**
+     * Writes straight to the given stream as things are printed instead of keeping everything in the buffer,
+     * str () is empty then
+     *
+     * @param out
+     * @param indentationCharacter
+     */
+    explicit StringPrinter (std::ostream& out, std::string indentationCharacter = "\t");
     ~StringPrinter () = default;
 
     /**
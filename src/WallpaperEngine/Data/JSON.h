@@ -54,10 +54,14 @@ class JsonExtensions {
     }
     template <int length, typename type, glm::qualifier qualifier>
     [[nodiscard]] glm::vec <length, type, qualifier> get () const {
-        return VectorBuilder::parse <length, type, qualifier> (this->base ().get <std::string> ());
+        // parsed straight from the document's string, no copy of it is made
+        return VectorBuilder::parse <length, type, qualifier> (this->base ().get_ref <const std::string&> ());
     }
-    [[nodiscard]] base_type require (const std::string& key, const std::string& message) const {
-        auto base  =  this->base ();
+    /**
+     * @return The value under the key, a reference into this document so big sections are not copied
+     */
+    [[nodiscard]] const base_type& require (const std::string& key, const std::string& message) const {
+        const auto& base = this->base ();
         const auto it = base.find (key);
 
         if (it == base.end ()) {
@@ -68,7 +72,7 @@ class JsonExtensions {
     }
     template <typename T>
     [[nodiscard]] T require (const std::string& key, const std::string& message) const {
-        auto base = this->base ();
+        const auto& base = this->base ();
         const auto it = base.find (key);
 
         if (it == base.end ()) {
@@ -78,7 +82,7 @@ class JsonExtensions {
         return (*it);
     }
     [[nodiscard]] std::optional <base_type> optional (const std::string& key) const noexcept {
-        auto base = this->base ();
+        const auto& base = this->base ();
         const auto it = base.find (key);
         auto result = std::optional<base_type> {};
 
@@ -90,7 +94,7 @@ class JsonExtensions {
     }
     template <typename T>
     [[nodiscard]] std::optional <T> optional (const std::string& key) const noexcept {
-        auto base = this->base ();
+        const auto& base = this->base ();
         const auto it = base.find (key);
 
         if (it == base.end () || it->is_null ()) {
@@ -101,7 +105,7 @@ class JsonExtensions {
     }
     template <typename T>
     [[nodiscard]] T optional (const std::string& key, T defaultValue) const noexcept {
-        auto base = this->base ();
+        const auto& base = this->base ();
         const auto it = base.find (key);
 
         if (it == base.end () || it->is_null ()) {
@@ -113,9 +117,8 @@ class JsonExtensions {
     [[nodiscard]] UserSettingUniquePtr user (const std::string& key, const Properties& properties) const;
     template <typename T>
     [[nodiscard]] UserSettingUniquePtr user (const std::string& key, const Properties& properties, T defaultValue) const {
-        const auto value = this->optional (key);
-
-        if (!value.has_value ()) {
+        // only the presence matters here, don't copy the value to check it
+        if (const auto it = this->base ().find (key); it == this->base ().end () || it->is_null ()) {
             return UserSettingBuilder::fromValue <T> (defaultValue);
         }
 
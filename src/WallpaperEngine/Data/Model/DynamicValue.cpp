@@ -1,8 +1,23 @@
 #include "DynamicValue.h"
 #include "WallpaperEngine/Logging/Log.h"
 
+#include <algorithm>
+
 using namespace WallpaperEngine::Data::Model;
 
+int DynamicValue::sBatchDepth = 0;
+bool DynamicValue::sFlushing = false;
+uint32_t DynamicValue::sFlushLevel = 0;
+std::vector<std::vector<DynamicValue*>> DynamicValue::sPending = {};
+
+DynamicValue::Batch::Batch () {
+    sBatchDepth++;
+}
+
+DynamicValue::Batch::~Batch () {
+    sBatchDepth--;
+}
+
 DynamicValue::DynamicValue (const glm::ivec4& value) {
     this->DynamicValue::update (value);
 }
@@ -39,51 +54,75 @@ DynamicValue::DynamicValue (bool value) {
     this->DynamicValue::update (value);
 }
 
+DynamicValue::DynamicValue (const DynamicValue& other) :
+    m_type (other.m_type),
+    m_integer (other.m_integer),
+    m_bool (other.m_bool) {
+    if (other.m_integer)
+        this->m_ivec4 = other.m_ivec4;
+    else
+        this->m_vec4 = other.m_vec4;
+
+    if (other.m_extra != nullptr && (!other.m_extra->string.empty () || other.m_extra->condition.has_value ())) {
+        this->extra ().string = other.m_extra->string;
+        this->extra ().condition = other.m_extra->condition;
+    }
+}
+
 DynamicValue::~DynamicValue () {
-    if (this->m_aliveFlag)
-        *this->m_aliveFlag = false;
+    if (this->m_extra == nullptr)
+        return;
+
+    if (this->m_extra->aliveFlag)
+        *this->m_extra->aliveFlag = false;
+    // the slot is skipped by flush (), removing it would move the values after it
+    if (this->m_extra->queuedLevel.has_value ())
+        std::replace (sPending [*this->m_extra->queuedLevel].begin (), sPending [*this->m_extra->queuedLevel].end (),
+                      this, static_cast<DynamicValue*> (nullptr));
     this->disconnect ();
-    this->m_listeners.clear ();
+    this->m_extra->listeners.clear ();
 }
 
-const glm::ivec4& DynamicValue::getIVec4 () const {
-    return this->m_ivec4;
+glm::ivec4 DynamicValue::getIVec4 () const {
+    return this->m_integer ? this->m_ivec4 : glm::ivec4 (this->m_vec4);
 }
 
-const glm::ivec3& DynamicValue::getIVec3 () const {
-    return this->m_ivec3;
+glm::ivec3 DynamicValue::getIVec3 () const {
+    return glm::ivec3 (this->getIVec4 ());
 }
 
-const glm::ivec2& DynamicValue::getIVec2 () const {
-    return this->m_ivec2;
+glm::ivec2 DynamicValue::getIVec2 () const {
+    return glm::ivec2 (this->getIVec4 ());
 }
 
-const glm::vec4& DynamicValue::getVec4 () const {
-    return this->m_vec4;
+glm::vec4 DynamicValue::getVec4 () const {
+    return this->m_integer ? glm::vec4 (this->m_ivec4) : this->m_vec4;
 }
 
-const glm::vec3& DynamicValue::getVec3 () const {
-    return this->m_vec3;
+glm::vec3 DynamicValue::getVec3 () const {
+    return glm::vec3 (this->getVec4 ());
 }
 
-const glm::vec2& DynamicValue::getVec2 () const {
-    return this->m_vec2;
+glm::vec2 DynamicValue::getVec2 () const {
+    return glm::vec2 (this->getVec4 ());
 }
 
-const float& DynamicValue::getFloat () const {
-    return this->m_float;
+float DynamicValue::getFloat () const {
+    return this->m_integer ? static_cast<float> (this->m_ivec4.x) : this->m_vec4.x;
 }
 
-const int& DynamicValue::getInt () const {
-    return this->m_int;
+int DynamicValue::getInt () const {
+    return this->m_integer ? this->m_ivec4.x : static_cast<int> (this->m_vec4.x);
 }
 
-const bool& DynamicValue::getBool () const {
+bool DynamicValue::getBool () const {
     return this->m_bool;
 }
 
 const std::string& DynamicValue::getString () const {
-    return this->m_string;
+    static const std::string empty;
+
+    return this->m_extra != nullptr ? this->m_extra->string : empty;
 }
 
 DynamicValue::UnderlyingType DynamicValue::getType () const {
@@ -93,229 +132,172 @@ DynamicValue::UnderlyingType DynamicValue::getType () const {
 std::string DynamicValue::toString () const {
     switch (this->m_type) {
         case UnderlyingType::Float:
-            return std::to_string (this->m_float);
+            return std::to_string (this->getFloat ());
         case UnderlyingType::Int:
-            return std::to_string (this->m_int);
+            return std::to_string (this->getInt ());
         case UnderlyingType::Boolean:
-            return std::to_string (this->m_bool);
+            return std::to_string (this->getBool ());
         case UnderlyingType::Vec2:
-            return std::to_string (this->m_vec2.x) + ", " + std::to_string (this->m_vec2.y);
         case UnderlyingType::Vec3:
-            return std::to_string (this->m_vec3.x) + ", " + std::to_string (this->m_vec3.y) + ", " + std::to_string (this->m_vec3.z);
-        case UnderlyingType::Vec4:
-            return std::to_string (this->m_vec4.x) + ", " + std::to_string (this->m_vec4.y) + ", " + std::to_string (this->m_vec4.z) + ", " + std::to_string (this->m_vec4.w);
+        case UnderlyingType::Vec4: {
+            const glm::vec4 value = this->getVec4 ();
+            const int components = this->m_type == UnderlyingType::Vec2 ? 2 : this->m_type == UnderlyingType::Vec3 ? 3 : 4;
+            std::string result = std::to_string (value.x);
+
+            for (int i = 1; i < components; i++)
+                result += ", " + std::to_string (value [i]);
+
+            return result;
+        }
         case UnderlyingType::IVec2:
-            return std::to_string (this->m_ivec2.x) + ", " + std::to_string (this->m_ivec2.y);
         case UnderlyingType::IVec3:
-            return std::to_string (this->m_ivec3.x) + ", " + std::to_string (this->m_ivec3.y) + ", " + std::to_string (this->m_ivec3.z);
-        case UnderlyingType::IVec4:
-            return std::to_string (this->m_ivec4.x) + ", " + std::to_string (this->m_ivec4.y) + ", " + std::to_string (this->m_ivec4.z) + ", " + std::to_string (this->m_ivec4.w);
+        case UnderlyingType::IVec4: {
+            const glm::ivec4 value = this->getIVec4 ();
+            const int components = this->m_type == UnderlyingType::IVec2 ? 2 : this->m_type == UnderlyingType::IVec3 ? 3 : 4;
+            std::string result = std::to_string (value.x);
+
+            for (int i = 1; i < components; i++)
+                result += ", " + std::to_string (value [i]);
+
+            return result;
+        }
         default:
             return "Unknown conversion for dynamic value of type: " + std::to_string (static_cast<int> (this->m_type));
     }
 }
 
 void DynamicValue::update (const float newValue) {
-    this->m_ivec4 = glm::ivec4(static_cast<int> (newValue));
-    this->m_ivec3 = glm::ivec3(static_cast<int> (newValue));
-    this->m_ivec2 = glm::ivec2(static_cast<int> (newValue));
-    this->m_vec4 = glm::vec4(newValue);
-    this->m_vec3 = glm::vec3(newValue);
-    this->m_vec2 = glm::vec2(newValue);
-    this->m_float = newValue;
-    this->m_int = static_cast<int> (newValue);
-    this->m_bool = static_cast<int> (newValue) != 0;
-    this->m_string = "";
-    this->m_type = UnderlyingType::Float;
-
+    // scalars are splatted into every component, vectors are padded with zeros
+    this->store (UnderlyingType::Float, glm::vec4 (newValue), static_cast<int> (newValue) != 0);
     this->propagate ();
 }
 
 void DynamicValue::update (const int newValue) {
-    this->m_ivec4 = glm::ivec4(newValue);
-    this->m_ivec3 = glm::ivec3(newValue);
-    this->m_ivec2 = glm::ivec2(newValue);
-    this->m_vec4 = glm::vec4(static_cast<float> (newValue));
-    this->m_vec3 = glm::vec3(static_cast<float> (newValue));
-    this->m_vec2 = glm::vec2(static_cast<float> (newValue));
-    this->m_float = static_cast<float> (newValue);
-    this->m_int = newValue;
-    this->m_bool = newValue != 0;
-    this->m_string = "";
-    this->m_type = UnderlyingType::Int;
-
+    this->store (UnderlyingType::Int, glm::ivec4 (newValue), newValue != 0);
     this->propagate ();
 }
 
 void DynamicValue::update (const bool newValue) {
-    this->m_ivec4 = glm::ivec4(newValue);
-    this->m_ivec3 = glm::ivec3(newValue);
-    this->m_ivec2 = glm::ivec2(newValue);
-    this->m_vec4 = glm::vec4(newValue);
-    this->m_vec3 = glm::vec3(newValue);
-    this->m_vec2 = glm::vec2(newValue);
-    this->m_float = newValue;
-    this->m_int = newValue;
-    this->m_bool = newValue;
-    this->m_string = "";
-    this->m_type = UnderlyingType::Boolean;
-
+    this->store (UnderlyingType::Boolean, glm::ivec4 (newValue), newValue);
     this->propagate ();
 }
 
-void DynamicValue::update(const glm::vec2& newValue) {
-    this->m_ivec4 = glm::ivec4(newValue, 0, 0);
-    this->m_ivec3 = glm::ivec3(newValue, 0);
-    this->m_ivec2 = glm::ivec2(newValue);
-    this->m_vec2 = newValue;
-    this->m_vec3 = glm::vec3(newValue, 0.0f);
-    this->m_vec4 = glm::vec4(newValue, 0.0f, 0.0f);
-    this->m_float = newValue.x;
-    this->m_int = static_cast<int> (newValue.x);
-    this->m_bool = newValue.x != 0.0f;
-    this->m_string = "";
-    this->m_type = UnderlyingType::Vec2;
-
+void DynamicValue::update (const glm::vec2& newValue) {
+    this->store (UnderlyingType::Vec2, glm::vec4 (newValue, 0.0f, 0.0f), newValue.x != 0.0f);
     this->propagate ();
 }
 
-void DynamicValue::update(const glm::vec3& newValue) {
-    this->m_ivec4 = glm::ivec4(newValue, 0);
-    this->m_ivec3 = glm::ivec3(newValue);
-    this->m_ivec2 = glm::ivec2(newValue);
-    this->m_vec2 = glm::vec2(newValue);
-    this->m_vec3 = newValue;
-    this->m_vec4 = glm::vec4(newValue, 0.0f);
-    this->m_float = newValue.x;
-    this->m_int = static_cast<int> (newValue.x);
-    this->m_bool = newValue.x != 0.0f;
-    this->m_string = "";
-    this->m_type = UnderlyingType::Vec3;
-
+void DynamicValue::update (const glm::vec3& newValue) {
+    this->store (UnderlyingType::Vec3, glm::vec4 (newValue, 0.0f), newValue.x != 0.0f);
     this->propagate ();
 }
 
-void DynamicValue::update(const glm::vec4& newValue) {
-    this->m_ivec4 = glm::ivec4(newValue);
-    this->m_ivec3 = glm::ivec3(newValue);
-    this->m_ivec2 = glm::ivec2(newValue);
-    this->m_vec2 = glm::vec2(newValue);
-    this->m_vec3 = glm::vec3(newValue);
-    this->m_vec4 = newValue;
-    this->m_float = newValue.x;
-    this->m_int = static_cast<int> (newValue.x);
-    this->m_bool = newValue.x != 0.0f;
-    this->m_string = "";
-    this->m_type = UnderlyingType::Vec4;
-
+void DynamicValue::update (const glm::vec4& newValue) {
+    this->store (UnderlyingType::Vec4, newValue, newValue.x != 0.0f);
     this->propagate ();
 }
 
-void DynamicValue::update(const glm::ivec2& newValue) {
-    this->m_ivec4 = glm::ivec4(newValue, 0, 0);
-    this->m_ivec3 = glm::ivec3(newValue, 0);
-    this->m_ivec2 = glm::ivec2(newValue);
-    this->m_vec2 = newValue;
-    this->m_vec3 = glm::vec3(newValue, 0.0f);
-    this->m_vec4 = glm::vec4(newValue, 0.0f, 0.0f);
-    this->m_float = static_cast<float> (newValue.x);
-    this->m_int = static_cast<int> (newValue.x);
-    this->m_bool = newValue.x != 0;
-    this->m_string = "";
-    this->m_type = UnderlyingType::IVec2;
-
+void DynamicValue::update (const glm::ivec2& newValue) {
+    this->store (UnderlyingType::IVec2, glm::ivec4 (newValue, 0, 0), newValue.x != 0);
     this->propagate ();
 }
 
-void DynamicValue::update(const glm::ivec3& newValue) {
-    this->m_ivec4 = glm::ivec4(newValue, 0);
-    this->m_ivec3 = glm::ivec3(newValue);
-    this->m_ivec2 = glm::ivec2(newValue);
-    this->m_vec2 = glm::vec2(newValue);
-    this->m_vec3 = newValue;
-    this->m_vec4 = glm::vec4(newValue, 0.0f);
-    this->m_float = static_cast<float> (newValue.x);
-    this->m_int = static_cast<int> (newValue.x);
-    this->m_bool = newValue.x != 0;
-    this->m_string = "";
-    this->m_type = UnderlyingType::IVec3;
-
+void DynamicValue::update (const glm::ivec3& newValue) {
+    this->store (UnderlyingType::IVec3, glm::ivec4 (newValue, 0), newValue.x != 0);
     this->propagate ();
 }
 
-void DynamicValue::update(const glm::ivec4& newValue) {
-    this->m_ivec4 = glm::ivec4(newValue);
-    this->m_ivec3 = glm::ivec3(newValue);
-    this->m_ivec2 = glm::ivec2(newValue);
-    this->m_vec2 = glm::vec2(newValue);
-    this->m_vec3 = glm::vec3(newValue);
-    this->m_vec4 = newValue;
-    this->m_float = static_cast<float> (newValue.x);
-    this->m_int = static_cast<int> (newValue.x);
-    this->m_bool = newValue.x != 0;
-    this->m_string = "";
-    this->m_type = UnderlyingType::IVec4;
-
+void DynamicValue::update (const glm::ivec4& newValue) {
+    this->store (UnderlyingType::IVec4, newValue, newValue.x != 0);
     this->propagate ();
 }
 
 void DynamicValue::update (const std::string& newValue) {
-    this->m_ivec4 = glm::ivec4(0);
-    this->m_ivec3 = glm::ivec3(0);
-    this->m_ivec2 = glm::ivec2(0);
-    this->m_vec2 = glm::vec2(0.0f);
-    this->m_vec3 = glm::vec3(0.0f);
-    this->m_vec4 = glm::vec4(0.0f);
-    this->m_float = 0.0f;
-    this->m_int = 0;
-    this->m_bool = false;
-    this->m_string = newValue;
-    this->m_type = UnderlyingType::String;
+    this->store (UnderlyingType::String, glm::vec4 (0.0f), false);
+
+    if (this->m_extra != nullptr || !newValue.empty ())
+        this->extra ().string = newValue;
 }
 
 void DynamicValue::update (const DynamicValue& other) {
-    this->m_ivec4 = other.getIVec4 ();
-    this->m_ivec3 = other.getIVec3 ();
-    this->m_ivec2 = other.getIVec2 ();
-    this->m_vec2 = other.getVec2 ();
-    this->m_vec3 = other.getVec3 ();
-    this->m_vec4 = other.getVec4 ();
-    this->m_float = other.getFloat ();
-    this->m_int = other.getInt ();
-    this->m_bool = other.getBool ();
-    this->m_type = other.getType ();
-
-    if (this->m_condition.has_value () && other.getType () == UnderlyingType::String) {
+    bool boolean = other.m_bool;
+
+    if (this->m_extra != nullptr && this->m_extra->condition.has_value () &&
+        other.getType () == UnderlyingType::String) {
         // TODO: DOES THIS NEED TO HAPPEN WITH OTHER TYPES TOO?
-        this->m_bool = this->m_condition.value ().condition == other.getString ();
+        boolean = this->m_extra->condition.value ().condition == other.getString ();
     }
 
+    // the string is not copied over, only the values derived from it, so keep the current one
+    std::string string = this->m_extra != nullptr ? std::move (this->m_extra->string) : std::string ();
+
+    if (other.m_integer)
+        this->store (other.m_type, other.m_ivec4, boolean);
+    else
+        this->store (other.m_type, other.m_vec4, boolean);
+
+    if (this->m_extra != nullptr)
+        this->m_extra->string = std::move (string);
+
     this->propagate ();
 }
 
 void DynamicValue::update () {
-    this->m_ivec4 = glm::ivec4(0);
-    this->m_ivec3 = glm::ivec3(0);
-    this->m_ivec2 = glm::ivec2(0);
-    this->m_vec2 = glm::vec2(0.0f);
-    this->m_vec3 = glm::vec3(0.0f);
-    this->m_vec4 = glm::vec4(0.0f);
-    this->m_float = 0.0f;
-    this->m_int = 0;
-    this->m_bool = false;
-    this->m_type = UnderlyingType::Null;
+    std::string string = this->m_extra != nullptr ? std::move (this->m_extra->string) : std::string ();
+
+    this->store (UnderlyingType::Null, glm::vec4 (0.0f), false);
+
+    if (this->m_extra != nullptr)
+        this->m_extra->string = std::move (string);
 
     this->propagate ();
 }
 
+void DynamicValue::store (const UnderlyingType type, const glm::vec4& value, const bool boolean) {
+    this->m_vec4 = value;
+    this->m_integer = false;
+    this->m_bool = boolean;
+    this->m_type = type;
+
+    if (this->m_extra != nullptr)
+        this->m_extra->string.clear ();
+}
+
+void DynamicValue::store (const UnderlyingType type, const glm::ivec4& value, const bool boolean) {
+    this->m_ivec4 = value;
+    this->m_integer = true;
+    this->m_bool = boolean;
+    this->m_type = type;
+
+    if (this->m_extra != nullptr)
+        this->m_extra->string.clear ();
+}
+
+DynamicValue::Extra& DynamicValue::extra () {
+    if (this->m_extra == nullptr)
+        this->m_extra = std::make_unique<Extra> ();
+
+    return *this->m_extra;
+}
+
 std::function<void ()> DynamicValue::listen (const std::function<void (const DynamicValue&)>& callback) {
-    const auto it = this->m_listeners.insert (this->m_listeners.end (), callback);
-    auto alive = this->m_aliveFlag;
+    auto& extra = this->extra ();
+
+    if (extra.aliveFlag == nullptr)
+        extra.aliveFlag = std::make_shared<bool> (true);
+
+    const uint32_t id = extra.nextListener++;
+    auto alive = extra.aliveFlag;
 
-    return [this, it, alive] {
+    extra.listeners.emplace_back (id, callback);
+
+    return [this, id, alive] {
         if (!alive || !*alive)
             return;
-        this->m_listeners.erase (it);
+
+        auto& listeners = this->m_extra->listeners;
+
+        std::erase_if (listeners, [id] (const auto& listener) { return listener.first == id; });
     };
 }
 
@@ -335,11 +317,18 @@ void DynamicValue::connect (DynamicValue* other) {
     // same update cycle has to happen as in the lambda, so trigger it
     lambda (*other);
 
-    this->m_connections.push_back (deregisterFunction);
+    auto& extra = this->extra ();
+
+    // sources are always flushed before the values connected to them
+    extra.depth = std::max (extra.depth, other->m_extra->depth + 1);
+    extra.connections.push_back (deregisterFunction);
 }
 
 void DynamicValue::disconnect () {
-    for (const auto& deregister : this->m_connections) {
+    if (this->m_extra == nullptr)
+        return;
+
+    for (const auto& deregister : this->m_extra->connections) {
         if (!deregister)
             continue;
         try {
@@ -349,16 +338,72 @@ void DynamicValue::disconnect () {
         }
     }
 
-    this->m_connections.clear ();
+    this->m_extra->connections.clear ();
 }
 
 void DynamicValue::attachCondition (const ConditionInfo& condition) {
-    this->m_condition = condition;
+    this->extra ().condition = condition;
+}
+
+
+void DynamicValue::flush () {
+    if (sFlushing)
+        return;
+
+    sFlushing = true;
+
+    // notifying a level only queues values in the levels after it, sPending can grow so it's indexed every time
+    for (sFlushLevel = 0; sFlushLevel < sPending.size (); sFlushLevel++) {
+        for (size_t i = 0; i < sPending [sFlushLevel].size (); i++) {
+            DynamicValue* value = sPending [sFlushLevel] [i];
+
+            // destroyed after being queued
+            if (value == nullptr)
+                continue;
+
+            value->m_extra->queuedLevel = std::nullopt;
+            value->notify ();
+        }
+
+        sPending [sFlushLevel].clear ();
+    }
+
+    sFlushing = false;
 }
 
+void DynamicValue::propagate () {
+    if (this->m_extra == nullptr || this->m_extra->listeners.empty ())
+        return;
 
-void DynamicValue::propagate () const {
-    for (const auto& callback : this->m_listeners) {
-        callback(*this);
+    if (sBatchDepth > 0 || sFlushing)
+        this->queue ();
+    else
+        this->notify ();
+}
+
+void DynamicValue::notify () const {
+    // by index, listeners can deregister themselves while being called
+    for (size_t i = 0; i < this->m_extra->listeners.size (); i++) {
+        this->m_extra->listeners [i].second (*this);
     }
 }
+
+void DynamicValue::queue () {
+    auto& extra = *this->m_extra;
+
+    // already queued, it'll be notified with whatever value it has by then
+    if (extra.queuedLevel.has_value ())
+        return;
+
+    uint32_t level = extra.depth;
+
+    // a listener changed a value flush () already went past, it gets notified in the next level instead
+    if (sFlushing && level <= sFlushLevel)
+        level = sFlushLevel + 1;
+
+    if (sPending.size () <= level)
+        sPending.resize (level + 1);
+
+    sPending [level].push_back (this);
+    extra.queuedLevel = level;
+}
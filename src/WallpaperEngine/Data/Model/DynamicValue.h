@@ -1,12 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <glm/glm.hpp>
-#include <list>
 #include <memory>
 #include <optional>
 #include <string>
 
+#include "WallpaperEngine/Data/Utils/Arena.h"
+
 namespace WallpaperEngine::Data::Model {
 struct ConditionInfo {
     std::string name;
@@ -18,7 +20,22 @@ struct ConditionInfo {
  */
 class DynamicValue {
   public:
-    enum UnderlyingType {
+    ARENA_ALLOCATED
+
+    /**
+     * Holds back listener notifications while it exists, changes are queued instead, once per value, and delivered by
+     * flush (). Batches can be nested, only used from the main thread
+     */
+    class Batch {
+      public:
+        Batch ();
+        ~Batch ();
+
+        Batch (const Batch&) = delete;
+        Batch& operator= (const Batch&) = delete;
+    };
+
+    enum UnderlyingType : uint8_t {
         Null = 0,
         IVec4 = 1,
         IVec3 = 2,
@@ -42,17 +59,23 @@ class DynamicValue {
     explicit DynamicValue(float value);
     explicit DynamicValue(int value);
     explicit DynamicValue(bool value);
+    /**
+     * Copies the value, its string and condition, listeners and connections stay with the original
+     *
+     * @param other
+     */
+    DynamicValue (const DynamicValue& other);
     virtual ~DynamicValue ();
 
-    [[nodiscard]] const glm::ivec4& getIVec4 () const;
-    [[nodiscard]] const glm::ivec3& getIVec3 () const;
-    [[nodiscard]] const glm::ivec2& getIVec2 () const;
-    [[nodiscard]] const glm::vec4& getVec4 () const;
-    [[nodiscard]] const glm::vec3& getVec3 () const;
-    [[nodiscard]] const glm::vec2& getVec2 () const;
-    [[nodiscard]] const float& getFloat () const;
-    [[nodiscard]] const int& getInt () const;
-    [[nodiscard]] const bool& getBool () const;
+    [[nodiscard]] glm::ivec4 getIVec4 () const;
+    [[nodiscard]] glm::ivec3 getIVec3 () const;
+    [[nodiscard]] glm::ivec2 getIVec2 () const;
+    [[nodiscard]] glm::vec4 getVec4 () const;
+    [[nodiscard]] glm::vec3 getVec3 () const;
+    [[nodiscard]] glm::vec2 getVec2 () const;
+    [[nodiscard]] float getFloat () const;
+    [[nodiscard]] int getInt () const;
+    [[nodiscard]] bool getBool () const;
     [[nodiscard]] const std::string& getString () const;
     [[nodiscard]] UnderlyingType getType () const;
     [[nodiscard]] virtual std::string toString () const;
@@ -104,27 +127,78 @@ class DynamicValue {
      */
     void attachCondition (const ConditionInfo& condition);
 
+    /**
+     * Notifies the listeners of every value changed in a batch, sources before the values connected to them, so each
+     * value is only notified once with its latest value. Called at the start of every frame
+     */
+    static void flush ();
+
   private:
+    /**
+     * Everything most values never use, only allocated when a value is listened to, connected, conditioned or holds
+     * a string
+     */
+    struct Extra {
+        std::shared_ptr<bool> aliveFlag = nullptr;
+        std::vector<std::pair<uint32_t, std::function<void (const DynamicValue&)>>> listeners = {};
+        std::vector<std::function<void ()>> connections = {};
+        /** Id the next listener gets, used to deregister it */
+        uint32_t nextListener = 0;
+        /** How many connections away from a value nothing is connected to, values are flushed in this order */
+        uint32_t depth = 0;
+        /** The level of the pending queue the value is in, if queued */
+        std::optional<uint32_t> queuedLevel = std::nullopt;
+        std::string string = "";
+        std::optional<ConditionInfo> condition = std::nullopt;
+    };
+
     /**
      * Notifies any listeners that the value has changed
      */
-    void propagate () const;
-
-    std::shared_ptr<bool> m_aliveFlag = std::make_shared<bool> (true);
-    std::list<std::function<void (const DynamicValue&)>> m_listeners = {};
-    std::vector<std::function<void ()>> m_connections = {};
-
-    glm::ivec4 m_ivec4 = {};
-    glm::ivec3 m_ivec3 = {};
-    glm::ivec2 m_ivec2 = {};
-    glm::vec4 m_vec4 = {};
-    glm::vec3 m_vec3 = {};
-    glm::vec2 m_vec2 = {};
-    float m_float = 0.0f;
-    int m_int = 0;
-    bool m_bool = false;
-    std::string m_string = "";
+    void propagate ();
+    /**
+     * Calls every listener with the current value
+     */
+    void notify () const;
+    /**
+     * Queues the value to be notified on the next flush (), if it's not queued yet
+     */
+    void queue ();
+    /**
+     * @return The side allocation, created on first use
+     */
+    Extra& extra ();
+    /**
+     * Stores a new value, integer and float values keep their own representation so they're read back without losses
+     *
+     * @param type
+     * @param value Already widened to four components the way the value is read back
+     * @param boolean
+     */
+    void store (UnderlyingType type, const glm::vec4& value, bool boolean);
+    void store (UnderlyingType type, const glm::ivec4& value, bool boolean);
+
+    /**
+     * The value itself, widened to four components when stored so reads only have to pick the representation
+     */
+    union {
+        glm::vec4 m_vec4;
+        glm::ivec4 m_ivec4 = {};
+    };
     UnderlyingType m_type = Null;
-    std::optional<ConditionInfo> m_condition = std::nullopt;
+    /** If the payload holds integers instead of floats */
+    bool m_integer = false;
+    /** Not derived from the payload, conditions and the per-type rules decide it when the value is stored */
+    bool m_bool = false;
+    std::unique_ptr<Extra> m_extra = nullptr;
+
+    /** Open batches */
+    static int sBatchDepth;
+    /** If flush () is delivering notifications, changes made by listeners are queued for a later level */
+    static bool sFlushing;
+    /** The level flush () is delivering */
+    static uint32_t sFlushLevel;
+    /** Values waiting to be notified, by depth */
+    static std::vector<std::vector<DynamicValue*>> sPending;
 };
-}
+}
\ No newline at end of file
@@ -12,6 +12,8 @@ enum PassCommandType {
 };
 
 struct FBO {
+    ARENA_ALLOCATED
+
     std::string name;
     std::string format;
     float scale;
@@ -19,6 +21,8 @@ struct FBO {
 };
 
 struct EffectPass {
+    ARENA_ALLOCATED
+
     /** The material to use for this effect's pass */
     std::optional<MaterialUniquePtr> material;
     /** Texture bindings for this effect's pass */
@@ -32,6 +36,8 @@ struct EffectPass {
 };
 
 struct Effect {
+    ARENA_ALLOCATED
+
     /** Effect's name for the UI */
     std::string name;
     /** Effect's description for the UI */
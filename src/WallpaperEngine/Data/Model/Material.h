@@ -35,6 +35,8 @@ enum DepthwriteMode {
 };
 
 struct MaterialPass {
+    ARENA_ALLOCATED
+
     /** Blending mode */
     BlendingMode blending;
     /** Culling mode */
@@ -56,6 +58,8 @@ struct MaterialPass {
 };
 
 struct Material {
+    ARENA_ALLOCATED
+
     /** The name of the file this material is defined in */
     std::string filename;
     /** The passes that compose this material */
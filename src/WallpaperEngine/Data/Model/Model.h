@@ -8,6 +8,8 @@
 namespace WallpaperEngine::Data::Model {
 // TODO: FIND A BETTER NAMING SO THIS DOESN'T COLLIDE WITH THE NAMESPACE ITSELF
 struct ModelStruct {
+    ARENA_ALLOCATED
+
     /** The filename of the model */
     std::string filename;
     /** The material used for this model */
@@ -34,6 +34,8 @@ struct ObjectData {
  */
 class Object : public TypeCaster, public ObjectData {
   public:
+    ARENA_ALLOCATED
+
     explicit Object (ObjectData data) noexcept : TypeCaster (), ObjectData (std::move (data)) {};
     ~Object () override = default;
 };
@@ -45,6 +47,8 @@ class Object : public TypeCaster, public ObjectData {
  * @see EffectPass
  */
 struct ImageEffectPassOverride {
+    ARENA_ALLOCATED
+
     int id;
     ComboMap combos;
     ShaderConstantMap constants;
@@ -60,6 +64,8 @@ struct ImageEffectPassOverride {
  * @see ImageEffectPass
  */
 struct ImageEffect {
+    ARENA_ALLOCATED
+
     /** Not sure what it's used for */
     int id;
     /** Effect's name for the editor */
@@ -76,6 +82,8 @@ struct ImageEffect {
  * Animation layers for the puppet warp
  */
 struct ImageAnimationLayer {
+    ARENA_ALLOCATED
+
     int id;
     float rate;
     bool visible;
@@ -126,6 +134,8 @@ struct SoundData {
     // TODO: WRITE AN ENUM FOR THIS
     std::optional <std::string> playbackmode;
     std::vector <std::string> sounds;
+    /** Volume the sounds are mixed at */
+    float volume;
 };
 
 class Sound : public Object, public SoundData {
@@ -168,6 +178,8 @@ struct ParticleEmitter {
  */
 class ParticleInitializerBase : public TypeCaster {
   public:
+    ARENA_ALLOCATED
+
     virtual ~ParticleInitializerBase () = default;
 };
 
@@ -249,6 +261,8 @@ using ParticleInitializerUniquePtr = std::unique_ptr<ParticleInitializerBase>;
  */
 class ParticleOperatorBase : public TypeCaster {
   public:
+    ARENA_ALLOCATED
+
     virtual ~ParticleOperatorBase () = default;
 };
 
@@ -366,6 +380,8 @@ struct ParticleChild {
     glm::vec3 origin;
     glm::vec3 scale;
     std::string particleFile;
+    /** The child's own system, nullptr if particleFile couldn't be loaded */
+    std::shared_ptr <Particle> definition;
 };
 
 /**
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <string>
 #include <memory>
 
@@ -19,6 +20,8 @@ struct Project {
         Type_Unknown = 3
     };
 
+    /** Memory the model tree was parsed into, declared first so it outlives everything allocated from it */
+    Utils::ArenaUniquePtr arena;
     /** Wallpapers title */
     std::string title;
     /** Wallpaper's type */
@@ -33,5 +36,7 @@ struct Project {
     WallpaperUniquePtr wallpaper;
     /** Abstraction over asset loading to provide access to them */
     AssetLocatorUniquePtr assetLocator;
+    /** Folder the project was loaded from */
+    std::filesystem::path path;
 };
 };
@@ -5,6 +5,8 @@
 #include <string>
 #include <memory>
 
+#include "WallpaperEngine/Data/Utils/Arena.h"
+
 namespace WallpaperEngine::Data::Model {
 struct Project;
 class Wallpaper;
@@ -41,6 +43,7 @@ using UserSettingUniquePtr = std::unique_ptr <UserSetting>;
 using ShaderConstantMap = std::map <std::string, UserSettingUniquePtr>;
 
 using ProjectUniquePtr = std::unique_ptr <Project>;
+using ProjectSharedPtr = std::shared_ptr <Project>;
 using WallpaperUniquePtr = std::unique_ptr <Wallpaper>;
 using SceneUniquePtr = std::unique_ptr <Scene>;
 using WebUniquePtr = std::unique_ptr <Web>;
@@ -2,12 +2,15 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 
 #include "DynamicValue.h"
 #include "Types.h"
 
 namespace WallpaperEngine::Data::Model {
 struct UserSetting {
+    ARENA_ALLOCATED
+
     /**
      * The value of this setting, can be a few different things:
      * - a value connected to the property
@@ -19,6 +22,10 @@ struct UserSetting {
     PropertySharedPtr property;
     /** Condition required for this setting, this should be possible to run in JS' V8 */
     std::optional <ConditionInfo> condition;
-    /** TODO: Value might come from a script and not have conditions, implement this later */
+    /**
+     * SceneScript source that computes the value, empty if there's none. Scripts are not run yet, the value stays
+     * the static one the setting ships next to it
+     */
+    std::string script;
 };
 } // namespace WallpaperEngine::Data::Model
\ No newline at end of file
@@ -19,6 +19,8 @@ struct WallpaperData {
 
 class Wallpaper : public TypeCaster, public WallpaperData {
   public:
+    ARENA_ALLOCATED
+
     explicit Wallpaper (WallpaperData data) noexcept : TypeCaster (), WallpaperData (std::move(data)) {};
     ~Wallpaper () override = default;
 };
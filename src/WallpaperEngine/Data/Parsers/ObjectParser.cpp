@@ -81,18 +81,23 @@ std::vector<int> ObjectParser::parseDependencies (const JSON& it) {
 }
 
 SoundUniquePtr ObjectParser::parseSound (const JSON& it, ObjectData base) {
-    const auto soundIt = it.require ("sound", "Object must have a sound");
+    const auto& soundIt = it.require ("sound", "Object must have a sound");
     std::vector<std::string> sounds = {};
 
     for (const auto& cur : soundIt) {
         sounds.push_back (cur);
     }
 
+    // volume can also be bound to a user property, those are played at full volume for now
+    const auto volumeIt = it.find ("volume");
+    const float volume = volumeIt != it.end () && volumeIt->is_number () ? volumeIt->get<float> () : 1.0f;
+
     return std::make_unique <Sound> (
         std::move (base),
         SoundData {
             .playbackmode = it.optional <std::string> ("playbackmode"),
             .sounds = sounds,
+            .volume = volume,
         }
     );
 }
@@ -296,7 +301,7 @@ ParticleUniquePtr ObjectParser::parseParticle (const JSON& it, const Project& pr
     JSON particleJson = JSON::object ();
     if (!particleFile.empty ()) {
         try {
-            particleJson = WallpaperEngine::Data::JSON::JSON::parse (project.assetLocator->readString (particleFile));
+            particleJson = project.assetLocator->readJSON (particleFile);
         } catch (std::runtime_error& e) {
             sLog.error ("Cannot load particle file: ", particleFile, " - ", e.what ());
         }
@@ -819,6 +824,25 @@ ParticleChild ObjectParser::parseParticleChild (const JSON& it, const Project& p
         return defaultValue;
     };
 
+    // children can have children of their own, cap the nesting so a file referencing itself doesn't recurse forever
+    static int nesting = 0;
+    std::shared_ptr <Particle> definition = nullptr;
+
+    if (!particleFile.empty () && nesting < MAX_PARTICLE_CHILD_NESTING) {
+        JSON childJson = JSON::object ();
+        childJson ["particle"] = particleFile;
+
+        nesting++;
+
+        try {
+            definition = parseParticle (childJson, project, ObjectData {.id = 0, .name = name, .dependencies = {}});
+        } catch (std::exception& e) {
+            sLog.error ("Cannot load child particle ", particleFile, " - ", e.what ());
+        }
+
+        nesting--;
+    }
+
     return ParticleChild {
         .type = type,
         .name = name,
@@ -829,6 +853,7 @@ ParticleChild ObjectParser::parseParticleChild (const JSON& it, const Project& p
         .origin = parseVec3 ("origin", glm::vec3 (0.0f)),
         .scale = parseVec3 ("scale", glm::vec3 (1.0f)),
         .particleFile = particleFile,
+        .definition = std::move (definition),
     };
 }
 
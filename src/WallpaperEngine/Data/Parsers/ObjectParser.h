@@ -18,6 +18,9 @@ class ObjectParser {
     static ObjectUniquePtr parse (const JSON& it, const Project& project);
 
   private:
+    /** How deep child particle systems are followed */
+    static constexpr int MAX_PARTICLE_CHILD_NESTING = 3;
+
     static std::vector<int> parseDependencies (const JSON& it);
     static SoundUniquePtr parseSound (const JSON& it, ObjectData base);
     static ImageUniquePtr parseImage (const JSON& it, const Project& project, ObjectData base, const std::string& image);
@@ -5,6 +5,7 @@
 
 #include "WallpaperEngine/Data/Assets/Package.h"
 
+#include <filesystem>
 #include <fstream>
 #include <memory>
 
@@ -15,20 +16,32 @@ using namespace WallpaperEngine::Data::Utils;
 PackageUniquePtr PackageParser::parse (ReadStreamSharedPtr stream) {
     auto reader = std::make_unique <BinaryReader> (std::move (stream));
 
-    if (const std::string header = reader->nextSizedString (); header.starts_with ("PKGV") == false) {
+    std::string header = reader->nextSizedString ();
+
+    if (header.starts_with ("PKGV") == false) {
         sLog.exception ("Expected header to start with PKGV, got ", header);
     }
 
     auto result =  std::make_unique <Package> (Package {
+        .header = std::move (header),
         .file = std::move(reader),
     });
 
     result->files = parseFileList (*result->file);
+    result->index.reserve (result->files.size ());
+
+    for (const auto& entry : result->files)
+        result->index.emplace (normalize (entry->filename), entry.get ());
+
     result->baseOffset = result->file->base ().tellg ();
 
     return result;
 }
 
+std::string PackageParser::normalize (const std::filesystem::path& path) {
+    return path.lexically_normal ().generic_string ();
+}
+
 FileEntryList PackageParser::parseFileList (const BinaryReader& stream) {
     FileEntryList result = {};
     const uint32_t filesCount = stream.nextUInt32 ();
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <filesystem>
 #include <iosfwd>
+#include <string>
 #include "WallpaperEngine/Data/Assets/Types.h"
 #include "WallpaperEngine/Data/Utils/BinaryReader.h"
 
@@ -10,6 +12,12 @@ using namespace WallpaperEngine::Data::Utils;
 class PackageParser {
 public:
     static PackageUniquePtr parse (ReadStreamSharedPtr stream);
+    /**
+     * @param path
+     *
+     * @return The key the path has in Package::index
+     */
+    static std::string normalize (const std::filesystem::path& path);
 
 private:
     static FileEntryList parseFileList (const BinaryReader& stream);
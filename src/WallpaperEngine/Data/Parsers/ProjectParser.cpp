@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <atomic>
 
 #include "ProjectParser.h"
 #include "WallpaperEngine/Logging/Log.h"
@@ -10,10 +11,12 @@
 #include "WallpaperEngine/FileSystem/Container.h"
 
 using namespace WallpaperEngine::Data::Parsers;
+using namespace WallpaperEngine::Data::Utils;
 
-static int backgroundId = 0;
+// backgrounds are parsed from several jobs at once
+static std::atomic<int> backgroundId = 0;
 
-ProjectUniquePtr ProjectParser::parse (const JSON& data, AssetLocatorUniquePtr container) {
+ProjectUniquePtr ProjectParser::parse (const JSON& data, AssetLocatorUniquePtr container, const bool metadataOnly) {
     const auto general = data.optional ("general");
     const auto workshopId = data.optional ("workshopid");
     auto actualWorkshopId = std::to_string (--backgroundId);
@@ -32,6 +35,10 @@ ProjectUniquePtr ProjectParser::parse (const JSON& data, AssetLocatorUniquePtr c
     // lowercase for consistency
     std::ranges::transform (type, type.begin (), tolower);
 
+    // the whole model tree is parsed into the project's arena and released with it
+    auto arena = std::make_unique <Arena> ();
+    Arena::Scope scope (*arena);
+
     auto result = std::make_unique <Project> (Project {
         .title = data.require <std::string> ("title", "Project title missing"),
         .type = parseType (type),
@@ -41,8 +48,18 @@ ProjectUniquePtr ProjectParser::parse (const JSON& data, AssetLocatorUniquePtr c
         .assetLocator = std::move(container),
     });
 
+    // the scene, its objects, materials and effects are the bulk of the work and not needed to list properties
+    if (metadataOnly) {
+        result->arena = std::move (arena);
+        return result;
+    }
+
     result->wallpaper = WallpaperParser::parse (data.require ("file", "Project's main file missing"), *result);
 
+    sLog.debug ("Parsed ", result->title, " into ", arena->getUsed () / 1024, "KiB of model memory");
+
+    result->arena = std::move (arena);
+
     return result;
 }
 
@@ -17,7 +17,14 @@ using namespace WallpaperEngine::Data::Model;
  */
 class ProjectParser {
   public:
-    static ProjectUniquePtr parse (const JSON& data, AssetLocatorUniquePtr container);
+    /**
+     * @param data
+     * @param container
+     * @param metadataOnly Stops after the project's own information and properties, the wallpaper is left empty
+     *
+     * @return
+     */
+    static ProjectUniquePtr parse (const JSON& data, AssetLocatorUniquePtr container, bool metadataOnly = false);
 
   private:
     static Project::Type parseType (const std::string& type);
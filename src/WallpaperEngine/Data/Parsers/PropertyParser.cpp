@@ -46,7 +46,7 @@ PropertySharedPtr PropertyParser::parse (const JSON& it, const std::string& name
 PropertySharedPtr PropertyParser::parseCombo (const JSON& it, const std::string& name) {
     std::map <std::string, std::string> optionsMap = {};
 
-    const auto options = it.require ("options", "Combo property must have options");
+    const auto& options = it.require ("options", "Combo property must have options");
 
     if (!options.is_array ()) {
         sLog.exception ("Property combo options should be an array");
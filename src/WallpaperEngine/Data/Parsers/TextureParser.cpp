@@ -11,7 +11,7 @@
 using namespace WallpaperEngine::Data::Assets;
 using namespace WallpaperEngine::Data::Parsers;
 
-TextureUniquePtr TextureParser::parse (const BinaryReader& file) {
+TextureUniquePtr TextureParser::parse (const BinaryReader& file, const bool decompress) {
     auto result = std::make_unique<Texture> ();
 
     parseTextureHeader (*result, file);
@@ -22,7 +22,7 @@ TextureUniquePtr TextureParser::parse (const BinaryReader& file) {
         MipmapList mipmaps;
 
         for (uint32_t mipmap = 0; mipmap < mipmapCount; mipmap++) {
-            mipmaps.emplace_back (parseMipmap (file, *result));
+            mipmaps.emplace_back (parseMipmap (file, *result, decompress));
         }
 
         result->images.emplace (image, mipmaps);
@@ -37,7 +37,7 @@ TextureUniquePtr TextureParser::parse (const BinaryReader& file) {
     return result;
 }
 
-MipmapSharedPtr TextureParser::parseMipmap (const BinaryReader& file, const Texture& header) {
+MipmapSharedPtr TextureParser::parseMipmap (const BinaryReader& file, const Texture& header, const bool decompress) {
     auto result = std::make_shared<Mipmap> ();
 
     // TEXB0004 has some extra data in the header that has to be handled
@@ -71,27 +71,42 @@ MipmapSharedPtr TextureParser::parseMipmap (const BinaryReader& file, const Text
         result->uncompressedSize = result->compressedSize;
     }
 
-    result->uncompressedData = std::unique_ptr<char[]> (new char [result->uncompressedSize]);
-
     if (result->compression == 1) {
         result->compressedData = std::unique_ptr<char[]> (new char [result->compressedSize]);
         // read the compressed data into the buffer
         file.next (result->compressedData.get (), result->compressedSize);
-        // finally decompress it
-        int bytes = LZ4_decompress_safe (
-            result->compressedData.get (), result->uncompressedData.get (), result->compressedSize,
-            result->uncompressedSize
-        );
-
-        if (bytes < 0)
-            sLog.exception ("Cannot decompress texture data, LZ4_decompress_safe returned an error");
+
+        if (decompress)
+            TextureParser::decompress (*result);
     } else {
+        result->uncompressedData = std::unique_ptr<char[]> (new char [result->uncompressedSize]);
         file.next (result->uncompressedData.get (), result->uncompressedSize);
     }
 
     return result;
 }
 
+void TextureParser::decompress (Mipmap& mipmap) {
+    if (mipmap.uncompressedData != nullptr)
+        return;
+
+    mipmap.uncompressedData = std::unique_ptr<char[]> (new char [mipmap.uncompressedSize]);
+
+    decompress (mipmap, mipmap.uncompressedData.get ());
+
+    // the compressed blocks are of no use anymore
+    mipmap.compressedData.reset ();
+}
+
+void TextureParser::decompress (const Mipmap& mipmap, char* destination) {
+    int bytes = LZ4_decompress_safe (
+        mipmap.compressedData.get (), destination, mipmap.compressedSize, mipmap.uncompressedSize
+    );
+
+    if (bytes < 0)
+        sLog.exception ("Cannot decompress texture data, LZ4_decompress_safe returned an error");
+}
+
 FrameSharedPtr TextureParser::parseFrame (const BinaryReader& file) {
     auto result = std::make_shared<Frame> ();
 
@@ -304,9 +319,10 @@ FIF TextureParser::parseFIF (uint32_t value) {
 }
 
 TextureUniquePtr TextureParser::parse (const BinaryReader& file, const std::string& filename,
-                                       std::function<std::string(const std::string&)> metadataLoader) {
+                                       std::function<std::string(const std::string&)> metadataLoader,
+                                       const bool decompress) {
     // Parse the binary .tex file first
-    auto result = parse (file);
+    auto result = parse (file, decompress);
 
     // Try to load optional .tex-json metadata for spritesheet data
     if (metadataLoader) {
@@ -14,10 +14,30 @@ using namespace WallpaperEngine::Data::Assets;
 
 class TextureParser {
   public:
-    static TextureUniquePtr parse (const BinaryReader& file);
+    /**
+     * @param file
+     * @param decompress If false the LZ4 compressed mipmaps are left as they are, decompress () has to be called on
+     * them before their uncompressedData can be used
+     */
+    static TextureUniquePtr parse (const BinaryReader& file, bool decompress = true);
     static TextureUniquePtr parse (const BinaryReader& file, const std::string& filename,
-                                    std::function<std::string(const std::string&)> metadataLoader);
-    static MipmapSharedPtr parseMipmap (const BinaryReader& file, const Texture& header);
+                                    std::function<std::string(const std::string&)> metadataLoader,
+                                    bool decompress = true);
+    static MipmapSharedPtr parseMipmap (const BinaryReader& file, const Texture& header, bool decompress = true);
+    /**
+     * Fills in the uncompressedData of a mipmap parsed without decompressing it, does nothing if it's already there.
+     * Only touches the mipmap itself so it can run on any thread
+     *
+     * @param mipmap
+     */
+    static void decompress (Mipmap& mipmap);
+    /**
+     * Decompresses an LZ4 compressed mipmap into the given buffer instead of its uncompressedData
+     *
+     * @param mipmap
+     * @param destination At least mipmap.uncompressedSize bytes
+     */
+    static void decompress (const Mipmap& mipmap, char* destination);
     static FrameSharedPtr parseFrame (const BinaryReader& file);
 
   private:
@@ -1,5 +1,7 @@
 #include "UserSettingParser.h"
 
+#include <mutex>
+
 #include "WallpaperEngine/Data/Model/UserSetting.h"
 #include "WallpaperEngine/Data/Model/Property.h"
 
@@ -10,17 +12,24 @@ UserSettingUniquePtr UserSettingParser::parse (const json& data, const Propertie
     auto value = std::make_unique <DynamicValue> ();
     PropertySharedPtr property;
     std::optional<ConditionInfo> condition;
-    auto valueIt = data;
-    std::string content = data.dump ();
+    std::string script;
+    // points into the document, the value itself is never copied
+    const json* valueIt = &data;
 
     if (data.is_object ()) {
         const auto user = data.optional ("user");
-        const auto script = data.optional ("script");
-        valueIt = data.require ("value", "User setting must have a value");
+        const auto scriptIt = data.optional ("script");
+        valueIt = &data.require ("value", "User setting must have a value");
+
+        if (scriptIt.has_value () && scriptIt->is_string ()) {
+            static std::once_flag warned;
+
+            // scenes can have hundreds of scripted settings, and backgrounds are parsed on several jobs at once
+            std::call_once (warned, [] {
+                sLog.error ("SceneScript is not supported yet, scripted values keep the value they were saved with");
+            });
 
-        // TODO: PARSE SCRIPT VALUES
-        if (script.has_value () && !script->is_null ()) {
-            sLog.error ("Found user setting with script value: ", script.value ().dump ());
+            script = scriptIt->get <std::string> ();
         }
 
         if (user.has_value () && !user->is_null ()) {
@@ -44,24 +53,24 @@ UserSettingUniquePtr UserSettingParser::parse (const json& data, const Propertie
     }
 
     // actual value parsing
-    if (valueIt.is_string ()) {
-        std::string str = valueIt;
+    if (valueIt->is_string ()) {
+        const auto& str = valueIt->get_ref <const std::string&> ();
 
         // TODO: VALIDATE THIS IS RIGHT?
         if (int size = VectorBuilder::preparseSize (str); size == 2) {
-            value->update (static_cast<glm::vec2> (valueIt));
+            value->update (VectorBuilder::parse <glm::vec2> (str));
         } else if (size == 3) {
-            value->update (static_cast<glm::vec3> (valueIt));
+            value->update (VectorBuilder::parse <glm::vec3> (str));
         } else {
-            value->update (static_cast<glm::vec4> (valueIt));
+            value->update (VectorBuilder::parse <glm::vec4> (str));
         }
-    } else if (valueIt.is_number_integer ()) {
-        value->update (valueIt.get <int> ());
-    } else if (valueIt.is_number_float ()) {
-        value->update (valueIt.get <float> ());
-    } else if (valueIt.is_boolean ()) {
-        value->update (valueIt.get <bool> ());
-    } else if (valueIt.is_null ()) {
+    } else if (valueIt->is_number_integer ()) {
+        value->update (valueIt->get <int> ());
+    } else if (valueIt->is_number_float ()) {
+        value->update (valueIt->get <float> ());
+    } else if (valueIt->is_boolean ()) {
+        value->update (valueIt->get <bool> ());
+    } else if (valueIt->is_null ()) {
         // null value with no connection to property
         value->update ();
     }
@@ -80,5 +89,6 @@ UserSettingUniquePtr UserSettingParser::parse (const json& data, const Propertie
         .value = std::move (value),
         .property = property,
         .condition = condition,
+        .script = std::move (script),
     });
 }
\ No newline at end of file
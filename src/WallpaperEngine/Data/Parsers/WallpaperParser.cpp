@@ -22,11 +22,11 @@ WallpaperUniquePtr WallpaperParser::parse (const JSON& file, Project& project) {
 }
 
 SceneUniquePtr WallpaperParser::parseScene (const JSON& file, Project& project) {
-    const auto scene = JSON::parse (project.assetLocator->readString (file));
-    const auto camera = scene.require ("camera", "Scenes must have a camera section");
-    const auto general = scene.require ("general", "Scenes must have a general section");
-    const auto projection = general.require ("orthogonalprojection", "General section must have orthogonal projection info");
-    const auto objects = scene.require ("objects", "Scenes must have an objects section");
+    const auto scene = project.assetLocator->readJSON (file);
+    const auto& camera = scene.require ("camera", "Scenes must have a camera section");
+    const auto& general = scene.require ("general", "Scenes must have a general section");
+    const auto& projection = general.require ("orthogonalprojection", "General section must have orthogonal projection info");
+    const auto& objects = scene.require ("objects", "Scenes must have an objects section");
     const auto& properties = project.properties;
 
     // TODO: FIND IF THESE DEFAULTS ARE SENSIBLE OR NOT AND PERFORM PROPER VALIDATION WHEN CAMERA PREVIEW AND CAMERA
@@ -0,0 +1,58 @@
+#include "Arena.h"
+
+#include <new>
+#include <utility>
+
+using namespace WallpaperEngine::Data::Utils;
+
+/** Block size the arena starts with, a small scene's whole tree fits in the first couple of them */
+#define ARENA_INITIAL_SIZE (64 * 1024)
+
+namespace {
+/**
+ * Sits in front of every node so delete knows where it came from, keeps the node aligned like malloc would
+ */
+struct alignas (std::max_align_t) Header {
+    Arena* arena;
+};
+} // namespace
+
+thread_local Arena* Arena::sCurrent = nullptr;
+
+Arena::Scope::Scope (Arena& arena) : m_previous (std::exchange (sCurrent, &arena)) {}
+
+Arena::Scope::~Scope () {
+    sCurrent = this->m_previous;
+}
+
+Arena::Arena () : m_resource (ARENA_INITIAL_SIZE, std::pmr::new_delete_resource ()) {}
+
+void* Arena::allocate (const std::size_t size) {
+    Arena* arena = sCurrent;
+    void* memory;
+
+    if (arena != nullptr) {
+        memory = arena->m_resource.allocate (sizeof (Header) + size, alignof (Header));
+        arena->m_used += sizeof (Header) + size;
+    } else {
+        memory = ::operator new (sizeof (Header) + size);
+    }
+
+    auto* header = new (memory) Header {arena};
+
+    return header + 1;
+}
+
+void Arena::deallocate (void* pointer) noexcept {
+    if (pointer == nullptr)
+        return;
+
+    const auto* header = static_cast<Header*> (pointer) - 1;
+
+    if (header->arena == nullptr)
+        ::operator delete (const_cast<Header*> (header));
+}
+
+std::size_t Arena::getUsed () const {
+    return this->m_used;
+}
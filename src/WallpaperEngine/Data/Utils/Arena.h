@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace WallpaperEngine::Data::Utils {
+/**
+ * Monotonic memory for a project's model tree
+ *
+ * Everything the parsers create while a scope is open is carved out of a few big blocks instead of going through
+ * malloc one node at a time, and all of it goes back in one go when the project is unloaded. Deleting single nodes
+ * doesn't free anything, the memory stays with the arena until then
+ */
+class Arena {
+  public:
+    /**
+     * Makes the arena the one model nodes are allocated from on this thread while it exists, scopes can be nested
+     */
+    class Scope {
+      public:
+        explicit Scope (Arena& arena);
+        ~Scope ();
+
+        Scope (const Scope&) = delete;
+        Scope& operator= (const Scope&) = delete;
+
+      private:
+        Arena* m_previous;
+    };
+
+    Arena ();
+
+    Arena (const Arena&) = delete;
+    Arena& operator= (const Arena&) = delete;
+
+    /**
+     * Allocates from the arena of the current scope or the heap when there's none
+     *
+     * @param size
+     *
+     * @return The memory for the new node
+     */
+    static void* allocate (std::size_t size);
+    /**
+     * Frees nodes that came from the heap, arena nodes are only released with their arena
+     *
+     * @param pointer
+     */
+    static void deallocate (void* pointer) noexcept;
+
+    /**
+     * @return Bytes handed out from this arena so far
+     */
+    [[nodiscard]] std::size_t getUsed () const;
+
+  private:
+    std::pmr::monotonic_buffer_resource m_resource;
+    std::size_t m_used = 0;
+
+    static thread_local Arena* sCurrent;
+};
+
+using ArenaUniquePtr = std::unique_ptr<Arena>;
+} // namespace WallpaperEngine::Data::Utils
+
+/**
+ * Sends the type's new and delete through the arena of the project being parsed, the type itself stays an aggregate
+ */
+#define ARENA_ALLOCATED                                                                                                \
+    static void* operator new (std::size_t size) {                                                                     \
+        return WallpaperEngine::Data::Utils::Arena::allocate (size);                                                   \
+    }                                                                                                                  \
+    static void operator delete (void* pointer) noexcept {                                                             \
+        WallpaperEngine::Data::Utils::Arena::deallocate (pointer);                                                     \
+    }
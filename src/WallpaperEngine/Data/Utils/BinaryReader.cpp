@@ -1,18 +1,22 @@
+#include <algorithm>
 #include <iostream>
 #include <bit>
 
 #include "BinaryReader.h"
+#include "MemoryStream.h"
 
 #include <cstring>
 
 using namespace WallpaperEngine::Data::Utils;
 
-BinaryReader::BinaryReader (ReadStreamSharedPtr file) : m_input (std::move (file)) { }
+BinaryReader::BinaryReader (ReadStreamSharedPtr file) :
+    m_input (std::move (file)),
+    m_memory (dynamic_cast<MemoryStream*> (this->m_input.get ())) { }
 
 uint32_t BinaryReader::nextUInt32 () const {
     char buffer[4];
 
-    this->m_input->read (buffer, 4);
+    this->next (buffer, 4);
 
     if constexpr (std::endian::native == std::endian::little) {
         return (buffer [3] & 0xFF) << 24 |
@@ -28,60 +32,98 @@ uint32_t BinaryReader::nextUInt32 () const {
 }
 
 int BinaryReader::nextInt () const {
-    char buffer[4];
-
-    this->m_input->read (buffer, 4);
-
-    if constexpr (std::endian::native == std::endian::little) {
-        return (buffer [3] & 0xFF) << 24 |
-               (buffer [2] & 0xFF) << 16 |
-               (buffer [1] & 0xFF) << 8 |
-               (buffer [0] & 0xFF);
-    } else {
-        return (buffer [0] & 0xFF) << 24 |
-               (buffer [1] & 0xFF) << 16 |
-               (buffer [2] & 0xFF) << 8 |
-               (buffer [3] & 0xFF);
-    }
+    return static_cast<int> (this->nextUInt32 ());
 }
 
 float BinaryReader::nextFloat () const {
     float result;
     static_assert (std::endian::native == std::endian::little, "Only little endian is supported for floats");
 
-    this->m_input->read (reinterpret_cast<char*>(&result), sizeof (result));
+    this->next (reinterpret_cast<char*>(&result), sizeof (result));
 
     return result;
 }
 
 
 std::string BinaryReader::nextNullTerminatedString () const {
-    std::string output;
+    return std::string (this->nextNullTerminatedStringView ());
+}
+
+std::string BinaryReader::nextSizedString () const {
+    return std::string (this->nextSizedStringView ());
+}
 
-    while (const auto c = this->next ()) {
-        output += c;
+std::string_view BinaryReader::nextNullTerminatedStringView () const {
+    if (this->m_memory == nullptr) {
+        this->m_scratch.clear ();
+
+        while (const auto c = this->next ()) {
+            this->m_scratch += c;
+        }
+
+        return this->m_scratch;
     }
 
-    return output;
+    const char* start = this->m_memory->cursor ();
+    const size_t remaining = this->m_memory->remaining ();
+    const auto* end = static_cast<const char*> (memchr (start, '\0', remaining));
+
+    // running out of data before the terminator fails the stream like reading past the end would
+    if (end == nullptr) {
+        this->m_memory->advance (remaining);
+        this->m_memory->setstate (std::ios::eofbit | std::ios::failbit);
+
+        return {start, remaining};
+    }
+
+    this->m_memory->advance (end - start + 1);
+
+    return {start, static_cast<size_t> (end - start)};
 }
 
-std::string BinaryReader::nextSizedString () const {
-    uint32_t length = this->nextUInt32 ();
-    std::string output (length, '\0');
+std::string_view BinaryReader::nextSizedStringView () const {
+    const uint32_t length = this->nextUInt32 ();
+
+    if (this->m_memory == nullptr) {
+        this->m_scratch.assign (length, '\0');
+        this->m_input->read (this->m_scratch.data (), length);
 
-    this->m_input->read (output.data (), length);
+        return this->m_scratch;
+    }
+
+    const char* start = this->m_memory->cursor ();
+    const size_t available = std::min<size_t> (length, this->m_memory->remaining ());
+
+    this->m_memory->advance (available);
 
-    return output;
+    if (available < length)
+        this->m_memory->setstate (std::ios::eofbit | std::ios::failbit);
+
+    return {start, available};
 }
 
 
 void BinaryReader::next (char* out, size_t size) const {
-    this->m_input->read (out, size);
+    if (this->m_memory == nullptr) {
+        this->m_input->read (out, size);
+        return;
+    }
+
+    const size_t available = std::min (size, this->m_memory->remaining ());
+
+    memcpy (out, this->m_memory->cursor (), available);
+    this->m_memory->advance (available);
+
+    // whatever is missing reads as zeroes instead of whatever was in the buffer before
+    if (available < size) {
+        memset (out + available, 0, size - available);
+        this->m_memory->setstate (std::ios::eofbit | std::ios::failbit);
+    }
 }
 
 char BinaryReader::next () const {
     char buffer;
-    this->m_input->read (&buffer, 1);
+    this->next (&buffer, 1);
     return buffer;
 }
 
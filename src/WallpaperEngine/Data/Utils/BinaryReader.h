@@ -3,11 +3,21 @@
 #include <cstdint>
 #include <iosfwd>
 #include <memory>
+#include <string>
+#include <string_view>
 
 namespace WallpaperEngine::Data::Utils {
 using ReadStream = std::istream;
 using ReadStreamSharedPtr = std::shared_ptr<ReadStream>;
 
+struct MemoryStream;
+
+/**
+ * Reads the little endian values the asset formats are made of
+ *
+ * When the stream is a MemoryStream (mapped packages and the files read off them) the values are loaded straight from
+ * its buffer, only the stream's position is updated. Any other stream goes through std::istream::read ()
+ */
 class BinaryReader {
   public:
     explicit BinaryReader (ReadStreamSharedPtr file);
@@ -17,6 +27,18 @@ class BinaryReader {
     [[nodiscard]] float nextFloat () const;
     [[nodiscard]] std::string nextNullTerminatedString () const;
     [[nodiscard]] std::string nextSizedString () const;
+    /**
+     * Same as nextNullTerminatedString () without the copy when reading from memory
+     *
+     * @return Valid until the stream goes away, or the next call when not reading from memory
+     */
+    [[nodiscard]] std::string_view nextNullTerminatedStringView () const;
+    /**
+     * Same as nextSizedString () without the copy when reading from memory
+     *
+     * @return Valid until the stream goes away, or the next call when not reading from memory
+     */
+    [[nodiscard]] std::string_view nextSizedStringView () const;
     void next(char* out, size_t size) const;
     [[nodiscard]] char next () const;
 
@@ -24,6 +46,10 @@ class BinaryReader {
 
   private:
     ReadStreamSharedPtr m_input;
+    /** the same stream when it's a MemoryStream */
+    MemoryStream* m_memory;
+    /** what the views point to when not reading from memory */
+    mutable std::string m_scratch;
 };
 
 using BinaryReaderUniquePtr = std::unique_ptr<BinaryReader>;
@@ -0,0 +1,68 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Data::Utils;
+
+MappedFile::MappedFile (const char* data, const size_t size) : m_data (data), m_size (size) {}
+
+MappedFile::~MappedFile () {
+    munmap (const_cast<char*> (this->m_data), this->m_size);
+}
+
+std::shared_ptr<const MappedFile> MappedFile::map (const std::filesystem::path& path) {
+    const int fd = ::open (path.c_str (), O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        sLog.error ("Cannot open ", path, " to map it");
+        return nullptr;
+    }
+
+    struct stat status {};
+
+    // empty files cannot be mapped, they have nothing to read anyway
+    if (fstat (fd, &status) != 0 || status.st_size <= 0) {
+        close (fd);
+        return nullptr;
+    }
+
+    const auto size = static_cast<size_t> (status.st_size);
+    void* data = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping keeps its own reference to the file
+    close (fd);
+
+    if (data == MAP_FAILED) {
+        sLog.error ("Cannot map ", path);
+        return nullptr;
+    }
+
+    return std::shared_ptr<const MappedFile> (new MappedFile (static_cast<const char*> (data), size));
+}
+
+void MappedFile::prefetch (const size_t offset, const size_t length) const {
+    if (offset >= this->m_size || length == 0)
+        return;
+
+    // madvise only takes page aligned addresses
+    static const auto page = static_cast<size_t> (sysconf (_SC_PAGESIZE));
+    const size_t start = offset - offset % page;
+    const size_t end = std::min (offset + length, this->m_size);
+
+    madvise (const_cast<char*> (this->m_data) + start, end - start, MADV_WILLNEED);
+}
+
+const char* MappedFile::data () const {
+    return this->m_data;
+}
+
+size_t MappedFile::size () const {
+    return this->m_size;
+}
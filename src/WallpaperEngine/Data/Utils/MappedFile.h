@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+namespace WallpaperEngine::Data::Utils {
+/**
+ * Read-only mapping of a whole file
+ *
+ * The pages come straight from the kernel's page cache, so every process and monitor mapping the same file
+ * shares them and nothing is read until it's touched
+ */
+class MappedFile {
+  public:
+    ~MappedFile ();
+
+    MappedFile (const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    /**
+     * @param path
+     *
+     * @return The mapping, nullptr if the file cannot be mapped
+     */
+    static std::shared_ptr<const MappedFile> map (const std::filesystem::path& path);
+
+    /**
+     * Asks the kernel to read the given range in the background, nothing is waited on
+     *
+     * @param offset
+     * @param length
+     */
+    void prefetch (size_t offset, size_t length) const;
+
+    [[nodiscard]] const char* data () const;
+    [[nodiscard]] size_t size () const;
+
+  private:
+    MappedFile (const char* data, size_t size);
+
+    const char* m_data;
+    size_t m_size;
+};
+
+using MappedFileSharedPtr = std::shared_ptr<const MappedFile>;
+} // namespace WallpaperEngine::Data::Utils
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 
 namespace WallpaperEngine::Data::Utils {
 struct MemoryStream : std::istream, private std::streambuf
@@ -16,6 +17,22 @@ struct MemoryStream : std::istream, private std::streambuf
         );
     }
 
+    /**
+     * A view over memory someone else owns, it's never written to
+     *
+     * @param data
+     * @param size
+     * @param owner Kept alive as long as the stream is
+     */
+    MemoryStream (const char* data, const size_t size, std::shared_ptr<const void> owner) :
+        std::istream (this),
+        m_owner (std::move (owner))
+    {
+        char* begin = const_cast<char*> (data);
+
+        this->setg (begin, begin, begin + size);
+    }
+
     std::streambuf::pos_type seekoff(std::streambuf::off_type off,
                      std::ios_base::seekdir dir,
                      std::ios_base::openmode which) override {
@@ -28,7 +45,39 @@ struct MemoryStream : std::istream, private std::streambuf
         return gptr() - eback();
     }
 
+    std::streambuf::pos_type seekpos (std::streambuf::pos_type pos, std::ios_base::openmode which) override {
+        return this->seekoff (pos, std::ios_base::beg, which);
+    }
+
+    /** @return The whole contents, whatever was read off the stream already */
+    [[nodiscard]] const char* data () const {
+        return this->eback ();
+    }
+
+    [[nodiscard]] size_t size () const {
+        return this->egptr () - this->eback ();
+    }
+
+    /** @return Where the next read starts */
+    [[nodiscard]] const char* cursor () const {
+        return this->gptr ();
+    }
+
+    [[nodiscard]] size_t remaining () const {
+        return this->egptr () - this->gptr ();
+    }
+
+    /**
+     * Moves the cursor as if that many bytes were read, without going through the stream
+     *
+     * @param bytes Not more than remaining ()
+     */
+    void advance (const size_t bytes) {
+        this->gbump (static_cast<int> (bytes));
+    }
+
     std::unique_ptr<char[]> m_buffer;
+    std::shared_ptr<const void> m_owner;
 };
 
 using MemoryStreamSharedPtr = std::shared_ptr<MemoryStream>;
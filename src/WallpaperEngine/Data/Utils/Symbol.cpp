@@ -0,0 +1,106 @@
+#include "Symbol.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+using namespace WallpaperEngine::Data::Utils;
+
+struct Symbol::Entry {
+    std::string name;
+    uint32_t id;
+    const Entry* upper;
+    bool renderTarget;
+};
+
+namespace {
+/**
+ * Every name interned so far, entries are never freed so symbols and the strings they hand out stay valid
+ */
+struct SymbolTable {
+    std::shared_mutex mutex;
+    std::unordered_map<std::string_view, std::unique_ptr<Symbol::Entry>> entries;
+    const Symbol::Entry* empty;
+
+    SymbolTable () {
+        this->empty = this->insert ({});
+    }
+
+    /** Adds the name, the table has to be locked for writing */
+    const Symbol::Entry* insert (const std::string_view name) {
+        if (const auto it = this->entries.find (name); it != this->entries.end ())
+            return it->second.get ();
+
+        auto entry = std::make_unique<Symbol::Entry> (Symbol::Entry {
+            .name = std::string (name),
+            .id = static_cast<uint32_t> (this->entries.size ()),
+            .upper = nullptr,
+            .renderTarget = name.starts_with ("_rt_") || name.starts_with ("_alias_"),
+        });
+
+        std::string uppercase = entry->name;
+        std::ranges::transform (uppercase, uppercase.begin (), ::toupper);
+
+        auto* result = entry.get ();
+
+        // the key points into the entry, which never moves
+        this->entries.emplace (result->name, std::move (entry));
+        result->upper = uppercase == result->name ? result : this->insert (uppercase);
+
+        return result;
+    }
+
+    static SymbolTable& get () {
+        static SymbolTable table;
+
+        return table;
+    }
+};
+} // namespace
+
+Symbol::Symbol () : m_entry (SymbolTable::get ().empty) {}
+
+Symbol::Symbol (const Entry* entry) : m_entry (entry) {}
+
+Symbol::Symbol (const std::string_view name) {
+    auto& table = SymbolTable::get ();
+
+    {
+        std::shared_lock lock (table.mutex);
+
+        if (const auto it = table.entries.find (name); it != table.entries.end ()) {
+            this->m_entry = it->second.get ();
+            return;
+        }
+    }
+
+    std::unique_lock lock (table.mutex);
+
+    this->m_entry = table.insert (name);
+}
+
+const std::string& Symbol::str () const {
+    return this->m_entry->name;
+}
+
+uint32_t Symbol::getId () const {
+    return this->m_entry->id;
+}
+
+Symbol Symbol::upper () const {
+    return Symbol (this->m_entry->upper);
+}
+
+bool Symbol::isRenderTarget () const {
+    return this->m_entry->renderTarget;
+}
+
+bool Symbol::empty () const {
+    return this->m_entry->name.empty ();
+}
+
+std::strong_ordering Symbol::operator<=> (const Symbol& other) const {
+    return this->m_entry->id <=> other.m_entry->id;
+}
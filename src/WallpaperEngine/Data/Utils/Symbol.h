@@ -0,0 +1,57 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace WallpaperEngine::Data::Utils {
+/**
+ * Interned string, every distinct name is stored once for the whole process and symbols only carry a pointer to it
+ *
+ * Comparing and hashing symbols never looks at the characters, and the things asked about names over and over
+ * (their uppercase form for combos, if they name a render target) are worked out once when the name is first seen.
+ * Interning takes a lock, so names should be turned into symbols when they're loaded and not every frame
+ */
+class Symbol {
+  public:
+    /** The empty symbol */
+    Symbol ();
+    explicit Symbol (std::string_view name);
+
+    /**
+     * @return The name, stays valid for the lifetime of the process
+     */
+    [[nodiscard]] const std::string& str () const;
+    /**
+     * @return Unique id for the name, only meaningful within the running process
+     */
+    [[nodiscard]] uint32_t getId () const;
+    /**
+     * @return The same name in uppercase, how combos are defined in the shaders
+     */
+    [[nodiscard]] Symbol upper () const;
+    /**
+     * @return If the name refers to a render target (_rt_) or an alias to one (_alias_) instead of a texture file
+     */
+    [[nodiscard]] bool isRenderTarget () const;
+    [[nodiscard]] bool empty () const;
+
+    bool operator== (const Symbol& other) const = default;
+    std::strong_ordering operator<=> (const Symbol& other) const;
+
+    struct Entry;
+
+  private:
+    explicit Symbol (const Entry* entry);
+
+    const Entry* m_entry;
+};
+} // namespace WallpaperEngine::Data::Utils
+
+template <> struct std::hash<WallpaperEngine::Data::Utils::Symbol> {
+    size_t operator() (const WallpaperEngine::Data::Utils::Symbol& symbol) const noexcept {
+        return symbol.getId ();
+    }
+};
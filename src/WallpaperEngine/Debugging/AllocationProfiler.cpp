@@ -0,0 +1,233 @@
+#include "AllocationProfiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Debugging;
+
+namespace {
+struct Site {
+    const void* address;
+    uint64_t count;
+};
+
+/** power of two so the hash can be masked, sites past it are still counted but not attributed */
+constexpr size_t MAX_SITES = 4096;
+
+thread_local bool tracking = false;
+thread_local uint64_t allocations = 0;
+// only written by the thread that's tracking, a single one (the render thread) is expected
+Site sites [MAX_SITES] = {};
+uint64_t frames = 0;
+std::chrono::steady_clock::time_point nextReport = {};
+
+void record (const void* site) {
+    allocations++;
+
+    const size_t start = (reinterpret_cast<uintptr_t> (site) >> 4) & (MAX_SITES - 1);
+
+    for (size_t i = 0; i < MAX_SITES; i++) {
+        Site& cur = sites [(start + i) & (MAX_SITES - 1)];
+
+        if (cur.address == site || cur.address == nullptr) {
+            cur.address = site;
+            cur.count++;
+            return;
+        }
+    }
+}
+
+void* allocate (size_t size, const void* site) {
+    if (tracking)
+        record (site);
+
+    return std::malloc (size == 0 ? 1 : size);
+}
+
+void* allocate (size_t size, const std::align_val_t alignment, const void* site) {
+    if (tracking)
+        record (site);
+
+    const auto align = static_cast<size_t> (alignment);
+
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return std::aligned_alloc (align, std::max (align, (size + align - 1) & ~(align - 1)));
+}
+
+std::string hex (const ptrdiff_t value) {
+    std::ostringstream stream;
+
+    stream << std::hex << value;
+
+    return stream.str ();
+}
+
+/**
+ * @return Name of the function the address is in with the offset into it, or the binary and offset into it for
+ * addr2line when the symbol isn't exported
+ */
+std::string describe (const void* address) {
+    Dl_info info = {};
+
+    if (dladdr (address, &info) == 0)
+        return "unknown";
+
+    if (info.dli_sname == nullptr)
+        return std::string (info.dli_fname) + " +0x" +
+               hex (static_cast<const char*> (address) - static_cast<const char*> (info.dli_fbase));
+
+    int status = 0;
+    char* demangled = abi::__cxa_demangle (info.dli_sname, nullptr, nullptr, &status);
+    std::string result = status == 0 && demangled != nullptr ? demangled : info.dli_sname;
+
+    std::free (demangled);
+
+    return result + " +" +
+           std::to_string (static_cast<const char*> (address) - static_cast<const char*> (info.dli_saddr));
+}
+} // namespace
+
+void* operator new (const size_t size) {
+    if (void* result = allocate (size, __builtin_return_address (0)); result != nullptr)
+        return result;
+
+    throw std::bad_alloc ();
+}
+
+void* operator new[] (const size_t size) {
+    if (void* result = allocate (size, __builtin_return_address (0)); result != nullptr)
+        return result;
+
+    throw std::bad_alloc ();
+}
+
+void* operator new (const size_t size, const std::nothrow_t&) noexcept {
+    return allocate (size, __builtin_return_address (0));
+}
+
+void* operator new[] (const size_t size, const std::nothrow_t&) noexcept {
+    return allocate (size, __builtin_return_address (0));
+}
+
+void* operator new (const size_t size, const std::align_val_t alignment) {
+    if (void* result = allocate (size, alignment, __builtin_return_address (0)); result != nullptr)
+        return result;
+
+    throw std::bad_alloc ();
+}
+
+void* operator new[] (const size_t size, const std::align_val_t alignment) {
+    if (void* result = allocate (size, alignment, __builtin_return_address (0)); result != nullptr)
+        return result;
+
+    throw std::bad_alloc ();
+}
+
+void* operator new (const size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate (size, alignment, __builtin_return_address (0));
+}
+
+void* operator new[] (const size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate (size, alignment, __builtin_return_address (0));
+}
+
+// everything above comes from malloc or aligned_alloc, so free takes all of it back
+void operator delete (void* pointer) noexcept {
+    std::free (pointer);
+}
+
+void operator delete[] (void* pointer) noexcept {
+    std::free (pointer);
+}
+
+void operator delete (void* pointer, size_t) noexcept {
+    std::free (pointer);
+}
+
+void operator delete[] (void* pointer, size_t) noexcept {
+    std::free (pointer);
+}
+
+void operator delete (void* pointer, const std::nothrow_t&) noexcept {
+    std::free (pointer);
+}
+
+void operator delete[] (void* pointer, const std::nothrow_t&) noexcept {
+    std::free (pointer);
+}
+
+void operator delete (void* pointer, std::align_val_t) noexcept {
+    std::free (pointer);
+}
+
+void operator delete[] (void* pointer, std::align_val_t) noexcept {
+    std::free (pointer);
+}
+
+void operator delete (void* pointer, size_t, std::align_val_t) noexcept {
+    std::free (pointer);
+}
+
+void operator delete[] (void* pointer, size_t, std::align_val_t) noexcept {
+    std::free (pointer);
+}
+
+void operator delete (void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free (pointer);
+}
+
+void operator delete[] (void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free (pointer);
+}
+
+void AllocationProfiler::start () {
+    std::fill (std::begin (sites), std::end (sites), Site {nullptr, 0});
+    allocations = 0;
+    frames = 0;
+    nextReport = std::chrono::steady_clock::now () + REPORT_INTERVAL;
+    tracking = true;
+}
+
+void AllocationProfiler::stop () {
+    tracking = false;
+}
+
+uint64_t AllocationProfiler::count () {
+    return allocations;
+}
+
+void AllocationProfiler::endFrame () {
+    frames++;
+
+    if (std::chrono::steady_clock::now () < nextReport)
+        return;
+
+    // logging allocates too, none of it should show up in the next report
+    tracking = false;
+    report (frames);
+    start ();
+}
+
+void AllocationProfiler::report (const uint64_t frames) {
+    std::vector<Site> used = {};
+
+    for (const auto& site : sites)
+        if (site.address != nullptr)
+            used.push_back (site);
+
+    std::ranges::sort (used, [] (const Site& a, const Site& b) { return a.count > b.count; });
+
+    sLog.out ("Allocations per frame: ", static_cast<double> (allocations) / std::max<uint64_t> (frames, 1));
+
+    for (size_t i = 0; i < used.size () && i < REPORT_SITES; i++)
+        sLog.out ("\t", static_cast<double> (used [i].count) / std::max<uint64_t> (frames, 1), " from ",
+                  describe (used [i].address));
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace WallpaperEngine::Debugging {
+/**
+ * Counts the heap allocations the render thread does, and where they come from
+ *
+ * The global operator new is replaced to count every allocation made while the calling thread is tracking, keyed by
+ * the address it was called from. Threads that aren't tracking only pay for checking a thread-local flag. The call
+ * sites are kept in a fixed table so counting never allocates itself, and they're only turned into names when
+ * reported
+ */
+class AllocationProfiler {
+  public:
+    /**
+     * Starts counting the calling thread's allocations from zero
+     */
+    static void start ();
+    /**
+     * Stops counting the calling thread's allocations, what was counted stays until the next start ()
+     */
+    static void stop ();
+    /**
+     * @return Allocations the calling thread did since start ()
+     */
+    [[nodiscard]] static uint64_t count ();
+    /**
+     * Closes the frame for the report and logs the allocations per frame and their top call sites every
+     * REPORT_INTERVAL, has to be called once per frame by the thread that started tracking
+     */
+    static void endFrame ();
+
+  private:
+    /**
+     * Logs the average allocations per frame since the last report and the call sites doing the most of them
+     */
+    static void report (uint64_t frames);
+
+    /** how often the report is logged */
+    static constexpr std::chrono::seconds REPORT_INTERVAL {5};
+    /** call sites listed in every report */
+    static constexpr int REPORT_SITES = 10;
+};
+} // namespace WallpaperEngine::Debugging
@@ -0,0 +1,168 @@
+#include "InputRecording.h"
+
+#include <algorithm>
+
+#include "WallpaperEngine/Audio/Drivers/Recorders/PlaybackRecorder.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Debugging;
+using namespace WallpaperEngine::Audio::Drivers::Recorders;
+
+namespace {
+template <typename T> void put (std::fstream& file, const T& value) {
+    file.write (reinterpret_cast<const char*> (&value), sizeof (T));
+}
+
+template <typename T> T get (std::fstream& file) {
+    T value = {};
+
+    file.read (reinterpret_cast<char*> (&value), sizeof (T));
+
+    return value;
+}
+} // namespace
+
+InputRecording::InputRecording (const std::filesystem::path& path, const uint64_t seed) :
+    m_file (path, std::ios::out | std::ios::binary | std::ios::trunc),
+    m_replaying (false),
+    m_seed (seed) {
+    if (!this->m_file.is_open ())
+        sLog.exception ("Cannot record the input to ", path);
+
+    put (this->m_file, MAGIC);
+    put (this->m_file, VERSION);
+    put (this->m_file, seed);
+
+    sLog.out ("Recording the input to ", path, " with seed ", seed);
+}
+
+InputRecording::InputRecording (const std::filesystem::path& path) :
+    m_file (path, std::ios::in | std::ios::binary),
+    m_replaying (true) {
+    if (!this->m_file.is_open ())
+        sLog.exception ("Cannot open the input recording ", path);
+
+    const auto magic = get<uint32_t> (this->m_file);
+    const auto version = get<uint32_t> (this->m_file);
+
+    if (!this->m_file || magic != MAGIC || version != VERSION)
+        sLog.exception (path, " is not an input recording made by this version");
+
+    this->m_seed = get<uint64_t> (this->m_file);
+
+    sLog.out ("Replaying the input from ", path, " with seed ", this->m_seed);
+}
+
+bool InputRecording::isReplaying () const {
+    return this->m_replaying;
+}
+
+uint64_t InputRecording::getSeed () const {
+    return this->m_seed;
+}
+
+void InputRecording::write (Frame& frame) {
+    uint8_t flags = 0;
+
+    // the spectrum eases towards silence and then stays there, most frames don't need theirs stored
+    if (frame.spectrum != this->m_spectrum) {
+        flags |= Frame_Spectrum;
+        this->m_spectrum = frame.spectrum;
+    }
+
+    if (!frame.properties.empty ())
+        flags |= Frame_Properties;
+
+    put (this->m_file, frame.time);
+    put (this->m_file, frame.daytime);
+    put (this->m_file, frame.mouse.x);
+    put (this->m_file, frame.mouse.y);
+    put (this->m_file, static_cast<uint8_t> (frame.leftClick));
+    put (this->m_file, static_cast<uint8_t> (frame.rightClick));
+    put (this->m_file, flags);
+
+    if (flags & Frame_Spectrum)
+        this->m_file.write (reinterpret_cast<const char*> (frame.spectrum.data ()), sizeof (frame.spectrum));
+
+    if (flags & Frame_Properties) {
+        put (this->m_file, static_cast<uint32_t> (frame.properties.size ()));
+
+        for (const auto& [name, value] : frame.properties) {
+            this->writeString (name);
+            this->writeString (value);
+        }
+    }
+
+    frame.properties.clear ();
+}
+
+bool InputRecording::read (Frame& frame) {
+    frame.time = get<float> (this->m_file);
+    frame.daytime = get<float> (this->m_file);
+    frame.mouse.x = get<double> (this->m_file);
+    frame.mouse.y = get<double> (this->m_file);
+    frame.leftClick = static_cast<Input::MouseClickStatus> (get<uint8_t> (this->m_file));
+    frame.rightClick = static_cast<Input::MouseClickStatus> (get<uint8_t> (this->m_file));
+
+    const auto flags = get<uint8_t> (this->m_file);
+
+    frame.hasSpectrum = flags & Frame_Spectrum;
+    frame.properties.clear ();
+
+    if (frame.hasSpectrum)
+        this->m_file.read (reinterpret_cast<char*> (frame.spectrum.data ()), sizeof (frame.spectrum));
+
+    if (flags & Frame_Properties) {
+        const auto count = get<uint32_t> (this->m_file);
+
+        for (uint32_t i = 0; i < count && this->m_file; i++) {
+            std::string name = this->readString ();
+            std::string value = this->readString ();
+
+            frame.properties.emplace_back (std::move (name), std::move (value));
+        }
+    }
+
+    // a recording cut short by a crash ends on a partial frame, that one is dropped
+    return static_cast<bool> (this->m_file);
+}
+
+void InputRecording::captureSpectrum (const PlaybackRecorder& recorder, Frame& frame) {
+    float* out = frame.spectrum.data ();
+
+    out = std::copy_n (recorder.audio16Left, 16, out);
+    out = std::copy_n (recorder.audio16Right, 16, out);
+    out = std::copy_n (recorder.audio32Left, 32, out);
+    out = std::copy_n (recorder.audio32Right, 32, out);
+    out = std::copy_n (recorder.audio64Left, 64, out);
+    std::copy_n (recorder.audio64Right, 64, out);
+}
+
+void InputRecording::applySpectrum (const Frame& frame, PlaybackRecorder& recorder) {
+    const float* in = frame.spectrum.data ();
+
+    std::copy_n (in, 16, recorder.audio16Left);
+    std::copy_n (in + 16, 16, recorder.audio16Right);
+    std::copy_n (in + 32, 32, recorder.audio32Left);
+    std::copy_n (in + 64, 32, recorder.audio32Right);
+    std::copy_n (in + 96, 64, recorder.audio64Left);
+    std::copy_n (in + 160, 64, recorder.audio64Right);
+}
+
+void InputRecording::writeString (const std::string& value) {
+    put (this->m_file, static_cast<uint32_t> (value.size ()));
+    this->m_file.write (value.data (), static_cast<std::streamsize> (value.size ()));
+}
+
+std::string InputRecording::readString () {
+    const auto size = get<uint32_t> (this->m_file);
+
+    if (!this->m_file)
+        return {};
+
+    std::string value (size, '\0');
+
+    this->m_file.read (value.data (), size);
+
+    return value;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "WallpaperEngine/Input/MouseInput.h"
+
+namespace WallpaperEngine::Audio::Drivers::Recorders {
+class PlaybackRecorder;
+}
+
+namespace WallpaperEngine::Debugging {
+/**
+ * Everything a run depends on that changes from one run to the next, written or read one frame at a time for
+ * --record-input and --replay-input
+ *
+ * The file starts with the random seed the run used and has one record per frame after it: the time, daytime,
+ * mouse and property changes of the frame, and the audio spectrum when it's not the same as the previous frame's
+ */
+class InputRecording {
+  public:
+    /** 16, 32 and 64 bands for both channels, in that order and left first */
+    static constexpr size_t SPECTRUM_VALUES = 2 * (16 + 32 + 64);
+
+    struct Frame {
+        /** g_Time and g_Daytime */
+        float time = 0.0f;
+        float daytime = 0.0f;
+        glm::dvec2 mouse = {};
+        Input::MouseClickStatus leftClick = Input::Released;
+        Input::MouseClickStatus rightClick = Input::Released;
+        /** the spectrum changed in this frame and spectrum has the new one */
+        bool hasSpectrum = false;
+        std::array<float, SPECTRUM_VALUES> spectrum = {};
+        /** property names and values applied before the frame was rendered */
+        std::vector<std::pair<std::string, std::string>> properties = {};
+    };
+
+    /**
+     * Opens a recording to write, the seed is written as the first thing in it
+     *
+     * @param path
+     * @param seed Seed the particle systems and playlists are given this run
+     */
+    InputRecording (const std::filesystem::path& path, uint64_t seed);
+    /**
+     * Opens a recording to read back
+     *
+     * @param path
+     */
+    explicit InputRecording (const std::filesystem::path& path);
+
+    /** @return If frames are read from the file instead of written to it */
+    [[nodiscard]] bool isReplaying () const;
+    /** @return The seed of the recorded run */
+    [[nodiscard]] uint64_t getSeed () const;
+
+    /**
+     * Appends a frame, the spectrum is only written when it's not the previous frame's
+     *
+     * @param frame
+     */
+    void write (Frame& frame);
+    /**
+     * Reads the next frame, the spectrum is kept from the previous one when it didn't change
+     *
+     * @param frame
+     *
+     * @return If there was a frame left
+     */
+    bool read (Frame& frame);
+
+    /** Copies the spectrum the recorder has now into the frame */
+    static void captureSpectrum (const Audio::Drivers::Recorders::PlaybackRecorder& recorder, Frame& frame);
+    /** Overwrites the recorder's spectrum with the frame's */
+    static void applySpectrum (const Frame& frame, Audio::Drivers::Recorders::PlaybackRecorder& recorder);
+
+  private:
+    static constexpr uint32_t MAGIC = 0x52495057; // WPIR
+    static constexpr uint32_t VERSION = 1;
+
+    enum FrameFlags : uint8_t {
+        Frame_Spectrum = 1 << 0,
+        Frame_Properties = 1 << 1,
+    };
+
+    void writeString (const std::string& value);
+    [[nodiscard]] std::string readString ();
+
+    std::fstream m_file;
+    bool m_replaying;
+    uint64_t m_seed = 0;
+    /** spectrum of the last frame written, frames only carry theirs when it's different */
+    std::array<float, SPECTRUM_VALUES> m_spectrum = {};
+};
+} // namespace WallpaperEngine::Debugging
@@ -0,0 +1,119 @@
+#include "LoadReport.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <iomanip>
+#include <sstream>
+
+using namespace WallpaperEngine::Debugging;
+
+namespace {
+constexpr const char* STAGE_NAMES [LoadReport::Stage_Count] = {
+    "background parse", "wallpaper setup",  "json parse",         "shader preprocess", "shader translate",
+    "shader link",      "texture read",     "texture decompress", "texture decode",    "texture upload",
+    "framebuffers",     "video init",       "web init",           "audio setup",
+};
+
+int64_t nanoseconds (const std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (time.time_since_epoch ()).count ();
+}
+} // namespace
+
+LoadReport::Scope::Scope (const Stage stage, const uint64_t bytes, const uint64_t count) :
+    m_stage (stage),
+    m_bytes (bytes),
+    m_count (count),
+    m_enabled (isEnabled ()) {
+    if (!this->m_enabled)
+        return;
+
+    this->m_start = std::chrono::steady_clock::now ();
+
+    // the wall time of the report starts with whatever started the load
+    if (stage == Stage_Background || stage == Stage_Wallpaper) {
+        int64_t none = 0;
+
+        LoadReport::get ().m_start.compare_exchange_strong (none, nanoseconds (this->m_start));
+        LoadReport::get ().m_loading++;
+    }
+}
+
+LoadReport::Scope::~Scope () {
+    if (!this->m_enabled)
+        return;
+
+    LoadReport::get ().add (
+        this->m_stage, this->m_start, std::chrono::steady_clock::now (), this->m_bytes, this->m_count);
+
+    if (this->m_stage == Stage_Background || this->m_stage == Stage_Wallpaper)
+        LoadReport::get ().m_loading--;
+}
+
+void LoadReport::Scope::addBytes (const uint64_t bytes) {
+    this->m_bytes += bytes;
+}
+
+void LoadReport::enable () {
+    sEnabled = true;
+}
+
+bool LoadReport::isEnabled () {
+    return sEnabled.load (std::memory_order_relaxed);
+}
+
+bool LoadReport::isPending () const {
+    return this->m_start.load (std::memory_order_relaxed) != 0 &&
+           this->m_loading.load (std::memory_order_relaxed) == 0;
+}
+
+void LoadReport::print (const std::string& label) {
+    const int64_t start = this->m_start.exchange (0);
+
+    if (start == 0)
+        return;
+
+    std::ostringstream out;
+
+    out << std::fixed << std::setprecision (3);
+    out << "Load report for " << label << ", ready after "
+        << static_cast<double> (nanoseconds (std::chrono::steady_clock::now ()) - start) / 1000000.0 << "ms:";
+
+    for (int stage = 0; stage < Stage_Count; stage++) {
+        auto& counter = this->m_counters [stage];
+        const int64_t time = counter.nanoseconds.exchange (0);
+        const uint64_t count = counter.count.exchange (0);
+        const uint64_t bytes = counter.bytes.exchange (0);
+
+        if (count == 0)
+            continue;
+
+        out << "\n  " << std::left << std::setw (20) << STAGE_NAMES [stage] << std::right << std::setw (10)
+            << static_cast<double> (time) / 1000000.0 << "ms " << std::setw (6) << count << "x";
+
+        if (bytes > 0)
+            out << " " << std::setw (10) << static_cast<double> (bytes) / (1024.0 * 1024.0) << "MB";
+    }
+
+    sLog.out (out.str ());
+}
+
+LoadReport& LoadReport::get () {
+    if (sInstance == nullptr) {
+        sInstance = std::make_unique<LoadReport> ();
+    }
+
+    return *sInstance;
+}
+
+void LoadReport::add (
+    const Stage stage, const std::chrono::steady_clock::time_point start,
+    const std::chrono::steady_clock::time_point end, const uint64_t bytes, const uint64_t count
+) {
+    auto& counter = this->m_counters [stage];
+
+    counter.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count ();
+    counter.count += count;
+    counter.bytes += bytes;
+}
+
+std::atomic<bool> LoadReport::sEnabled = false;
+std::unique_ptr<LoadReport> LoadReport::sInstance = nullptr;
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace WallpaperEngine::Debugging {
+/**
+ * Singleton class, adds up the time, count and bytes of every stage of loading a background for --load-report
+ *
+ * Stages are timed with Scope wherever they happen, render thread or job pool, so their times are CPU time summed over
+ * the threads and can add up to more than the wall time. The background and wallpaper stages include whatever of the
+ * others ran while they did. Once the backgrounds are ready everything since the last report is logged and the
+ * counts start over
+ */
+class LoadReport {
+  public:
+    enum Stage {
+        /** project.json and the model tree built from it, see WallpaperApplication::loadBackground */
+        Stage_Background = 0,
+        /** the render side of the background: scene objects, video or browser, see CWallpaper::fromWallpaper */
+        Stage_Wallpaper,
+        /** JSON documents parsed, project, scene, materials, models and effects */
+        Stage_Json,
+        /** shader sources read, includes and combos resolved, see CPass::prepareShaders */
+        Stage_ShaderPreprocess,
+        /** glslang and SPIRV-Cross, only when the driver refused the sources or there's no cached translation */
+        Stage_ShaderTranslate,
+        /** GL compiles and links, or the binaries loaded from the ShaderCache */
+        Stage_ShaderLink,
+        /** .tex files read from their containers and their headers parsed */
+        Stage_TextureRead,
+        /** LZ4 blocks of the mipmaps */
+        Stage_TextureDecompress,
+        /** PNGs and JPEGs embedded in textures */
+        Stage_TextureDecode,
+        /** mipmaps handed to GL */
+        Stage_TextureUpload,
+        /** framebuffers created for effects and the scene */
+        Stage_Framebuffers,
+        /** mpv context and its GL side */
+        Stage_Video,
+        /** browser created for web backgrounds */
+        Stage_Web,
+        /** sounds opened, and decoded when they are short enough to keep in memory */
+        Stage_Audio,
+        Stage_Count
+    };
+
+    /**
+     * Adds the time between its construction and destruction to the stage, does nothing unless the report is enabled
+     */
+    class Scope {
+      public:
+        /**
+         * @param stage
+         * @param bytes What the stage went through, if it's known up front
+         * @param count What it's done for, for stages timed in batches
+         */
+        explicit Scope (Stage stage, uint64_t bytes = 0, uint64_t count = 1);
+        ~Scope ();
+
+        Scope (const Scope&) = delete;
+        Scope& operator= (const Scope&) = delete;
+
+        /** @param bytes More bytes the stage went through, for when they are only known once it's done */
+        void addBytes (uint64_t bytes);
+
+      private:
+        Stage m_stage;
+        uint64_t m_bytes;
+        uint64_t m_count;
+        bool m_enabled;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /** Starts counting, has to happen before any thread loads anything */
+    void enable ();
+    /** @return If the stages are counted, checked without the instance so scopes on any thread cost nothing otherwise */
+    [[nodiscard]] static bool isEnabled ();
+    /**
+     * @return If a background or wallpaper was loaded since the last report, and none is still loading
+     */
+    [[nodiscard]] bool isPending () const;
+    /**
+     * Logs the counts since the last report and starts over
+     *
+     * @param label The backgrounds the report is for
+     */
+    void print (const std::string& label);
+
+    static LoadReport& get ();
+
+  private:
+    struct Counter {
+        std::atomic<int64_t> nanoseconds = 0;
+        std::atomic<uint64_t> count = 0;
+        std::atomic<uint64_t> bytes = 0;
+    };
+
+    void add (Stage stage, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end,
+              uint64_t bytes, uint64_t count);
+
+    static std::atomic<bool> sEnabled;
+    /** when the first background or wallpaper since the last report started loading, 0 if none did */
+    std::atomic<int64_t> m_start = 0;
+    /** backgrounds and wallpapers loading right now */
+    std::atomic<int> m_loading = 0;
+    std::array<Counter, Stage_Count> m_counters = {};
+    static std::unique_ptr<LoadReport> sInstance;
+};
+} // namespace WallpaperEngine::Debugging
+
+#define sLoadReport (WallpaperEngine::Debugging::LoadReport::get ())
@@ -0,0 +1,182 @@
+#include "Tracer.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <algorithm>
+#include <fstream>
+
+using namespace WallpaperEngine::Debugging;
+
+Tracer::Zone::Zone (const char* name) :
+    m_name (name),
+    m_start (std::chrono::steady_clock::now ()) {}
+
+Tracer::Zone::~Zone () {
+    auto& tracer = Tracer::get ();
+
+    if (tracer.isRecording ())
+        tracer.record (this->m_name, this->m_start, std::chrono::steady_clock::now ());
+}
+
+void Tracer::start (const std::filesystem::path& path) {
+    std::lock_guard lock (this->m_mutex);
+
+    this->m_path = path;
+    this->m_events.clear ();
+    this->m_dropped = 0;
+    this->m_recording = true;
+
+    sLog.out ("Tracing to ", path);
+}
+
+void Tracer::stop () {
+    if (!this->m_recording.exchange (false))
+        return;
+
+    std::lock_guard lock (this->m_mutex);
+    std::ofstream out (this->m_path);
+
+    if (!out.is_open ()) {
+        sLog.error ("Cannot write trace to ", this->m_path);
+        return;
+    }
+
+    write (out, this->m_events, "");
+
+    sLog.out ("Trace written to ", this->m_path, " with ", this->m_events.size (), " zones");
+
+    if (this->m_dropped > 0)
+        sLog.error ("The trace was full, ", this->m_dropped, " zones were dropped");
+
+    this->m_events.clear ();
+    this->m_events.shrink_to_fit ();
+}
+
+void Tracer::startRing (const std::chrono::milliseconds window) {
+    std::lock_guard lock (this->m_mutex);
+
+    this->m_ringWindow = window;
+    this->m_ring.clear ();
+    this->m_ring.reserve (RING_EVENTS);
+    this->m_ringNext = 0;
+    this->m_ringing = true;
+}
+
+bool Tracer::dumpRing (
+    const std::filesystem::path& path, const std::chrono::steady_clock::time_point end, const std::string& label
+) {
+    std::vector<Event> events;
+
+    {
+        std::lock_guard lock (this->m_mutex);
+
+        const int64_t to = std::chrono::duration_cast<std::chrono::microseconds> (end - this->m_origin).count ();
+        const int64_t from = to - std::chrono::duration_cast<std::chrono::microseconds> (this->m_ringWindow).count ();
+
+        // copy out what's needed first so the zones recorded meanwhile don't wait on the file
+        for (const auto& event : this->m_ring)
+            if (event.start <= to && event.start + event.duration >= from)
+                events.push_back (event);
+    }
+
+    std::ranges::sort (events, {}, &Event::start);
+
+    std::ofstream out (path);
+
+    if (!out.is_open ()) {
+        sLog.error ("Cannot write trace to ", path);
+        return false;
+    }
+
+    write (out, events, label);
+
+    return out.good ();
+}
+
+bool Tracer::isRecording () const {
+    return this->m_recording.load (std::memory_order_relaxed) || this->m_ringing.load (std::memory_order_relaxed);
+}
+
+Tracer& Tracer::get () {
+    if (sInstance == nullptr) {
+        sInstance = std::make_unique<Tracer> ();
+    }
+
+    return *sInstance;
+}
+
+void Tracer::record (
+    const char* name, const std::chrono::steady_clock::time_point start, const std::chrono::steady_clock::time_point end
+) {
+    const uint32_t thread = getThreadId ();
+    std::lock_guard lock (this->m_mutex);
+
+    const Event event = {
+        .name = name,
+        .thread = thread,
+        .start = std::chrono::duration_cast<std::chrono::microseconds> (start - this->m_origin).count (),
+        .duration = std::chrono::duration_cast<std::chrono::microseconds> (end - start).count (),
+    };
+
+    if (this->m_ringing) {
+        if (this->m_ring.size () < RING_EVENTS)
+            this->m_ring.push_back (event);
+        else
+            this->m_ring [this->m_ringNext] = event;
+
+        this->m_ringNext = (this->m_ringNext + 1) % RING_EVENTS;
+    }
+
+    if (!this->m_recording)
+        return;
+
+    if (this->m_events.size () >= MAX_EVENTS) {
+        this->m_dropped++;
+        return;
+    }
+
+    this->m_events.push_back (event);
+}
+
+void Tracer::write (std::ostream& out, const std::vector<Event>& events, const std::string& label) {
+    out << "{\"displayTimeUnit\":\"ms\",";
+
+    if (!label.empty ()) {
+        out << "\"otherData\":{\"wallpaper\":\"";
+
+        // unlike the zone names this comes from the wallpapers, so quotes and control characters have to be escaped
+        for (const char c : label) {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char> (c) < 0x20)
+                out << ' ';
+            else
+                out << c;
+        }
+
+        out << "\"},";
+    }
+
+    out << "\"traceEvents\":[";
+
+    for (size_t i = 0; i < events.size (); i++) {
+        const auto& [name, thread, start, duration] = events [i];
+
+        if (i > 0)
+            out << ',';
+
+        // the names are literals from the code, nothing in them needs escaping
+        out << "\n{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << ",\"ts\":" << start
+            << ",\"dur\":" << duration << '}';
+    }
+
+    out << "\n]}\n";
+}
+
+uint32_t Tracer::getThreadId () {
+    static std::atomic<uint32_t> next = 1;
+    thread_local const uint32_t id = next++;
+
+    return id;
+}
+
+std::unique_ptr<Tracer> Tracer::sInstance = nullptr;
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace WallpaperEngine::Debugging {
+/**
+ * Singleton class, records how long the zones of the app take on every thread
+ *
+ * Zones are opened with TRACE_SCOPE and recorded once they close, when the tracer stops everything recorded is
+ * written as a Chrome trace-event file that chrome://tracing or ui.perfetto.dev can open. The macros are only compiled
+ * in with TRACING=1, otherwise they're empty and cost nothing
+ *
+ * Independently of that the zones can be kept in a fixed-size ring that only holds the last few seconds, so the moments
+ * around a hitch can be written out after it happened without recording the whole run
+ */
+class Tracer {
+  public:
+    /**
+     * Records the time between its construction and destruction as a zone of the calling thread
+     */
+    class Zone {
+      public:
+        /**
+         * @param name Name the zone is shown with, it has to outlive the tracer (a string literal)
+         */
+        explicit Zone (const char* name);
+        ~Zone ();
+
+        Zone (const Zone&) = delete;
+        Zone& operator= (const Zone&) = delete;
+
+      private:
+        const char* m_name;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /**
+     * Starts recording the zones
+     *
+     * @param path Where the trace is written to when stopping
+     */
+    void start (const std::filesystem::path& path);
+    /**
+     * Stops recording and writes the trace, does nothing if it wasn't started
+     */
+    void stop ();
+    /**
+     * Starts keeping the zones of the last seconds in the ring, older ones are overwritten
+     *
+     * @param window How far back the ring has to reach
+     */
+    void startRing (std::chrono::milliseconds window);
+    /**
+     * Writes the zones in the ring that overlap the given window as a trace file
+     *
+     * @param path Where to write the trace to
+     * @param end The end of the window, it reaches as far back as the one given to startRing
+     * @param label Written into the trace's metadata so it can be told which wallpapers were running
+     *
+     * @return If the file could be written
+     */
+    bool dumpRing (const std::filesystem::path& path, std::chrono::steady_clock::time_point end,
+                   const std::string& label);
+    /** @return If zones are kept at all, either by start or startRing */
+    [[nodiscard]] bool isRecording () const;
+
+    static Tracer& get ();
+
+  private:
+    /** zones kept at most so long runs don't use up the memory, anything after that is dropped */
+    static constexpr size_t MAX_EVENTS = 2000000;
+    /** zones the ring holds, enough for a few seconds of a busy scene at high frame rates */
+    static constexpr size_t RING_EVENTS = 1 << 16;
+
+    struct Event {
+        const char* name;
+        uint32_t thread;
+        /** microseconds since the tracer started */
+        int64_t start;
+        int64_t duration;
+    };
+
+    void record (const char* name, std::chrono::steady_clock::time_point start,
+                 std::chrono::steady_clock::time_point end);
+    /** @return A small id for the calling thread, threads are numbered in the order they record their first zone */
+    static uint32_t getThreadId ();
+
+    /** writes the events to the stream as a Chrome trace-event file */
+    static void write (std::ostream& out, const std::vector<Event>& events, const std::string& label);
+
+    std::atomic<bool> m_recording = false;
+    std::atomic<bool> m_ringing = false;
+    std::filesystem::path m_path = {};
+    /** shared by the full trace and the ring so zones from both line up */
+    std::chrono::steady_clock::time_point m_origin = std::chrono::steady_clock::now ();
+    std::mutex m_mutex = {};
+    std::vector<Event> m_events = {};
+    size_t m_dropped = 0;
+    std::chrono::milliseconds m_ringWindow = {};
+    std::vector<Event> m_ring = {};
+    /** where the next zone goes in the ring, it wraps around once the ring is full */
+    size_t m_ringNext = 0;
+    static std::unique_ptr<Tracer> sInstance;
+};
+} // namespace WallpaperEngine::Debugging
+
+#define sTracer (WallpaperEngine::Debugging::Tracer::get ())
+
+#if TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER (a, b)
+#define TRACE_SCOPE(name) const WallpaperEngine::Debugging::Tracer::Zone TRACE_CONCAT (traceZone, __LINE__) (name)
+#else
+#define TRACE_SCOPE(name)
+#endif /* TRACING */
@@ -1,14 +1,71 @@
+#include <cerrno>
 #include <filesystem>
-#include <fstream>
 #include <memory>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "Directory.h"
 
 #include "WallpaperEngine/Assets/AssetLoadException.h"
+#include "WallpaperEngine/Data/Utils/MappedFile.h"
+#include "WallpaperEngine/Data/Utils/MemoryStream.h"
 
 using namespace WallpaperEngine::FileSystem;
 using namespace WallpaperEngine::FileSystem::Adapters;
 
+namespace {
+/**
+ * Reads the whole file with positioned reads on its own descriptor, so threads opening files at the same time
+ * share no state at all
+ */
+ReadStreamSharedPtr readFile (const std::filesystem::path& finalpath, const std::filesystem::path& path) {
+    const int fd = ::open (finalpath.c_str (), O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        throw std::filesystem::filesystem_error (
+            "Cannot open file", path, std::error_code (errno, std::generic_category ()));
+    }
+
+    struct stat status {};
+
+    if (fstat (fd, &status) != 0) {
+        const int error = errno;
+
+        close (fd);
+        throw std::filesystem::filesystem_error (
+            "Cannot stat file", path, std::error_code (error, std::generic_category ()));
+    }
+
+    const auto size = static_cast<size_t> (status.st_size);
+    auto buffer = std::make_unique <char[]> (size);
+    size_t done = 0;
+
+    while (done < size) {
+        const ssize_t count = pread (fd, buffer.get () + done, size - done, static_cast<off_t> (done));
+
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            break;
+
+        done += static_cast<size_t> (count);
+    }
+
+    const int error = errno;
+
+    close (fd);
+
+    if (done != size) {
+        throw std::filesystem::filesystem_error (
+            "Cannot read file", path, std::error_code (error, std::generic_category ()));
+    }
+
+    return std::make_shared <MemoryStream> (std::move (buffer), size);
+}
+} // namespace
+
 ReadStreamSharedPtr DirectoryAdapter::open (const std::filesystem::path& path) const {
     auto finalpath = std::filesystem::canonical(this->basepath / path);
 
@@ -26,7 +83,13 @@ ReadStreamSharedPtr DirectoryAdapter::open (const std::filesystem::path& path) c
         throw std::filesystem::filesystem_error ("Expected file but found a directory", path, std::error_code ());
     }
 
-    return std::make_shared <std::ifstream> (finalpath);
+    // the mapping is owned by the stream, it goes away with the last reader
+    if (this->mapFiles) {
+        if (const auto mapping = MappedFile::map (finalpath); mapping != nullptr)
+            return std::make_shared <MemoryStream> (mapping->data (), mapping->size (), mapping);
+    }
+
+    return readFile (finalpath, path);
 }
 
 bool DirectoryAdapter::exists (const std::filesystem::path& path) const {
@@ -63,6 +126,22 @@ std::filesystem::path DirectoryAdapter::physicalPath (const std::filesystem::pat
     return finalpath;
 }
 
+void DirectoryAdapter::prefetch (const std::filesystem::path& path) const {
+    std::error_code ec;
+    const auto finalpath = std::filesystem::canonical (this->basepath / path, ec);
+
+    if (ec || finalpath.string ().find (this->basepath.string ()) != 0)
+        return;
+
+    const int fd = ::open (finalpath.c_str (), O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1)
+        return;
+
+    // the readahead goes on after the descriptor is closed
+    posix_fadvise (fd, 0, 0, POSIX_FADV_WILLNEED);
+    close (fd);
+}
 
 bool DirectoryFactory::handlesMountpoint (const std::filesystem::path& path) const {
     const auto finalpath = std::filesystem::canonical (path);
@@ -19,7 +19,10 @@ struct DirectoryAdapter final : Adapter {
     [[nodiscard]] ReadStreamSharedPtr open (const std::filesystem::path& path) const override;
     [[nodiscard]] bool exists (const std::filesystem::path& path) const override;
     [[nodiscard]] std::filesystem::path physicalPath (const std::filesystem::path& path) const override;
+    void prefetch (const std::filesystem::path& path) const override;
 
     const std::filesystem::path basepath;
+    /** open () maps the files instead of reading them, the pages are shared with every process mapping them */
+    bool mapFiles = false;
 };
 }
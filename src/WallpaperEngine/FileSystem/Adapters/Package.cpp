@@ -1,5 +1,6 @@
 #include <memory>
 #include <fstream>
+#include <vector>
 
 #include "Package.h"
 
@@ -8,40 +9,164 @@
 #include "WallpaperEngine/Data/Utils/BinaryReader.h"
 #include "WallpaperEngine/Data/Utils/MemoryStream.h"
 
-#include <algorithm>
-
 using namespace WallpaperEngine::FileSystem;
 using namespace WallpaperEngine::FileSystem::Adapters;
 
 ReadStreamSharedPtr PackageAdapter::open (const std::filesystem::path& path) const {
-    // find the file entry
-    const auto it = std::ranges::find_if (this->package->files, [&path] (const auto& file) {
-        return file->filename == path.string ();
-    });
+    const auto it = this->package->index.find (Data::Parsers::PackageParser::normalize (path));
 
-    if (it == this->package->files.end ()) {
+    if (it == this->package->index.end ()) {
         throw std::filesystem::filesystem_error ("Cannot find file", path, std::error_code ());
     }
 
+    const FileEntry& entry = *it->second;
+    const uint64_t offset = static_cast<uint64_t> (entry.offset) + this->package->baseOffset;
+
+    {
+        std::scoped_lock lock (this->accessLock);
+
+        if (this->accessed.insert (&entry).second)
+            this->accessOrder.push_back (&entry);
+    }
+
+    if (this->mapping != nullptr) {
+        if (offset + entry.length > this->mapping->size ())
+            throw std::filesystem::filesystem_error ("File goes past the end of the package", path, std::error_code ());
+
+        // the stream keeps the mapping alive, even past the adapter
+        return std::make_shared <MemoryStream> (this->mapping->data () + offset, entry.length, this->mapping);
+    }
+
     // read file into memory
-    auto buffer = std::make_unique <char[]> (it->get ()->length);
+    auto buffer = std::make_unique <char[]> (entry.length);
 
     // go to the file's position and read into the buffer
-    this->package->file->base ().seekg (it->get ()->offset + this->package->baseOffset, std::ios::beg);
-    this->package->file->next (buffer.get (), it->get ()->length);
+    {
+        std::scoped_lock lock (this->streamLock);
+
+        this->package->file->base ().seekg (offset, std::ios::beg);
+        this->package->file->next (buffer.get (), entry.length);
+    }
 
     // create a memory stream and return that
-    return std::make_shared <MemoryStream> (std::move (buffer), it->get ()->length);
+    return std::make_shared <MemoryStream> (std::move (buffer), entry.length);
 }
 
 bool PackageAdapter::exists (const std::filesystem::path& path) const {
-    for (const auto& file : this->package->files) {
-        if (file->filename == path.string ()) {
-            return true;
+    return this->package->index.contains (Data::Parsers::PackageParser::normalize (path));
+}
+
+void PackageAdapter::prefetch (const std::filesystem::path& path) const {
+    // unmapped packages read the whole file on open anyway
+    if (this->mapping == nullptr)
+        return;
+
+    const auto it = this->package->index.find (Data::Parsers::PackageParser::normalize (path));
+
+    if (it == this->package->index.end ())
+        return;
+
+    this->mapping->prefetch (static_cast<size_t> (it->second->offset) + this->package->baseOffset, it->second->length);
+}
+
+void PackageAdapter::repack (const std::filesystem::path& destination) const {
+    constexpr uint32_t PAGE_SIZE = 4096;
+
+    std::vector<const FileEntry*> order;
+
+    {
+        std::scoped_lock lock (this->accessLock);
+
+        order = this->accessOrder;
+
+        for (const auto& entry : this->package->files)
+            if (!this->accessed.contains (entry.get ()))
+                order.push_back (entry.get ());
+    }
+
+    const auto writeUInt32 = [] (std::ostream& out, const uint32_t value) {
+        out.write (reinterpret_cast<const char*> (&value), sizeof (value));
+    };
+
+    // the header's size decides where the first file starts, so it's sized before anything is written
+    uint64_t headerSize = sizeof (uint32_t) + this->package->header.size () + sizeof (uint32_t);
+
+    for (const auto* entry : order)
+        headerSize += sizeof (uint32_t) + entry->filename.size () + sizeof (uint32_t) * 2;
+
+    std::vector<uint32_t> offsets;
+    uint64_t end = headerSize;
+
+    offsets.reserve (order.size ());
+
+    for (const auto* entry : order) {
+        end = (end + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+
+        // offsets are stored from the end of the header
+        if (end - headerSize > UINT32_MAX)
+            throw std::filesystem::filesystem_error ("Repacked package is too big", destination, std::error_code ());
+
+        offsets.push_back (static_cast<uint32_t> (end - headerSize));
+        end += entry->length;
+    }
+
+    auto temporary = destination;
+
+    temporary += ".repack";
+
+    {
+        std::ofstream out (temporary, std::ios::binary | std::ios::trunc);
+
+        if (!out.is_open ())
+            throw std::filesystem::filesystem_error ("Cannot write repacked package", temporary, std::error_code ());
+
+        writeUInt32 (out, static_cast<uint32_t> (this->package->header.size ()));
+        out.write (this->package->header.data (), static_cast<std::streamsize> (this->package->header.size ()));
+        writeUInt32 (out, static_cast<uint32_t> (order.size ()));
+
+        for (size_t index = 0; index < order.size (); index++) {
+            writeUInt32 (out, static_cast<uint32_t> (order [index]->filename.size ()));
+            out.write (order [index]->filename.data (), static_cast<std::streamsize> (order [index]->filename.size ()));
+            writeUInt32 (out, offsets [index]);
+            writeUInt32 (out, order [index]->length);
         }
+
+        std::vector<char> buffer;
+
+        for (size_t index = 0; index < order.size (); index++) {
+            const auto* entry = order [index];
+            const uint64_t offset = static_cast<uint64_t> (entry->offset) + this->package->baseOffset;
+            const std::vector<char> padding (headerSize + offsets [index] - static_cast<uint64_t> (out.tellp ()), 0);
+
+            out.write (padding.data (), static_cast<std::streamsize> (padding.size ()));
+
+            if (this->mapping != nullptr) {
+                if (offset + entry->length > this->mapping->size ())
+                    throw std::filesystem::filesystem_error (
+                        "File goes past the end of the package", entry->filename, std::error_code ());
+
+                out.write (this->mapping->data () + offset, entry->length);
+                continue;
+            }
+
+            buffer.resize (entry->length);
+
+            {
+                std::scoped_lock lock (this->streamLock);
+
+                this->package->file->base ().seekg (static_cast<std::streamoff> (offset), std::ios::beg);
+                this->package->file->next (buffer.data (), entry->length);
+            }
+
+            out.write (buffer.data (), entry->length);
+        }
+
+        if (!out.good ())
+            throw std::filesystem::filesystem_error ("Cannot write repacked package", temporary, std::error_code ());
     }
 
-    return false;
+    // the mapping keeps the old contents, so the package stays readable while it's replaced
+    std::filesystem::rename (temporary, destination);
 }
 
 std::filesystem::path PackageAdapter::physicalPath (const std::filesystem::path& path) const {
@@ -56,6 +181,14 @@ bool PackageFactory::handlesMountpoint (const std::filesystem::path& path) const
 }
 
 AdapterSharedPtr PackageFactory::create (const std::filesystem::path& path) const {
+    // the header is parsed off the mapping too, so the file is only opened once
+    if (auto mapping = MappedFile::map (path); mapping != nullptr) {
+        const auto stream = std::make_shared <MemoryStream> (mapping->data (), mapping->size (), mapping);
+        auto package = Data::Parsers::PackageParser::parse (stream);
+
+        return std::make_unique <PackageAdapter> (std::move (package), std::move (mapping));
+    }
+
     const auto stream = std::make_shared <std::ifstream> (path, std::ios::binary);
     auto package = Data::Parsers::PackageParser::parse (stream);
 
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <filesystem>
+#include <mutex>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "Types.h"
 #include "WallpaperEngine/Data/Assets/Types.h"
 #include "WallpaperEngine/Data/Assets/Package.h"
+#include "WallpaperEngine/Data/Utils/MappedFile.h"
 
 namespace WallpaperEngine::FileSystem::Adapters {
 using namespace WallpaperEngine::Data::Assets;
@@ -17,13 +21,37 @@ struct PackageFactory final : Factory {
     [[nodiscard]] AdapterSharedPtr create (const std::filesystem::path& path) const override;
 };
 
+/**
+ * Files inside a scene.pkg, when the package can be mapped the streams are views into the mapping and nothing
+ * is copied, otherwise every file is read into memory as it's opened
+ *
+ * The order files are first opened in is kept, so repack () can lay the package out the way it's read
+ */
 struct PackageAdapter final : Adapter {
-    explicit PackageAdapter (PackageUniquePtr package) : package (std::move(package)) {};
+    explicit PackageAdapter (PackageUniquePtr package, MappedFileSharedPtr mapping = nullptr) :
+        package (std::move(package)), mapping (std::move (mapping)) {};
 
     [[nodiscard]] ReadStreamSharedPtr open (const std::filesystem::path& path) const override;
     [[nodiscard]] bool exists (const std::filesystem::path& path) const override;
     [[nodiscard]] std::filesystem::path physicalPath (const std::filesystem::path& path) const override;
+    void prefetch (const std::filesystem::path& path) const override;
+
+    /**
+     * Writes the package again with the files in the order they were opened so far, the ones never opened after
+     * them. Every file starts at a page, so a load reads the package front to back and its prefetches don't
+     * overlap
+     *
+     * @param destination Written to a temporary file first and renamed over, so it can be the package itself
+     */
+    void repack (const std::filesystem::path& destination) const;
 
     PackageUniquePtr package;
+    MappedFileSharedPtr mapping;
+    /** the package's stream is shared when the package couldn't be mapped */
+    mutable std::mutex streamLock;
+    /** files in the order they were first opened */
+    mutable std::vector<const FileEntry*> accessOrder;
+    mutable std::unordered_set<const FileEntry*> accessed;
+    mutable std::mutex accessLock;
 };
 }
\ No newline at end of file
@@ -12,6 +12,13 @@ struct Adapter {
     [[nodiscard]] virtual ReadStreamSharedPtr open (const std::filesystem::path& path) const = 0;
     [[nodiscard]] virtual bool exists (const std::filesystem::path& path) const = 0;
     [[nodiscard]] virtual std::filesystem::path physicalPath (const std::filesystem::path& path) const = 0;
+    /**
+     * Asks the kernel to start reading the file in the background so a later open () doesn't wait on the disk,
+     * adapters that keep their files in memory do nothing
+     *
+     * @param path
+     */
+    virtual void prefetch (const std::filesystem::path& path) const {}
 };
 
 using AdapterSharedPtr = std::shared_ptr<Adapter>;
@@ -14,7 +14,8 @@ ReadStreamSharedPtr VirtualAdapter::open (const std::filesystem::path& path) con
         throw std::filesystem::filesystem_error ("Cannot find file", path, std::error_code ());
     }
 
-    return file->second;
+    // every caller gets its own position in the contents
+    return std::make_shared <MemoryStream> (file->second->data (), file->second->size (), file->second);
 }
 
 bool VirtualAdapter::exists (const std::filesystem::path& path) const {
@@ -47,6 +48,7 @@ void VirtualAdapter::add (const std::filesystem::path& path, const std::string&
 
 void VirtualAdapter::add (const std::filesystem::path& path, MemoryStreamSharedPtr stream) {
     this->files.insert_or_assign (path, stream);
+    this->generation++;
 }
 
 bool VirtualFactory::handlesMountpoint (const std::filesystem::path& path) const {
@@ -28,5 +28,7 @@ struct VirtualAdapter final : Adapter {
     void add (const std::filesystem::path& path, MemoryStreamSharedPtr stream);
 
     std::map <std::filesystem::path, MemoryStreamSharedPtr> files;
+    /** bumped every time a file is added, so lookups cached elsewhere know they might be stale */
+    uint64_t generation = 0;
 };
 }
\ No newline at end of file
@@ -48,12 +48,21 @@ std::string Container::readString (const std::filesystem::path& path) const {
     return buffer.str ();
 }
 
+bool Container::exists (const std::filesystem::path& path) const {
+    return this->findAdapterForFile (path) != nullptr;
+}
+
 std::filesystem::path Container::physicalPath (const std::filesystem::path& path) const {
     const auto normalized = normalize_path (path);
 
     return this->resolveAdapterForFile (path).physicalPath (normalized);
 }
 
+void Container::prefetch (const std::filesystem::path& path) const {
+    if (const auto adapter = this->findAdapterForFile (path); adapter != nullptr)
+        adapter->prefetch (normalize_path (path));
+}
+
 AdapterSharedPtr Container::mount (const std::filesystem::path& path, const std::filesystem::path& mountPoint) {
     // check if any adapter can handle the path
     for (const auto& factory : this->m_factories) {
@@ -61,7 +70,13 @@ AdapterSharedPtr Container::mount (const std::filesystem::path& path, const std:
             continue;
         }
 
-        return this->m_mountpoints.emplace_back (mountPoint, factory->create (path)).second;
+        auto& adapter = this->m_mountpoints.emplace_back (mountPoint, factory->create (path)).second;
+
+        // files might be found somewhere else now
+        std::scoped_lock lock (this->m_resolvedMutex);
+        this->m_resolved.clear ();
+
+        return adapter;
     }
 
     throw std::filesystem::filesystem_error (
@@ -73,8 +88,38 @@ VirtualAdapter& Container::getVFS () const {
 }
 
 Adapter& Container::resolveAdapterForFile (const std::filesystem::path& path) const {
+    if (const auto adapter = this->findAdapterForFile (path); adapter != nullptr)
+        return *adapter;
+
+    throw std::filesystem::filesystem_error ("Cannot find requested file in any of the mountpoints", path, std::error_code ());
+}
+
+Adapter* Container::findAdapterForFile (const std::filesystem::path& path) const {
     const auto normalized = normalize_path (path);
+    const auto key = normalized.string ();
 
+    {
+        std::scoped_lock lock (this->m_resolvedMutex);
+
+        if (this->m_resolvedGeneration != this->m_vfs->generation) {
+            this->m_resolved.clear ();
+            this->m_resolvedGeneration = this->m_vfs->generation;
+        }
+
+        if (const auto it = this->m_resolved.find (key); it != this->m_resolved.end ())
+            return it->second;
+    }
+
+    // the search itself is done unlocked, two threads finding the same file get the same answer anyway
+    Adapter* adapter = this->searchAdapterForFile (normalized);
+
+    std::scoped_lock lock (this->m_resolvedMutex);
+    this->m_resolved.emplace (key, adapter);
+
+    return adapter;
+}
+
+Adapter* Container::searchAdapterForFile (const std::filesystem::path& normalized) const {
     for (const auto& [root, adapter] : this->m_mountpoints) {
         if (normalized.string().starts_with (root.string()) == false) {
             continue;
@@ -85,13 +130,13 @@ Adapter& Container::resolveAdapterForFile (const std::filesystem::path& path) co
             continue;
         }
 
-        return *adapter;
+        return adapter.get ();
     }
 
     if (normalized.string().starts_with ("/") == false) {
         // try resolving as absolute, just in case it's relative to the root
-        return this->resolveAdapterForFile ("/" + normalized.string());
+        return this->searchAdapterForFile ("/" + normalized.string());
     }
 
-    throw std::filesystem::filesystem_error ("Cannot find requested file in any of the mountpoints", path, std::error_code ());
+    return nullptr;
 }
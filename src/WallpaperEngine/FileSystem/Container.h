@@ -5,11 +5,21 @@
 
 #include "WallpaperEngine/Data/Utils/BinaryReader.h"
 #include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 namespace WallpaperEngine::FileSystem {
 using namespace WallpaperEngine::Data::Utils;
 using namespace WallpaperEngine::FileSystem::Adapters;
 
+/**
+ * Virtual file system made of every mounted adapter
+ *
+ * Once everything is mounted, read (), readString (), exists () and physicalPath () can be called from any
+ * thread at the same time, every stream returned is independent of the others. Mounting or adding files to the
+ * VFS has to happen before that
+ */
 class Container {
   public:
     Container ();
@@ -31,6 +41,12 @@ class Container {
      */
     [[nodiscard]] std::string readString (const std::filesystem::path& path) const;
 
+    /**
+     * @param path The file to look for
+     * @return If any of the mountpoints has the file, without throwing when it doesn't
+     */
+    [[nodiscard]] bool exists (const std::filesystem::path& path) const;
+
     /**
      * Tries to resolve the given file into an absolute, real, filesystem path
      * to be used as info for other tools that might require it (like MPV)
@@ -40,6 +56,13 @@ class Container {
      */
     [[nodiscard]] std::filesystem::path physicalPath (const std::filesystem::path& path) const;
 
+    /**
+     * Starts reading the given file in the background if any mountpoint has it, without throwing when none does
+     *
+     * @param path The file that is going to be read soon
+     */
+    void prefetch (const std::filesystem::path& path) const;
+
     /**
      *
      * @param path Base of the mountpoint
@@ -60,12 +83,29 @@ class Container {
      * @return The adapter handling the file
      */
     Adapter& resolveAdapterForFile (const std::filesystem::path& path) const;
+    /**
+     * @param path The path to the file
+     * @return The adapter handling the file, nullptr if there's none
+     */
+    Adapter* findAdapterForFile (const std::filesystem::path& path) const;
+    /**
+     * Walks the mountpoints for the adapter handling the file, findAdapterForFile () keeps the answers
+     *
+     * @param normalized The path to the file, already normalized
+     * @return The adapter handling the file, nullptr if there's none
+     */
+    Adapter* searchAdapterForFile (const std::filesystem::path& normalized) const;
     /** The factories available for this container */
     std::vector<FactoryUniquePtr> m_factories;
     /** Mountpoints on this container */
     std::vector<std::pair<std::filesystem::path, AdapterSharedPtr>> m_mountpoints;
     /** Virtual file system adapter */
     std::shared_ptr<VirtualAdapter> m_vfs;
+    /** adapter every path looked up so far resolved to, nullptr for the ones no mountpoint has */
+    mutable std::unordered_map<std::string, Adapter*> m_resolved = {};
+    /** m_vfs->generation when m_resolved was last valid */
+    mutable uint64_t m_resolvedGeneration = 0;
+    mutable std::mutex m_resolvedMutex = {};
 };
 
 using ContainerUniquePtr = std::unique_ptr<Container>;
@@ -0,0 +1,21 @@
+#include "DRMMouseInput.h"
+
+using namespace WallpaperEngine::Input::Drivers;
+
+void DRMMouseInput::update () {}
+
+glm::dvec2 DRMMouseInput::position () const {
+    return {0, 0};
+}
+
+WallpaperEngine::Input::MouseClickStatus DRMMouseInput::leftClick () const {
+    return MouseClickStatus::Released;
+}
+
+WallpaperEngine::Input::MouseClickStatus DRMMouseInput::rightClick () const {
+    return MouseClickStatus::Released;
+}
+
+uint64_t DRMMouseInput::generation () const {
+    return 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#ifdef ENABLE_DRM
+
+#include "WallpaperEngine/Input/MouseInput.h"
+
+#include <glm/vec2.hpp>
+
+namespace WallpaperEngine::Input::Drivers {
+/**
+ * Mouse input for the DRM driver, without a window server there's no pointer to follow so the background
+ * always sees it resting at the origin
+ */
+class DRMMouseInput final : public MouseInput {
+  public:
+    /**
+     * Takes current mouse position and updates it
+     */
+    void update () override;
+
+    /**
+     * The virtual pointer's position
+     */
+    [[nodiscard]] glm::dvec2 position () const override;
+
+    /**
+     * @return The status of the mouse's left click
+     */
+    [[nodiscard]] MouseClickStatus leftClick () const override;
+
+    /**
+     * @return The status of the mouse's right click
+     */
+    [[nodiscard]] MouseClickStatus rightClick () const override;
+
+    [[nodiscard]] uint64_t generation () const override;
+};
+} // namespace WallpaperEngine::Input::Drivers
+
+#endif /* ENABLE_DRM */
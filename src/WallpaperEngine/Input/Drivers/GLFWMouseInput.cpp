@@ -9,11 +9,19 @@ GLFWMouseInput::GLFWMouseInput (const Render::Drivers::GLFWOpenGLDriver& driver)
     m_driver (driver) {}
 
 void GLFWMouseInput::update () {
+    const glm::dvec2 previousPosition = this->m_reportedPosition;
+
     if (!this->m_driver.getApp ().getContext ().settings.mouse.enabled) {
         this->m_reportedPosition = {0, 0};
+
+        if (previousPosition != this->m_reportedPosition)
+            this->m_generation++;
+
         return;
     }
 
+    const MouseClickStatus previousLeftClick = this->m_leftClick;
+    const MouseClickStatus previousRightClick = this->m_rightClick;
     const int leftClickState = glfwGetMouseButton (this->m_driver.getWindow (), GLFW_MOUSE_BUTTON_LEFT);
     const int rightClickState = glfwGetMouseButton (this->m_driver.getWindow (), GLFW_MOUSE_BUTTON_RIGHT);
 
@@ -29,6 +37,11 @@ void GLFWMouseInput::update () {
     
     // interpolate to the new position
     this->m_reportedPosition = glm::mix (this->m_reportedPosition, this->m_mousePosition, 1.0);
+
+    // GLFW is polled, so whatever happened since the last frame shows up as one change
+    if (this->m_reportedPosition != previousPosition || this->m_leftClick != previousLeftClick ||
+        this->m_rightClick != previousRightClick)
+        this->m_generation++;
 }
 
 glm::dvec2 GLFWMouseInput::position () const {
@@ -41,4 +54,8 @@ WallpaperEngine::Input::MouseClickStatus GLFWMouseInput::leftClick () const {
 
 WallpaperEngine::Input::MouseClickStatus GLFWMouseInput::rightClick () const {
     return m_rightClick;
+}
+
+uint64_t GLFWMouseInput::generation () const {
+    return this->m_generation;
 }
\ No newline at end of file
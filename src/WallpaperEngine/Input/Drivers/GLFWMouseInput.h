@@ -36,6 +36,8 @@ class GLFWMouseInput final : public MouseInput {
      */
     [[nodiscard]] MouseClickStatus rightClick () const override;
 
+    [[nodiscard]] uint64_t generation () const override;
+
   private:
     const Render::Drivers::GLFWOpenGLDriver& m_driver;
 
@@ -46,5 +48,6 @@ class GLFWMouseInput final : public MouseInput {
     glm::dvec2 m_reportedPosition = {};
     MouseClickStatus m_leftClick = Released;
     MouseClickStatus m_rightClick = Released;
+    uint64_t m_generation = 0;
 };
 } // namespace WallpaperEngine::Input::Drivers
@@ -0,0 +1,33 @@
+#include "ReplayMouseInput.h"
+
+using namespace WallpaperEngine::Input;
+using namespace WallpaperEngine::Input::Drivers;
+
+void ReplayMouseInput::update () {}
+
+void ReplayMouseInput::set (const glm::dvec2 position, const MouseClickStatus leftClick,
+                            const MouseClickStatus rightClick) {
+    // the same frames as in the recorded run see something new
+    if (position != this->m_position || leftClick != this->m_leftClick || rightClick != this->m_rightClick)
+        this->m_generation++;
+
+    this->m_position = position;
+    this->m_leftClick = leftClick;
+    this->m_rightClick = rightClick;
+}
+
+glm::dvec2 ReplayMouseInput::position () const {
+    return this->m_position;
+}
+
+MouseClickStatus ReplayMouseInput::leftClick () const {
+    return this->m_leftClick;
+}
+
+MouseClickStatus ReplayMouseInput::rightClick () const {
+    return this->m_rightClick;
+}
+
+uint64_t ReplayMouseInput::generation () const {
+    return this->m_generation;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "WallpaperEngine/Input/MouseInput.h"
+
+#include <glm/vec2.hpp>
+
+namespace WallpaperEngine::Input::Drivers {
+/**
+ * Mouse that is wherever the input recording played back says, see --replay-input
+ */
+class ReplayMouseInput final : public MouseInput {
+  public:
+    /**
+     * Does nothing, the pointer only moves with set ()
+     */
+    void update () override;
+
+    /**
+     * Moves the pointer for the frame about to be rendered
+     *
+     * @param position
+     * @param leftClick
+     * @param rightClick
+     */
+    void set (glm::dvec2 position, MouseClickStatus leftClick, MouseClickStatus rightClick);
+
+    [[nodiscard]] glm::dvec2 position () const override;
+    [[nodiscard]] MouseClickStatus leftClick () const override;
+    [[nodiscard]] MouseClickStatus rightClick () const override;
+    [[nodiscard]] uint64_t generation () const override;
+
+  private:
+    glm::dvec2 m_position = {};
+    MouseClickStatus m_leftClick = Released;
+    MouseClickStatus m_rightClick = Released;
+    uint64_t m_generation = 0;
+};
+} // namespace WallpaperEngine::Input::Drivers
@@ -32,4 +32,8 @@ WallpaperEngine::Input::MouseClickStatus WaylandMouseInput::rightClick () const
         return m_waylandDriver.viewportInFocus->rightClick;
 
     return MouseClickStatus::Released;
-}
\ No newline at end of file
+}
+
+uint64_t WaylandMouseInput::generation () const {
+    return this->m_waylandDriver.mouseGeneration;
+}
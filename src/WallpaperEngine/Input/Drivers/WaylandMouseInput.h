@@ -38,6 +38,8 @@ class WaylandMouseInput final : public MouseInput {
      */
     [[nodiscard]] MouseClickStatus rightClick () const override;
 
+    [[nodiscard]] uint64_t generation () const override;
+
   private:
     /**
      * Wayland: Driver
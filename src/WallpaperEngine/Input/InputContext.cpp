@@ -3,12 +3,16 @@
 using namespace WallpaperEngine::Input;
 using namespace WallpaperEngine::Render::Drivers;
 
-InputContext::InputContext (MouseInput& mouseInput) : m_mouse (mouseInput) {}
+InputContext::InputContext (MouseInput& mouseInput) : m_mouse (&mouseInput) {}
 
 void InputContext::update () {
-    this->m_mouse.update ();
+    this->m_mouse->update ();
 }
 
 const MouseInput& InputContext::getMouseInput () const {
-    return this->m_mouse;
+    return *this->m_mouse;
+}
+
+void InputContext::setMouseInput (MouseInput& mouseInput) {
+    this->m_mouse = &mouseInput;
 }
\ No newline at end of file
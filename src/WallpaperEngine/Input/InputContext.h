@@ -17,8 +17,14 @@ class InputContext {
     void update ();
 
     [[nodiscard]] const MouseInput& getMouseInput () const;
+    /**
+     * Takes the mouse from somewhere other than the driver from now on, like a recording played back
+     *
+     * @param mouseInput Has to outlive the context
+     */
+    void setMouseInput (MouseInput& mouseInput);
 
   private:
-    MouseInput& m_mouse;
+    MouseInput* m_mouse;
 };
 } // namespace WallpaperEngine::Input
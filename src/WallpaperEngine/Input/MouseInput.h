@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <glm/vec2.hpp>
 
 namespace WallpaperEngine::Input {
@@ -42,5 +43,13 @@ class MouseInput {
      * @return The status of the mouse's right click
      */
     [[nodiscard]] virtual MouseClickStatus rightClick () const = 0;
+
+    /**
+     * Counts the pointer's events: moving, clicking or entering another screen all bump it. Any number of them
+     * between two frames is seen as a single change, so comparing it tells if there's anything new to react to
+     *
+     * @return The number of pointer events so far
+     */
+    [[nodiscard]] virtual uint64_t generation () const = 0;
 };
 } // namespace WallpaperEngine::Input
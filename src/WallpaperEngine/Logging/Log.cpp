@@ -9,6 +9,19 @@ Log::Log () {
     assert (this->sInstance == nullptr);
 }
 
+Log::~Log () {
+    if (!this->mWriter.joinable ())
+        return;
+
+    {
+        std::lock_guard lock (this->mMutex);
+        this->mStopping = true;
+    }
+
+    this->mQueued.notify_one ();
+    this->mWriter.join ();
+}
+
 Log& Log::get () {
     if (sInstance == nullptr) {
         sInstance = std::make_unique<Log> ();
@@ -25,4 +38,98 @@ void Log::addError (std::ostream* stream) {
     this->mErrors.push_back (stream);
 }
 
-std::unique_ptr<Log> Log::sInstance = nullptr;
\ No newline at end of file
+void Log::startWriter () {
+    if (this->mWriter.joinable ())
+        return;
+
+    this->mWriter = std::thread (&Log::writerLoop, this);
+}
+
+void Log::flush () {
+    if (!this->mWriter.joinable ())
+        return;
+
+    std::unique_lock lock (this->mMutex);
+
+    this->mWritten.wait (lock, [this] { return this->mQueue.empty () && this->mWriting == 0; });
+}
+
+void Log::write (std::string&& line, const bool error) {
+    if (!this->mWriter.joinable ()) {
+        this->writeLines ({{std::move (line), error}});
+        return;
+    }
+
+    {
+        std::lock_guard lock (this->mMutex);
+
+        if (this->mQueue.size () >= MAX_QUEUED_LINES) {
+            this->mDropped++;
+            return;
+        }
+
+        this->mQueue.push_back ({std::move (line), error});
+    }
+
+    this->mQueued.notify_one ();
+}
+
+void Log::writeLines (const std::vector<Line>& lines) const {
+    std::string output;
+    std::string errors;
+
+    for (const auto& [text, error] : lines) {
+        std::string& target = error ? errors : output;
+
+        target += text;
+        target += '\n';
+    }
+
+    if (!output.empty ())
+        for (const auto cur : this->mOutputs)
+            *cur << output << std::flush;
+
+    if (!errors.empty ())
+        for (const auto cur : this->mErrors)
+            *cur << errors << std::flush;
+}
+
+void Log::writerLoop () {
+    std::vector<Line> lines = {};
+
+    while (true) {
+        size_t dropped = 0;
+        bool stopping = false;
+
+        {
+            std::unique_lock lock (this->mMutex);
+
+            this->mQueued.wait (lock, [this] { return !this->mQueue.empty () || this->mStopping; });
+
+            // swap the buffers so the loggers can keep queueing while this batch is written
+            lines.swap (this->mQueue);
+            this->mWriting = lines.size ();
+            dropped = this->mDropped;
+            this->mDropped = 0;
+            stopping = this->mStopping;
+        }
+
+        if (dropped > 0)
+            lines.push_back ({"Logging fell behind, " + std::to_string (dropped) + " lines were dropped", true});
+
+        this->writeLines (lines);
+        lines.clear ();
+
+        {
+            std::lock_guard lock (this->mMutex);
+            this->mWriting = 0;
+        }
+
+        this->mWritten.notify_all ();
+
+        if (stopping)
+            return;
+    }
+}
+
+std::unique_ptr<Log> Log::sInstance = nullptr;
@@ -1,89 +1,148 @@
 #pragma once
 
+#include <condition_variable>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace WallpaperEngine::Logging {
 /**
  * Singleton class, simplifies logging for the whole app
+ *
+ * Lines are formatted on the thread logging them, but only queued there once the writer is started: a background
+ * thread takes everything queued since its last pass and writes it with one flush per stream. Nothing is formatted
+ * for a level without streams, and LOG_DEBUG skips evaluating its arguments altogether in builds without debug output
  */
 class Log {
   public:
     Log ();
+    ~Log ();
 
     void addOutput (std::ostream* stream);
     void addError (std::ostream* stream);
 
-    template <typename... Data> void out (Data... data) {
-        std::string str = this->buildBuffer (data...);
+    /**
+     * Moves writing the lines to a background thread, until then they're written right away
+     */
+    void startWriter ();
+    /**
+     * Waits until every line queued so far is written
+     */
+    void flush ();
+
+    template <typename... Data> void out (const Data&... data) {
+        if (this->mOutputs.empty ())
+            return;
 
-        // then send it to all the outputs configured
-        for (const auto cur : this->mOutputs)
-            *cur << str << std::endl;
+        this->write (this->buildBuffer (data...), false);
     }
 
-    template <typename... Data> void debug (Data... data) {
+    template <typename... Data> void debug (const Data&... data) {
 #if (!NDEBUG) && (!ERRORONLY)
-        std::string str = this->buildBuffer (data...);
+        if (this->mOutputs.empty ())
+            return;
 
-        // then send it to all the outputs configured
-        for (const auto cur : this->mOutputs)
-            *cur << str << std::endl;
+        this->write (this->buildBuffer (data...), false);
 #endif /* DEBUG */
     }
 
-    template <typename... Data> void debugerror (Data... data) {
+    template <typename... Data> void debugerror (const Data&... data) {
 #if (!NDEBUG) && (ERRORONLY)
-        std::string str = this->buildBuffer (data...);
+        if (this->mOutputs.empty ())
+            return;
 
-        // then send it to all the outputs configured
-        for (const auto cur : this->mOutputs)
-            *cur << str << std::endl;
+        this->write (this->buildBuffer (data...), false);
 #endif /* DEBUG */
     }
 
-    template <typename... Data> void error (Data... data) {
-        std::string str = this->buildBuffer (data...);
+    template <typename... Data> void error (const Data&... data) {
+        if (this->mErrors.empty ())
+            return;
 
-        // then send it to all the outputs configured
-        for (const auto cur : this->mErrors)
-            *cur << str << std::endl;
+        this->write (this->buildBuffer (data...), true);
     }
 
-    template <class EX, typename... Data> [[noreturn]] void exception (Data... data) {
+    template <class EX, typename... Data> [[noreturn]] void exception (const Data&... data) {
         std::string str = this->buildBuffer (data...);
-        // then send it to all the outputs configured
-        for (const auto cur : this->mErrors)
-            *cur << str << std::endl;
+
+        // whatever catches it might print it right away, so everything logged before has to be out by then
+        if (!this->mErrors.empty ()) {
+            this->write (std::string (str), true);
+            this->flush ();
+        }
 
         // now throw the exception
         throw EX (str);
     }
 
-    template <typename... Data> [[noreturn]] void exception (Data... data) {
+    template <typename... Data> [[noreturn]] void exception (const Data&... data) {
         this->exception<std::runtime_error> (data...);
     }
 
     static Log& get ();
 
   private:
-    template <typename... Data> std::string buildBuffer (Data... data) {
+    struct Line {
+        std::string text;
+        bool error;
+    };
+
+    template <typename... Data> std::string buildBuffer (const Data&... data) {
         // buffer the string first
         std::stringbuf buffer;
         std::ostream bufferStream (&buffer);
 
-        ((bufferStream << std::forward<Data> (data)), ...);
+        ((bufferStream << data), ...);
 
         return buffer.str ();
     }
 
+    /**
+     * Queues the line for the writer, or writes it straight away if there's none
+     */
+    void write (std::string&& line, bool error);
+    /**
+     * Writes the lines to their streams, one flush for each
+     */
+    void writeLines (const std::vector<Line>& lines) const;
+    /**
+     * Writer thread's loop, takes the queued lines in batches until the log goes away
+     */
+    void writerLoop ();
+
+    /** lines queued at most, anything past it is dropped instead of making the logging thread wait */
+    static constexpr size_t MAX_QUEUED_LINES = 4096;
+
     std::vector<std::ostream*> mOutputs = {};
     std::vector<std::ostream*> mErrors = {};
+    std::vector<Line> mQueue = {};
+    size_t mDropped = 0;
+    /** lines the writer took from the queue but didn't write yet, flush () waits for these too */
+    size_t mWriting = 0;
+    bool mStopping = false;
+    std::mutex mMutex;
+    std::condition_variable mQueued;
+    std::condition_variable mWritten;
+    std::thread mWriter;
     static std::unique_ptr<Log> sInstance;
 };
 } // namespace WallpaperEngine::Logging
 
-#define sLog (WallpaperEngine::Logging::Log::get ())
\ No newline at end of file
+#define sLog (WallpaperEngine::Logging::Log::get ())
+
+/**
+ * Same as sLog.debug, but the arguments aren't even evaluated in builds that don't print debug output. Meant for
+ * calls on hot paths whose arguments cost something to put together
+ */
+#if (!NDEBUG) && (!ERRORONLY)
+#define LOG_DEBUG(...) sLog.debug (__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) \
+    do {               \
+    } while (0)
+#endif /* DEBUG */
@@ -0,0 +1,245 @@
+#include "BloomPass.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace WallpaperEngine::Render;
+
+namespace {
+constexpr const char* FULLSCREEN_VERTEX = R"(#version 330
+out vec2 v_TexCoord;
+void main () {
+    v_TexCoord = vec2 ((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4 (v_TexCoord * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+/** averages the 4x4 texels under every quarter size pixel with four bilinear taps and keeps what's bright */
+constexpr const char* THRESHOLD_FRAGMENT = R"(#version 330
+uniform sampler2D g_Texture0;
+uniform vec2 u_TexelSize;
+uniform float u_Factor;
+in vec2 v_TexCoord;
+out vec4 out_FragColor;
+void main () {
+    vec3 color = texture (g_Texture0, v_TexCoord + vec2 (-1.0, -1.0) * u_TexelSize).rgb;
+    color += texture (g_Texture0, v_TexCoord + vec2 (1.0, -1.0) * u_TexelSize).rgb;
+    color += texture (g_Texture0, v_TexCoord + vec2 (-1.0, 1.0) * u_TexelSize).rgb;
+    color += texture (g_Texture0, v_TexCoord + vec2 (1.0, 1.0) * u_TexelSize).rgb;
+    color *= 0.25;
+
+    float brightness = max (color.r, max (color.g, color.b));
+    float contribution = max (brightness - u_Factor, 0.0) / max (brightness, 0.0001);
+
+    out_FragColor = vec4 (color * contribution, 1.0);
+}
+)";
+
+constexpr const char* DOWNSAMPLE_FRAGMENT = R"(#version 330
+uniform sampler2D g_Texture0;
+uniform vec2 u_TexelSize;
+in vec2 v_TexCoord;
+out vec4 out_FragColor;
+void main () {
+    vec2 offset = u_TexelSize * 0.5;
+    vec3 color = texture (g_Texture0, v_TexCoord).rgb * 4.0;
+
+    color += texture (g_Texture0, v_TexCoord - offset).rgb;
+    color += texture (g_Texture0, v_TexCoord + offset).rgb;
+    color += texture (g_Texture0, v_TexCoord + vec2 (offset.x, -offset.y)).rgb;
+    color += texture (g_Texture0, v_TexCoord - vec2 (offset.x, -offset.y)).rgb;
+
+    out_FragColor = vec4 (color / 8.0, 1.0);
+}
+)";
+
+constexpr const char* UPSAMPLE_FRAGMENT = R"(#version 330
+uniform sampler2D g_Texture0;
+uniform vec2 u_TexelSize;
+in vec2 v_TexCoord;
+out vec4 out_FragColor;
+void main () {
+    vec2 offset = u_TexelSize * 0.5;
+    vec3 color = texture (g_Texture0, v_TexCoord + vec2 (-offset.x * 2.0, 0.0)).rgb;
+
+    color += texture (g_Texture0, v_TexCoord + vec2 (-offset.x, offset.y)).rgb * 2.0;
+    color += texture (g_Texture0, v_TexCoord + vec2 (0.0, offset.y * 2.0)).rgb;
+    color += texture (g_Texture0, v_TexCoord + vec2 (offset.x, offset.y)).rgb * 2.0;
+    color += texture (g_Texture0, v_TexCoord + vec2 (offset.x * 2.0, 0.0)).rgb;
+    color += texture (g_Texture0, v_TexCoord + vec2 (offset.x, -offset.y)).rgb * 2.0;
+    color += texture (g_Texture0, v_TexCoord + vec2 (0.0, -offset.y * 2.0)).rgb;
+    color += texture (g_Texture0, v_TexCoord + vec2 (-offset.x, -offset.y)).rgb * 2.0;
+
+    out_FragColor = vec4 (color / 12.0, 1.0);
+}
+)";
+
+/** the blend adds this over the scene, the alpha it writes is ignored */
+constexpr const char* COMPOSITE_FRAGMENT = R"(#version 330
+uniform sampler2D g_Texture0;
+uniform float u_Factor;
+in vec2 v_TexCoord;
+out vec4 out_FragColor;
+void main () {
+    out_FragColor = vec4 (texture (g_Texture0, v_TexCoord).rgb * u_Factor, 0.0);
+}
+)";
+
+GLuint compileShader (const GLenum type, const char* source) {
+    const GLuint shader = glCreateShader (type);
+
+    glShaderSource (shader, 1, &source, nullptr);
+    glCompileShader (shader);
+
+    GLint success;
+    glGetShaderiv (shader, GL_COMPILE_STATUS, &success);
+
+    if (!success) {
+        char infoLog [1024];
+        glGetShaderInfoLog (shader, sizeof (infoLog), nullptr, infoLog);
+        sLog.error ("Bloom shader compilation failed: ", infoLog);
+        glDeleteShader (shader);
+        return 0;
+    }
+
+    return shader;
+}
+} // namespace
+
+BloomPass::BloomPass (FBOProvider& provider, uint32_t width, uint32_t height, const uint32_t levels) {
+    const uint32_t maxLevels = levels == 0 ? MAX_LEVELS : std::min (levels, MAX_LEVELS);
+
+    width /= 4;
+    height /= 4;
+
+    // the last levels are the ones that make the blur wide, but there's nothing left to blur under a couple pixels
+    for (uint32_t level = 0; level < maxLevels && width >= 2 && height >= 2; level++) {
+        this->m_levels.push_back (provider.create (
+            "_rt_BloomLevel" + std::to_string (level), TextureFormat_ARGB8888, TextureFlags_ClampUVs, 1.0,
+            {width, height}, {width, height}));
+
+        width /= 2;
+        height /= 2;
+    }
+}
+
+BloomPass::~BloomPass () {
+    for (const auto* program : {&this->m_threshold, &this->m_downsample, &this->m_upsample, &this->m_composite})
+        glDeleteProgram (program->id);
+
+    glDeleteVertexArrays (1, &this->m_vao);
+}
+
+bool BloomPass::setup () {
+    if (this->m_levels.empty ())
+        return false;
+
+    if (!link (this->m_threshold, THRESHOLD_FRAGMENT) || !link (this->m_downsample, DOWNSAMPLE_FRAGMENT) ||
+        !link (this->m_upsample, UPSAMPLE_FRAGMENT) || !link (this->m_composite, COMPOSITE_FRAGMENT))
+        return false;
+
+    glGenVertexArrays (1, &this->m_vao);
+
+    return true;
+}
+
+void BloomPass::render (RenderState& state, const CFBO& scene, const float strength, const float threshold) const {
+    if (this->m_vao == GL_NONE)
+        return;
+
+#if !NDEBUG
+    glPushDebugGroup (GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Bloom");
+#endif /* DEBUG */
+
+    state.bindVertexArray (this->m_vao);
+    state.setBlending (false);
+    state.setDepthTest (false);
+    state.setCullFace (false);
+
+    state.useProgram (this->m_threshold.id);
+    glUniform1f (this->m_threshold.factor, threshold);
+    draw (state, this->m_threshold, scene, *this->m_levels.front ());
+
+    for (size_t level = 1; level < this->m_levels.size (); level++)
+        draw (state, this->m_downsample, *this->m_levels [level - 1], *this->m_levels [level]);
+
+    // going back up replaces every level's own downsample, it's not needed anymore
+    for (size_t level = this->m_levels.size () - 1; level > 0; level--)
+        draw (state, this->m_upsample, *this->m_levels [level], *this->m_levels [level - 1]);
+
+    // the upsample from the first level to the scene's size is the bilinear filter of the composite
+    state.setBlending (true);
+    state.setBlendFunc (GL_ONE, GL_ONE, GL_ZERO, GL_ONE);
+    state.useProgram (this->m_composite.id);
+    glUniform1f (this->m_composite.factor, strength);
+    draw (state, this->m_composite, *this->m_levels.front (), scene);
+
+#if !NDEBUG
+    glPopDebugGroup ();
+#endif /* DEBUG */
+}
+
+uint32_t BloomPass::getDrawCount () const {
+    if (this->m_vao == GL_NONE)
+        return 0;
+
+    // threshold and composite plus one downsample and one upsample between every two levels
+    return static_cast<uint32_t> (this->m_levels.size ()) * 2;
+}
+
+bool BloomPass::link (Program& program, const char* fragment) {
+    const GLuint vertexShader = compileShader (GL_VERTEX_SHADER, FULLSCREEN_VERTEX);
+    const GLuint fragmentShader = compileShader (GL_FRAGMENT_SHADER, fragment);
+
+    if (vertexShader == 0 || fragmentShader == 0) {
+        glDeleteShader (vertexShader);
+        glDeleteShader (fragmentShader);
+        return false;
+    }
+
+    program.id = glCreateProgram ();
+    glAttachShader (program.id, vertexShader);
+    glAttachShader (program.id, fragmentShader);
+    glLinkProgram (program.id);
+    glDeleteShader (vertexShader);
+    glDeleteShader (fragmentShader);
+
+    GLint success;
+    glGetProgramiv (program.id, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        char infoLog [1024];
+        glGetProgramInfoLog (program.id, sizeof (infoLog), nullptr, infoLog);
+        sLog.error ("Bloom program linking failed: ", infoLog);
+        glDeleteProgram (program.id);
+        program.id = GL_NONE;
+        return false;
+    }
+
+    program.texture = glGetUniformLocation (program.id, "g_Texture0");
+    program.texelSize = glGetUniformLocation (program.id, "u_TexelSize");
+    program.factor = glGetUniformLocation (program.id, "u_Factor");
+
+    return true;
+}
+
+void BloomPass::draw (
+    RenderState& state, const Program& program, const TextureProvider& source, const CFBO& destination
+) {
+    glBindFramebuffer (GL_FRAMEBUFFER, destination.getFramebuffer ());
+    glViewport (0, 0, destination.getRealWidth (), destination.getRealHeight ());
+
+    state.useProgram (program.id);
+    state.bindTexture (0, source.getTextureID (0));
+
+    glUniform1i (program.texture, 0);
+
+    if (program.texelSize != -1) {
+        glUniform2f (
+            program.texelSize, 1.0f / static_cast<float> (source.getRealWidth ()),
+            1.0f / static_cast<float> (source.getRealHeight ()));
+    }
+
+    glDrawArrays (GL_TRIANGLES, 0, 3);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "CFBO.h"
+#include "FBOProvider.h"
+#include "RenderState.h"
+
+namespace WallpaperEngine::Render {
+/**
+ * Camera bloom of scenes, done on a chain of downsampled framebuffers
+ *
+ * The bright parts of the scene are kept on a quarter size framebuffer, then blurred with a dual filter: every
+ * level down halves the size and every level back up doubles it, each one taking a handful of bilinear samples.
+ * The blur ends up wide for a fraction of the fill a full size one takes, and the result is added over the scene
+ * in a single draw
+ */
+class BloomPass {
+  public:
+    /**
+     * @param provider Where the framebuffers of the chain are created
+     * @param width Width of the scene in scene units
+     * @param height Height of the scene in scene units
+     * @param levels Most levels the chain goes down, 0 for as many as it can
+     */
+    BloomPass (FBOProvider& provider, uint32_t width, uint32_t height, uint32_t levels = 0);
+    ~BloomPass ();
+
+    BloomPass (const BloomPass&) = delete;
+    BloomPass& operator= (const BloomPass&) = delete;
+
+    /**
+     * Compiles the programs of the pass
+     *
+     * @return false if they couldn't be built, rendering does nothing then
+     */
+    bool setup ();
+
+    /**
+     * Adds the bloom of the scene's framebuffer over it
+     *
+     * @param state
+     * @param scene
+     * @param strength How much of the bloom is added
+     * @param threshold Brightness parts of the scene need to go over to bloom
+     */
+    void render (RenderState& state, const CFBO& scene, float strength, float threshold) const;
+    /** @return The draw calls render () issues */
+    [[nodiscard]] uint32_t getDrawCount () const;
+
+  private:
+    /** most levels the chain goes down, each one half the size of the one before */
+    static constexpr uint32_t MAX_LEVELS = 5;
+
+    struct Program {
+        GLuint id = GL_NONE;
+        GLint texture = -1;
+        GLint texelSize = -1;
+        /** threshold for the first pass, strength for the composite */
+        GLint factor = -1;
+    };
+
+    static bool link (Program& program, const char* fragment);
+    /**
+     * Draws the source texture over the whole destination with the given program
+     */
+    static void draw (
+        RenderState& state, const Program& program, const TextureProvider& source, const CFBO& destination);
+
+    /** the chain, starting at a quarter of the scene's size */
+    std::vector<std::shared_ptr<CFBO>> m_levels = {};
+    Program m_threshold = {};
+    Program m_downsample = {};
+    Program m_upsample = {};
+    Program m_composite = {};
+    /** the draws make their fullscreen triangle from gl_VertexID, this has no attributes */
+    GLuint m_vao = GL_NONE;
+};
+} // namespace WallpaperEngine::Render
@@ -1,4 +1,6 @@
 #include "CFBO.h"
+#include "GPUResources.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
 #include "WallpaperEngine/Logging/Log.h"
 
 using namespace WallpaperEngine::Render;
@@ -9,6 +11,9 @@ CFBO::CFBO (std::string name, const TextureFormat format, const uint32_t flags,
     m_name (std::move (name)),
     m_format (format),
     m_flags (flags) {
+    const Debugging::LoadReport::Scope report (
+        Debugging::LoadReport::Stage_Framebuffers,
+        static_cast<uint64_t> (textureWidth) * textureHeight * getPixelSize (format));
     // create an empty texture that'll be free'd so the FBO is transparent
     constexpr GLenum drawBuffers [1] = {GL_COLOR_ATTACHMENT0};
     // create the main framebuffer
@@ -18,8 +23,10 @@ CFBO::CFBO (std::string name, const TextureFormat format, const uint32_t flags,
     glGenTextures (1, &this->m_texture);
     // bind the new texture to set settings on it
     glBindTexture (GL_TEXTURE_2D, this->m_texture);
-    // give OpenGL an empty image
-    glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    // give OpenGL an empty image, masks and data only get the channels they use
+    glTexImage2D (
+        GL_TEXTURE_2D, 0, getInternalFormat (format), textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+        nullptr);
     // label stuff for debugging
 #if !NDEBUG
     glObjectLabel (GL_TEXTURE, this->m_texture, -1, this->m_name.c_str ());
@@ -60,6 +67,11 @@ CFBO::CFBO (std::string name, const TextureFormat format, const uint32_t flags,
 
     this->m_resolution = {textureWidth, textureHeight, realWidth, realHeight};
 
+    sGPUResources.add (
+        this, GPUResources::Type_Framebuffer,
+        static_cast<uint64_t> (textureWidth) * textureHeight * getPixelSize (format), this->m_name,
+        GPUResources::formatName (getInternalFormat (format)));
+
     // create the textureframe entries
     const auto frame = std::make_shared<Frame> ();
 
@@ -76,11 +88,33 @@ CFBO::CFBO (std::string name, const TextureFormat format, const uint32_t flags,
 }
 
 CFBO::~CFBO () {
+    // shared storage is released by its owner
+    if (this->m_storageOwner != nullptr)
+        return;
+
+    sGPUResources.remove (this);
     // free opengl texture and framebuffer
     glDeleteTextures (1, &this->m_texture);
     glDeleteFramebuffers (1, &this->m_framebuffer);
 }
 
+void CFBO::shareStorage (std::shared_ptr<const CFBO> owner) {
+    // always point to the FBO that actually owns the storage so chains don't build up
+    if (owner->m_storageOwner != nullptr)
+        owner = owner->m_storageOwner;
+
+    if (this->m_storageOwner == nullptr) {
+        sGPUResources.remove (this);
+        glDeleteTextures (1, &this->m_texture);
+        glDeleteFramebuffers (1, &this->m_framebuffer);
+    }
+
+    this->m_framebuffer = owner->m_framebuffer;
+    this->m_depthbuffer = owner->m_depthbuffer;
+    this->m_texture = owner->m_texture;
+    this->m_storageOwner = std::move (owner);
+}
+
 const std::string& CFBO::getName () const {
     return this->m_name;
 }
@@ -151,4 +185,27 @@ uint32_t CFBO::getSpritesheetFrames () const {
 
 float CFBO::getSpritesheetDuration () const {
     return 0.0f;  // FBOs don't have spritesheets
-}
\ No newline at end of file
+}
+GLenum CFBO::getInternalFormat (const TextureFormat format) {
+    switch (format) {
+        case TextureFormat_R8: return GL_R8;
+        case TextureFormat_RG88: return GL_RG8;
+        case TextureFormat_R16f: return GL_R16F;
+        case TextureFormat_RG1616f: return GL_RG16F;
+        case TextureFormat_RGBa1010102: return GL_RGB10_A2;
+        // three channel float targets aren't required to be renderable
+        case TextureFormat_RGB161616f:
+        case TextureFormat_RGBA16161616f: return GL_RGBA16F;
+        default: return GL_RGBA8;
+    }
+}
+
+uint32_t CFBO::getPixelSize (const TextureFormat format) {
+    switch (getInternalFormat (format)) {
+        case GL_R8: return 1;
+        case GL_RG8:
+        case GL_R16F: return 2;
+        case GL_RGBA16F: return 8;
+        default: return 4;
+    }
+}
@@ -13,6 +13,15 @@ class CFBO final : public TextureProvider {
           uint32_t realWidth, uint32_t realHeight, uint32_t textureWidth, uint32_t textureHeight);
     ~CFBO () override;
 
+    /**
+     * Renders into the storage of another FBO from now on, releasing this one's
+     *
+     * Both FBOs must have the same size, format and flags and their contents must never be needed at the same time
+     *
+     * @param owner
+     */
+    void shareStorage (std::shared_ptr<const CFBO> owner);
+
     [[nodiscard]] const std::string& getName () const;
     [[nodiscard]] const float& getScale () const;
     [[nodiscard]] TextureFormat getFormat () const override;
@@ -32,6 +41,16 @@ class CFBO final : public TextureProvider {
     [[nodiscard]] uint32_t getSpritesheetFrames () const override;
     [[nodiscard]] float getSpritesheetDuration () const override;
 
+    /**
+     * @return The GL internal format render targets of the given format are allocated with, formats that can't be
+     *         rendered to are widened to the closest one that can
+     */
+    [[nodiscard]] static GLenum getInternalFormat (TextureFormat format);
+    /**
+     * @return Bytes every pixel of a render target of the given format takes
+     */
+    [[nodiscard]] static uint32_t getPixelSize (TextureFormat format);
+
   private:
     GLuint m_framebuffer = GL_NONE;
     GLuint m_depthbuffer = GL_NONE;
@@ -41,6 +60,8 @@ class CFBO final : public TextureProvider {
     std::string m_name = "";
     TextureFormat m_format = TextureFormat_UNKNOWN;
     uint32_t m_flags = TextureFlags_NoFlags;
+    /** FBO whose framebuffer and texture this one uses, nullptr if they're its own */
+    std::shared_ptr<const CFBO> m_storageOwner = nullptr;
     /** Placeholder for frames, FBOs only have ONE */
     std::vector<FrameSharedPtr> m_frames = {};
 };
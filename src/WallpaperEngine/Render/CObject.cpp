@@ -1,5 +1,7 @@
 #include "CObject.h"
+#include "RenderContext.h"
 
+#include <string>
 #include <utility>
 
 using namespace WallpaperEngine;
@@ -9,7 +11,9 @@ using namespace WallpaperEngine::Render::Wallpapers;
 CObject::CObject (Wallpapers::CScene& scene, const Object& object) :
     Helpers::ContextAware (scene),
     m_scene (scene),
-    m_object (object) {}
+    m_object (object),
+    m_profilerEntry (
+        this->getContext ().getProfiler ().registerEntry (object.name + " (" + std::to_string (object.id) + ")")) {}
 
 Wallpapers::CScene& CObject::getScene () const {
     return this->m_scene;
@@ -21,4 +25,8 @@ const AssetLocator& CObject::getAssetLocator () const {
 
 int CObject::getId () const {
     return this->m_object.id;
-}
\ No newline at end of file
+}
+
+GPUProfiler::Entry CObject::getProfilerEntry () const {
+    return this->m_profilerEntry;
+}
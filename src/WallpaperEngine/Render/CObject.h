@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include "WallpaperEngine/Render/GPUProfiler.h"
 #include "WallpaperEngine/Render/Helpers/ContextAware.h"
 
 #include "WallpaperEngine/Render/Wallpapers/CScene.h"
@@ -38,6 +39,8 @@ class CObject : public Helpers::ContextAware {
     [[nodiscard]] Wallpapers::CScene& getScene () const;
     [[nodiscard]] const AssetLocator& getAssetLocator () const;
     [[nodiscard]] int getId () const;
+    /** @return The entry the GPU time of the object's draws is reported as */
+    [[nodiscard]] GPUProfiler::Entry getProfilerEntry () const;
 
   protected:
     CObject (Wallpapers::CScene& scene, const Object& object);
@@ -46,5 +49,6 @@ class CObject : public Helpers::ContextAware {
   private:
     Wallpapers::CScene& m_scene;
     const Object& m_object;
+    GPUProfiler::Entry m_profilerEntry;
 };
 } // namespace WallpaperEngine::Render
\ No newline at end of file
@@ -1,84 +1,779 @@
 #include "CTexture.h"
 #include "WallpaperEngine/Logging/Log.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
-#include <lz4.h>
+#include <exception>
+#include <mutex>
+#include <ranges>
 #include <string>
 
+#include "GPUResources.h"
+#include "SamplerCache.h"
+#include "WallpaperEngine/Data/Parsers/TextureParser.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
+#include "WallpaperEngine/Threading/JobPool.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 using namespace WallpaperEngine::Render;
+using namespace WallpaperEngine::Data::Parsers;
 
-CTexture::CTexture (TextureUniquePtr header) : m_header (std::move(header)) {
+CTexture::CTexture (
+    TextureUniquePtr header, const bool streamed, const bool compress, const std::string& name, const uint32_t maxSize
+) :
+    m_header (std::move(header)) {
     // ensure the header is parsed
     this->setupResolution ();
-    const GLint internalFormat = this->setupInternalFormat();
+    this->m_internalFormat = this->setupInternalFormat();
+
+    this->m_atlas = this->canPackAtlas ();
+    this->setupReduction (maxSize);
+
+    // the cache stores every image on its own, at the size in the file
+    if (compress && !this->m_atlas && this->m_skippedLevels == 0 && this->m_halvings == 0 &&
+        TextureCompressionCache::isEligible (*this->m_header))
+        this->m_compressedFormat = TextureCompressionCache::getFormat ();
+
+    this->m_generateMipmaps = this->shouldGenerateMipmaps ();
+    // an atlas has a single level, nothing to refine
+    this->m_progressive = !this->m_atlas && std::ranges::any_of (
+        this->m_header->images | std::views::values,
+        [this] (const auto& mipmaps) { return mipmaps.size () - this->getFirstLevel (mipmaps) > 1; });
+
+    if (this->m_header->flags & TextureFlags_ClampUVs)
+        this->m_samplerFlags |= SamplerCache::Flags_Clamp;
+    if (this->m_header->flags & TextureFlags_NoInterpolation)
+        this->m_samplerFlags |= SamplerCache::Flags_Nearest;
+    if (const auto& first = this->m_header->images.begin ()->second;
+        this->m_generateMipmaps || first.size () - this->getFirstLevel (first) > 1)
+        this->m_samplerFlags |= SamplerCache::Flags_Mipmaps;
 
     // allocate texture ids list
     this->m_textureID = new GLuint [this->m_header->imageCount];
-    // ask opengl for the correct amount of textures
-    glGenTextures (this->m_header->imageCount, this->m_textureID);
 
-    for (const auto& [index, mipmaps] : this->m_header->images) {
-        this->setupOpenGLParameters (index);
-
-        int level = 0;
-
-        for (const auto& mipmap : mipmaps) {
-            stbi_uc* handle = nullptr;
-            const void* dataptr = mipmap->uncompressedData.get ();
-            int width = mipmap->width;
-            int height = mipmap->height;
-            const uint32_t bufferSize = mipmap->uncompressedSize;
-            GLenum textureFormat = GL_RGBA;
-
-            if (this->m_header->freeImageFormat != FIF_UNKNOWN) {
-                int fileChannels;
-
-                dataptr = handle = stbi_load_from_memory (
-                    reinterpret_cast <unsigned char*> (mipmap->uncompressedData.get ()),
-                    mipmap->uncompressedSize,
-                    &width,
-                    &height,
-                    &fileChannels,
-                    4);
-            } else {
-                if (this->m_header->format == TextureFormat_R8) {
-                    // red textures are 1-byte-per-pixel, so it's alignment has to be set manually
-                    glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
-                    textureFormat = GL_RED;
-                } else if (this->m_header->format == TextureFormat_RG88) {
-                    textureFormat = GL_RG;
-                }
+    if (this->m_atlas) {
+        // every image is a row of the same texture
+        glGenTextures (1, this->m_textureID);
+        std::fill_n (this->m_textureID + 1, this->m_header->imageCount - 1, this->m_textureID [0]);
+        this->setupOpenGLParameters (0);
+    } else {
+        // ask opengl for the correct amount of textures
+        glGenTextures (this->m_header->imageCount, this->m_textureID);
+
+        for (const auto& index : this->m_header->images | std::views::keys)
+            this->setupOpenGLParameters (index);
+    }
+
+    // takes no memory until the levels are uploaded
+    sGPUResources.add (
+        this, GPUResources::Type_Texture, 0, name,
+        GPUResources::formatName (
+            this->m_compressedFormat != GL_NONE ? this->m_compressedFormat : this->m_internalFormat));
+
+    double end = 0.0;
+
+    for (const auto& frame : this->m_header->frames)
+        this->m_frameEnds.push_back (end += frame->frametime);
+
+    // the cache needs the stored bytes to find the entry, and the blocks it has can't go through the buffer
+    if (this->m_compressedFormat == GL_NONE)
+        this->mapUnpackBuffer ();
+
+    if (streamed)
+        return;
+
+    this->decode ();
+    this->upload ();
+}
+
+CTexture::~CTexture () {
+    // only left if the texture was never fully uploaded
+    for (const auto& levels : this->m_levels)
+        for (const auto& level : levels)
+            stbi_image_free (level.decoded);
+
+    this->releaseUnpackBuffer ();
+
+    sGPUResources.remove (this);
+    glDeleteTextures (this->m_atlas ? 1 : this->m_header->imageCount, this->m_textureID);
+    delete [] this->m_textureID;
+}
+
+bool CTexture::canPackAtlas () const {
+    if (!this->isAnimated () || this->m_header->imageCount < 2 || this->m_header->images.size () < 2)
+        return false;
+
+    const auto& first = this->m_header->images.begin ()->second;
+
+    if (first.size () != 1)
+        return false;
+
+    const auto width = first.front ()->width;
+    const auto height = first.front ()->height;
+
+    for (const auto& mipmaps : this->m_header->images | std::views::values) {
+        // mipmaps would bleed into the neighbouring rows
+        if (mipmaps.size () != 1 || mipmaps.front ()->width != width || mipmaps.front ()->height != height)
+            return false;
+    }
+
+    const bool compressed = this->m_internalFormat != GL_RGBA8 && this->m_internalFormat != GL_RG8 &&
+        this->m_internalFormat != GL_R8;
+
+    // compressed rows have to start at a block
+    if (compressed && height % 4 != 0)
+        return false;
+
+    return static_cast<uint64_t> (height) * this->m_header->images.size () <=
+           static_cast<uint64_t> (getMaxTextureSize ());
+}
+
+GLint CTexture::getMaxTextureSize () {
+    static const GLint maximum = [] {
+        GLint size = 0;
+
+        glGetIntegerv (GL_MAX_TEXTURE_SIZE, &size);
+
+        return size;
+    } ();
+
+    return maximum;
+}
+
+void CTexture::setupReduction (const uint32_t maxSize) {
+    // an atlas is already known to fit, its rows have to stay the size of the frames
+    if (this->m_atlas || this->m_header->images.empty ())
+        return;
+
+    const auto limit = maxSize == 0
+        ? static_cast<uint32_t> (getMaxTextureSize ())
+        : std::min (maxSize, static_cast<uint32_t> (getMaxTextureSize ()));
+    const auto& mipmaps = this->m_header->images.begin ()->second;
+
+    if (mipmaps.empty () || limit == 0)
+        return;
+
+    uint32_t reductions = 0;
+
+    for (uint32_t size = std::max (mipmaps.front ()->width, mipmaps.front ()->height); size > limit; size /= 2)
+        reductions++;
+
+    if (reductions == 0)
+        return;
+
+    // the chain has the smaller levels already, whatever it's short of is made on decode ()
+    this->m_skippedLevels = std::min<uint32_t> (reductions, mipmaps.size () - 1);
+    this->m_halvings = reductions - this->m_skippedLevels;
+
+    const bool compressed = this->m_header->freeImageFormat == FIF_UNKNOWN && this->m_internalFormat != GL_RGBA8 &&
+        this->m_internalFormat != GL_RG8 && this->m_internalFormat != GL_R8;
+
+    // DXT blocks can't be filtered without decoding them first
+    if (compressed && this->m_halvings > 0) {
+        sLog.error (
+            "Texture of ", mipmaps.front ()->width, "x", mipmaps.front ()->height,
+            " is over the size limit but its format cannot be scaled down, it might not show");
+        this->m_halvings = 0;
+    }
+
+    reductions = this->m_skippedLevels + this->m_halvings;
+
+    if (reductions > 0)
+        sLog.debug (
+            "Texture of ", mipmaps.front ()->width, "x", mipmaps.front ()->height, " is kept at ",
+            std::max (mipmaps.front ()->width >> reductions, 1u), "x",
+            std::max (mipmaps.front ()->height >> reductions, 1u), " to fit in ", limit);
+}
+
+size_t CTexture::getFirstLevel (const MipmapList& mipmaps) const {
+    return mipmaps.empty () ? 0 : std::min<size_t> (this->m_skippedLevels, mipmaps.size () - 1);
+}
+
+void CTexture::halveLevel (Level& level) const {
+    int channels = 4;
+
+    if (this->m_header->freeImageFormat == FIF_UNKNOWN) {
+        if (this->m_internalFormat == GL_RG8)
+            channels = 2;
+        else if (this->m_internalFormat == GL_R8)
+            channels = 1;
+    }
+
+    const int width = std::max (level.width / 2, 1);
+    const int height = std::max (level.height / 2, 1);
+    const auto* source = static_cast<const uint8_t*> (level.data);
+    // allocated like stb_image does so both are freed the same way
+    auto* target = static_cast<uint8_t*> (malloc (static_cast<size_t> (width) * height * channels));
+
+    if (target == nullptr)
+        sLog.exception ("Cannot allocate memory to scale down texture");
+
+    for (int y = 0; y < height; y++) {
+        // odd sides average the last row or column with itself
+        const int top = std::min (y * 2, level.height - 1);
+        const int bottom = std::min (y * 2 + 1, level.height - 1);
+
+        for (int x = 0; x < width; x++) {
+            const int left = std::min (x * 2, level.width - 1);
+            const int right = std::min (x * 2 + 1, level.width - 1);
+
+            for (int channel = 0; channel < channels; channel++) {
+                const auto texel = [&] (const int row, const int column) -> uint32_t {
+                    return source [(static_cast<size_t> (row) * level.width + column) * channels + channel];
+                };
+
+                target [(static_cast<size_t> (y) * width + x) * channels + channel] = static_cast<uint8_t> (
+                    (texel (top, left) + texel (top, right) + texel (bottom, left) + texel (bottom, right) + 2) / 4);
             }
+        }
+    }
+
+    stbi_image_free (level.decoded);
+    // the pixels in the file aren't needed anymore either
+    level.mipmap->uncompressedData.reset ();
+    level.data = level.decoded = target;
+    level.width = width;
+    level.height = height;
+    level.size = static_cast<GLsizei> (static_cast<size_t> (width) * height * channels);
+}
+
+void CTexture::allocateAtlas (const Level& level, const GLenum textureFormat) const {
+    const auto images = static_cast<GLsizei> (this->m_levels.size ());
+
+    if (this->m_unpackBuffer != GL_NONE)
+        glBindBuffer (GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+
+    if (this->m_internalFormat == GL_RGBA8 || this->m_internalFormat == GL_RG8 || this->m_internalFormat == GL_R8) {
+        glTexImage2D (
+            GL_TEXTURE_2D, 0, this->m_internalFormat, level.width, level.height * images, 0, textureFormat,
+            GL_UNSIGNED_BYTE, nullptr);
+    } else {
+        glCompressedTexImage2D (
+            GL_TEXTURE_2D, 0, this->m_internalFormat, level.width, level.height * images, 0, level.size * images,
+            nullptr);
+    }
+}
+
+void CTexture::uploadAtlasImage (
+    const Level& level, const size_t image, const GLenum textureFormat, const void* data) const {
+    const auto y = static_cast<GLint> (image) * level.height;
+
+    if (this->m_internalFormat == GL_RGBA8 || this->m_internalFormat == GL_RG8 || this->m_internalFormat == GL_R8) {
+        glTexSubImage2D (GL_TEXTURE_2D, 0, 0, y, level.width, level.height, textureFormat, GL_UNSIGNED_BYTE, data);
+    } else {
+        glCompressedTexSubImage2D (
+            GL_TEXTURE_2D, 0, 0, y, level.width, level.height, this->m_internalFormat, level.size, data);
+    }
+}
+
+void CTexture::planUploads () {
+    this->m_uploadOrder.clear ();
+
+    if (!this->m_progressive) {
+        for (size_t image = 0; image < this->m_levels.size (); image++)
+            for (size_t level = 0; level < this->m_levels [image].size (); level++)
+                this->m_uploadOrder.emplace_back (image, level);
+
+        return;
+    }
+
+    size_t rounds = 0;
+
+    for (const auto& levels : this->m_levels)
+        rounds = std::max (rounds, levels.size ());
+
+    // every image gets its next bigger level before any of them gets the one after, so the frames of an
+    // animation sharpen together
+    for (size_t round = 0; round < rounds; round++)
+        for (size_t image = 0; image < this->m_levels.size (); image++)
+            if (round < this->m_levels [image].size ())
+                this->m_uploadOrder.emplace_back (image, this->m_levels [image].size () - 1 - round);
+}
+
+void CTexture::mapUnpackBuffer () {
+    // image formats go through stb_image, which needs the whole file in memory anyway, and so does scaling down
+    if (this->m_header->freeImageFormat != FIF_UNKNOWN || this->m_halvings > 0)
+        return;
+
+    GLintptr size = 0;
+
+    for (const auto& mipmaps : this->m_header->images | std::views::values) {
+        for (const auto& mipmap : mipmaps | std::views::drop (this->getFirstLevel (mipmaps))) {
+            if (mipmap->uncompressedData != nullptr)
+                continue;
+
+            this->m_unpackOffsets.emplace (mipmap.get (), size);
+            // keep every level aligned for the driver
+            size += (mipmap->uncompressedSize + 15) & ~15;
+        }
+    }
+
+    if (size == 0)
+        return;
+
+    glGenBuffers (1, &this->m_unpackBuffer);
+    glBindBuffer (GL_PIXEL_UNPACK_BUFFER, this->m_unpackBuffer);
+    glBufferData (GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    sGPUResources.add (&this->m_unpackBuffer, GPUResources::Type_Buffer, size, "texture upload");
+    this->m_unpackData = static_cast<char*> (
+        glMapBufferRange (GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    glBindBuffer (GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+
+    if (this->m_unpackData != nullptr)
+        return;
+
+    // decode () decompresses into memory instead
+    sLog.error ("Cannot map pixel unpack buffer for texture, decompressing it in memory");
+    this->releaseUnpackBuffer ();
+}
+
+void CTexture::unmapUnpackBuffer () {
+    if (this->m_unpackData == nullptr)
+        return;
+
+    glBindBuffer (GL_PIXEL_UNPACK_BUFFER, this->m_unpackBuffer);
+    this->m_unpackData = nullptr;
+
+    if (glUnmapBuffer (GL_PIXEL_UNPACK_BUFFER) == GL_TRUE)
+        return;
+
+    // the contents are undefined after a failed unmap, the compressed blocks are still around for this
+    sLog.error ("Pixel unpack buffer for texture was lost while mapped, decompressing it in memory");
+
+    glBindBuffer (GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+    this->releaseUnpackBuffer ();
+
+    for (auto& levels : this->m_levels) {
+        for (auto& level : levels) {
+            if (level.offset == -1)
+                continue;
+
+            TextureParser::decompress (*level.mipmap);
+            level.data = level.mipmap->uncompressedData.get ();
+            level.offset = -1;
+        }
+    }
+}
+
+void CTexture::releaseUnpackBuffer () {
+    if (this->m_unpackBuffer == GL_NONE)
+        return;
+
+    if (this->m_unpackData != nullptr) {
+        glBindBuffer (GL_PIXEL_UNPACK_BUFFER, this->m_unpackBuffer);
+        glUnmapBuffer (GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer (GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+        this->m_unpackData = nullptr;
+    }
+
+    sGPUResources.remove (&this->m_unpackBuffer);
+    glDeleteBuffers (1, &this->m_unpackBuffer);
+    this->m_unpackBuffer = GL_NONE;
+    this->m_unpackOffsets.clear ();
+}
+
+void CTexture::decode () {
+    if (this->m_compressedFormat != GL_NONE && this->decodeCached ())
+        return;
+
+    std::vector<Mipmap*> mipmaps;
+
+    for (const auto& list : this->m_header->images | std::views::values) {
+        const auto first = this->getFirstLevel (list);
 
-            switch (internalFormat) {
-                case GL_RGBA8:
-                case GL_RG8:
-                case GL_R8:
-                    glTexImage2D (
-                        GL_TEXTURE_2D, level, internalFormat, width, height, 0, textureFormat,
-                        GL_UNSIGNED_BYTE, dataptr);
-                    break;
-                case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
-                case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
-                case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
-                    glCompressedTexImage2D (
-                        GL_TEXTURE_2D, level, internalFormat, width, height, 0, bufferSize,
-                        dataptr);
-                    break;
-                default: sLog.exception ("Cannot load texture, unknown format", this->m_header->format);
+        this->m_levels.emplace_back (list.size () - first);
+
+        for (size_t index = 0; index < list.size (); index++) {
+            // the levels over the size limit are never decompressed
+            if (index < first) {
+                list [index]->compressedData.reset ();
+                list [index]->uncompressedData.reset ();
+                continue;
             }
 
-            // stbi_image buffer won't be used anymore, so free memory
-            if (this->m_header->freeImageFormat != FIF_UNKNOWN) {
-                stbi_image_free (handle);
+            mipmaps.push_back (list [index].get ());
+        }
+    }
+
+    // every level has its place already, so the jobs only need to find it
+    std::vector<Level*> levels;
+
+    for (auto& list : this->m_levels)
+        for (auto& level : list)
+            levels.push_back (&level);
+
+    // embedded PNGs and JPEGs take long to decode and the frames of an animation do not depend on each other
+    std::mutex errorMutex;
+    std::exception_ptr error = nullptr;
+
+    sJobPool.parallelFor (mipmaps.size (), 1, [&] (const uint32_t begin, const uint32_t end) {
+        for (uint32_t index = begin; index < end; index++) {
+            try {
+                this->decodeLevel (*mipmaps [index], *levels [index]);
+            } catch (...) {
+                std::scoped_lock lock (errorMutex);
+
+                if (error == nullptr)
+                    error = std::current_exception ();
             }
+        }
+    });
+
+    if (error != nullptr)
+        std::rethrow_exception (error);
+}
+
+bool CTexture::decodeCached () {
+    this->m_cachePath = TextureCompressionCache::getPath (*this->m_header);
+
+    if (this->m_cachePath.empty () || !TextureCompressionCache::load (this->m_cachePath, this->m_cached))
+        return false;
+
+    // an entry for a different texture that happened to have the same hash
+    bool matches = this->m_cached.images.size () == this->m_header->images.size ();
+
+    for (size_t image = 0; matches && image < this->m_cached.images.size (); image++)
+        matches = this->m_cached.images [image].size () == this->m_header->images [image].size ();
+
+    if (!matches) {
+        this->m_cached = {};
+        return false;
+    }
+
+    for (size_t image = 0; image < this->m_cached.images.size (); image++) {
+        auto& levels = this->m_levels.emplace_back ();
+
+        for (size_t index = 0; index < this->m_cached.images [image].size (); index++) {
+            const auto& cached = this->m_cached.images [image] [index];
+
+            levels.push_back ({
+                .mipmap = this->m_header->images [image] [index].get (),
+                .width = cached.width,
+                .height = cached.height,
+                .size = static_cast<GLsizei> (cached.data.size ()),
+                .data = cached.data.data (),
+                .decoded = nullptr,
+                .offset = -1,
+            });
+        }
+    }
+
+    this->m_fromCache = true;
+
+    return true;
+}
+
+void CTexture::decodeLevel (Mipmap& mipmap, Level& level) const {
+    level = {
+        .mipmap = &mipmap,
+        .width = static_cast<int> (mipmap.width),
+        .height = static_cast<int> (mipmap.height),
+        .size = mipmap.uncompressedSize,
+        .data = nullptr,
+        .decoded = nullptr,
+        .offset = -1,
+    };
+
+    {
+        const Debugging::LoadReport::Scope report (
+            Debugging::LoadReport::Stage_TextureDecompress, mipmap.uncompressedSize);
+
+        if (const auto offset = this->m_unpackOffsets.find (&mipmap); offset != this->m_unpackOffsets.end ()) {
+            TextureParser::decompress (mipmap, this->m_unpackData + offset->second);
+            level.offset = offset->second;
+            return;
+        }
+
+        TextureParser::decompress (mipmap);
+        level.data = mipmap.uncompressedData.get ();
+    }
+
+    if (this->m_header->freeImageFormat != FIF_UNKNOWN) {
+        const Debugging::LoadReport::Scope report (
+            Debugging::LoadReport::Stage_TextureDecode, mipmap.uncompressedSize);
+        int fileChannels;
+
+        level.data = level.decoded = stbi_load_from_memory (
+            reinterpret_cast <unsigned char*> (mipmap.uncompressedData.get ()),
+            mipmap.uncompressedSize,
+            &level.width,
+            &level.height,
+            &fileChannels,
+            4);
+
+        if (level.decoded == nullptr)
+            sLog.exception ("Cannot decode texture image: ", stbi_failure_reason ());
+    }
+
+    if (this->m_halvings == 0)
+        return;
+
+    const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_TextureDecode, level.size);
+
+    for (uint32_t halving = 0; halving < this->m_halvings; halving++)
+        this->halveLevel (level);
+}
+
+bool CTexture::upload (const std::chrono::steady_clock::time_point deadline, const bool untilDrawable) {
+    GLenum textureFormat = GL_RGBA;
 
-            level ++;
+    if (this->m_header->freeImageFormat == FIF_UNKNOWN) {
+        if (this->m_header->format == TextureFormat_R8)
+            textureFormat = GL_RED;
+        else if (this->m_header->format == TextureFormat_RG88)
+            textureFormat = GL_RG;
+    }
+
+    this->unmapUnpackBuffer ();
+
+    // red textures are 1-byte-per-pixel, so it's alignment has to be set manually
+    if (textureFormat == GL_RED)
+        glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+
+    if (this->m_unpackBuffer != GL_NONE)
+        glBindBuffer (GL_PIXEL_UNPACK_BUFFER, this->m_unpackBuffer);
+
+    if (this->m_uploaded == 0 && this->m_uploadOrder.empty ())
+        this->planUploads ();
+
+    bool first = true;
+
+    while (this->m_uploaded < this->m_uploadOrder.size ()) {
+        if (untilDrawable && this->m_drawable)
+            break;
+        if (!first && std::chrono::steady_clock::now () >= deadline)
+            break;
+
+        const auto [image, index] = this->m_uploadOrder [this->m_uploaded];
+        auto& level = this->m_levels [image] [index];
+        const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_TextureUpload, level.size);
+        const auto mipmapLevel = static_cast<GLint> (index);
+        const void* data = level.offset == -1 ? level.data : reinterpret_cast<const void*> (level.offset);
+
+        glBindTexture (GL_TEXTURE_2D, this->m_textureID [image]);
+
+        // the first image allocates the whole atlas, with nothing to read from
+        if (this->m_atlas && image == 0)
+            this->allocateAtlas (level, textureFormat);
+
+        // levels in the unpack buffer are read from the offset, the rest from memory
+        if (this->m_unpackBuffer != GL_NONE)
+            glBindBuffer (GL_PIXEL_UNPACK_BUFFER, level.offset == -1 ? GL_NONE : this->m_unpackBuffer);
+
+        if (this->m_atlas) {
+            this->uploadAtlasImage (level, image, textureFormat, data);
+        } else if (this->m_fromCache) {
+            glCompressedTexImage2D (
+                GL_TEXTURE_2D, mipmapLevel, this->m_compressedFormat, level.width, level.height, 0, level.size, data);
+        } else switch (this->m_internalFormat) {
+            case GL_RGBA8:
+            case GL_RG8:
+            case GL_R8:
+                // the driver compresses the pixels itself when asked for a compressed format
+                glTexImage2D (
+                    GL_TEXTURE_2D, mipmapLevel,
+                    this->m_compressedFormat != GL_NONE ? this->m_compressedFormat : this->m_internalFormat,
+                    level.width, level.height, 0, textureFormat, GL_UNSIGNED_BYTE, data);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                glCompressedTexImage2D (
+                    GL_TEXTURE_2D, mipmapLevel, this->m_internalFormat, level.width, level.height, 0, level.size,
+                    data);
+                break;
+            default: sLog.exception ("Cannot load texture, unknown format", this->m_header->format);
+        }
+
+        // levels come in from the smallest, sampling stays within the ones that are there
+        if (this->m_progressive)
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, mipmapLevel);
+
+        const uint64_t pixels = static_cast<uint64_t> (level.width) * level.height;
+        uint64_t memory;
+
+        if (this->m_fromCache)
+            memory = level.size;
+        else if (this->m_compressedFormat != GL_NONE)
+            // both BC7 and DXT5 take a byte per pixel
+            memory = pixels;
+        else if (this->m_internalFormat == GL_RGBA8)
+            memory = pixels * 4;
+        else if (this->m_internalFormat == GL_RG8)
+            memory = pixels * 2;
+        else if (this->m_internalFormat == GL_R8)
+            memory = pixels;
+        else
+            memory = level.size;
+
+        this->m_videoMemory += memory;
+
+        if (this->m_generateMipmaps) {
+            glGenerateMipmap (GL_TEXTURE_2D);
+            // the whole chain adds up to a third of the first level
+            this->m_videoMemory += memory / 3;
         }
+
+        // stbi_image buffer and the mipmap's own copy won't be used anymore, so free memory
+        if (level.mipmap->compressedData != nullptr)
+            this->m_releasedBytes += level.mipmap->compressedSize;
+        if (level.mipmap->uncompressedData != nullptr)
+            this->m_releasedBytes += level.mipmap->uncompressedSize;
+        if (level.decoded != nullptr)
+            this->m_releasedBytes += static_cast<uint64_t> (level.width) * level.height * 4;
+
+        stbi_image_free (level.decoded);
+        level.decoded = nullptr;
+        level.mipmap->compressedData.reset ();
+        level.mipmap->uncompressedData.reset ();
+
+        this->m_uploaded++;
+        first = false;
+
+        // the smallest level of every image comes first
+        if (this->m_uploaded >= (this->m_progressive ? this->m_levels.size () : this->m_uploadOrder.size ()))
+            this->m_drawable = true;
     }
+
+    if (textureFormat == GL_RED)
+        glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
+
+    if (this->m_unpackBuffer != GL_NONE)
+        glBindBuffer (GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+
+    sGPUResources.resize (this, this->m_videoMemory);
+
+    if (this->m_uploaded < this->m_uploadOrder.size ())
+        return false;
+
+    // the driver has its own copy by now
+    this->releaseUnpackBuffer ();
+    this->m_levels.clear ();
+    this->m_uploadOrder.clear ();
+    this->m_drawable = true;
+    this->m_cached = {};
+    this->m_ready = true;
+
+    return true;
+}
+
+void CTexture::discard () {
+    for (const auto& levels : this->m_levels)
+        for (const auto& level : levels)
+            stbi_image_free (level.decoded);
+
+    this->m_levels.clear ();
+    this->releaseUnpackBuffer ();
+}
+
+bool CTexture::isReady () const {
+    return this->m_ready;
+}
+
+bool CTexture::isDrawable () const {
+    return this->m_drawable;
+}
+
+GLuint CTexture::getSampler (const uint32_t flags) const {
+    return SamplerCache::get (this->m_samplerFlags | flags);
+}
+
+glm::vec2 CTexture::getImageMapping (const uint32_t imageIndex) const {
+    if (!this->m_atlas || imageIndex >= this->m_header->imageCount)
+        return {1.0f, 0.0f};
+
+    const float rows = static_cast<float> (this->m_header->imageCount);
+
+    return {1.0f / rows, static_cast<float> (imageIndex) / rows};
+}
+
+const Frame* CTexture::getFrameAt (const double time) const {
+    if (time == this->m_lastFrameTime)
+        return this->m_lastFrame;
+
+    // the first frame still showing at that time
+    const auto it = std::ranges::lower_bound (this->m_frameEnds, time);
+
+    this->m_lastFrameTime = time;
+    this->m_lastFrame = it == this->m_frameEnds.end ()
+        ? nullptr
+        : this->m_header->frames [std::distance (this->m_frameEnds.begin (), it)].get ();
+
+    return this->m_lastFrame;
+}
+
+uint64_t CTexture::getReleasedBytes () const {
+    return this->m_releasedBytes;
+}
+
+uint64_t CTexture::getVideoMemory () const {
+    return this->m_videoMemory;
+}
+
+bool CTexture::readBack (TextureCompressionCache::Entry& entry) const {
+    if (!this->m_ready || this->m_compressedFormat == GL_NONE || this->m_fromCache || this->m_cachePath.empty ())
+        return false;
+
+    entry.format = this->m_compressedFormat;
+    entry.images.clear ();
+
+    for (const auto& [index, mipmaps] : this->m_header->images) {
+        auto& levels = entry.images.emplace_back ();
+
+        glBindTexture (GL_TEXTURE_2D, this->m_textureID [index]);
+
+        for (size_t level = 0; level < mipmaps.size (); level++) {
+            const auto mipmapLevel = static_cast<GLint> (level);
+            GLint compressed = GL_FALSE;
+            GLint format = GL_NONE;
+            GLint size = 0;
+            auto& result = levels.emplace_back ();
+
+            glGetTexLevelParameteriv (GL_TEXTURE_2D, mipmapLevel, GL_TEXTURE_COMPRESSED, &compressed);
+            glGetTexLevelParameteriv (GL_TEXTURE_2D, mipmapLevel, GL_TEXTURE_INTERNAL_FORMAT, &format);
+            glGetTexLevelParameteriv (GL_TEXTURE_2D, mipmapLevel, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+            glGetTexLevelParameteriv (GL_TEXTURE_2D, mipmapLevel, GL_TEXTURE_WIDTH, &result.width);
+            glGetTexLevelParameteriv (GL_TEXTURE_2D, mipmapLevel, GL_TEXTURE_HEIGHT, &result.height);
+
+            // drivers are free to keep the texture uncompressed
+            if (compressed != GL_TRUE || static_cast<GLenum> (format) != this->m_compressedFormat || size <= 0)
+                return false;
+
+            result.data.resize (size);
+            glGetCompressedTexImage (GL_TEXTURE_2D, mipmapLevel, result.data.data ());
+        }
+    }
+
+    return true;
+}
+
+const std::filesystem::path& CTexture::getCachePath () const {
+    return this->m_cachePath;
+}
+
+GLuint CTexture::getPlaceholder () {
+    static const GLuint placeholder = [] {
+        constexpr uint8_t pixel [4] = {0, 0, 0, 0};
+        GLuint texture;
+
+        glGenTextures (1, &texture);
+        glBindTexture (GL_TEXTURE_2D, texture);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+
+#if !NDEBUG
+        glObjectLabel (GL_TEXTURE, texture, -1, "Texture placeholder");
+#endif /* DEBUG */
+
+        return texture;
+    } ();
+
+    return placeholder;
 }
 
 void CTexture::setupResolution () {
@@ -136,31 +831,42 @@ void CTexture::setupOpenGLParameters (const uint32_t textureID) const {
     // bind the texture to assign information to it
     glBindTexture (GL_TEXTURE_2D, this->m_textureID [textureID]);
 
-    // set mipmap levels
-    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, this->m_header->images [textureID].size () - 1);
+    const auto& mipmaps = this->m_header->images [textureID];
+    GLint maxLevel = static_cast<GLint> (mipmaps.size () - this->getFirstLevel (mipmaps)) - 1;
 
-    // setup texture wrapping and filtering
-    if (this->m_header->flags & TextureFlags_ClampUVs) {
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    } else {
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    }
+    // room for the levels glGenerateMipmap builds
+    if (this->m_generateMipmaps)
+        for (uint32_t size = std::max (mipmaps.front ()->width, mipmaps.front ()->height) >> this->m_halvings;
+             size > 1; size /= 2)
+            maxLevel++;
 
-    if (this->m_header->flags & TextureFlags_NoInterpolation) {
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-    } else {
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    // set mipmap levels, wrapping and filtering come from the SamplerCache
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+}
+
+bool CTexture::shouldGenerateMipmaps () const {
+    // generated levels would bleed into the neighbouring rows of an atlas, and the formats the driver
+    // compresses to can't be generated from
+    if (this->m_atlas || this->m_compressedFormat != GL_NONE)
+        return false;
+    if (this->m_internalFormat != GL_RGBA8 && this->m_internalFormat != GL_RG8 && this->m_internalFormat != GL_R8)
+        return false;
+
+    for (const auto& mipmaps : this->m_header->images | std::views::values) {
+        if (mipmaps.size () != 1)
+            return false;
+        if (std::max (mipmaps.front ()->width, mipmaps.front ()->height) < MIPMAP_MIN_SIZE)
+            return false;
     }
 
-    glTexParameterf (GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, 8.0f);
+    return !this->m_header->images.empty ();
 }
 
 GLuint CTexture::getTextureID (const uint32_t imageIndex) const {
+    if (!this->m_drawable)
+        return getPlaceholder ();
+
     // ensure we do not go out of bounds
     if (imageIndex >= this->m_header->imageCount)
         return this->m_textureID [0];
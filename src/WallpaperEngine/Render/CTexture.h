@@ -1,11 +1,17 @@
 #pragma once
 
+#include "TextureCompressionCache.h"
 #include "TextureProvider.h"
 #include "WallpaperEngine/Data/Assets/Texture.h"
 
 #include <GL/glew.h>
+#include <chrono>
+#include <filesystem>
 #include <glm/vec4.hpp>
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace WallpaperEngine::Render {
@@ -13,10 +19,89 @@ using namespace WallpaperEngine::Data::Assets;
 
 /**
  * A normal texture file in WallpaperEngine's format
+ *
+ * Streamed textures are created with their metadata only and render as a 1x1 transparent placeholder until
+ * decode () filled in the pixels (on any thread) and upload () handed them to OpenGL (on the render thread)
+ *
+ * Textures that ship a mipmap chain are uploaded from the smallest level up, with GL_TEXTURE_BASE_LEVEL clamped
+ * to the biggest level uploaded so far, so they can be drawn blurry as soon as every image has its smallest level
+ * and sharpen over the following frames
+ *
+ * Mipmaps that are still LZ4 compressed when the texture is created are decompressed straight into a mapped
+ * pixel unpack buffer, so the only copy of the pixels besides the driver's is the one in that buffer. Either way
+ * the mipmap data in the header is freed once uploaded, only the metadata stays
+ *
+ * Compressed textures skip that buffer: the first time they're uploaded with the TextureCompressionCache's
+ * format and readBack () gets the driver's blocks to store, later times decode () takes the stored blocks instead
+ *
+ * Textures bigger than the GPU can take (or than the size limit given) are kept smaller in video memory: the levels
+ * over the limit of a mipmap chain are never decompressed, and single level images are halved on decode () until
+ * they fit. Their size and resolution stay the ones in the file, the UVs are the same at any level
  */
 class CTexture final : public TextureProvider {
   public:
-    explicit CTexture (TextureUniquePtr header);
+    /**
+     * @param header The parsed texture, its mipmaps can still be LZ4 compressed if streamed
+     * @param streamed If false the texture is decoded and uploaded right away
+     * @param compress If the texture should go through the TextureCompressionCache when eligible
+     * @param name What the texture is listed as in the GPUResources
+     * @param maxSize Largest side the texture may take in video memory, 0 for the GPU's limit only
+     */
+    explicit CTexture (
+        TextureUniquePtr header, bool streamed = false, bool compress = false, const std::string& name = "",
+        uint32_t maxSize = 0);
+    ~CTexture () override;
+
+    CTexture (const CTexture&) = delete;
+    CTexture& operator= (const CTexture&) = delete;
+
+    /**
+     * Decompresses the mipmaps and decodes the image formats into pixels OpenGL can take, no GL calls are made
+     * so this can run on a worker thread. The levels are spread over the JobPool
+     */
+    void decode ();
+    /**
+     * Uploads decoded levels to OpenGL until the deadline passes, at least one level is always uploaded
+     *
+     * @param deadline
+     * @param untilDrawable Stops once the texture can be drawn, even if it has bigger levels left
+     *
+     * @return If every level is uploaded and the texture is ready
+     */
+    bool upload (
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max (),
+        bool untilDrawable = false);
+    /**
+     * Drops whatever decode () left for a texture that won't be uploaded, it stays a placeholder
+     */
+    void discard ();
+    [[nodiscard]] bool isReady () const override;
+    /**
+     * @return If the texture has enough levels uploaded to be drawn instead of the placeholder, it's only ready
+     * once all of them are
+     */
+    [[nodiscard]] bool isDrawable () const;
+    /**
+     * Binary searches the frame timeline, every pass sampling the texture in a frame asks for the same time so the
+     * last answer is kept
+     */
+    [[nodiscard]] const Frame* getFrameAt (double time) const override;
+    [[nodiscard]] glm::vec2 getImageMapping (uint32_t imageIndex) const override;
+    [[nodiscard]] GLuint getSampler (uint32_t flags = 0) const override;
+    /** @return Bytes of pixel data freed from memory as the levels were uploaded */
+    [[nodiscard]] uint64_t getReleasedBytes () const;
+    /** @return Bytes of video memory the uploaded levels take */
+    [[nodiscard]] uint64_t getVideoMemory () const;
+    /**
+     * Reads back the blocks the driver compressed the texture to, once uploaded
+     *
+     * @param entry Filled in with the blocks of every level
+     *
+     * @return If the entry should be stored at getCachePath (), false if the texture was not compressed by the
+     * driver or already came from the cache
+     */
+    bool readBack (TextureCompressionCache::Entry& entry) const;
+    [[nodiscard]] const std::filesystem::path& getCachePath () const;
 
     [[nodiscard]] GLuint getTextureID (uint32_t imageIndex) const override;
     [[nodiscard]] uint32_t getTextureWidth (uint32_t imageIndex) const override;
@@ -34,6 +119,83 @@ class CTexture final : public TextureProvider {
     [[nodiscard]] float getSpritesheetDuration () const override;
 
   private:
+    /** smallest side a single level texture needs to get mipmaps generated, a 4K layer on a 1080p screen has them */
+    static constexpr uint32_t MIPMAP_MIN_SIZE = 2048;
+
+    /**
+     * A mipmap ready to be handed to OpenGL
+     */
+    struct Level {
+        Mipmap* mipmap;
+        int width;
+        int height;
+        GLsizei size;
+        const void* data;
+        /** pixels stb_image decoded data points to, freed once uploaded */
+        void* decoded;
+        /** where the level is in m_unpackBuffer, -1 if data is used instead */
+        GLintptr offset;
+    };
+
+    /**
+     * @return GL_MAX_TEXTURE_SIZE, only asked for once
+     */
+    static GLint getMaxTextureSize ();
+    /**
+     * Works out how many times the texture has to be halved to fit in the limit, and how many of those come from
+     * skipping levels of its mipmap chains
+     */
+    void setupReduction (uint32_t maxSize);
+    /**
+     * @return Index of the first mipmap of the chain that's uploaded, the ones before it are over the limit
+     */
+    [[nodiscard]] size_t getFirstLevel (const MipmapList& mipmaps) const;
+    /**
+     * Replaces the decoded pixels of the level with a box filtered copy of half its size
+     */
+    void halveLevel (Level& level) const;
+    /**
+     * @return If the images of an animated texture can be stacked in a single GL texture, they need to have the
+     * same size, no mipmaps and fit in GL_MAX_TEXTURE_SIZE
+     */
+    [[nodiscard]] bool canPackAtlas () const;
+    /** Allocates storage for every row of the atlas, sized after the given level */
+    void allocateAtlas (const Level& level, GLenum textureFormat) const;
+    /** Copies the level into the row of the given image */
+    void uploadAtlasImage (const Level& level, size_t image, GLenum textureFormat, const void* data) const;
+    /**
+     * Lays out the order upload () hands the levels to OpenGL in, image by image, or smallest level first
+     * for every image when progressive
+     */
+    void planUploads ();
+    /**
+     * Takes the levels from the TextureCompressionCache instead of decoding them
+     *
+     * @return If the cache had the texture
+     */
+    bool decodeCached ();
+    /**
+     * Decodes a single mipmap, safe to run for different levels at the same time
+     *
+     * @param mipmap
+     * @param level Filled in with the decoded level
+     */
+    void decodeLevel (Mipmap& mipmap, Level& level) const;
+    /**
+     * Maps a pixel unpack buffer big enough for every mipmap that's still LZ4 compressed
+     */
+    void mapUnpackBuffer ();
+    /**
+     * Unmaps the pixel unpack buffer before uploading from it, falls back to decompressing the levels in memory
+     * if the driver lost its contents while mapped
+     */
+    void unmapUnpackBuffer ();
+    void releaseUnpackBuffer ();
+
+    /**
+     * @return The texture shown while a streamed one is not uploaded yet, shared by all of them
+     */
+    static GLuint getPlaceholder ();
     /**
      * @return The texture header
      */
@@ -51,6 +213,11 @@ class CTexture final : public TextureProvider {
      * Prepares openGL parameters for loading texture data
      */
     void setupOpenGLParameters (const uint32_t textureID) const;
+    /**
+     * @return If the texture only ships its full size level but is big enough to be drawn much smaller, so
+     * OpenGL should build the rest of the chain once uploaded
+     */
+    [[nodiscard]] bool shouldGenerateMipmaps () const;
 
     /** The texture header */
     TextureUniquePtr m_header;
@@ -58,5 +225,45 @@ class CTexture final : public TextureProvider {
     GLuint* m_textureID = nullptr;
     /** Resolution vector of the texture */
     glm::vec4 m_resolution {};
+    /** Format OpenGL stores the texture in */
+    GLint m_internalFormat = GL_NONE;
+    /** Decoded levels of every image, emptied as they're uploaded */
+    std::vector<std::vector<Level>> m_levels = {};
+    /** Image and level of every upload, in the order upload () hands them to OpenGL */
+    std::vector<std::pair<size_t, size_t>> m_uploadOrder = {};
+    /** How many of m_uploadOrder are uploaded already */
+    size_t m_uploaded = 0;
+    /** the levels are uploaded smallest first so the texture is drawn before the biggest ones are in */
+    bool m_progressive = false;
+    bool m_drawable = false;
+    bool m_ready = false;
+    uint64_t m_releasedBytes = 0;
+    uint64_t m_videoMemory = 0;
+    /** time every frame of the animation ends at, from the start of it */
+    std::vector<double> m_frameEnds = {};
+    /** the images are stacked as rows of m_textureID [0] */
+    bool m_atlas = false;
+    /** the images have a single level and OpenGL builds the rest after uploading it */
+    bool m_generateMipmaps = false;
+    /** levels of every mipmap chain over the size limit, never uploaded */
+    uint32_t m_skippedLevels = 0;
+    /** times the first level uploaded still has to be halved on decode () to fit in the size limit */
+    uint32_t m_halvings = 0;
+    /** SamplerCache::Flags from the header */
+    uint32_t m_samplerFlags = 0;
+    mutable double m_lastFrameTime = -1.0;
+    mutable const Frame* m_lastFrame = nullptr;
+    /** format the driver compresses the texture to, GL_NONE to keep m_internalFormat */
+    GLenum m_compressedFormat = GL_NONE;
+    std::filesystem::path m_cachePath = {};
+    /** blocks from the cache, m_levels point into them until uploaded */
+    TextureCompressionCache::Entry m_cached = {};
+    bool m_fromCache = false;
+    /** pixel unpack buffer the compressed levels are decompressed into */
+    GLuint m_unpackBuffer = GL_NONE;
+    /** where m_unpackBuffer is mapped, nullptr once it's ready to be read by OpenGL */
+    char* m_unpackData = nullptr;
+    /** offset of every compressed mipmap in m_unpackBuffer */
+    std::map<const Mipmap*, GLintptr> m_unpackOffsets = {};
 };
 } // namespace WallpaperEngine::Assets
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "CWallpaper.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
 #include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/GPUResources.h"
+#include "WallpaperEngine/Render/TransientFBOPool.h"
 #include "WallpaperEngine/Render/Wallpapers/CScene.h"
 #include "WallpaperEngine/Render/Wallpapers/CVideo.h"
 #include "WallpaperEngine/Render/Wallpapers/CWeb.h"
@@ -9,6 +12,8 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <ranges>
+#include <utility>
 
 using namespace WallpaperEngine::Render;
 
@@ -21,7 +26,8 @@ CWallpaper::CWallpaper (
     FBOProvider (nullptr),
     m_wallpaperData (wallpaperData),
     m_audioContext (audioContext),
-    m_state (scalingMode, clampMode) {
+    m_state (scalingMode, clampMode),
+    m_outputEntry (context.getProfiler ().registerEntry ("output")) {
     // generate the VAO to stop opengl from complaining
     glGenVertexArrays (1, &this->m_vaoBuffer);
     glBindVertexArray (this->m_vaoBuffer);
@@ -41,10 +47,17 @@ CWallpaper::CWallpaper (
     glGenBuffers (1, &this->m_positionBuffer);
     glBindBuffer (GL_ARRAY_BUFFER, this->m_positionBuffer);
     glBufferData (GL_ARRAY_BUFFER, sizeof (position), position, GL_STATIC_DRAW);
+
+    if (context.getApp ().getContext ().settings.render.adaptiveFPS)
+        this->m_motionMeter = std::make_unique<MotionMeter> ();
 }
 
 CWallpaper::~CWallpaper () = default;
 
+float CWallpaper::getMotionFPS (const float limit) const {
+    return this->m_motionMeter == nullptr ? limit : this->m_motionMeter->getFPS (limit);
+}
+
 const AssetLocator& CWallpaper::getAssetLocator () const {
     return *this->m_wallpaperData.project.assetLocator;
 }
@@ -61,6 +74,10 @@ GLuint CWallpaper::getWallpaperTexture () const {
     return this->m_sceneFBO->getTextureID (0);
 }
 
+GLuint CWallpaper::getVertexArray () const {
+    return this->m_vaoBuffer;
+}
+
 void CWallpaper::setupShaders () {
     // reserve shaders in OpenGL
     const GLuint vertexShaderID = glCreateShader (GL_VERTEX_SHADER);
@@ -181,49 +198,110 @@ void CWallpaper::setDestinationFramebuffer (GLuint framebuffer) {
     this->m_destFramebuffer = framebuffer;
 }
 
-void CWallpaper::updateUVs (const glm::ivec4& viewport, const bool vflip) {
+bool CWallpaper::updateUVs (const glm::ivec4& viewport, const bool vflip) {
     // update UVs if something has changed, otherwise use old values
-    if (this->m_state.hasChanged (viewport, vflip, this->getWidth (), this->getHeight ())) {
-        // Update wallpaper state
-        this->m_state.updateState (viewport, vflip, this->getWidth (), this->getHeight ());
-    }
+    if (!this->m_state.hasChanged (viewport, vflip, this->getWidth (), this->getHeight ()))
+        return false;
+
+    // Update wallpaper state
+    this->m_state.updateState (viewport, vflip, this->getWidth (), this->getHeight ());
+    return true;
 }
 
-void CWallpaper::render (const glm::ivec4& viewport, const bool vflip) {
+const DirectOutput* CWallpaper::getDirectOutput () const {
+    return this->m_directOutput.has_value () ? &this->m_directOutput.value () : nullptr;
+}
+
+bool CWallpaper::canRenderToOutput () {
+    return false;
+}
+
+bool CWallpaper::render (const glm::ivec4& viewport, const bool vflip) {
 #if !NDEBUG
     glPushDebugGroup (GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Rendering scene");
 #endif /* !NDEBUG */
-    this->renderFrame (viewport);
+    bool changed = false;
+    // Update UVs coordinates according to scaling mode of this wallpaper
+    const bool uvsChanged = updateUVs (viewport, vflip);
+
+    // other viewports showing this wallpaper already rendered the scene for this frame
+    if (this->m_renderedFrame != this->getContext ().getFrame ()) {
+        // render targets and textures can still be created the first time something renders
+        GPUResources::Owner owner (this->m_wallpaperData.project.title);
+
+        // with nothing around the scene to fill, its last layer can take the place of the copy
+        if (this->m_state.coversViewport () && this->canRenderToOutput ()) {
+            this->m_directOutput = DirectOutput {
+                .framebuffer = this->m_destFramebuffer,
+                .viewport = viewport,
+                .transform = this->m_state.getOutputTransform (),
+            };
+        } else {
+            this->m_directOutput = std::nullopt;
+        }
+
+        this->m_renderedFrame = this->getContext ().getFrame ();
+        changed = this->renderFrame (viewport);
+
+        if (changed)
+            this->m_frameVersion++;
+
+        // the output has the last layer when it was drawn straight there, the framebuffer the whole frame otherwise
+        if (changed && this->m_motionMeter != nullptr) {
+            if (this->m_directOutput.has_value ()) {
+                this->m_motionMeter->sample (this->m_destFramebuffer, viewport);
+            } else {
+                const auto fbo = this->getFBO ();
+
+                this->m_motionMeter->sample (
+                    this->getWallpaperFramebuffer (),
+                    {0, 0, static_cast<int> (fbo->getRealWidth ()), static_cast<int> (fbo->getRealHeight ())});
+            }
+        }
+    }
 #if !NDEBUG
     glPopDebugGroup ();
-    glPushDebugGroup (GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Rendering scene to output");
 #endif /* !NDEBUG */
-    // Update UVs coordinates according to scaling mode of this wallpaper
-    updateUVs (viewport, vflip);
-    auto [ustart, uend, vstart, vend] = this->m_state.getTextureUVs ();
 
-    const GLfloat texCoords [] = {
-        ustart, vstart, uend, vstart, ustart, vend, ustart, vend, uend, vstart, uend, vend,
-    };
+    // the output already got the last layer, the framebuffer doesn't have it
+    if (this->m_directOutput.has_value ()) {
+        this->m_texCoordsOutdated = this->m_texCoordsOutdated || uvsChanged;
+        return changed || uvsChanged;
+    }
 
+#if !NDEBUG
+    glPushDebugGroup (GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Rendering scene to output");
+#endif /* !NDEBUG */
     glViewport (viewport.x, viewport.y, viewport.z, viewport.w);
 
     glBindFramebuffer (GL_FRAMEBUFFER, this->m_destFramebuffer);
 
-    glBindVertexArray (this->m_vaoBuffer);
+    RenderState& state = this->getContext ().getRenderState ();
+    GPUProfiler::Scope profile (this->getContext ().getProfiler (), this->m_outputEntry);
 
-    glDisable (GL_BLEND);
-    glDisable (GL_DEPTH_TEST);
-    glDisable (GL_CULL_FACE);
+    state.bindVertexArray (this->m_vaoBuffer);
+    state.setBlending (false);
+    state.setDepthTest (false);
+    state.setCullFace (false);
     // do not use any shader
-    glUseProgram (this->m_shader);
+    state.useProgram (this->m_shader);
     // activate scene texture
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture (GL_TEXTURE_2D, this->getWallpaperTexture ());
+    state.bindTexture (0, this->getWallpaperTexture ());
     // set uniforms and attribs
     glEnableVertexAttribArray (this->a_TexCoord);
     glBindBuffer (GL_ARRAY_BUFFER, this->m_texCoordBuffer);
-    glBufferData (GL_ARRAY_BUFFER, sizeof (texCoords), texCoords, GL_STATIC_DRAW);
+
+    // the buffer keeps the texcoords of the last frame, only rewrite them when the scaling changes
+    if (uvsChanged || std::exchange (this->m_texCoordsOutdated, false)) {
+        auto [ustart, uend, vstart, vend] = this->m_state.getTextureUVs ();
+
+        const GLfloat texCoords [] = {
+            ustart, vstart, uend, vstart, ustart, vend, ustart, vend, uend, vstart, uend, vend,
+        };
+
+        glBufferSubData (GL_ARRAY_BUFFER, 0, sizeof (texCoords), texCoords);
+    }
+
     glVertexAttribPointer (this->a_TexCoord, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
 
     glEnableVertexAttribArray (this->a_Position);
@@ -232,16 +310,42 @@ void CWallpaper::render (const glm::ivec4& viewport, const bool vflip) {
 
     glUniform1i (this->g_Texture0, 0);
     // write the framebuffer as is to the screen
-    glBindBuffer (GL_ARRAY_BUFFER, this->m_texCoordBuffer);
     glDrawArrays (GL_TRIANGLES, 0, 6);
+    this->getContext ().getStats ().addDraws (1);
 
 #if !NDEBUG
     glPopDebugGroup ();
 #endif /* !NDEBUG */
+
+    return changed || uvsChanged;
+}
+
+uint64_t CWallpaper::getFrameVersion () const {
+    return this->m_frameVersion;
 }
 
 void CWallpaper::setPause (bool newState) {}
 
+bool CWallpaper::load (const std::chrono::steady_clock::time_point deadline) {
+    GPUResources::Owner owner (this->m_wallpaperData.project.title);
+    // only the time counts, the wallpaper was counted when it was created
+    const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_Wallpaper, 0, 0);
+
+    return this->loadStep (deadline);
+}
+
+bool CWallpaper::loadStep (std::chrono::steady_clock::time_point deadline) {
+    return true;
+}
+
+void CWallpaper::requestRebuild () {
+    this->m_rebuildRequested = true;
+}
+
+bool CWallpaper::takeRebuildRequest () {
+    return std::exchange (this->m_rebuildRequested, false);
+}
+
 void CWallpaper::setupFramebuffers () {
     const uint32_t width = this->getWidth ();
     const uint32_t height = this->getHeight ();
@@ -263,11 +367,11 @@ const WallpaperState& CWallpaper::getState () const {
     return this->m_state;
 }
 
-std::shared_ptr<const CFBO> CWallpaper::findFBO (const std::string& name) const {
+std::shared_ptr<const CFBO> CWallpaper::findFBO (const Symbol name) const {
     const auto fbo = this->find (name);
 
     if (fbo == nullptr)
-        sLog.exception ("Cannot find FBO ", name);
+        sLog.exception ("Cannot find FBO ", name.str ());
 
     return fbo;
 }
@@ -276,25 +380,39 @@ std::shared_ptr<const CFBO> CWallpaper::getFBO () const {
     return this->m_sceneFBO;
 }
 
+uint64_t CWallpaper::getFramebufferBytes () const {
+    uint64_t result = 0;
+
+    for (const auto& fbo : this->m_fbos | std::views::values)
+        result += TransientFBOPool::getSize (*fbo);
+
+    return result;
+}
+
 std::unique_ptr<CWallpaper> CWallpaper::fromWallpaper (
     const Wallpaper& wallpaper, RenderContext& context, AudioContext& audioContext,
     WebBrowser::WebBrowserContext* browserContext, const WallpaperState::TextureUVsScaling& scalingMode,
-    const uint32_t& clampMode
+    const uint32_t& clampMode, const bool finish
 ) {
+    GPUResources::Owner owner (wallpaper.project.title);
+    const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_Wallpaper);
+    std::unique_ptr<CWallpaper> result = nullptr;
+
     if (wallpaper.is<Scene> ()) {
-        return std::make_unique <WallpaperEngine::Render::Wallpapers::CScene> (
+        result = std::make_unique <WallpaperEngine::Render::Wallpapers::CScene> (
             wallpaper, context, audioContext, scalingMode, clampMode);
-    }
-
-    if (wallpaper.is<Video> ()) {
-        return std::make_unique<WallpaperEngine::Render::Wallpapers::CVideo> (
+    } else if (wallpaper.is<Video> ()) {
+        result = std::make_unique<WallpaperEngine::Render::Wallpapers::CVideo> (
             wallpaper, context, audioContext, scalingMode, clampMode);
-    }
-
-    if (wallpaper.is<Web> ()) {
-        return std::make_unique<WallpaperEngine::Render::Wallpapers::CWeb> (
+    } else if (wallpaper.is<Web> ()) {
+        result = std::make_unique<WallpaperEngine::Render::Wallpapers::CWeb> (
             wallpaper, context, audioContext, *browserContext, scalingMode, clampMode);
+    } else {
+        sLog.exception ("Unsupported wallpaper type");
     }
 
-    sLog.exception ("Unsupported wallpaper type");
+    if (finish)
+        result->loadStep (std::chrono::steady_clock::time_point::max ());
+
+    return result;
 }
@@ -3,10 +3,14 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <chrono>
+#include <optional>
+
 #include "WallpaperEngine/Audio/AudioContext.h"
 
 #include "WallpaperEngine/Render/CFBO.h"
 #include "WallpaperEngine/Render/Helpers/ContextAware.h"
+#include "WallpaperEngine/Render/MotionMeter.h"
 #include "WallpaperEngine/Render/RenderContext.h"
 
 #include "WallpaperEngine/Data/Model/Wallpaper.h"
@@ -59,14 +63,43 @@ class CWallpaper : public Helpers::ContextAware, public FBOProvider {
 
     /**
      * Performs a render pass of the wallpaper
+     *
+     * The scene is only rendered on the first call of every RenderContext frame, later calls for other viewports
+     * showing the same wallpaper only scale the frame that's already there to their size
+     *
+     * @return If what ended up on the destination framebuffer differs from the previous call
+     */
+    bool render (const glm::ivec4& viewport, const bool vflip);
+
+    /**
+     * @return Increases every time the scene's framebuffer gets a new frame
      */
-    void render (const glm::ivec4& viewport, const bool vflip);
+    [[nodiscard]] uint64_t getFrameVersion () const;
 
     /**
      * Pause the renderer
      */
     virtual void setPause (bool newState);
 
+    /**
+     * Builds more of a wallpaper created by fromWallpaper () with finish set to false, it can only be rendered once
+     * this returned true
+     *
+     * @param deadline When to leave the rest for the next call, the step running by then is finished first
+     *
+     * @return If the wallpaper is completely built
+     */
+    bool load (std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * Asks for the wallpaper to be built again, used when a property changed something it can't follow on its own
+     */
+    void requestRebuild ();
+    /**
+     * @return If a rebuild was requested since the last call
+     */
+    [[nodiscard]] bool takeRebuildRequest ();
+
     /**
      * @return The container to resolve files for this wallpaper
      */
@@ -90,13 +123,17 @@ class CWallpaper : public Helpers::ContextAware, public FBOProvider {
      * @return The scene's texture
      */
     [[nodiscard]] virtual GLuint getWallpaperTexture () const;
+    /**
+     * @return The vertex array the wallpaper's passes set their attributes on
+     */
+    [[nodiscard]] GLuint getVertexArray () const;
     /**
      * Searches the FBO list for the given FBO
      *
      * @param name
      * @return
      */
-    [[nodiscard]] std::shared_ptr<const CFBO> findFBO (const std::string& name) const;
+    [[nodiscard]] std::shared_ptr<const CFBO> findFBO (Symbol name) const;
 
     /**
      * @return The main FBO of this wallpaper
@@ -105,8 +142,10 @@ class CWallpaper : public Helpers::ContextAware, public FBOProvider {
 
     /**
      * Updates the UVs coordinates if window/screen/vflip/projection has changed
+     *
+     * @return If the UVs had to be updated
      */
-    void updateUVs (const glm::ivec4& viewport, const bool vflip);
+    bool updateUVs (const glm::ivec4& viewport, const bool vflip);
 
     /**
      * Updates the destination framebuffer for this wallpaper
@@ -115,6 +154,11 @@ class CWallpaper : public Helpers::ContextAware, public FBOProvider {
      */
     void setDestinationFramebuffer (GLuint framebuffer);
 
+    /**
+     * @return Where the last layer goes this frame, nullptr if the whole scene is copied to the output
+     */
+    [[nodiscard]] const DirectOutput* getDirectOutput () const;
+
     /**
      * @return The width of this wallpaper
      */
@@ -125,6 +169,18 @@ class CWallpaper : public Helpers::ContextAware, public FBOProvider {
      */
     [[nodiscard]] virtual int getHeight () const = 0;
 
+    /**
+     * @param limit The highest frame rate allowed
+     *
+     * @return Frames a second the wallpaper's motion needs with --adaptive-fps, the limit otherwise
+     */
+    [[nodiscard]] float getMotionFPS (float limit) const;
+
+    /**
+     * @return Video memory taken by the framebuffers of this wallpaper
+     */
+    [[nodiscard]] virtual uint64_t getFramebufferBytes () const;
+
     /**
      * Creates a new instance of CWallpaper based on the information provided by the read backgrounds
      *
@@ -132,13 +188,14 @@ class CWallpaper : public Helpers::ContextAware, public FBOProvider {
      * @param context
      * @param audioContext
      * @param scalingMode
+     * @param finish If false only the first part is built and load () has to do the rest
      *
      * @return
      */
     static std::unique_ptr<CWallpaper> fromWallpaper (
         const Wallpaper& wallpaper, RenderContext& context, AudioContext& audioContext,
         WebBrowser::WebBrowserContext* browserContext, const WallpaperState::TextureUVsScaling& scalingMode,
-        const uint32_t& clampMode);
+        const uint32_t& clampMode, bool finish = true);
 
   protected:
     CWallpaper (
@@ -146,10 +203,29 @@ class CWallpaper : public Helpers::ContextAware, public FBOProvider {
         AudioContext& audioContext, const WallpaperState::TextureUVsScaling& scalingMode,
         const uint32_t& clampMode);
 
+    /**
+     * Builds the next parts of the wallpaper, what the constructor left out
+     *
+     * @param deadline When to stop, time_point::max () to build everything
+     *
+     * @return If the wallpaper is completely built
+     */
+    virtual bool loadStep (std::chrono::steady_clock::time_point deadline);
+
     /**
      * Renders a frame of the wallpaper
+     *
+     * @return If the framebuffer changed, false means it still holds the previous frame
+     */
+    virtual bool renderFrame (const glm::ivec4& viewport) = 0;
+
+    /**
+     * Checks if the last thing rendered covers the whole frame on its own, so it can be drawn straight to the output
+     * instead of copying the framebuffer there afterwards
+     *
+     * @return If renderFrame () can draw its last layer to getDirectOutput ()
      */
-    virtual void renderFrame (const glm::ivec4& viewport) = 0;
+    [[nodiscard]] virtual bool canRenderToOutput ();
 
     /**
      * Setups OpenGL's framebuffers for ping-pong and scene rendering
@@ -183,5 +259,19 @@ class CWallpaper : public Helpers::ContextAware, public FBOProvider {
     AudioContext& m_audioContext;
     /** Current Wallpaper state */
     WallpaperState m_state;
+    /** RenderContext frame the scene was last rendered on, 0 if it never was */
+    uint64_t m_renderedFrame = 0;
+    /** Times renderFrame () produced a new frame */
+    uint64_t m_frameVersion = 0;
+    /** Set by requestRebuild () until the application takes it */
+    bool m_rebuildRequested = false;
+    /** Set while the last layer is drawn to the output instead of copying the framebuffer */
+    std::optional<DirectOutput> m_directOutput = std::nullopt;
+    /** The scaling changed while the copy wasn't used, its texture coordinates have to be written again */
+    bool m_texCoordsOutdated = false;
+    /** What the copy to the output is profiled as */
+    GPUProfiler::Entry m_outputEntry;
+    /** measures how fast the frames change with --adaptive-fps, nullptr otherwise */
+    std::unique_ptr<MotionMeter> m_motionMeter = nullptr;
 };
 } // namespace WallpaperEngine::Render
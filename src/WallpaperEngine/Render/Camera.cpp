@@ -14,6 +14,7 @@ Camera::Camera (Wallpapers::CScene& scene, const SceneData::Camera& camera) :
     // get the lookat position
     // TODO: ENSURE THIS IS ONLY USED WHEN NOT DOING AN ORTOGRAPHIC CAMERA AS IT THROWS OFF POINTS
     this->m_lookat = glm::lookAt (this->getEye (), this->getCenter (), this->getUp ());
+    this->m_viewProjection = this->m_projection * this->m_lookat;
 }
 
 Camera::~Camera () = default;
@@ -38,6 +39,14 @@ const glm::mat4& Camera::getLookAt () const {
     return this->m_lookat;
 }
 
+const glm::mat4& Camera::getViewProjection () const {
+    return this->m_viewProjection;
+}
+
+uint32_t Camera::getVersion () const {
+    return this->m_version;
+}
+
 bool Camera::isOrthogonal () const {
     return this->m_isOrthogonal;
 }
@@ -64,4 +73,7 @@ void Camera::setOrthogonalProjection (const float width, const float height) {
     this->m_projection = glm::translate (this->m_projection, this->getEye ());
     // update the orthogonal flag
     this->m_isOrthogonal = true;
+
+    this->m_viewProjection = this->m_projection * this->m_lookat;
+    this->m_version++;
 }
\ No newline at end of file
@@ -26,6 +26,14 @@ class Camera {
     [[nodiscard]] const glm::vec3& getUp () const;
     [[nodiscard]] const glm::mat4& getProjection () const;
     [[nodiscard]] const glm::mat4& getLookAt () const;
+    /**
+     * @return The projection and look-at matrices combined
+     */
+    [[nodiscard]] const glm::mat4& getViewProjection () const;
+    /**
+     * @return Changes every time the matrices do, objects keep their transforms until it does
+     */
+    [[nodiscard]] uint32_t getVersion () const;
     [[nodiscard]] Wallpapers::CScene& getScene () const;
     [[nodiscard]] bool isOrthogonal () const;
     [[nodiscard]] float getWidth () const;
@@ -37,6 +45,8 @@ class Camera {
     bool m_isOrthogonal = false;
     glm::mat4 m_projection = {};
     glm::mat4 m_lookat = {};
+    glm::mat4 m_viewProjection = {};
+    uint32_t m_version = 0;
     const SceneData::Camera& m_camera;
     Wallpapers::CScene& m_scene;
 };
@@ -0,0 +1,148 @@
+#include "Benchmark.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#include <sys/resource.h>
+
+using namespace WallpaperEngine::Render::Drivers;
+
+namespace {
+/** static initialization runs before main, so loading is measured from the very start of the process */
+const auto PROCESS_START = std::chrono::steady_clock::now ();
+
+double milliseconds (const std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli> (duration).count ();
+}
+
+/** Writes the mean, p50, p99 and max of the times as a JSON object */
+void writeStats (std::ostringstream& out, std::vector<double> times) {
+    if (times.empty ()) {
+        out << "null";
+        return;
+    }
+
+    std::ranges::sort (times);
+
+    const auto percentile = [&times] (const double p) {
+        return times [static_cast<size_t> (std::ceil (p * static_cast<double> (times.size ()))) - 1];
+    };
+
+    out << "{\"mean\":" << std::accumulate (times.begin (), times.end (), 0.0) / static_cast<double> (times.size ())
+        << ",\"p50\":" << percentile (0.5) << ",\"p99\":" << percentile (0.99) << ",\"max\":" << times.back ()
+        << '}';
+}
+} // namespace
+
+Benchmark::Benchmark (const uint32_t frames) :
+    m_frames (frames) {
+    this->m_cpuTimes.reserve (frames);
+    this->m_gpuTimes.reserve (frames);
+
+    glGenQueries (QUERIES, this->m_queries.data ());
+
+    this->sampleMemory ();
+    this->m_baseVideoMemory = this->m_peakVideoMemory;
+}
+
+Benchmark::~Benchmark () {
+    glDeleteQueries (QUERIES, this->m_queries.data ());
+}
+
+void Benchmark::beginFrame () {
+    if (this->isDone ())
+        return;
+
+    if (this->m_frame == 0) {
+        this->m_lastFrame = std::chrono::steady_clock::now ();
+        this->m_loadTime = milliseconds (this->m_lastFrame - PROCESS_START);
+    }
+
+    // the query is reused every QUERIES frames, that frame is long done by now
+    if (this->m_frame >= QUERIES)
+        this->collect (this->m_frame - QUERIES);
+
+    glBeginQuery (GL_TIME_ELAPSED, this->m_queries [this->m_frame % QUERIES]);
+}
+
+void Benchmark::endFrame () {
+    if (this->isDone ())
+        return;
+
+    glEndQuery (GL_TIME_ELAPSED);
+
+    const auto now = std::chrono::steady_clock::now ();
+
+    this->m_cpuTimes.push_back (milliseconds (now - this->m_lastFrame));
+    this->m_lastFrame = now;
+    this->m_frame++;
+
+    this->sampleMemory ();
+}
+
+bool Benchmark::isDone () const {
+    return this->m_frame >= this->m_frames;
+}
+
+void Benchmark::report (const std::chrono::steady_clock::duration shaderTime, const uint64_t textureBytes) {
+    if (this->m_reported)
+        return;
+
+    this->m_reported = true;
+
+    for (uint32_t frame = this->m_frame > QUERIES ? this->m_frame - QUERIES : 0; frame < this->m_frame; frame++)
+        this->collect (frame);
+
+    rusage usage = {};
+
+    getrusage (RUSAGE_SELF, &usage);
+
+    std::ostringstream out;
+
+    out << std::fixed << std::setprecision (3);
+    out << "{\"frames\":" << this->m_frame << ",\"loadMs\":" << this->m_loadTime
+        << ",\"shaderMs\":" << milliseconds (shaderTime)
+        << ",\"textureMB\":" << static_cast<double> (textureBytes) / (1024.0 * 1024.0) << ",\"cpuMs\":";
+    writeStats (out, this->m_cpuTimes);
+    out << ",\"gpuMs\":";
+    writeStats (out, this->m_gpuTimes);
+    // ru_maxrss is in KB on linux
+    out << ",\"peakRssMB\":" << static_cast<double> (usage.ru_maxrss) / 1024.0 << ",\"peakVramMB\":";
+
+    if (this->m_baseVideoMemory < 0)
+        out << "null";
+    else
+        out << static_cast<double> (this->m_peakVideoMemory - this->m_baseVideoMemory) / 1024.0;
+
+    out << '}';
+
+    sLog.out (out.str ());
+}
+
+void Benchmark::collect (const uint32_t frame) {
+    GLuint64 elapsed = 0;
+
+    // blocks if the GPU is still on it, which only happens at the very end or when it's far behind
+    glGetQueryObjectui64v (this->m_queries [frame % QUERIES], GL_QUERY_RESULT, &elapsed);
+
+    this->m_gpuTimes.push_back (static_cast<double> (elapsed) / 1000000.0);
+}
+
+void Benchmark::sampleMemory () {
+    if (!GLEW_NVX_gpu_memory_info) {
+        this->m_peakVideoMemory = -1;
+        return;
+    }
+
+    GLint total = 0;
+    GLint available = 0;
+
+    glGetIntegerv (GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &total);
+    glGetIntegerv (GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+
+    this->m_peakVideoMemory = std::max<int64_t> (this->m_peakVideoMemory, total - available);
+}
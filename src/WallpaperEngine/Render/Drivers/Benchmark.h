@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+
+namespace WallpaperEngine::Render::Drivers {
+/**
+ * Times the frames rendered with --benchmark and prints the results as JSON once they're done
+ *
+ * CPU time is the wall time between the end of two frames, so it covers the whole main loop. GPU time is taken with
+ * GL_TIME_ELAPSED queries read a few frames later, so measuring doesn't make the CPU wait for the GPU either
+ */
+class Benchmark {
+  public:
+    /**
+     * @param frames Frames to measure
+     */
+    explicit Benchmark (uint32_t frames);
+    ~Benchmark ();
+
+    Benchmark (const Benchmark&) = delete;
+    Benchmark& operator= (const Benchmark&) = delete;
+
+    /**
+     * Starts measuring a frame, the first one also marks the end of loading
+     */
+    void beginFrame ();
+    /**
+     * Stops measuring the frame started with beginFrame ()
+     */
+    void endFrame ();
+    /** @return If every frame was measured */
+    [[nodiscard]] bool isDone () const;
+    /**
+     * Waits for the GPU times still in flight and prints the results to stdout
+     *
+     * @param shaderTime Time spent building shader programs while loading
+     * @param textureBytes Video memory taken by the textures loaded
+     */
+    void report (std::chrono::steady_clock::duration shaderTime, uint64_t textureBytes);
+
+  private:
+    /** GL_TIME_ELAPSED queries in flight */
+    static constexpr uint32_t QUERIES = 4;
+
+    /** Reads the result of the query for the given frame into m_gpuTimes */
+    void collect (uint32_t frame);
+    /** Keeps the highest video memory use seen, only NVIDIA drivers report it */
+    void sampleMemory ();
+
+    uint32_t m_frames;
+    uint32_t m_frame = 0;
+    std::array<GLuint, QUERIES> m_queries = {};
+    std::chrono::steady_clock::time_point m_lastFrame = {};
+    double m_loadTime = 0.0;
+    /** milliseconds every frame took */
+    std::vector<double> m_cpuTimes = {};
+    std::vector<double> m_gpuTimes = {};
+    /** KB of video memory in use at most, -1 if the driver can't tell */
+    int64_t m_peakVideoMemory = 0;
+    /** video memory in use before loading, the driver reports the whole GPU's so the rest of the system counts too */
+    int64_t m_baseVideoMemory = -1;
+    bool m_reported = false;
+};
+} // namespace WallpaperEngine::Render::Drivers
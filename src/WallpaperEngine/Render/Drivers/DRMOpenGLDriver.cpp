@@ -0,0 +1,583 @@
+#include "DRMOpenGLDriver.h"
+#include "GPUSelection.h"
+#include "VideoFactories.h"
+#include "WallpaperEngine/Application/WallpaperApplication.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <poll.h>
+#include <ranges>
+#include <set>
+#include <tuple>
+#include <unistd.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+using namespace WallpaperEngine::Render::Drivers;
+
+namespace {
+void handlePageFlip (int fd, unsigned int sequence, unsigned int sec, unsigned int usec, void* data) {
+    static_cast<Output::DRMOutputViewport*> (data)->onPageFlip ();
+}
+
+/**
+ * @return The value of the named property of the object, 0 if it doesn't have it
+ */
+uint64_t getPropertyValue (const int fd, const uint32_t object, const uint32_t type, const char* name) {
+    drmModeObjectProperties* properties = drmModeObjectGetProperties (fd, object, type);
+    uint64_t result = 0;
+
+    if (properties == nullptr)
+        return 0;
+
+    for (uint32_t i = 0; i < properties->count_props; i++) {
+        drmModePropertyRes* property = drmModeGetProperty (fd, properties->props [i]);
+
+        if (property == nullptr)
+            continue;
+
+        const bool found = strcmp (property->name, name) == 0;
+
+        drmModeFreeProperty (property);
+
+        if (found) {
+            result = properties->prop_values [i];
+            break;
+        }
+    }
+
+    drmModeFreeObjectProperties (properties);
+
+    return result;
+}
+
+/**
+ * @return The connector's name the way the kernel and Wayland compositors give it, like HDMI-A-1
+ */
+std::string getConnectorName (const drmModeConnector* connector) {
+    const char* type = drmModeGetConnectorTypeName (connector->connector_type);
+
+    return std::string (type == nullptr ? "Unknown" : type) + "-" + std::to_string (connector->connector_type_id);
+}
+
+/**
+ * @return If the card has at least one screen connected to it
+ */
+bool anythingConnected (const int fd) {
+    drmModeRes* resources = drmModeGetResources (fd);
+    bool result = false;
+
+    if (resources == nullptr)
+        return false;
+
+    for (int i = 0; i < resources->count_connectors && !result; i++) {
+        drmModeConnector* connector = drmModeGetConnector (fd, resources->connectors [i]);
+
+        if (connector == nullptr)
+            continue;
+
+        result = connector->connection == DRM_MODE_CONNECTED && connector->count_modes > 0;
+        drmModeFreeConnector (connector);
+    }
+
+    drmModeFreeResources (resources);
+
+    return result;
+}
+} // namespace
+
+void DRMOpenGLDriver::openDevice () {
+    std::vector<std::filesystem::path> cards = {};
+    std::error_code ec;
+
+    for (const auto& entry : std::filesystem::directory_iterator ("/dev/dri", ec))
+        if (entry.path ().filename ().string ().starts_with ("card"))
+            cards.push_back (entry.path ());
+
+    std::ranges::sort (cards);
+
+    // the screens have to be connected to the selected GPU, there's no second device to render on here
+    if (const auto gpu = GPUSelection::selected (this->m_context.settings.render.gpu); gpu.has_value ())
+        cards = {gpu->card};
+
+    for (const auto& card : cards) {
+        const int fd = open (card.c_str (), O_RDWR | O_CLOEXEC);
+
+        if (fd == -1) {
+            sLog.debug ("Cannot open ", card, ": ", strerror (errno));
+            continue;
+        }
+
+        // primary planes are only visible with universal planes, and the commits need atomic modesetting
+        if (drmSetClientCap (fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0 ||
+            drmSetClientCap (fd, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
+            sLog.debug (card, " doesn't support atomic modesetting");
+            close (fd);
+            continue;
+        }
+
+        if (!anythingConnected (fd)) {
+            close (fd);
+            continue;
+        }
+
+        sLog.out ("Using ", card, " for output");
+        this->m_fd = fd;
+        return;
+    }
+
+    sLog.exception ("Cannot find a card with atomic modesetting and a screen connected to it");
+}
+
+void DRMOpenGLDriver::setupScreens () {
+    drmModeRes* resources = drmModeGetResources (this->m_fd);
+    drmModePlaneRes* planes = drmModeGetPlaneResources (this->m_fd);
+    std::set<uint32_t> usedCrtcs = {};
+    std::set<uint32_t> usedPlanes = {};
+    std::vector<std::string> detected = {};
+
+    if (resources == nullptr || planes == nullptr)
+        sLog.exception ("Cannot get the resources of the card");
+
+    for (int i = 0; i < resources->count_connectors; i++) {
+        drmModeConnector* connector = drmModeGetConnector (this->m_fd, resources->connectors [i]);
+
+        if (connector == nullptr)
+            continue;
+
+        if (connector->connection != DRM_MODE_CONNECTED || connector->count_modes == 0) {
+            drmModeFreeConnector (connector);
+            continue;
+        }
+
+        const std::string name = getConnectorName (connector);
+
+        detected.push_back (name);
+
+        if (!this->m_context.settings.general.screenBackgrounds.contains (name)) {
+            drmModeFreeConnector (connector);
+            continue;
+        }
+
+        // the mode the screen prefers, usually its native resolution
+        const drmModeModeInfo* mode = &connector->modes [0];
+
+        for (int m = 0; m < connector->count_modes; m++) {
+            if (connector->modes [m].type & DRM_MODE_TYPE_PREFERRED) {
+                mode = &connector->modes [m];
+                break;
+            }
+        }
+
+        // any CRTC one of the encoders can drive that's not taken by another screen yet
+        int crtcIndex = -1;
+
+        for (int e = 0; e < connector->count_encoders && crtcIndex == -1; e++) {
+            drmModeEncoder* encoder = drmModeGetEncoder (this->m_fd, connector->encoders [e]);
+
+            if (encoder == nullptr)
+                continue;
+
+            for (int c = 0; c < resources->count_crtcs; c++) {
+                if ((encoder->possible_crtcs & (1 << c)) && !usedCrtcs.contains (resources->crtcs [c])) {
+                    crtcIndex = c;
+                    break;
+                }
+            }
+
+            drmModeFreeEncoder (encoder);
+        }
+
+        uint32_t plane = 0;
+
+        for (uint32_t p = 0; p < planes->count_planes && crtcIndex != -1 && plane == 0; p++) {
+            drmModePlane* candidate = drmModeGetPlane (this->m_fd, planes->planes [p]);
+
+            if (candidate == nullptr)
+                continue;
+
+            if ((candidate->possible_crtcs & (1 << crtcIndex)) && !usedPlanes.contains (candidate->plane_id) &&
+                getPropertyValue (this->m_fd, candidate->plane_id, DRM_MODE_OBJECT_PLANE, "type") ==
+                    DRM_PLANE_TYPE_PRIMARY)
+                plane = candidate->plane_id;
+
+            drmModeFreePlane (candidate);
+        }
+
+        if (crtcIndex == -1 || plane == 0) {
+            sLog.error ("No CRTC or plane left to drive ", name, ", skipping it");
+            drmModeFreeConnector (connector);
+            continue;
+        }
+
+        const uint32_t crtc = resources->crtcs [crtcIndex];
+
+        usedCrtcs.insert (crtc);
+        usedPlanes.insert (plane);
+
+        sLog.out ("Showing ", name, " at ", mode->hdisplay, "x", mode->vdisplay, "@", mode->vrefresh, "Hz");
+
+        this->m_screens.push_back (new Output::DRMOutputViewport (
+            this, name, connector->connector_id, crtc, plane, *mode));
+
+        drmModeFreeConnector (connector);
+    }
+
+    drmModeFreePlaneResources (planes);
+    drmModeFreeResources (resources);
+
+    if (this->m_screens.empty ()) {
+        sLog.error ("No outputs could be initialized, please check the parameters and try again");
+        sLog.error ("Detected outputs:");
+
+        for (const auto& name : detected) {
+            sLog.error ("  ", name);
+        }
+
+        sLog.error ("Requested: ");
+
+        for (const auto& name : this->m_context.settings.general.screenBackgrounds | std::views::keys) {
+            sLog.error ("  ", name);
+        }
+
+        sLog.exception ("Cannot continue...");
+    }
+}
+
+void DRMOpenGLDriver::initEGL () {
+    const char* CLIENT_EXTENSIONS = eglQueryString (EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!CLIENT_EXTENSIONS)
+        sLog.exception ("Failed to query EGL Extensions");
+
+    const auto CLIENTEXTENSIONS = std::string (CLIENT_EXTENSIONS);
+
+    if (CLIENTEXTENSIONS.find ("EGL_EXT_platform_base") == std::string::npos)
+        sLog.exception ("EGL_EXT_platform_base not supported by EGL!");
+
+    if (CLIENTEXTENSIONS.find ("EGL_KHR_platform_gbm") == std::string::npos &&
+        CLIENTEXTENSIONS.find ("EGL_MESA_platform_gbm") == std::string::npos)
+        sLog.exception ("EGL_KHR_platform_gbm not supported by EGL!");
+
+    const auto eglGetPlatformDisplayEXT =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC> (eglGetProcAddress ("eglGetPlatformDisplayEXT"));
+    m_eglContext.eglCreatePlatformWindowSurfaceEXT = reinterpret_cast<PFNEGLCREATEPLATFORMWINDOWSURFACEEXTPROC> (
+        eglGetProcAddress ("eglCreatePlatformWindowSurfaceEXT"));
+
+    if (!eglGetPlatformDisplayEXT || !m_eglContext.eglCreatePlatformWindowSurfaceEXT)
+        sLog.exception ("EGL did not return EXT proc pointers!");
+
+    m_eglContext.display = eglGetPlatformDisplayEXT (EGL_PLATFORM_GBM_KHR, this->m_gbm, nullptr);
+
+    if (m_eglContext.display == EGL_NO_DISPLAY) {
+        this->finishEGL ();
+        sLog.exception ("eglGetPlatformDisplayEXT failed!");
+    }
+
+    if (!eglInitialize (m_eglContext.display, nullptr, nullptr)) {
+        this->finishEGL ();
+        sLog.exception ("eglInitialize failed!");
+    }
+
+    const auto CLIENTEXTENSIONSPOSTINIT = std::string (eglQueryString (m_eglContext.display, EGL_EXTENSIONS));
+
+    if (CLIENTEXTENSIONSPOSTINIT.find ("EGL_KHR_create_context") == std::string::npos) {
+        this->finishEGL ();
+        sLog.exception ("EGL_KHR_create_context not supported!");
+    }
+
+    EGLint matchedConfigs = 0;
+    const EGLint CONFIG_ATTRIBUTES [] = {
+        EGL_SURFACE_TYPE, EGL_WINDOW_BIT, EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 0,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE,
+    };
+
+    if (!eglChooseConfig (m_eglContext.display, CONFIG_ATTRIBUTES, nullptr, 0, &matchedConfigs) ||
+        matchedConfigs == 0) {
+        this->finishEGL ();
+        sLog.exception ("eglChooseConfig failed! (matched 0 configs)");
+    }
+
+    std::vector<EGLConfig> configs (matchedConfigs);
+
+    eglChooseConfig (m_eglContext.display, CONFIG_ATTRIBUTES, configs.data (), matchedConfigs, &matchedConfigs);
+
+    // the surfaces are created as XRGB8888, the config has to render in that same format
+    for (const auto& config : configs) {
+        EGLint format = 0;
+
+        if (eglGetConfigAttrib (m_eglContext.display, config, EGL_NATIVE_VISUAL_ID, &format) &&
+            static_cast<uint32_t> (format) == GBM_FORMAT_XRGB8888) {
+            m_eglContext.config = config;
+            break;
+        }
+    }
+
+    if (m_eglContext.config == nullptr) {
+        this->finishEGL ();
+        sLog.exception ("eglChooseConfig failed! (no XRGB8888 config)");
+    }
+
+    if (!eglBindAPI (EGL_OPENGL_API)) {
+        this->finishEGL ();
+        sLog.exception ("eglBindAPI failed!");
+    }
+
+    const EGLint CONTEXT_ATTRIBUTES [] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR,
+        3,
+        EGL_CONTEXT_MINOR_VERSION_KHR,
+        3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR,
+        EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE,
+    };
+
+    m_eglContext.context =
+        eglCreateContext (m_eglContext.display, m_eglContext.config, EGL_NO_CONTEXT, CONTEXT_ATTRIBUTES);
+
+    if (m_eglContext.context == EGL_NO_CONTEXT) {
+        this->finishEGL ();
+        sLog.error ("eglCreateContext error " + std::to_string (eglGetError ()));
+        sLog.exception ("eglCreateContext failed!");
+    }
+}
+
+void DRMOpenGLDriver::finishEGL () const {
+    eglMakeCurrent (EGL_NO_DISPLAY, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_eglContext.display)
+        eglTerminate (m_eglContext.display);
+    eglReleaseThread ();
+}
+
+DRMOpenGLDriver::DRMOpenGLDriver (ApplicationContext& context, WallpaperApplication& app) :
+    VideoDriver (app, m_mouseInput),
+    m_output (context, *this),
+    m_context (context) {
+    this->openDevice ();
+
+    this->m_gbm = gbm_create_device (this->m_fd);
+
+    if (this->m_gbm == nullptr)
+        sLog.exception ("Cannot create the GBM device");
+
+    this->initEGL ();
+    this->setupScreens ();
+
+    if (pipe2 (this->m_wakeup, O_CLOEXEC | O_NONBLOCK) == -1)
+        sLog.error ("Cannot create the wakeup pipe, new video and web frames wait for the idle check: ",
+                    strerror (errno));
+
+    for (const auto& screen : this->m_screens)
+        screen->setup ();
+
+    this->m_output.reset ();
+
+    if (const GLenum result = glewInit (); result != GLEW_OK)
+        sLog.error ("Failed to initialize GLEW: ", glewGetErrorString (result));
+}
+
+DRMOpenGLDriver::~DRMOpenGLDriver () {
+    // the screens go back to what they showed before, and need the EGL display to release their surfaces
+    for (const auto& screen : this->m_screens)
+        delete screen;
+
+    this->m_screens.clear ();
+
+    // stop EGL
+    eglMakeCurrent (EGL_NO_DISPLAY, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (m_eglContext.context != EGL_NO_CONTEXT)
+        eglDestroyContext (m_eglContext.display, m_eglContext.context);
+
+    if (m_eglContext.display != EGL_NO_DISPLAY)
+        eglTerminate (m_eglContext.display);
+
+    eglReleaseThread ();
+
+    if (this->m_gbm != nullptr)
+        gbm_device_destroy (this->m_gbm);
+
+    if (this->m_fd != -1)
+        close (this->m_fd);
+
+    for (const int fd : this->m_wakeup) {
+        if (fd != -1)
+            close (fd);
+    }
+}
+
+void DRMOpenGLDriver::dispatchEventQueue () {
+    TRACE_SCOPE ("DRMOpenGLDriver::dispatchEventQueue");
+
+    const float now = this->getRenderTime ();
+    float wait = -1.0f;
+
+    // every screen is paced on its own, only block on the card until the first one is due
+    for (const auto& screen : this->m_screens) {
+        float due;
+
+        if (screen->frameRequested) {
+            due = std::max (screen->nextFrame - now, 0.0f);
+        } else if (screen->idle) {
+            // idle screens didn't flip anything, check on them every now and then
+            due = std::max (screen->nextFrame - now, IDLE_WAKEUP_TIME);
+        } else {
+            // waiting on the page flip
+            continue;
+        }
+
+        wait = wait < 0.0f ? due : std::min (wait, due);
+    }
+
+    pollfd fds [2] = {
+        {.fd = this->m_fd, .events = POLLIN, .revents = 0},
+        {.fd = this->m_wakeup [0], .events = POLLIN, .revents = 0},
+    };
+
+    if (poll (fds, 2, wait < 0.0f ? -1 : static_cast<int> (std::ceil (wait * 1000))) > 0) {
+        if (fds [0].revents & (POLLERR | POLLHUP))
+            m_requestedExit = true;
+
+        if (fds [0].revents & POLLIN) {
+            drmEventContext events = {
+                .version = 2,
+                .page_flip_handler = handlePageFlip,
+            };
+
+            if (drmHandleEvent (this->m_fd, &events) != 0)
+                m_requestedExit = true;
+        }
+    }
+
+    if (fds [1].revents & POLLIN) {
+        char buffer [64];
+
+        while (read (this->m_wakeup [0], buffer, sizeof (buffer)) > 0) {}
+
+        // idle screens have no flip pending, they're drawn as soon as their FPS limit allows
+        for (const auto& screen : this->m_screens) {
+            if (screen->idle)
+                screen->frameRequested = true;
+        }
+    }
+
+    this->renderScreens ();
+
+    m_frameCounter++;
+}
+
+void DRMOpenGLDriver::renderScreens () {
+    const float now = this->getRenderTime ();
+
+    for (const auto& screen : this->m_screens) {
+        if (screen->rendering || (!screen->frameRequested && !screen->idle) || now < screen->nextFrame)
+            continue;
+
+        if (!this->getApp ().isVisible (screen->name)) {
+            screen->frameRequested = false;
+            screen->idle = true;
+            screen->nextFrame = now + IDLE_WAKEUP_TIME;
+            continue;
+        }
+
+        const float frameTime = this->getFrameTime (screen);
+
+        // keep the cadence unless the screen fell a whole frame behind, then start over from now
+        screen->nextFrame = now - screen->nextFrame > frameTime ? now + frameTime : screen->nextFrame + frameTime;
+        screen->frameRequested = false;
+        screen->rendering = true;
+        screen->idle = !this->getApp ().update (screen);
+        screen->rendering = false;
+    }
+}
+
+float DRMOpenGLDriver::getFrameTime (const Output::DRMOutputViewport* viewport) const {
+    const auto& fps = this->m_context.settings.general.screenFPS;
+    const auto cur = fps.find (viewport->name);
+
+    const auto limit = static_cast<float> (cur == fps.end () ? this->m_context.settings.render.maximumFPS : cur->second);
+
+    // slow wallpapers ask for less with --adaptive-fps
+    return 1.0f / std::max (
+        1.0f, this->getApp ().getRenderContext ().getMotionFPS (
+                  viewport->name, limit * this->m_context.state.power.fpsScale));
+}
+
+Output::Output& DRMOpenGLDriver::getOutput () {
+    return this->m_output;
+}
+
+float DRMOpenGLDriver::getRenderTime () const {
+    return static_cast<float> (std::chrono::duration_cast<std::chrono::microseconds> (
+                                   std::chrono::high_resolution_clock::now () - renderStart)
+                                   .count ()) /
+           1000000.0;
+}
+
+bool DRMOpenGLDriver::closeRequested () {
+    return this->m_requestedExit;
+}
+
+void DRMOpenGLDriver::resizeWindow (glm::ivec2 size) {}
+
+void DRMOpenGLDriver::resizeWindow (glm::ivec4 sizeandpos) {}
+
+void DRMOpenGLDriver::showWindow () {}
+
+void DRMOpenGLDriver::hideWindow () {}
+
+glm::ivec2 DRMOpenGLDriver::getFramebufferSize () const {
+    return glm::ivec2 {0, 0};
+}
+
+void DRMOpenGLDriver::wakeUp () const {
+    const char wakeup = 0;
+
+    // a full pipe already has a wakeup pending
+    std::ignore = write (this->m_wakeup [1], &wakeup, 1);
+}
+
+uint32_t DRMOpenGLDriver::getFrameCounter () const {
+    return m_frameCounter;
+}
+
+int DRMOpenGLDriver::getRefreshRate () const {
+    int refreshRate = 0;
+
+    for (const auto& screen : this->m_screens)
+        refreshRate = std::max (refreshRate, screen->refreshRate);
+
+    return refreshRate;
+}
+
+DRMOpenGLDriver::SEGLContext* DRMOpenGLDriver::getEGLContext () {
+    return &this->m_eglContext;
+}
+
+gbm_device* DRMOpenGLDriver::getGBMDevice () const {
+    return this->m_gbm;
+}
+
+int DRMOpenGLDriver::getFD () const {
+    return this->m_fd;
+}
+
+void* DRMOpenGLDriver::getProcAddress (const char* name) const {
+    return reinterpret_cast<void*> (eglGetProcAddress (name));
+}
+
+__attribute__((constructor)) void registerDRMOpenGL () {
+    // what logind sets for sessions started on a virtual terminal, with no window server running
+    sVideoFactories.registerDriver (
+        ApplicationContext::DESKTOP_BACKGROUND,
+        "tty",
+        [](ApplicationContext& context, WallpaperApplication& application) -> std::unique_ptr<VideoDriver> {
+            return std::make_unique <DRMOpenGLDriver> (context, application);
+        }
+    );
+}
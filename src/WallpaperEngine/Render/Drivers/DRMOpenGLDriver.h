@@ -0,0 +1,119 @@
+#pragma once
+
+#ifdef ENABLE_DRM
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/glew.h>
+#include <gbm.h>
+
+#include <chrono>
+#include <vector>
+
+#include "WallpaperEngine/Application/ApplicationContext.h"
+#include "WallpaperEngine/Application/WallpaperApplication.h"
+#include "WallpaperEngine/Input/Drivers/DRMMouseInput.h"
+#include "WallpaperEngine/Render/Drivers/Output/DRMOutput.h"
+#include "WallpaperEngine/Render/Drivers/Output/DRMOutputViewport.h"
+#include "WallpaperEngine/Render/Drivers/VideoDriver.h"
+
+namespace WallpaperEngine::Application {
+class ApplicationContext;
+class WallpaperApplication;
+} // namespace WallpaperEngine::Application
+
+namespace WallpaperEngine::Render::Drivers {
+using namespace WallpaperEngine::Application;
+using namespace WallpaperEngine::Input::Drivers;
+
+namespace Output {
+class DRMOutputViewport;
+class DRMOutput;
+} // namespace Output
+
+/**
+ * Renders straight to the screens through DRM/KMS, for machines that run without X11 or a Wayland compositor
+ *
+ * Every connector showing a background gets a GBM surface the EGL context renders into, and the buffer that
+ * comes out of eglSwapBuffers is put on the CRTC's primary plane with an atomic commit. There's no compositor
+ * copying the frame around and nothing is read back, the plane scans out the same buffer GL drew to.
+ *
+ * Screens are paced like on Wayland: the page flip event that comes with the commit plays the role of the frame
+ * callback, so no screen renders faster than its refresh rate or queues more than one frame, and the FPS limit
+ * is applied on top of that per screen
+ */
+class DRMOpenGLDriver final : public VideoDriver {
+    friend class Output::DRMOutput;
+
+  public:
+    struct SEGLContext {
+        EGLDisplay display = EGL_NO_DISPLAY;
+        EGLConfig config = nullptr;
+        EGLContext context = EGL_NO_CONTEXT;
+        /** surface bound to the context right now, rebinding the same one still costs a flush on some drivers */
+        EGLSurface current = EGL_NO_SURFACE;
+        PFNEGLCREATEPLATFORMWINDOWSURFACEEXTPROC eglCreatePlatformWindowSurfaceEXT = nullptr;
+    };
+
+    explicit DRMOpenGLDriver (ApplicationContext& context, WallpaperApplication& app);
+    ~DRMOpenGLDriver () override;
+
+    [[nodiscard]] Output::Output& getOutput () override;
+    float getRenderTime () const override;
+    bool closeRequested () override;
+    void resizeWindow (glm::ivec2 size) override;
+    void resizeWindow (glm::ivec4 sizeandpos) override;
+    void showWindow () override;
+    void hideWindow () override;
+    glm::ivec2 getFramebufferSize () const override;
+    uint32_t getFrameCounter () const override;
+    int getRefreshRate () const override;
+    void wakeUp () const override;
+    void dispatchEventQueue () override;
+    [[nodiscard]] void* getProcAddress (const char* name) const override;
+
+    [[nodiscard]] SEGLContext* getEGLContext ();
+    [[nodiscard]] gbm_device* getGBMDevice () const;
+    [[nodiscard]] int getFD () const;
+
+    /** Screens that are showing a background */
+    std::vector<Output::DRMOutputViewport*> m_screens = {};
+
+  private:
+    /** The output used by the driver */
+    Output::DRMOutput m_output;
+    SEGLContext m_eglContext = {};
+    /** the card the screens are connected to */
+    int m_fd = -1;
+    gbm_device* m_gbm = nullptr;
+    mutable bool m_requestedExit = false;
+    /** written to by wakeUp (), polled along with the card */
+    int m_wakeup [2] = {-1, -1};
+
+    /**
+     * Opens the first card that can do atomic modesetting and has something connected
+     */
+    void openDevice ();
+    /**
+     * Creates a viewport for every connected screen a background was requested for
+     */
+    void setupScreens ();
+    void initEGL ();
+    void finishEGL () const;
+    /**
+     * @return Minimum time between two frames on the given screen
+     */
+    [[nodiscard]] float getFrameTime (const Output::DRMOutputViewport* viewport) const;
+    /**
+     * Renders the screens that are due, the rest keep waiting on their page flip or FPS limit
+     */
+    void renderScreens ();
+
+    uint32_t m_frameCounter = 0;
+    ApplicationContext& m_context;
+    DRMMouseInput m_mouseInput;
+
+    std::chrono::high_resolution_clock::time_point renderStart = std::chrono::high_resolution_clock::now ();
+};
+} // namespace WallpaperEngine::Render::Drivers
+#endif /* ENABLE_DRM */
@@ -1,5 +1,7 @@
 #include "FullScreenDetector.h"
 
+#include <unistd.h>
+
 using namespace WallpaperEngine;
 using namespace WallpaperEngine::Render::Drivers::Detectors;
 
@@ -14,4 +16,16 @@ bool FullScreenDetector::anythingFullscreen () const {
     return false;
 }
 
+bool FullScreenDetector::isFullscreen (const std::string& output) const {
+    return this->anythingFullscreen ();
+}
+
+bool FullScreenDetector::isVisible (const std::string& output) const {
+    return !this->isFullscreen (output);
+}
+
+void FullScreenDetector::waitForChange (float timeout) const {
+    usleep (static_cast<useconds_t> (timeout * 1000000));
+}
+
 void FullScreenDetector::reset () {}
\ No newline at end of file
@@ -12,6 +12,26 @@ class FullScreenDetector {
      * @return If anything is fullscreen
      */
     [[nodiscard]] virtual bool anythingFullscreen () const;
+    /**
+     * @param output Name of the output
+     *
+     * @return If something fullscreen covers the given output, detectors that can't tell outputs apart check for
+     *         anything fullscreen instead
+     */
+    [[nodiscard]] virtual bool isFullscreen (const std::string& output) const;
+    /**
+     * @param output Name of the output
+     *
+     * @return If the background on the output can be seen at all, it's not when something fullscreen or maximized
+     *         covers it or the output is off
+     */
+    [[nodiscard]] virtual bool isVisible (const std::string& output) const;
+    /**
+     * Blocks until the fullscreen state might have changed, detectors that can't be notified just sleep
+     *
+     * @param timeout Maximum seconds to wait for
+     */
+    virtual void waitForChange (float timeout) const;
     /**
      * Restarts the fullscreen detector, specially useful if there's any resources tied to the output driver
      */
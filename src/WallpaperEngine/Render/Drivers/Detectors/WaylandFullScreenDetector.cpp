@@ -4,11 +4,27 @@
 #include "WallpaperEngine/Render/Drivers/VideoFactories.h"
 #include "wlr-foreign-toplevel-management-unstable-v1-protocol.h"
 #include <cstring>
+#include <poll.h>
 #include <string>
 #include <string_view>
+#include <wayland-client.h>
 
 namespace WallpaperEngine::Render::Drivers::Detectors {
 
+struct FullscreenState {
+    bool pending = false;
+    bool current = false;
+    bool pendingActivated = false;
+    bool currentActivated = false;
+    /** maximized and not minimized, so it covers the wallpaper on its outputs */
+    bool pendingMaximized = false;
+    bool currentMaximized = false;
+    std::string appId {};
+    /** outputs the toplevel is shown on */
+    std::set<wl_output*> outputs {};
+    WallpaperEngine::Render::Drivers::Detectors::WaylandFullscreenDetectorCallbackData* const data;
+};
+
 namespace {
 
 bool icontains (std::string_view haystack, std::string_view needle) {
@@ -39,15 +55,6 @@ bool icontains (std::string_view haystack, std::string_view needle) {
     return false;
 }
 
-struct FullscreenState {
-    bool pending = false;
-    bool current = false;
-    bool pendingActivated = false;
-    bool currentActivated = false;
-    std::string appId {};
-    WallpaperEngine::Render::Drivers::Detectors::WaylandFullscreenDetectorCallbackData* const data;
-};
-
 void toplevelHandleTitle (void*, struct zwlr_foreign_toplevel_handle_v1*, const char*) {}
 
 void toplevelHandleAppId (void* data, struct zwlr_foreign_toplevel_handle_v1*, const char* appId) {
@@ -56,9 +63,13 @@ void toplevelHandleAppId (void* data, struct zwlr_foreign_toplevel_handle_v1*, c
         state->appId = appId;
 }
 
-void toplevelHandleOutputEnter (void*, struct zwlr_foreign_toplevel_handle_v1*, struct wl_output*) {}
+void toplevelHandleOutputEnter (void* data, struct zwlr_foreign_toplevel_handle_v1*, struct wl_output* output) {
+    static_cast<FullscreenState*> (data)->outputs.insert (output);
+}
 
-void toplevelHandleOutputLeave (void*, struct zwlr_foreign_toplevel_handle_v1*, struct wl_output*) {}
+void toplevelHandleOutputLeave (void* data, struct zwlr_foreign_toplevel_handle_v1*, struct wl_output* output) {
+    static_cast<FullscreenState*> (data)->outputs.erase (output);
+}
 
 void toplevelHandleParent (void*, struct zwlr_foreign_toplevel_handle_v1*, struct zwlr_foreign_toplevel_handle_v1*) {}
 
@@ -68,13 +79,22 @@ void toplevelHandleState (void* data, struct zwlr_foreign_toplevel_handle_v1*, s
 
     toplevel->pending = false;
     toplevel->pendingActivated = false;
+    toplevel->pendingMaximized = false;
+
+    bool minimized = false;
 
     for (auto it = begin; it < begin + state->size / sizeof (uint32_t); ++it) {
         if (*it == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_FULLSCREEN)
             toplevel->pending = true;
         if (*it == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED)
             toplevel->pendingActivated = true;
+        if (*it == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MAXIMIZED)
+            toplevel->pendingMaximized = true;
+        if (*it == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MINIMIZED)
+            minimized = true;
     }
+
+    toplevel->pendingMaximized = toplevel->pendingMaximized && !minimized;
 }
 
 bool isRelevant (
@@ -131,6 +151,7 @@ void toplevelHandleDone (void* data, struct zwlr_foreign_toplevel_handle_v1* han
 
     toplevel->current = toplevel->pending;
     toplevel->currentActivated = toplevel->pendingActivated;
+    toplevel->currentMaximized = toplevel->pendingMaximized;
 }
 
 void toplevelHandleClosed (void* data, struct zwlr_foreign_toplevel_handle_v1* handle) {
@@ -147,6 +168,7 @@ void toplevelHandleClosed (void* data, struct zwlr_foreign_toplevel_handle_v1* h
         }
     }
 
+    toplevel->data->toplevels.erase (toplevel);
     zwlr_foreign_toplevel_handle_v1_destroy (handle);
     delete toplevel;
 }
@@ -170,9 +192,13 @@ void handleToplevel (void* data, struct zwlr_foreign_toplevel_manager_v1* manage
         .current = false,
         .pendingActivated = false,
         .currentActivated = false,
+        .pendingMaximized = false,
+        .currentMaximized = false,
         .appId = {},
+        .outputs = {},
         .data = cb,
     };
+    cb->toplevels.insert (toplevel);
     zwlr_foreign_toplevel_handle_v1_add_listener (handle, &toplevelHandleListener, toplevel);
 }
 
@@ -185,11 +211,43 @@ zwlr_foreign_toplevel_manager_v1_listener toplevelManagerListener = {
     .finished = handleFinished,
 };
 
+void outputGeometry (void*, wl_output*, int32_t, int32_t, int32_t, int32_t, int32_t, const char*, const char*,
+                     int32_t) {}
+
+void outputMode (void*, wl_output*, uint32_t, int32_t, int32_t, int32_t) {}
+
+void outputDone (void*, wl_output*) {}
+
+void outputScale (void*, wl_output*, int32_t) {}
+
+void outputName (void* data, wl_output* output, const char* name) {
+    const auto cb = static_cast<WallpaperEngine::Render::Drivers::Detectors::WaylandFullscreenDetectorCallbackData*> (data);
+
+    if (name)
+        cb->outputNames [output] = name;
+}
+
+void outputDescription (void*, wl_output*, const char*) {}
+
+constexpr wl_output_listener outputListener = {
+    .geometry = outputGeometry,
+    .mode = outputMode,
+    .done = outputDone,
+    .scale = outputScale,
+    .name = outputName,
+    .description = outputDescription,
+};
+
 }; // anonymous namespace
 
 void handleGlobal (void* data, struct wl_registry* registry, uint32_t name, const char* interface, uint32_t version) {
     const auto detector = static_cast<WaylandFullScreenDetector*> (data);
-    if (strcmp (interface, zwlr_foreign_toplevel_manager_v1_interface.name) == 0) {
+    // names are only sent from version 4 on, older outputs can't be matched to screens anyway
+    if (strcmp (interface, wl_output_interface.name) == 0 && version >= 4) {
+        const auto output = static_cast<wl_output*> (wl_registry_bind (registry, name, &wl_output_interface, 4));
+
+        wl_output_add_listener (output, &outputListener, &detector->m_callbackData);
+    } else if (strcmp (interface, zwlr_foreign_toplevel_manager_v1_interface.name) == 0) {
         detector->m_toplevelManager = static_cast<zwlr_foreign_toplevel_manager_v1*> (
             wl_registry_bind (registry, name, &zwlr_foreign_toplevel_manager_v1_interface, 3));
         if (detector->m_toplevelManager) {
@@ -234,10 +292,93 @@ bool WaylandFullScreenDetector::anythingFullscreen () const {
     if (!m_toplevelManager) {
         return false;
     }
-    wl_display_roundtrip (m_display);
+
+    // the count is kept up to date by the toplevel events, only the ones that already arrived have to be read
+    this->dispatchPending ();
+
     return m_fullscreenCount > 0;
 }
 
+bool WaylandFullScreenDetector::isFullscreen (const std::string& output) const {
+    if (!m_toplevelManager) {
+        return false;
+    }
+
+    this->dispatchPending ();
+
+    for (const auto toplevel : m_callbackData.toplevels) {
+        if (!isCurrentlyRelevant (*toplevel))
+            continue;
+
+        for (const auto wlOutput : toplevel->outputs) {
+            const auto cur = m_callbackData.outputNames.find (wlOutput);
+
+            if (cur != m_callbackData.outputNames.end () && cur->second == output)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+bool WaylandFullScreenDetector::isVisible (const std::string& output) const {
+    if (!m_toplevelManager) {
+        return true;
+    }
+
+    this->dispatchPending ();
+
+    const auto& ctx = this->getApplicationContext ();
+
+    for (const auto toplevel : m_callbackData.toplevels) {
+        // maximized windows go through the same rules as fullscreen ones, like the ignored app ids
+        const bool covers = isCurrentlyRelevant (*toplevel) ||
+            (ctx.settings.render.pauseOnMaximized &&
+             isRelevant (ctx, toplevel->currentMaximized, toplevel->currentActivated, toplevel->appId));
+
+        if (!covers)
+            continue;
+
+        for (const auto wlOutput : toplevel->outputs) {
+            const auto cur = m_callbackData.outputNames.find (wlOutput);
+
+            if (cur != m_callbackData.outputNames.end () && cur->second == output)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void WaylandFullScreenDetector::waitForChange (float timeout) const {
+    if (!m_toplevelManager) {
+        FullScreenDetector::waitForChange (timeout);
+        return;
+    }
+
+    wl_display_flush (m_display);
+
+    pollfd fd = {.fd = wl_display_get_fd (m_display), .events = POLLIN, .revents = 0};
+
+    poll (&fd, 1, static_cast<int> (timeout * 1000));
+}
+
+void WaylandFullScreenDetector::dispatchPending () const {
+    while (wl_display_prepare_read (m_display) != 0)
+        wl_display_dispatch_pending (m_display);
+
+    wl_display_flush (m_display);
+
+    pollfd fd = {.fd = wl_display_get_fd (m_display), .events = POLLIN, .revents = 0};
+
+    if (poll (&fd, 1, 0) > 0)
+        wl_display_read_events (m_display);
+    else
+        wl_display_cancel_read (m_display);
+
+    wl_display_dispatch_pending (m_display);
+}
+
 void WaylandFullScreenDetector::reset () {}
 
 
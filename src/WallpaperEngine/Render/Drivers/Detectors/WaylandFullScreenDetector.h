@@ -3,20 +3,29 @@
 #ifdef ENABLE_WAYLAND
 
 #include <glm/vec4.hpp>
+#include <map>
+#include <set>
+#include <string>
 
 #include "FullScreenDetector.h"
 
 struct wl_display;
+struct wl_output;
 struct wl_registry;
 struct zwlr_foreign_toplevel_manager_v1;
 
 namespace WallpaperEngine::Render::Drivers::Detectors {
 
 class WaylandFullScreenDetector;
+struct FullscreenState;
 
 struct WaylandFullscreenDetectorCallbackData {
     WaylandFullScreenDetector* detector;
     uint32_t* fullscreenCount;
+    /** every toplevel the compositor announced and didn't close yet */
+    std::set<FullscreenState*> toplevels = {};
+    /** toplevels only tell the wl_output they're on, this maps them to the names the screens are set up with */
+    std::map<wl_output*, std::string> outputNames = {};
 };
 
 class WaylandFullScreenDetector final : public FullScreenDetector {
@@ -25,9 +34,26 @@ class WaylandFullScreenDetector final : public FullScreenDetector {
     ~WaylandFullScreenDetector () override;
 
     [[nodiscard]] bool anythingFullscreen () const override;
+    /**
+     * Only reads the events already received instead of doing a roundtrip, as it's checked for every output's frame
+     */
+    [[nodiscard]] bool isFullscreen (const std::string& output) const override;
+    /**
+     * Outputs are hidden by fullscreen and maximized toplevels, the ones that are off get no frame callbacks already
+     */
+    [[nodiscard]] bool isVisible (const std::string& output) const override;
+    /**
+     * Waits for the compositor to send anything about the toplevels
+     */
+    void waitForChange (float timeout) const override;
     void reset () override;
 
   private:
+    /**
+     * Dispatches whatever the compositor already sent without waiting for anything else
+     */
+    void dispatchPending () const;
+
     wl_display* m_display = nullptr;
     zwlr_foreign_toplevel_manager_v1* m_toplevelManager = nullptr;
 
@@ -1,8 +1,13 @@
 #include "WallpaperEngine/Logging/Log.h"
 #include "X11FullScreenDetector.h"
 
+#include <X11/Xatom.h>
 #include <X11/Xlib.h>
 #include <X11/extensions/Xrandr.h>
+#ifdef HAVE_XDPMS
+#include <X11/extensions/dpms.h>
+#endif /* HAVE_XDPMS */
+#include <poll.h>
 
 #include "WallpaperEngine/Render/Drivers/VideoFactories.h"
 #include "WallpaperEngine/Render/Drivers/GLFWOpenGLDriver.h"
@@ -59,15 +64,83 @@ X11FullScreenDetector::~X11FullScreenDetector () {
 }
 
 bool X11FullScreenDetector::anythingFullscreen () const {
-    // stop rendering if anything is fullscreen
-    bool isFullscreen = false;
+    if (this->m_display == nullptr)
+        return false;
+
+    this->update ();
+
+    return this->m_fullscreen;
+}
+
+bool X11FullScreenDetector::isFullscreen (const std::string& output) const {
+    if (this->m_display == nullptr)
+        return false;
+
+    this->update ();
+
+    return this->m_fullscreenScreens.contains (output);
+}
+
+bool X11FullScreenDetector::isVisible (const std::string& output) const {
+    if (this->m_display == nullptr)
+        return true;
+
+    this->update ();
+
+    if (this->m_fullscreenScreens.contains (output) || this->m_maximizedScreens.contains (output))
+        return false;
+
+    return !this->isDisplayOff ();
+}
+
+void X11FullScreenDetector::update () const {
+    this->processEvents ();
+
+    // nothing moved since the last query, the answer is the same
+    if (!this->m_stale)
+        return;
+
+    this->queryWindows ();
+    this->m_stale = false;
+}
+
+void X11FullScreenDetector::processEvents () const {
+    XEvent event;
+
+    while (XPending (this->m_display) > 0) {
+        XNextEvent (this->m_display, &event);
+
+        switch (event.type) {
+            case ConfigureNotify:
+            case MapNotify:
+            case UnmapNotify:
+            case DestroyNotify:
+            case ReparentNotify:
+                this->m_stale = true;
+                break;
+            case PropertyNotify:
+                // the root gets lots of other properties changed, like the background pixmap on every frame
+                if (event.xproperty.atom == this->m_activeWindowAtom || event.xproperty.atom == this->m_clientListAtom)
+                    this->m_stale = true;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void X11FullScreenDetector::queryWindows () const {
     XWindowAttributes attribs;
     Window _;
     Window* children;
     unsigned int nchildren;
 
+    this->m_fullscreen = false;
+    this->m_fullscreenScreens.clear ();
+    this->m_maximizedScreens.clear ();
+
     if (!XQueryTree (this->m_display, this->m_root, &_, &_, &children, &nchildren))
-        return false;
+        return;
 
     const auto ourWindow = reinterpret_cast<Window> (dynamic_cast <GLFWOpenGLDriver&> (this->m_driver).getWindow ());
     Window parentWindow;
@@ -76,11 +149,13 @@ bool X11FullScreenDetector::anythingFullscreen () const {
         Window root, *schildren = nullptr;
         unsigned int num_children;
 
-        if (!XQueryTree (this->m_display, ourWindow, &root, &parentWindow, &schildren, &num_children))
-            return false;
+        if (!XQueryTree (this->m_display, ourWindow, &root, &parentWindow, &schildren, &num_children)) {
+            XFree (children);
+            return;
+        }
 
         if (schildren)
-            XFree (children);
+            XFree (schildren);
     }
 
     for (unsigned int i = 0; i < nchildren; i++) {
@@ -98,15 +173,123 @@ bool X11FullScreenDetector::anythingFullscreen () const {
         for (const auto& [name, viewport] : this->m_screens) {
             if (attribs.x == viewport.x && attribs.y == viewport.y && attribs.width == viewport.z &&
                 attribs.height == viewport.w) {
-                isFullscreen = true;
-                break;
+                this->m_fullscreen = true;
+                this->m_fullscreenScreens.insert (name);
             }
         }
     }
 
     XFree (children);
 
-    return isFullscreen;
+    if (this->getApplicationContext ().settings.render.pauseOnMaximized)
+        this->queryMaximized ();
+}
+
+void X11FullScreenDetector::queryMaximized () const {
+    Atom type;
+    int format;
+    unsigned long count, remaining;
+    unsigned char* data = nullptr;
+
+    // window managers without EWMH support have no list, nothing can be told about them
+    if (XGetWindowProperty (this->m_display, this->m_root, this->m_clientListAtom, 0, 4096, False, XA_WINDOW, &type,
+                            &format, &count, &remaining, &data) != Success || data == nullptr)
+        return;
+
+    const auto clients = reinterpret_cast<const Window*> (data);
+
+    for (unsigned long i = 0; i < count; i++) {
+        XWindowAttributes attribs;
+
+        if (!this->isMaximized (clients [i]))
+            continue;
+
+        // windows in other workspaces are unmapped
+        if (!XGetWindowAttributes (this->m_display, clients [i], &attribs) || attribs.map_state != IsViewable)
+            continue;
+
+        int x, y;
+        Window child;
+
+        if (!XTranslateCoordinates (this->m_display, clients [i], this->m_root, 0, 0, &x, &y, &child))
+            continue;
+
+        // the window belongs to the screen its center is on, panels keep it from being the screen's exact size
+        const int centerX = x + attribs.width / 2;
+        const int centerY = y + attribs.height / 2;
+
+        for (const auto& [name, viewport] : this->m_screens) {
+            if (centerX >= viewport.x && centerX < viewport.x + viewport.z && centerY >= viewport.y &&
+                centerY < viewport.y + viewport.w)
+                this->m_maximizedScreens.insert (name);
+        }
+    }
+
+    XFree (data);
+}
+
+bool X11FullScreenDetector::isMaximized (Window window) const {
+    Atom type;
+    int format;
+    unsigned long count, remaining;
+    unsigned char* data = nullptr;
+
+    if (XGetWindowProperty (this->m_display, window, this->m_wmStateAtom, 0, 64, False, XA_ATOM, &type, &format,
+                            &count, &remaining, &data) != Success || data == nullptr)
+        return false;
+
+    const auto states = reinterpret_cast<const Atom*> (data);
+    bool vertical = false, horizontal = false, hidden = false;
+
+    for (unsigned long i = 0; i < count; i++) {
+        vertical = vertical || states [i] == this->m_maximizedVertAtom;
+        horizontal = horizontal || states [i] == this->m_maximizedHorzAtom;
+        hidden = hidden || states [i] == this->m_hiddenAtom;
+    }
+
+    XFree (data);
+
+    return vertical && horizontal && !hidden;
+}
+
+bool X11FullScreenDetector::isDisplayOff () const {
+#ifdef HAVE_XDPMS
+    const auto now = std::chrono::steady_clock::now ();
+
+    if (now - this->m_lastDisplayCheck < std::chrono::seconds (1))
+        return this->m_displayOff;
+
+    this->m_lastDisplayCheck = now;
+    this->m_displayOff = false;
+
+    int event, error;
+    CARD16 state;
+    BOOL enabled;
+
+    if (DPMSQueryExtension (this->m_display, &event, &error) && DPMSCapable (this->m_display) &&
+        DPMSInfo (this->m_display, &state, &enabled) && enabled)
+        this->m_displayOff = state != DPMSModeOn;
+
+    return this->m_displayOff;
+#else
+    return false;
+#endif /* HAVE_XDPMS */
+}
+
+void X11FullScreenDetector::waitForChange (float timeout) const {
+    if (this->m_display == nullptr) {
+        FullScreenDetector::waitForChange (timeout);
+        return;
+    }
+
+    // anything already queued means something changed since the last check
+    if (XPending (this->m_display) == 0) {
+        pollfd fd = {.fd = ConnectionNumber (this->m_display), .events = POLLIN, .revents = 0};
+
+        poll (&fd, 1, static_cast<int> (timeout * 1000));
+    }
+
+    this->processEvents ();
 }
 
 void X11FullScreenDetector::reset () {
@@ -130,6 +313,15 @@ void X11FullScreenDetector::initialize () {
     }
 
     this->m_root = DefaultRootWindow (this->m_display);
+    // get notified of top-level windows changing and the focus moving, the windows are only queried again then
+    XSelectInput (this->m_display, this->m_root, SubstructureNotifyMask | PropertyChangeMask);
+    this->m_activeWindowAtom = XInternAtom (this->m_display, "_NET_ACTIVE_WINDOW", False);
+    this->m_clientListAtom = XInternAtom (this->m_display, "_NET_CLIENT_LIST", False);
+    this->m_wmStateAtom = XInternAtom (this->m_display, "_NET_WM_STATE", False);
+    this->m_maximizedVertAtom = XInternAtom (this->m_display, "_NET_WM_STATE_MAXIMIZED_VERT", False);
+    this->m_maximizedHorzAtom = XInternAtom (this->m_display, "_NET_WM_STATE_MAXIMIZED_HORZ", False);
+    this->m_hiddenAtom = XInternAtom (this->m_display, "_NET_WM_STATE_HIDDEN", False);
+    this->m_stale = true;
     XRRScreenResources* screenResources = XRRGetScreenResources (this->m_display, this->m_root);
 
     if (screenResources == nullptr) {
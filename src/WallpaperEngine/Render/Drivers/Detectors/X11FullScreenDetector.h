@@ -1,6 +1,8 @@
 #pragma once
 
+#include <chrono>
 #include <glm/vec4.hpp>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -18,16 +20,64 @@ class X11FullScreenDetector final : public FullScreenDetector {
     ~X11FullScreenDetector () override;
 
     [[nodiscard]] bool anythingFullscreen () const override;
+    [[nodiscard]] bool isFullscreen (const std::string& output) const override;
+    /**
+     * Screens are hidden by windows the size of the screen, maximized windows and the display being in DPMS standby
+     */
+    [[nodiscard]] bool isVisible (const std::string& output) const override;
+    /**
+     * Waits for windows to be mapped, unmapped or moved around on the root window
+     */
+    void waitForChange (float timeout) const override;
     void reset () override;
 
   private:
     void initialize ();
     void stop ();
+    /**
+     * Reads the events already received, flagging the cached state as stale if any of them could change it
+     */
+    void processEvents () const;
+    /**
+     * Queries the windows again if an event made the cached state stale
+     */
+    void update () const;
+    /**
+     * Asks the server for every top-level window and works out which screens they cover
+     */
+    void queryWindows () const;
+    /**
+     * Finds the screens maximized clients are on, through the window manager's _NET_CLIENT_LIST
+     */
+    void queryMaximized () const;
+    /**
+     * @param window A client window
+     *
+     * @return If the window manager has the window maximized in both directions and not minimized
+     */
+    [[nodiscard]] bool isMaximized (Window window) const;
+    /**
+     * @return If DPMS turned the monitors off, checked at most once a second as the server sends no events for it
+     */
+    [[nodiscard]] bool isDisplayOff () const;
 
     Display* m_display = nullptr;
     Window m_root;
     std::map<std::string, glm::ivec4> m_screens = {};
     VideoDriver& m_driver;
+    Atom m_activeWindowAtom = None;
+    Atom m_clientListAtom = None;
+    Atom m_wmStateAtom = None;
+    Atom m_maximizedVertAtom = None;
+    Atom m_maximizedHorzAtom = None;
+    Atom m_hiddenAtom = None;
+    /** results of the last queryWindows (), only valid while m_stale is not set */
+    mutable bool m_fullscreen = false;
+    mutable std::set<std::string> m_fullscreenScreens = {};
+    mutable std::set<std::string> m_maximizedScreens = {};
+    mutable bool m_stale = true;
+    mutable bool m_displayOff = false;
+    mutable std::chrono::steady_clock::time_point m_lastDisplayCheck = {};
 };
 } // namespace Detectors
 } // namespace WallpaperEngine::Render::Drivers
\ No newline at end of file
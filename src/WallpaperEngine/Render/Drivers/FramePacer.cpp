@@ -0,0 +1,82 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+
+using namespace WallpaperEngine::Render::Drivers;
+
+namespace {
+constexpr int64_t NANOSECONDS = 1000000000;
+} // namespace
+
+FramePacer::FramePacer (int fps) {
+    this->setFPS (fps);
+}
+
+void FramePacer::setFPS (int fps) {
+    fps = std::max (fps, 1);
+
+    if (fps == this->m_fps)
+        return;
+
+    this->m_fps = fps;
+    this->m_interval = NANOSECONDS / fps;
+}
+
+int FramePacer::getFPS () const {
+    return this->m_fps;
+}
+
+void FramePacer::wait () {
+    const int64_t current = now ();
+
+    // first frame, or so far behind that catching up would mean rendering several frames back to back
+    if (this->m_deadline == 0 || current - this->m_deadline > this->m_interval) {
+        this->m_deadline = current;
+    } else {
+        const timespec deadline = {
+            .tv_sec = static_cast<time_t> (this->m_deadline / NANOSECONDS),
+            .tv_nsec = static_cast<long> (this->m_deadline % NANOSECONDS),
+        };
+
+        // signals interrupt the sleep, but as the deadline is absolute it can just be resumed
+        while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+    }
+
+    const int64_t frame = now ();
+
+    if (this->m_lastFrame != 0) {
+        const double frameTime = static_cast<double> (frame - this->m_lastFrame) / NANOSECONDS;
+        const double alpha = std::min (1.0, 1.0 / this->m_fps);
+        const double diff = frameTime - this->m_mean;
+        const double increment = alpha * diff;
+
+        this->m_mean += increment;
+        this->m_variance = (1.0 - alpha) * (this->m_variance + diff * increment);
+    }
+
+    this->m_lastFrame = frame;
+    this->m_deadline += this->m_interval;
+}
+
+void FramePacer::reset () {
+    this->m_deadline = 0;
+    this->m_lastFrame = 0;
+}
+
+double FramePacer::getAverageFrameTime () const {
+    return this->m_mean;
+}
+
+double FramePacer::getFrameTimeDeviation () const {
+    return std::sqrt (this->m_variance);
+}
+
+int64_t FramePacer::now () {
+    timespec time {};
+
+    clock_gettime (CLOCK_MONOTONIC, &time);
+
+    return static_cast<int64_t> (time.tv_sec) * NANOSECONDS + time.tv_nsec;
+}
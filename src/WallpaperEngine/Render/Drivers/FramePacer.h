@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+namespace WallpaperEngine::Render::Drivers {
+/**
+ * Keeps frames to an FPS limit by sleeping until absolute deadlines
+ *
+ * Every deadline is one frame after the previous one instead of one frame after the current one ended, so the
+ * time spent rendering and the sleep overshooting don't add up into a lower frame rate. When a frame runs over
+ * by more than a whole interval the cadence starts over instead of rendering a burst of frames to catch up
+ */
+class FramePacer {
+  public:
+    explicit FramePacer (int fps);
+
+    /**
+     * Changes the FPS limit, takes effect on the next frame
+     *
+     * @param fps
+     */
+    void setFPS (int fps);
+    [[nodiscard]] int getFPS () const;
+    /**
+     * Sleeps until the current frame's deadline and moves it to the next one
+     */
+    void wait ();
+    /**
+     * Starts the cadence over from now, for when frames stopped for a while (like when nothing changes on screen)
+     */
+    void reset ();
+    /**
+     * @return Average time between frames in seconds, over roughly the last second
+     */
+    [[nodiscard]] double getAverageFrameTime () const;
+    /**
+     * @return Standard deviation of the time between frames in seconds, over roughly the last second
+     */
+    [[nodiscard]] double getFrameTimeDeviation () const;
+
+  private:
+    static int64_t now ();
+
+    int m_fps = 0;
+    /** nanoseconds between frames */
+    int64_t m_interval = 0;
+    /** CLOCK_MONOTONIC nanoseconds the current frame ends at, 0 until the first frame */
+    int64_t m_deadline = 0;
+    /** when the previous frame was let through, 0 after a reset */
+    int64_t m_lastFrame = 0;
+    /** exponentially weighted mean and variance of the frame time, in seconds */
+    double m_mean = 0.0;
+    double m_variance = 0.0;
+};
+} // namespace WallpaperEngine::Render::Drivers
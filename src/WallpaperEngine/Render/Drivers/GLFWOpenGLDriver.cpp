@@ -8,10 +8,12 @@
 
 #define GLFW_EXPOSE_NATIVE_X11
 #include "WallpaperEngine/Debugging/CallStack.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
 
 #include <GLFW/glfw3native.h>
 
-#include <unistd.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace WallpaperEngine::Render::Drivers;
 
@@ -24,7 +26,8 @@ GLFWOpenGLDriver::GLFWOpenGLDriver (
 ) :
     VideoDriver (app, m_mouseInput),
     m_context (context),
-    m_mouseInput (*this) {
+    m_mouseInput (*this),
+    m_pacer (context.settings.render.maximumFPS) {
     glfwSetErrorCallback (CustomGLFWErrorHandler);
 
     // initialize glfw
@@ -36,6 +39,9 @@ GLFWOpenGLDriver::GLFWOpenGLDriver (
     glfwWindowHint (GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint (GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint (GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // wallpapers are drawn into framebuffers without depth and copied over, the window doesn't need any
+    glfwWindowHint (GLFW_DEPTH_BITS, 0);
+    glfwWindowHint (GLFW_STENCIL_BITS, 0);
     glfwWindowHint (GLFW_VISIBLE, GLFW_FALSE);
     // set X11-specific hints
     glfwWindowHintString (GLFW_X11_CLASS_NAME, "linux-wallpaperengine");
@@ -48,12 +54,22 @@ GLFWOpenGLDriver::GLFWOpenGLDriver (
         glfwWindowHint (GLFW_FLOATING, GLFW_TRUE);
     }
 
+    // the window may be shown as the desktop itself (see X11Output), it shouldn't get any borders then
+    if (context.settings.render.mode == Application::ApplicationContext::DESKTOP_BACKGROUND)
+        glfwWindowHint (GLFW_DECORATED, GLFW_FALSE);
+
 #if !NDEBUG
     glfwWindowHint (GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
 #endif /* DEBUG */
 
-    // create window, size doesn't matter as long as we don't show it
-    this->m_window = glfwCreateWindow (640, 480, windowTitle, nullptr, nullptr);
+    const bool benchmark = context.settings.general.benchmarkFrames > 0;
+
+    this->m_previews = !context.settings.screenshot.previews.empty ();
+    this->m_fixedTimestep = benchmark || this->m_previews;
+
+    // create window, size doesn't matter as long as we don't show it, benchmarks never show it but render to it
+    this->m_window = benchmark ? glfwCreateWindow (BENCHMARK_WIDTH, BENCHMARK_HEIGHT, windowTitle, nullptr, nullptr)
+                               : glfwCreateWindow (640, 480, windowTitle, nullptr, nullptr);
 
     if (this->m_window == nullptr)
         sLog.exception ("Cannot create window");
@@ -65,6 +81,13 @@ GLFWOpenGLDriver::GLFWOpenGLDriver (
     if (const GLenum result = glewInit (); result != GLEW_OK)
         sLog.error ("Failed to initialize GLEW: ", glewGetErrorString (result));
 
+    // the swaps shouldn't wait for a vblank that never comes for a hidden window
+    if (this->m_fixedTimestep)
+        glfwSwapInterval (0);
+
+    if (benchmark)
+        this->m_benchmark = std::make_unique<Benchmark> (context.settings.general.benchmarkFrames);
+
     // setup output
     if (context.settings.render.mode == ApplicationContext::EXPLICIT_WINDOW ||
         context.settings.render.mode == ApplicationContext::NORMAL_WINDOW) {
@@ -72,7 +95,8 @@ GLFWOpenGLDriver::GLFWOpenGLDriver (
     }
 #ifdef ENABLE_X11
     else {
-        m_output = new WallpaperEngine::Render::Drivers::Output::X11Output (context, *this);
+        m_output = new WallpaperEngine::Render::Drivers::Output::X11Output (
+            context, *this, glfwGetX11Window (this->m_window));
     }
 #else
     else {
@@ -82,6 +106,9 @@ GLFWOpenGLDriver::GLFWOpenGLDriver (
 }
 
 GLFWOpenGLDriver::~GLFWOpenGLDriver () {
+    this->releaseReadbacks ();
+    // its queries have to go while the context is still there
+    this->m_benchmark = nullptr;
     glfwTerminate ();
 }
 
@@ -90,10 +117,18 @@ Output::Output& GLFWOpenGLDriver::getOutput () {
 }
 
 float GLFWOpenGLDriver::getRenderTime () const {
+    // benchmarks and previews simulate a fixed step per frame so every run is the same no matter how fast it renders
+    if (this->m_fixedTimestep)
+        return static_cast<float> (this->m_frameCounter) /
+               static_cast<float> (this->m_context.settings.render.maximumFPS);
+
     return static_cast<float> (glfwGetTime ());
 }
 
 bool GLFWOpenGLDriver::closeRequested () {
+    if (this->m_benchmark != nullptr && this->m_benchmark->isDone ())
+        return true;
+
     return glfwWindowShouldClose (this->m_window);
 }
 
@@ -126,50 +161,268 @@ uint32_t GLFWOpenGLDriver::getFrameCounter () const {
     return this->m_frameCounter;
 }
 
+int GLFWOpenGLDriver::getRefreshRate () const {
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor ();
+    const GLFWvidmode* mode = monitor != nullptr ? glfwGetVideoMode (monitor) : nullptr;
+
+    return mode != nullptr ? mode->refreshRate : 0;
+}
+
+void GLFWOpenGLDriver::wakeUp () const {
+    // ends the glfwWaitEventsTimeout () of the idle path
+    glfwPostEmptyEvent ();
+}
+
+void* GLFWOpenGLDriver::getX11Display () const {
+    // nullptr when GLFW runs on anything other than X11
+    return glfwGetX11Display ();
+}
+
 void GLFWOpenGLDriver::dispatchEventQueue () {
-    static float startTime, endTime, minimumTime = 1.0f / this->m_context.settings.render.maximumFPS;
-    // get the start time of the frame
-    startTime = this->getRenderTime ();
+    TRACE_SCOPE ("GLFWOpenGLDriver::dispatchEventQueue");
+
+    if (this->m_benchmark != nullptr)
+        this->m_benchmark->beginFrame ();
+
     // clear the screen
-    glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClear (GL_COLOR_BUFFER_BIT);
 
-    for (const auto& [screen, viewport] : this->m_output->getViewports ())
-        this->getApp ().update (viewport);
+    bool changed = false;
+    std::vector<glm::ivec4> damage;
 
-    // read the full texture into the image
-    if (this->m_output->haveImageBuffer ()) {
-        // 4.5 supports glReadnPixels, anything older doesn't...
-        if (GLEW_VERSION_4_5) {
-            glReadnPixels (0, 0, this->m_output->getFullWidth (), this->m_output->getFullHeight (), GL_BGRA,
-                           GL_UNSIGNED_BYTE, this->m_output->getImageBufferSize (), this->m_output->getImageBuffer ());
-        } else {
-            // fallback to old version
-            glReadPixels (0, 0, this->m_output->getFullWidth (), this->m_output->getFullHeight (), GL_BGRA, GL_UNSIGNED_BYTE, this->m_output->getImageBuffer ());
-        }
+    const bool background = this->m_context.settings.render.mode == ApplicationContext::DESKTOP_BACKGROUND;
 
-        GLenum error = glGetError();
+    // unchanged viewports still draw their last frame, the screen was cleared
+    for (const auto& [screen, viewport] : this->m_output->getViewports ()) {
+        // hidden screens keep their wallpaper loaded but don't draw, the root window image keeps their last frame
+        if (background && !this->getApp ().isVisible (screen))
+            continue;
 
-        if (error != GL_NO_ERROR) {
-            sLog.exception("OpenGL error when reading texture ", error);
-        }
+        if (!this->getApp ().update (viewport))
+            continue;
+
+        changed = true;
+        damage.push_back (viewport->viewport);
+    }
+
+    // nothing new to show, keep the current image on screen and wait for input or the next check
+    if (!changed && !this->m_fixedTimestep) {
+        // the last frames rendered are still on their way back, show them before going idle
+        if (this->m_output->haveImageBuffer () && this->collectReadbacks (true, damage))
+            this->m_output->updateRegions (damage);
+
+        glfwWaitEventsTimeout (IDLE_WAKEUP_TIME);
+        this->m_frameCounter++;
+        // the next changed frame starts a new cadence instead of being measured against the idle time
+        this->m_pacer.reset ();
+        return;
+    }
+
+    // previews read the wallpapers' framebuffers, nothing has to reach the window
+    if (this->m_previews) {
+        this->m_frameCounter++;
+        return;
     }
 
     // TODO: FRAMETIME CONTROL SHOULD GO BACK TO THE CWALLPAPAERAPPLICATION ONCE ACTUAL PARTICLES ARE IMPLEMENTED
     // TODO: AS THOSE, MORE THAN LIKELY, WILL REQUIRE OF A DIFFERENT PROCESSING RATE
-    // update the output with the given image
-    this->m_output->updateRender ();
+    if (this->m_output->haveImageBuffer ()) {
+        // the image shown lags a frame or two behind, but the CPU never waits for the GPU to finish this one
+        std::vector<glm::ivec4> presented;
+
+        this->queueReadback (damage, presented);
+        this->collectReadbacks (false, presented);
+
+        if (!presented.empty ())
+            this->m_output->updateRegions (presented);
+    } else {
+        this->m_output->updateRender ();
+    }
+
     // do buffer swapping first
     glfwSwapBuffers (this->m_window);
     // poll for events
     glfwPollEvents ();
     // increase frame counter
     this->m_frameCounter++;
-    // get the end time of the frame
-    endTime = this->getRenderTime ();
 
-    // ensure the frame time is correct to not overrun FPS
-    if ((endTime - startTime) < minimumTime)
-        usleep ((minimumTime - (endTime - startTime)) * CLOCKS_PER_SEC);
+    // benchmarks render as fast as they can
+    if (this->m_benchmark != nullptr) {
+        this->m_benchmark->endFrame ();
+
+        if (this->m_benchmark->isDone ()) {
+            auto& context = this->getApp ().getRenderContext ();
+
+            this->m_benchmark->report (
+                context.getProgramCache ().getBuildTime (), context.getTextureCache ().getResidentBytes ());
+        }
+
+        return;
+    }
+
+    // the limit is picked up every frame so it can be changed while running, power profiles lower it too and
+    // with --adaptive-fps every screen goes as fast as the fastest moving wallpaper needs
+    const float limit =
+        static_cast<float> (this->m_context.settings.render.maximumFPS) * this->m_context.state.power.fpsScale;
+
+    this->m_pacer.setFPS (
+        std::max (1, static_cast<int> (this->getApp ().getRenderContext ().getMotionFPS (limit))));
+    this->m_pacer.wait ();
+
+#if !NDEBUG
+    if (this->m_frameCounter % (this->m_pacer.getFPS () * 10) == 0)
+        sLog.debug ("Frame time ", this->m_pacer.getAverageFrameTime () * 1000.0, "ms, deviation ",
+                    this->m_pacer.getFrameTimeDeviation () * 1000.0, "ms");
+#endif /* DEBUG */
+}
+
+void GLFWOpenGLDriver::queueReadback (std::vector<glm::ivec4> regions, std::vector<glm::ivec4>& presented) {
+    const uint32_t size = this->m_output->getImageBufferSize ();
+    const int width = this->m_output->getFullWidth ();
+    const int height = this->m_output->getFullHeight ();
+
+    if (size != this->m_readbackSize) {
+        this->releaseReadbacks ();
+
+        glGenBuffers (READBACK_BUFFERS, this->m_readbackBuffers.data ());
+
+        for (const GLuint buffer : this->m_readbackBuffers) {
+            glBindBuffer (GL_PIXEL_PACK_BUFFER, buffer);
+            glBufferData (GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        }
+
+        this->m_readbackSize = size;
+        // nothing was read into the image yet, the viewports that didn't change are just as new to it
+        regions = {{0, 0, width, height}};
+    }
+
+    // every buffer is in flight, the oldest one has to be taken before its buffer can be reused
+    if (GLsync& oldest = this->m_readbackFences [this->m_readbackIndex]; oldest != nullptr) {
+        glClientWaitSync (oldest, GL_SYNC_FLUSH_COMMANDS_BIT, READBACK_TIMEOUT);
+        this->collectReadbacks (false, presented);
+
+        // the driver is stuck on it, drop that frame
+        if (oldest != nullptr) {
+            glDeleteSync (oldest);
+            oldest = nullptr;
+        }
+    }
+
+    auto& queued = this->m_readbackRegions [this->m_readbackIndex];
+
+    queued.clear ();
+
+    glBindBuffer (GL_PIXEL_PACK_BUFFER, this->m_readbackBuffers [this->m_readbackIndex]);
+    // regions land where they'd be in a full readback, so the buffer keeps the image's layout
+    glPixelStorei (GL_PACK_ROW_LENGTH, width);
+
+    for (const glm::ivec4& region : regions) {
+        const int x = std::clamp (region.x, 0, width);
+        const int y = std::clamp (region.y, 0, height);
+        const int w = std::clamp (region.x + region.z, 0, width) - x;
+        const int h = std::clamp (region.y + region.w, 0, height) - y;
+
+        if (w <= 0 || h <= 0)
+            continue;
+
+        const uint32_t offset = (y * width + x) * 4;
+
+        // with a pack buffer bound the pointer is an offset into it and the copy happens on the GPU's time
+        if (GLEW_VERSION_4_5) {
+            glReadnPixels (x, y, w, h, GL_BGRA, GL_UNSIGNED_BYTE, size - offset,
+                           reinterpret_cast<void*> (static_cast<uintptr_t> (offset)));
+        } else {
+            glReadPixels (x, y, w, h, GL_BGRA, GL_UNSIGNED_BYTE,
+                          reinterpret_cast<void*> (static_cast<uintptr_t> (offset)));
+        }
+
+        queued.emplace_back (x, y, w, h);
+    }
+
+    glPixelStorei (GL_PACK_ROW_LENGTH, 0);
+    glBindBuffer (GL_PIXEL_PACK_BUFFER, GL_NONE);
+
+    GLenum error = glGetError ();
+
+    if (error != GL_NO_ERROR) {
+        sLog.exception ("OpenGL error when reading texture ", error);
+    }
+
+    if (queued.empty ())
+        return;
+
+    this->m_readbackFences [this->m_readbackIndex] = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    this->m_readbackIndex = (this->m_readbackIndex + 1) % READBACK_BUFFERS;
+}
+
+bool GLFWOpenGLDriver::collectReadbacks (bool wait, std::vector<glm::ivec4>& regions) {
+    const int width = this->m_output->getFullWidth ();
+    auto* image = static_cast<char*> (this->m_output->getImageBuffer ());
+    bool updated = false;
+
+    // fences signal in the order they were queued, so walk from the oldest one and stop at the first pending,
+    // every finished one is copied as the newer ones might not cover the same regions
+    for (uint32_t i = 0; i < READBACK_BUFFERS; i++) {
+        const uint32_t index = (this->m_readbackIndex + i) % READBACK_BUFFERS;
+        GLsync& fence = this->m_readbackFences [index];
+
+        if (fence == nullptr)
+            continue;
+
+        const GLenum status =
+            glClientWaitSync (fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? READBACK_TIMEOUT : 0);
+
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED)
+            break;
+
+        glDeleteSync (fence);
+        fence = nullptr;
+
+        glBindBuffer (GL_PIXEL_PACK_BUFFER, this->m_readbackBuffers [index]);
+
+        const auto* pixels = static_cast<const char*> (
+            glMapBufferRange (GL_PIXEL_PACK_BUFFER, 0, this->m_readbackSize, GL_MAP_READ_BIT));
+
+        if (pixels != nullptr) {
+            for (const glm::ivec4& region : this->m_readbackRegions [index]) {
+                for (int y = region.y; y < region.y + region.w; y++) {
+                    const size_t offset = (static_cast<size_t> (y) * width + region.x) * 4;
+
+                    memcpy (image + offset, pixels + offset, region.z * 4);
+                }
+
+                // the same viewport commonly changed in every frame collected, present it once
+                if (std::find (regions.begin (), regions.end (), region) == regions.end ())
+                    regions.push_back (region);
+            }
+
+            updated = true;
+        }
+
+        glUnmapBuffer (GL_PIXEL_PACK_BUFFER);
+        glBindBuffer (GL_PIXEL_PACK_BUFFER, GL_NONE);
+    }
+
+    return updated;
+}
+
+void GLFWOpenGLDriver::releaseReadbacks () {
+    for (GLsync& fence : this->m_readbackFences) {
+        if (fence != nullptr)
+            glDeleteSync (fence);
+
+        fence = nullptr;
+    }
+
+    if (this->m_readbackSize != 0)
+        glDeleteBuffers (READBACK_BUFFERS, this->m_readbackBuffers.data ());
+
+    for (auto& regions : this->m_readbackRegions)
+        regions.clear ();
+
+    this->m_readbackBuffers = {};
+    this->m_readbackSize = 0;
+    this->m_readbackIndex = 0;
 }
 
 void* GLFWOpenGLDriver::getProcAddress (const char* name) const {
@@ -3,11 +3,17 @@
 #include "WallpaperEngine/Application/ApplicationContext.h"
 #include "WallpaperEngine/Application/WallpaperApplication.h"
 #include "WallpaperEngine/Input/Drivers/GLFWMouseInput.h"
+#include "WallpaperEngine/Render/Drivers/Benchmark.h"
 #include "WallpaperEngine/Render/Drivers/Detectors/FullScreenDetector.h"
+#include "WallpaperEngine/Render/Drivers/FramePacer.h"
 #include "WallpaperEngine/Render/Drivers/VideoDriver.h"
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <array>
+#include <memory>
+#include <vector>
+
 namespace WallpaperEngine::Application {
 class ApplicationContext;
 class WallpaperApplication;
@@ -30,16 +36,61 @@ class GLFWOpenGLDriver final : public VideoDriver {
     void hideWindow () override;
     [[nodiscard]] glm::ivec2 getFramebufferSize () const override;
     [[nodiscard]] uint32_t getFrameCounter () const override;
+    [[nodiscard]] int getRefreshRate () const override;
+    void wakeUp () const override;
+    [[nodiscard]] void* getX11Display () const override;
     void dispatchEventQueue () override;
     [[nodiscard]] void* getProcAddress (const char* name) const override;
 
     GLFWwindow* getWindow () const;
 
   private:
+    /** frames in flight between the GPU writing the pixels and them being copied into the output's image */
+    static constexpr uint32_t READBACK_BUFFERS = 3;
+    /** nanoseconds to block on a readback before giving up on it */
+    static constexpr GLuint64 READBACK_TIMEOUT = 1000000000;
+    /** size of the hidden window benchmarks render to when no --window geometry is given */
+    static constexpr int BENCHMARK_WIDTH = 1920;
+    static constexpr int BENCHMARK_HEIGHT = 1080;
+
+    /**
+     * Starts reading the regions of the frame just rendered into the next pixel pack buffer, without waiting for it
+     *
+     * @param regions x, y, width and height of every changed region, in framebuffer coordinates
+     * @param presented Gets the regions of the oldest readback when it had to be taken first to free its buffer
+     */
+    void queueReadback (std::vector<glm::ivec4> regions, std::vector<glm::ivec4>& presented);
+    /**
+     * Copies the regions of every finished readback into the output's image buffer, oldest first
+     *
+     * @param wait Block until every queued readback is done instead of only taking the finished ones
+     * @param regions Gets the regions copied
+     *
+     * @return If the image buffer was updated
+     */
+    bool collectReadbacks (bool wait, std::vector<glm::ivec4>& regions);
+    void releaseReadbacks ();
+
     ApplicationContext& m_context;
     Input::Drivers::GLFWMouseInput m_mouseInput;
+    FramePacer m_pacer;
     Output::Output* m_output = nullptr;
     GLFWwindow* m_window = nullptr;
     uint32_t m_frameCounter = 0;
+    std::array<GLuint, READBACK_BUFFERS> m_readbackBuffers = {};
+    /** signalled once the readback into the buffer with the same index is done, nullptr if there's none queued */
+    std::array<GLsync, READBACK_BUFFERS> m_readbackFences = {};
+    /** regions read into the buffer with the same index, everything else in it is stale */
+    std::array<std::vector<glm::ivec4>, READBACK_BUFFERS> m_readbackRegions = {};
+    /** size the buffers were allocated with, 0 while there are none */
+    uint32_t m_readbackSize = 0;
+    /** buffer the next readback goes into, also the oldest one queued */
+    uint32_t m_readbackIndex = 0;
+    /** times the frames with --benchmark, nullptr otherwise */
+    std::unique_ptr<Benchmark> m_benchmark = nullptr;
+    /** rendering previews with --previews, frames are never presented */
+    bool m_previews = false;
+    /** time advances by 1/fps every frame instead of following the clock, as fast as frames can be rendered */
+    bool m_fixedTimestep = false;
 };
 } // namespace WallpaperEngine::Render::Drivers
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "GPUSelection.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Render::Drivers;
+
+std::vector<GPUSelection::GPU> GPUSelection::list () {
+    std::vector<GPU> result = {};
+    std::error_code ec;
+
+    for (const auto& entry : std::filesystem::directory_iterator ("/sys/class/drm", ec)) {
+        const std::string name = entry.path ().filename ().string ();
+
+        // connectors show up as cardN-HDMI-A-1 and the like, only the cards themselves matter
+        if (!name.starts_with ("card") || name.find ('-') != std::string::npos)
+            continue;
+
+        const auto device = entry.path () / "device";
+        GPU gpu = {.card = std::filesystem::path ("/dev/dri") / name};
+
+        for (const auto& node : std::filesystem::directory_iterator (device / "drm", ec))
+            if (node.path ().filename ().string ().starts_with ("renderD"))
+                gpu.renderNode = std::filesystem::path ("/dev/dri") / node.path ().filename ();
+
+        const std::string vendor = readLine (device / "vendor");
+
+        if (vendor == "0x8086")
+            gpu.vendor = "intel";
+        else if (vendor == "0x1002")
+            gpu.vendor = "amd";
+        else if (vendor == "0x10de")
+            gpu.vendor = "nvidia";
+        else
+            gpu.vendor = vendor;
+
+        gpu.driver = std::filesystem::read_symlink (device / "driver", ec).filename ().string ();
+
+        // the device links to its place on the bus, for PCI devices the last part is the slot
+        if (std::filesystem::read_symlink (device / "subsystem", ec).filename () == "pci")
+            gpu.pciSlot = std::filesystem::canonical (device, ec).filename ().string ();
+
+        result.push_back (gpu);
+    }
+
+    std::ranges::sort (result, [] (const GPU& a, const GPU& b) -> bool { return a.card < b.card; });
+
+    return result;
+}
+
+GPUSelection::GPU GPUSelection::find (const std::string& selector) {
+    const auto gpus = list ();
+
+    for (const auto& gpu : gpus)
+        if (gpu.vendor == selector || gpu.card == selector || gpu.renderNode == selector)
+            return gpu;
+
+    std::ostringstream available;
+
+    for (const auto& gpu : gpus)
+        available << "\n\t" << gpu.card.string () << " (" << gpu.renderNode.string () << "): " << gpu.vendor
+                  << ", " << gpu.driver;
+
+    sLog.exception ("Cannot find the GPU ", selector, ", the available ones are:", available.str ());
+}
+
+std::optional<GPUSelection::GPU> GPUSelection::selected (const std::string& selector) {
+    if (selector.empty ())
+        return std::nullopt;
+
+    return find (selector);
+}
+
+void GPUSelection::apply (const GPU& gpu) {
+    sLog.out ("Rendering on ", gpu.card, " (", gpu.vendor, ", ", gpu.driver, ")");
+
+    // Mesa takes the slot in udev's ID_PATH_TAG form, pci-0000_01_00_0
+    if (!gpu.pciSlot.empty ()) {
+        std::string tag = "pci-" + gpu.pciSlot;
+
+        std::ranges::replace (tag, ':', '_');
+        std::ranges::replace (tag, '.', '_');
+        setenv ("DRI_PRIME", tag.c_str (), 1);
+    }
+
+    // NVIDIA's own driver doesn't look at DRI_PRIME, it has its own switches for render offloading
+    if (gpu.driver == "nvidia") {
+        setenv ("__NV_PRIME_RENDER_OFFLOAD", "1", 1);
+        setenv ("__GLX_VENDOR_LIBRARY_NAME", "nvidia", 1);
+    } else {
+        setenv ("__GLX_VENDOR_LIBRARY_NAME", "mesa", 1);
+    }
+}
+
+std::string GPUSelection::readLine (const std::filesystem::path& path) {
+    std::ifstream file (path);
+    std::string line;
+
+    std::getline (file, line);
+
+    return line;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace WallpaperEngine::Render::Drivers {
+/**
+ * Finds the GPU --gpu asks for on machines with more than one
+ *
+ * GPUs are listed from /sys/class/drm, each card with its render node, PCI slot and vendor. The drivers use the
+ * nodes to pick the matching EGL device or card, everything else (GLX, mpv, Chromium's GPU process) follows the
+ * environment variables Mesa and NVIDIA's driver read for PRIME offloading
+ */
+class GPUSelection {
+  public:
+    struct GPU {
+        /** primary node, like /dev/dri/card1 */
+        std::filesystem::path card;
+        /** render node, like /dev/dri/renderD128, empty if the kernel doesn't expose one */
+        std::filesystem::path renderNode;
+        /** intel, amd, nvidia, or the PCI vendor id for anything else */
+        std::string vendor;
+        /** kernel driver bound to it, tells NVIDIA's own driver apart from nouveau */
+        std::string driver;
+        /** PCI slot the GPU sits in, like 0000:01:00.0, empty if it's not a PCI device */
+        std::string pciSlot;
+    };
+
+    /**
+     * @return Every GPU the kernel knows about, sorted by card
+     */
+    [[nodiscard]] static std::vector<GPU> list ();
+    /**
+     * @param selector A vendor name or any of the GPU's device nodes
+     *
+     * @return The first GPU matching the selector, stops with the list of GPUs if there's none
+     */
+    [[nodiscard]] static GPU find (const std::string& selector);
+    /**
+     * Looks up the GPU selected in the settings
+     *
+     * @return The selected GPU, nothing if no GPU was requested
+     */
+    [[nodiscard]] static std::optional<GPU> selected (const std::string& selector);
+    /**
+     * Sets up the environment so every GL context created from now on, in this process or its children, is
+     * created on the GPU. Has to happen before any context is created for it to apply
+     */
+    static void apply (const GPU& gpu);
+
+  private:
+    /**
+     * @return The first line of the file, empty if it can't be read
+     */
+    static std::string readLine (const std::filesystem::path& path);
+};
+} // namespace WallpaperEngine::Render::Drivers
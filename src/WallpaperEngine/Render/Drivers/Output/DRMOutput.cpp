@@ -0,0 +1,52 @@
+#include "DRMOutput.h"
+#include "../DRMOpenGLDriver.h"
+
+#include <algorithm>
+
+using namespace WallpaperEngine::Render::Drivers::Output;
+
+DRMOutput::DRMOutput (ApplicationContext& context, DRMOpenGLDriver& driver) : Output (context, driver) {
+    updateViewports ();
+}
+
+void DRMOutput::updateViewports () {
+    m_viewports.clear ();
+    const auto driver = dynamic_cast<DRMOpenGLDriver*> (&m_driver);
+    glm::ivec2 full = {0, 0};
+
+    for (const auto& screen : driver->m_screens) {
+        m_viewports [screen->name] = screen;
+
+        full.x += screen->viewport.z;
+        full.y = std::max (full.y, screen->viewport.w);
+    }
+
+    m_fullWidth = full.x;
+    m_fullHeight = full.y;
+}
+
+void DRMOutput::reset () {
+    updateViewports ();
+}
+
+bool DRMOutput::renderVFlip () const {
+    return true;
+}
+
+bool DRMOutput::renderMultiple () const {
+    return false;
+}
+
+bool DRMOutput::haveImageBuffer () const {
+    return false;
+}
+
+void* DRMOutput::getImageBuffer () const {
+    return nullptr;
+}
+
+uint32_t DRMOutput::getImageBufferSize () const {
+    return 0;
+}
+
+void DRMOutput::updateRender () const {}
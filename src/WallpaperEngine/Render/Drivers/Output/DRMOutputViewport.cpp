@@ -0,0 +1,257 @@
+#include "DRMOutputViewport.h"
+#include "../DRMOpenGLDriver.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <cstring>
+#include <utility>
+#include <xf86drm.h>
+
+using namespace WallpaperEngine::Render::Drivers;
+using namespace WallpaperEngine::Render::Drivers::Output;
+
+namespace {
+/** Kept as the buffer's user data so its framebuffer goes away with it */
+struct Framebuffer {
+    int fd;
+    uint32_t id;
+};
+
+void destroyFramebuffer (gbm_bo* bo, void* data) {
+    const auto framebuffer = static_cast<Framebuffer*> (data);
+
+    drmModeRmFB (framebuffer->fd, framebuffer->id);
+    delete framebuffer;
+}
+} // namespace
+
+DRMOutputViewport::DRMOutputViewport (DRMOpenGLDriver* driver, std::string name, const uint32_t connector,
+                                      const uint32_t crtc, const uint32_t plane,
+                                      const drmModeModeInfo& mode) :
+    OutputViewport ({0, 0, mode.hdisplay, mode.vdisplay}, std::move (name), true),
+    refreshRate (static_cast<int> (mode.vrefresh)),
+    m_driver (driver),
+    m_connector (connector),
+    m_crtc (crtc),
+    m_plane (plane),
+    m_mode (mode) {}
+
+DRMOutputViewport::~DRMOutputViewport () {
+    const int fd = this->m_driver->getFD ();
+
+    // give the screen back the way it was found, a console or whatever was there
+    if (this->m_savedCrtc != nullptr) {
+        if (this->m_savedCrtc->mode_valid)
+            drmModeSetCrtc (fd, this->m_savedCrtc->crtc_id, this->m_savedCrtc->buffer_id, this->m_savedCrtc->x,
+                            this->m_savedCrtc->y, &this->m_connector, 1, &this->m_savedCrtc->mode);
+
+        drmModeFreeCrtc (this->m_savedCrtc);
+    }
+
+    if (this->m_pending != nullptr)
+        gbm_surface_release_buffer (this->m_gbmSurface, this->m_pending);
+
+    if (this->m_front != nullptr)
+        gbm_surface_release_buffer (this->m_gbmSurface, this->m_front);
+
+    if (this->m_eglSurface != EGL_NO_SURFACE) {
+        if (this->m_driver->getEGLContext ()->current == this->m_eglSurface)
+            this->m_driver->getEGLContext ()->current = EGL_NO_SURFACE;
+
+        eglDestroySurface (this->m_driver->getEGLContext ()->display, this->m_eglSurface);
+    }
+
+    if (this->m_gbmSurface != nullptr)
+        gbm_surface_destroy (this->m_gbmSurface);
+
+    if (this->m_modeBlob != 0)
+        drmModeDestroyPropertyBlob (fd, this->m_modeBlob);
+}
+
+void DRMOutputViewport::setup () {
+    const int fd = this->m_driver->getFD ();
+
+    this->m_properties = {
+        .connectorCrtcId = this->findProperty (this->m_connector, DRM_MODE_OBJECT_CONNECTOR, "CRTC_ID"),
+        .crtcModeId = this->findProperty (this->m_crtc, DRM_MODE_OBJECT_CRTC, "MODE_ID"),
+        .crtcActive = this->findProperty (this->m_crtc, DRM_MODE_OBJECT_CRTC, "ACTIVE"),
+        .planeFbId = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "FB_ID"),
+        .planeCrtcId = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "CRTC_ID"),
+        .planeSrcX = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "SRC_X"),
+        .planeSrcY = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "SRC_Y"),
+        .planeSrcW = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "SRC_W"),
+        .planeSrcH = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "SRC_H"),
+        .planeCrtcX = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "CRTC_X"),
+        .planeCrtcY = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "CRTC_Y"),
+        .planeCrtcW = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "CRTC_W"),
+        .planeCrtcH = this->findProperty (this->m_plane, DRM_MODE_OBJECT_PLANE, "CRTC_H"),
+    };
+
+    if (drmModeCreatePropertyBlob (fd, &this->m_mode, sizeof (this->m_mode), &this->m_modeBlob) != 0)
+        sLog.exception ("Cannot create the mode blob for ", this->name, ": ", strerror (errno));
+
+    this->m_savedCrtc = drmModeGetCrtc (fd, this->m_crtc);
+    this->m_gbmSurface = gbm_surface_create (this->m_driver->getGBMDevice (), this->m_mode.hdisplay,
+                                             this->m_mode.vdisplay, GBM_FORMAT_XRGB8888,
+                                             GBM_BO_USE_SCANOUT | GBM_BO_USE_RENDERING);
+
+    if (this->m_gbmSurface == nullptr)
+        sLog.exception ("Cannot create a GBM surface for ", this->name);
+
+    const auto egl = this->m_driver->getEGLContext ();
+
+    this->m_eglSurface = egl->eglCreatePlatformWindowSurfaceEXT (egl->display, egl->config, this->m_gbmSurface, nullptr);
+
+    if (this->m_eglSurface == EGL_NO_SURFACE)
+        sLog.exception ("Cannot create an EGL surface for ", this->name, ": ", eglGetError ());
+
+    if (eglMakeCurrent (egl->display, this->m_eglSurface, this->m_eglSurface, egl->context) == EGL_FALSE)
+        sLog.exception ("Failed to make egl current");
+
+    egl->current = this->m_eglSurface;
+}
+
+DRMOpenGLDriver* DRMOutputViewport::getDriver () const {
+    return this->m_driver;
+}
+
+void DRMOutputViewport::makeCurrent () {
+    const auto egl = this->m_driver->getEGLContext ();
+
+    // render () binds the surface right before swapOutput () does, with a single screen it never changes at all
+    if (egl->current == this->m_eglSurface)
+        return;
+
+    if (eglMakeCurrent (egl->display, this->m_eglSurface, this->m_eglSurface, egl->context) == EGL_FALSE) {
+        sLog.error ("Couldn't make egl current");
+        return;
+    }
+
+    egl->current = this->m_eglSurface;
+}
+
+void DRMOutputViewport::swapOutput () {
+    const int fd = this->m_driver->getFD ();
+
+    this->makeCurrent ();
+    eglSwapBuffers (this->m_driver->getEGLContext ()->display, this->m_eglSurface);
+
+    gbm_bo* bo = gbm_surface_lock_front_buffer (this->m_gbmSurface);
+
+    if (bo == nullptr) {
+        sLog.error ("Cannot lock the buffer rendered for ", this->name);
+        this->frameRequested = true;
+        return;
+    }
+
+    const uint32_t framebuffer = this->getFramebuffer (bo);
+
+    if (framebuffer == 0) {
+        gbm_surface_release_buffer (this->m_gbmSurface, bo);
+        this->frameRequested = true;
+        return;
+    }
+
+    drmModeAtomicReq* request = drmModeAtomicAlloc ();
+    const auto& properties = this->m_properties;
+    uint32_t flags = DRM_MODE_PAGE_FLIP_EVENT;
+
+    if (!this->m_modeSet) {
+        drmModeAtomicAddProperty (request, this->m_connector, properties.connectorCrtcId, this->m_crtc);
+        drmModeAtomicAddProperty (request, this->m_crtc, properties.crtcModeId, this->m_modeBlob);
+        drmModeAtomicAddProperty (request, this->m_crtc, properties.crtcActive, 1);
+        flags |= DRM_MODE_ATOMIC_ALLOW_MODESET;
+    } else {
+        // the flip completes on the next vblank, the page flip event says when
+        flags |= DRM_MODE_ATOMIC_NONBLOCK;
+    }
+
+    // source coordinates are 16.16 fixed point
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeFbId, framebuffer);
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeCrtcId, this->m_crtc);
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeSrcX, 0);
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeSrcY, 0);
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeSrcW, static_cast<uint64_t> (this->m_mode.hdisplay) << 16);
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeSrcH, static_cast<uint64_t> (this->m_mode.vdisplay) << 16);
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeCrtcX, 0);
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeCrtcY, 0);
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeCrtcW, this->m_mode.hdisplay);
+    drmModeAtomicAddProperty (request, this->m_plane, properties.planeCrtcH, this->m_mode.vdisplay);
+
+    const int result = drmModeAtomicCommit (fd, request, flags, this);
+
+    drmModeAtomicFree (request);
+
+    if (result != 0) {
+        // without the mode nothing can be shown at all, most likely something else is DRM master
+        if (!this->m_modeSet)
+            sLog.exception ("Cannot set the mode on ", this->name, ": ", strerror (errno));
+
+        sLog.error ("Cannot flip the frame on ", this->name, ": ", strerror (errno));
+        gbm_surface_release_buffer (this->m_gbmSurface, bo);
+        this->frameRequested = true;
+        return;
+    }
+
+    this->m_modeSet = true;
+    this->m_pending = bo;
+}
+
+void DRMOutputViewport::onPageFlip () {
+    // the old buffer left the screen, GL can render into it again
+    if (this->m_front != nullptr)
+        gbm_surface_release_buffer (this->m_gbmSurface, this->m_front);
+
+    this->m_front = this->m_pending;
+    this->m_pending = nullptr;
+    this->frameRequested = true;
+}
+
+uint32_t DRMOutputViewport::findProperty (const uint32_t object, const uint32_t type, const char* name) const {
+    const int fd = this->m_driver->getFD ();
+    drmModeObjectProperties* properties = drmModeObjectGetProperties (fd, object, type);
+    uint32_t result = 0;
+
+    if (properties == nullptr)
+        return 0;
+
+    for (uint32_t i = 0; i < properties->count_props && result == 0; i++) {
+        drmModePropertyRes* property = drmModeGetProperty (fd, properties->props [i]);
+
+        if (property == nullptr)
+            continue;
+
+        if (strcmp (property->name, name) == 0)
+            result = property->prop_id;
+
+        drmModeFreeProperty (property);
+    }
+
+    drmModeFreeObjectProperties (properties);
+
+    if (result == 0)
+        sLog.exception ("Cannot find the ", name, " property for ", this->name);
+
+    return result;
+}
+
+uint32_t DRMOutputViewport::getFramebuffer (gbm_bo* bo) const {
+    if (const auto framebuffer = static_cast<Framebuffer*> (gbm_bo_get_user_data (bo)); framebuffer != nullptr)
+        return framebuffer->id;
+
+    const int fd = this->m_driver->getFD ();
+    const uint32_t handles [4] = {gbm_bo_get_handle (bo).u32};
+    const uint32_t strides [4] = {gbm_bo_get_stride (bo)};
+    const uint32_t offsets [4] = {0};
+    uint32_t id = 0;
+
+    if (drmModeAddFB2 (fd, gbm_bo_get_width (bo), gbm_bo_get_height (bo), gbm_bo_get_format (bo), handles, strides,
+                       offsets, &id, 0) != 0) {
+        sLog.error ("Cannot create a framebuffer for ", this->name, ": ", strerror (errno));
+        return 0;
+    }
+
+    // GBM surfaces cycle through the same few buffers, so this only happens for the first frames
+    gbm_bo_set_user_data (bo, new Framebuffer {fd, id}, destroyFramebuffer);
+
+    return id;
+}
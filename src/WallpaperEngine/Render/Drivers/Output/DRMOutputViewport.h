@@ -0,0 +1,116 @@
+#pragma once
+
+#ifdef ENABLE_DRM
+
+#include <EGL/egl.h>
+#include <gbm.h>
+#include <xf86drmMode.h>
+
+#include "OutputViewport.h"
+
+namespace WallpaperEngine::Render::Drivers {
+class DRMOpenGLDriver;
+
+namespace Output {
+class OutputViewport;
+
+/**
+ * A connector driven by a CRTC, its primary plane shows the buffers rendered for it
+ */
+class DRMOutputViewport final : public OutputViewport {
+  public:
+    /**
+     * @param driver
+     * @param name The connector's name as the kernel gives it (like HDMI-A-1)
+     * @param connector
+     * @param crtc CRTC free to drive the connector
+     * @param plane Primary plane of the CRTC
+     * @param mode Mode to set on the connector
+     */
+    DRMOutputViewport (DRMOpenGLDriver* driver, std::string name, uint32_t connector, uint32_t crtc,
+                       uint32_t plane, const drmModeModeInfo& mode);
+    ~DRMOutputViewport () override;
+
+    /**
+     * @return The DRM driver
+     */
+    [[nodiscard]] DRMOpenGLDriver* getDriver () const;
+
+    /** refresh rate of the mode in Hz */
+    int refreshRate = 0;
+    bool rendering = false;
+    /** the last frame didn't change so nothing was flipped, the driver has to check on it instead */
+    bool idle = false;
+    /** the previous flip is done and a new frame can be drawn once nextFrame is reached */
+    bool frameRequested = true;
+    /** render time the next frame can be drawn at, keeps every output to its own FPS limit */
+    float nextFrame = 0.0f;
+
+    /**
+     * Creates the GBM surface and the EGL surface on top of it
+     */
+    void setup ();
+
+    /**
+     * Activates output's context for drawing
+     */
+    void makeCurrent () override;
+
+    /**
+     * Puts the frame just rendered on the plane, the first one also sets the mode
+     */
+    void swapOutput () override;
+
+    /**
+     * Called with the page flip event of the last commit, the buffer it replaced can be drawn to again
+     */
+    void onPageFlip ();
+
+  private:
+    /** Property ids the atomic commits need, they're looked up by name once */
+    struct Properties {
+        uint32_t connectorCrtcId = 0;
+        uint32_t crtcModeId = 0;
+        uint32_t crtcActive = 0;
+        uint32_t planeFbId = 0;
+        uint32_t planeCrtcId = 0;
+        uint32_t planeSrcX = 0;
+        uint32_t planeSrcY = 0;
+        uint32_t planeSrcW = 0;
+        uint32_t planeSrcH = 0;
+        uint32_t planeCrtcX = 0;
+        uint32_t planeCrtcY = 0;
+        uint32_t planeCrtcW = 0;
+        uint32_t planeCrtcH = 0;
+    };
+
+    /**
+     * @return The id of the named property of the object, 0 if it doesn't have it
+     */
+    [[nodiscard]] uint32_t findProperty (uint32_t object, uint32_t type, const char* name) const;
+    /**
+     * @return The framebuffer for the buffer, added the first time the buffer is seen and removed along with it
+     */
+    [[nodiscard]] uint32_t getFramebuffer (gbm_bo* bo) const;
+
+    DRMOpenGLDriver* m_driver = nullptr;
+    uint32_t m_connector;
+    uint32_t m_crtc;
+    uint32_t m_plane;
+    drmModeModeInfo m_mode;
+    uint32_t m_modeBlob = 0;
+    Properties m_properties = {};
+    /** what the CRTC was showing before, put back when the program stops */
+    drmModeCrtc* m_savedCrtc = nullptr;
+    gbm_surface* m_gbmSurface = nullptr;
+    EGLSurface m_eglSurface = EGL_NO_SURFACE;
+    /** buffer on screen right now */
+    gbm_bo* m_front = nullptr;
+    /** buffer committed but not flipped yet */
+    gbm_bo* m_pending = nullptr;
+    /** the mode is set with the first commit */
+    bool m_modeSet = false;
+};
+} // namespace Output
+} // namespace WallpaperEngine::Render::Drivers
+#endif /* ENABLE_DRM */
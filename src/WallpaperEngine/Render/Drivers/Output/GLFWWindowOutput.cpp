@@ -13,8 +13,10 @@ GLFWWindowOutput::GLFWWindowOutput (ApplicationContext& context, VideoDriver& dr
         this->m_context.settings.render.mode != Application::ApplicationContext::EXPLICIT_WINDOW)
         sLog.exception ("Initializing window output when not in output mode, how did you get here?!");
 
-    // window should be visible
-    driver.showWindow ();
+    // window should be visible, benchmarks, previews and cooking render offscreen
+    if (this->m_context.settings.general.benchmarkFrames == 0 && this->m_context.settings.screenshot.previews.empty () &&
+        !this->m_context.settings.general.cook)
+        driver.showWindow ();
 
     if (this->m_context.settings.render.mode == Application::ApplicationContext::EXPLICIT_WINDOW) {
         this->m_fullWidth = this->m_context.settings.render.window.geometry.z;
@@ -17,3 +17,7 @@ int Output::getFullWidth () const {
 int Output::getFullHeight () const {
     return this->m_fullHeight;
 }
+
+void Output::updateRegions (const std::vector<glm::ivec4>& regions) const {
+    this->updateRender ();
+}
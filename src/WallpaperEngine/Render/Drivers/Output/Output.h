@@ -3,6 +3,7 @@
 #include <glm/vec4.hpp>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "WallpaperEngine/Application/ApplicationContext.h"
 #include "WallpaperEngine/Render/Drivers/Detectors/FullScreenDetector.h"
@@ -40,6 +41,12 @@ class Output {
     virtual void* getImageBuffer () const = 0;
     virtual uint32_t getImageBufferSize () const = 0;
     virtual void updateRender () const = 0;
+    /**
+     * Presents only part of the image buffer, outputs that can't do that present all of it
+     *
+     * @param regions x, y, width and height of every region that changed, in image coordinates
+     */
+    virtual void updateRegions (const std::vector<glm::ivec4>& regions) const;
 
   protected:
     mutable int m_fullWidth = 0;
@@ -7,11 +7,16 @@
 extern "C" {
 #include "wlr-layer-shell-unstable-v1-protocol.h"
 #include "xdg-shell-protocol.h"
+#ifdef ENABLE_FRACTIONAL_SCALE
+#include "fractional-scale-v1-protocol.h"
+#include "viewporter-protocol.h"
+#endif /* ENABLE_FRACTIONAL_SCALE */
 }
 #undef class
 #undef namespace
 #undef static
 
+#include <cmath>
 
 using namespace WallpaperEngine::Render::Drivers;
 using namespace WallpaperEngine::Render::Drivers::Output;
@@ -19,7 +24,10 @@ using namespace WallpaperEngine::Render::Drivers::Output;
 static void handleLSConfigure (void* data, zwlr_layer_surface_v1* surface, uint32_t serial, uint32_t w, uint32_t h) {
     const auto viewport = static_cast<WaylandOutputViewport*> (data);
     viewport->size = {w, h};
-    viewport->viewport = {0, 0, viewport->size.x * viewport->scale, viewport->size.y * viewport->scale};
+
+    const glm::ivec2 buffer = viewport->getBufferSize ();
+
+    viewport->viewport = {0, 0, buffer.x, buffer.y};
     viewport->resize ();
 
     zwlr_layer_surface_v1_ack_configure (surface, serial);
@@ -41,17 +49,29 @@ static void mode (void* data, wl_output* output, uint32_t flags, int32_t width,
 
     // update viewport size too
     viewport->size = {width, height};
-    viewport->viewport = {0, 0, viewport->size.x * viewport->scale, viewport->size.y * viewport->scale};
+    // wayland gives it in mHz
+    viewport->refreshRate = (refresh + 500) / 1000;
+    const glm::ivec2 buffer = viewport->getBufferSize ();
+
+    viewport->viewport = {0, 0, buffer.x, buffer.y};
 
     if (viewport->layerSurface)
         viewport->resize ();
 
-    if (viewport->initialized)
+    // resize () updates the output's viewports itself once there's a window
+    if (viewport->initialized && !viewport->eglWindow)
         viewport->getDriver ()->getOutput ().reset ();
 }
 
 static void done (void* data, wl_output* wl_output) {
-    static_cast<WaylandOutputViewport*> (data)->initialized = true;
+    const auto viewport = static_cast<WaylandOutputViewport*> (data);
+
+    if (viewport->initialized)
+        return;
+
+    viewport->initialized = true;
+    // screens plugged in after startup are only complete now that every property came in
+    viewport->getDriver ()->onOutputReady (viewport);
 }
 
 static void scale (void* data, wl_output* wl_output, int32_t scale) {
@@ -59,10 +79,14 @@ static void scale (void* data, wl_output* wl_output, int32_t scale) {
 
     viewport->scale = scale;
 
+    const glm::ivec2 buffer = viewport->getBufferSize ();
+
+    viewport->viewport = {0, 0, buffer.x, buffer.y};
+
     if (viewport->layerSurface)
         viewport->resize ();
 
-    if (viewport->initialized)
+    if (viewport->initialized && !viewport->eglWindow)
         viewport->getDriver ()->getOutput ().reset ();
 }
 
@@ -86,11 +110,25 @@ static void surfaceFrameCallback (void* data, struct wl_callback* cb, uint32_t t
     wl_callback_destroy (cb);
 
     viewport->frameCallback = nullptr;
-    viewport->rendering = true;
-    viewport->getDriver ()->getApp ().update (viewport);
-    viewport->rendering = false;
+    // the driver renders it when it's due, outputs with a lower FPS limit skip some of these
+    viewport->frameRequested = true;
+}
+
+#ifdef ENABLE_FRACTIONAL_SCALE
+static void preferredScale (void* data, wp_fractional_scale_v1* fractionalScale, uint32_t scale) {
+    const auto viewport = static_cast<WaylandOutputViewport*> (data);
+
+    viewport->fractionalScale = scale;
+
+    const glm::ivec2 buffer = viewport->getBufferSize ();
+
+    viewport->viewport = {0, 0, buffer.x, buffer.y};
+    viewport->resize ();
 }
 
+constexpr struct wp_fractional_scale_v1_listener fractionalScaleListener = {.preferred_scale = preferredScale};
+#endif /* ENABLE_FRACTIONAL_SCALE */
+
 constexpr struct wl_callback_listener frameListener = {.done = surfaceFrameCallback};
 
 constexpr wl_output_listener outputListener = {
@@ -130,12 +168,26 @@ void WaylandOutputViewport::setupLS () {
                                           ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP | ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM);
     zwlr_layer_surface_v1_set_keyboard_interactivity (layerSurface, false);
     zwlr_layer_surface_v1_add_listener (layerSurface, &layerSurfaceListener, this);
+
+#ifdef ENABLE_FRACTIONAL_SCALE
+    // the buffer is rendered at exactly the physical size and the viewport maps it onto the surface, instead of
+    // rendering at the next integer scale for the compositor to shrink it
+    if (m_driver->getWaylandContext ()->viewporter && m_driver->getWaylandContext ()->fractionalScaleManager) {
+        surfaceViewport = wp_viewporter_get_viewport (m_driver->getWaylandContext ()->viewporter, surface);
+        fractionalScaleObject = wp_fractional_scale_manager_v1_get_fractional_scale (
+            m_driver->getWaylandContext ()->fractionalScaleManager, surface);
+        wp_fractional_scale_v1_add_listener (fractionalScaleObject, &fractionalScaleListener, this);
+    }
+#endif /* ENABLE_FRACTIONAL_SCALE */
+
     zwlr_layer_surface_v1_set_exclusive_zone (layerSurface, -1);
     wl_surface_set_input_region (surface, region);
     wl_surface_commit (surface);
     wl_display_roundtrip (m_driver->getWaylandContext ()->display);
 
-    eglWindow = wl_egl_window_create (surface, size.x * scale, size.y * scale);
+    const glm::ivec2 buffer = this->getBufferSize ();
+
+    eglWindow = wl_egl_window_create (surface, buffer.x, buffer.y);
     eglSurface = m_driver->getEGLContext ()->eglCreatePlatformWindowSurfaceEXT (
         m_driver->getEGLContext ()->display, m_driver->getEGLContext ()->config, eglWindow, nullptr);
     wl_surface_commit (surface);
@@ -159,19 +211,46 @@ void WaylandOutputViewport::setupLS () {
                         m_driver->getEGLContext ()->context) == EGL_FALSE)
         sLog.exception ("Failed to make egl current");
 
+    m_driver->getEGLContext ()->current = eglSurface;
+
     this->m_driver->getOutput ().reset ();
 }
 
+double WaylandOutputViewport::getScale () const {
+    // the protocol gives it with a denominator of 120
+    if (this->surfaceViewport && this->fractionalScale != 0)
+        return static_cast<double> (this->fractionalScale) / 120.0;
+
+    return this->scale;
+}
+
+glm::ivec2 WaylandOutputViewport::getBufferSize () const {
+    const double factor = this->getScale ();
+
+    return {
+        static_cast<int> (std::round (this->size.x * factor)),
+        static_cast<int> (std::round (this->size.y * factor)),
+    };
+}
+
 WaylandOpenGLDriver* WaylandOutputViewport::getDriver () const {
     return this->m_driver;
 }
 
 void WaylandOutputViewport::makeCurrent () {
+    // render () binds the surface right before swapOutput () does, with a single screen it never changes at all
+    if (m_driver->getEGLContext ()->current == eglSurface)
+        return;
+
     const EGLBoolean result = eglMakeCurrent (m_driver->getEGLContext ()->display, eglSurface, eglSurface,
                                               m_driver->getEGLContext ()->context);
 
-    if (result == EGL_FALSE)
+    if (result == EGL_FALSE) {
         sLog.error ("Couldn't make egl current");
+        return;
+    }
+
+    m_driver->getEGLContext ()->current = eglSurface;
 }
 
 void WaylandOutputViewport::swapOutput () {
@@ -181,16 +260,30 @@ void WaylandOutputViewport::swapOutput () {
     frameCallback = wl_surface_frame (surface);
     wl_callback_add_listener (frameCallback, &frameListener, this);
     eglSwapBuffers (m_driver->getEGLContext ()->display, this->eglSurface);
-    wl_surface_set_buffer_scale (surface, scale);
-    wl_surface_damage_buffer (surface, 0, 0, INT32_MAX, INT32_MAX);
+
+    // with a viewport the buffer scale stays at 1, the viewport's destination does the mapping
+    if (!this->surfaceViewport)
+        wl_surface_set_buffer_scale (surface, scale);
+
+    const glm::ivec2 buffer = this->getBufferSize ();
+
+    // every surface holds one viewport only, and swapOutput () is only reached when it changed
+    wl_surface_damage_buffer (surface, 0, 0, buffer.x, buffer.y);
     wl_surface_commit (surface);
 }
 
 void WaylandOutputViewport::resize () {
+#ifdef ENABLE_FRACTIONAL_SCALE
+    if (this->surfaceViewport && this->size.x > 0 && this->size.y > 0)
+        wp_viewport_set_destination (this->surfaceViewport, this->size.x, this->size.y);
+#endif /* ENABLE_FRACTIONAL_SCALE */
+
     if (!this->eglWindow)
         return;
 
-    wl_egl_window_resize (this->eglWindow, this->size.x * this->scale, this->size.y * this->scale, 0, 0);
+    const glm::ivec2 buffer = this->getBufferSize ();
+
+    wl_egl_window_resize (this->eglWindow, buffer.x, buffer.y, 0, 0);
 
     this->getDriver ()->getOutput ().reset ();
 }
\ No newline at end of file
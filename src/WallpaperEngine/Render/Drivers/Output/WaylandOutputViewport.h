@@ -16,6 +16,8 @@
 
 struct zwlr_layer_shell_v1;
 struct zwlr_layer_surface_v1;
+struct wp_viewport;
+struct wp_fractional_scale_v1;
 
 namespace WallpaperEngine::Render::Drivers {
 class WaylandOpenGLDriver;
@@ -36,6 +38,10 @@ class WaylandOutputViewport final : public OutputViewport {
     glm::ivec2 size = {};
     uint32_t waylandName;
     int scale = 1;
+    /** scale the compositor wants the surface at in 120ths, 0 until it says (or without fractional scaling) */
+    uint32_t fractionalScale = 0;
+    /** refresh rate of the current mode in Hz, 0 if the compositor didn't say */
+    int refreshRate = 0;
     bool initialized = false;
     bool rendering = false;
 
@@ -43,6 +49,9 @@ class WaylandOutputViewport final : public OutputViewport {
     EGLSurface eglSurface = nullptr;
     wl_surface* surface = nullptr;
     zwlr_layer_surface_v1* layerSurface = nullptr;
+    /** maps the buffer onto the surface when it's not at an integer scale */
+    wp_viewport* surfaceViewport = nullptr;
+    wp_fractional_scale_v1* fractionalScaleObject = nullptr;
     wl_callback* frameCallback = nullptr;
     glm::dvec2 mousePos = {0, 0};
     WallpaperEngine::Input::MouseClickStatus leftClick = WallpaperEngine::Input::MouseClickStatus::Released;
@@ -50,9 +59,24 @@ class WaylandOutputViewport final : public OutputViewport {
     wl_cursor* pointer = nullptr;
     wl_surface* cursorSurface = nullptr;
     bool callbackInitialized = false;
+    /** the last frame didn't change so no frame callback was requested, the driver has to check on it instead */
+    bool idle = false;
+    /** the compositor is ready for a new frame, the driver draws it once nextFrame is reached */
+    bool frameRequested = false;
+    /** render time the next frame can be drawn at, keeps every output to its own FPS limit */
+    float nextFrame = 0.0f;
 
     void setupLS ();
 
+    /**
+     * @return Physical pixels per surface pixel, fractional if the compositor supports it
+     */
+    [[nodiscard]] double getScale () const;
+    /**
+     * @return Size of the buffer rendered to, the surface's size in physical pixels
+     */
+    [[nodiscard]] glm::ivec2 getBufferSize () const;
+
     /**
      * Activates output's context for drawing
      */
@@ -4,10 +4,28 @@
 
 #include <X11/Xatom.h>
 #include <X11/Xlib.h>
+#include <X11/Xutil.h>
 #include <X11/extensions/Xrandr.h>
 
+#ifdef ENABLE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif /* ENABLE_XSHM */
+
 using namespace WallpaperEngine::Render::Drivers::Output;
 
+#ifdef ENABLE_XSHM
+namespace {
+bool shmAttachFailed = false;
+
+int ShmAttachErrorHandler (Display* dpy, XErrorEvent* event) {
+    shmAttachFailed = true;
+
+    return 0;
+}
+} // namespace
+#endif /* ENABLE_XSHM */
+
 void CustomXIOErrorExitHandler (Display* dsp, void* userdata) {
     const auto context = static_cast<X11Output*> (userdata);
 
@@ -29,10 +47,11 @@ int CustomXIOErrorHandler (Display* dsp) {
     return 0;
 }
 
-X11Output::X11Output (ApplicationContext& context, VideoDriver& driver) : Output (context, driver),
+X11Output::X11Output (ApplicationContext& context, VideoDriver& driver, Window window) : Output (context, driver),
     m_display (nullptr),
     m_pixmap (None),
     m_root (None),
+    m_window (window),
     m_gc (None),
     m_imageData (nullptr),
     m_imageSize (0),
@@ -65,11 +84,35 @@ void X11Output::free () {
 
     this->m_viewports.clear ();
 
-    // free all the resources we've got
-    XDestroyImage (this->m_image);
-    XFreeGC (this->m_display, this->m_gc);
-    XFreePixmap (this->m_display, this->m_pixmap);
-    delete this->m_imageData;
+    // free all the resources we've got, the image's data is not Xlib's to free
+    if (this->m_image != nullptr) {
+        this->m_image->data = nullptr;
+        XDestroyImage (this->m_image);
+        this->m_image = nullptr;
+    }
+
+#ifdef ENABLE_XSHM
+    if (this->m_useShm) {
+        XShmDetach (this->m_display, &this->m_shm);
+        shmdt (this->m_shm.shmaddr);
+        this->m_shm = {};
+        this->m_useShm = false;
+    } else {
+        delete [] this->m_imageData;
+    }
+#else
+    delete [] this->m_imageData;
+#endif /* ENABLE_XSHM */
+
+    this->m_imageData = nullptr;
+
+    if (this->m_gc != None)
+        XFreeGC (this->m_display, this->m_gc);
+    if (this->m_pixmap != None)
+        XFreePixmap (this->m_display, this->m_pixmap);
+
+    this->m_gc = None;
+    this->m_pixmap = None;
     XCloseDisplay (this->m_display);
 }
 
@@ -78,7 +121,8 @@ void* X11Output::getImageBuffer () const {
 }
 
 bool X11Output::renderVFlip () const {
-    return false;
+    // the readback writes the rows bottom to top, only the window shows them as they're rendered
+    return this->m_desktopWindow;
 }
 
 bool X11Output::renderMultiple () const {
@@ -86,7 +130,7 @@ bool X11Output::renderMultiple () const {
 }
 
 bool X11Output::haveImageBuffer () const {
-    return true;
+    return !this->m_desktopWindow;
 }
 
 uint32_t X11Output::getImageBufferSize () const {
@@ -110,6 +154,7 @@ void X11Output::loadScreenInfo () {
     this->m_root = DefaultRootWindow (this->m_display);
     this->m_fullWidth = DisplayWidth (this->m_display, DefaultScreen (this->m_display));
     this->m_fullHeight = DisplayHeight (this->m_display, DefaultScreen (this->m_display));
+    this->m_desktopWindow = this->useDesktopWindow ();
     XRRScreenResources* screenResources = XRRGetScreenResources (this->m_display, DefaultRootWindow (this->m_display));
 
     if (screenResources == nullptr) {
@@ -130,8 +175,11 @@ void X11Output::loadScreenInfo () {
         if (crtc == nullptr)
             continue;
 
+        // the window is drawn to directly, so its viewports are in OpenGL's coordinates with Y going up
+        const int y = this->m_desktopWindow ? this->m_fullHeight - crtc->y - static_cast<int> (crtc->height) : crtc->y;
+
         // add the screen to the list of screens
-        this->m_screens.push_back (new GLFWOutputViewport {{crtc->x, crtc->y, crtc->width, crtc->height}, info->name});
+        this->m_screens.push_back (new GLFWOutputViewport {{crtc->x, y, crtc->width, crtc->height}, info->name});
 
         // only keep info of registered screens
         if (this->m_context.settings.general.screenBackgrounds.find (info->name) !=
@@ -139,8 +187,7 @@ void X11Output::loadScreenInfo () {
             sLog.out ("Found requested screen: ", info->name, " -> ", crtc->x, "x", crtc->y, ":", crtc->width, "x",
                       crtc->height);
 
-            this->m_viewports [info->name] =
-                new GLFWOutputViewport {{crtc->x, crtc->y, crtc->width, crtc->height}, info->name};
+            this->m_viewports [info->name] = new GLFWOutputViewport {{crtc->x, y, crtc->width, crtc->height}, info->name};
         }
 
         XRRFreeCrtcInfo (crtc);
@@ -176,6 +223,12 @@ void X11Output::loadScreenInfo () {
         sLog.exception ("Cannot continue...");
     }
 
+    if (this->m_desktopWindow) {
+        this->setupDesktopWindow ();
+        return;
+    }
+
+    sLog.debug ("Copying the frames into the root window's pixmap");
 
     // create pixmap so we can draw things in there
     this->m_pixmap = XCreatePixmap (this->m_display, this->m_root, this->m_fullWidth, this->m_fullHeight, 24);
@@ -184,31 +237,163 @@ void X11Output::loadScreenInfo () {
     XFillRectangle (this->m_display, this->m_pixmap, this->m_gc, 0, 0, this->m_fullWidth, this->m_fullHeight);
     // set the window background as our pixmap
     XSetWindowBackgroundPixmap (this->m_display, this->m_root, this->m_pixmap);
-    // allocate space for the image's data
+    // these never change, look them up once instead of on every frame
+    this->m_rootPixmapAtom = XInternAtom (this->m_display, "_XROOTPMAP_ID", False);
+    this->m_esetrootPixmapAtom = XInternAtom (this->m_display, "ESETROOT_PMAP_ID", False);
+    this->createImage ();
+    // setup driver's render changing the window's size
+    this->m_driver.resizeWindow ({this->m_fullWidth, this->m_fullHeight});
+}
+
+bool X11Output::useDesktopWindow () const {
+    const std::string& mode = this->m_context.settings.render.x11Output;
+
+    if (mode == "root" || this->m_window == None)
+        return false;
+    if (mode == "window")
+        return true;
+
+    // without a compositor the root window's pixmap is what every program expects to find the background in
+    const std::string selection = "_NET_WM_CM_S" + std::to_string (DefaultScreen (this->m_display));
+
+    return XGetSelectionOwner (this->m_display, XInternAtom (this->m_display, selection.c_str (), False)) != None;
+}
+
+void X11Output::setupDesktopWindow () const {
+    sLog.debug ("Drawing the frames into a desktop window");
+
+    const Atom type = XInternAtom (this->m_display, "_NET_WM_WINDOW_TYPE_DESKTOP", False);
+    const Atom state [] = {
+        XInternAtom (this->m_display, "_NET_WM_STATE_BELOW", False),
+        XInternAtom (this->m_display, "_NET_WM_STATE_STICKY", False),
+        XInternAtom (this->m_display, "_NET_WM_STATE_SKIP_TASKBAR", False),
+        XInternAtom (this->m_display, "_NET_WM_STATE_SKIP_PAGER", False),
+    };
+    // shown on every workspace
+    const long workspace = 0xFFFFFFFF;
+
+    XChangeProperty (this->m_display, this->m_window, XInternAtom (this->m_display, "_NET_WM_WINDOW_TYPE", False),
+                     XA_ATOM, 32, PropModeReplace, (unsigned char*) &type, 1);
+    XChangeProperty (this->m_display, this->m_window, XInternAtom (this->m_display, "_NET_WM_STATE", False),
+                     XA_ATOM, 32, PropModeReplace, (unsigned char*) state, std::size (state));
+    XChangeProperty (this->m_display, this->m_window, XInternAtom (this->m_display, "_NET_WM_DESKTOP", False),
+                     XA_CARDINAL, 32, PropModeReplace, (unsigned char*) &workspace, 1);
+    // the window is mapped through the driver's connection, the properties have to be there before it is
+    XSync (this->m_display, False);
+
+    this->m_driver.resizeWindow ({0, 0, this->m_fullWidth, this->m_fullHeight});
+    this->m_driver.showWindow ();
+
+    XLowerWindow (this->m_display, this->m_window);
+    XFlush (this->m_display);
+}
+
+void X11Output::createImage () {
     this->m_imageSize = this->m_fullWidth * this->m_fullHeight * 4;
-    this->m_imageData = new char [this->m_fullWidth * this->m_fullHeight * 4];
+
+#ifdef ENABLE_XSHM
+    // the server reads the pixels straight from our memory instead of them going through the socket
+    if (XShmQueryExtension (this->m_display)) {
+        Visual* visual = DefaultVisual (this->m_display, DefaultScreen (this->m_display));
+
+        this->m_image = XShmCreateImage (this->m_display, visual, 24, ZPixmap, nullptr, &this->m_shm,
+                                         this->m_fullWidth, this->m_fullHeight);
+    }
+
+    if (this->m_image != nullptr) {
+        const uint32_t size = this->m_image->bytes_per_line * this->m_image->height;
+
+        this->m_shm.shmid = shmget (IPC_PRIVATE, size, IPC_CREAT | 0600);
+        this->m_shm.shmaddr = this->m_shm.shmid == -1 ? reinterpret_cast<char*> (-1)
+                                                      : static_cast<char*> (shmat (this->m_shm.shmid, nullptr, 0));
+        this->m_shm.readOnly = False;
+
+        if (this->m_shm.shmaddr != reinterpret_cast<char*> (-1)) {
+            // attaching fails on remote displays, which only shows up as an X error
+            shmAttachFailed = false;
+
+            const auto previous = XSetErrorHandler (ShmAttachErrorHandler);
+
+            XShmAttach (this->m_display, &this->m_shm);
+            XSync (this->m_display, False);
+            XSetErrorHandler (previous);
+
+            this->m_useShm = !shmAttachFailed;
+        }
+
+        // the segment goes away once both sides detach
+        if (this->m_shm.shmid != -1)
+            shmctl (this->m_shm.shmid, IPC_RMID, nullptr);
+
+        // readback writes tightly packed rows, any padding would skew the image
+        if (this->m_useShm && size == this->m_imageSize) {
+            this->m_imageData = this->m_shm.shmaddr;
+            this->m_image->data = this->m_shm.shmaddr;
+            return;
+        }
+
+        sLog.debug ("MIT-SHM is not usable, falling back to XPutImage");
+
+        if (this->m_useShm)
+            XShmDetach (this->m_display, &this->m_shm);
+        if (this->m_shm.shmaddr != reinterpret_cast<char*> (-1))
+            shmdt (this->m_shm.shmaddr);
+
+        XDestroyImage (this->m_image);
+        this->m_image = nullptr;
+        this->m_shm = {};
+        this->m_useShm = false;
+    }
+#endif /* ENABLE_XSHM */
+
+    // allocate space for the image's data
+    this->m_imageData = new char [this->m_imageSize];
     // create an image so we can copy it over
     this->m_image = XCreateImage (this->m_display, CopyFromParent, 24, ZPixmap, 0, this->m_imageData, this->m_fullWidth,
                                   this->m_fullHeight, 32, 0);
-    // setup driver's render changing the window's size
-    this->m_driver.resizeWindow ({this->m_fullWidth, this->m_fullHeight});
 }
 
 void X11Output::updateRender () const {
-    // put the image back into the screen
-    XPutImage (this->m_display, this->m_pixmap, this->m_gc, this->m_image, 0, 0, 0, 0, this->m_fullWidth,
-               this->m_fullHeight);
+    // the frame is already in the window, the swap shows it
+    if (this->m_desktopWindow)
+        return;
+
+    this->updateRegions ({{0, 0, this->m_fullWidth, this->m_fullHeight}});
+}
+
+void X11Output::updateRegions (const std::vector<glm::ivec4>& regions) const {
+    // put the changed parts of the image back into the screen
+    for (const glm::ivec4& region : regions) {
+#ifdef ENABLE_XSHM
+        if (this->m_useShm) {
+            XShmPutImage (this->m_display, this->m_pixmap, this->m_gc, this->m_image, region.x, region.y, region.x,
+                          region.y, region.z, region.w, False);
+            continue;
+        }
+#endif /* ENABLE_XSHM */
+
+        XPutImage (this->m_display, this->m_pixmap, this->m_gc, this->m_image, region.x, region.y, region.x, region.y,
+                   region.z, region.w);
+    }
 
     // _XROOTPMAP_ID & ESETROOT_PMAP_ID allow other programs (compositors) to
     // edit the background. Without these, other programs will clear the screen.
     // it also forces the compositor to refresh the background (tested with picom)
-    const Atom prop_root = XInternAtom (this->m_display, "_XROOTPMAP_ID", False);
-    const Atom prop_esetroot = XInternAtom (this->m_display, "ESETROOT_PMAP_ID", False);
-    XChangeProperty (this->m_display, this->m_root, prop_root, XA_PIXMAP, 32, PropModeReplace,
+    XChangeProperty (this->m_display, this->m_root, this->m_rootPixmapAtom, XA_PIXMAP, 32, PropModeReplace,
                      (unsigned char*) &this->m_pixmap, 1);
-    XChangeProperty (this->m_display, this->m_root, prop_esetroot, XA_PIXMAP, 32, PropModeReplace,
+    XChangeProperty (this->m_display, this->m_root, this->m_esetrootPixmapAtom, XA_PIXMAP, 32, PropModeReplace,
                      (unsigned char*) &this->m_pixmap, 1);
 
-    XClearWindow (this->m_display, this->m_root);
+    for (const glm::ivec4& region : regions)
+        XClearArea (this->m_display, this->m_root, region.x, region.y, region.z, region.w, False);
+
+#ifdef ENABLE_XSHM
+    // the next frame is written into the same memory, the server has to be done reading it by then
+    if (this->m_useShm) {
+        XSync (this->m_display, False);
+        return;
+    }
+#endif /* ENABLE_XSHM */
+
     XFlush (this->m_display);
 }
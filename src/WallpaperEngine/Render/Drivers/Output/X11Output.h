@@ -5,6 +5,9 @@
 #include <string>
 
 #include <X11/Xlib.h>
+#ifdef ENABLE_XSHM
+#include <X11/extensions/XShm.h>
+#endif /* ENABLE_XSHM */
 
 #include "Output.h"
 #include "WallpaperEngine/Render/Drivers/VideoDriver.h"
@@ -12,7 +15,10 @@
 namespace WallpaperEngine::Render::Drivers::Output {
 class X11Output final : public Output {
   public:
-    X11Output (ApplicationContext& context, VideoDriver& driver);
+    /**
+     * @param window The driver's window, frames are drawn straight into it when it's used as the desktop
+     */
+    X11Output (ApplicationContext& context, VideoDriver& driver, Window window);
     ~X11Output () override;
 
     void reset () override;
@@ -23,18 +29,41 @@ class X11Output final : public Output {
     void* getImageBuffer () const override;
     uint32_t getImageBufferSize () const override;
     void updateRender () const override;
+    void updateRegions (const std::vector<glm::ivec4>& regions) const override;
 
   private:
     void loadScreenInfo ();
+    /**
+     * @return If the frames should be drawn into the desktop window instead of copied into the root window's pixmap
+     */
+    bool useDesktopWindow () const;
+    /**
+     * Turns the driver's window into a desktop window covering every screen, below everything else
+     */
+    void setupDesktopWindow () const;
+    /**
+     * Creates the image the frames are copied into, in a segment shared with the X server when MIT-SHM is usable
+     */
+    void createImage ();
     void free ();
 
     Display* m_display = nullptr;
     Pixmap m_pixmap;
     Window m_root;
+    Window m_window;
+    /** frames go straight to m_window, there's no pixmap or image */
+    bool m_desktopWindow = false;
     GC m_gc;
     char* m_imageData = nullptr;
     uint32_t m_imageSize = 0;
     XImage* m_image = nullptr;
+    Atom m_rootPixmapAtom = None;
+    Atom m_esetrootPixmapAtom = None;
+#ifdef ENABLE_XSHM
+    XShmSegmentInfo m_shm = {};
+    /** the image's data lives in m_shm and XShmPutImage is used to update the pixmap */
+    bool m_useShm = false;
+#endif /* ENABLE_XSHM */
     std::vector<OutputViewport*> m_screens = {};
 };
 } // namespace WallpaperEngine::Render::Drivers::Output
\ No newline at end of file
@@ -11,6 +11,20 @@ WallpaperApplication& VideoDriver::getApp () const {
     return this->m_app;
 }
 
+int VideoDriver::getRefreshRate () const {
+    return 0;
+}
+
+void VideoDriver::wakeUp () const {}
+
+void* VideoDriver::getX11Display () const {
+    return nullptr;
+}
+
+void* VideoDriver::getWaylandDisplay () const {
+    return nullptr;
+}
+
 InputContext& VideoDriver::getInputContext () {
     return this->m_inputContext;
 }
\ No newline at end of file
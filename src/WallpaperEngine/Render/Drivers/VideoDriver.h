@@ -23,6 +23,9 @@ class FullScreenDetector;
 
 class VideoDriver {
   public:
+    /** Seconds between checks for changes while the wallpapers keep showing the same frame */
+    static constexpr float IDLE_WAKEUP_TIME = 0.1f;
+
     explicit VideoDriver (WallpaperApplication& app, Input::MouseInput& mouseInput);
     virtual ~VideoDriver () = default;
 
@@ -62,6 +65,23 @@ class VideoDriver {
      * @return The number of rendered frames since the start of the driver
      */
     [[nodiscard]] virtual uint32_t getFrameCounter () const = 0;
+    /**
+     * @return Refresh rate of the fastest screen in Hz, 0 if it's not known
+     */
+    [[nodiscard]] virtual int getRefreshRate () const;
+    /**
+     * Wakes the driver up if it's waiting on idle screens, so a frame that just became available is shown right away
+     * instead of on the next check. Can be called from any thread
+     */
+    virtual void wakeUp () const;
+    /**
+     * @return The X11 Display* the driver is connected to, nullptr if it doesn't use X11
+     */
+    [[nodiscard]] virtual void* getX11Display () const;
+    /**
+     * @return The wl_display* the driver is connected to, nullptr if it doesn't use Wayland
+     */
+    [[nodiscard]] virtual void* getWaylandDisplay () const;
     /**
      * @param name
      * @return GetProcAddress for this video driver
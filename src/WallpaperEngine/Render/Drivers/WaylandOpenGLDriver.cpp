@@ -1,6 +1,8 @@
 #include "WaylandOpenGLDriver.h"
+#include "GPUSelection.h"
 #include "VideoFactories.h"
 #include "WallpaperEngine/Application/WallpaperApplication.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
 #include "WallpaperEngine/Logging/Log.h"
 
 #define class _class
@@ -10,12 +12,26 @@ extern "C" {
 #include "wlr-layer-shell-unstable-v1-protocol.h"
 #include "xdg-shell-protocol.h"
 #include <linux/input-event-codes.h>
+#ifdef ENABLE_FRACTIONAL_SCALE
+#include "fractional-scale-v1-protocol.h"
+#include "viewporter-protocol.h"
+#endif /* ENABLE_FRACTIONAL_SCALE */
 }
 #undef class
 #undef namespace
 #undef static
 
+// newer than some of the EGL headers still around
+#ifndef EGL_DRM_RENDER_NODE_FILE_EXT
+#define EGL_DRM_RENDER_NODE_FILE_EXT 0x3377
+#endif /* EGL_DRM_RENDER_NODE_FILE_EXT */
+
+#include <algorithm>
+#include <cmath>
+#include <fcntl.h>
+#include <poll.h>
 #include <string.h>
+#include <tuple>
 #include <unistd.h>
 
 using namespace WallpaperEngine::Render::Drivers;
@@ -25,6 +41,7 @@ static void handlePointerEnter (void* data, struct wl_pointer* wl_pointer, uint3
     const auto driver = static_cast<WaylandOpenGLDriver*> (data);
     const auto viewport = driver->surfaceToViewport (surface);
     driver->viewportInFocus = viewport;
+    driver->mouseGeneration++;
     wl_surface_set_buffer_scale (viewport->cursorSurface, viewport->scale);
     wl_surface_attach (viewport->cursorSurface, wl_cursor_image_get_buffer (viewport->pointer->images [0]), 0, 0);
     wl_pointer_set_cursor (wl_pointer, serial, viewport->cursorSurface, viewport->pointer->images [0]->hotspot_x,
@@ -51,7 +68,10 @@ static void handlePointerMotion (void* data, struct wl_pointer* wl_pointer, uint
     const double viewportHeight = static_cast<double> (driver->viewportInFocus->size.y);
     y = viewportHeight - y;
 
-    driver->viewportInFocus->mousePos = {x * driver->viewportInFocus->scale, y * driver->viewportInFocus->scale};
+    const double scale = driver->viewportInFocus->getScale ();
+
+    driver->viewportInFocus->mousePos = {x * scale, y * scale};
+    driver->mouseGeneration++;
 }
 
 static void handlePointerButton (void* data, struct wl_pointer* wl_pointer, uint32_t serial, uint32_t time,
@@ -74,6 +94,8 @@ static void handlePointerButton (void* data, struct wl_pointer* wl_pointer, uint
             driver->viewportInFocus->rightClick = WallpaperEngine::Input::MouseClickStatus::Released;
         }
     }
+
+    driver->mouseGeneration++;
 }
 
 constexpr struct wl_pointer_listener pointerListener = {.enter = handlePointerEnter,
@@ -110,10 +132,19 @@ static void handleGlobal (void* data, struct wl_registry* registry, uint32_t nam
             static_cast<wl_seat*> (wl_registry_bind (registry, name, &wl_seat_interface, 1));
         wl_seat_add_listener (driver->getWaylandContext ()->seat, &seatListener, driver);
     }
+#ifdef ENABLE_FRACTIONAL_SCALE
+    else if (strcmp (interface, wp_viewporter_interface.name) == 0) {
+        driver->getWaylandContext ()->viewporter =
+            static_cast<wp_viewporter*> (wl_registry_bind (registry, name, &wp_viewporter_interface, 1));
+    } else if (strcmp (interface, wp_fractional_scale_manager_v1_interface.name) == 0) {
+        driver->getWaylandContext ()->fractionalScaleManager = static_cast<wp_fractional_scale_manager_v1*> (
+            wl_registry_bind (registry, name, &wp_fractional_scale_manager_v1_interface, 1));
+    }
+#endif /* ENABLE_FRACTIONAL_SCALE */
 }
 
 static void handleGlobalRemoved (void* data, struct wl_registry* registry, uint32_t id) {
-    // todo: outputs
+    static_cast<WaylandOpenGLDriver*> (data)->onOutputRemoved (id);
 }
 
 constexpr struct wl_registry_listener registryListener = {
@@ -121,6 +152,45 @@ constexpr struct wl_registry_listener registryListener = {
     .global_remove = handleGlobalRemoved,
 };
 
+EGLDeviceEXT WaylandOpenGLDriver::findEGLDevice (const std::string& clientExtensions) const {
+    const auto gpu = GPUSelection::selected (this->m_context.settings.render.gpu);
+
+    if (!gpu.has_value ())
+        return EGL_NO_DEVICE_EXT;
+
+    if (clientExtensions.find ("EGL_EXT_device_enumeration") == std::string::npos ||
+        clientExtensions.find ("EGL_EXT_explicit_device") == std::string::npos) {
+        sLog.debug ("EGL cannot pick a device, the GPU is selected through the environment only");
+        return EGL_NO_DEVICE_EXT;
+    }
+
+    const auto eglQueryDevicesEXT =
+        reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC> (eglGetProcAddress ("eglQueryDevicesEXT"));
+    const auto eglQueryDeviceStringEXT =
+        reinterpret_cast<PFNEGLQUERYDEVICESTRINGEXTPROC> (eglGetProcAddress ("eglQueryDeviceStringEXT"));
+    EGLDeviceEXT devices [16];
+    EGLint count = 0;
+
+    if (!eglQueryDevicesEXT || !eglQueryDeviceStringEXT || !eglQueryDevicesEXT (16, devices, &count))
+        return EGL_NO_DEVICE_EXT;
+
+    for (EGLint i = 0; i < count; i++) {
+        const char* extensions = eglQueryDeviceStringEXT (devices [i], EGL_EXTENSIONS);
+
+        if (extensions == nullptr || std::string (extensions).find ("EGL_EXT_device_drm") == std::string::npos)
+            continue;
+
+        const char* card = eglQueryDeviceStringEXT (devices [i], EGL_DRM_DEVICE_FILE_EXT);
+        const char* render = eglQueryDeviceStringEXT (devices [i], EGL_DRM_RENDER_NODE_FILE_EXT);
+
+        if ((card != nullptr && gpu->card == card) || (render != nullptr && gpu->renderNode == render))
+            return devices [i];
+    }
+
+    sLog.error ("EGL doesn't list ", gpu->card, ", the GPU is selected through the environment only");
+    return EGL_NO_DEVICE_EXT;
+}
+
 void WaylandOpenGLDriver::initEGL () {
     const char* CLIENT_EXTENSIONS = eglQueryString (EGL_NO_DISPLAY, EGL_EXTENSIONS);
     if (!CLIENT_EXTENSIONS)
@@ -142,7 +212,17 @@ void WaylandOpenGLDriver::initEGL () {
     if (!eglGetPlatformDisplayEXT || !m_eglContext.eglCreatePlatformWindowSurfaceEXT)
         sLog.exception ("EGL did not return EXT proc pointers!");
 
-    m_eglContext.display = eglGetPlatformDisplayEXT (EGL_PLATFORM_WAYLAND_EXT, m_waylandContext.display, nullptr);
+    // with an explicit device the display renders on that GPU and Mesa hands the compositor dmabufs it can import,
+    // otherwise the display goes with the default one (or whatever DRI_PRIME says)
+    if (const EGLDeviceEXT device = this->findEGLDevice (CLIENTEXTENSIONS); device != EGL_NO_DEVICE_EXT) {
+        // the device is a pointer, only the EGL 1.5 entry point takes attributes that wide
+        const EGLAttrib DISPLAY_ATTRIBUTES [] = {EGL_DEVICE_EXT, reinterpret_cast<EGLAttrib> (device), EGL_NONE};
+
+        m_eglContext.display = eglGetPlatformDisplay (EGL_PLATFORM_WAYLAND_EXT, m_waylandContext.display,
+                                                      DISPLAY_ATTRIBUTES);
+    } else {
+        m_eglContext.display = eglGetPlatformDisplayEXT (EGL_PLATFORM_WAYLAND_EXT, m_waylandContext.display, nullptr);
+    }
 
     if (m_eglContext.display == EGL_NO_DISPLAY) {
         this->finishEGL ();
@@ -212,18 +292,83 @@ void WaylandOpenGLDriver::finishEGL () const {
 void WaylandOpenGLDriver::onLayerClose (Output::WaylandOutputViewport* viewport) {
     sLog.error ("Compositor closed our LS, freeing data...");
 
-    if (viewport->eglSurface)
+    this->destroyViewport (viewport);
+}
+
+void WaylandOpenGLDriver::onOutputReady (Output::WaylandOutputViewport* viewport) {
+    if (!this->m_outputsReady || viewport->layerSurface ||
+        !this->m_context.settings.general.screenBackgrounds.contains (viewport->name))
+        return;
+
+    // setting the surface up takes a roundtrip, that can't happen from inside the output's event handlers
+    this->m_outputsAdded = true;
+}
+
+void WaylandOpenGLDriver::setupAddedOutputs () {
+    this->m_outputsAdded = false;
+
+    for (const auto& screen : this->m_screens) {
+        if (!screen->initialized || screen->layerSurface ||
+            !this->m_context.settings.general.screenBackgrounds.contains (screen->name))
+            continue;
+
+        sLog.out ("Screen ", screen->name, " connected");
+
+        // setupLS () updates the output's viewports once the surface is there
+        screen->setupLS ();
+        // there's no frame callback to wait for until the first frame is presented
+        screen->frameRequested = true;
+        screen->nextFrame = 0.0f;
+    }
+}
+
+void WaylandOpenGLDriver::onOutputRemoved (const uint32_t waylandName) {
+    const auto it = std::ranges::find_if (this->m_screens, [waylandName] (const Output::WaylandOutputViewport* screen) {
+        return screen->waylandName == waylandName;
+    });
+
+    if (it == this->m_screens.end ())
+        return;
+
+    sLog.out ("Screen ", (*it)->name, " disconnected");
+
+    this->destroyViewport (*it);
+}
+
+void WaylandOpenGLDriver::destroyViewport (Output::WaylandOutputViewport* viewport) {
+    if (this->viewportInFocus == viewport)
+        this->viewportInFocus = nullptr;
+
+    if (viewport->frameCallback)
+        wl_callback_destroy (viewport->frameCallback);
+
+    if (viewport->eglSurface) {
+        if (m_eglContext.current == viewport->eglSurface)
+            m_eglContext.current = EGL_NO_SURFACE;
+
         eglDestroySurface (m_eglContext.display, viewport->eglSurface);
+    }
 
     if (viewport->eglWindow)
         wl_egl_window_destroy (viewport->eglWindow);
 
+#ifdef ENABLE_FRACTIONAL_SCALE
+    if (viewport->fractionalScaleObject)
+        wp_fractional_scale_v1_destroy (viewport->fractionalScaleObject);
+
+    if (viewport->surfaceViewport)
+        wp_viewport_destroy (viewport->surfaceViewport);
+#endif /* ENABLE_FRACTIONAL_SCALE */
+
     if (viewport->layerSurface)
         zwlr_layer_surface_v1_destroy (viewport->layerSurface);
 
     if (viewport->surface)
         wl_surface_destroy (viewport->surface);
 
+    if (viewport->output)
+        wl_output_release (viewport->output);
+
     // remove the output from the list
     std::erase (this->m_screens, viewport);
 
@@ -258,6 +403,10 @@ WaylandOpenGLDriver::WaylandOpenGLDriver (ApplicationContext& context, Wallpaper
 
     initEGL ();
 
+    if (pipe2 (this->m_wakeup, O_CLOEXEC | O_NONBLOCK) == -1)
+        sLog.error ("Cannot create the wakeup pipe, new video and web frames wait for the idle check: ",
+                    strerror (errno));
+
     bool any = false;
 
     for (const auto& o : this->m_screens) {
@@ -285,6 +434,8 @@ WaylandOpenGLDriver::WaylandOpenGLDriver (ApplicationContext& context, Wallpaper
         sLog.exception ("Cannot continue...");
     }
 
+    this->m_outputsReady = true;
+
     if (const GLenum result = glewInit (); result != GLEW_OK)
         sLog.error ("Failed to initialize GLEW: ", glewGetErrorString (result));
 }
@@ -302,9 +453,16 @@ WaylandOpenGLDriver::~WaylandOpenGLDriver () {
     // disconnect from wayland display
     if (this->m_waylandContext.display)
         wl_display_disconnect (this->m_waylandContext.display);
+
+    for (const int fd : this->m_wakeup) {
+        if (fd != -1)
+            close (fd);
+    }
 }
 
 void WaylandOpenGLDriver::dispatchEventQueue () {
+    TRACE_SCOPE ("WaylandOpenGLDriver::dispatchEventQueue");
+
     static bool initialized = false;
 
     if (!initialized) {
@@ -314,25 +472,104 @@ void WaylandOpenGLDriver::dispatchEventQueue () {
             this->getApp ().update (viewport);
     }
 
-    // TODO: FRAMETIME CONTROL SHOULD GO BACK TO THE CWALLPAPAERAPPLICATION ONCE ACTUAL PARTICLES ARE IMPLEMENTED
-    // TODO: AS THOSE, MORE THAN LIKELY, WILL REQUIRE OF A DIFFERENT PROCESSING RATE
+    wl_display* display = this->m_waylandContext.display;
+    const float now = this->getRenderTime ();
+    float wait = -1.0f;
+
+    // every screen is paced on its own, only block on the display until the first one is due
+    for (const auto& screen : this->m_screens) {
+        float due;
+
+        if (screen->frameRequested) {
+            due = std::max (screen->nextFrame - now, 0.0f);
+        } else if (screen->idle) {
+            // idle screens won't get frame callbacks, check on them every now and then
+            due = std::max (screen->nextFrame - now, IDLE_WAKEUP_TIME);
+        } else {
+            // waiting on the compositor, which doesn't send callbacks for outputs that are not visible
+            continue;
+        }
+
+        wait = wait < 0.0f ? due : std::min (wait, due);
+    }
+
+    while (wl_display_prepare_read (display) != 0)
+        wl_display_dispatch_pending (display);
+
+    wl_display_flush (display);
+
+    pollfd fds [2] = {
+        {.fd = wl_display_get_fd (display), .events = POLLIN, .revents = 0},
+        {.fd = this->m_wakeup [0], .events = POLLIN, .revents = 0},
+    };
+
+    if (poll (fds, 2, wait < 0.0f ? -1 : static_cast<int> (std::ceil (wait * 1000))) > 0 &&
+        fds [0].revents & POLLIN) {
+        if (wl_display_read_events (display) == -1)
+            m_requestedExit = true;
+    } else {
+        wl_display_cancel_read (display);
+    }
 
-    // TODO: WRITE A NON-BLOCKING VERSION OF THIS ONCE PARTICLE SIMULATION STARTS WORKING
-    // TODO: OTHERWISE wl_display_dispatch WILL BLOCK IF NO SURFACES ARE BEING DRAWN
-    static float startTime, endTime, minimumTime = 1.0f / this->m_context.settings.render.maximumFPS;
-    // get the start time of the frame
-    startTime = this->getRenderTime ();
+    if (fds [1].revents & POLLIN) {
+        char buffer [64];
 
-    if (wl_display_dispatch (m_waylandContext.display) == -1)
+        while (read (this->m_wakeup [0], buffer, sizeof (buffer)) > 0) {}
+
+        // idle screens have no frame callback pending, they're drawn as soon as their FPS limit allows
+        for (const auto& screen : this->m_screens) {
+            if (screen->idle)
+                screen->frameRequested = true;
+        }
+    }
+
+    if (wl_display_dispatch_pending (display) == -1)
         m_requestedExit = true;
 
+    if (this->m_outputsAdded)
+        this->setupAddedOutputs ();
+
+    this->renderScreens ();
+
     m_frameCounter++;
+}
+
+void WaylandOpenGLDriver::renderScreens () {
+    const float now = this->getRenderTime ();
+
+    for (const auto& screen : this->m_screens) {
+        if (screen->rendering || (!screen->frameRequested && !screen->idle) || now < screen->nextFrame)
+            continue;
+
+        // covered by something or turned off, check again later without drawing anything
+        if (!this->getApp ().isVisible (screen->name)) {
+            screen->frameRequested = false;
+            screen->idle = true;
+            screen->nextFrame = now + IDLE_WAKEUP_TIME;
+            continue;
+        }
+
+        const float frameTime = this->getFrameTime (screen);
+
+        // keep the cadence unless the screen fell a whole frame behind, then start over from now
+        screen->nextFrame = now - screen->nextFrame > frameTime ? now + frameTime : screen->nextFrame + frameTime;
+        screen->frameRequested = false;
+        screen->rendering = true;
+        screen->idle = !this->getApp ().update (screen);
+        screen->rendering = false;
+    }
+}
+
+float WaylandOpenGLDriver::getFrameTime (const Output::WaylandOutputViewport* viewport) const {
+    const auto& fps = this->m_context.settings.general.screenFPS;
+    const auto cur = fps.find (viewport->name);
 
-    endTime = this->getRenderTime ();
+    const auto limit = static_cast<float> (cur == fps.end () ? this->m_context.settings.render.maximumFPS : cur->second);
 
-    // ensure the frame time is correct to not overrun FPS
-    if ((endTime - startTime) < minimumTime)
-        usleep ((minimumTime - (endTime - startTime)) * CLOCKS_PER_SEC);
+    // slow wallpapers ask for less with --adaptive-fps
+    return 1.0f / std::max (
+        1.0f, this->getApp ().getRenderContext ().getMotionFPS (
+                  viewport->name, limit * this->m_context.state.power.fpsScale));
 }
 
 Output::Output& WaylandOpenGLDriver::getOutput () {
@@ -362,10 +599,30 @@ glm::ivec2 WaylandOpenGLDriver::getFramebufferSize () const {
     return glm::ivec2 {0, 0};
 }
 
+void WaylandOpenGLDriver::wakeUp () const {
+    const char wakeup = 0;
+
+    // a full pipe already has a wakeup pending
+    std::ignore = write (this->m_wakeup [1], &wakeup, 1);
+}
+
+void* WaylandOpenGLDriver::getWaylandDisplay () const {
+    return this->m_waylandContext.display;
+}
+
 uint32_t WaylandOpenGLDriver::getFrameCounter () const {
     return m_frameCounter;
 }
 
+int WaylandOpenGLDriver::getRefreshRate () const {
+    int refreshRate = 0;
+
+    for (const auto& screen : this->m_screens)
+        refreshRate = std::max (refreshRate, screen->refreshRate);
+
+    return refreshRate;
+}
+
 WaylandOpenGLDriver::SEGLContext* WaylandOpenGLDriver::getEGLContext () {
     return &this->m_eglContext;
 }
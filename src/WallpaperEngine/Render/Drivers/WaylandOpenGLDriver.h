@@ -24,6 +24,8 @@ class WallpaperApplication;
 
 struct zwlr_layer_shell_v1;
 struct zwlr_layer_surface_v1;
+struct wp_viewporter;
+struct wp_fractional_scale_manager_v1;
 
 namespace WallpaperEngine::Render::Drivers {
 using namespace WallpaperEngine::Application;
@@ -44,6 +46,8 @@ class WaylandOpenGLDriver final : public VideoDriver {
         EGLDisplay display = nullptr;
         EGLConfig config = nullptr;
         EGLContext context = nullptr;
+        /** surface bound to the context right now, rebinding the same one still costs a flush on some drivers */
+        EGLSurface current = EGL_NO_SURFACE;
         PFNEGLCREATEPLATFORMWINDOWSURFACEEXTPROC eglCreatePlatformWindowSurfaceEXT = nullptr;
     };
 
@@ -54,6 +58,9 @@ class WaylandOpenGLDriver final : public VideoDriver {
         wl_shm* shm = nullptr;
         zwlr_layer_shell_v1* layerShell = nullptr;
         wl_seat* seat = nullptr;
+        /** both only there if the compositor does fractional scaling */
+        wp_viewporter* viewporter = nullptr;
+        wp_fractional_scale_manager_v1* fractionalScaleManager = nullptr;
     };
 
     explicit WaylandOpenGLDriver (ApplicationContext& context, WallpaperApplication& app);
@@ -68,13 +75,29 @@ class WaylandOpenGLDriver final : public VideoDriver {
     void hideWindow () override;
     glm::ivec2 getFramebufferSize () const override;
     uint32_t getFrameCounter () const override;
+    int getRefreshRate () const override;
+    void wakeUp () const override;
+    [[nodiscard]] void* getWaylandDisplay () const override;
     void dispatchEventQueue () override;
     [[nodiscard]] void* getProcAddress (const char* name) const override;
 
     void onLayerClose (Output::WaylandOutputViewport*);
+    /**
+     * Queues a requested screen plugged in after startup to get its layer surface, its wallpaper was kept by the
+     * render context so nothing has to be loaded again
+     */
+    void onOutputReady (Output::WaylandOutputViewport*);
+    /**
+     * Frees the surface of an unplugged screen, the other screens and every wallpaper stay as they are
+     *
+     * @param waylandName The output's global, any other global is ignored
+     */
+    void onOutputRemoved (uint32_t waylandName);
     Output::WaylandOutputViewport* surfaceToViewport (const wl_surface*) const;
 
     Output::WaylandOutputViewport* viewportInFocus = nullptr;
+    /** bumped by every pointer event, the pointer's state only keeps the last of them */
+    uint64_t mouseGeneration = 0;
 
     [[nodiscard]] SEGLContext* getEGLContext ();
     [[nodiscard]] WaylandContext* getWaylandContext ();
@@ -90,9 +113,36 @@ class WaylandOpenGLDriver final : public VideoDriver {
     /** The Wayland context in use */
     WaylandContext m_waylandContext = {};
     mutable bool m_requestedExit;
+    /** written to by wakeUp (), polled along with the display */
+    int m_wakeup [2] = {-1, -1};
+
+    /** the screens requested at startup got their surfaces, any other is a hotplug */
+    bool m_outputsReady = false;
+    /** a requested screen was plugged in and is waiting for setupAddedOutputs () */
+    bool m_outputsAdded = false;
 
     void initEGL ();
     void finishEGL () const;
+    /**
+     * Destroys the viewport and everything created for it, then updates the output's list of viewports
+     */
+    void destroyViewport (Output::WaylandOutputViewport* viewport);
+    /**
+     * Sets up the surfaces of the requested screens plugged in since the last dispatch
+     */
+    void setupAddedOutputs ();
+    /**
+     * @return The EGL device for the GPU selected with --gpu, EGL_NO_DEVICE_EXT if none was or EGL can't tell
+     */
+    [[nodiscard]] EGLDeviceEXT findEGLDevice (const std::string& clientExtensions) const;
+    /**
+     * @return Minimum time between two frames on the given screen
+     */
+    [[nodiscard]] float getFrameTime (const Output::WaylandOutputViewport* viewport) const;
+    /**
+     * Renders the screens that are due, the rest keep waiting on their frame callback or FPS limit
+     */
+    void renderScreens ();
 
     uint32_t m_frameCounter = 0;
     ApplicationContext& m_context;
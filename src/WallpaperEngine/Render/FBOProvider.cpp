@@ -1,24 +1,59 @@
 #include "FBOProvider.h"
+#include <algorithm>
+#include <cctype>
+#include <glm/common.hpp>
 #include <gmpxx.h>
 
+#include "WallpaperEngine/Logging/Log.h"
+
 using namespace WallpaperEngine::Render;
 using namespace WallpaperEngine::Data::Model;
 
+namespace {
+/**
+ * @return The texture format for the name effects give their render targets
+ */
+TextureFormat parseFormat (const std::string& format) {
+    static const std::unordered_map<std::string, TextureFormat> formats = {
+        {"rgba8888", TextureFormat_ARGB8888},
+        {"rgb888", TextureFormat_RGB888},
+        {"rg88", TextureFormat_RG88},
+        {"r8", TextureFormat_R8},
+        {"r16f", TextureFormat_R16f},
+        {"rg1616f", TextureFormat_RG1616f},
+        {"rgb161616f", TextureFormat_RGB161616f},
+        {"rgba16161616f", TextureFormat_RGBA16161616f},
+        {"rgba1010102", TextureFormat_RGBa1010102},
+    };
+
+    std::string name = format;
+
+    std::ranges::transform (name, name.begin (), [] (const unsigned char c) { return std::tolower (c); });
+
+    if (const auto it = formats.find (name); it != formats.end ())
+        return it->second;
+
+    sLog.error ("Unknown render target format ", format, ", using rgba8888");
+
+    return TextureFormat_ARGB8888;
+}
+} // namespace
 
 FBOProvider::FBOProvider (const FBOProvider* parent) :
     m_parent (parent) {}
 
 std::shared_ptr<CFBO> FBOProvider::create(const FBO& base, uint32_t flags, const glm::vec2 size) {
-    return this->m_fbos[base.name] = std::make_shared <CFBO> (
+    const glm::vec2 scaled = this->scale (size / base.scale);
+
+    return this->m_fbos[Symbol (base.name)] = std::make_shared <CFBO> (
         base.name,
-        // TODO: PROPERLY DETERMINE FBO FORMAT BASED ON THE STRING
-        TextureFormat_ARGB8888,
+        parseFormat (base.format),
         flags,
         base.scale,
-        size.x / base.scale,
-        size.y / base.scale,
-        size.x / base.scale,
-        size.y / base.scale
+        scaled.x,
+        scaled.y,
+        scaled.x,
+        scaled.y
     );
 }
 
@@ -26,9 +61,12 @@ std::shared_ptr<CFBO> FBOProvider::create (
     const std::string& name, TextureFormat format, uint32_t flags, float scale,
     glm::vec2 realSize, glm::vec2 textureSize
 ) {
-    return this->m_fbos[name] = std::make_shared <CFBO> (
+    realSize = this->scale (realSize);
+    textureSize = this->scale (textureSize);
+
+    return this->m_fbos[Symbol (name)] = std::make_shared <CFBO> (
         name,
-        TextureFormat_ARGB8888,
+        format,
         flags,
         scale,
         realSize.x,
@@ -39,10 +77,14 @@ std::shared_ptr<CFBO> FBOProvider::create (
 }
 
 std::shared_ptr<CFBO> FBOProvider::alias (const std::string& newName, const std::string& original) {
-    return this->m_fbos[newName] = this->m_fbos[original];
+    return this->m_fbos[Symbol (newName)] = this->m_fbos[Symbol (original)];
 }
 
 std::shared_ptr<CFBO> FBOProvider::find (const std::string& name) const {
+    return this->find (Symbol (name));
+}
+
+std::shared_ptr<CFBO> FBOProvider::find (const Symbol name) const {
     if (const auto it = this->m_fbos.find (name); it != this->m_fbos.end ()) {
         return it->second;
     }
@@ -52,4 +94,24 @@ std::shared_ptr<CFBO> FBOProvider::find (const std::string& name) const {
     }
 
     return this->m_parent->find (name);
-}
\ No newline at end of file
+}
+
+void FBOProvider::setRenderScale (const float scale) {
+    this->m_renderScale = scale;
+}
+
+float FBOProvider::getRenderScale () const {
+    if (this->m_parent != nullptr)
+        return this->m_parent->getRenderScale ();
+
+    return this->m_renderScale;
+}
+
+glm::vec2 FBOProvider::scale (const glm::vec2 size) const {
+    const float scale = this->getRenderScale ();
+
+    if (scale == 1.0f)
+        return size;
+
+    return glm::max (glm::round (size * scale), glm::vec2 (1.0f));
+}
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <glm/vec2.hpp>
+#include <unordered_map>
 
 #include "CFBO.h"
 #include "WallpaperEngine/Data/Model/Effect.h"
+#include "WallpaperEngine/Data/Utils/Symbol.h"
 
 namespace WallpaperEngine::Render {
 using namespace WallpaperEngine::Data::Model;
+using namespace WallpaperEngine::Data::Utils;
 
 class FBOProvider {
   public:
@@ -18,9 +21,29 @@ class FBOProvider {
         glm::vec2 realSize, glm::vec2 textureSize);
     std::shared_ptr<CFBO> alias (const std::string& newName, const std::string& original);
     [[nodiscard]] std::shared_ptr<CFBO> find (const std::string& name) const;
+    /**
+     * Looks the FBO up here and then in the parents, the name is only interned once for the whole chain
+     *
+     * @param name
+     *
+     * @return The FBO, nullptr if no provider has it
+     */
+    [[nodiscard]] std::shared_ptr<CFBO> find (Symbol name) const;
+    /**
+     * Changes the size every FBO created from now on has relative to the one asked for, providers with a parent use
+     * their parent's
+     *
+     * @param scale
+     */
+    void setRenderScale (float scale);
+    [[nodiscard]] float getRenderScale () const;
 
   private:
+    /** @return The size scaled by the render scale, never less than a pixel */
+    [[nodiscard]] glm::vec2 scale (glm::vec2 size) const;
+
     const FBOProvider* m_parent;
-    std::map <std::string, std::shared_ptr<CFBO>> m_fbos = {};
+    float m_renderScale = 1.0f;
+    std::unordered_map <Symbol, std::shared_ptr<CFBO>> m_fbos = {};
 };
 }
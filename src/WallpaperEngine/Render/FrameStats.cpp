@@ -0,0 +1,321 @@
+#include "FrameStats.h"
+#include "GPUResources.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <unistd.h>
+
+using namespace WallpaperEngine::Render;
+
+namespace {
+double milliseconds (const std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli> (duration).count ();
+}
+
+double megabytes (const uint64_t bytes) {
+    return static_cast<double> (bytes) / (1024.0 * 1024.0);
+}
+
+double seconds (const int64_t nanoseconds) {
+    return static_cast<double> (nanoseconds) / 1000000000.0;
+}
+
+/** @return The value escaped to go between the quotes of a label */
+std::string label (const std::string& value) {
+    std::string result;
+
+    for (const char c : value) {
+        if (c == '\\' || c == '"')
+            result += '\\';
+
+        if (c == '\n')
+            result += "\\n";
+        else
+            result += c;
+    }
+
+    return result;
+}
+
+/** @return The memory the process has resident, 0 if it cannot be read */
+uint64_t residentBytes () {
+    std::ifstream statm ("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+
+    if (!(statm >> size >> resident))
+        return 0;
+
+    return resident * static_cast<uint64_t> (sysconf (_SC_PAGESIZE));
+}
+
+constexpr const char* PHASE_NAMES [FrameStats::Phase_Count] = {"audio", "particles", "render", "present"};
+constexpr const char* RESOURCE_NAMES [GPUResources::Type_Count] = {"texture", "framebuffer", "buffer", "program"};
+} // namespace
+
+FrameStats::Scope::Scope (FrameStats& stats, const Phase phase) :
+    m_stats (stats),
+    m_phase (phase) {
+    if (this->m_stats.isEnabled ())
+        this->m_start = std::chrono::steady_clock::now ();
+}
+
+FrameStats::Scope::~Scope () {
+    if (this->m_stats.isEnabled ())
+        this->m_stats.add (this->m_phase, std::chrono::steady_clock::now () - this->m_start);
+}
+
+FrameStats::FrameStats (const bool enabled) :
+    m_enabled (enabled) {}
+
+bool FrameStats::beginFrame () {
+    if (!this->m_enabled)
+        return false;
+
+    const auto now = std::chrono::steady_clock::now ();
+
+    // the very first frame only starts counting
+    if (this->m_frameStart == std::chrono::steady_clock::time_point {}) {
+        this->m_frameStart = now;
+        this->m_windowStart = now;
+        return false;
+    }
+
+    const auto frameTime = now - this->m_frameStart;
+
+    this->m_frameStart = now;
+    this->m_frames++;
+    this->m_frameTime += frameTime;
+    this->m_longestFrame = std::max (this->m_longestFrame, frameTime);
+
+    const double frameSeconds = std::chrono::duration<double> (frameTime).count ();
+    const auto bucket = std::ranges::lower_bound (FRAME_BUCKETS, frameSeconds) - FRAME_BUCKETS.begin ();
+
+    // only this thread writes them, relaxed is enough for whoever reads them to see them eventually
+    this->m_totals.frames.fetch_add (1, std::memory_order_relaxed);
+    this->m_totals.frameBuckets [bucket].fetch_add (1, std::memory_order_relaxed);
+    this->m_totals.frameNanoseconds.fetch_add (
+        std::chrono::duration_cast<std::chrono::nanoseconds> (frameTime).count (), std::memory_order_relaxed);
+    this->m_totals.particles.store (this->m_frameParticles, std::memory_order_relaxed);
+    this->m_frameParticles = 0;
+
+    return now - this->m_windowStart >= PUBLISH_INTERVAL;
+}
+
+void FrameStats::publish (
+    const uint64_t textureBytes, const uint64_t framebufferBytes, const double gpuTime, std::vector<Output> outputs
+) {
+    if (!this->m_enabled || this->m_frames == 0)
+        return;
+
+    this->m_totals.gpuTime.store (gpuTime, std::memory_order_relaxed);
+    this->m_totals.textureCacheBytes.store (textureBytes, std::memory_order_relaxed);
+
+    for (int type = 0; type < GPUResources::Type_Count; type++)
+        this->m_totals.videoMemory [type].store (
+            sGPUResources.getBytes (static_cast<GPUResources::Type> (type)), std::memory_order_relaxed);
+
+    const auto frames = static_cast<double> (this->m_frames);
+    const double window = std::chrono::duration<double> (this->m_frameStart - this->m_windowStart).count ();
+    std::ostringstream out;
+
+    out << std::fixed << std::setprecision (3);
+    out << "{\"fps\":" << frames / window << ",\"frameMs\":{\"mean\":" << milliseconds (this->m_frameTime) / frames
+        << ",\"max\":" << milliseconds (this->m_longestFrame) << "},\"phaseMs\":{\"audio\":"
+        << milliseconds (this->m_phases [Phase_Audio]) / frames
+        << ",\"particles\":" << milliseconds (this->m_phases [Phase_Particles]) / frames
+        << ",\"render\":" << milliseconds (this->m_phases [Phase_Render]) / frames
+        << ",\"present\":" << milliseconds (this->m_phases [Phase_Present]) / frames << "},\"gpuMs\":";
+
+    if (gpuTime < 0.0)
+        out << "null";
+    else
+        out << gpuTime;
+
+    out << ",\"draws\":" << static_cast<double> (this->m_draws) / frames
+        << ",\"particles\":" << static_cast<double> (this->m_particles) / frames
+        << ",\"textureMB\":" << megabytes (textureBytes) << ",\"framebufferMB\":" << megabytes (framebufferBytes)
+        << ",\"gpuMemory\":";
+    sGPUResources.writeSummary (out);
+    out << ",\"audio\":{\"bufferMs\":" << this->m_audioBufferTime << ",\"underruns\":" << this->m_audioUnderruns
+        << ",\"lateCallbacks\":" << this->m_audioLateCallbacks
+        << ",\"realtime\":" << (this->m_audioRealtime ? "true" : "false") << "}}";
+
+    {
+        std::lock_guard lock (this->m_mutex);
+        this->m_snapshot = out.str ();
+        this->m_outputs = std::move (outputs);
+    }
+
+    this->m_windowStart = this->m_frameStart;
+    this->m_frames = 0;
+    this->m_frameTime = {};
+    this->m_longestFrame = {};
+    this->m_phases = {};
+    this->m_draws = 0;
+    this->m_particles = 0;
+}
+
+void FrameStats::setAudio (
+    const double bufferTime, const uint64_t underruns, const uint64_t lateCallbacks, const bool realtime
+) {
+    if (!this->m_enabled)
+        return;
+
+    this->m_audioBufferTime = bufferTime;
+    this->m_audioUnderruns = underruns;
+    this->m_audioLateCallbacks = lateCallbacks;
+    this->m_audioRealtime = realtime;
+    this->m_totals.audioUnderruns.store (underruns, std::memory_order_relaxed);
+}
+
+void FrameStats::addDraws (const uint32_t draws) {
+    if (!this->m_enabled)
+        return;
+
+    this->m_draws += draws;
+    this->m_totals.draws.fetch_add (draws, std::memory_order_relaxed);
+}
+
+void FrameStats::addParticles (const uint32_t particles) {
+    if (!this->m_enabled)
+        return;
+
+    this->m_particles += particles;
+    this->m_frameParticles += particles;
+}
+
+void FrameStats::addLoad (const std::chrono::steady_clock::duration duration) {
+    if (!this->m_enabled)
+        return;
+
+    this->m_totals.loads.fetch_add (1, std::memory_order_relaxed);
+    this->m_totals.loadNanoseconds.fetch_add (
+        std::chrono::duration_cast<std::chrono::nanoseconds> (duration).count (), std::memory_order_relaxed);
+}
+
+void FrameStats::setPaused (const bool paused) {
+    if (!this->m_enabled || this->m_totals.paused.exchange (paused, std::memory_order_relaxed) == paused)
+        return;
+
+    const auto now = std::chrono::steady_clock::now ();
+
+    if (paused) {
+        this->m_pauseStart = now;
+        return;
+    }
+
+    // the time paused is not part of any frame
+    if (this->m_frameStart != std::chrono::steady_clock::time_point {}) {
+        this->m_frameStart += now - this->m_pauseStart;
+        this->m_windowStart += now - this->m_pauseStart;
+    }
+}
+
+bool FrameStats::isEnabled () const {
+    return this->m_enabled;
+}
+
+std::string FrameStats::getSnapshot () const {
+    std::lock_guard lock (this->m_mutex);
+
+    return this->m_snapshot;
+}
+
+void FrameStats::writeMetrics (std::ostream& stream) const {
+    constexpr const char* prefix = "linux_wallpaperengine_";
+    const auto& totals = this->m_totals;
+    // formatted on its own so the stream given is left as it was
+    std::ostringstream out;
+
+    out << std::setprecision (9);
+
+    out << "# TYPE " << prefix << "frames counter\n"
+        << "# HELP " << prefix << "frames Frames rendered\n"
+        << prefix << "frames_total " << totals.frames.load (std::memory_order_relaxed) << '\n';
+
+    out << "# TYPE " << prefix << "frame_seconds histogram\n"
+        << "# HELP " << prefix << "frame_seconds Time between the start of a frame and the next one\n";
+
+    // frames keep coming in while this reads, the count comes from the buckets so at least those agree
+    uint64_t cumulative = 0;
+
+    for (size_t bucket = 0; bucket < FRAME_BUCKETS.size (); bucket++) {
+        cumulative += totals.frameBuckets [bucket].load (std::memory_order_relaxed);
+        out << prefix << "frame_seconds_bucket{le=\"" << FRAME_BUCKETS [bucket] << "\"} " << cumulative << '\n';
+    }
+
+    cumulative += totals.frameBuckets [FRAME_BUCKETS.size ()].load (std::memory_order_relaxed);
+    out << prefix << "frame_seconds_bucket{le=\"+Inf\"} " << cumulative << '\n'
+        << prefix << "frame_seconds_sum " << seconds (totals.frameNanoseconds.load (std::memory_order_relaxed))
+        << '\n'
+        << prefix << "frame_seconds_count " << cumulative << '\n';
+
+    out << "# TYPE " << prefix << "phase_seconds counter\n"
+        << "# HELP " << prefix << "phase_seconds CPU time spent on every part of the frames\n";
+
+    for (int phase = 0; phase < Phase_Count; phase++)
+        out << prefix << "phase_seconds_total{phase=\"" << PHASE_NAMES [phase] << "\"} "
+            << seconds (totals.phaseNanoseconds [phase].load (std::memory_order_relaxed)) << '\n';
+
+    if (const double gpuTime = totals.gpuTime.load (std::memory_order_relaxed); gpuTime >= 0.0)
+        out << "# TYPE " << prefix << "gpu_frame_seconds gauge\n"
+            << "# HELP " << prefix << "gpu_frame_seconds GPU time of the last measured frame\n"
+            << prefix << "gpu_frame_seconds " << gpuTime / 1000.0 << '\n';
+
+    out << "# TYPE " << prefix << "draws counter\n"
+        << "# HELP " << prefix << "draws Draw calls issued\n"
+        << prefix << "draws_total " << totals.draws.load (std::memory_order_relaxed) << '\n'
+        << "# TYPE " << prefix << "particles gauge\n"
+        << "# HELP " << prefix << "particles Particles alive in the last frame\n"
+        << prefix << "particles " << totals.particles.load (std::memory_order_relaxed) << '\n'
+        << "# TYPE " << prefix << "resident_memory_bytes gauge\n"
+        << "# HELP " << prefix << "resident_memory_bytes Memory of the process that is resident\n"
+        << prefix << "resident_memory_bytes " << residentBytes () << '\n'
+        << "# TYPE " << prefix << "video_memory_bytes gauge\n"
+        << "# HELP " << prefix << "video_memory_bytes Estimated video memory taken by every type of resource\n";
+
+    for (int type = 0; type < GPUResources::Type_Count; type++)
+        out << prefix << "video_memory_bytes{type=\"" << RESOURCE_NAMES [type] << "\"} "
+            << totals.videoMemory [type].load (std::memory_order_relaxed) << '\n';
+
+    out << "# TYPE " << prefix << "texture_cache_bytes gauge\n"
+        << "# HELP " << prefix << "texture_cache_bytes Video memory of the textures in the cache\n"
+        << prefix << "texture_cache_bytes " << totals.textureCacheBytes.load (std::memory_order_relaxed) << '\n'
+        << "# TYPE " << prefix << "background_loads counter\n"
+        << "# HELP " << prefix << "background_loads Backgrounds loaded\n"
+        << prefix << "background_loads_total " << totals.loads.load (std::memory_order_relaxed) << '\n'
+        << "# TYPE " << prefix << "background_load_seconds counter\n"
+        << "# HELP " << prefix << "background_load_seconds Time spent loading backgrounds\n"
+        << prefix << "background_load_seconds_total "
+        << seconds (totals.loadNanoseconds.load (std::memory_order_relaxed)) << '\n'
+        << "# TYPE " << prefix << "audio_underruns counter\n"
+        << "# HELP " << prefix << "audio_underruns Times a sound ran out of decoded samples\n"
+        << prefix << "audio_underruns_total " << totals.audioUnderruns.load (std::memory_order_relaxed) << '\n'
+        << "# TYPE " << prefix << "paused gauge\n"
+        << "# HELP " << prefix << "paused If rendering is paused\n"
+        << prefix << "paused " << (totals.paused.load (std::memory_order_relaxed) ? 1 : 0) << '\n'
+        << "# TYPE " << prefix << "output_visible gauge\n"
+        << "# HELP " << prefix << "output_visible If the background on the screen can be seen\n";
+
+    {
+        std::lock_guard lock (this->m_mutex);
+
+        for (const auto& [screen, workshopId, visible] : this->m_outputs)
+            out << prefix << "output_visible{screen=\"" << label (screen) << "\",workshop_id=\""
+                << label (workshopId) << "\"} " << (visible ? 1 : 0) << '\n';
+    }
+
+    out << "# EOF\n";
+
+    stream << out.str ();
+}
+
+void FrameStats::add (const Phase phase, const std::chrono::steady_clock::duration duration) {
+    this->m_phases [phase] += duration;
+    this->m_totals.phaseNanoseconds [phase].fetch_add (
+        std::chrono::duration_cast<std::chrono::nanoseconds> (duration).count (), std::memory_order_relaxed);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "GPUResources.h"
+
+namespace WallpaperEngine::Render {
+/**
+ * Sums up what the last frames cost so external monitors can keep an eye on a running background
+ *
+ * The render loop adds to the counters of the current frame, once every PUBLISH_INTERVAL the averages of the frames
+ * in it are written as a JSON object other threads can read with getSnapshot ()
+ * (see Application::StatsSocket). Totals since launch are kept next to them in atomics for writeMetrics ()
+ * (see Application::MetricsServer), so scraping them never blocks the render loop. When disabled nothing is
+ * measured and every call returns right away
+ */
+class FrameStats {
+  public:
+    /** Parts of the frame timed on their own, render includes particles but not present */
+    enum Phase {
+        Phase_Audio = 0,
+        Phase_Particles = 1,
+        Phase_Render = 2,
+        Phase_Present = 3,
+        Phase_Count = 4
+    };
+
+    /**
+     * Adds the time between its construction and destruction to the phase
+     */
+    class Scope {
+      public:
+        Scope (FrameStats& stats, Phase phase);
+        ~Scope ();
+
+        Scope (const Scope&) = delete;
+        Scope& operator= (const Scope&) = delete;
+
+      private:
+        FrameStats& m_stats;
+        Phase m_phase;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /** What's shown on a screen as of the last publish () */
+    struct Output {
+        std::string screen;
+        std::string workshopId;
+        bool visible;
+    };
+
+    explicit FrameStats (bool enabled);
+
+    /**
+     * Ends the frame in progress and starts a new one
+     *
+     * @return If the frames since the last snapshot have to be published with publish ()
+     */
+    bool beginFrame ();
+    /**
+     * Writes the averages of the frames since the last snapshot as the new one and starts counting again
+     *
+     * @param textureBytes Video memory taken by the textures
+     * @param framebufferBytes Video memory taken by the render targets
+     * @param gpuTime Milliseconds the GPU spent on the last frame, negative if it's not measured
+     * @param outputs The screens and what's on them
+     */
+    void publish (uint64_t textureBytes, uint64_t framebufferBytes, double gpuTime, std::vector<Output> outputs);
+    /**
+     * Keeps the audio driver's state for the next snapshot
+     *
+     * @param bufferTime Milliseconds of sound in the device's buffer
+     * @param underruns Callbacks where a stream ran out of decoded samples so far
+     * @param lateCallbacks Callbacks that came too late to keep the device's buffer filled so far
+     * @param realtime If the mixing thread has real-time scheduling
+     */
+    void setAudio (double bufferTime, uint64_t underruns, uint64_t lateCallbacks, bool realtime);
+    void addDraws (uint32_t draws);
+    void addParticles (uint32_t particles);
+    /** Can be called from any thread, backgrounds are loaded ahead of time on others */
+    void addLoad (std::chrono::steady_clock::duration duration);
+    /** Frames around a pause are measured as if it never happened */
+    void setPaused (bool paused);
+    [[nodiscard]] bool isEnabled () const;
+    /**
+     * Can be called from any thread
+     *
+     * @return The last published snapshot, an empty JSON object before the first one
+     */
+    [[nodiscard]] std::string getSnapshot () const;
+    /**
+     * Writes the totals since launch in the OpenMetrics text format, can be called from any thread
+     */
+    void writeMetrics (std::ostream& out) const;
+
+  private:
+    static constexpr std::chrono::seconds PUBLISH_INTERVAL {1};
+    /** upper bounds of the frame time histogram's buckets in seconds, from 200 FPS down to 1 */
+    static constexpr std::array<double, 10> FRAME_BUCKETS = {
+        0.005, 0.010, 0.0167, 0.025, 0.0334, 0.050, 0.100, 0.250, 0.500, 1.000};
+
+    void add (Phase phase, std::chrono::steady_clock::duration duration);
+
+    bool m_enabled;
+    std::chrono::steady_clock::time_point m_frameStart = {};
+    std::chrono::steady_clock::time_point m_windowStart = {};
+    /** totals of the frames since the last snapshot */
+    uint32_t m_frames = 0;
+    std::chrono::steady_clock::duration m_frameTime = {};
+    std::chrono::steady_clock::duration m_longestFrame = {};
+    std::array<std::chrono::steady_clock::duration, Phase_Count> m_phases = {};
+    uint64_t m_draws = 0;
+    uint64_t m_particles = 0;
+    /** the audio driver's, only totals so they're not reset between snapshots */
+    double m_audioBufferTime = 0.0;
+    uint64_t m_audioUnderruns = 0;
+    uint64_t m_audioLateCallbacks = 0;
+    bool m_audioRealtime = false;
+    std::chrono::steady_clock::time_point m_pauseStart = {};
+    /** particles counted in the frame in progress */
+    uint64_t m_frameParticles = 0;
+    mutable std::mutex m_mutex = {};
+    std::string m_snapshot = "{}";
+    /** guarded by m_mutex like the snapshot, it only changes with it */
+    std::vector<Output> m_outputs = {};
+
+    /** totals since launch, only written by the render loop (loads aside) and read by whoever scrapes them */
+    struct {
+        std::atomic<uint64_t> frames = 0;
+        /** frames per bucket of FRAME_BUCKETS, not cumulative, the last one is for those over every bound */
+        std::array<std::atomic<uint64_t>, FRAME_BUCKETS.size () + 1> frameBuckets = {};
+        std::atomic<int64_t> frameNanoseconds = 0;
+        std::array<std::atomic<int64_t>, Phase_Count> phaseNanoseconds = {};
+        std::atomic<uint64_t> draws = 0;
+        /** live in the last frame */
+        std::atomic<uint64_t> particles = 0;
+        /** milliseconds, negative when it's not measured */
+        std::atomic<double> gpuTime = -1.0;
+        std::atomic<uint64_t> textureCacheBytes = 0;
+        std::array<std::atomic<uint64_t>, GPUResources::Type_Count> videoMemory = {};
+        std::atomic<uint64_t> loads = 0;
+        std::atomic<int64_t> loadNanoseconds = 0;
+        std::atomic<bool> paused = false;
+        std::atomic<uint64_t> audioUnderruns = 0;
+    } m_totals;
+};
+} // namespace WallpaperEngine::Render
@@ -0,0 +1,192 @@
+#include "FrameUniforms.h"
+
+#include <cstddef>
+#include <regex>
+
+using namespace WallpaperEngine::Render;
+
+namespace {
+struct Variable {
+    const char* name;
+    const char* type;
+    const char* member;
+    /** array size, 0 for plain values */
+    int count;
+};
+
+/** in the same order as the members of FrameUniforms::Block */
+constexpr Variable VARIABLES [] = {
+    {"g_Time", "float", "time", 0},
+    {"g_Daytime", "float", "daytime", 0},
+    {"g_PointerPosition", "vec2", "pointerPosition", 0},
+    {"g_PointerPositionLast", "vec2", "pointerPositionLast", 0},
+    {"g_AudioSpectrum16Left", "float", "audioSpectrum16Left", 16},
+    {"g_AudioSpectrum16Right", "float", "audioSpectrum16Right", 16},
+    {"g_AudioSpectrum32Left", "float", "audioSpectrum32Left", 32},
+    {"g_AudioSpectrum32Right", "float", "audioSpectrum32Right", 32},
+    {"g_AudioSpectrum64Left", "float", "audioSpectrum64Left", 64},
+    {"g_AudioSpectrum64Right", "float", "audioSpectrum64Right", 64},
+};
+
+constexpr const char* BLOCK_NAME = "g_FrameGlobals";
+constexpr const char* INSTANCE_NAME = "g_Frame";
+
+std::string buildDeclaration () {
+    std::string declaration = "layout(std140) uniform " + std::string (BLOCK_NAME) + " {\n";
+
+    for (const auto& variable : VARIABLES) {
+        declaration += "    " + std::string (variable.type) + " " + variable.member;
+
+        if (variable.count > 0)
+            declaration += "[" + std::to_string (variable.count) + "]";
+
+        declaration += ";\n";
+    }
+
+    // not replacing any uniform, only read by the code injectParallax () adds
+    declaration += "    vec4 parallaxX;\n";
+    declaration += "    vec4 parallaxY;\n";
+
+    return declaration + "} " + INSTANCE_NAME + ";\n";
+}
+
+/**
+ * Declares the block right after the #version line, unless the source already has it
+ */
+void declare (std::string& source) {
+    if (source.find (std::string ("uniform ") + BLOCK_NAME + " {") != std::string::npos)
+        return;
+
+    // #version has to stay the first thing in the source
+    size_t position = source.find ("#version");
+
+    if (position != std::string::npos) {
+        position = source.find ('\n', position);
+
+        if (position == std::string::npos) {
+            source += '\n';
+            position = source.size ();
+        } else {
+            position++;
+        }
+    } else {
+        position = 0;
+    }
+
+    source.insert (position, buildDeclaration ());
+}
+} // namespace
+
+FrameUniforms::FrameUniforms () {
+    static_assert (offsetof (Block, pointerPosition) == 8);
+    static_assert (offsetof (Block, pointerPositionLast) == 16);
+    static_assert (offsetof (Block, audioSpectrum16Left) == 32);
+    static_assert (offsetof (Block, parallaxX) % 16 == 0);
+
+    glGenBuffers (1, &this->m_buffer);
+    glBindBuffer (GL_UNIFORM_BUFFER, this->m_buffer);
+    glBufferData (GL_UNIFORM_BUFFER, sizeof (Block), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer (GL_UNIFORM_BUFFER, 0);
+}
+
+FrameUniforms::~FrameUniforms () {
+    glDeleteBuffers (1, &this->m_buffer);
+}
+
+bool FrameUniforms::rewrite (std::string& source, std::set<std::string>& replaced) {
+    bool found = false;
+
+    for (const auto& variable : VARIABLES) {
+        std::string pattern = std::string ("\\buniform\\s+") + variable.type + "\\s+" + variable.name + "\\s*";
+
+        if (variable.count > 0)
+            pattern += "\\[\\s*" + std::to_string (variable.count) + "\\s*\\]\\s*";
+
+        const std::regex declaration (pattern + ";");
+
+        if (!std::regex_search (source, declaration))
+            continue;
+
+        // the define stays where the declaration was, so it's still subject to whatever #if surrounded it
+        source = std::regex_replace (
+            source, declaration, "\n#define " + std::string (variable.name) + " " + INSTANCE_NAME + "." + variable.member + "\n");
+        replaced.insert (variable.name);
+        found = true;
+    }
+
+    if (!found)
+        return false;
+
+    declare (source);
+
+    return true;
+}
+
+bool FrameUniforms::injectParallax (std::string& source) {
+    const std::regex entryPoint ("\\bvoid\\s+main\\s*\\(\\s*(void\\s*)?\\)");
+
+    if (!std::regex_search (source, entryPoint))
+        return false;
+
+    // the original main runs first, the offset goes on top of whatever position it came up with
+    source = std::regex_replace (source, entryPoint, "void parallaxMain ()");
+    source +=
+        "\nuniform vec2 g_ParallaxDepth;\n"
+        "void main () {\n"
+        "    parallaxMain ();\n"
+        "    gl_Position += g_ParallaxDepth.x * g_Frame.parallaxX + g_ParallaxDepth.y * g_Frame.parallaxY;\n"
+        "}\n";
+
+    declare (source);
+
+    return true;
+}
+
+void FrameUniforms::bind (const GLuint program) {
+    const GLuint index = glGetUniformBlockIndex (program, BLOCK_NAME);
+
+    // the compiler is free to remove the block if nothing ends up reading from it
+    if (index == GL_INVALID_INDEX)
+        return;
+
+    glUniformBlockBinding (program, index, BINDING);
+}
+
+void FrameUniforms::update (
+    const float time, const float daytime, const glm::vec2& pointerPosition, const glm::vec2& pointerPositionLast,
+    const glm::vec2& parallaxDisplacement, const glm::mat4& viewProjection,
+    const Audio::Drivers::Recorders::PlaybackRecorder& recorder
+) {
+    const auto copy = [] (float (*destination) [4], const float* values, const int count) {
+        for (int i = 0; i < count; i++)
+            destination [i][0] = values [i];
+    };
+
+    this->m_block.time = time;
+    this->m_block.daytime = daytime;
+    this->m_block.pointerPosition [0] = pointerPosition.x;
+    this->m_block.pointerPosition [1] = pointerPosition.y;
+    this->m_block.pointerPositionLast [0] = pointerPositionLast.x;
+    this->m_block.pointerPositionLast [1] = pointerPositionLast.y;
+
+    // moving a vertex along x and y in world space moves it by these columns of the camera's matrix in clip space
+    for (int i = 0; i < 4; i++) {
+        this->m_block.parallaxX [i] = parallaxDisplacement.x * viewProjection [0][i];
+        this->m_block.parallaxY [i] = parallaxDisplacement.y * viewProjection [1][i];
+    }
+
+    copy (this->m_block.audioSpectrum16Left, recorder.audio16Left, 16);
+    copy (this->m_block.audioSpectrum16Right, recorder.audio16Right, 16);
+    copy (this->m_block.audioSpectrum32Left, recorder.audio32Left, 32);
+    copy (this->m_block.audioSpectrum32Right, recorder.audio32Right, 32);
+    copy (this->m_block.audioSpectrum64Left, recorder.audio64Left, 64);
+    copy (this->m_block.audioSpectrum64Right, recorder.audio64Right, 64);
+
+    glBindBuffer (GL_UNIFORM_BUFFER, this->m_buffer);
+    glBufferSubData (GL_UNIFORM_BUFFER, 0, sizeof (Block), &this->m_block);
+    glBindBuffer (GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::use () const {
+    glBindBufferBase (GL_UNIFORM_BUFFER, BINDING, this->m_buffer);
+}
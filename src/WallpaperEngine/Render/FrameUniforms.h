@@ -0,0 +1,94 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+#include <GL/glew.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+
+#include "WallpaperEngine/Audio/Drivers/Recorders/PlaybackRecorder.h"
+
+namespace WallpaperEngine::Render {
+/**
+ * Uniform block with the values every pass of a scene shares and that change from one frame to the next
+ *
+ * Shaders get their declarations of these variables swapped for members of the block by rewrite (),
+ * so the scene uploads them once per frame instead of every pass setting its own copy. The block
+ * always has the same std140 layout, so one buffer serves every program that uses it
+ *
+ * The block also carries the parallax displacement already taken through the camera, vertex shaders get it
+ * added to their output by injectParallax () scaled by the depth of the layer they draw
+ */
+class FrameUniforms {
+  public:
+    /** Uniform buffer binding point the block is attached to */
+    static constexpr GLuint BINDING = 0;
+
+    FrameUniforms ();
+    ~FrameUniforms ();
+
+    FrameUniforms (const FrameUniforms&) = delete;
+    FrameUniforms& operator= (const FrameUniforms&) = delete;
+
+    /**
+     * Replaces the declarations of the block's variables in the given source with accessors into the block
+     * and declares the block right after the #version line, leaves the source alone if no variable was found
+     *
+     * @param source The GLSL source to update
+     * @param replaced Gets the names of the variables found in the source added to it
+     *
+     * @return If anything was replaced
+     */
+    static bool rewrite (std::string& source, std::set<std::string>& replaced);
+
+    /**
+     * Wraps the main function of a vertex shader so the parallax displacement is added to gl_Position, scaled by
+     * the g_ParallaxDepth uniform it declares. Passes that leave it at zero draw exactly as before
+     *
+     * @param source The GLSL source of the vertex shader to update
+     *
+     * @return If the source had a main function to wrap
+     */
+    static bool injectParallax (std::string& source);
+
+    /**
+     * Attaches the block of a linked program to BINDING
+     *
+     * @param program
+     */
+    static void bind (GLuint program);
+
+    void update (
+        float time, float daytime, const glm::vec2& pointerPosition, const glm::vec2& pointerPositionLast,
+        const glm::vec2& parallaxDisplacement, const glm::mat4& viewProjection,
+        const Audio::Drivers::Recorders::PlaybackRecorder& recorder);
+
+    /**
+     * Makes the programs bound to BINDING read this buffer
+     */
+    void use () const;
+
+  private:
+    /** mirrors the std140 layout of the GLSL block, array elements are padded to 16 bytes */
+    struct Block {
+        float time;
+        float daytime;
+        float pointerPosition [2];
+        float pointerPositionLast [2];
+        float padding [2];
+        float audioSpectrum16Left [16][4];
+        float audioSpectrum16Right [16][4];
+        float audioSpectrum32Left [32][4];
+        float audioSpectrum32Right [32][4];
+        float audioSpectrum64Left [64][4];
+        float audioSpectrum64Right [64][4];
+        /** the displacement along each axis, as the clip space offset one unit of it moves a vertex */
+        float parallaxX [4];
+        float parallaxY [4];
+    };
+
+    GLuint m_buffer = 0;
+    Block m_block = {};
+};
+} // namespace WallpaperEngine::Render
@@ -0,0 +1,159 @@
+#include "GPUProfiler.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+using namespace WallpaperEngine::Render;
+
+GPUProfiler::Scope::Scope (GPUProfiler& profiler, const Entry entry) :
+    m_profiler (profiler) {
+    this->m_profiler.begin (entry);
+}
+
+GPUProfiler::Scope::~Scope () {
+    this->m_profiler.end ();
+}
+
+GPUProfiler::GPUProfiler (const bool enabled) :
+    m_enabled (enabled) {}
+
+GPUProfiler::~GPUProfiler () {
+    for (auto& frame : this->m_frames)
+        if (!frame.queries.empty ())
+            glDeleteQueries (static_cast<GLsizei> (frame.queries.size ()), frame.queries.data ());
+}
+
+GPUProfiler::Entry GPUProfiler::registerEntry (std::string name) {
+    this->m_totals.push_back ({.name = std::move (name)});
+
+    return static_cast<Entry> (this->m_totals.size () - 1);
+}
+
+void GPUProfiler::beginFrame () {
+    if (!this->m_enabled)
+        return;
+
+    this->m_current = (this->m_current + 1) % FRAMES;
+    // the slot about to be reused is the oldest frame in flight
+    this->collect (this->m_frames [this->m_current]);
+
+    if (std::chrono::steady_clock::now () - this->m_lastReport >= REPORT_INTERVAL)
+        this->report ();
+}
+
+void GPUProfiler::begin (const Entry entry) {
+    if (!this->m_enabled)
+        return;
+
+    auto& frame = this->m_frames [this->m_current];
+    const size_t used = frame.entries.size () * 2;
+
+    // queries are only ever added, frames with less draws leave the rest unused
+    if (frame.queries.size () < used + 2) {
+        const size_t previous = frame.queries.size ();
+
+        frame.queries.resize (std::max<size_t> (used + 2, previous * 2));
+        glGenQueries (
+            static_cast<GLsizei> (frame.queries.size () - previous), frame.queries.data () + previous);
+    }
+
+    frame.entries.push_back (entry);
+    glQueryCounter (frame.queries [used], GL_TIMESTAMP);
+}
+
+void GPUProfiler::end () {
+    if (!this->m_enabled)
+        return;
+
+    auto& frame = this->m_frames [this->m_current];
+
+    glQueryCounter (frame.queries [frame.entries.size () * 2 - 1], GL_TIMESTAMP);
+}
+
+bool GPUProfiler::isEnabled () const {
+    return this->m_enabled;
+}
+
+double GPUProfiler::getFrameTime () const {
+    return this->m_frameTime;
+}
+
+void GPUProfiler::collect (Frame& frame) {
+    if (frame.entries.empty ())
+        return;
+
+    GLint available = GL_FALSE;
+
+    // the queries finish in order, if the last one is there all the others are too
+    glGetQueryObjectiv (frame.queries [frame.entries.size () * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+    if (available == GL_FALSE) {
+        this->m_dropped++;
+        frame.entries.clear ();
+        return;
+    }
+
+    uint64_t frameNanoseconds = 0;
+
+    for (size_t i = 0; i < frame.entries.size (); i++) {
+        GLuint64 start = 0;
+        GLuint64 end = 0;
+
+        glGetQueryObjectui64v (frame.queries [i * 2], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v (frame.queries [i * 2 + 1], GL_QUERY_RESULT, &end);
+
+        auto& totals = this->m_totals [frame.entries [i]];
+
+        totals.nanoseconds += end - start;
+        totals.draws++;
+        frameNanoseconds += end - start;
+    }
+
+    this->m_frameTime = static_cast<double> (frameNanoseconds) / 1000000.0;
+    this->m_collected++;
+    frame.entries.clear ();
+}
+
+void GPUProfiler::report () {
+    this->m_lastReport = std::chrono::steady_clock::now ();
+
+    if (this->m_collected == 0)
+        return;
+
+    std::vector<const Totals*> sorted = {};
+
+    for (const auto& totals : this->m_totals)
+        if (totals.draws > 0)
+            sorted.push_back (&totals);
+
+    std::ranges::sort (sorted, [] (const Totals* a, const Totals* b) { return a->nanoseconds > b->nanoseconds; });
+
+    const auto frames = static_cast<double> (this->m_collected);
+    const uint64_t total = std::accumulate (
+        sorted.begin (), sorted.end (), uint64_t {0},
+        [] (const uint64_t sum, const Totals* totals) { return sum + totals->nanoseconds; });
+    std::ostringstream out;
+
+    out << std::fixed << std::setprecision (3);
+    out << "GPU profile over " << this->m_collected << " frames (" << this->m_dropped << " dropped), "
+        << total / frames / 1000000.0 << "ms per frame:";
+
+    for (const auto* totals : sorted) {
+        out << "\n  " << std::setw (8) << totals->nanoseconds / frames / 1000000.0 << "ms "
+            << std::setprecision (1) << std::setw (6) << totals->draws / frames << " draws  " << totals->name
+            << std::setprecision (3);
+    }
+
+    sLog.out (out.str ());
+
+    for (auto& totals : this->m_totals) {
+        totals.nanoseconds = 0;
+        totals.draws = 0;
+    }
+
+    this->m_collected = 0;
+    this->m_dropped = 0;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+namespace WallpaperEngine::Render {
+/**
+ * Measures how long the GPU takes to draw every object with timestamp queries
+ *
+ * Every measured draw writes a GL_TIMESTAMP query before and after it. The queries of a frame are only read after
+ * FRAMES more frames started, by then the GPU is done with them and reading doesn't stall the pipeline, frames
+ * whose queries still aren't done are dropped instead of waited for. Every few seconds the totals are logged,
+ * heaviest first. When disabled nothing is queried and every call returns right away
+ */
+class GPUProfiler {
+  public:
+    using Entry = uint32_t;
+
+    /**
+     * Measures the GPU time of the draws done while it's alive
+     */
+    class Scope {
+      public:
+        Scope (GPUProfiler& profiler, Entry entry);
+        ~Scope ();
+
+        Scope (const Scope&) = delete;
+        Scope& operator= (const Scope&) = delete;
+
+      private:
+        GPUProfiler& m_profiler;
+    };
+
+    explicit GPUProfiler (bool enabled);
+    ~GPUProfiler ();
+
+    GPUProfiler (const GPUProfiler&) = delete;
+    GPUProfiler& operator= (const GPUProfiler&) = delete;
+
+    /**
+     * @param name What the time is reported as, several entries can have the same name
+     *
+     * @return The entry to measure draws with
+     */
+    Entry registerEntry (std::string name);
+    /**
+     * Reads the queries of the oldest frame in flight and starts a new one, logs the totals every REPORT_INTERVAL
+     */
+    void beginFrame ();
+    /**
+     * Starts measuring a draw of the entry, measurements can't be nested
+     *
+     * @param entry
+     */
+    void begin (Entry entry);
+    /**
+     * Stops measuring the draw started with begin ()
+     */
+    void end ();
+    [[nodiscard]] bool isEnabled () const;
+    /**
+     * @return Milliseconds the GPU spent on the draws measured in the last frame read back, negative if there's none
+     */
+    [[nodiscard]] double getFrameTime () const;
+
+  private:
+    /** frames in flight before their queries are read */
+    static constexpr uint32_t FRAMES = 4;
+    static constexpr std::chrono::seconds REPORT_INTERVAL {5};
+
+    struct Frame {
+        /** pairs of start and end queries, kept between frames */
+        std::vector<GLuint> queries = {};
+        /** entry measured by every pair */
+        std::vector<Entry> entries = {};
+    };
+
+    struct Totals {
+        std::string name;
+        uint64_t nanoseconds = 0;
+        uint32_t draws = 0;
+    };
+
+    /** Adds the results of the frame to the totals and empties it */
+    void collect (Frame& frame);
+    void report ();
+
+    bool m_enabled;
+    std::array<Frame, FRAMES> m_frames = {};
+    uint32_t m_current = 0;
+    std::vector<Totals> m_totals = {};
+    /** frames in the totals, and frames dropped because their results were late */
+    uint32_t m_collected = 0;
+    uint32_t m_dropped = 0;
+    double m_frameTime = -1.0;
+    std::chrono::steady_clock::time_point m_lastReport = std::chrono::steady_clock::now ();
+};
+} // namespace WallpaperEngine::Render
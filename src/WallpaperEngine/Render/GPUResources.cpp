@@ -0,0 +1,224 @@
+#include "GPUResources.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <ranges>
+#include <sstream>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+using namespace WallpaperEngine::Render;
+
+std::unique_ptr<GPUResources> GPUResources::sInstance = nullptr;
+
+namespace {
+/** owner the resources created right now belong to, nullptr outside of any Owner scope */
+const std::string* currentOwner = nullptr;
+
+constexpr const char* TYPE_NAMES [GPUResources::Type_Count] = {"texture", "framebuffer", "buffer", "program"};
+
+double megabytes (const uint64_t bytes) {
+    return static_cast<double> (bytes) / (1024.0 * 1024.0);
+}
+
+/** @return The owner as shown, resources created outside of any wallpaper are shared by all of them */
+const std::string& ownerName (const GPUResources::Resource& resource) {
+    static const std::string shared = "shared";
+
+    return resource.owner.empty () ? shared : resource.owner;
+}
+} // namespace
+
+GPUResources::Owner::Owner (const std::string& name) :
+    m_previous (currentOwner) {
+    currentOwner = &name;
+}
+
+GPUResources::Owner::~Owner () {
+    currentOwner = this->m_previous;
+}
+
+GPUResources& GPUResources::get () {
+    if (sInstance == nullptr)
+        sInstance = std::make_unique<GPUResources> ();
+
+    return *sInstance;
+}
+
+void GPUResources::add (
+    const void* handle, const Type type, const uint64_t bytes, std::string name, std::string format,
+    const std::source_location site
+) {
+    this->remove (handle);
+    this->m_resources.emplace (
+        handle, Resource {
+                    .type = type,
+                    .bytes = bytes,
+                    .name = std::move (name),
+                    .format = std::move (format),
+                    .owner = currentOwner == nullptr ? "" : *currentOwner,
+                    .site = site,
+                });
+    this->m_totals [type] += bytes;
+}
+
+void GPUResources::resize (const void* handle, const uint64_t bytes) {
+    const auto it = this->m_resources.find (handle);
+
+    if (it == this->m_resources.end ())
+        return;
+
+    this->m_totals [it->second.type] += bytes - it->second.bytes;
+    it->second.bytes = bytes;
+}
+
+void GPUResources::remove (const void* handle) {
+    const auto it = this->m_resources.find (handle);
+
+    if (it == this->m_resources.end ())
+        return;
+
+    this->m_totals [it->second.type] -= it->second.bytes;
+    this->m_resources.erase (it);
+}
+
+uint64_t GPUResources::getBytes (const Type type) const {
+    return this->m_totals [type];
+}
+
+void GPUResources::writeSummary (std::ostream& out) const {
+    std::map<std::string, uint64_t> owners = {};
+
+    for (const auto& resource : this->m_resources | std::views::values)
+        owners [ownerName (resource)] += resource.bytes;
+
+    out << "{\"textureMB\":" << megabytes (this->m_totals [Type_Texture])
+        << ",\"framebufferMB\":" << megabytes (this->m_totals [Type_Framebuffer])
+        << ",\"bufferMB\":" << megabytes (this->m_totals [Type_Buffer])
+        << ",\"programMB\":" << megabytes (this->m_totals [Type_Program]) << ",\"owners\":{";
+
+    bool first = true;
+
+    for (const auto& [owner, bytes] : owners) {
+        // titles come from the workshop, anything can be in them
+        out << (first ? "" : ",") << nlohmann::json (owner).dump () << ':' << megabytes (bytes);
+        first = false;
+    }
+
+    int64_t used = -1;
+    int64_t available = -1;
+
+    driverMemory (used, available);
+
+    out << "},\"driver\":{\"usedMB\":";
+
+    if (used < 0)
+        out << "null";
+    else
+        out << static_cast<double> (used) / 1024.0;
+
+    out << ",\"availableMB\":";
+
+    if (available < 0)
+        out << "null";
+    else
+        out << static_cast<double> (available) / 1024.0;
+
+    out << "}}";
+}
+
+void GPUResources::dump (std::ostream& stream) const {
+    std::map<std::string, std::vector<const Resource*>> owners = {};
+    // formatted on its own so the stream given is left as it was
+    std::ostringstream out;
+
+    for (const auto& resource : this->m_resources | std::views::values)
+        owners [ownerName (resource)].push_back (&resource);
+
+    out << std::fixed << std::setprecision (2);
+    out << "Video memory: " << megabytes (this->m_totals [Type_Texture]) << "MB in textures, "
+        << megabytes (this->m_totals [Type_Framebuffer]) << "MB in framebuffers, "
+        << megabytes (this->m_totals [Type_Buffer]) << "MB in buffers, "
+        << megabytes (this->m_totals [Type_Program]) << "MB in programs" << std::endl;
+
+    int64_t used = -1;
+    int64_t available = -1;
+
+    driverMemory (used, available);
+
+    if (used >= 0)
+        out << "Driver reports " << static_cast<double> (used) / 1024.0 << "MB in use" << std::endl;
+    if (available >= 0)
+        out << "Driver reports " << static_cast<double> (available) / 1024.0 << "MB available" << std::endl;
+
+    for (auto& [owner, resources] : owners) {
+        uint64_t total = 0;
+
+        for (const auto* resource : resources)
+            total += resource->bytes;
+
+        std::ranges::sort (resources, [] (const Resource* a, const Resource* b) { return a->bytes > b->bytes; });
+
+        out << owner << ": " << megabytes (total) << "MB" << std::endl;
+
+        for (const auto* resource : resources) {
+            out << "\t" << megabytes (resource->bytes) << "MB " << TYPE_NAMES [resource->type] << " "
+                << resource->name;
+
+            if (!resource->format.empty ())
+                out << " (" << resource->format << ")";
+
+            out << " from " << resource->site.file_name () << ":" << resource->site.line () << std::endl;
+        }
+    }
+
+    stream << out.str ();
+}
+
+std::string GPUResources::formatName (const GLenum format) {
+    switch (format) {
+        case GL_RGBA8: return "RGBA8";
+        case GL_RG8: return "RG8";
+        case GL_R8: return "R8";
+        case GL_R16F: return "R16F";
+        case GL_RG16F: return "RG16F";
+        case GL_RGBA16F: return "RGBA16F";
+        case GL_RGB10_A2: return "RGB10A2";
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return "DXT1";
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: return "DXT3";
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "DXT5";
+        case GL_COMPRESSED_RGBA_BPTC_UNORM: return "BC7";
+        default: break;
+    }
+
+    std::ostringstream out;
+
+    out << "0x" << std::hex << format;
+
+    return out.str ();
+}
+
+void GPUResources::driverMemory (int64_t& used, int64_t& available) {
+    used = -1;
+    available = -1;
+
+    if (GLEW_NVX_gpu_memory_info) {
+        GLint total = 0;
+        GLint unused = 0;
+
+        glGetIntegerv (GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &total);
+        glGetIntegerv (GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &unused);
+
+        used = total - unused;
+        available = unused;
+    } else if (GLEW_ATI_meminfo) {
+        // total free, largest free block, then the same for auxiliary memory; the total isn't reported
+        GLint unused [4] = {};
+
+        glGetIntegerv (GL_TEXTURE_FREE_MEMORY_ATI, unused);
+
+        available = unused [0];
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <source_location>
+#include <string>
+#include <unordered_map>
+
+#include <GL/glew.h>
+
+namespace WallpaperEngine::Render {
+/**
+ * Keeps track of the video memory every texture, render target, buffer and program takes, and who it's for
+ *
+ * Resources are registered by whatever creates them, keyed by any address that's unique to them while they live
+ * (usually the object owning the GL name). The owner is the wallpaper in whose Owner scope they were created,
+ * resources shared between wallpapers stay with the first one. Sizes are what the data takes, not what the driver
+ * pads it to, so the driver's own totals are included next to them when it reports them
+ *
+ * Only used from the render thread
+ */
+class GPUResources {
+  public:
+    enum Type {
+        Type_Texture = 0,
+        Type_Framebuffer = 1,
+        Type_Buffer = 2,
+        Type_Program = 3,
+        Type_Count = 4
+    };
+
+    /**
+     * Resources registered while it lives belong to the given owner, scopes can be nested
+     */
+    class Owner {
+      public:
+        /**
+         * @param name Has to outlive the scope, it's only copied when resources are registered
+         */
+        explicit Owner (const std::string& name);
+        ~Owner ();
+
+        Owner (const Owner&) = delete;
+        Owner& operator= (const Owner&) = delete;
+
+      private:
+        const std::string* m_previous;
+    };
+
+    struct Resource {
+        Type type;
+        uint64_t bytes;
+        std::string name;
+        std::string format;
+        std::string owner;
+        std::source_location site;
+    };
+
+    static GPUResources& get ();
+
+    /**
+     * Starts tracking a resource, the same handle being added again replaces it
+     *
+     * @param handle Unique to the resource while it lives
+     * @param type
+     * @param bytes Video memory it takes, can be updated with resize ()
+     * @param name Texture file, render target or whatever tells the resource apart
+     * @param format Pixel or data format, empty if it doesn't apply
+     * @param site Where it was created, filled in by the compiler
+     */
+    void add (
+        const void* handle, Type type, uint64_t bytes, std::string name, std::string format = "",
+        std::source_location site = std::source_location::current ());
+    /**
+     * Updates the size of a tracked resource, unknown handles are ignored
+     */
+    void resize (const void* handle, uint64_t bytes);
+    /**
+     * Stops tracking a resource, unknown handles are ignored
+     */
+    void remove (const void* handle);
+
+    /** @return Video memory the resources of the given type take */
+    [[nodiscard]] uint64_t getBytes (Type type) const;
+    /**
+     * Writes the totals per type and per owner, and the driver's totals if it reports them, as a JSON object
+     */
+    void writeSummary (std::ostream& out) const;
+    /**
+     * Writes every resource, the biggest first, grouped by owner
+     */
+    void dump (std::ostream& stream) const;
+
+    /**
+     * @return A readable name for the GL internal format
+     */
+    [[nodiscard]] static std::string formatName (GLenum format);
+
+  private:
+    /**
+     * Reads the video memory the driver says is in use and available, in KB, -1 if it doesn't tell
+     */
+    static void driverMemory (int64_t& used, int64_t& available);
+
+    std::unordered_map<const void*, Resource> m_resources = {};
+    std::array<uint64_t, Type_Count> m_totals = {};
+
+    static std::unique_ptr<GPUResources> sInstance;
+};
+} // namespace WallpaperEngine::Render
+
+#define sGPUResources (WallpaperEngine::Render::GPUResources::get ())
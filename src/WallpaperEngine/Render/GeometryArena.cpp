@@ -0,0 +1,52 @@
+#include "GeometryArena.h"
+#include "GPUResources.h"
+
+#include <utility>
+
+using namespace WallpaperEngine::Render;
+
+GeometryArena::GeometryArena () {
+    glGenBuffers (1, &this->m_buffer);
+    sGPUResources.add (this, GPUResources::Type_Buffer, 0, "scene geometry");
+
+#if !NDEBUG
+    glBindBuffer (GL_ARRAY_BUFFER, this->m_buffer);
+    glObjectLabel (GL_BUFFER, this->m_buffer, -1, "Scene geometry");
+#endif /* DEBUG */
+}
+
+GeometryArena::~GeometryArena () {
+    sGPUResources.remove (this);
+    glDeleteBuffers (1, &this->m_buffer);
+}
+
+GLintptr GeometryArena::add (const GLfloat* data, size_t count) {
+    std::vector<GLfloat> vertices (data, data + count);
+
+    if (const auto it = this->m_offsets.find (vertices); it != this->m_offsets.end ())
+        return it->second;
+
+    const auto offset = static_cast<GLintptr> (this->m_data.size () * sizeof (GLfloat));
+
+    this->m_data.insert (this->m_data.end (), vertices.begin (), vertices.end ());
+    this->m_offsets.emplace (std::move (vertices), offset);
+
+    return offset;
+}
+
+void GeometryArena::bind () {
+    glBindBuffer (GL_ARRAY_BUFFER, this->m_buffer);
+
+    if (this->m_uploaded == this->m_data.size ())
+        return;
+
+    // offsets handed out stay valid, the buffer only ever grows
+    glBufferData (GL_ARRAY_BUFFER, this->getSize (), this->m_data.data (), GL_STATIC_DRAW);
+    sGPUResources.resize (this, this->getSize ());
+
+    this->m_uploaded = this->m_data.size ();
+}
+
+size_t GeometryArena::getSize () const {
+    return this->m_data.size () * sizeof (GLfloat);
+}
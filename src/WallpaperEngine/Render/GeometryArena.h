@@ -0,0 +1,53 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace WallpaperEngine::Render {
+/**
+ * Single vertex buffer holding the static quads and texture coordinates of a scene
+ *
+ * Images used to create five buffers each for geometry that is mostly the same on every layer (the pass quad,
+ * the pass texcoords, the fullscreen copies...). Instead every set of vertices is appended here once and
+ * images keep the offset the data ended up at, identical sets are stored only once. The buffer is uploaded
+ * the first time it's bound after new data was added, which in practice is once after the scene is loaded
+ */
+class GeometryArena {
+  public:
+    GeometryArena ();
+    ~GeometryArena ();
+
+    GeometryArena (const GeometryArena&) = delete;
+    GeometryArena& operator= (const GeometryArena&) = delete;
+
+    /**
+     * @param data The vertex data to store
+     * @param count Amount of floats in data
+     *
+     * @return Offset in bytes of the data in the buffer, to be used as the attribute pointer
+     */
+    GLintptr add (const GLfloat* data, size_t count);
+
+    template <size_t N> GLintptr add (const GLfloat (&data) [N]) {
+        return this->add (data, N);
+    }
+
+    /**
+     * Binds the buffer to GL_ARRAY_BUFFER, uploading anything added since the last time
+     */
+    void bind ();
+
+    /** @return Bytes of vertex data stored */
+    [[nodiscard]] size_t getSize () const;
+
+  private:
+    GLuint m_buffer = GL_NONE;
+    std::vector<GLfloat> m_data = {};
+    /** offset of every distinct set of vertices stored */
+    std::map<std::vector<GLfloat>, GLintptr> m_offsets = {};
+    /** amount of floats in m_data the buffer holds */
+    size_t m_uploaded = 0;
+};
+} // namespace WallpaperEngine::Render
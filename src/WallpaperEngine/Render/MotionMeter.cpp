@@ -0,0 +1,122 @@
+#include "MotionMeter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+using namespace WallpaperEngine::Render;
+
+MotionMeter::MotionMeter () {
+    glGenTextures (1, &this->m_texture);
+    glBindTexture (GL_TEXTURE_2D, this->m_texture);
+    glTexStorage2D (GL_TEXTURE_2D, 1, GL_RGBA8, SIZE, SIZE);
+    glBindTexture (GL_TEXTURE_2D, GL_NONE);
+
+    glGenFramebuffers (1, &this->m_framebuffer);
+    glBindFramebuffer (GL_FRAMEBUFFER, this->m_framebuffer);
+    glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->m_texture, 0);
+    glBindFramebuffer (GL_FRAMEBUFFER, GL_NONE);
+
+    for (auto& copy : this->m_copies) {
+        glGenBuffers (1, &copy.buffer);
+        glBindBuffer (GL_PIXEL_PACK_BUFFER, copy.buffer);
+        glBufferData (GL_PIXEL_PACK_BUFFER, SIZE * SIZE * 4, nullptr, GL_STREAM_READ);
+    }
+
+    glBindBuffer (GL_PIXEL_PACK_BUFFER, GL_NONE);
+}
+
+MotionMeter::~MotionMeter () {
+    for (auto& copy : this->m_copies) {
+        if (copy.fence != nullptr)
+            glDeleteSync (copy.fence);
+
+        glDeleteBuffers (1, &copy.buffer);
+    }
+
+    glDeleteFramebuffers (1, &this->m_framebuffer);
+    glDeleteTextures (1, &this->m_texture);
+}
+
+void MotionMeter::sample (const GLuint framebuffer, const glm::ivec4& region) {
+    for (auto& copy : this->m_copies)
+        this->collect (copy);
+
+    auto& copy = this->m_copies [this->m_next];
+
+    // the GPU is behind by a whole ring, skip this frame instead of waiting on it
+    if (copy.fence != nullptr)
+        return;
+
+    glBindFramebuffer (GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->m_framebuffer);
+    glBlitFramebuffer (
+        region.x, region.y, region.x + region.z, region.y + region.w, 0, 0, SIZE, SIZE, GL_COLOR_BUFFER_BIT,
+        GL_LINEAR);
+
+    glBindFramebuffer (GL_READ_FRAMEBUFFER, this->m_framebuffer);
+    glBindBuffer (GL_PIXEL_PACK_BUFFER, copy.buffer);
+    glReadPixels (0, 0, SIZE, SIZE, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer (GL_PIXEL_PACK_BUFFER, GL_NONE);
+    glBindFramebuffer (GL_FRAMEBUFFER, GL_NONE);
+
+    copy.fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    copy.time = Clock::now ();
+    this->m_next = (this->m_next + 1) % BUFFERS;
+}
+
+void MotionMeter::collect (Copy& copy) {
+    if (copy.fence == nullptr || glClientWaitSync (copy.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        return;
+
+    glDeleteSync (copy.fence);
+    copy.fence = nullptr;
+
+    glBindBuffer (GL_PIXEL_PACK_BUFFER, copy.buffer);
+
+    const auto* pixels = static_cast<const uint8_t*> (
+        glMapBufferRange (GL_PIXEL_PACK_BUFFER, 0, SIZE * SIZE * 4, GL_MAP_READ_BIT));
+
+    if (pixels == nullptr) {
+        glBindBuffer (GL_PIXEL_PACK_BUFFER, GL_NONE);
+        return;
+    }
+
+    const bool compare = !this->m_last.empty () && copy.time > this->m_lastTime;
+    uint64_t difference = 0;
+
+    this->m_last.resize (SIZE * SIZE * 4);
+
+    for (size_t index = 0; index < this->m_last.size (); index++) {
+        // alpha doesn't reach the screen
+        if (index % 4 != 3)
+            difference += std::abs (static_cast<int> (pixels [index]) - static_cast<int> (this->m_last [index]));
+
+        this->m_last [index] = pixels [index];
+    }
+
+    glUnmapBuffer (GL_PIXEL_PACK_BUFFER);
+    glBindBuffer (GL_PIXEL_PACK_BUFFER, GL_NONE);
+
+    const auto previous = std::exchange (this->m_lastTime, copy.time);
+
+    if (!compare)
+        return;
+
+    const float seconds = std::chrono::duration<float> (copy.time - previous).count ();
+    const float change = static_cast<float> (difference) / (SIZE * SIZE * 3) / seconds;
+    const float fps = change / TARGET_CHANGE;
+
+    if (fps >= this->m_fps || copy.time >= this->m_holdUntil) {
+        this->m_fps = fps;
+        this->m_holdUntil = copy.time + HOLD_TIME;
+    }
+}
+
+float MotionMeter::getFPS (const float limit) const {
+    // nothing measured yet, keep the limit until there's something to go on
+    if (this->m_lastTime == Clock::time_point {})
+        return limit;
+
+    return std::clamp (this->m_fps, std::min (MIN_FPS, limit), limit);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/vec4.hpp>
+
+namespace WallpaperEngine::Render {
+/**
+ * Measures how fast a wallpaper's image changes to tell how many frames a second its motion needs
+ *
+ * Every new frame is scaled down to SIZE x SIZE and read back through pixel pack buffers, a few frames later so
+ * nothing waits for the GPU. The average difference between two copies over the time between them is how much
+ * the image changes a second, the frame rate that keeps every frame under TARGET_CHANGE of that is what's asked
+ * for. Faster motion raises the rate right away, slower motion only lowers it once it lasted HOLD_TIME
+ */
+class MotionMeter {
+  public:
+    MotionMeter ();
+    ~MotionMeter ();
+
+    MotionMeter (const MotionMeter&) = delete;
+    MotionMeter& operator= (const MotionMeter&) = delete;
+
+    /**
+     * Queues the copy of a new frame and takes in the copies the GPU is done with, the framebuffer bindings are
+     * left unbound
+     *
+     * @param framebuffer Where the frame is
+     * @param region Part of the framebuffer the frame takes
+     */
+    void sample (GLuint framebuffer, const glm::ivec4& region);
+    /**
+     * @param limit The highest frame rate allowed
+     *
+     * @return Frames a second the motion needs, between MIN_FPS and the limit
+     */
+    [[nodiscard]] float getFPS (float limit) const;
+
+  private:
+    /** side of the scaled down copy */
+    static constexpr int SIZE = 32;
+    /** copies in flight, the oldest is read when the ring wraps around */
+    static constexpr uint32_t BUFFERS = 3;
+    /** average difference per channel (out of 255) a single frame should show at most */
+    static constexpr float TARGET_CHANGE = 0.25f;
+    /** lowest frame rate asked for, even the slowest motion is choppy below it */
+    static constexpr float MIN_FPS = 10.0f;
+    static constexpr std::chrono::seconds HOLD_TIME {2};
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Copy {
+        GLuint buffer = GL_NONE;
+        GLsync fence = nullptr;
+        Clock::time_point time = {};
+    };
+
+    /** Reads the copy if the GPU is done with it and compares it with the last one read */
+    void collect (Copy& copy);
+
+    GLuint m_framebuffer = GL_NONE;
+    GLuint m_texture = GL_NONE;
+    std::array<Copy, BUFFERS> m_copies = {};
+    uint32_t m_next = 0;
+    /** pixels of the last copy read and when it was taken */
+    std::vector<uint8_t> m_last = {};
+    Clock::time_point m_lastTime = {};
+    /** frames a second the motion asked for, and until when it's kept */
+    float m_fps = 0.0f;
+    Clock::time_point m_holdUntil = {};
+};
+} // namespace WallpaperEngine::Render
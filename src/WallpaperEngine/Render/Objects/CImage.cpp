@@ -1,4 +1,6 @@
 #include "CImage.h"
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 #include "WallpaperEngine/Data/Parsers/MaterialParser.h"
@@ -15,11 +17,11 @@ CImage::CImage (Wallpapers::CScene& scene, const Image& image) :
     Render::CObject (scene, image),
     Render::FBOProvider (&scene),
     m_texture (nullptr),
-    m_sceneSpacePosition (GL_NONE),
-    m_copySpacePosition (GL_NONE),
-    m_passSpacePosition (GL_NONE),
-    m_texcoordCopy (GL_NONE),
-    m_texcoordPass (GL_NONE),
+    m_sceneSpacePosition (0),
+    m_copySpacePosition (0),
+    m_passSpacePosition (0),
+    m_texcoordCopy (0),
+    m_texcoordPass (0),
     m_modelViewProjectionScreen (),
     m_modelViewProjectionPass (glm::mat4 (1.0)),
     m_modelViewProjectionCopy (),
@@ -34,6 +36,24 @@ CImage::CImage (Wallpapers::CScene& scene, const Image& image) :
     m_pos (),
     m_animationTime (0.0),
     m_initialized (false) {
+    // showing or hiding the image or one of its effects changes the passes, the scene has to be built again for it
+    const auto rebuild = [this] (const DynamicValue&) { this->getScene ().requestRebuild (); };
+
+    if (image.visible->property != nullptr)
+        this->m_structureListeners.push_back (image.visible->value->listen (rebuild));
+
+    for (const auto& effect : image.effects)
+        if (effect->visible->property != nullptr)
+            this->m_structureListeners.push_back (effect->visible->value->listen (rebuild));
+
+    // fading out completely takes the image off the scene too, any other alpha is just a uniform
+    if (image.alpha->property != nullptr) {
+        this->m_structureListeners.push_back (image.alpha->value->listen ([this] (const DynamicValue& alpha) {
+            if ((alpha.getFloat () <= 0.0f) != this->m_transparent)
+                this->getScene ().requestRebuild ();
+        }));
+    }
+
     // get scene width and height to calculate positions
     auto scene_width = static_cast<float> (scene.getWidth ());
     auto scene_height = static_cast<float> (scene.getHeight ());
@@ -48,11 +68,12 @@ CImage::CImage (Wallpapers::CScene& scene, const Image& image) :
     if (auto textures = (*this->m_image.model->material->passes.begin ())->textures; !textures.empty ()) {
         std::string textureName = textures.begin ()->second;
 
-        if (textureName.find ("_rt_") == 0 || textureName.find ("_alias_") == 0) {
-            this->m_texture = this->getScene ().findFBO (textureName);
+        if (const Symbol name (textureName); name.isRenderTarget ()) {
+            this->m_texture = this->getScene ().findFBO (name);
+            this->m_sceneTexture = true;
         } else {
             // get the first texture on the first pass (this one represents the image assigned to this object)
-            this->m_texture = this->getContext ().resolveTexture (textureName);
+            this->m_texture = this->getContext ().resolveTexture (textureName, this->getScene ().getScene ().project);
         }
     } else {
         if (this->m_image.model->solidlayer && size.x == 0.0f && size.y == 0.0f) {
@@ -70,8 +91,7 @@ CImage::CImage (Wallpapers::CScene& scene, const Image& image) :
 
     // If the wallpaper doesn't specify a size, fall back to the texture or model dimensions
     if ((size.x == 0.0f || size.y == 0.0f) && this->m_texture != nullptr) {
-        size.x = static_cast<float> (this->m_texture->getRealWidth ());
-        size.y = static_cast<float> (this->m_texture->getRealHeight ());
+        size = this->getSize ();
     } else if ((size.x == 0.0f || size.y == 0.0f) &&
                this->getImage ().model->width.has_value () &&
                this->getImage ().model->height.has_value ()) {
@@ -199,27 +219,14 @@ CImage::CImage (Wallpapers::CScene& scene, const Image& image) :
     GLfloat passSpacePosition [] = {-1.0, 1.0, 0.0f, -1.0, -1.0, 0.0f, 1.0, 1.0,  0.0f,
                                     1.0,  1.0, 0.0f, -1.0, -1.0, 0.0f, 1.0, -1.0, 0.0f};
 
-    // bind vertex list to the openGL buffers
-    glGenBuffers (1, &this->m_sceneSpacePosition);
-    glBindBuffer (GL_ARRAY_BUFFER, this->m_sceneSpacePosition);
-    glBufferData (GL_ARRAY_BUFFER, sizeof (sceneSpacePosition), sceneSpacePosition, GL_STATIC_DRAW);
-
-    glGenBuffers (1, &this->m_copySpacePosition);
-    glBindBuffer (GL_ARRAY_BUFFER, this->m_copySpacePosition);
-    glBufferData (GL_ARRAY_BUFFER, sizeof (copySpacePosition), copySpacePosition, GL_STATIC_DRAW);
-
-    // bind pass' vertex list to the openGL buffers
-    glGenBuffers (1, &this->m_passSpacePosition);
-    glBindBuffer (GL_ARRAY_BUFFER, this->m_passSpacePosition);
-    glBufferData (GL_ARRAY_BUFFER, sizeof (passSpacePosition), passSpacePosition, GL_STATIC_DRAW);
+    // the quads are shared with every other layer that ends up with the same vertices
+    GeometryArena& geometry = scene.getGeometry ();
 
-    glGenBuffers (1, &this->m_texcoordCopy);
-    glBindBuffer (GL_ARRAY_BUFFER, this->m_texcoordCopy);
-    glBufferData (GL_ARRAY_BUFFER, sizeof (texcoordCopy), texcoordCopy, GL_STATIC_DRAW);
-
-    glGenBuffers (1, &this->m_texcoordPass);
-    glBindBuffer (GL_ARRAY_BUFFER, this->m_texcoordPass);
-    glBufferData (GL_ARRAY_BUFFER, sizeof (texcoordPass), texcoordPass, GL_STATIC_DRAW);
+    this->m_sceneSpacePosition = geometry.add (sceneSpacePosition);
+    this->m_copySpacePosition = geometry.add (copySpacePosition);
+    this->m_passSpacePosition = geometry.add (passSpacePosition);
+    this->m_texcoordCopy = geometry.add (texcoordCopy);
+    this->m_texcoordPass = geometry.add (texcoordPass);
 
     this->m_modelViewProjectionScreen =
         this->getScene ().getCamera ().getProjection () * this->getScene ().getCamera ().getLookAt ();
@@ -232,6 +239,11 @@ CImage::CImage (Wallpapers::CScene& scene, const Image& image) :
     this->m_viewProjectionMatrix = glm::mat4 (1.0);
 }
 
+CImage::~CImage () {
+    for (const auto& deregister : this->m_structureListeners)
+        deregister ();
+}
+
 void CImage::setup () {
     // do not double-init stuff, that's bad!
     if (this->m_initialized) {
@@ -259,6 +271,10 @@ void CImage::setup () {
             // do not add non-visible effects, this might need some adjustements tho as some effects might not be visible
             // but affect the output of the image...
             if (!cur->visible->value->getBool ()) {
+                // effects toggled through a user property are likely to be shown at some point
+                if (cur->visible->property != nullptr)
+                    this->warmEffect (*cur);
+
                 continue;
             }
 
@@ -387,22 +403,26 @@ void CImage::setupPasses () {
     // do a pass on everything and setup proper inputs and values
     std::shared_ptr<const CFBO> drawTo = this->m_currentMainFBO;
     std::shared_ptr<const TextureProvider> asInput = this->getTexture ();
-    GLuint texcoord = this->getTexCoordCopy ();
+    GLintptr texcoord = this->getTexCoordCopy ();
 
     auto cur = this->m_passes.begin ();
     auto end = this->m_passes.end ();
     bool first = true;
 
+    this->m_transparent = this->isTransparent ();
+
     for (; cur != end; ++cur) {
         // TODO: PROPERLY CHECK EFFECT'S VISIBILITY AND TAKE IT INTO ACCOUNT
         // TODO: THIS REQUIRES ON-THE-FLY EVALUATION OF EFFECTS VISIBILITY TO FIGURE OUT
         // TODO: WHICH ONE IS THE LAST + A FEW OTHER THINGS
         Effects::CPass* pass = *cur;
         std::shared_ptr<const CFBO> prevDrawTo = drawTo;
-        GLuint spacePosition = (first) ? this->getCopySpacePosition () : this->getPassSpacePosition ();
+        GLintptr spacePosition = (first) ? this->getCopySpacePosition () : this->getPassSpacePosition ();
         const glm::mat4* projection = (first) ? &this->m_modelViewProjectionCopy : &this->m_modelViewProjectionPass;
         const glm::mat4* inverseProjection =
             (first) ? &this->m_modelViewProjectionCopyInverse : &this->m_modelViewProjectionPassInverse;
+        const glm::vec2* parallaxDepth = nullptr;
+        const DirectOutput* output = nullptr;
         first = false;
 
         pass->setModelMatrix (&this->m_modelMatrix);
@@ -411,7 +431,7 @@ void CImage::setupPasses () {
         // set viewport and target texture if needed
         if (pass->getTarget ().has_value ()) {
             // setup target texture
-            std::string target = pass->getTarget ().value ();
+            const Symbol target (pass->getTarget ().value ());
             drawTo = pass->getFBOProvider ()->find (target);
             // spacePosition = this->getPassSpacePosition ();
 
@@ -423,12 +443,20 @@ void CImage::setupPasses () {
         }
         // determine if it's the last element in the list as this is a screen-copy-like process
         // TODO: PROPERLY CHECK IF THIS IS ALL THAT'S NEEDED
-        else if (std::next (cur) == end && this->getImage ().visible->value->getBool ()) {
+        // transparent images keep their chain off the scene, the render graph drops it unless something samples it
+        else if (std::next (cur) == end && this->getImage ().visible->value->getBool () && !this->m_transparent) {
             // TODO: PROPERLY CHECK EFFECT'S VISIBILITY AND TAKE IT INTO ACCOUNT
             spacePosition = this->getSceneSpacePosition ();
             drawTo = this->getScene ().getFBO ();
             projection = &this->m_modelViewProjectionScreen;
             inverseProjection = &this->m_modelViewProjectionScreenInverse;
+            parallaxDepth = &this->m_parallaxDepth;
+
+            if (this->m_directOutput != nullptr) {
+                projection = &this->m_modelViewProjectionOutput;
+                inverseProjection = &this->m_modelViewProjectionOutputInverse;
+                output = this->m_directOutput;
+            }
         }
 
         pass->setDestination (drawTo);
@@ -437,6 +465,8 @@ void CImage::setupPasses () {
         pass->setTexCoord (texcoord);
         pass->setModelViewProjectionMatrix (projection);
         pass->setModelViewProjectionMatrixInverse (inverseProjection);
+        pass->setParallaxDepth (parallaxDepth);
+        pass->setDirectOutput (output);
 
         texcoord = this->getTexCoordPass ();
         drawTo = prevDrawTo;
@@ -446,6 +476,69 @@ void CImage::setupPasses () {
     }
 }
 
+void CImage::warmEffect (const ImageEffect& effect) {
+    static const ImageEffectPassOverride none = {};
+    auto curOverride = effect.passOverrides.begin ();
+    const auto endOverride = effect.passOverrides.end ();
+
+    // overrides go in the same order setup () gives them to the passes
+    for (const auto& cur : effect.effect->passes) {
+        if (!cur->material.has_value ())
+            continue;
+
+        const ImageEffectPassOverride& override = curOverride != endOverride ? **curOverride : none;
+
+        for (const auto& pass : cur->material.value ()->passes) {
+            try {
+                CPass::warm (*this, *pass, override);
+            } catch (std::runtime_error&) {
+                // not an issue until the effect is shown, it will fail there too
+            }
+        }
+
+        if (curOverride != endOverride)
+            ++curOverride;
+    }
+}
+
+void CImage::prepareShaders () {
+    if (!this->m_initialized)
+        return;
+
+    try {
+        for (const auto& pass : this->m_passes)
+            pass->prepareShaders ();
+    } catch (std::runtime_error&) {
+        // this error message is already printed, so just show extra info about it
+        sLog.error ("Cannot setup image ", this->getImage ().name);
+        this->m_initialized = false;
+    }
+}
+
+void CImage::setupShaders () {
+    if (!this->m_initialized)
+        return;
+
+    for (const auto& pass : this->m_passes)
+        pass->setupShaders ();
+}
+
+void CImage::setupPrograms () {
+    // images that failed to setup have nothing to link
+    if (!this->m_initialized)
+        return;
+
+    // until every pass has its program the image can't be drawn
+    this->m_initialized = false;
+
+    for (const auto& pass : this->m_passes) {
+        pass->setupProgram ();
+        pass->setupDependencies ();
+    }
+
+    this->m_initialized = true;
+}
+
 void CImage::pinpongFramebuffer (std::shared_ptr<const CFBO>* drawTo, std::shared_ptr<const TextureProvider>* asInput) {
     // temporarily store FBOs used
     std::shared_ptr<const CFBO> currentMainFBO = this->m_currentMainFBO;
@@ -461,6 +554,79 @@ void CImage::pinpongFramebuffer (std::shared_ptr<const CFBO>* drawTo, std::share
     this->m_currentSubFBO = currentMainFBO;
 }
 
+void CImage::removePass (const Effects::CPass* pass) {
+    const auto it = std::ranges::find (this->m_passes, pass);
+
+    if (it == this->m_passes.end ())
+        return;
+
+    delete *it;
+    this->m_passes.erase (it);
+}
+
+void CImage::setCacheable (const bool cacheable) {
+    this->m_cacheable = cacheable;
+    this->m_cacheValid = false;
+}
+
+bool CImage::isCacheable () const {
+    return this->m_cacheable;
+}
+
+bool CImage::isTransparent () const {
+    if (this->m_passes.empty () || this->getImage ().alpha->value->getFloat () > 0.0f)
+        return false;
+
+    // only blending by the alpha hides it, the other modes still write its colors
+    const BlendingMode blending = this->m_passes.back ()->getBlendingMode ();
+
+    return blending == BlendingMode_Translucent || blending == BlendingMode_Additive;
+}
+
+void CImage::setCullable (const bool cullable) {
+    this->m_cullable = cullable;
+}
+
+void CImage::setOccluded (const bool occluded) {
+    this->m_occluded = occluded;
+}
+
+bool CImage::isOccluded () const {
+    return this->m_cullable && this->m_occluded;
+}
+
+bool CImage::isBatchable () const {
+    return this->m_initialized && this->m_passes.size () == 1 &&
+           this->m_passes.front ()->getDestination () == this->getScene ().getFBO ();
+}
+
+bool CImage::updateChanges () {
+    if (!this->m_initialized)
+        return false;
+
+    // the displacement itself is in the scene's frame block, only the camera or the parallax settings changing
+    // has to touch what the passes use
+    this->updateScreenSpacePosition ();
+    this->updateParallaxDepth ();
+
+    const auto& sceneFBO = this->getScene ().getFBO ();
+    bool changed = false;
+
+    this->m_offscreenChanged = false;
+
+    // every pass has to take its snapshot, so no early exit here
+    for (const auto& pass : this->m_passes) {
+        const bool passChanged = pass->haveInputsChanged ();
+
+        changed = passChanged || changed;
+
+        if (pass->getDestination () != sceneFBO)
+            this->m_offscreenChanged = passChanged || this->m_offscreenChanged;
+    }
+
+    return changed;
+}
+
 void CImage::render () {
     // do not try to render something that did not initialize successfully
     // non-visible materials do need to be rendered
@@ -468,14 +634,14 @@ void CImage::render () {
         return;
     }
 
-    glColorMask (true, true, true, true);
-
-    // update the position if required
-    // TODO: There's more images that are not affected by parallax, autosize or fullscreen are not affected
-    if (this->getScene ().getScene ().camera.parallax.enabled && !this->getImage ().model->fullscreen) {
-        this->updateScreenSpacePosition ();
+    // effects of a layer out of view (like a sprite panning in) or under an opaque one are not worth running
+    if (this->isOccluded () || (this->m_cullable && this->isOutOfView ())) {
+        this->m_cacheValid = false;
+        return;
     }
 
+    glColorMask (true, true, true, true);
+
 #if !NDEBUG
     std::string str = "Rendering ";
 
@@ -489,9 +655,22 @@ void CImage::render () {
     glPushDebugGroup (GL_DEBUG_SOURCE_APPLICATION, 0, -1, str.c_str ());
 #endif /* DEBUG */
 
+    const auto& sceneFBO = this->getScene ().getFBO ();
+    bool renderCached = true;
+
+    // static layers only draw their result on the scene again unless something the other passes use changed
+    if (this->m_cacheable) {
+        renderCached = !this->m_cacheValid || this->m_offscreenChanged;
+        this->m_cacheValid = true;
+    }
+
     auto cur = this->m_passes.begin ();
 
     for (const auto end = this->m_passes.end (); cur != end; ++cur) {
+        if (!renderCached && (*cur)->getDestination () != sceneFBO) {
+            continue;
+        }
+
         if (std::next (cur) == end) {
             glColorMask (true, true, true, false);
         }
@@ -505,22 +684,126 @@ void CImage::render () {
 }
 
 void CImage::updateScreenSpacePosition () {
+    const auto& camera = this->getScene ().getCamera ();
+
+    // parallax is applied by the vertex shader, the matrix only follows the camera
+    if (this->m_screenSpaceCameraVersion == camera.getVersion ())
+        return;
+
+    this->m_screenSpaceCameraVersion = camera.getVersion ();
+    this->m_modelViewProjectionScreen = camera.getViewProjection ();
+    this->m_modelViewProjectionScreenInverse = glm::inverse (this->m_modelViewProjectionScreen);
+    this->updateOutputPosition ();
+}
+
+void CImage::updateOutputPosition () {
+    if (this->m_directOutput == nullptr)
+        return;
+
+    this->m_modelViewProjectionOutput = this->m_directOutput->transform * this->m_modelViewProjectionScreen;
+    this->m_modelViewProjectionOutputInverse = glm::inverse (this->m_modelViewProjectionOutput);
+}
+
+bool CImage::coversScene () const {
+    if (!this->m_initialized || this->m_passes.empty () || !this->getImage ().visible->value->getBool ())
+        return false;
+
+    const Effects::CPass& pass = *this->m_passes.back ();
+
+    // whatever is under it has to be overwritten, and flipping it for the output can't change what gets culled
+    if (pass.getDestination () != this->getScene ().getFBO () || !pass.overwritesDestination () ||
+        pass.getPass ().depthtest == DepthtestMode_Enabled || pass.getPass ().cullmode == CullingMode_Normal ||
+        this->m_parallaxDepth != glm::vec2 (0.0f))
+        return false;
+
+    glm::vec2 low;
+    glm::vec2 high;
+
+    // the quad's corners on screen have to reach past every edge
+    this->getScreenBounds (low, high);
+
+    return low.x <= -1.0f && low.y <= -1.0f && high.x >= 1.0f && high.y >= 1.0f;
+}
+
+bool CImage::hidesScene () const {
+    if (!this->coversScene ())
+        return false;
+
+    const auto& sceneFBO = this->getScene ().getFBO ();
+
+    // effects like refraction sample the layers under them through the scene's framebuffer
+    for (const auto& pass : this->m_passes)
+        for (const auto& fbo : pass->getSampledFBOs ())
+            if (fbo == sceneFBO)
+                return false;
+
+    return true;
+}
+
+void CImage::getScreenBounds (glm::vec2& low, glm::vec2& high) const {
+    // the same displacement the vertex shader adds, zero for images parallax doesn't move
+    const glm::vec2 parallax = this->m_parallaxDepth * *this->getScene ().getParallaxDisplacement ();
+
+    low = glm::vec2 (std::numeric_limits<float>::max ());
+    high = glm::vec2 (std::numeric_limits<float>::lowest ());
+
+    for (const float x : {this->m_pos.x, this->m_pos.z}) {
+        for (const float y : {this->m_pos.y, this->m_pos.w}) {
+            const glm::vec4 corner =
+                this->m_modelViewProjectionScreen * glm::vec4 (x + parallax.x, y + parallax.y, 0.0f, 1.0f);
+            const glm::vec2 position = glm::vec2 (corner) / corner.w;
+
+            low = glm::min (low, position);
+            high = glm::max (high, position);
+        }
+    }
+}
+
+bool CImage::isOutOfView () const {
+    glm::vec2 low;
+    glm::vec2 high;
+
+    this->getScreenBounds (low, high);
+
+    return low.x >= 1.0f || low.y >= 1.0f || high.x <= -1.0f || high.y <= -1.0f;
+}
+
+void CImage::setDirectOutput (const DirectOutput* output) {
+    this->m_directOutput = output;
+    this->updateOutputPosition ();
+
+    if (this->m_passes.empty () || this->m_passes.back ()->getDestination () != this->getScene ().getFBO ())
+        return;
+
+    Effects::CPass* pass = this->m_passes.back ();
+
+    pass->setDirectOutput (output);
+
+    if (output != nullptr) {
+        pass->setModelViewProjectionMatrix (&this->m_modelViewProjectionOutput);
+        pass->setModelViewProjectionMatrixInverse (&this->m_modelViewProjectionOutputInverse);
+    } else {
+        pass->setModelViewProjectionMatrix (&this->m_modelViewProjectionScreen);
+        pass->setModelViewProjectionMatrixInverse (&this->m_modelViewProjectionScreenInverse);
+    }
+}
+
+void CImage::updateParallaxDepth () {
+    const auto& parallax = this->getScene ().getScene ().camera.parallax;
+
+    // TODO: There's more images that are not affected by parallax, autosize or fullscreen are not affected
     // do not perform any changes to the image based on the parallax if it was explicitly disabled
-    if (this->getScene ().getContext ().getApp ().getContext ().settings.mouse.disableparallax) {
+    if (!parallax.enabled->value->getBool () || this->getImage ().model->fullscreen ||
+        this->getScene ().getContext ().getApp ().getContext ().settings.mouse.disableparallax) {
+        this->m_parallaxDepth = {0.0f, 0.0f};
         return;
     }
 
-    const double parallaxAmount = this->getScene ().getScene ().camera.parallax.amount->value->getFloat ();
+    const float amount = parallax.amount->value->getFloat ();
     const glm::vec2 depth = this->getImage ().parallaxDepth;
-    const glm::vec2* displacement = this->getScene ().getParallaxDisplacement ();
-
-    float x = (depth.x + parallaxAmount) * displacement->x * this->getSize ().x;
-    float y = (depth.y + parallaxAmount) * displacement->y * this->getSize ().x;
 
-    this->m_modelViewProjectionScreen = glm::translate (
-        this->getScene ().getCamera ().getProjection () * this->getScene ().getCamera ().getLookAt (),
-        {x, y, 0.0f}
-    );
+    // both axes are scaled by the width of the image
+    this->m_parallaxDepth = (depth + amount) * this->getSize ().x;
 }
 
 std::shared_ptr<const TextureProvider> CImage::getTexture () const {
@@ -543,30 +826,40 @@ const Effects::CMaterial* CImage::getMaterial () const {
     return this->m_material;
 }
 
+const std::vector<Effects::CPass*>& CImage::getPasses () const {
+    return this->m_passes;
+}
+
 glm::vec2 CImage::getSize () const {
     if (this->m_texture == nullptr) {
         return this->getImage ().size;
     }
 
-    return {this->m_texture->getRealWidth (), this->m_texture->getRealHeight ()};
+    const glm::vec2 size = {this->m_texture->getRealWidth (), this->m_texture->getRealHeight ()};
+
+    // the image is laid out in scene units whatever size the scene renders at
+    if (this->m_sceneTexture)
+        return size / this->getScene ().getRenderScale ();
+
+    return size;
 }
 
-GLuint CImage::getSceneSpacePosition () const {
+GLintptr CImage::getSceneSpacePosition () const {
     return this->m_sceneSpacePosition;
 }
 
-GLuint CImage::getCopySpacePosition () const {
+GLintptr CImage::getCopySpacePosition () const {
     return this->m_copySpacePosition;
 }
 
-GLuint CImage::getPassSpacePosition () const {
+GLintptr CImage::getPassSpacePosition () const {
     return this->m_passSpacePosition;
 }
 
-GLuint CImage::getTexCoordCopy () const {
+GLintptr CImage::getTexCoordCopy () const {
     return this->m_texcoordCopy;
 }
 
-GLuint CImage::getTexCoordPass () const {
+GLintptr CImage::getTexCoordPass () const {
     return this->m_texcoordPass;
 }
@@ -26,20 +26,34 @@ class CImage final : public CObject, public FBOProvider {
 
   public:
     CImage (Wallpapers::CScene& scene, const Image& image);
+    ~CImage () override;
 
     void setup ();
+    /**
+     * Preprocesses the shaders of the passes created by setup (), doesn't touch GL so it can run on any thread
+     */
+    void prepareShaders ();
+    /**
+     * Hands the prepared shaders to the ProgramCache so they're translated in the background
+     */
+    void setupShaders ();
+    /**
+     * Finishes the passes created by setup () once their shaders are translated, throws if one can't be built
+     */
+    void setupPrograms ();
     void render () override;
 
     [[nodiscard]] const Image& getImage () const;
     [[nodiscard]] const std::vector<CEffect*>& getEffects () const;
     [[nodiscard]] const Effects::CMaterial* getMaterial () const;
+    [[nodiscard]] const std::vector<Effects::CPass*>& getPasses () const;
     [[nodiscard]] glm::vec2 getSize () const;
 
-    [[nodiscard]] GLuint getSceneSpacePosition () const;
-    [[nodiscard]] GLuint getCopySpacePosition () const;
-    [[nodiscard]] GLuint getPassSpacePosition () const;
-    [[nodiscard]] GLuint getTexCoordCopy () const;
-    [[nodiscard]] GLuint getTexCoordPass () const;
+    [[nodiscard]] GLintptr getSceneSpacePosition () const;
+    [[nodiscard]] GLintptr getCopySpacePosition () const;
+    [[nodiscard]] GLintptr getPassSpacePosition () const;
+    [[nodiscard]] GLintptr getTexCoordCopy () const;
+    [[nodiscard]] GLintptr getTexCoordPass () const;
     [[nodiscard]] std::shared_ptr<const TextureProvider> getTexture () const;
     [[nodiscard]] double getAnimationTime () const;
 
@@ -51,18 +65,114 @@ class CImage final : public CObject, public FBOProvider {
      */
     void pinpongFramebuffer (std::shared_ptr<const CFBO>* drawTo, std::shared_ptr<const TextureProvider>* asInput);
 
+    /**
+     * Stops rendering the given pass, used to drop passes whose output is never read
+     *
+     * @param pass
+     */
+    void removePass (const Effects::CPass* pass);
+
+    /**
+     * Lets the image keep the result of the passes that don't draw on the scene between frames,
+     * only rendering them again when one of their inputs changes.
+     * Only safe when nothing outside of the image writes what those passes sample
+     *
+     * @param cacheable
+     */
+    void setCacheable (bool cacheable);
+    [[nodiscard]] bool isCacheable () const;
+
+    /**
+     * Lets the image skip all of its passes while what it draws on the scene is out of view.
+     * Only safe when nothing outside of the image reads the framebuffers it writes
+     *
+     * @param cullable
+     */
+    void setCullable (bool cullable);
+    /**
+     * @param occluded If a layer drawn later hides every pixel this one draws on the scene, only taken into account
+     * when the image is cullable
+     */
+    void setOccluded (bool occluded);
+    /**
+     * @return If the image is hidden under another one and nothing else reads what it draws, so it can be skipped
+     */
+    [[nodiscard]] bool isOccluded () const;
+
+    /**
+     * @return If the image draws straight on the scene with a single pass, so its draw can share the setup of
+     * compatible neighbours
+     */
+    [[nodiscard]] bool isBatchable () const;
+
+    /**
+     * Compares the inputs of every pass against the ones they had on the previous frame,
+     * has to be called once per frame before render ()
+     *
+     * @return If rendering now would give a different result than the last time
+     */
+    bool updateChanges ();
+
+    /**
+     * @return If the image's last pass hides everything under it on every pixel of the scene, so it can be drawn
+     * to the output directly
+     */
+    [[nodiscard]] bool coversScene () const;
+    /**
+     * @return If the image covers the scene without reading what's under it, so the layers below can't be seen at all
+     */
+    [[nodiscard]] bool hidesScene () const;
+    /**
+     * Makes the last pass draw to the given output instead of the scene, in the output's space
+     *
+     * @param output Has to outlive the image or be replaced, nullptr to draw on the scene again
+     */
+    void setDirectOutput (const DirectOutput* output);
+
   protected:
     void setupPasses ();
 
+    /**
+     * Follows the camera with the matrix the last pass draws on the scene with, nothing to do most frames
+     */
     void updateScreenSpacePosition ();
+    /**
+     * Works out how far the scene's parallax displacement moves the image, the vertex shader applies it
+     */
+    void updateParallaxDepth ();
+    /**
+     * Moves the screen matrix to the output's space, if the image draws there
+     */
+    void updateOutputPosition ();
+    /**
+     * Works out the rectangle the last pass' quad takes on the scene, in clip space, parallax included
+     */
+    void getScreenBounds (glm::vec2& low, glm::vec2& high) const;
+    /**
+     * @return If the quad drawn on the scene doesn't touch any of its pixels
+     */
+    [[nodiscard]] bool isOutOfView () const;
+    /**
+     * @return If the image's alpha is zero and the last pass blends with it, so nothing it draws shows up
+     */
+    [[nodiscard]] bool isTransparent () const;
+    /**
+     * Gives the shaders of an effect that is not shown to the ProgramCache's warm-up
+     *
+     * @param effect
+     */
+    void warmEffect (const ImageEffect& effect);
 
   private:
     std::shared_ptr<const TextureProvider> m_texture = nullptr;
-    GLuint m_sceneSpacePosition;
-    GLuint m_copySpacePosition;
-    GLuint m_passSpacePosition;
-    GLuint m_texcoordCopy;
-    GLuint m_texcoordPass;
+    /** the texture is one of the scene's framebuffers, so it's sized by the scene's render scale */
+    bool m_sceneTexture = false;
+    /** offsets of the image's quads in the scene's GeometryArena */
+    GLintptr m_sceneSpacePosition;
+    GLintptr m_copySpacePosition;
+    GLintptr m_passSpacePosition;
+    GLintptr m_texcoordCopy;
+    GLintptr m_texcoordPass;
 
     glm::mat4 m_modelViewProjectionScreen = {};
     glm::mat4 m_modelViewProjectionPass = {};
@@ -70,9 +180,19 @@ class CImage final : public CObject, public FBOProvider {
     glm::mat4 m_modelViewProjectionScreenInverse = {};
     glm::mat4 m_modelViewProjectionPassInverse = {};
     glm::mat4 m_modelViewProjectionCopyInverse = {};
+    glm::mat4 m_modelViewProjectionOutput = {};
+    glm::mat4 m_modelViewProjectionOutputInverse = {};
+    /** where the last pass draws instead of the scene, nullptr if it draws on the scene */
+    const DirectOutput* m_directOutput = nullptr;
 
     glm::mat4 m_modelMatrix = {};
     glm::mat4 m_viewProjectionMatrix = {};
+    /** camera version m_modelViewProjectionScreen was last built for */
+    uint32_t m_screenSpaceCameraVersion = 0;
+    /** what the scene's parallax displacement is scaled by for this image, zero if it doesn't move */
+    glm::vec2 m_parallaxDepth = {0.0f, 0.0f};
+    /** deregister the listeners on the properties that decide which passes the image has */
+    std::vector<std::function<void ()>> m_structureListeners = {};
 
     std::shared_ptr<const CFBO> m_mainFBO = nullptr;
     std::shared_ptr<const CFBO> m_subFBO = nullptr;
@@ -92,6 +212,15 @@ class CImage final : public CObject, public FBOProvider {
     double m_animationTime = 0.0;
 
     bool m_initialized = false;
+    bool m_cacheable = false;
+    bool m_cullable = false;
+    bool m_occluded = false;
+    /** isTransparent () when the passes were set up, the last one doesn't draw on the scene then */
+    bool m_transparent = false;
+    /** set once the cached passes rendered at least once */
+    bool m_cacheValid = false;
+    /** an input of the passes that don't draw on the scene changed since the last frame */
+    bool m_offscreenChanged = true;
 
     struct {
         struct {
@@ -1,9 +1,12 @@
 #include "CParticle.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
 #include "WallpaperEngine/Logging/Log.h"
 #include "WallpaperEngine/Data/Model/Property.h"
-#include "WallpaperEngine/Render/Utils/NoiseUtils.h"
+#include "WallpaperEngine/Render/Utils/CurlNoiseField.h"
+#include "WallpaperEngine/Render/SamplerCache.h"
 
 #include <GL/glew.h>
+#include <glm/common.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/constants.hpp>
 #include <algorithm>
@@ -11,6 +14,8 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <string>
+#include <optional>
+#include <random>
 
 extern float g_Time;
 
@@ -19,46 +24,175 @@ using namespace WallpaperEngine::Render::Utils;
 using namespace WallpaperEngine::Data::Model;
 
 namespace {
-    // Helper: Random float in range
-    inline float randomFloat (std::mt19937& rng, float min, float max) {
-        if (max < min) std::swap (min, max);
-        std::uniform_real_distribution<float> dist (min, max);
-        return dist (rng);
-    }
-
-    // Helper: Random vec3 in range
-    inline glm::vec3 randomVec3 (std::mt19937& rng, const glm::vec3& min, const glm::vec3& max) {
-        return glm::vec3 (
-            randomFloat (rng, min.x, max.x),
-            randomFloat (rng, min.y, max.y),
-            randomFloat (rng, min.z, max.z)
-        );
-    }
+    // Per-instance format: pos(3) + rotation(3) + size(1) + color(4) + frame(1) = 12 floats, trails have their
+    // velocity instead of the rotation
+    constexpr int PARTICLE_INSTANCE_FLOATS = 12;
 
-    // Helper: Linear interpolation
-    inline float lerp (float t, float a, float b) {
-        return a + t * (b - a);
-    }
+    // Sprite corners are within sqrt(2) half sizes of the particle, the rest is slack so culling never shows
+    constexpr float CULL_MARGIN = 2.0f;
+
+    // Shared by the CPU and GPU vertex paths
+    constexpr const char* PARTICLE_FRAGMENT_SHADER = R"(
+        #version 330 core
+        in vec2 vTexCoord;
+        in vec4 vColor;
+        in float vFrame;
+
+        out vec4 FragColor;
+
+        uniform sampler2D g_Texture0;
+        uniform int u_HasTexture;
+        uniform int u_TextureFormat; // 8 = RG88, 9 = R8
+        uniform vec2 u_SpritesheetSize; // x=cols, y=rows
+        uniform float u_Overbright; // Brightness multiplier for additive particles
+
+        void main() {
+            vec4 texColor;
+            if (u_HasTexture == 1) {
+                // Calculate UV coordinates for spritesheet frame
+                vec2 uv = vTexCoord;
+                if (u_SpritesheetSize.x > 0.0) {
+                    // Spritesheet: adjust UVs to sample only the current frame
+                    float cols = u_SpritesheetSize.x;
+                    float rows = u_SpritesheetSize.y;
+                    float frameIndex = floor(vFrame);
+
+                    float frameX = mod(frameIndex, cols);
+                    float frameY = floor(frameIndex / cols);
+
+                    float frameWidth = 1.0 / cols;
+                    float frameHeight = 1.0 / rows;
 
-    // Helper: Fade value change over lifetime
-    inline float fadeValue (float life, float startTime, float endTime, float startValue, float endValue) {
-        if (life <= startTime)
-            return startValue;
-        else if (life >= endTime)
-            return endValue;
-        else {
-            float t = (life - startTime) / (endTime - startTime);
-            return lerp (t, startValue, endValue);
+                    // Calculate UV coordinates for the current frame
+                    uv = vec2(
+                        frameX * frameWidth + vTexCoord.x * frameWidth,
+                        frameY * frameHeight + vTexCoord.y * frameHeight
+                    );
+                }
+
+                // Sample texture
+                vec4 sample = texture(g_Texture0, uv);
+
+                // Convert texture format like common_fragment.h does
+                if (u_TextureFormat == 8) {
+                    // RG88: R channel is color (grayscale), G channel is alpha
+                    texColor = vec4(sample.rrr, sample.g);
+                } else if (u_TextureFormat == 9) {
+                    // R8: R channel is alpha, white color
+                    texColor = vec4(1.0, 1.0, 1.0, sample.r);
+                } else {
+                    // Normal RGBA
+                    texColor = sample;
+                }
+            } else {
+                // No texture - create circular particle fallback
+                vec2 coord = vTexCoord - vec2(0.5);
+                float dist = length(coord) * 2.0;
+                if (dist > 1.0) discard;
+                float alpha = 1.0 - dist;
+                texColor = vec4(1.0, 1.0, 1.0, alpha);
+            }
+
+            // Apply vertex color and texture
+            vec4 finalColor = vColor * texColor;
+
+            // Apply overbright multiplier to RGB channels (controls brightness for additive particles)
+            finalColor.rgb *= u_Overbright;
+
+            FragColor = finalColor;
         }
-    }
+    )";
+
+    // GPU simulation path: the state records are drawn as points and expanded into quads by the geometry shader
+    constexpr const char* GPU_PARTICLE_VERTEX_SHADER = R"(
+        out vec3 vRotation;
+        out float vSize;
+        out vec4 vParticleColor;
+        out float vParticleFrame;
+
+        void main() {
+            gl_Position = vec4(aPosition, 1.0);
+            vRotation = aRotation;
+            // Particle size is already scaled by instance override, don't apply object scale
+            vSize = aSize / 2.0;
+            vParticleColor = vec4(aColor, aAlpha);
+            vParticleFrame = aFrame;
+        }
+    )";
+
+    constexpr const char* GPU_PARTICLE_GEOMETRY_SHADER = R"(
+        #version 330 core
+        layout (points) in;
+        layout (triangle_strip, max_vertices = 4) out;
+
+        in vec3 vRotation[];
+        in float vSize[];
+        in vec4 vParticleColor[];
+        in float vParticleFrame[];
+
+        out vec2 vTexCoord;
+        out vec4 vColor;
+        out float vFrame;
+
+        uniform mat4 g_ModelViewProjectionMatrix;
+
+        vec3 rotate(vec3 v, vec3 angles) {
+            vec3 c = cos(angles);
+            vec3 s = sin(angles);
+
+            vec3 rotX = vec3(v.x, v.y * c.x - v.z * s.x, v.y * s.x + v.z * c.x);
+            vec3 rotY = vec3(rotX.x * c.y + rotX.z * s.y, rotX.y, -rotX.x * s.y + rotX.z * c.y);
+            return vec3(rotY.x * c.z - rotY.y * s.z, rotY.x * s.z + rotY.y * c.z, rotY.z);
+        }
+
+        void emitCorner(vec2 texCoord) {
+            vec3 offset = rotate(vec3(texCoord - 0.5, 0.0), vRotation[0]);
+
+            gl_Position = g_ModelViewProjectionMatrix * vec4(gl_in[0].gl_Position.xyz + offset * vSize[0], 1.0);
+            vTexCoord = texCoord;
+            vColor = vParticleColor[0];
+            vFrame = vParticleFrame[0];
+            EmitVertex();
+        }
+
+        void main() {
+            // Same filtering as the CPU path: skip invalid or extreme sizes
+            if (!(vSize[0] > 0.0 && vSize[0] <= 5000.0))
+                return;
+
+            emitCorner(vec2(0.0, 1.0));
+            emitCorner(vec2(1.0, 1.0));
+            emitCorner(vec2(0.0, 0.0));
+            emitCorner(vec2(1.0, 0.0));
+            EndPrimitive();
+        }
+    )";
 }
 
 CParticle::CParticle (Wallpapers::CScene& scene, const Particle& particle) :
     CObject (scene, particle),
     m_particle (particle) {
-    // Initialize random number generator with time-based seed
-    std::random_device rd;
-    m_rng.seed (rd ());
+    // The model matrix is cached, user properties changing the transform invalidate it
+    const auto invalidate = [this] (const DynamicValue&) { m_modelMatrixDirty = true; };
+
+    m_transformListeners.push_back (m_particle.scale->value->listen (invalidate));
+    m_transformListeners.push_back (m_particle.angles->value->listen (invalidate));
+
+    // Fixed seeds are per system so adding or removing one doesn't change how the others behave
+    const auto& seed = getContext ().getApp ().getContext ().settings.render.particleSeed;
+
+    if (seed.has_value ()) {
+        m_rng.seed (Particles::ParticleRandom::mix (*seed) ^ static_cast<uint64_t> (getId ()));
+    } else {
+        std::random_device rd;
+        m_rng.seed ((static_cast<uint64_t> (rd ()) << 32) | rd ());
+    }
+
+    const uint32_t rate = getContext ().getApp ().getContext ().settings.render.particleRate;
+
+    if (rate > 0) {
+        m_fixedStep = 1.0f / static_cast<float> (rate);
+    }
 
     // Read renderer configuration early to determine if trails are used
     if (!m_particle.renderers.empty ()) {
@@ -87,39 +221,59 @@ CParticle::CParticle (Wallpapers::CScene& scene, const Particle& particle) :
 
     // Use wallpaper's specified count, or default if maxCount is 0
     m_maxParticles = (adjustedMaxCount > 0) ? adjustedMaxCount : DEFAULT_MAX_PARTICLES;
-    m_particles.resize (m_maxParticles);
+    m_particles.reserve (m_maxParticles);
 
+    sLog.out ("Particle '", particle.name, "' max particles: ", m_maxParticles,
+              " (maxCount=", particle.maxCount, " * countMultiplier=", countMultiplier, ")");
+}
 
-    // Calculate buffer sizes
-    // Trail particles: (N+1) * 2 vertices for ribbon strip, N * 6 indices for N quads
-    // Normal particles: 4 vertices, 6 indices
-    const int segmentsPerParticle = m_useTrailRenderer ? m_trailSubdivision : 1;
-    const int verticesPerParticle = m_useTrailRenderer ? (segmentsPerParticle + 1) * 2 : 4;
-    const int indicesPerParticle = m_useTrailRenderer ? segmentsPerParticle * 6 : 6;
+CParticle::CParticle (CParticle& parent, const ParticleChild& child) :
+    CParticle (parent.getScene (), *child.definition) {
+    m_parent = &parent;
+    m_child = &child;
+
+    if (child.type == "eventspawn") {
+        m_childType = ChildType::EventSpawn;
+    } else if (child.type == "eventdeath") {
+        m_childType = ChildType::EventDeath;
+    } else if (child.type == "eventfollow") {
+        m_childType = ChildType::EventFollow;
+    } else {
+        m_childType = ChildType::Static;
+    }
 
-    m_vertices.resize (m_maxParticles * verticesPerParticle * 17);
-    m_indices.resize (m_maxParticles * indicesPerParticle);
+    // Same screen space (Y down) to centered space (Y up) conversion as the emitter origins
+    glm::vec3 origin = child.origin;
+    origin.y = -origin.y;
 
-    sLog.out ("Particle '", particle.name, "' max particles: ", m_maxParticles,
-              " (maxCount=", particle.maxCount, " * countMultiplier=", countMultiplier, ")");
+    m_childTransform = glm::translate (glm::mat4 (1.0f), origin);
+    m_childTransform = glm::rotate (m_childTransform, glm::radians (child.angles.z), glm::vec3 (0, 0, 1));
+    m_childTransform = glm::rotate (m_childTransform, glm::radians (child.angles.y), glm::vec3 (0, 1, 0));
+    m_childTransform = glm::rotate (m_childTransform, glm::radians (child.angles.x), glm::vec3 (1, 0, 0));
+    m_childTransform = glm::scale (m_childTransform, child.scale);
+    m_childInverse = glm::inverse (m_childTransform);
+
+    // Derive the seed from the parent so fixed seeds stay reproducible
+    m_rng.seed ((static_cast<uint64_t> (parent.m_rng.next ()) << 32) | parent.m_rng.next ());
 }
 
 CParticle::~CParticle () {
+    for (const auto& deregister : m_transformListeners) {
+        deregister ();
+    }
+
     if (m_vao != 0) {
         glDeleteVertexArrays (1, &m_vao);
     }
-    if (m_vbo != 0) {
-        glDeleteBuffers (1, &m_vbo);
-    }
     if (m_ebo != 0) {
         glDeleteBuffers (1, &m_ebo);
     }
+    if (m_quadVbo != 0) {
+        glDeleteBuffers (1, &m_quadVbo);
+    }
     if (m_shaderProgram != 0) {
         glDeleteProgram (m_shaderProgram);
     }
-
-    m_vertices.clear();
-    m_indices.clear();
 }
 
 void CParticle::setup () {
@@ -136,12 +290,28 @@ void CParticle::setup () {
     origin.x -= m_lastScreenWidth / 2.0f;
     origin.y = m_lastScreenHeight / 2.0f - origin.y;
     m_transformedOrigin = origin;
+    m_modelMatrixDirty = true;
+
+    if (m_particle.animationMode == "randomframe") {
+        m_animationMode = AnimationMode::RandomFrame;
+    } else if (m_particle.animationMode == "once") {
+        m_animationMode = AnimationMode::Once;
+    } else {
+        // "loop" and "sequence" both loop
+        m_animationMode = AnimationMode::Loop;
+    }
+
+    // Apply sequence multiplier if present
+    m_animationSpeed = m_particle.sequenceMultiplier > 0.0f ? m_particle.sequenceMultiplier : 1.0f;
 
     // Load particle material texture and blending mode
     if (m_particle.material && m_particle.material->material && !m_particle.material->material->passes.empty ()) {
         auto& firstPass = *m_particle.material->material->passes.begin ();
 
         m_blendingMode = firstPass->blending;
+        // additive particles look the same in any order
+        m_depthSort = getContext ().getApp ().getContext ().settings.render.particleDepthSort &&
+                      m_blendingMode != Data::Model::BlendingMode_Additive;
 
         // Read overbright constant (brightness multiplier for additive particles)
         auto overbrightIt = firstPass->constants.find ("ui_editor_properties_overbright");
@@ -153,10 +323,10 @@ void CParticle::setup () {
         auto& textures = firstPass->textures;
         if (!textures.empty ()) {
             std::string textureName = textures.begin ()->second;
-            if (textureName.find ("_rt_") == 0 || textureName.find ("_alias_") == 0) {
-                m_texture = getScene ().findFBO (textureName);
+            if (const Symbol name (textureName); name.isRenderTarget ()) {
+                m_texture = getScene ().findFBO (name);
             } else {
-                m_texture = getContext ().resolveTexture (textureName);
+                m_texture = getContext ().resolveTexture (textureName, getScene ().getScene ().project);
             }
             if (m_texture) {
                 m_textureFormat = m_texture->getFormat ();
@@ -183,6 +353,8 @@ void CParticle::setup () {
     setupEmitters ();
     setupInitializers ();
     setupOperators ();
+    setupChildren ();
+    setupGPUSimulation ();
     setupBuffers ();
 
     // Setup control points (max 8)
@@ -199,37 +371,232 @@ void CParticle::setup () {
     m_initialized = true;
 }
 
-void CParticle::render () {
+void CParticle::beginFrame () {
+    m_mappedVertices = nullptr;
+
+    for (auto& child : m_children) {
+        child->beginFrame ();
+    }
+
+    // GPU simulated systems expand their state buffer into quads in the geometry shader
+    if (!m_initialized || m_gpuSimulator || m_shaderProgram == 0 || !m_vertexStream)
+        return;
+
+    // Only waits if the GPU is frames behind, prepare () then writes straight into the streaming buffer
+    m_mappedVertices = static_cast<float*> (m_vertexStream->map ());
+}
+
+void CParticle::prepare () {
+    m_prepared = true;
+    m_hasGeometry = false;
+    m_frameDt = 0.0f;
+
     if (!m_initialized || !m_particle.visible->value->getBool ())
         return;
 
     // Initialize time on first render to avoid huge dt spike
-    if (m_time == 0.0) {
+    if (m_lastFrameTime == 0.0) {
+        m_lastFrameTime = g_Time;
         m_time = g_Time;
         // Skip update on first frame to avoid weird initial burst
         // This ensures all particles start from a clean state
-        renderSprites ();
-        return;
+    } else {
+        // Update particles
+        float dt = g_Time - static_cast<float> (m_lastFrameTime);
+        m_lastFrameTime = g_Time;
+
+        if (dt > 0.0f) {
+            // Cap dt to prevent simulation instability
+            dt = std::min (dt, 0.1f);
+
+            if (m_fixedStep > 0.0f) {
+                // Fixed steps look the same at any FPS, the remainder is carried over and interpolated
+                m_accumulator += dt;
+
+                while (m_accumulator >= m_fixedStep) {
+                    m_accumulator -= m_fixedStep;
+                    m_frameDt += m_fixedStep;
+                    m_time += m_fixedStep;
+                    update (m_fixedStep);
+                }
+            } else {
+                m_frameDt = dt;
+                m_time += dt;
+                update (dt);
+            }
+        }
+    }
+
+    m_interpolation = m_fixedStep > 0.0f ? m_accumulator / m_fixedStep : 1.0f;
+
+    prepareGeometry ();
+}
+
+void CParticle::prepareGeometry () {
+    m_hasGeometry = false;
+    m_frameModelViewProjection = getScene ().getCamera ().getViewProjection () * getModelMatrix ();
+
+    if (m_gpuSimulator) {
+        m_hasGeometry = true;
+    } else if (m_mappedVertices && m_particles.getCount () > 0) {
+        m_hasGeometry = generateVertices (m_mappedVertices, m_vertexValues);
+    }
+
+    for (auto& child : m_children) {
+        child->m_interpolation = m_interpolation;
+        child->prepareGeometry ();
     }
+}
 
-    // Update particles
-    float dt = g_Time - static_cast<float> (m_time);
-    m_time = g_Time;
+void CParticle::render () {
+    // objects rendered outside the scene's particle pass prepare themselves
+    if (!m_prepared) {
+        beginFrame ();
+        prepare ();
+    }
+
+    m_prepared = false;
+
+    if (!m_initialized || !m_particle.visible->value->getBool ())
+        return;
 
-    if (dt > 0.0f) {
-        // Cap dt to prevent simulation instability
-        // Also provides more consistent behavior across different FPS
-        dt = std::min (dt, 0.1f);
-        update (dt);
+    // The GPU simulation has to be dispatched from the render thread
+    if (m_gpuSimulator && m_frameDt > 0.0f) {
+        m_gpuSimulator->simulate (getContext ().getRenderState (), m_particles, {m_controlPoints, static_cast<float> (m_time), m_frameDt});
     }
 
     // Render particles
-    if (m_particleCount > 0 && m_particle.material) {
+    if (m_hasGeometry && m_particle.material) {
         renderSprites ();
     }
+
+    renderChildren ();
+}
+
+void CParticle::renderChildren () {
+    for (auto& child : m_children) {
+        if (child->m_hasGeometry && child->m_particle.material) {
+            child->renderSprites ();
+        }
+
+        child->renderChildren ();
+    }
 }
 
 void CParticle::update (float dt) {
+    TRACE_SCOPE ("CParticle::update");
+
+    // Children get their control points from the parent
+    if (!m_parent) {
+        updateControlPoints ();
+    }
+
+    m_events.clear ();
+
+    const uint32_t maxParticles = std::max (1u, static_cast<uint32_t> (m_maxParticles * m_budgetScale));
+
+    if (m_gpuSimulator) {
+        // alive particles live on the GPU, only let the emitters fill the remaining room
+        m_particles.setLimit (maxParticles - std::min (m_gpuSimulator->getAliveEstimate (), maxParticles));
+
+        // the simulation itself is dispatched from render () as it needs the GL context
+        for (auto& emitter : m_emitters) {
+            emitter (m_particles, dt, false);
+        }
+
+        return;
+    }
+
+    m_particles.setLimit (maxParticles);
+
+    // Emit particles, event driven children only emit where their parent tells them to
+    if (!m_parent || m_childType == ChildType::Static) {
+        const uint32_t firstSpawned = m_particles.getCount ();
+
+        for (auto& emitter : m_emitters) {
+            emitter (m_particles, dt, false);
+        }
+
+        if (m_needsSpawnEvents) {
+            m_events.spawned.assign (
+                m_particles.position.begin () + firstSpawned, m_particles.position.begin () + m_particles.getCount ());
+        }
+    }
+
+    // Rendering blends from here to the result of this step
+    if (m_fixedStep > 0.0f) {
+        m_particles.storePreviousPositions ();
+    }
+
+    // Update particle age
+    float* age = m_particles.age.data ();
+    const uint32_t count = m_particles.getCount ();
+
+    for (uint32_t i = 0; i < count; i++) {
+        age [i] += dt;
+    }
+
+    // Apply operators to living particles (including alphafade)
+    m_operators.run (m_particles, {m_controlPoints, static_cast<float> (m_time), dt});
+
+    // Remove dead particles in one pass, then animate the survivors
+    m_particles.compact (m_needsDeathEvents ? &m_events.died : nullptr);
+    updateAnimationFrames ();
+
+    if (!m_children.empty ()) {
+        updateChildren (dt);
+    }
+}
+
+void CParticle::prewarm (float seconds) {
+    if (!canPrewarm () || seconds <= 0.0f)
+        return;
+
+    const float step = m_fixedStep > 0.0f ? m_fixedStep : PREWARM_STEP;
+    const auto steps = static_cast<uint32_t> (std::ceil (seconds / step));
+
+    for (uint32_t i = 0; i < steps; i++) {
+        m_time += step;
+        update (step);
+    }
+}
+
+bool CParticle::canPrewarm () const {
+    // GPU simulated particles live in GL buffers that can't be touched outside the render thread
+    return m_initialized && !m_gpuSimulator;
+}
+
+void CParticle::writeState (std::ostream& out) const {
+    m_particles.write (out);
+
+    for (const auto& child : m_children) {
+        child->writeState (out);
+    }
+}
+
+bool CParticle::readState (std::istream& in) {
+    bool restored = m_particles.read (in);
+
+    for (auto& child : m_children) {
+        restored = restored && child->readState (in);
+    }
+
+    if (!restored) {
+        clearState ();
+    }
+
+    return restored;
+}
+
+void CParticle::clearState () {
+    m_particles.clear ();
+
+    for (auto& child : m_children) {
+        child->clearState ();
+    }
+}
+
+void CParticle::updateControlPoints () {
     // Detect resolution changes and recalculate transformed origin
     float screenWidth = static_cast<float>(getScene().getWidth());
     float screenHeight = static_cast<float>(getScene().getHeight());
@@ -240,14 +607,19 @@ void CParticle::update (float dt) {
         origin.x -= screenWidth / 2.0f;
         origin.y = screenHeight / 2.0f - origin.y;
         m_transformedOrigin = origin;
+        m_modelMatrixDirty = true;
 
         m_lastScreenWidth = screenWidth;
         m_lastScreenHeight = screenHeight;
+        // Mouse linked control points are relative to the origin, force them to update
+        m_lastMousePosition.reset ();
     }
 
-    // Update control points with mouse position
+    // Update control points with mouse position, only when it actually moved
     const glm::vec2* mousePos = getScene().getMousePosition();
-    if (mousePos) {
+    if (mousePos && m_lastMousePosition != *mousePos) {
+        m_lastMousePosition = *mousePos;
+        m_controlPointsVersion++;
 
         for (auto& cp : m_controlPoints) {
             if (cp.linkMouse) {
@@ -267,68 +639,117 @@ void CParticle::update (float dt) {
             }
         }
     }
+}
 
-    // Emit particles
-    for (auto& emitter : m_emitters) {
-        emitter (m_particles, m_particleCount, dt);
+void CParticle::updateChildren (float dt) {
+    for (auto& child : m_children) {
+        child->m_time = m_time;
+
+        // Parent control points only change when the mouse or the parent moves
+        if (child->m_parentControlPointsVersion != m_controlPointsVersion) {
+            child->m_parentControlPointsVersion = m_controlPointsVersion;
+
+            for (size_t i = 0; i < child->m_controlPoints.size (); i++) {
+                const size_t source = i + static_cast<size_t> (std::max (child->m_child->controlPointStartIndex, 0));
+
+                if (source < m_controlPoints.size ()) {
+                    child->m_controlPoints [i].position =
+                        glm::vec3 (child->m_childInverse * glm::vec4 (m_controlPoints [source].position, 1.0f));
+                }
+            }
+        }
+
+        switch (child->m_childType) {
+            case ChildType::EventSpawn:
+                child->emitAt (m_events.spawned.data (), m_events.spawned.size (), dt, true);
+                break;
+            case ChildType::EventDeath:
+                child->emitAt (m_events.died.data (), m_events.died.size (), dt, true);
+                break;
+            case ChildType::EventFollow:
+                child->emitAt (m_particles.position.data (), m_particles.getCount (), dt, false);
+                break;
+            case ChildType::Static:
+                break;
+        }
+
+        child->update (dt);
     }
+}
 
-    // Update particle age
-    for (uint32_t i = 0; i < m_particleCount; i++) {
-        m_particles[i].age += dt;
+void CParticle::emitAt (const glm::vec3* positions, uint32_t count, float dt, bool burst) {
+    // maxcount caps how many instances of the child can be triggered at once
+    const uint32_t instances = std::min (count, static_cast<uint32_t> (std::max (m_child->maxCount, 0)));
+    uint32_t triggered = 0;
+
+    for (uint32_t e = 0; e < count && triggered < instances && !m_particles.isFull (); e++) {
+        if (burst && m_child->probability < 1.0f && m_rng.uniform () >= m_child->probability) {
+            continue;
+        }
+
+        triggered++;
+
+        const uint32_t first = m_particles.getCount ();
+
+        for (auto& emitter : m_emitters) {
+            emitter (m_particles, dt, burst);
+        }
+
+        const glm::vec3 offset = glm::vec3 (m_childInverse * glm::vec4 (positions [e], 1.0f));
+        const uint32_t last = m_particles.getCount ();
+
+        for (uint32_t i = first; i < last; i++) {
+            m_particles.position [i] += offset;
+        }
     }
+}
 
-    // Apply operators to living particles (including alphafade)
-    for (auto& op : m_operators) {
-        op (m_particles, m_particleCount, m_controlPoints, static_cast<float> (m_time), dt);
-    }
-
-    // Update animation frames and remove dead particles
-    for (uint32_t i = 0; i < m_particleCount; ) {
-        auto& p = m_particles [i];
-
-        // Update animation frame if we have a spritesheet
-        if (m_spritesheetFrames > 0) {
-            // Calculate frame based on particle lifetime
-            float lifetimePos = p.getLifetimePos();
-
-            // Apply sequence multiplier if present
-            float animSpeed = m_particle.sequenceMultiplier > 0.0f ? m_particle.sequenceMultiplier : 1.0f;
-
-            // Calculate frame based on animation mode
-            if (m_particle.animationMode == "randomframe") {
-                // Random frame mode: frame is set once at spawn and never changes
-                if (p.frame < 0.0f) {
-                    // Use particle memory address as seed for deterministic randomness per particle
-                    std::mt19937 particleRng(static_cast<std::mt19937::result_type>(reinterpret_cast<uintptr_t>(&p)));
-                    std::uniform_int_distribution<int> dist(0, m_spritesheetFrames - 1);
-                    p.frame = static_cast<float>(dist(particleRng));
-                }
-            } else if (m_particle.animationMode == "once") {
-                // Play animation once over particle lifetime
-                p.frame = std::min(lifetimePos * m_spritesheetFrames * animSpeed, static_cast<float>(m_spritesheetFrames - 1));
-            } else {
-                // Default to "loop" or "sequence" mode - loop animation based on duration
-                if (m_spritesheetDuration > 0.0f) {
-                    float timeInCycle = std::fmod(p.age * animSpeed, m_spritesheetDuration);
-                    float cyclePos = timeInCycle / m_spritesheetDuration;
-                    p.frame = std::fmod(cyclePos * m_spritesheetFrames, static_cast<float>(m_spritesheetFrames));
-                } else {
-                    // No duration, use lifetime-based for sequence mode
-                    p.frame = std::fmod(lifetimePos * m_spritesheetFrames * animSpeed, static_cast<float>(m_spritesheetFrames));
+void CParticle::updateAnimationFrames () {
+    if (m_spritesheetFrames <= 0)
+        return;
+
+    const uint32_t count = m_particles.getCount ();
+    const float frames = static_cast<float> (m_spritesheetFrames);
+    float* frame = m_particles.frame.data ();
+    const float* age = m_particles.age.data ();
+    const float* lifetime = m_particles.lifetime.data ();
+
+    switch (m_animationMode) {
+        case AnimationMode::RandomFrame:
+            // Random frame mode: frame is set once at spawn and never changes
+            for (uint32_t i = 0; i < count; i++) {
+                if (frame [i] < 0.0f) {
+                    frame [i] = static_cast<float> (m_rng.below (static_cast<uint32_t> (m_spritesheetFrames)));
                 }
             }
-        }
+            break;
 
-        if (!p.isAlive ()) {
-            // Swap with last particle and reduce count
-            if (i < m_particleCount - 1) {
-                p = m_particles [m_particleCount - 1];
+        case AnimationMode::Once:
+            // Play animation once over particle lifetime
+            for (uint32_t i = 0; i < count; i++) {
+                const float lifetimePos = lifetime [i] > 0.0f ? (age [i] / lifetime [i]) : 1.0f;
+
+                frame [i] = std::min (lifetimePos * frames * m_animationSpeed, frames - 1.0f);
             }
-            m_particleCount--;
-        } else {
-            i++;
-        }
+            break;
+
+        case AnimationMode::Loop:
+            if (m_spritesheetDuration > 0.0f) {
+                // Loop animation based on duration
+                for (uint32_t i = 0; i < count; i++) {
+                    const float cyclePos = std::fmod (age [i] * m_animationSpeed, m_spritesheetDuration) / m_spritesheetDuration;
+
+                    frame [i] = std::fmod (cyclePos * frames, frames);
+                }
+            } else {
+                // No duration, use lifetime-based for sequence mode
+                for (uint32_t i = 0; i < count; i++) {
+                    const float lifetimePos = lifetime [i] > 0.0f ? (age [i] / lifetime [i]) : 1.0f;
+
+                    frame [i] = std::fmod (lifetimePos * frames * m_animationSpeed, frames);
+                }
+            }
+            break;
     }
 }
 
@@ -336,6 +757,38 @@ const Particle& CParticle::getParticle () const {
     return m_particle;
 }
 
+uint32_t CParticle::getAliveCount () const {
+    uint32_t count = m_particles.getCount ();
+
+    if (m_gpuSimulator) {
+        count += m_gpuSimulator->getAliveEstimate ();
+    }
+
+    for (const auto& child : m_children) {
+        count += child->getAliveCount ();
+    }
+
+    return count;
+}
+
+void CParticle::getTextures (std::vector<std::shared_ptr<const TextureProvider>>& textures) const {
+    if (m_texture) {
+        textures.push_back (m_texture);
+    }
+
+    for (const auto& child : m_children) {
+        child->getTextures (textures);
+    }
+}
+
+void CParticle::setBudgetScale (float scale) {
+    m_budgetScale = scale;
+
+    for (auto& child : m_children) {
+        child->setBudgetScale (scale);
+    }
+}
+
 // ========== EMITTERS ==========
 
 void CParticle::setupEmitters () {
@@ -375,22 +828,28 @@ EmitterFunc CParticle::createBoxEmitter (const ParticleEmitter& emitter) {
         }
     }
 
-    return [this, emitter, transformedEmitterOrigin, controlPointIndex, rate, lifetime, emissionTimer = 0.0f, remaining = emitter.instantaneous](std::vector<ParticleInstance>& particles, uint32_t& count, float dt) mutable {
-        if (count >= particles.size ())
+    return [this, emitter, transformedEmitterOrigin, controlPointIndex, rate, lifetime, emissionTimer = 0.0f, remaining = emitter.instantaneous](ParticlePool& particles, float dt, bool burst) mutable {
+        if (particles.isFull ())
             return;
 
-        emissionTimer += dt * rate;
+        uint32_t toEmit;
 
-        uint32_t toEmit = static_cast<uint32_t> (emissionTimer);
-        emissionTimer -= static_cast<float> (toEmit);
+        if (burst) {
+            toEmit = std::max (emitter.instantaneous, 1u);
+        } else {
+            emissionTimer += dt * rate * m_budgetScale;
+
+            toEmit = static_cast<uint32_t> (emissionTimer);
+            emissionTimer -= static_cast<float> (toEmit);
 
-        if (remaining > 0) {
-            toEmit = remaining;
-            remaining = 0;
+            if (remaining > 0) {
+                toEmit = remaining;
+                remaining = 0;
+            }
         }
 
-        for (uint32_t i = 0; i < toEmit && count < particles.size (); i++) {
-            auto& p = particles [count];
+        for (uint32_t i = 0; i < toEmit && !particles.isFull (); i++) {
+            const uint32_t p = particles.spawn ();
 
             // Determine spawn origin (control point or emitter origin)
             glm::vec3 spawnOrigin = transformedEmitterOrigin;
@@ -399,44 +858,34 @@ EmitterFunc CParticle::createBoxEmitter (const ParticleEmitter& emitter) {
             }
 
             // Spawn at random position within box volume
-            glm::vec3 randomPos = randomVec3 (m_rng, emitter.distanceMin, emitter.distanceMax);
+            glm::vec3 randomPos = m_rng.range (emitter.distanceMin, emitter.distanceMax);
             // Flip Y to convert random offset from screen space to centered space
             randomPos.y = -randomPos.y;
-            p.position = spawnOrigin + randomPos;
+            particles.position [p] = spawnOrigin + randomPos;
 
             // Velocity based on position direction and emitter settings
             glm::vec3 direction = glm::length (randomPos) > 0.0f ? glm::normalize (randomPos) : glm::vec3 (0, 1, 0);
             direction = direction * emitter.directions;
 
-            float speed = randomFloat (m_rng, emitter.speedMin, emitter.speedMax);
-            p.velocity = direction * speed;
-
-            p.acceleration = glm::vec3 (0.0f);
-            p.rotation = glm::vec3 (0.0f);
-            p.angularVelocity = glm::vec3 (0.0f);
-            p.angularAcceleration = glm::vec3 (0.0f);
+            float speed = m_rng.range (emitter.speedMin, emitter.speedMax);
+            particles.velocity [p] = direction * speed;
 
             // Default properties (will be overridden by initializers)
-            p.color = glm::vec3 (1.0f) * m_particle.instanceOverride.colorn->value->getVec3 ();
-            p.alpha = 1.0f * m_particle.instanceOverride.alpha->value->getFloat ();
-            p.size = 20.0f * m_particle.instanceOverride.size->value->getFloat ();
-            p.lifetime = lifetime;
-            p.age = 0.0f;
-            p.alive = true;
-            p.frame = -1.0f;
+            particles.color [p] = glm::vec3 (1.0f) * m_particle.instanceOverride.colorn->value->getVec3 ();
+            particles.alpha [p] = 1.0f * m_particle.instanceOverride.alpha->value->getFloat ();
+            particles.size [p] = 20.0f * m_particle.instanceOverride.size->value->getFloat ();
+            particles.lifetime [p] = lifetime;
 
             // Store initial values
-            p.initial.color = p.color;
-            p.initial.alpha = p.alpha;
-            p.initial.size = p.size;
-            p.initial.lifetime = p.lifetime;
+            particles.initialColor [p] = particles.color [p];
+            particles.initialAlpha [p] = particles.alpha [p];
+            particles.initialSize [p] = particles.size [p];
+            particles.initialLifetime [p] = particles.lifetime [p];
 
             // Apply initializers
             for (auto& init : m_initializers) {
-                init (p);
+                init (particles, p);
             }
-
-            count++;
         }
     };
 }
@@ -462,22 +911,28 @@ EmitterFunc CParticle::createSphereEmitter (const ParticleEmitter& emitter) {
     // Capture scale for debug logging only
     glm::vec3 scale = m_particle.scale->value->getVec3();
 
-    return [this, emitter, transformedEmitterOrigin, scale, controlPointIndex, rate, lifetime, emissionTimer = 0.0f, remaining = emitter.instantaneous](std::vector<ParticleInstance>& particles, uint32_t& count, float dt) mutable {
-        if (count >= particles.size ())
+    return [this, emitter, transformedEmitterOrigin, scale, controlPointIndex, rate, lifetime, emissionTimer = 0.0f, remaining = emitter.instantaneous](ParticlePool& particles, float dt, bool burst) mutable {
+        if (particles.isFull ())
             return;
 
-        emissionTimer += dt * rate;
+        uint32_t toEmit;
 
-        uint32_t toEmit = static_cast<uint32_t> (emissionTimer);
-        emissionTimer -= static_cast<float> (toEmit);
+        if (burst) {
+            toEmit = std::max (emitter.instantaneous, 1u);
+        } else {
+            emissionTimer += dt * rate * m_budgetScale;
 
-        if (remaining > 0) {
-            toEmit = remaining;
-            remaining = 0;
+            toEmit = static_cast<uint32_t> (emissionTimer);
+            emissionTimer -= static_cast<float> (toEmit);
+
+            if (remaining > 0) {
+                toEmit = remaining;
+                remaining = 0;
+            }
         }
 
-        for (uint32_t i = 0; i < toEmit && count < particles.size (); i++) {
-            auto& p = particles [count];
+        for (uint32_t i = 0; i < toEmit && !particles.isFull (); i++) {
+            const uint32_t p = particles.spawn ();
 
             // Determine spawn origin (control point or emitter origin)
             glm::vec3 spawnOrigin = transformedEmitterOrigin;
@@ -493,8 +948,8 @@ EmitterFunc CParticle::createSphereEmitter (const ParticleEmitter& emitter) {
             // Try to find a valid spawn point, with fallback to prevent infinite loop
             while (retryCount < maxRetries) {
                 // Generate spherical coordinates
-                float theta = randomFloat (m_rng, 0.0f, glm::two_pi<float>());
-                float phi = randomFloat (m_rng, 0.0f, glm::pi<float>());
+                float theta = m_rng.range (0.0f, glm::two_pi<float>());
+                float phi = m_rng.range (0.0f, glm::pi<float>());
 
                 // Generate 3D position on unit sphere
                 randomPos = glm::vec3 (
@@ -523,45 +978,61 @@ EmitterFunc CParticle::createSphereEmitter (const ParticleEmitter& emitter) {
             }
 
             // Scale by radius
-            float radius = randomFloat (m_rng, emitter.distanceMin.x, emitter.distanceMax.x);
+            float radius = m_rng.range (emitter.distanceMin.x, emitter.distanceMax.x);
             randomPos *= radius;
 
             // Flip Y to convert random offset from screen space to centered space
             randomPos.y = -randomPos.y;
-            p.position = spawnOrigin + randomPos;
+            particles.position [p] = spawnOrigin + randomPos;
 
             // Velocity pointing outward from sphere center
             glm::vec3 direction = glm::length (randomPos) > 0.0f ? glm::normalize (randomPos) : glm::vec3 (0.0f, 1.0f, 0.0f);
-            float speed = randomFloat (m_rng, emitter.speedMin, emitter.speedMax);
-            p.velocity = direction * speed * emitter.directions;
-
-            p.acceleration = glm::vec3 (0.0f);
-            p.rotation = glm::vec3 (0.0f);
-            p.angularVelocity = glm::vec3 (0.0f);
-            p.angularAcceleration = glm::vec3 (0.0f);
-
-            p.color = glm::vec3 (1.0f) * m_particle.instanceOverride.colorn->value->getVec3 ();
-            p.alpha = 1.0f * m_particle.instanceOverride.alpha->value->getFloat ();
-            p.size = 20.0f * m_particle.instanceOverride.size->value->getFloat ();
-            p.lifetime = lifetime;
-            p.age = 0.0f;
-            p.alive = true;
-            p.frame = -1.0f;
-
-            p.initial.color = p.color;
-            p.initial.alpha = p.alpha;
-            p.initial.size = p.size;
-            p.initial.lifetime = p.lifetime;
+            float speed = m_rng.range (emitter.speedMin, emitter.speedMax);
+            particles.velocity [p] = direction * speed * emitter.directions;
+
+            particles.color [p] = glm::vec3 (1.0f) * m_particle.instanceOverride.colorn->value->getVec3 ();
+            particles.alpha [p] = 1.0f * m_particle.instanceOverride.alpha->value->getFloat ();
+            particles.size [p] = 20.0f * m_particle.instanceOverride.size->value->getFloat ();
+            particles.lifetime [p] = lifetime;
+
+            particles.initialColor [p] = particles.color [p];
+            particles.initialAlpha [p] = particles.alpha [p];
+            particles.initialSize [p] = particles.size [p];
+            particles.initialLifetime [p] = particles.lifetime [p];
 
             for (auto& init : m_initializers) {
-                init (p);
+                init (particles, p);
             }
-
-            count++;
         }
     };
 }
 
+// ========== CHILDREN ==========
+
+void CParticle::setupChildren () {
+    for (const auto& child : m_particle.children) {
+        if (!child.definition || child.definition->emitters.empty ()) {
+            sLog.out ("Particle '", m_particle.name, "' child '", child.name, "' has nothing to emit, skipping");
+            continue;
+        }
+
+        auto system = std::unique_ptr<CParticle> (new CParticle (*this, child));
+
+        if (system->m_childType == ChildType::EventSpawn) {
+            m_needsSpawnEvents = true;
+        } else if (system->m_childType == ChildType::EventDeath) {
+            m_needsDeathEvents = true;
+        }
+
+        system->setup ();
+
+        sLog.out ("Particle '", m_particle.name, "' child '", child.name, "' (", child.type, ") from ",
+                  child.particleFile);
+
+        m_children.push_back (std::move (system));
+    }
+}
+
 // ========== INITIALIZERS ==========
 
 void CParticle::setupInitializers () {
@@ -604,9 +1075,9 @@ InitializerFunc CParticle::createColorRandomInitializer (const ColorRandomInitia
     DynamicValue* minValue = init.min->value.get ();
     DynamicValue* maxValue = init.max->value.get ();
 
-    return [this, minValue, maxValue](ParticleInstance& p) {
-        p.color = randomVec3 (m_rng, minValue->getVec3 (), maxValue->getVec3 ()) * m_particle.instanceOverride.colorn->value->getVec3 ();
-        p.initial.color = p.color;
+    return [this, minValue, maxValue](ParticlePool& particles, uint32_t p) {
+        particles.color [p] = m_rng.range (minValue->getVec3 (), maxValue->getVec3 ()) * m_particle.instanceOverride.colorn->value->getVec3 ();
+        particles.initialColor [p] = particles.color [p];
     };
 }
 
@@ -615,16 +1086,16 @@ InitializerFunc CParticle::createSizeRandomInitializer (const SizeRandomInitiali
     DynamicValue* maxValue = init.max->value.get ();
     DynamicValue* exponentValue = init.exponent->value.get ();
 
-    return [this, minValue, maxValue, exponentValue](ParticleInstance& p) {
-        float t = randomFloat (m_rng, 0.0f, 1.0f);
+    return [this, minValue, maxValue, exponentValue](ParticlePool& particles, uint32_t p) {
+        float t = m_rng.range (0.0f, 1.0f);
         float exponent = exponentValue->getFloat ();
         float min = minValue->getFloat ();
         float max = maxValue->getFloat ();
 
         // Apply exponent for non-linear distribution
         float adjustedT = std::pow (t, exponent);
-        p.size = (min + adjustedT * (max - min)) * m_particle.instanceOverride.size->value->getFloat ();
-        p.initial.size = p.size;
+        particles.size [p] = (min + adjustedT * (max - min)) * m_particle.instanceOverride.size->value->getFloat ();
+        particles.initialSize [p] = particles.size [p];
     };
 }
 
@@ -632,9 +1103,9 @@ InitializerFunc CParticle::createAlphaRandomInitializer (const AlphaRandomInitia
     DynamicValue* minValue = init.min->value.get ();
     DynamicValue* maxValue = init.max->value.get ();
 
-    return [this, minValue, maxValue](ParticleInstance& p) {
-        p.alpha = randomFloat (m_rng, minValue->getFloat (), maxValue->getFloat ()) * m_particle.instanceOverride.alpha->value->getFloat ();
-        p.initial.alpha = p.alpha;
+    return [this, minValue, maxValue](ParticlePool& particles, uint32_t p) {
+        particles.alpha [p] = m_rng.range (minValue->getFloat (), maxValue->getFloat ()) * m_particle.instanceOverride.alpha->value->getFloat ();
+        particles.initialAlpha [p] = particles.alpha [p];
     };
 }
 
@@ -642,9 +1113,9 @@ InitializerFunc CParticle::createLifetimeRandomInitializer (const LifetimeRandom
     DynamicValue* minValue = init.min->value.get ();
     DynamicValue* maxValue = init.max->value.get ();
 
-    return [this, minValue, maxValue](ParticleInstance& p) {
-        p.lifetime = randomFloat (m_rng, minValue->getFloat (), maxValue->getFloat ()) * m_particle.instanceOverride.lifetime->value->getFloat ();
-        p.initial.lifetime = p.lifetime;
+    return [this, minValue, maxValue](ParticlePool& particles, uint32_t p) {
+        particles.lifetime [p] = m_rng.range (minValue->getFloat (), maxValue->getFloat ()) * m_particle.instanceOverride.lifetime->value->getFloat ();
+        particles.initialLifetime [p] = particles.lifetime [p];
     };
 }
 
@@ -652,12 +1123,12 @@ InitializerFunc CParticle::createVelocityRandomInitializer (const VelocityRandom
     DynamicValue* minValue = init.min->value.get ();
     DynamicValue* maxValue = init.max->value.get ();
 
-    return [this, minValue, maxValue](ParticleInstance& p) {
-        glm::vec3 vel = randomVec3 (m_rng, minValue->getVec3 (), maxValue->getVec3 ());
+    return [this, minValue, maxValue](ParticlePool& particles, uint32_t p) {
+        glm::vec3 vel = m_rng.range (minValue->getVec3 (), maxValue->getVec3 ());
         // Flip Y velocity for centered space
         vel.y = -vel.y;
         float speedMultiplier = m_particle.instanceOverride.speed->value->getFloat ();
-        p.velocity += vel * speedMultiplier;
+        particles.velocity [p] += vel * speedMultiplier;
     };
 }
 
@@ -665,8 +1136,8 @@ InitializerFunc CParticle::createRotationRandomInitializer (const RotationRandom
     DynamicValue* minValue = init.min->value.get ();
     DynamicValue* maxValue = init.max->value.get ();
 
-    return [this, minValue, maxValue](ParticleInstance& p) {
-        p.rotation = randomVec3 (m_rng, minValue->getVec3 (), maxValue->getVec3 ());
+    return [this, minValue, maxValue](ParticlePool& particles, uint32_t p) {
+        particles.rotation [p] = m_rng.range (minValue->getVec3 (), maxValue->getVec3 ());
     };
 }
 
@@ -674,8 +1145,8 @@ InitializerFunc CParticle::createAngularVelocityRandomInitializer (const Angular
     DynamicValue* minValue = init.min->value.get ();
     DynamicValue* maxValue = init.max->value.get ();
 
-    return [this, minValue, maxValue](ParticleInstance& p) {
-        p.angularVelocity = randomVec3 (m_rng, minValue->getVec3 (), maxValue->getVec3 ());
+    return [this, minValue, maxValue](ParticlePool& particles, uint32_t p) {
+        particles.angularVelocity [p] = m_rng.range (minValue->getVec3 (), maxValue->getVec3 ());
     };
 }
 
@@ -684,27 +1155,28 @@ InitializerFunc CParticle::createTurbulentVelocityRandomInitializer (const Turbu
     DynamicValue* speedMax = init.speedMax->value.get ();
     DynamicValue* offset = init.offset->value.get ();
     DynamicValue* scale = init.scale->value.get ();
+    const CurlNoiseField* noise = &CurlNoiseField::get ();
 
-    return [this, speedMin, speedMax, offset, scale](ParticleInstance& p) {
+    return [this, speedMin, speedMax, offset, scale, noise](ParticlePool& particles, uint32_t p) {
         // Random speed in specified range
-        float speed = randomFloat (m_rng, speedMin->getFloat (), speedMax->getFloat ());
+        float speed = m_rng.range (speedMin->getFloat (), speedMax->getFloat ());
 
         // Initialize random position in noise field (0-10 range for good variety)
-        p.noisePos = randomVec3 (m_rng, glm::vec3(0.0f), glm::vec3(10.0f));
+        particles.noisePos [p] = m_rng.range (glm::vec3(0.0f), glm::vec3(10.0f));
 
         // Apply offset to noise position (shifts sampling region in noise field)
-        glm::vec3 noisePosWithOffset = p.noisePos + glm::vec3(offset->getFloat ());
+        glm::vec3 noisePosWithOffset = particles.noisePos [p] + glm::vec3(offset->getFloat ());
 
         // Sample curl noise to get turbulent direction
-        glm::vec3 direction = curlNoise(noisePosWithOffset);
+        glm::vec3 direction = noise->sample (noisePosWithOffset);
 
         // Normalize for consistent velocity magnitude
         if (glm::length(direction) > 0.0001f) {
             direction = glm::normalize(direction);
         } else {
             // Fallback to random direction if noise returns zero
-            float theta = randomFloat (m_rng, 0.0f, glm::two_pi<float>());
-            float phi = randomFloat (m_rng, 0.0f, glm::pi<float>());
+            float theta = m_rng.range (0.0f, glm::two_pi<float>());
+            float phi = m_rng.range (0.0f, glm::pi<float>());
             direction = glm::vec3(
                 std::sin(phi) * std::cos(theta),
                 std::sin(phi) * std::sin(theta),
@@ -721,7 +1193,7 @@ InitializerFunc CParticle::createTurbulentVelocityRandomInitializer (const Turbu
         // Flip Y for centered space (like velocity initializer does)
         turbulentVel.y = -turbulentVel.y;
 
-        p.velocity += turbulentVel;
+        particles.velocity [p] += turbulentVel;
     };
 }
 
@@ -735,7 +1207,7 @@ InitializerFunc CParticle::createMapSequenceAroundControlPointInitializer (const
     // This creates the circular distribution pattern
     int sequenceIndex = 0;
 
-    return [this, controlPointValue, countValue, speedMinValue, speedMaxValue, sequenceIndex](ParticleInstance& p) mutable {
+    return [this, controlPointValue, countValue, speedMinValue, speedMaxValue, sequenceIndex](ParticlePool& particles, uint32_t p) mutable {
         int controlPoint = static_cast<int>(controlPointValue->getFloat());
         int count = static_cast<int>(countValue->getFloat());
 
@@ -751,12 +1223,12 @@ InitializerFunc CParticle::createMapSequenceAroundControlPointInitializer (const
 
         // Set particle position in circular pattern around control point
         // This creates the natural clustering seen in the original
-        p.position = centerPos;
+        particles.position [p] = centerPos;
 
         // Set velocity based on angle and speed range
         glm::vec3 speedMin = speedMinValue->getVec3();
         glm::vec3 speedMax = speedMaxValue->getVec3();
-        glm::vec3 speed = randomVec3(m_rng, speedMin, speedMax);
+        glm::vec3 speed = m_rng.range (speedMin, speedMax);
 
         // Rotate velocity based on sequence angle (creates outward spiral pattern)
         glm::mat3 rotationMatrix = glm::mat3(
@@ -770,7 +1242,7 @@ InitializerFunc CParticle::createMapSequenceAroundControlPointInitializer (const
         rotatedSpeed.y = -rotatedSpeed.y;
 
         // Apply speed multiplier and add to velocity
-        p.velocity += rotatedSpeed * m_particle.instanceOverride.speed->value->getFloat();
+        particles.velocity [p] += rotatedSpeed * m_particle.instanceOverride.speed->value->getFloat();
     };
 }
 
@@ -782,7 +1254,7 @@ void CParticle::setupOperators () {
             continue;
         }
 
-        OperatorFunc func;
+        std::optional<ParticleOperator> func;
 
         if (op->is<MovementOperator> ()) {
             func = createMovementOperator (*op->as<MovementOperator> ());
@@ -807,419 +1279,156 @@ void CParticle::setupOperators () {
         }
 
         if (func) {
-            m_operators.push_back (std::move (func));
+            m_operators.add (std::move (*func));
         }
     }
 }
 
-OperatorFunc CParticle::createMovementOperator (const MovementOperator& op) {
-    DynamicValue* speedOverride = m_particle.instanceOverride.speed->value.get ();
-    DynamicValue* dragValue = op.drag->value.get ();
-    DynamicValue* gravityValue = op.gravity->value.get ();
-
-    return [dragValue, gravityValue, speedOverride](
-        std::vector<ParticleInstance>& particles,
-        uint32_t count,
-        const std::vector<ControlPointData>&,
-        float,
-        float dt
-    ) {
-        float speed = speedOverride->getFloat ();
-        float drag = dragValue->getFloat ();
-        glm::vec3 gravity = gravityValue->getVec3 ();
-        // Flip gravity Y for centered space
-        gravity.y = -gravity.y;
-
-        for (uint32_t i = 0; i < count; i++) {
-            auto& p = particles [i];
-
-            // Apply drag force
-            glm::vec3 dragForce = -drag * p.velocity;
-
-            // Total acceleration
-            glm::vec3 totalAccel = (dragForce + gravity) * speed;
-
-            // Update velocity and position
-            p.velocity += totalAccel * dt;
-            p.position += p.velocity * dt;
-        }
+ParticleOperator CParticle::createMovementOperator (const MovementOperator& op) {
+    return Particles::Operators::Movement {
+        .speedValue = m_particle.instanceOverride.speed->value.get (),
+        .dragValue = op.drag->value.get (),
+        .gravityValue = op.gravity->value.get (),
     };
 }
 
-OperatorFunc CParticle::createAngularMovementOperator (const AngularMovementOperator& op) {
-    DynamicValue* dragValue = op.drag->value.get ();
-    DynamicValue* forceValue = op.force->value.get ();
-
-    return [dragValue, forceValue](
-        std::vector<ParticleInstance>& particles,
-        uint32_t count,
-        const std::vector<ControlPointData>&,
-        float,
-        float dt
-    ) {
-        float drag = dragValue->getFloat ();
-        glm::vec3 force = forceValue->getVec3 ();
-
-        for (uint32_t i = 0; i < count; i++) {
-            auto& p = particles [i];
-
-            glm::vec3 dragForce = -drag * p.angularVelocity;
-            glm::vec3 totalAccel = dragForce + force;
-
-            p.angularVelocity += totalAccel * dt;
-            p.rotation += p.angularVelocity * dt;
-
-            // Wrap rotation to prevent floating-point precision issues
-            const float pi = glm::pi<float>();
-            const float two_pi = glm::two_pi<float>();
-            for (int j = 0; j < 3; j++) {
-                while (p.rotation[j] > pi) p.rotation[j] -= two_pi;
-                while (p.rotation[j] < -pi) p.rotation[j] += two_pi;
-            }
-        }
+ParticleOperator CParticle::createAngularMovementOperator (const AngularMovementOperator& op) {
+    return Particles::Operators::AngularMovement {
+        .dragValue = op.drag->value.get (),
+        .forceValue = op.force->value.get (),
     };
 }
 
-OperatorFunc CParticle::createAlphaFadeOperator (const AlphaFadeOperator& op) {
-    DynamicValue* fadeInTimeValue = op.fadeInTime->value.get ();
-    DynamicValue* fadeOutTimeValue = op.fadeOutTime->value.get ();
-
-    return [fadeInTimeValue, fadeOutTimeValue](
-        std::vector<ParticleInstance>& particles,
-        uint32_t count,
-        const std::vector<ControlPointData>&,
-        float,
-        float
-    ) {
-        float fadeInTime = fadeInTimeValue->getFloat ();
-        float fadeOutTime = fadeOutTimeValue->getFloat ();
-
-        for (uint32_t i = 0; i < count; i++) {
-            auto& p = particles [i];
-
-            float life = p.getLifetimePos ();
-
-            if (life <= fadeInTime) {
-                float fade = fadeValue (life, 0.0f, fadeInTime, 0.0f, 1.0f);
-                p.alpha = p.initial.alpha * fade;
-            } else if (life > fadeOutTime) {
-                float fade = 1.0f - fadeValue (life, fadeOutTime, 1.0f, 0.0f, 1.0f);
-                p.alpha = p.initial.alpha * fade;
-            } else {
-                p.alpha = p.initial.alpha;
-            }
-        }
+ParticleOperator CParticle::createAlphaFadeOperator (const AlphaFadeOperator& op) {
+    return Particles::Operators::AlphaFade {
+        .fadeInTimeValue = op.fadeInTime->value.get (),
+        .fadeOutTimeValue = op.fadeOutTime->value.get (),
     };
 }
 
-OperatorFunc CParticle::createSizeChangeOperator (const SizeChangeOperator& op) {
-    DynamicValue* startTimeValue = op.startTime->value.get ();
-    DynamicValue* endTimeValue = op.endTime->value.get ();
-    DynamicValue* startValueValue = op.startValue->value.get ();
-    DynamicValue* endValueValue = op.endValue->value.get ();
-
-    return [startTimeValue, endTimeValue, startValueValue, endValueValue](
-        std::vector<ParticleInstance>& particles,
-        uint32_t count,
-        const std::vector<ControlPointData>&,
-        float,
-        float
-    ) {
-        float startTime = startTimeValue->getFloat ();
-        float endTime = endTimeValue->getFloat ();
-        float startValue = startValueValue->getFloat ();
-        float endValue = endValueValue->getFloat ();
-
-        for (uint32_t i = 0; i < count; i++) {
-            auto& p = particles [i];
-
-            float life = p.getLifetimePos ();
-            float multiplier = fadeValue (life, startTime, endTime, startValue, endValue);
-            p.size = p.initial.size * multiplier;
-        }
+ParticleOperator CParticle::createSizeChangeOperator (const SizeChangeOperator& op) {
+    return Particles::Operators::ValueChange {
+        .target = Particles::Operators::ValueChange::Size,
+        .startTimeValue = op.startTime->value.get (),
+        .endTimeValue = op.endTime->value.get (),
+        .startValueValue = op.startValue->value.get (),
+        .endValueValue = op.endValue->value.get (),
     };
 }
 
-OperatorFunc CParticle::createAlphaChangeOperator (const AlphaChangeOperator& op) {
-    DynamicValue* startTimeValue = op.startTime->value.get ();
-    DynamicValue* endTimeValue = op.endTime->value.get ();
-    DynamicValue* startValueValue = op.startValue->value.get ();
-    DynamicValue* endValueValue = op.endValue->value.get ();
-
-    return [startTimeValue, endTimeValue, startValueValue, endValueValue](
-        std::vector<ParticleInstance>& particles,
-        uint32_t count,
-        const std::vector<ControlPointData>&,
-        float,
-        float
-    ) {
-        float startTime = startTimeValue->getFloat ();
-        float endTime = endTimeValue->getFloat ();
-        float startValue = startValueValue->getFloat ();
-        float endValue = endValueValue->getFloat ();
-
-        for (uint32_t i = 0; i < count; i++) {
-            auto& p = particles [i];
-
-            float life = p.getLifetimePos ();
-            float multiplier = fadeValue (life, startTime, endTime, startValue, endValue);
-            p.alpha = p.initial.alpha * multiplier;
-        }
+ParticleOperator CParticle::createAlphaChangeOperator (const AlphaChangeOperator& op) {
+    return Particles::Operators::ValueChange {
+        .target = Particles::Operators::ValueChange::Alpha,
+        .startTimeValue = op.startTime->value.get (),
+        .endTimeValue = op.endTime->value.get (),
+        .startValueValue = op.startValue->value.get (),
+        .endValueValue = op.endValue->value.get (),
     };
 }
 
-OperatorFunc CParticle::createColorChangeOperator (const ColorChangeOperator& op) {
-    DynamicValue* startTimeValue = op.startTime->value.get ();
-    DynamicValue* endTimeValue = op.endTime->value.get ();
-    DynamicValue* startValueValue = op.startValue->value.get ();
-    DynamicValue* endValueValue = op.endValue->value.get ();
-
-    return [startTimeValue, endTimeValue, startValueValue, endValueValue](
-        std::vector<ParticleInstance>& particles,
-        uint32_t count,
-        const std::vector<ControlPointData>&,
-        float,
-        float
-    ) {
-        float startTime = startTimeValue->getFloat ();
-        float endTime = endTimeValue->getFloat ();
-        glm::vec3 startValue = startValueValue->getVec3 ();
-        glm::vec3 endValue = endValueValue->getVec3 ();
-
-        for (uint32_t i = 0; i < count; i++) {
-            auto& p = particles [i];
-
-            float life = p.getLifetimePos ();
-
-            glm::vec3 color;
-            color.r = fadeValue (life, startTime, endTime, startValue.r, endValue.r);
-            color.g = fadeValue (life, startTime, endTime, startValue.g, endValue.g);
-            color.b = fadeValue (life, startTime, endTime, startValue.b, endValue.b);
-
-            p.color = p.initial.color * color;
-        }
+ParticleOperator CParticle::createColorChangeOperator (const ColorChangeOperator& op) {
+    return Particles::Operators::ColorChange {
+        .startTimeValue = op.startTime->value.get (),
+        .endTimeValue = op.endTime->value.get (),
+        .startValueValue = op.startValue->value.get (),
+        .endValueValue = op.endValue->value.get (),
     };
 }
 
-OperatorFunc CParticle::createTurbulenceOperator (const TurbulenceOperator& op) {
-    DynamicValue* scaleValue = op.scale->value.get ();
+ParticleOperator CParticle::createTurbulenceOperator (const TurbulenceOperator& op) {
     DynamicValue* speedMinValue = op.speedMin->value.get ();
     DynamicValue* speedMaxValue = op.speedMax->value.get ();
-    DynamicValue* timeScaleValue = op.timeScale->value.get ();
     DynamicValue* audioModeValue = op.audioProcessingMode->value.get ();
     // DynamicValue* audioBoundsValue = op.audioProcessingBounds->value.get ();
     // DynamicValue* audioFreqEndValue = op.audioProcessingFrequencyEnd->value.get ();
 
-    // Random phase for noise offset
-    float phase = randomFloat (m_rng, 0.0f, 100.0f);
-
-    // Check if audio processing is enabled
-    int audioMode = static_cast<int>(audioModeValue->getFloat());
-
-    // For non-audio mode, randomize speed once; for audio mode, use speedmin as default
-    float fixedSpeed;
-    if (audioMode == 0) {
-        fixedSpeed = randomFloat (m_rng, speedMinValue->getFloat (), speedMaxValue->getFloat ());
-    } else {
-        // TODO: Implement audio processing support (audioprocessingbounds, audioprocessingfrequencyend)
-        // For now, use speedmin as baseline (assume no audio input)
-        fixedSpeed = speedMinValue->getFloat();
-    }
-
-    return [this, scaleValue, timeScaleValue, phase, fixedSpeed, &rng = m_rng](
-        std::vector<ParticleInstance>& particles,
-        uint32_t count,
-        const std::vector<ControlPointData>&,
-        float currentTime,
-        float dt
-    ) {
-        float scale = scaleValue->getFloat ();
-        float timeScale = timeScaleValue->getFloat ();
-        float speed = fixedSpeed;
-
-        for (uint32_t i = 0; i < count; i++) {
-            auto& p = particles [i];
-
-            // Initialize noise position if not set (for particles without turbulentvelocityrandom initializer)
-            if (glm::length(p.noisePos) < 0.001f && p.age < 0.001f) {
-                // Use particle position plus small random offset to break clustering
-                // for particles spawned at the same location
-                glm::vec3 randomOffset(
-                    randomFloat(rng, -5.0f, 5.0f),
-                    randomFloat(rng, -5.0f, 5.0f),
-                    randomFloat(rng, -5.0f, 5.0f)
-                );
-                p.noisePos = p.position * scale * 2.0f + randomOffset;
-            }
-
-            // Advance noise position based on particle's current velocity direction
-            // This creates per-particle turbulence paths instead of uniform motion
-            glm::vec3 noiseVelocity = glm::normalize(p.velocity + glm::vec3(0.001f)) * speed * scale;
-            p.noisePos += noiseVelocity * dt;
-
-            // Apply time-based phase shift
-            glm::vec3 sampledNoisePos = p.noisePos;
-            sampledNoisePos.x += phase + timeScale * currentTime;
-
-            // Get curl noise acceleration
-            glm::vec3 acceleration = curlNoise (sampledNoisePos);
-
-            // Normalize and scale by speed
-            if (glm::length (acceleration) > 0.0f) {
-                acceleration = glm::normalize (acceleration) * speed;
-            }
-
-            // Apply acceleration (convert to velocity change over dt)
-            p.velocity += acceleration * dt;
-        }
-    };
-}
-
-OperatorFunc CParticle::createVortexOperator (const VortexOperator& op) {
-    int controlPoint = op.controlPoint;
-    DynamicValue* axisValue = op.axis->value.get ();
-    DynamicValue* offsetValue = op.offset->value.get ();
-    DynamicValue* distanceInnerValue = op.distanceInner->value.get ();
-    DynamicValue* distanceOuterValue = op.distanceOuter->value.get ();
-    DynamicValue* speedInnerValue = op.speedInner->value.get ();
-    DynamicValue* speedOuterValue = op.speedOuter->value.get ();
-    DynamicValue* audioModeValue = op.audioProcessingMode->value.get ();
-
-    // Check if audio processing is enabled
-    int audioMode = static_cast<int>(audioModeValue->getFloat());
-
-    return [this, controlPoint, axisValue, offsetValue, distanceInnerValue, distanceOuterValue, speedInnerValue, speedOuterValue, audioMode](
-        std::vector<ParticleInstance>& particles,
-        uint32_t count,
-        const std::vector<ControlPointData>& controlPoints,
-        float,
-        float dt
-    ) {
-        // Audio modulation (when implemented, this will sample from audio context)
-        float audioAmplitude = 0.0f; // TODO: Sample from AudioContext when audio processing is implemented
-
-        // If audio mode is enabled but no audio, skip vortex entirely
-        if (audioMode > 0 && audioAmplitude == 0.0f) {
-            return;
-        }
-
-        glm::vec3 axis = axisValue->getVec3 ();
-        glm::vec3 offset = offsetValue->getVec3 ();
-        float distanceInner = distanceInnerValue->getFloat ();
-        float distanceOuter = distanceOuterValue->getFloat ();
-        float speedInner = speedInnerValue->getFloat ();
-        float speedOuter = speedOuterValue->getFloat ();
-
-        // Apply audio modulation to speeds
-        if (audioMode > 0) {
-            speedInner *= (1.0f + audioAmplitude);
-            speedOuter *= (1.0f + audioAmplitude);
-        }
-
-        // Get vortex center from control point
-        glm::vec3 center = glm::vec3 (0.0f);
-        if (controlPoint >= 0 && controlPoint < static_cast<int>(controlPoints.size ())) {
-            center = controlPoints [controlPoint].position + offset;
-        } else {
-            center = offset;
-        }
-
-        // Normalize axis
-        if (glm::length (axis) > 0.0f) {
-            axis = glm::normalize (axis);
-        } else {
-            axis = glm::vec3 (0.0f, 0.0f, 1.0f); // Default to Z-axis
-        }
-
-        float disMid = distanceOuter - distanceInner + 0.1f;
-
-        for (uint32_t i = 0; i < count; i++) {
-            auto& p = particles [i];
+    // Random phase for noise offset
+    float phase = m_rng.range (0.0f, 100.0f);
 
-            // Calculate distance from vortex center
-            glm::vec3 toParticle = p.position - center;
-            float distance = glm::length(toParticle);
+    // Check if audio processing is enabled
+    int audioMode = static_cast<int>(audioModeValue->getFloat());
 
-            // Compute tangent direction (perpendicular to both axis and position vector)
-            // Negative cross product to match rotation direction
-            glm::vec3 direct = -glm::cross(axis, toParticle);
-            if (glm::length(direct) > 0.001f) {
-                direct = glm::normalize(direct);
-            } else {
-                continue; // Particle is on the axis
-            }
+    // For non-audio mode, randomize speed once; for audio mode, use speedmin as default
+    float fixedSpeed;
+    if (audioMode == 0) {
+        fixedSpeed = m_rng.range (speedMinValue->getFloat (), speedMaxValue->getFloat ());
+    } else {
+        // TODO: Implement audio processing support (audioprocessingbounds, audioprocessingfrequencyend)
+        // For now, use speedmin as baseline (assume no audio input)
+        fixedSpeed = speedMinValue->getFloat();
+    }
 
-            // Determine speed based on distance (matching KDE logic)
-            float speed = 0.0f;
-            if (disMid < 0 || distance < distanceInner) {
-                // Inside inner radius or invalid range - use inner speed
-                speed = speedInner;
-            } else if (distance > distanceOuter) {
-                // Outside outer radius - use outer speed
-                speed = speedOuter;
-            } else {
-                // Between inner and outer - interpolate
-                float t = (distance - distanceInner) / disMid;
-                speed = glm::mix(speedInner, speedOuter, t);
-            }
+    return Particles::Operators::Turbulence {
+        .scaleValue = op.scale->value.get (),
+        .timeScaleValue = op.timeScale->value.get (),
+        .phase = phase,
+        .speed = fixedSpeed,
+        .rng = &m_rng,
+        .noise = &CurlNoiseField::get (),
+    };
+}
 
-            // Apply tangential velocity (spinning)
-            p.velocity += direct * speed * dt;
-        }
+ParticleOperator CParticle::createVortexOperator (const VortexOperator& op) {
+    return Particles::Operators::Vortex {
+        .controlPoint = op.controlPoint,
+        // Check if audio processing is enabled
+        .audioMode = static_cast<int> (op.audioProcessingMode->value->getFloat ()),
+        .axisValue = op.axis->value.get (),
+        .offsetValue = op.offset->value.get (),
+        .distanceInnerValue = op.distanceInner->value.get (),
+        .distanceOuterValue = op.distanceOuter->value.get (),
+        .speedInnerValue = op.speedInner->value.get (),
+        .speedOuterValue = op.speedOuter->value.get (),
     };
 }
 
-OperatorFunc CParticle::createControlPointAttractOperator (const ControlPointAttractOperator& op) {
-    int controlPoint = op.controlPoint;
-    DynamicValue* originValue = op.origin->value.get ();
-    DynamicValue* scaleValue = op.scale->value.get ();
-    DynamicValue* thresholdValue = op.threshold->value.get ();
+ParticleOperator CParticle::createControlPointAttractOperator (const ControlPointAttractOperator& op) {
+    return Particles::Operators::ControlPointAttract {
+        .controlPoint = op.controlPoint,
+        .originValue = op.origin->value.get (),
+        .scaleValue = op.scale->value.get (),
+        .thresholdValue = op.threshold->value.get (),
+    };
+}
 
-    return [this, controlPoint, originValue, scaleValue, thresholdValue]
-           (std::vector<ParticleInstance>& particles, uint32_t count,
-            const std::vector<ControlPointData>& controlPoints, float currentTime, float dt) {
+void CParticle::setupGPUSimulation () {
+    if (!getContext ().getApp ().getContext ().settings.render.gpuParticles)
+        return;
 
-        // Get dynamic values
-        glm::vec3 origin = originValue->getVec3 ();
-        float scale = scaleValue->getFloat ();
-        float threshold = thresholdValue->getFloat ();
+    // Events and followed particles have to be read back on the CPU
+    if (m_parent || !m_children.empty ()) {
+        sLog.out ("Particle '", m_particle.name, "' is part of a child system hierarchy, using the CPU");
+        return;
+    }
 
-        // Get control point position
-        if (controlPoint < 0 || controlPoint >= static_cast<int>(controlPoints.size())) {
-            return;
-        }
+    if (!Particles::GPUParticleSimulator::canSimulate (m_particle, m_useTrailRenderer)) {
+        sLog.out ("Particle '", m_particle.name, "' uses features the GPU simulation doesn't support, using the CPU");
+        return;
+    }
 
-        glm::vec3 center = controlPoints[controlPoint].position + origin;
-
-        // Apply attraction force to all particles within threshold
-        for (uint32_t i = 0; i < count; i++) {
-            auto& p = particles [i];
-            if (!p.alive) continue;
-
-            // Calculate distance and direction to control point
-            glm::vec3 toCenter = center - p.position;
-            float distance = glm::length (toCenter);
-
-            // Only apply force if within threshold
-            if (distance > 0.001f && distance < threshold) {
-                // Normalize direction
-                glm::vec3 direction = toCenter / distance;
-
-                // Apply constant force (scale value) in direction of control point
-                // Scale can be negative for repulsion, positive for attraction
-                glm::vec3 forceVec = direction * scale * dt;
-                p.velocity += forceVec;
-
-                // For attraction (positive scale), apply velocity damping near center
-                // This slows particles down as they approach the control point
-                if (scale > 0 && distance < threshold * 0.1f) {
-                    // Damping factor increases as particle gets closer (0.0 at threshold*0.1, 0.75 at distance 0)
-                    float dampingFactor = 1.0f - (distance / (threshold * 0.1f)) * 0.75f;
-                    p.velocity *= (1.0f - dampingFactor * dt);
-                }
-            }
-        }
+    Particles::GPUAnimationSettings animation {
+        .mode = Particles::GPUAnimationSettings::Loop,
+        .frames = m_spritesheetFrames,
+        .duration = m_spritesheetDuration,
+        .speed = m_animationSpeed,
     };
+
+    if (m_animationMode == AnimationMode::RandomFrame) {
+        animation.mode = Particles::GPUAnimationSettings::RandomFrame;
+    } else if (m_animationMode == AnimationMode::Once) {
+        animation.mode = Particles::GPUAnimationSettings::Once;
+    }
+
+    auto simulator = std::make_unique<Particles::GPUParticleSimulator> (
+        m_maxParticles, m_operators.getOperators (), animation);
+
+    if (!simulator->setup ()) {
+        sLog.out ("Particle '", m_particle.name, "' cannot be simulated on the GPU, using the CPU");
+        return;
+    }
+
+    m_gpuSimulator = std::move (simulator);
+    sLog.out ("Particle '", m_particle.name, "' simulated on the GPU");
 }
 
 // ========== RENDERING ==========
@@ -1259,17 +1468,40 @@ GLuint CParticle::createShaderProgram () {
         uniform int u_UseTrailRenderer;
         uniform float u_TrailLength;
         uniform float u_TrailMaxLength;
+        uniform int u_TrailSegments;
         uniform float u_TextureRatio;
 
         void main() {
             vec2 offset = aTexCoord - 0.5;
             vec3 billboardPos;
+            vec2 texCoord = aTexCoord;
+            vec4 color = aColor;
 
             if (u_UseTrailRenderer == 1) {
-                // Trail rendering: positions are pre-computed on CPU
-                // Vertices already have left/right positions baked in
-                // Just pass through without transformation
-                billboardPos = aPos;
+                // Trail rendering: every instance is a ribbon strip of u_TrailSegments quads, two vertices per
+                // segment edge. Head at t = 0, tail at t = 1
+                float side = float(gl_VertexID % 2);
+                float t = float(gl_VertexID / 2) / float(u_TrailSegments);
+
+                // 2D velocity (XY plane only for orthographic rendering)
+                vec2 velocity = aVelocity.xy;
+                float speed = length(velocity);
+                bool moving = speed > 0.001;
+
+                // Trail length is scaled by particle size to match normal particle rendering
+                float trailLength = moving ? clamp(speed * u_TrailLength, 0.0, u_TrailMaxLength) * aSize : 0.0;
+
+                // The segments march perpendicular to the velocity, the ribbon's width is along it and grows with
+                // the trail's length so fast particles have long and wide trails
+                vec2 trailDir = moving ? vec2(velocity.y, -velocity.x) / speed : vec2(1.0, 0.0);
+                vec2 widthDir = moving ? velocity / speed : vec2(0.0, 1.0);
+                vec2 center = aPos.xy - trailDir * (trailLength * t);
+
+                billboardPos = vec3(center + widthDir * trailLength * (side * 2.0 - 1.0), aPos.z);
+                // u across the ribbon, v along the trail
+                texCoord = vec2(side, t);
+                // Fade to 50% at the tail, not to zero so it doesn't disappear suddenly
+                color.a *= 1.0 - t * 0.5;
             } else {
                 // Standard rotation-based rendering
                 float cx = cos(aRotation.x);
@@ -1306,85 +1538,30 @@ GLuint CParticle::createShaderProgram () {
             }
 
             gl_Position = g_ModelViewProjectionMatrix * vec4(billboardPos, 1.0);
-            vTexCoord = aTexCoord;
-            vColor = aColor;
+            vTexCoord = texCoord;
+            vColor = color;
             vFrame = aFrame;
         }
     )";
 
-    const char* fragmentShaderSource = R"(
-        #version 330 core
-        in vec2 vTexCoord;
-        in vec4 vColor;
-        in float vFrame;
-
-        out vec4 FragColor;
-
-        uniform sampler2D g_Texture0;
-        uniform int u_HasTexture;
-        uniform int u_TextureFormat; // 8 = RG88, 9 = R8
-        uniform vec2 u_SpritesheetSize; // x=cols, y=rows
-        uniform float u_Overbright; // Brightness multiplier for additive particles
-
-        void main() {
-            vec4 texColor;
-            if (u_HasTexture == 1) {
-                // Calculate UV coordinates for spritesheet frame
-                vec2 uv = vTexCoord;
-                if (u_SpritesheetSize.x > 0.0) {
-                    // Spritesheet: adjust UVs to sample only the current frame
-                    float cols = u_SpritesheetSize.x;
-                    float rows = u_SpritesheetSize.y;
-                    float frameIndex = floor(vFrame);
-
-                    float frameX = mod(frameIndex, cols);
-                    float frameY = floor(frameIndex / cols);
-
-                    float frameWidth = 1.0 / cols;
-                    float frameHeight = 1.0 / rows;
-
-                    // Calculate UV coordinates for the current frame
-                    uv = vec2(
-                        frameX * frameWidth + vTexCoord.x * frameWidth,
-                        frameY * frameHeight + vTexCoord.y * frameHeight
-                    );
-                }
-
-                // Sample texture
-                vec4 sample = texture(g_Texture0, uv);
-
-                // Convert texture format like common_fragment.h does
-                if (u_TextureFormat == 8) {
-                    // RG88: R channel is color (grayscale), G channel is alpha
-                    texColor = vec4(sample.rrr, sample.g);
-                } else if (u_TextureFormat == 9) {
-                    // R8: R channel is alpha, white color
-                    texColor = vec4(1.0, 1.0, 1.0, sample.r);
-                } else {
-                    // Normal RGBA
-                    texColor = sample;
-                }
-            } else {
-                // No texture - create circular particle fallback
-                vec2 coord = vTexCoord - vec2(0.5);
-                float dist = length(coord) * 2.0;
-                if (dist > 1.0) discard;
-                float alpha = 1.0 - dist;
-                texColor = vec4(1.0, 1.0, 1.0, alpha);
-            }
 
-            // Apply vertex color and texture
-            vec4 finalColor = vColor * texColor;
+    // GPU simulated systems read the simulator's state buffer directly
+    std::string gpuVertexShaderSource;
+    GLuint geometryShader = 0;
 
-            // Apply overbright multiplier to RGB channels (controls brightness for additive particles)
-            finalColor.rgb *= u_Overbright;
+    if (m_gpuSimulator) {
+        gpuVertexShaderSource = std::string ("#version 330 core\n") +
+            Particles::GPUParticleSimulator::getStateLayout () + GPU_PARTICLE_VERTEX_SHADER;
+        vertexShaderSource = gpuVertexShaderSource.c_str ();
+        geometryShader = compileShader (GL_GEOMETRY_SHADER, GPU_PARTICLE_GEOMETRY_SHADER);
 
-            FragColor = finalColor;
+        if (geometryShader == 0) {
+            return 0;
         }
-    )";
+    }
 
     GLuint vertexShader = compileShader (GL_VERTEX_SHADER, vertexShaderSource);
-    GLuint fragmentShader = compileShader (GL_FRAGMENT_SHADER, fragmentShaderSource);
+    GLuint fragmentShader = compileShader (GL_FRAGMENT_SHADER, PARTICLE_FRAGMENT_SHADER);
 
     if (vertexShader == 0 || fragmentShader == 0) {
         return 0;
@@ -1392,6 +1569,9 @@ GLuint CParticle::createShaderProgram () {
 
     GLuint program = glCreateProgram ();
     glAttachShader (program, vertexShader);
+    if (geometryShader != 0) {
+        glAttachShader (program, geometryShader);
+    }
     glAttachShader (program, fragmentShader);
     glLinkProgram (program);
 
@@ -1402,11 +1582,13 @@ GLuint CParticle::createShaderProgram () {
         glGetProgramInfoLog (program, 512, nullptr, infoLog);
         sLog.error ("Particle shader program linking failed: ", infoLog);
         glDeleteShader (vertexShader);
+        glDeleteShader (geometryShader);
         glDeleteShader (fragmentShader);
         return 0;
     }
 
     glDeleteShader (vertexShader);
+    glDeleteShader (geometryShader);
     glDeleteShader (fragmentShader);
 
     return program;
@@ -1415,12 +1597,38 @@ GLuint CParticle::createShaderProgram () {
 void CParticle::setupBuffers () {
     // Create shader program
     m_shaderProgram = createShaderProgram ();
+    if (m_shaderProgram == 0 && m_gpuSimulator) {
+        sLog.out ("Particle '", m_particle.name, "' GPU render program unavailable, using the CPU simulation");
+        m_gpuSimulator.reset ();
+        m_shaderProgram = createShaderProgram ();
+    }
     if (m_shaderProgram == 0) {
         sLog.error ("Failed to create particle shader program for ", m_particle.name);
         return;
     }
 
+    setupUniforms ();
+
+    // GPU simulated systems draw straight from the simulator's state buffers
+    if (m_gpuSimulator) {
+        return;
+    }
+
+    glGenVertexArrays (1, &m_vao);
+    glBindVertexArray (m_vao);
+
+    // One instance record per particle, sprites and trail ribbons alike are expanded from it in the vertex shader
+    m_vertexStream = std::make_unique<StreamingBuffer> (m_maxParticles * PARTICLE_INSTANCE_FLOATS * sizeof (float));
+
+    setupInstancedBuffers ();
+
+    bindVertexAttributes (0);
+    glBindVertexArray (0);
+}
+
+void CParticle::setupUniforms () {
     // Cache uniform locations
+    m_uniformModelViewProjection = glGetUniformLocation (m_shaderProgram, "g_ModelViewProjectionMatrix");
     m_uniformTexture = glGetUniformLocation (m_shaderProgram, "g_Texture0");
     m_uniformHasTexture = glGetUniformLocation (m_shaderProgram, "u_HasTexture");
     m_uniformTextureFormat = glGetUniformLocation (m_shaderProgram, "u_TextureFormat");
@@ -1429,265 +1637,13 @@ void CParticle::setupBuffers () {
     m_uniformUseTrailRenderer = glGetUniformLocation (m_shaderProgram, "u_UseTrailRenderer");
     m_uniformTrailLength = glGetUniformLocation (m_shaderProgram, "u_TrailLength");
     m_uniformTrailMaxLength = glGetUniformLocation (m_shaderProgram, "u_TrailMaxLength");
+    m_uniformTrailSegments = glGetUniformLocation (m_shaderProgram, "u_TrailSegments");
     m_uniformTextureRatio = glGetUniformLocation (m_shaderProgram, "u_TextureRatio");
 
-    glGenVertexArrays (1, &m_vao);
-    glGenBuffers (1, &m_vbo);
-    glGenBuffers (1, &m_ebo);
-
-    glBindVertexArray (m_vao);
-    glBindBuffer (GL_ARRAY_BUFFER, m_vbo);
-    glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-
-    // Vertex format: pos(3) + texcoord(2) + rotation(3) + size(1) + color(4) + frame(1) + velocity(3) = 17 floats
-    const int stride = sizeof (float) * 17;
-
-    // Position (location 0)
-    glEnableVertexAttribArray (0);
-    glVertexAttribPointer (0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-
-    // Texture coordinates (location 1)
-    glEnableVertexAttribArray (1);
-    glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof (float) * 3));
-
-    // Rotation (location 2)
-    glEnableVertexAttribArray (2);
-    glVertexAttribPointer (2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof (float) * 5));
-
-    // Size (location 3)
-    glEnableVertexAttribArray (3);
-    glVertexAttribPointer (3, 1, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof (float) * 8));
-
-    // Color (location 4) - includes alpha as 4th component
-    glEnableVertexAttribArray (4);
-    glVertexAttribPointer (4, 4, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof (float) * 9));
-
-    // Frame (location 5)
-    glEnableVertexAttribArray (5);
-    glVertexAttribPointer (5, 1, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof (float) * 13));
-
-    // Velocity (location 6)
-    glEnableVertexAttribArray (6);
-    glVertexAttribPointer (6, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof (float) * 14));
-
-    glBindVertexArray (0);
-}
-
-void CParticle::renderSprites () {
-    if (m_particleCount == 0)
-        return;
-
-    // Count alive particles
-    uint32_t aliveCount = 0;
-    for (uint32_t i = 0; i < m_particleCount; i++) {
-        if (m_particles[i].alive) aliveCount++;
-    }
-
-    if (aliveCount == 0)
-        return;
-
-    const int segmentsPerParticle = m_useTrailRenderer ? m_trailSubdivision : 1;
-
-    uint32_t writtenVertexValues = 0;
-    uint32_t writtenIndexValues = 0;
-    uint32_t vertexIndex = 0; // Tracks total vertices written (not particles)
-    for (uint32_t i = 0; i < m_particleCount; i++) {
-        const auto& p = m_particles [i];
-        if (!p.alive)
-            continue;
-
-        // Skip particles with invalid values (NaN, infinity, or extreme size)
-        if (!std::isfinite(p.position.x) || !std::isfinite(p.position.y) || !std::isfinite(p.position.z) ||
-            !std::isfinite(p.rotation.x) || !std::isfinite(p.rotation.y) || !std::isfinite(p.rotation.z) ||
-            !std::isfinite(p.size) || p.size <= 0.0f || p.size > 10000.0f) {
-            continue;
-        }
-
-        // Particle size is already scaled by instance override, don't apply object scale
-        float size = p.size / 2.0f;
-
-        // For trail particles, generate multiple segments along velocity direction
-        if (m_useTrailRenderer && segmentsPerParticle >= 1) {
-            // Calculate trail parameters using 2D velocity (XY plane only for orthographic rendering)
-            glm::vec2 velocity2D = glm::vec2(p.velocity.x, p.velocity.y);
-            float speed = glm::length(velocity2D);
-
-            // Trail length is scaled by particle size to match normal particle rendering
-            float trailLength = speed > 0.001f ? std::max(0.0f, std::min(speed * m_trailLength, m_trailMaxLength)) : 0.0f;
-            trailLength *= size; // Scale trail length by particle size
-
-            // Compute trail directions
-            // trailDir: perpendicular to velocity - direction to march segments along (creates the trail shape)
-            // widthDir: along velocity direction - offset left/right to create ribbon width
-            glm::vec2 perpendicular2D = speed > 0.001f ? glm::vec2(velocity2D.y, -velocity2D.x) / speed : glm::vec2(1.0f, 0.0f);
-            glm::vec3 trailDir = glm::vec3(perpendicular2D, 0.0f);
-
-            glm::vec2 velocityDir2D = speed > 0.001f ? glm::normalize(velocity2D) : glm::vec2(0.0f, 1.0f);
-            glm::vec3 widthDir = glm::vec3(velocityDir2D, 0.0f);
-
-            // Generate ribbon strip: vertices alternate left/right along the trail
-            // Pre-compute actual positions on CPU (no shader transformation needed)
-            for (int seg = 0; seg <= segmentsPerParticle; seg++) {
-                // Position this vertex along the trail
-                // seg=0 is at particle position (head), seg=N is at the tail
-                float t = segmentsPerParticle > 0 ? static_cast<float>(seg) / static_cast<float>(segmentsPerParticle) : 0.0f;
-                glm::vec3 centerPos = p.position - trailDir * (trailLength * t);
-
-                // Alpha fade toward tail (but don't go to zero to avoid sudden disappearance)
-                float segmentAlpha = p.alpha * (1.0f - t * 0.5f); // Fade to 50% at tail
-
-                // V coordinate: 0 at head, 1 at tail (texture flows along trail)
-                float v = t;
-
-                // Compute actual left and right positions
-                // widthDir is along velocity, so make width scale with trailLength (velocity-based)
-                // This makes fast particles have long trails, slow particles have short trails
-                float velocityBasedWidth = trailLength;
-                glm::vec3 leftPos = centerPos - widthDir * velocityBasedWidth;
-                glm::vec3 rightPos = centerPos + widthDir * velocityBasedWidth;
-
-                // Left vertex (u=0)
-                m_vertices[writtenVertexValues++] = leftPos.x;
-                m_vertices[writtenVertexValues++] = leftPos.y;
-                m_vertices[writtenVertexValues++] = leftPos.z;
-                m_vertices[writtenVertexValues++] = 0.0f;  // u = 0 (left edge)
-                m_vertices[writtenVertexValues++] = v;     // v varies along trail
-                m_vertices[writtenVertexValues++] = 0.0f;  // No rotation for trail
-                m_vertices[writtenVertexValues++] = 0.0f;
-                m_vertices[writtenVertexValues++] = 0.0f;
-                m_vertices[writtenVertexValues++] = size;
-                m_vertices[writtenVertexValues++] = p.color.r;
-                m_vertices[writtenVertexValues++] = p.color.g;
-                m_vertices[writtenVertexValues++] = p.color.b;
-                m_vertices[writtenVertexValues++] = segmentAlpha;
-                m_vertices[writtenVertexValues++] = p.frame;
-                m_vertices[writtenVertexValues++] = 0.0f;  // Zero velocity to disable shader transformation
-                m_vertices[writtenVertexValues++] = 0.0f;
-                m_vertices[writtenVertexValues++] = 0.0f;
-
-                // Right vertex (u=1)
-                m_vertices[writtenVertexValues++] = rightPos.x;
-                m_vertices[writtenVertexValues++] = rightPos.y;
-                m_vertices[writtenVertexValues++] = rightPos.z;
-                m_vertices[writtenVertexValues++] = 1.0f;  // u = 1 (right edge)
-                m_vertices[writtenVertexValues++] = v;     // v varies along trail
-                m_vertices[writtenVertexValues++] = 0.0f;  // No rotation for trail
-                m_vertices[writtenVertexValues++] = 0.0f;
-                m_vertices[writtenVertexValues++] = 0.0f;
-                m_vertices[writtenVertexValues++] = size;
-                m_vertices[writtenVertexValues++] = p.color.r;
-                m_vertices[writtenVertexValues++] = p.color.g;
-                m_vertices[writtenVertexValues++] = p.color.b;
-                m_vertices[writtenVertexValues++] = segmentAlpha;
-                m_vertices[writtenVertexValues++] = p.frame;
-                m_vertices[writtenVertexValues++] = 0.0f;  // Zero velocity to disable shader transformation
-                m_vertices[writtenVertexValues++] = 0.0f;
-                m_vertices[writtenVertexValues++] = 0.0f;
-
-                // Create triangles connecting this segment to the previous one
-                if (seg > 0) {
-                    uint32_t base = vertexIndex + (seg - 1) * 2;
-                    // Triangle 1: [prevLeft, prevRight, currRight]
-                    m_indices[writtenIndexValues++] = base + 0;
-                    m_indices[writtenIndexValues++] = base + 1;
-                    m_indices[writtenIndexValues++] = base + 3;
-                    // Triangle 2: [prevLeft, currRight, currLeft]
-                    m_indices[writtenIndexValues++] = base + 0;
-                    m_indices[writtenIndexValues++] = base + 3;
-                    m_indices[writtenIndexValues++] = base + 2;
-                }
-            }
-
-            vertexIndex += (segmentsPerParticle + 1) * 2;
-        } else {
-            // Normal particle: single quad
-            auto addVertex = [&](float u, float v) {
-                m_vertices[writtenVertexValues++] = p.position.x;
-                m_vertices[writtenVertexValues++] = p.position.y;
-                m_vertices[writtenVertexValues++] = p.position.z;
-                m_vertices[writtenVertexValues++] = u;
-                m_vertices[writtenVertexValues++] = v;
-                m_vertices[writtenVertexValues++] = p.rotation.x;
-                m_vertices[writtenVertexValues++] = p.rotation.y;
-                m_vertices[writtenVertexValues++] = p.rotation.z;
-                m_vertices[writtenVertexValues++] = size;
-                m_vertices[writtenVertexValues++] = p.color.r;
-                m_vertices[writtenVertexValues++] = p.color.g;
-                m_vertices[writtenVertexValues++] = p.color.b;
-                m_vertices[writtenVertexValues++] = p.alpha;
-                m_vertices[writtenVertexValues++] = p.frame;
-                m_vertices[writtenVertexValues++] = p.velocity.x;
-                m_vertices[writtenVertexValues++] = p.velocity.y;
-                m_vertices[writtenVertexValues++] = p.velocity.z;
-            };
-
-            // 4 vertices for quad corners
-            uint32_t baseVertex = vertexIndex;
-            addVertex (0.0f, 1.0f);  // 0: Bottom-left
-            addVertex (1.0f, 1.0f);  // 1: Bottom-right
-            addVertex (1.0f, 0.0f);  // 2: Top-right
-            addVertex (0.0f, 0.0f);  // 3: Top-left
-
-            // 6 indices forming 2 triangles
-            m_indices[writtenIndexValues++] = baseVertex + 0;
-            m_indices[writtenIndexValues++] = baseVertex + 1;
-            m_indices[writtenIndexValues++] = baseVertex + 2;
-            m_indices[writtenIndexValues++] = baseVertex + 2;
-            m_indices[writtenIndexValues++] = baseVertex + 3;
-            m_indices[writtenIndexValues++] = baseVertex + 0;
-
-            vertexIndex += 4;
-        }
-    }
-
-    if (m_shaderProgram == 0) {
-        return;
-    }
-
-    // Clear any existing GL errors before we start
-    while (glGetError () != GL_NO_ERROR);
-
-    // Save current GL state before any modifications
-    GLint prevProgram = 0;
-    GLint prevVAO = 0;
-    GLint prevTexture = 0;
-    GLboolean prevBlendEnabled = glIsEnabled (GL_BLEND);
-    GLboolean prevDepthMask = GL_TRUE;
-    GLint prevBlendSrcRGB = GL_ONE;
-    GLint prevBlendDstRGB = GL_ZERO;
-    GLint prevBlendSrcAlpha = GL_ONE;
-    GLint prevBlendDstAlpha = GL_ZERO;
-    GLint prevActiveTexture = GL_TEXTURE0;
-    GLint prevArrayBuffer = 0;
-    glGetIntegerv (GL_CURRENT_PROGRAM, &prevProgram);
-    glGetIntegerv (GL_VERTEX_ARRAY_BINDING, &prevVAO);
-    glGetIntegerv (GL_TEXTURE_BINDING_2D, &prevTexture);
-    glGetBooleanv (GL_DEPTH_WRITEMASK, &prevDepthMask);
-    glGetIntegerv (GL_BLEND_SRC_RGB, &prevBlendSrcRGB);
-    glGetIntegerv (GL_BLEND_DST_RGB, &prevBlendDstRGB);
-    glGetIntegerv (GL_BLEND_SRC_ALPHA, &prevBlendSrcAlpha);
-    glGetIntegerv (GL_BLEND_DST_ALPHA, &prevBlendDstAlpha);
-    glGetIntegerv (GL_ACTIVE_TEXTURE, &prevActiveTexture);
-    glGetIntegerv (GL_ARRAY_BUFFER_BINDING, &prevArrayBuffer);
-
-    glBindBuffer (GL_ARRAY_BUFFER, m_vbo);
-    glBufferData (GL_ARRAY_BUFFER, writtenVertexValues * sizeof (float), m_vertices.data (), GL_DYNAMIC_DRAW);
-
-    glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-    glBufferData (GL_ELEMENT_ARRAY_BUFFER, writtenIndexValues * sizeof (uint32_t), m_indices.data (), GL_DYNAMIC_DRAW);
-
-    // Use particle shader
+    // Everything but the transform is fixed for the lifetime of the system, the program keeps the values
     glUseProgram (m_shaderProgram);
 
-    // Bind particle texture
     if (m_texture) {
-        glActiveTexture (GL_TEXTURE0);
-        glBindTexture (GL_TEXTURE_2D, m_texture->getTextureID (0));
-
-        // Set texture wrapping mode
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
         if (m_uniformTexture != -1) {
             glUniform1i (m_uniformTexture, 0);
         }
@@ -1737,58 +1693,259 @@ void CParticle::renderSprites () {
         glUniform1f (m_uniformTrailMaxLength, m_trailMaxLength);
     }
 
+    glUseProgram (0);
+}
+
+void CParticle::setupInstancedBuffers () {
+    // Per-instance data, advanced once per particle. Trails read their velocity where sprites have their rotation
+    const GLuint orientation = m_useTrailRenderer ? 6 : 2;
+
+    for (GLuint location : {0u, orientation, 3u, 4u, 5u}) {
+        glEnableVertexAttribArray (location);
+        glVertexAttribDivisor (location, 1);
+    }
+
+    // Trail ribbons work their corners out from gl_VertexID, only sprites need the static quad
+    if (m_useTrailRenderer) {
+        return;
+    }
+
+    // Corner texcoords, the vertex shader expands them around the instance position
+    const float quad [] = {
+        0.0f, 1.0f, // 0: Bottom-left
+        1.0f, 1.0f, // 1: Bottom-right
+        1.0f, 0.0f, // 2: Top-right
+        0.0f, 0.0f, // 3: Top-left
+    };
+    const uint32_t indices [] = {0, 1, 2, 2, 3, 0};
+
+    glGenBuffers (1, &m_quadVbo);
+    glGenBuffers (1, &m_ebo);
+    glBindBuffer (GL_ARRAY_BUFFER, m_quadVbo);
+    glBufferData (GL_ARRAY_BUFFER, sizeof (quad), quad, GL_STATIC_DRAW);
+
+    // Texture coordinates (location 1)
+    glEnableVertexAttribArray (1);
+    glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE, sizeof (float) * 2, (void*)0);
+
+    glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBufferData (GL_ELEMENT_ARRAY_BUFFER, sizeof (indices), indices, GL_STATIC_DRAW);
+}
+
+void CParticle::bindVertexAttributes (size_t offset) {
+    // The streaming buffer moves to a different region every frame so the pointers have to follow it
+    glBindBuffer (GL_ARRAY_BUFFER, m_vertexStream->getBuffer ());
+
+    // Instance format: pos(3) + rotation or velocity(3) + size(1) + color(4) + frame(1)
+    const int stride = sizeof (float) * PARTICLE_INSTANCE_FLOATS;
+    const GLuint orientation = m_useTrailRenderer ? 6 : 2;
+
+    glVertexAttribPointer (0, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset));
+    glVertexAttribPointer (orientation, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset + sizeof (float) * 3));
+    glVertexAttribPointer (3, 1, GL_FLOAT, GL_FALSE, stride, (void*)(offset + sizeof (float) * 6));
+    glVertexAttribPointer (4, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + sizeof (float) * 7));
+    glVertexAttribPointer (5, 1, GL_FLOAT, GL_FALSE, stride, (void*)(offset + sizeof (float) * 11));
+}
+
+bool CParticle::generateVertices (float* vertices, uint32_t& vertexValues) {
+    const uint32_t count = m_particles.getCount ();
+
+    if (count == 0)
+        return false;
+
+    const glm::mat4& transform = m_frameModelViewProjection;
+    // How far a unit offset from a particle can move it in clip space, sprites are expanded around their position
+    // before this transform so no corner gets further than this times its distance
+    const float reach = std::max ({
+        glm::length (glm::vec3 (transform [0][0], transform [1][0], transform [2][0])),
+        glm::length (glm::vec3 (transform [0][1], transform [1][1], transform [2][1])),
+        glm::length (glm::vec3 (transform [0][3], transform [1][3], transform [2][3])),
+    });
+
+    m_drawOrder.clear ();
+    m_sortKeys.clear ();
+
+    // Only particles the camera can see are expanded and uploaded
+    for (uint32_t i = 0; i < count; i++) {
+        if (!m_particles.alive [i])
+            continue;
+
+        const glm::vec3 position = m_interpolation < 1.0f
+            ? glm::mix (m_particles.previousPosition [i], m_particles.position [i], m_interpolation)
+            : m_particles.position [i];
+        const glm::vec3& rotation = m_particles.rotation [i];
+        const float particleSize = m_particles.size [i];
+
+        // Skip particles with invalid values (NaN, infinity, or extreme size)
+        if (!std::isfinite(position.x) || !std::isfinite(position.y) || !std::isfinite(position.z) ||
+            !std::isfinite(rotation.x) || !std::isfinite(rotation.y) || !std::isfinite(rotation.z) ||
+            !std::isfinite(particleSize) || particleSize <= 0.0f || particleSize > 10000.0f) {
+            continue;
+        }
+
+        float radius = particleSize / 2.0f * CULL_MARGIN;
+
+        // Trails stretch along their velocity, up to their maximum length
+        if (m_useTrailRenderer) {
+            const float speed = glm::length (glm::vec2 (m_particles.velocity [i]));
+
+            radius += std::min (speed * m_trailLength, m_trailMaxLength) * particleSize * CULL_MARGIN;
+        }
+
+        const glm::vec4 clip = transform * glm::vec4 (position, 1.0f);
+        const float extent = radius * reach;
+
+        if (clip.w + extent <= 0.0f || clip.x - extent > clip.w + extent || clip.x + extent < -clip.w - extent ||
+            clip.y - extent > clip.w + extent || clip.y + extent < -clip.w - extent) {
+            continue;
+        }
+
+        m_drawOrder.push_back (i);
+
+        // Farthest first, the keys sort ascending
+        if (m_depthSort)
+            m_sortKeys.push_back (~Particles::ParticleSort::floatKey (clip.z / std::max (clip.w, 1e-6f)));
+    }
+
+    if (m_drawOrder.empty ())
+        return false;
+
+    if (m_depthSort)
+        m_sort.sort (m_sortKeys, m_drawOrder);
+
+    // Trails are expanded into ribbons by the vertex shader, the record only needs what it builds them from
+    m_trailSegments = m_useTrailRenderer
+        ? std::max (1, static_cast<int> (std::lround (m_trailSubdivision * m_budgetScale)))
+        : 1;
+
+    uint32_t writtenVertexValues = 0;
+    for (const uint32_t i : m_drawOrder) {
+        const glm::vec3 position = m_interpolation < 1.0f
+            ? glm::mix (m_particles.previousPosition [i], m_particles.position [i], m_interpolation)
+            : m_particles.position [i];
+        // Trails have no rotation, they follow their velocity
+        const glm::vec3& orientation = m_useTrailRenderer ? m_particles.velocity [i] : m_particles.rotation [i];
+        const glm::vec3& color = m_particles.color [i];
+
+        // Particle size is already scaled by instance override, don't apply object scale
+        vertices[writtenVertexValues++] = position.x;
+        vertices[writtenVertexValues++] = position.y;
+        vertices[writtenVertexValues++] = position.z;
+        vertices[writtenVertexValues++] = orientation.x;
+        vertices[writtenVertexValues++] = orientation.y;
+        vertices[writtenVertexValues++] = orientation.z;
+        vertices[writtenVertexValues++] = m_particles.size [i] / 2.0f;
+        vertices[writtenVertexValues++] = color.r;
+        vertices[writtenVertexValues++] = color.g;
+        vertices[writtenVertexValues++] = color.b;
+        vertices[writtenVertexValues++] = m_particles.alpha [i];
+        vertices[writtenVertexValues++] = m_particles.frame [i];
+    }
+
+    vertexValues = writtenVertexValues;
+    return true;
+}
+
+glm::mat4 CParticle::getModelMatrix () const {
+    // Children are placed relative to their parent
+    if (m_parent) {
+        return m_parent->getModelMatrix () * m_childTransform;
+    }
+
+    if (!m_modelMatrixDirty) {
+        return m_modelMatrix;
+    }
+
     // Build model matrix from particle object transform
     glm::vec3 scale = m_particle.scale->value->getVec3 ();
     glm::vec3 angles = m_particle.angles->value->getVec3 ();
 
-    glm::mat4 model = glm::mat4 (1.0f);
-    model = glm::translate (model, m_transformedOrigin);
-    model = glm::rotate (model, glm::radians (angles.z), glm::vec3 (0, 0, 1));
-    model = glm::rotate (model, glm::radians (angles.y), glm::vec3 (0, 1, 0));
-    model = glm::rotate (model, glm::radians (angles.x), glm::vec3 (1, 0, 0));
-    model = glm::scale (model, scale);
+    m_modelMatrix = glm::mat4 (1.0f);
+    m_modelMatrix = glm::translate (m_modelMatrix, m_transformedOrigin);
+    m_modelMatrix = glm::rotate (m_modelMatrix, glm::radians (angles.z), glm::vec3 (0, 0, 1));
+    m_modelMatrix = glm::rotate (m_modelMatrix, glm::radians (angles.y), glm::vec3 (0, 1, 0));
+    m_modelMatrix = glm::rotate (m_modelMatrix, glm::radians (angles.x), glm::vec3 (1, 0, 0));
+    m_modelMatrix = glm::scale (m_modelMatrix, scale);
+    m_modelMatrixDirty = false;
+
+    return m_modelMatrix;
+}
+
+void CParticle::renderSprites () {
+    // Geometry was already written by prepare ()
+    const uint32_t writtenVertexValues = m_vertexValues;
+
+    if (m_shaderProgram == 0) {
+        return;
+    }
+
+    RenderState& state = getContext ().getRenderState ();
+    GPUProfiler::Scope profile (getContext ().getProfiler (), getProfilerEntry ());
+
+    if (!m_gpuSimulator) {
+        state.bindVertexArray (m_vao);
+        bindVertexAttributes (m_vertexStream->commit (writtenVertexValues * sizeof (float)));
+    }
+
+    // Use particle shader, the uniforms other than the transform and trail segments were set in setupUniforms
+    state.useProgram (m_shaderProgram);
 
-    // Apply camera transform
-    glm::mat4 mvp = getScene ().getCamera ().getProjection () * getScene ().getCamera ().getLookAt () * model;
-    GLint mvpLoc = glGetUniformLocation (m_shaderProgram, "g_ModelViewProjectionMatrix");
-    if (mvpLoc != -1) {
-        glUniformMatrix4fv (mvpLoc, 1, GL_FALSE, &mvp[0][0]);
+    // The segments follow the particle budget, they only change when it does
+    if (m_useTrailRenderer && m_uploadedTrailSegments != m_trailSegments) {
+        m_uploadedTrailSegments = m_trailSegments;
+
+        if (m_uniformTrailSegments != -1) {
+            glUniform1i (m_uniformTrailSegments, m_trailSegments);
+        }
+    }
+
+    // Bind particle texture
+    if (m_texture) {
+        // Sprites are clamped, the texture is shared with whatever else uses it so it's done in the sampler
+        state.bindTexture (0, m_texture->getTextureID (0), m_texture->getSampler (SamplerCache::Flags_Clamp));
+    }
+
+    // Apply camera transform, prepare () built it already to cull against. The program is this system's own so the
+    // uniform keeps its value until the transform changes
+    if (!m_modelViewProjectionUploaded || m_frameModelViewProjection != m_modelViewProjection) {
+        m_modelViewProjection = m_frameModelViewProjection;
+        m_modelViewProjectionUploaded = true;
+
+        if (m_uniformModelViewProjection != -1) {
+            glUniformMatrix4fv (m_uniformModelViewProjection, 1, GL_FALSE, &m_modelViewProjection[0][0]);
+        }
     }
 
     // Enable blending for particles
-    glEnable (GL_BLEND);
+    state.setBlending (true);
     // Apply blending mode from material
     switch (m_blendingMode) {
         case Data::Model::BlendingMode_Additive:
-            glBlendFunc (GL_SRC_ALPHA, GL_ONE);
+            state.setBlendFunc (GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE);
             break;
         case Data::Model::BlendingMode_Translucent:
-            glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            break;
         case Data::Model::BlendingMode_Normal:
         default:
-            glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            state.setBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             break;
     }
-    glDepthMask (GL_FALSE); // Don't write to depth buffer for transparent particles
+    state.setDepthMask (false); // Don't write to depth buffer for transparent particles
+
+    // One instance per visible particle, trails are expanded into ribbons by the vertex shader
+    if (m_gpuSimulator) {
+        m_gpuSimulator->draw (state);
+    } else if (m_useTrailRenderer) {
+        glDrawArraysInstanced (
+            GL_TRIANGLE_STRIP, 0, (m_trailSegments + 1) * 2, writtenVertexValues / PARTICLE_INSTANCE_FLOATS);
+    } else {
+        // Regular particles share the static quad indices uploaded in setupInstancedBuffers
+        glDrawElementsInstanced (
+            GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, writtenVertexValues / PARTICLE_INSTANCE_FLOATS);
+    }
 
-    // Render triangles using indexed rendering
-    // Use actual index count (accounts for trail segments and filtered particles)
-    glBindVertexArray (m_vao);
-    glDrawElements (GL_TRIANGLES, writtenIndexValues, GL_UNSIGNED_INT, nullptr);
-    glBindVertexArray (0);
+    getContext ().getStats ().addDraws (1);
 
-    // Restore state
-    glDepthMask (prevDepthMask);
-    glBlendFuncSeparate (prevBlendSrcRGB, prevBlendDstRGB, prevBlendSrcAlpha, prevBlendDstAlpha);
-    if (prevBlendEnabled) {
-        glEnable (GL_BLEND);
-    } else {
-        glDisable (GL_BLEND);
+    if (!m_gpuSimulator) {
+        m_vertexStream->fence ();
     }
-    glUseProgram (prevProgram);
-    glActiveTexture (prevActiveTexture);
-    glBindTexture (GL_TEXTURE_2D, prevTexture);
-    glBindBuffer (GL_ARRAY_BUFFER, prevArrayBuffer);
-    glBindVertexArray (prevVAO);
 }
@@ -3,12 +3,23 @@
 #include "WallpaperEngine/Render/CObject.h"
 #include "WallpaperEngine/Render/Wallpapers/CScene.h"
 #include "WallpaperEngine/Data/Model/Object.h"
-
+#include "WallpaperEngine/Render/Objects/Particles/GPUParticleSimulator.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticleEvents.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticleOperators.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticlePool.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticleRandom.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticleSort.h"
+#include "WallpaperEngine/Render/StreamingBuffer.h"
+
+#include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <vector>
-#include <random>
 #include <functional>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <ostream>
 
 using namespace WallpaperEngine;
 using namespace WallpaperEngine::Render;
@@ -17,78 +28,23 @@ using namespace WallpaperEngine::Data::Model;
 namespace WallpaperEngine::Render::Objects {
 
 constexpr uint32_t DEFAULT_MAX_PARTICLES = 1000;
+/** Step used to pre-warm systems that are simulated once per frame */
+constexpr float PREWARM_STEP = 1.0f / 30.0f;
 
-/**
- * Runtime particle instance state
- */
-struct ParticleInstance {
-    // Position and movement
-    glm::vec3 position {0.0f};
-    glm::vec3 velocity {0.0f};
-    glm::vec3 acceleration {0.0f};
-
-    // Rotation
-    glm::vec3 rotation {0.0f};
-    glm::vec3 angularVelocity {0.0f};
-    glm::vec3 angularAcceleration {0.0f};
-
-    // Visual properties
-    glm::vec3 color {1.0f};
-    float alpha {1.0f};
-    float size {20.0f};
-    float frame {0.0f};         // Current animation frame
-
-    // Lifetime
-    float lifetime {1.0f};      // Total lifetime in seconds
-    float age {0.0f};           // Current age in seconds
-
-    // Turbulent velocity state
-    glm::vec3 noisePos {0.0f};  // Position in noise field for turbulent velocity
-
-    // Initial values for resets/multipliers
-    struct {
-        glm::vec3 color {1.0f};
-        float alpha {1.0f};
-        float size {20.0f};
-        float lifetime {1.0f};
-    } initial;
-
-    bool alive {false};
-
-    // Get normalized lifetime position (0.0 to 1.0)
-    float getLifetimePos () const {
-        return lifetime > 0.0f ? (age / lifetime) : 1.0f;
-    }
-
-    bool isAlive () const {
-        return alive && age < lifetime;
-    }
-};
+using Particles::ControlPointData;
+using Particles::ParticleOperator;
+using Particles::ParticlePool;
 
 /**
- * Control point runtime data
+ * Particle emitter function, a burst ignores the emission rate and fires the instantaneous count (at least one
+ * particle) again, used by children that emit on their parent's events
  */
-struct ControlPointData {
-    glm::vec3 position {0.0f};
-    glm::vec3 offset {0.0f};
-    bool linkMouse {false};
-    bool worldSpace {false};
-};
+using EmitterFunc = std::function<void(ParticlePool&, float, bool)>;
 
 /**
- * Particle emitter function
+ * Particle initializer function, receives the index of the freshly spawned particle
  */
-using EmitterFunc = std::function<void(std::vector<ParticleInstance>&, uint32_t&, float)>;
-
-/**
- * Particle initializer function
- */
-using InitializerFunc = std::function<void(ParticleInstance&)>;
-
-/**
- * Particle operator function
- */
-using OperatorFunc = std::function<void(std::vector<ParticleInstance>&, uint32_t, const std::vector<ControlPointData>&, float, float)>;
+using InitializerFunc = std::function<void(ParticlePool&, uint32_t)>;
 
 class CParticle final : public CObject {
     friend CObject;
@@ -98,15 +54,67 @@ class CParticle final : public CObject {
     ~CParticle ();
 
     void setup ();
+    /**
+     * Grabs this frame's geometry storage, has to run on the render thread before prepare ()
+     */
+    void beginFrame ();
+    /**
+     * Simulates the system and writes this frame's geometry, doesn't touch any GL state so it can run on any thread
+     */
+    void prepare ();
     void render () override;
     void update (float dt);
 
+    /**
+     * Fast-forwards the simulation so the system doesn't start empty, doesn't touch any GL state
+     * so it can run on any thread
+     *
+     * @param seconds
+     */
+    void prewarm (float seconds);
+    /**
+     * @return If the particles are simulated on the CPU, the only ones prewarm () and the state methods handle
+     */
+    [[nodiscard]] bool canPrewarm () const;
+    /**
+     * Writes the particles of this system and its children
+     *
+     * @param out
+     */
+    void writeState (std::ostream& out) const;
+    /**
+     * Restores the particles written by writeState (), the system is left empty if they don't match it
+     *
+     * @param in
+     *
+     * @return If the state was restored
+     */
+    bool readState (std::istream& in);
+    /**
+     * Kills every particle of this system and its children
+     */
+    void clearState ();
+
+    /**
+     * Scales emission rate, particle limit and trail subdivision, used to keep the scene within its particle budget
+     *
+     * @param scale Fraction of the authored values to use
+     */
+    void setBudgetScale (float scale);
+
     [[nodiscard]] const Particle& getParticle () const;
+    [[nodiscard]] uint32_t getAliveCount () const;
+    /**
+     * @param textures Receives the material texture of this system and its children
+     */
+    void getTextures (std::vector<std::shared_ptr<const TextureProvider>>& textures) const;
 
   protected:
     void setupEmitters ();
     void setupInitializers ();
     void setupOperators ();
+    void setupGPUSimulation ();
+    void setupChildren ();
 
     // Emitter creators
     EmitterFunc createBoxEmitter (const ParticleEmitter& emitter);
@@ -124,45 +132,93 @@ class CParticle final : public CObject {
     InitializerFunc createMapSequenceAroundControlPointInitializer (const MapSequenceAroundControlPointInitializer& init);
 
     // Operator creators
-    OperatorFunc createMovementOperator (const MovementOperator& op);
-    OperatorFunc createAngularMovementOperator (const AngularMovementOperator& op);
-    OperatorFunc createAlphaFadeOperator (const AlphaFadeOperator& op);
-    OperatorFunc createSizeChangeOperator (const SizeChangeOperator& op);
-    OperatorFunc createAlphaChangeOperator (const AlphaChangeOperator& op);
-    OperatorFunc createColorChangeOperator (const ColorChangeOperator& op);
-    OperatorFunc createTurbulenceOperator (const TurbulenceOperator& op);
-    OperatorFunc createVortexOperator (const VortexOperator& op);
-    OperatorFunc createControlPointAttractOperator (const ControlPointAttractOperator& op);
+    ParticleOperator createMovementOperator (const MovementOperator& op);
+    ParticleOperator createAngularMovementOperator (const AngularMovementOperator& op);
+    ParticleOperator createAlphaFadeOperator (const AlphaFadeOperator& op);
+    ParticleOperator createSizeChangeOperator (const SizeChangeOperator& op);
+    ParticleOperator createAlphaChangeOperator (const AlphaChangeOperator& op);
+    ParticleOperator createColorChangeOperator (const ColorChangeOperator& op);
+    ParticleOperator createTurbulenceOperator (const TurbulenceOperator& op);
+    ParticleOperator createVortexOperator (const VortexOperator& op);
+    ParticleOperator createControlPointAttractOperator (const ControlPointAttractOperator& op);
 
     // Rendering
     void renderSprites ();
+    bool generateVertices (float* vertices, uint32_t& vertexValues);
     void setupBuffers ();
+    void setupUniforms ();
+    void setupInstancedBuffers ();
+    void bindVertexAttributes (size_t offset);
+    void updateAnimationFrames ();
+    void prepareGeometry ();
+    void renderChildren ();
+    [[nodiscard]] glm::mat4 getModelMatrix () const;
+
+    // Control points and child systems
+    void updateControlPoints ();
+    void updateChildren (float dt);
+    /**
+     * Runs the emitters once per position, moving what they spawn there
+     *
+     * @param positions Positions in the parent's space
+     * @param count
+     * @param dt
+     * @param burst Fire the instantaneous count once per position instead of emitting at the regular rate
+     */
+    void emitAt (const glm::vec3* positions, uint32_t count, float dt, bool burst);
 
   private:
+    enum class ChildType {
+        /** always emitting, attached to the parent */
+        Static,
+        /** bursts wherever the parent emits a particle */
+        EventSpawn,
+        /** bursts wherever a particle of the parent dies */
+        EventDeath,
+        /** emits continuously from the parent's particles */
+        EventFollow,
+    };
+
+    /**
+     * Builds a child system, it lives inside its parent and simulates every instance the parent triggers in one pool
+     */
+    CParticle (CParticle& parent, const ParticleChild& child);
+
     const Particle& m_particle;
 
-    std::vector<ParticleInstance> m_particles;
-    uint32_t m_particleCount {0};
+    ParticlePool m_particles;
     uint32_t m_maxParticles {DEFAULT_MAX_PARTICLES};
+    float m_budgetScale {1.0f};
 
     std::vector<EmitterFunc> m_emitters;
     std::vector<InitializerFunc> m_initializers;
-    std::vector<OperatorFunc> m_operators;
+    Particles::OperatorPipeline m_operators;
+    /** set when the system is simulated on the GPU, m_particles then only holds the particles spawned this frame */
+    std::unique_ptr<Particles::GPUParticleSimulator> m_gpuSimulator {nullptr};
 
     std::vector<ControlPointData> m_controlPoints;
 
-    std::vector<float> m_vertices;
-    std::vector<uint32_t> m_indices;
-
+    /** simulation time, advances by the simulated steps */
     double m_time {0.0};
+    double m_lastFrameTime {0.0};
+    /** length of a simulation step, 0 steps once per frame with the frame's delta */
+    float m_fixedStep {0.0f};
+    /** simulation time not yet stepped */
+    float m_accumulator {0.0f};
+    /** how far the frame is between the previous and the current step */
+    float m_interpolation {1.0f};
 
     // OpenGL buffers
     GLuint m_vao {0};
-    GLuint m_vbo {0};
-    GLuint m_ebo {0}; // Element Buffer Object for indexed rendering
+    GLuint m_ebo {0}; // Static quad indices for instanced rendering
+    GLuint m_quadVbo {0}; // Static quad corners shared by every particle instance
+    // Per-instance data, for trails and regular particles alike
+    std::unique_ptr<StreamingBuffer> m_vertexStream {nullptr};
+    float* m_mappedVertices {nullptr};
     GLuint m_shaderProgram {0};
 
     // Cached uniform locations
+    GLint m_uniformModelViewProjection {-1};
     GLint m_uniformTexture {-1};
     GLint m_uniformHasTexture {-1};
     GLint m_uniformTextureFormat {-1};
@@ -171,6 +227,7 @@ class CParticle final : public CObject {
     GLint m_uniformUseTrailRenderer {-1};
     GLint m_uniformTrailLength {-1};
     GLint m_uniformTrailMaxLength {-1};
+    GLint m_uniformTrailSegments {-1};
     GLint m_uniformTextureRatio {-1};
 
     // Particle material texture
@@ -184,6 +241,16 @@ class CParticle final : public CObject {
     int m_spritesheetFrames {0};
     float m_spritesheetDuration {1.0f};
 
+    // Animation settings resolved at setup so the per-particle loop doesn't compare strings
+    enum class AnimationMode {
+        Loop,
+        Once,
+        RandomFrame,
+    };
+
+    AnimationMode m_animationMode {AnimationMode::Loop};
+    float m_animationSpeed {1.0f};
+
     // Material shader constants
     float m_overbright {1.0f};  // Brightness multiplier for additive particles
 
@@ -192,6 +259,8 @@ class CParticle final : public CObject {
     float m_trailLength {0.05f};
     float m_trailMaxLength {10.0f};
     int m_trailSubdivision {3}; // Number of segments per trail
+    int m_trailSegments {1}; // Segments drawn this frame, fewer than the subdivision when over the particle budget
+    int m_uploadedTrailSegments {0};
 
     // Transformed origin (screen space to centered space conversion)
     glm::vec3 m_transformedOrigin {0.0f};
@@ -201,10 +270,53 @@ class CParticle final : public CObject {
     float m_lastScreenHeight {0.0f};
 
     // Random number generator
-    std::mt19937 m_rng;
+    Particles::ParticleRandom m_rng;
+
+    // Mouse linked control points are only recomputed when the mouse or the system moves
+    std::optional<glm::vec2> m_lastMousePosition {std::nullopt};
+    uint32_t m_controlPointsVersion {0};
+
+    // Child systems, each one simulates all its instances in a single pool fed by this system's events
+    std::vector<std::unique_ptr<CParticle>> m_children;
+    Particles::ParticleEvents m_events;
+    bool m_needsSpawnEvents {false};
+    bool m_needsDeathEvents {false};
+
+    // Set when this is the child of another system
+    CParticle* m_parent {nullptr};
+    const ParticleChild* m_child {nullptr};
+    ChildType m_childType {ChildType::Static};
+    /** child origin, angles and scale relative to the parent, and its inverse to bring parent positions over */
+    glm::mat4 m_childTransform {1.0f};
+    glm::mat4 m_childInverse {1.0f};
+
+    /** Object transform, only rebuilt by getModelMatrix () after the origin, scale or angles changed */
+    mutable glm::mat4 m_modelMatrix {1.0f};
+    mutable bool m_modelMatrixDirty {true};
+    /** Camera and model transform of the frame being prepared, particles are culled against it */
+    glm::mat4 m_frameModelViewProjection {1.0f};
+    /** Camera and model transform last uploaded to the sprite shader */
+    glm::mat4 m_modelViewProjection {1.0f};
+    bool m_modelViewProjectionUploaded {false};
+    /** Live particles the camera can see, in the order they're drawn. Kept between frames so it doesn't allocate */
+    std::vector<uint32_t> m_drawOrder;
+    /** Depth of every particle in m_drawOrder, only filled when sorting */
+    std::vector<uint32_t> m_sortKeys;
+    Particles::ParticleSort m_sort;
+    /** If the particles are drawn back to front, only for blending modes where the order shows */
+    bool m_depthSort {false};
+    /** Deregister the listeners that mark the model matrix dirty */
+    std::vector<std::function<void ()>> m_transformListeners;
+    uint32_t m_parentControlPointsVersion {~0u};
 
     bool m_initialized {false};
 
+    // Frame state handed from prepare () to render ()
+    bool m_prepared {false};
+    bool m_hasGeometry {false};
+    float m_frameDt {0.0f};
+    uint32_t m_vertexValues {0};
+
     // Helper methods
     GLuint compileShader (GLenum type, const char* source);
     GLuint createShaderProgram ();
@@ -14,20 +14,21 @@ CSound::CSound (Wallpapers::CScene& scene, const Sound& sound) :
 }
 
 CSound::~CSound() {
-    // free all the sound buffers and streams
+    // free all the sound buffers and streams once nothing plays or decodes them anymore
     for (const auto& stream : this->m_audioStreams) {
+        this->getScene ().getAudioContext ().removeStream (stream);
         delete stream;
     }
 }
 
 void CSound::load () {
     for (const auto& cur : this->m_sound.sounds) {
-        auto stream = new Audio::AudioStream (
-            this->getScene ().getAudioContext (),
-            this->getAssetLocator ().read (cur)
-        );
+        // short sounds are decoded once and shared with every other object playing them
+        auto stream = this->getScene ().getAudioContext ().createStream (
+            &this->getAssetLocator (), cur, this->getAssetLocator ().read (cur));
 
         stream->setRepeat (this->m_sound.playbackmode.has_value() && this->m_sound.playbackmode == "loop");
+        stream->setVolume (this->m_sound.volume);
 
         this->m_audioStreams.push_back (stream);
 
@@ -1,21 +1,24 @@
 #include "CPass.h"
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <regex>
 #include <sstream>
 #include <utility>
 
 #include "WallpaperEngine/Render/Helpers/ContextAware.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
 
 #include "WallpaperEngine/Data/Model/Effect.h"
 #include "WallpaperEngine/Data/Model/Material.h"
 
 #include "WallpaperEngine/Render/Objects/CImage.h"
 #include "WallpaperEngine/Render/CFBO.h"
+#include "WallpaperEngine/Render/FrameUniforms.h"
+#include "WallpaperEngine/Render/RenderContext.h"
 
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariable.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableFloat.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableInteger.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableVector2.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableVector3.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableVector4.h"
 
 #include "WallpaperEngine/Logging/Log.h"
 
@@ -23,7 +26,7 @@ using namespace WallpaperEngine;
 using namespace WallpaperEngine::Render;
 using namespace WallpaperEngine::Render::Objects;
 
-using namespace WallpaperEngine::Render::Shaders::Variables;
+using namespace WallpaperEngine::Render::Shaders;
 using namespace WallpaperEngine::Render::Objects::Effects;
 
 extern float g_Time;
@@ -31,6 +34,91 @@ extern float g_Daytime;
 
 const TextureMap DEFAULT_BINDS = {};
 const ImageEffectPassOverride DEFAULT_OVERRIDE = {};
+const glm::vec2 NO_PARALLAX = {0.0f, 0.0f};
+
+namespace {
+/** uniforms setupUniforms () fills in besides the textures' */
+const std::set<std::string> ENGINE_UNIFORMS = {
+    "g_LightAmbientColor", "g_LightSkylightColor", "g_Brightness", "g_UserAlpha", "g_Alpha", "g_Color", "g_Color4",
+    "g_CompositeColor", "g_NormalModelMatrix", "g_EffectTextureProjectionMatrix",
+    "g_EffectTextureProjectionMatrixInverse", "g_TexelSize", "g_TexelSizeHalf",
+};
+
+/**
+ * @return If the engine sets the uniform itself, over whatever constant a material gives it
+ */
+bool isEngineUniform (const std::string& name) {
+    return ENGINE_UNIFORMS.contains (name) || name.starts_with ("g_Texture");
+}
+
+/**
+ * @return The value as a GLSL constructor of the declared type, empty if it can't be written as one
+ */
+std::string literal (const std::string& type, const ShaderParameters::Type kind, const DynamicValue& value) {
+    std::ostringstream out;
+    float components [4] = {};
+    int count = 0;
+
+    out.imbue (std::locale::classic ());
+    out << std::setprecision (std::numeric_limits<float>::max_digits10);
+
+    switch (kind) {
+        case ShaderParameters::Integer: out << type << " (" << value.getInt () << ")"; return out.str ();
+        case ShaderParameters::Float: components [0] = value.getFloat (); count = 1; break;
+        case ShaderParameters::Vector2: {
+            const glm::vec2 vector = value.getVec2 ();
+            memcpy (components, glm::value_ptr (vector), sizeof (vector));
+            count = 2;
+            break;
+        }
+        case ShaderParameters::Vector3: {
+            const glm::vec3 vector = value.getVec3 ();
+            memcpy (components, glm::value_ptr (vector), sizeof (vector));
+            count = 3;
+            break;
+        }
+        case ShaderParameters::Vector4: {
+            const glm::vec4 vector = value.getVec4 ();
+            memcpy (components, glm::value_ptr (vector), sizeof (vector));
+            count = 4;
+            break;
+        }
+    }
+
+    out << type << " (";
+
+    for (int i = 0; i < count; i++) {
+        if (!std::isfinite (components [i]))
+            return {};
+
+        out << (i == 0 ? "" : ", ") << components [i];
+    }
+
+    out << ")";
+
+    return out.str ();
+}
+
+/**
+ * Turns the uniform declaration of the parameter into a constant, sources that don't declare it stay the same
+ */
+void bake (std::string& source, const ShaderParameters::Parameter& parameter, const DynamicValue& value) {
+    const std::string& name = parameter.name.str ();
+    const std::regex declaration ("uniform\\s+(\\w+)\\s+" + name + "\\s*;");
+    std::smatch match;
+
+    if (!std::regex_search (source, match, declaration))
+        return;
+
+    const std::string constant = literal (match [1].str (), parameter.type, value);
+
+    if (constant.empty ())
+        return;
+
+    source.replace (
+        match.position (0), match.length (0), "const " + match [1].str () + " " + name + " = " + constant + ";");
+}
+} // namespace
 
 CPass::CPass (
     CImage& image, std::shared_ptr<const FBOProvider> fboProvider, const MaterialPass& pass,
@@ -45,11 +133,25 @@ CPass::CPass (
     m_binds (binds.has_value () ? binds.value ().get () : DEFAULT_BINDS),
     m_override (override.has_value () ? override.value ().get () : DEFAULT_OVERRIDE),
     m_target (target),
-    m_blendingmode (pass.blending) {
-    this->setupShaders ();
+    m_blendingmode (pass.blending),
+    m_parallaxDepth (&NO_PARALLAX) {}
+
+CPass::~CPass () {
+    for (const auto& deregister : this->m_propertyListeners)
+        deregister ();
+
+    if (this->m_program == nullptr)
+        return;
+
+    // another pass could end up at the same address, don't let it think its uniforms are still there
+    if (this->m_program->lastUser == this)
+        this->m_program->lastUser = nullptr;
+
+    // removed passes give their program back so it's gone once no other pass shares it
+    this->getContext ().getProgramCache ().release (*this->m_program);
 }
 
-std::shared_ptr<const TextureProvider> CPass::resolveTexture (std::shared_ptr<const TextureProvider> expected, int index, std::shared_ptr<const TextureProvider> previous) {
+std::shared_ptr<const TextureProvider> CPass::resolveTexture (std::shared_ptr<const TextureProvider> expected, int index, std::shared_ptr<const TextureProvider> previous) const {
     if (expected == nullptr) {
         if (const auto it = this->m_fbos.find (index); it != this->m_fbos.end ())
             expected = it->second;
@@ -66,81 +168,70 @@ std::shared_ptr<const TextureProvider> CPass::resolveTexture (std::shared_ptr<co
         return previous ?: expected;
 
     // the bind actually has a name, search the FBO in the effect and return it
-    return this->resolveFBO (it->second);
+    return this->resolveFBO (Symbol (it->second));
 }
 
-std::shared_ptr<const CFBO> CPass::resolveFBO (const std::string& name) const {
+std::shared_ptr<const CFBO> CPass::resolveFBO (const Symbol name) const {
     auto fbo = this->m_fboProvider->find (name);
 
     if (fbo == nullptr) {
-        sLog.exception ("Tried to resolve and FBO without any luck: ", name);
+        sLog.exception ("Tried to resolve and FBO without any luck: ", name.str ());
     }
 
     return fbo;
 }
 
 void CPass::setupRenderFramebuffer () const {
-    // set the framebuffer we're drawing to
-    glBindFramebuffer (GL_FRAMEBUFFER, this->m_drawTo->getFramebuffer ());
+    if (this->m_directOutput != nullptr) {
+        constexpr GLfloat opaque [] = {0.0f, 0.0f, 0.0f, 1.0f};
+        const auto& viewport = this->m_directOutput->viewport;
+
+        glBindFramebuffer (GL_FRAMEBUFFER, this->m_directOutput->framebuffer);
+        glViewport (viewport.x, viewport.y, viewport.z, viewport.w);
 
-    // set proper viewport based on what we're drawing to
-    glViewport (0, 0, this->m_drawTo->getRealWidth (), this->m_drawTo->getRealHeight ());
+        // the layer doesn't write alpha, the copy used to bring the scene's opaque one along
+        glColorMask (true, true, true, true);
+        glClearBufferfv (GL_COLOR, 0, opaque);
+        glColorMask (true, true, true, false);
+    } else {
+        // set the framebuffer we're drawing to
+        glBindFramebuffer (GL_FRAMEBUFFER, this->m_drawTo->getFramebuffer ());
+
+        // set proper viewport based on what we're drawing to
+        glViewport (0, 0, this->m_drawTo->getRealWidth (), this->m_drawTo->getRealHeight ());
+    }
+
+    RenderState& state = this->getContext ().getRenderState ();
 
     // set texture blending
     switch (this->getBlendingMode ()) {
         case BlendingMode_Translucent:
-            glEnable (GL_BLEND);
-            glBlendFuncSeparate (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            state.setBlending (true);
+            state.setBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             break;
         case BlendingMode_Additive:
-            glEnable (GL_BLEND);
-            glBlendFuncSeparate (GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE);
+            state.setBlending (true);
+            state.setBlendFunc (GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE);
             break;
         case BlendingMode_Normal:
-            glEnable (GL_BLEND);
-            glBlendFuncSeparate (GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
-            break;
-        default:
-        glDisable (GL_BLEND);
+            state.setBlending (true);
+            state.setBlendFunc (GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
             break;
-    }
-
-    switch (this->m_pass.depthtest) {
-        case DepthtestMode_Enabled:
-            glEnable (GL_DEPTH_TEST);
-            break;
-        case DepthtestMode_Disabled:
-        default:
-            glDisable (GL_DEPTH_TEST);
-            break;
-    }
-
-    switch (this->m_pass.cullmode) {
-        case CullingMode_Normal:
-            glEnable (GL_CULL_FACE);
-            break;
-
-        case CullingMode_Disable:
         default:
-            glDisable (GL_CULL_FACE);
+            state.setBlending (false);
             break;
     }
 
-    switch (this->m_pass.depthwrite) {
-        case DepthwriteMode_Enabled:
-            glDepthMask (true);
-            break;
-
-        case DepthwriteMode_Disabled:
-        default:
-            glDepthMask (false);
-            break;
-    }
+    state.setDepthTest (this->m_pass.depthtest == DepthtestMode_Enabled);
+    state.setCullFace (this->m_pass.cullmode == CullingMode_Normal);
+    state.setDepthMask (this->m_pass.depthwrite == DepthwriteMode_Enabled);
 }
 
 void CPass::setupRenderTexture () {
+    RenderState& state = this->getContext ().getRenderState ();
+
     // use the shader we have registered
-    glUseProgram (this->m_programID);
+    state.useProgram (this->m_programID);
 
     // maybe we can do this when setting the texture?
     auto texture = this->resolveTexture (this->m_input, 0, this->m_input);
@@ -151,31 +242,32 @@ void CPass::setupRenderTexture () {
 
     if (texture->isAnimated ()) {
         // calculate current texture and frame
-        double currentRenderTime = fmod (static_cast<double> (this->getContext ().getDriver ().getRenderTime ()),
-                                         this->m_image.getAnimationTime ());
+        const double currentRenderTime = fmod (static_cast<double> (this->getContext ().getDriver ().getRenderTime ()),
+                                               this->m_image.getAnimationTime ());
 
-        for (const auto& frameCur : texture->getFrames ()) {
-            currentRenderTime -= frameCur->frametime;
+        if (const auto frameCur = texture->getFrameAt (currentRenderTime); frameCur != nullptr) {
+            // frame found, store coordinates
+            currentTexture = frameCur->frameNumber;
 
-            if (currentRenderTime <= 0.0f) {
-                // frame found, store coordinates and done
-                currentTexture = frameCur->frameNumber;
+            translation.x = frameCur->x / texture->getTextureWidth (currentTexture);
+            translation.y = frameCur->y / texture->getTextureHeight (currentTexture);
 
-                translation.x = frameCur->x / texture->getTextureWidth (currentTexture);
-                translation.y = frameCur->y / texture->getTextureHeight (currentTexture);
+            rotation.x = frameCur->width1 / static_cast<float> (texture->getTextureWidth (currentTexture));
+            rotation.y = frameCur->width2 / static_cast<float> (texture->getTextureWidth (currentTexture));
+            rotation.z = frameCur->height2 / static_cast<float> (texture->getTextureHeight (currentTexture));
+            rotation.w = frameCur->height1 / static_cast<float> (texture->getTextureHeight (currentTexture));
 
-                rotation.x = frameCur->width1 / static_cast<float> (texture->getTextureWidth (currentTexture));
-                rotation.y = frameCur->width2 / static_cast<float> (texture->getTextureWidth (currentTexture));
-                rotation.z = frameCur->height2 / static_cast<float> (texture->getTextureHeight (currentTexture));
-                rotation.w = frameCur->height1 / static_cast<float> (texture->getTextureHeight (currentTexture));
-                break;
-            }
+            // the image may only be a band of the actual texture
+            const glm::vec2 mapping = texture->getImageMapping (currentTexture);
+
+            translation.y = translation.y * mapping.x + mapping.y;
+            rotation.y *= mapping.x;
+            rotation.w *= mapping.x;
         }
     }
 
     // first texture is a bit special as we have to take what comes from the chain first
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture (GL_TEXTURE_2D, texture->getTextureID (currentTexture));
+    state.bindTexture (0, texture->getTextureID (currentTexture), texture->getSampler ());
 
     // continue on the map from the second texture
     if (!this->m_textures.empty ()) {
@@ -186,8 +278,7 @@ void CPass::setupRenderTexture () {
                 texture = expectedTexture;
             }
 
-            glActiveTexture (GL_TEXTURE0 + index);
-            glBindTexture (GL_TEXTURE_2D, texture->getTextureID (0));
+            state.bindTexture (index, texture->getTextureID (0), texture->getSampler ());
         }
     }
 
@@ -202,106 +293,247 @@ void CPass::setupRenderTexture () {
 
 void CPass::setupRenderReferenceUniforms () {
     // add reference uniforms
-    for (const auto& value : this->m_referenceUniforms | std::views::values) {
-        switch (value->type) {
-            case Double: glUniform1d (value->id, *static_cast<const double*> (*value->value)); break;
-            case Float: glUniform1f (value->id, *static_cast<const float*> (*value->value)); break;
-            case Integer: glUniform1i (value->id, *static_cast<const int*> (*value->value)); break;
+    for (const auto& value : this->m_referenceUniforms) {
+        switch (value.type) {
+            case Double: glUniform1d (value.id, *static_cast<const double*> (*value.value)); break;
+            case Float: glUniform1f (value.id, *static_cast<const float*> (*value.value)); break;
+            case Integer: glUniform1i (value.id, *static_cast<const int*> (*value.value)); break;
             case Vector4:
-                glUniform4fv (value->id, 1, glm::value_ptr (*static_cast<const glm::vec4*> (*value->value)));
+                glUniform4fv (value.id, 1, glm::value_ptr (*static_cast<const glm::vec4*> (*value.value)));
                 break;
             case Vector3:
-                glUniform3fv (value->id, 1, glm::value_ptr (*static_cast<const glm::vec3*> (*value->value)));
+                glUniform3fv (value.id, 1, glm::value_ptr (*static_cast<const glm::vec3*> (*value.value)));
                 break;
             case Vector2:
-                glUniform2fv (value->id, 1, glm::value_ptr (*static_cast<const glm::vec2*> (*value->value)));
+                glUniform2fv (value.id, 1, glm::value_ptr (*static_cast<const glm::vec2*> (*value.value)));
                 break;
             case Matrix4:
-                glUniformMatrix4fv (value->id, 1, GL_FALSE,
-                                    glm::value_ptr (*static_cast<const glm::mat4*> (*value->value)));
+                glUniformMatrix4fv (value.id, 1, GL_FALSE,
+                                    glm::value_ptr (*static_cast<const glm::mat4*> (*value.value)));
                 break;
             case Matrix3:
-                glUniformMatrix3fv (value->id, 1, GL_FALSE,
-                                    glm::value_ptr (*static_cast<const glm::mat3*> (*value->value)));
+                glUniformMatrix3fv (value.id, 1, GL_FALSE,
+                                    glm::value_ptr (*static_cast<const glm::mat3*> (*value.value)));
                 break;
         }
     }
 }
 
 void CPass::setupRenderUniforms () {
+    // constants stay in the program from one frame to the next, unless another pass sharing it set its own since
+    const bool uploadConstants = !this->m_constantsUploaded || this->m_program->lastUser != this;
+
+    this->m_program->lastUser = this;
+
     // add uniforms
-    for (const auto& value : this->m_uniforms | std::views::values) {
-        switch (value->type) {
-            case Double: glUniform1dv (value->id, value->count, static_cast<const double*> (value->value)); break;
-            case Float: glUniform1fv (value->id, value->count, static_cast<const float*> (value->value)); break;
-            case Integer: glUniform1iv (value->id, value->count, static_cast<const int*> (value->value)); break;
+    for (const auto& value : this->m_uniforms) {
+        if (value.id == -1 || (value.constant && !uploadConstants))
+            continue;
+
+        const void* data = value.data ();
+
+        switch (value.type) {
+            case Double: glUniform1dv (value.id, value.count, static_cast<const double*> (data)); break;
+            case Float: glUniform1fv (value.id, value.count, static_cast<const float*> (data)); break;
+            case Integer: glUniform1iv (value.id, value.count, static_cast<const int*> (data)); break;
             // TODO: THESE MIGHT NEED SPECIAL TREATMENT? IDK ONLY SUPPORT 1 FOR NOW
             case Vector4:
-                glUniform4fv (value->id, 1, glm::value_ptr (*static_cast<const glm::vec4*> (value->value)));
+                glUniform4fv (value.id, 1, glm::value_ptr (*static_cast<const glm::vec4*> (data)));
                 break;
             case Vector3:
-                glUniform3fv (value->id, 1, glm::value_ptr (*static_cast<const glm::vec3*> (value->value)));
+                glUniform3fv (value.id, 1, glm::value_ptr (*static_cast<const glm::vec3*> (data)));
                 break;
             case Vector2:
-                glUniform2fv (value->id, 1, glm::value_ptr (*static_cast<const glm::vec2*> (value->value)));
+                glUniform2fv (value.id, 1, glm::value_ptr (*static_cast<const glm::vec2*> (data)));
                 break;
             case Matrix4:
-                glUniformMatrix4fv (value->id, 1, GL_FALSE,
-                                    glm::value_ptr (*static_cast<const glm::mat4*> (value->value)));
+                glUniformMatrix4fv (value.id, 1, GL_FALSE,
+                                    glm::value_ptr (*static_cast<const glm::mat4*> (data)));
                 break;
             case Matrix3:
-                glUniformMatrix3fv (value->id, 1, GL_FALSE,
-                                    glm::value_ptr (*static_cast<const glm::mat3*> (value->value)));
+                glUniformMatrix3fv (value.id, 1, GL_FALSE,
+                                    glm::value_ptr (*static_cast<const glm::mat3*> (data)));
                 break;
         }
     }
+
+    this->m_constantsUploaded = true;
 }
 
 void CPass::setupRenderAttributes () const {
+    // other draws (particles) may have left their own vertex array bound
+    this->getContext ().getRenderState ().bindVertexArray (this->m_image.getScene ().getVertexArray ());
+
+    // every attribute reads from the same buffer, only the offsets change between passes
+    this->m_image.getScene ().getGeometry ().bind ();
+
     for (const auto& cur : this->m_attribs) {
         glEnableVertexAttribArray (cur->id);
-        glBindBuffer (GL_ARRAY_BUFFER, *cur->value);
-        glVertexAttribPointer (cur->id, cur->elements, cur->type, GL_FALSE, 0, nullptr);
-
-#if !NDEBUG
-        glObjectLabel (GL_BUFFER, *cur->value, -1,
-                       ("Image " + std::to_string (this->m_image.getId ()) + " Pass " +
-                        this->m_pass.shader + " " + cur->name)
-                           .c_str ());
-#endif /* DEBUG */
+        glVertexAttribPointer (
+            cur->id, cur->elements, cur->type, GL_FALSE, 0, reinterpret_cast<const void*> (*cur->value));
     }
 }
 
 void CPass::renderGeometry () const {
     // start actual rendering now
-    glBindBuffer (GL_ARRAY_BUFFER, this->a_Position);
     glDrawArrays (GL_TRIANGLES, 0, 6);
+    this->getContext ().getStats ().addDraws (1);
 }
 
 void CPass::cleanupRenderSetup () {
-    // disable vertex attribs array and textures
+    // disable vertex attribs array, textures stay bound so the next pass can skip binding the same ones again
     for (const auto& cur : this->m_attribs)
         glDisableVertexAttribArray (cur->id);
+}
 
-    // unbind all the used textures
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture (GL_TEXTURE_2D, 0);
+void CPass::render (const uint32_t flags) {
+    TRACE_SCOPE ("CPass::render");
+    GPUProfiler::Scope profile (this->getContext ().getProfiler (), this->m_image.getProfilerEntry ());
 
-    // continue on the map from the second texture
-    for (const auto& index : this->m_textures | std::views::keys) {
-        glActiveTexture (GL_TEXTURE0 + index);
-        glBindTexture (GL_TEXTURE_2D, 0);
-    }
-}
+    // the last of a batch can still be going to the output instead
+    if (!(flags & Render_KeepTarget) || this->m_directOutput != nullptr)
+        this->setupRenderFramebuffer ();
 
-void CPass::render () {
-    this->setupRenderFramebuffer ();
     this->setupRenderTexture ();
     this->setupRenderUniforms ();
     this->setupRenderReferenceUniforms ();
     this->setupRenderAttributes ();
     this->renderGeometry ();
-    this->cleanupRenderSetup ();
+
+    if (!this->m_discarded.empty ())
+        this->discardFramebuffers ();
+
+    if (!(flags & Render_KeepAttributes))
+        this->cleanupRenderSetup ();
+}
+
+void CPass::discardFramebuffers () const {
+    if (!GLEW_ARB_invalidate_subdata)
+        return;
+
+    constexpr GLenum attachments [] = {GL_COLOR_ATTACHMENT0};
+
+    // only the read binding changes, the next pass can keep drawing where this one did
+    for (const auto& fbo : this->m_discarded) {
+        glBindFramebuffer (GL_READ_FRAMEBUFFER, fbo->getFramebuffer ());
+        glInvalidateFramebuffer (GL_READ_FRAMEBUFFER, 1, attachments);
+    }
+
+    glBindFramebuffer (
+        GL_READ_FRAMEBUFFER,
+        this->m_directOutput != nullptr ? this->m_directOutput->framebuffer : this->m_drawTo->getFramebuffer ());
+}
+
+bool CPass::isBatchableWith (const CPass& other) const {
+    // the same program means the same attributes too
+    return this->m_programID == other.m_programID && this->m_drawTo == other.m_drawTo &&
+           this->getBlendingMode () == other.getBlendingMode () && this->m_pass.depthtest == other.m_pass.depthtest &&
+           this->m_pass.cullmode == other.m_pass.cullmode && this->m_pass.depthwrite == other.m_pass.depthwrite;
+}
+
+void CPass::setupDependencies () {
+    this->m_dependencies = Dependency_None;
+
+    const auto uses = [this] (const std::string_view name) {
+        const Symbol symbol (name);
+
+        return this->m_uniformIndices.contains (symbol) || this->m_referenceUniformIndices.contains (symbol);
+    };
+
+    // g_Daytime only moves once a minute, comparing its value between frames is enough
+    if (uses ("g_Time"))
+        this->m_dependencies |= Dependency_Time;
+    if (uses ("g_PointerPosition") || uses ("g_PointerPositionLast"))
+        this->m_dependencies |= Dependency_Mouse;
+
+    for (const auto& name : this->m_uniformIndices | std::views::keys) {
+        if (name.str ().starts_with ("g_AudioSpectrum")) {
+            this->m_dependencies |= Dependency_Audio;
+            break;
+        }
+    }
+
+    // parallax only moves the image on screen, the displacement comes from the frame block so it's compared on its own
+    if (this->m_drawTo == this->m_image.getScene ().getFBO () &&
+        this->m_image.getScene ().getScene ().camera.parallax.enabled->value->getBool ())
+        this->m_dependencies |= Dependency_Parallax;
+
+    if (this->m_input != nullptr && this->m_input->isAnimated ())
+        this->m_dependencies |= Dependency_AnimatedTexture;
+
+    for (const auto& texture : this->m_textures | std::views::values) {
+        if (texture != nullptr && texture->isAnimated ())
+            this->m_dependencies |= Dependency_AnimatedTexture;
+    }
+}
+
+uint32_t CPass::getDependencies () const {
+    return this->m_dependencies;
+}
+
+bool CPass::haveInputsChanged () {
+    // these change every single frame, no point in comparing
+    if (this->m_dependencies & (Dependency_Time | Dependency_AnimatedTexture))
+        return true;
+
+    const auto sizeOf = [] (const UniformType type) -> size_t {
+        switch (type) {
+            case Double: return sizeof (double);
+            case Float: return sizeof (float);
+            case Integer: return sizeof (int);
+            case Vector2: return sizeof (glm::vec2);
+            case Vector3: return sizeof (glm::vec3);
+            case Vector4: return sizeof (glm::vec4);
+            case Matrix3: return sizeof (glm::mat3);
+            case Matrix4: return sizeof (glm::mat4);
+        }
+
+        return 0;
+    };
+
+    const auto append = [this] (const void* value, const size_t size) {
+        const auto* bytes = static_cast<const uint8_t*> (value);
+
+        this->m_currentInputValues.insert (this->m_currentInputValues.end (), bytes, bytes + size);
+    };
+
+    this->m_currentInputValues.clear ();
+
+    // textures streaming in render as a placeholder, the frame they're swapped for the real ones is a change
+    bool streaming = this->m_input != nullptr && !this->m_input->isReady ();
+
+    for (const auto& texture : this->m_textures | std::views::values)
+        streaming |= texture != nullptr && !texture->isReady ();
+
+    const bool swapped = this->m_streaming && !streaming;
+
+    this->m_streaming = streaming;
+
+    // the values setupRenderUniforms () and setupRenderReferenceUniforms () can change, constants are covered by
+    // m_constantsUploaded below
+    for (const auto& value : this->m_uniforms) {
+        if (value.constant)
+            continue;
+
+        const bool scalar = value.type == Double || value.type == Float || value.type == Integer;
+
+        append (value.value, sizeOf (value.type) * (scalar ? value.count : 1));
+    }
+
+    for (const auto& value : this->m_referenceUniforms)
+        append (*value.value, sizeOf (value.type));
+
+    if (this->m_dependencies & Dependency_Parallax)
+        append (this->m_image.getScene ().getParallaxDisplacement (), sizeof (glm::vec2));
+
+    // constants only change when a user property they're bound to does, which uploads them again
+    const bool changed = swapped || !this->m_hasInputValues || !this->m_constantsUploaded ||
+                         this->m_currentInputValues != this->m_inputValues;
+
+    std::swap (this->m_inputValues, this->m_currentInputValues);
+    this->m_hasInputValues = true;
+
+    return changed;
 }
 
 std::shared_ptr<const FBOProvider> CPass::getFBOProvider () const {
@@ -320,6 +552,32 @@ void CPass::setInput (std::shared_ptr<const TextureProvider> input) {
     this->m_input = std::move(input);
 }
 
+std::shared_ptr<const CFBO> CPass::getDestination () const {
+    return this->m_drawTo;
+}
+
+std::vector<std::shared_ptr<const CFBO>> CPass::getSampledFBOs () const {
+    std::vector<std::shared_ptr<const CFBO>> result = {};
+
+    const auto add = [&result] (const std::shared_ptr<const TextureProvider>& texture) {
+        if (auto fbo = std::dynamic_pointer_cast<const CFBO> (texture))
+            result.push_back (std::move (fbo));
+    };
+
+    // same resolution render () does, the first texture comes from the chain unless a bind says otherwise
+    add (this->resolveTexture (this->m_input, 0, this->m_input));
+
+    for (const auto& texture : this->m_textures | std::views::values)
+        add (texture == nullptr ? this->m_input : texture);
+
+    return result;
+}
+
+bool CPass::overwritesDestination () const {
+    // normal blending is ONE, ZERO and unknown modes disable blending, translucent and additive mix with what's there
+    return this->getBlendingMode () != BlendingMode_Translucent && this->getBlendingMode () != BlendingMode_Additive;
+}
+
 void CPass::setModelViewProjectionMatrix (const glm::mat4* projection) {
     this->m_modelViewProjectionMatrix = projection;
 }
@@ -336,6 +594,18 @@ void CPass::setViewProjectionMatrix (const glm::mat4* viewProjection) {
     this->m_viewProjectionMatrix = viewProjection;
 }
 
+void CPass::setParallaxDepth (const glm::vec2* depth) {
+    this->m_parallaxDepth = depth == nullptr ? &NO_PARALLAX : depth;
+}
+
+void CPass::setDirectOutput (const DirectOutput* output) {
+    this->m_directOutput = output;
+}
+
+void CPass::setDiscarded (std::vector<std::shared_ptr<const CFBO>> fbos) {
+    this->m_discarded = std::move (fbos);
+}
+
 void CPass::setBlendingMode (BlendingMode blendingmode) {
     this->m_blendingmode = blendingmode;
 }
@@ -344,11 +614,11 @@ BlendingMode CPass::getBlendingMode () const {
     return this->m_blendingmode;
 }
 
-void CPass::setTexCoord (GLuint texcoord) {
+void CPass::setTexCoord (GLintptr texcoord) {
     this->a_TexCoord = texcoord;
 }
 
-void CPass::setPosition (GLuint position) {
+void CPass::setPosition (GLintptr position) {
     this->a_Position = position;
 }
 
@@ -364,61 +634,52 @@ Render::Shaders::Shader* CPass::getShader () const {
     return this->m_shader;
 }
 
-GLuint CPass::compileShader (const char* shader, GLuint type) {
-    // reserve shaders in OpenGL
-    const GLuint shaderID = glCreateShader (type);
-
-    glShaderSource (shaderID, 1, &shader, nullptr);
-    glCompileShader (shaderID);
-
-    GLint result = GL_FALSE;
-    int infoLogLength = 0;
-
-    // ensure the vertex shader was correctly compiled
-    glGetShaderiv (shaderID, GL_COMPILE_STATUS, &result);
-    glGetShaderiv (shaderID, GL_INFO_LOG_LENGTH, &infoLogLength);
-
-    if (infoLogLength > 0) {
-        const auto logBuffer = new char [infoLogLength + 1];
-        // ensure logBuffer ends with a \0
-        memset (logBuffer, 0, infoLogLength + 1);
-        // get information about the error
-        glGetShaderInfoLog (shaderID, infoLogLength, nullptr, logBuffer);
-        // throw an exception about the issue
-        std::stringstream buffer;
-        buffer << logBuffer << std::endl << "Compiled source code:" << std::endl << shader;
-        // free the buffer
-        delete [] logBuffer;
-
-        if (result == GL_FALSE) {
-            // shader compilation failed completely, throw an exception
-            sLog.exception (buffer.str ());
-        } else {
-            // some warning was emitted, log the error and keep chuging along
-            sLog.error (buffer.str ());
-        }
-    }
+void CPass::warm (const CImage& image, const MaterialPass& pass, const ImageEffectPassOverride& override) {
+    const ComboMap combos = getCombos (image, pass);
+    Render::Shaders::Shader shader (
+        image.getAssetLocator (), pass.shader, combos, override.combos, pass.textures, override.textures,
+        override.constants
+    );
 
-    return shaderID;
+    std::string vertexSource = shader.vertex ();
+    std::string fragmentSource = shader.fragment ();
+    std::set<std::string> frameUniforms;
+
+    // same sources setupShaders () would end up with, otherwise they would never match in the cache
+    FrameUniforms::rewrite (vertexSource, frameUniforms);
+    FrameUniforms::rewrite (fragmentSource, frameUniforms);
+    FrameUniforms::injectParallax (vertexSource);
+    bakeConstants (shader, override.constants, vertexSource, fragmentSource);
+
+    image.getContext ().getProgramCache ().warm (vertexSource, fragmentSource, pass.shader);
 }
 
-void CPass::setupShaders () {
+ComboMap CPass::getCombos (const CImage& image, const MaterialPass& pass) {
     // ensure the constants are defined
-    const auto texture0 = this->m_image.getTexture ();
+    const auto texture0 = image.getTexture ();
 
     // copy the combos from the pass
-    this->m_combos.insert (this->m_pass.combos.begin (), this->m_pass.combos.end ());
+    ComboMap combos = pass.combos;
 
     // TODO: THE VALUES ARE THE SAME AS THE ENUMERATION, SO MAYBE IT HAS TO BE SPECIFIED FOR THE TEXTURE 0 OF ALL
     // ELEMENTS?
     if (texture0 != nullptr) {
         if (texture0->getFormat () == TextureFormat_RG88) {
-            this->m_combos.insert_or_assign ("TEX0FORMAT", 8);
+            combos.insert_or_assign ("TEX0FORMAT", 8);
         } else if (texture0->getFormat () == TextureFormat_R8) {
-            this->m_combos.insert_or_assign ("TEX0FORMAT", 9);
+            combos.insert_or_assign ("TEX0FORMAT", 9);
         }
     }
 
+    return combos;
+}
+
+void CPass::prepareShaders () {
+    TRACE_SCOPE ("CPass::prepareShaders");
+    Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_ShaderPreprocess);
+
+    this->m_combos = getCombos (this->m_image, this->m_pass);
+
     // TODO: REVIEW THE SHADER TEXTURES HERE, THE ONES PASSED ON TO THE SHADER SHOULD NOT BE IN THE LIST
     // TODO: USED TO BUILD THE TEXTURES LATER
     // use the combos copied from the pass so it includes the texture format
@@ -427,56 +688,61 @@ void CPass::setupShaders () {
         this->m_pass.textures, this->m_override.textures, this->m_override.constants
     );
 
-    const auto [vertex, fragment] = Shaders::GLSLContext::get ().toGlsl (
-        this->m_shader->vertex (), this->m_shader->fragment ());
-
-    // compile the shaders
-    const GLuint vertexShaderID = compileShader (vertex.c_str (), GL_VERTEX_SHADER);
-    const GLuint fragmentShaderID = compileShader (fragment.c_str (), GL_FRAGMENT_SHADER);
-    // create the final program
-    this->m_programID = glCreateProgram ();
-    // link the shaders together
-    glAttachShader (this->m_programID, vertexShaderID);
-    glAttachShader (this->m_programID, fragmentShaderID);
-    glLinkProgram (this->m_programID);
-    // check that the shader was properly linked
-    GLint result = GL_FALSE;
-    int infoLogLength = 0;
-
-    glGetProgramiv (this->m_programID, GL_LINK_STATUS, &result);
-    glGetProgramiv (this->m_programID, GL_INFO_LOG_LENGTH, &infoLogLength);
-
-    if (infoLogLength > 0) {
-        const auto logBuffer = new char [infoLogLength + 1];
-        // ensure logBuffer ends with a \0
-        memset (logBuffer, 0, infoLogLength + 1);
-        // get information about the error
-        glGetProgramInfoLog (this->m_programID, infoLogLength, nullptr, logBuffer);
-        // throw an exception about the issue
-        const std::string message = logBuffer;
-        // free the buffer
-        delete [] logBuffer;
-        if (result == GL_FALSE) {
-            // shader compilation failed completely, throw an exception
-            sLog.exception (message);
-        } else {
-            // some warning was emitted, log the error and keep chuging along
-            sLog.error (message);
-        }
+    this->m_vertexSource = this->m_shader->vertex ();
+    this->m_fragmentSource = this->m_shader->fragment ();
+
+    // values shared by every pass come from the scene's block, uploaded once per frame
+    FrameUniforms::rewrite (this->m_vertexSource, this->m_frameUniforms);
+    FrameUniforms::rewrite (this->m_fragmentSource, this->m_frameUniforms);
+    // every pass gets the same vertex shader whatever it draws to, so programs are still shared between them
+    FrameUniforms::injectParallax (this->m_vertexSource);
+    // every pass with different constants gets its own program, but the driver gets to fold them
+    bakeConstants (*this->m_shader, this->m_override.constants, this->m_vertexSource, this->m_fragmentSource);
+
+    report.addBytes (this->m_vertexSource.size () + this->m_fragmentSource.size ());
+}
+
+void CPass::bakeConstants (
+    const Render::Shaders::Shader& shader, const ShaderConstantMap& constants, std::string& vertex,
+    std::string& fragment
+) {
+    for (const auto& [name, value] : constants) {
+        // constants bound to a user property are updated while running, they stay uniforms
+        if (value->property != nullptr)
+            continue;
+
+        const auto [vertexParameter, fragmentParameter] = shader.findParameter (name);
+
+        if (vertexParameter != nullptr && !isEngineUniform (vertexParameter->name.str ()))
+            bake (vertex, *vertexParameter, *value->value);
+        if (fragmentParameter != nullptr && !isEngineUniform (fragmentParameter->name.str ()))
+            bake (fragment, *fragmentParameter, *value->value);
     }
+}
+
+void CPass::setupShaders () {
+    if (this->m_shader == nullptr)
+        this->prepareShaders ();
 
-#if !NDEBUG
-    glObjectLabel (GL_PROGRAM, this->m_programID, -1, this->m_pass.shader.c_str ());
-    glObjectLabel (GL_SHADER, vertexShaderID, -1, (this->m_pass.shader + ".vert").c_str ());
-    glObjectLabel (GL_SHADER, fragmentShaderID, -1, (this->m_pass.shader + ".frag").c_str ());
-#endif /* DEBUG */
+    // passes with the exact same shaders share the program, it's translated in the background until setupProgram ()
+    this->m_program = &this->getContext ().getProgramCache ().get (
+        this->m_vertexSource, this->m_fragmentSource, this->m_pass.shader);
 
-    // after being liked shaders can be dettached and deleted
-    glDetachShader (this->m_programID, vertexShaderID);
-    glDetachShader (this->m_programID, fragmentShaderID);
+    this->m_vertexSource = {};
+    this->m_fragmentSource = {};
+}
+
+void CPass::setupProgram () {
+    // builds every program requested so far in one go, later calls find them ready
+    this->getContext ().getProgramCache ().build ();
+
+    if (this->m_program->id == GL_NONE)
+        sLog.exception ("Cannot build the program for pass ", this->m_pass.shader);
 
-    glDeleteShader (vertexShaderID);
-    glDeleteShader (fragmentShaderID);
+    this->m_programID = this->m_program->id;
+
+    // the parallax code reads from the block even when the shader itself didn't
+    FrameUniforms::bind (this->m_programID);
 
     // first setup the default values, these will be overwritten by future values
     this->setupShaderVariables ();
@@ -486,8 +752,8 @@ void CPass::setupShaders () {
     this->setupAttributes ();
     // get information from the program, like uniforms, etc
     // support three textures for now
-    this->g_Texture0Rotation = glGetUniformLocation (this->m_programID, "g_Texture0Rotation");
-    this->g_Texture0Translation = glGetUniformLocation (this->m_programID, "g_Texture0Translation");
+    this->g_Texture0Rotation = this->m_program->getUniformLocation ("g_Texture0Rotation");
+    this->g_Texture0Translation = this->m_program->getUniformLocation ("g_Texture0Translation");
 }
 
 void CPass::setupAttributes () {
@@ -496,16 +762,19 @@ void CPass::setupAttributes () {
 }
 
 void CPass::setupTextureUniforms () {
+    // textures are looked up in the background's own container first
+    const auto& project = this->m_image.getScene ().getScene ().project;
+
     // first set default textures extracted from the shader
     // vertex shader doesn't seem to have texture info
     // but for now just set first vertex's textures
     // and then try with fragment's and override any existing
     for (const auto& [index, textureName] : this->m_shader->getVertex ().getTextures ()) {
         try {
-            if (textureName.find ("_rt_") == 0 || textureName.find ("_alias_") == 0) {
-                this->m_textures [index] = this->resolveFBO (textureName);
+            if (const Symbol name (textureName); name.isRenderTarget ()) {
+                this->m_textures [index] = this->resolveFBO (name);
             } else if(!textureName.empty ()) {
-                this->m_textures [index] = this->getContext ().resolveTexture (textureName);
+                this->m_textures [index] = this->getContext ().resolveTexture (textureName, project);
             }
         } catch (std::runtime_error& ex) {
             sLog.error ("Cannot resolve texture ", textureName, " for fragment shader ", ex.what ());
@@ -514,10 +783,10 @@ void CPass::setupTextureUniforms () {
 
     for (const auto& [index, textureName] : this->m_shader->getFragment ().getTextures ()) {
         try {
-            if (textureName.find ("_rt_") == 0 || textureName.find ("_alias_") == 0) {
-                this->m_textures [index] = this->resolveFBO (textureName);
+            if (const Symbol name (textureName); name.isRenderTarget ()) {
+                this->m_textures [index] = this->resolveFBO (name);
             } else if(!textureName.empty ()) {
-                this->m_textures [index] = this->getContext ().resolveTexture (textureName);
+                this->m_textures [index] = this->getContext ().resolveTexture (textureName, project);
             }
         } catch (std::runtime_error& ex) {
             sLog.error ("Cannot resolve texture ", textureName, " for fragment shader ", ex.what ());
@@ -531,10 +800,10 @@ void CPass::setupTextureUniforms () {
         }
 
         try {
-            if (textureName.find ("_rt_") == 0 || textureName.find ("_alias_") == 0) {
-                this->m_textures [index] = this->resolveFBO (textureName);
+            if (const Symbol name (textureName); name.isRenderTarget ()) {
+                this->m_textures [index] = this->resolveFBO (name);
             } else if (!textureName.empty ()) {
-                this->m_textures [index] = this->getContext ().resolveTexture (textureName);
+                this->m_textures [index] = this->getContext ().resolveTexture (textureName, project);
             }
         } catch (std::runtime_error& ex) {
             sLog.error ("Cannot resolve texture ", textureName, " for pass ", ex.what ());
@@ -548,10 +817,10 @@ void CPass::setupTextureUniforms () {
         }
 
         try {
-            if (textureName.find ("_rt_") == 0 || textureName.find ("_alias_") == 0) {
-                this->m_textures [index] = this->resolveFBO (textureName);
+            if (const Symbol name (textureName); name.isRenderTarget ()) {
+                this->m_textures [index] = this->resolveFBO (name);
             } else if (!textureName.empty ()) {
-                this->m_textures [index] = this->getContext ().resolveTexture (textureName);
+                this->m_textures [index] = this->getContext ().resolveTexture (textureName, project);
             }
         } catch (std::runtime_error& ex) {
             sLog.error ("Cannot resolve texture ", textureName, " for override ", ex.what ());
@@ -565,7 +834,7 @@ void CPass::setupTextureUniforms () {
             this->m_textures [index] = nullptr;
         } else if(!bind.empty ()) {
             // a normal bind, search for the corresponding FBO and set it
-            this->m_textures [index] = this->resolveFBO (bind);
+            this->m_textures [index] = this->resolveFBO (Symbol (bind));
         }
     }
 
@@ -620,22 +889,27 @@ void CPass::setupUniforms () {
     this->addUniform ("g_ModelMatrix", &this->m_modelMatrix);
     this->addUniform ("g_NormalModelMatrix", glm::identity<glm::mat3> ());
     this->addUniform ("g_ViewProjectionMatrix", &this->m_viewProjectionMatrix);
+    this->addUniform ("g_ParallaxDepth", &this->m_parallaxDepth);
     this->addUniform ("g_PointerPosition", scene.getMousePosition ());
     this->addUniform ("g_PointerPositionLast", scene.getMousePositionLast ());
     this->addUniform ("g_EffectTextureProjectionMatrix", glm::mat4 (1.0));
     this->addUniform ("g_EffectTextureProjectionMatrixInverse", glm::mat4 (1.0));
-    this->addUniform ("g_TexelSize", glm::vec2 (1.0 / scene.getWidth (), 1.0 / scene.getHeight ()));
-    this->addUniform ("g_TexelSizeHalf", glm::vec2 (0.5 / scene.getWidth (), 0.5 / scene.getHeight ()));
-    this->addUniform ("g_AudioSpectrum16Left", recorder.audio16, 16);
-    this->addUniform ("g_AudioSpectrum16Right", recorder.audio16, 16);
-    this->addUniform ("g_AudioSpectrum32Left", recorder.audio32, 32);
-    this->addUniform ("g_AudioSpectrum32Right", recorder.audio32, 32);
-    this->addUniform ("g_AudioSpectrum64Left", recorder.audio64, 64);
-    this->addUniform ("g_AudioSpectrum64Right", recorder.audio64, 64);
+    // texels of the scene's framebuffer, which the render scale sizes
+    const glm::vec2 texelSize =
+        glm::vec2 (1.0f) / (glm::vec2 (scene.getWidth (), scene.getHeight ()) * scene.getRenderScale ());
+
+    this->addUniform ("g_TexelSize", texelSize);
+    this->addUniform ("g_TexelSizeHalf", texelSize * 0.5f);
+    this->addUniform ("g_AudioSpectrum16Left", recorder.audio16Left, 16);
+    this->addUniform ("g_AudioSpectrum16Right", recorder.audio16Right, 16);
+    this->addUniform ("g_AudioSpectrum32Left", recorder.audio32Left, 32);
+    this->addUniform ("g_AudioSpectrum32Right", recorder.audio32Right, 32);
+    this->addUniform ("g_AudioSpectrum64Left", recorder.audio64Left, 64);
+    this->addUniform ("g_AudioSpectrum64Right", recorder.audio64Right, 64);
 }
 
-void CPass::addAttribute (const std::string& name, GLint type, GLint elements, const GLuint* value) {
-    const GLint id = glGetAttribLocation (this->m_programID, name.c_str ());
+void CPass::addAttribute (const std::string& name, GLint type, GLint elements, const GLintptr* value) {
+    const GLint id = this->m_program->getAttribLocation (name);
 
     if (id == -1)
         return;
@@ -643,72 +917,119 @@ void CPass::addAttribute (const std::string& name, GLint type, GLint elements, c
     this->m_attribs.emplace_back (new AttribEntry (id, name, type, elements, value));
 }
 
+CPass::UniformEntry& CPass::emplaceUniform (const Symbol name) {
+    // replace the uniform that's already registered if it's there already
+    if (const auto it = this->m_uniformIndices.find (name); it != this->m_uniformIndices.end ())
+        return this->m_uniforms [it->second];
+
+    this->m_uniformIndices.emplace (name, this->m_uniforms.size ());
+
+    return this->m_uniforms.emplace_back ();
+}
+
+void CPass::removeUniform (const Symbol name) {
+    const auto it = this->m_uniformIndices.find (name);
+
+    if (it == this->m_uniformIndices.end ())
+        return;
+
+    // the order doesn't matter, move the last one to the hole
+    const size_t index = it->second;
+
+    this->m_uniformIndices.erase (it);
+
+    if (index != this->m_uniforms.size () - 1) {
+        this->m_uniforms [index] = this->m_uniforms.back ();
+
+        for (auto& position : this->m_uniformIndices | std::views::values) {
+            if (position == this->m_uniforms.size () - 1)
+                position = index;
+        }
+    }
+
+    this->m_uniforms.pop_back ();
+}
+
 template <typename T> void CPass::addUniform (const std::string& name, UniformType type, T value) {
-    GLint id = glGetUniformLocation (this->m_programID, name.c_str ());
+    static_assert (sizeof (T) <= sizeof (UniformEntry::storage));
+
+    const GLint id = this->m_program->getUniformLocation (name);
 
     // parameter not found, can be ignored
     if (id == -1)
         return;
 
-    // free the uniform that's already registered if it's there already
-    const auto it = this->m_uniforms.find (name);
+    UniformEntry& entry = this->emplaceUniform (Symbol (name));
 
-    if (it != this->m_uniforms.end ()) {
-        delete it->second;
-    }
-
-    // build a copy of the value and allocate it somewhere
-    T* newValue = new T (value);
+    // keep a copy of the value in the entry itself
+    entry.id = id;
+    entry.type = type;
+    entry.count = 1;
+    entry.constant = true;
+    entry.value = nullptr;
+    memcpy (entry.storage.data (), &value, sizeof (T));
 
-    // uniform found, add it to the list
-    this->m_uniforms.insert_or_assign (name, new UniformEntry (id, name, type, newValue, 1));
+    this->m_constantsUploaded = false;
 }
 
 template <typename T> void CPass::addUniform (const std::string& name, UniformType type, T* value, int count) {
     // this version is used to reference to system variables so things like g_Time works fine
-    GLint id = glGetUniformLocation (this->m_programID, name.c_str ());
+    const GLint id = this->m_program->getUniformLocation (name);
 
     // parameter not found, can be ignored
-    if (id == -1)
+    // the ones in the frame block still have to be known to find out what the pass depends on
+    if (id == -1 && !this->m_frameUniforms.contains (name))
         return;
 
-    // free the uniform that's already registered if it's there already
+    UniformEntry& entry = this->emplaceUniform (Symbol (name));
 
-    if (const auto it = this->m_uniforms.find (name); it != this->m_uniforms.end ()) {
-        delete it->second;
-    }
-
-    // uniform found, add it to the list
-    this->m_uniforms.insert_or_assign (name, new UniformEntry (id, name, type, value, count));
+    entry.id = id;
+    entry.type = type;
+    entry.count = count;
+    entry.constant = false;
+    entry.value = value;
 }
 
 template <typename T> void CPass::addUniform (const std::string& name, UniformType type, T** value) {
     // this version is used to reference to system variables so things like g_Time works fine
-    const GLint id = glGetUniformLocation (this->m_programID, name.c_str ());
+    const GLint id = this->m_program->getUniformLocation (name);
 
     // parameter not found, can be ignored
     if (id == -1)
         return;
 
-    // free the uniform that's already registered if it's there already
+    const Symbol symbol (name);
+
+    // the reference takes over any value registered under the same name
+    this->removeUniform (symbol);
 
-    if (const auto it = this->m_uniforms.find (name); it != this->m_uniforms.end ()) {
-        delete it->second;
+    const ReferenceUniformEntry entry {id, type, reinterpret_cast<const void**> (value)};
+
+    if (const auto it = this->m_referenceUniformIndices.find (symbol); it != this->m_referenceUniformIndices.end ()) {
+        this->m_referenceUniforms [it->second] = entry;
+        return;
     }
 
-    // uniform found, add it to the list
-    this->m_referenceUniforms.insert_or_assign (
-        name, new ReferenceUniformEntry (id, name, type, reinterpret_cast<const void**> (value)));
+    this->m_referenceUniformIndices.emplace (symbol, this->m_referenceUniforms.size ());
+    this->m_referenceUniforms.push_back (entry);
 }
 
 void CPass::setupShaderVariables () {
-    for (const auto& cur : this->m_shader->getVertex ().getParameters ())
-        if (!this->m_uniforms.contains (cur->getName ()))
-            this->addUniform (cur);
+    // parameters the program never reads are not worth converting
+    const auto wanted = [this] (const ShaderParameters::Parameter& parameter) {
+        return !this->m_uniformIndices.contains (parameter.name) &&
+               this->m_program->getUniformLocation (parameter.name.str ()) != -1;
+    };
+
+    for (const auto* unit : {&this->m_shader->getVertex (), &this->m_shader->getFragment ()})
+        for (const auto& cur : unit->getParameters ())
+            if (wanted (cur))
+                this->addUniform (cur, unit->getParameters ());
 
-    for (const auto& cur : this->m_shader->getFragment ().getParameters ())
-        if (!this->m_uniforms.contains (cur->getName ()))
-            this->addUniform (cur);
+    for (const auto& deregister : this->m_propertyListeners)
+        deregister ();
+
+    this->m_propertyListeners.clear ();
 
     // find variables in the shaders and set the value with the constants if possible
     for (const auto& [name, value] : this->m_override.constants) {
@@ -719,34 +1040,49 @@ void CPass::setupShaderVariables () {
             continue;
 
         // get one instance of it
-        ShaderVariable* var = vertex == nullptr ? fragment : vertex;
+        const ShaderParameters::Parameter* var = vertex == nullptr ? fragment : vertex;
+
+        if (this->m_program->getUniformLocation (var->name.str ()) == -1)
+            continue;
 
         // this takes care of all possible casts, even invalid ones, which will use whatever default behaviour
         // of the underlying CDynamicValue used for the value
-        this->addUniform (var, value->value.get ());
+        this->addUniform (*var, value->value.get ());
+
+        // constants bound to a user property follow it while running, only this uniform is updated
+        if (value->property != nullptr) {
+            const DynamicValue* setting = value->value.get ();
+
+            this->m_propertyListeners.push_back (value->value->listen (
+                [this, var, setting] (const DynamicValue&) { this->addUniform (*var, setting); }));
+        }
     }
 }
 
 // define some basic methods for the template
-void CPass::addUniform (ShaderVariable* value) {
-    // no need to re-implement this, call the version that takes a CDynamicValue as second parameter
-    // and that handles casting and everything
-    this->addUniform (value, value);
-}
-
-void CPass::addUniform (const ShaderVariable* value, const DynamicValue* setting) {
-    if (value->is<ShaderVariableFloat> ()) {
-        this->addUniform (value->getName (), setting->getFloat ());
-    } else if (value->is<ShaderVariableInteger> ()) {
-        this->addUniform (value->getName (), setting->getInt ());
-    } else if (value->is<ShaderVariableVector2> ()) {
-        this->addUniform (value->getName (), setting->getVec2 ());
-    } else if (value->is<ShaderVariableVector3> ()) {
-        this->addUniform (value->getName (), setting->getVec3 ());
-    } else if (value->is<ShaderVariableVector4> ()) {
-        this->addUniform (value->getName (), setting->getVec4 ());
-    } else {
-        sLog.error ("Cannot convert setting dynamic value  to ", value->getName (), ". Using default value");
+void CPass::addUniform (const ShaderParameters::Parameter& parameter, const ShaderParameters& defaults) {
+    const std::string& name = parameter.name.str ();
+
+    // the default is read straight out of the block with the type it was stored as
+    switch (parameter.type) {
+        case ShaderParameters::Float: this->addUniform (name, defaults.get<float> (parameter)); break;
+        case ShaderParameters::Integer: this->addUniform (name, defaults.get<int> (parameter)); break;
+        case ShaderParameters::Vector2: this->addUniform (name, defaults.get<glm::vec2> (parameter)); break;
+        case ShaderParameters::Vector3: this->addUniform (name, defaults.get<glm::vec3> (parameter)); break;
+        case ShaderParameters::Vector4: this->addUniform (name, defaults.get<glm::vec4> (parameter)); break;
+    }
+}
+
+void CPass::addUniform (const ShaderParameters::Parameter& parameter, const DynamicValue* setting) {
+    const std::string& name = parameter.name.str ();
+
+    // this takes care of all possible casts, the setting converts itself to the parameter's type
+    switch (parameter.type) {
+        case ShaderParameters::Float: this->addUniform (name, setting->getFloat ()); break;
+        case ShaderParameters::Integer: this->addUniform (name, setting->getInt ()); break;
+        case ShaderParameters::Vector2: this->addUniform (name, setting->getVec2 ()); break;
+        case ShaderParameters::Vector3: this->addUniform (name, setting->getVec3 ()); break;
+        case ShaderParameters::Vector4: this->addUniform (name, setting->getVec4 ()); break;
     }
 }
 
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <array>
+#include <functional>
 #include <glm/gtc/type_ptr.hpp>
+#include <set>
+#include <unordered_map>
 #include <utility>
 
 #include "../../TextureProvider.h"
@@ -8,8 +12,9 @@
 #include "WallpaperEngine/Render/CFBO.h"
 #include "WallpaperEngine/Render/FBOProvider.h"
 #include "WallpaperEngine/Render/Helpers/ContextAware.h"
+#include "WallpaperEngine/Render/ProgramCache.h"
 #include "WallpaperEngine/Render/Shaders/Shader.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariable.h"
+#include "WallpaperEngine/Render/WallpaperState.h"
 
 namespace WallpaperEngine::Render::Objects {
 class CImage;
@@ -17,30 +22,107 @@ class CImage;
 
 namespace WallpaperEngine::Render::Objects::Effects {
 using namespace WallpaperEngine::Render;
-using namespace WallpaperEngine::Render::Shaders::Variables;
 using namespace WallpaperEngine::Data::Model;
 
 class CPass final : public Helpers::ContextAware {
   public:
+    /**
+     * Inputs besides the sampled FBOs that can make the output of a pass change from one frame to the next
+     */
+    enum Dependency {
+        Dependency_None = 0,
+        Dependency_Time = 1 << 0,
+        Dependency_Mouse = 1 << 1,
+        Dependency_Audio = 1 << 2,
+        Dependency_Parallax = 1 << 3,
+        Dependency_AnimatedTexture = 1 << 4,
+    };
+
     CPass (
         CImage& image, std::shared_ptr<const FBOProvider> fboProvider, const MaterialPass& pass,
         std::optional<std::reference_wrapper<const ImageEffectPassOverride>> override,
         std::optional<std::reference_wrapper<const TextureMap>> binds,
         std::optional<std::reference_wrapper<std::string>> target);
+    ~CPass () override;
 
-    void render ();
+    enum RenderFlags {
+        Render_Full = 0,
+        /** the previous pass was compatible and left the framebuffer, viewport, blending and depth state set */
+        Render_KeepTarget = 1 << 0,
+        /** the next pass is compatible, leave the vertex attributes enabled for it */
+        Render_KeepAttributes = 1 << 1,
+    };
+
+    /**
+     * @param flags RenderFlags for passes drawn back to back with compatible ones
+     */
+    void render (uint32_t flags = Render_Full);
 
     void setDestination (std::shared_ptr<const CFBO> drawTo);
     void setInput (std::shared_ptr<const TextureProvider> input);
-    void setTexCoord (GLuint texcoord);
-    void setPosition (GLuint position);
+    /** @param texcoord Offset of the texture coordinates in the scene's GeometryArena */
+    void setTexCoord (GLintptr texcoord);
+    /** @param position Offset of the vertex positions in the scene's GeometryArena */
+    void setPosition (GLintptr position);
     void setModelViewProjectionMatrix (const glm::mat4* projection);
     void setModelViewProjectionMatrixInverse (const glm::mat4* projection);
     void setModelMatrix (const glm::mat4* model);
     void setViewProjectionMatrix (const glm::mat4* viewProjection);
+    /**
+     * @param depth How much the scene's parallax displacement moves what the pass draws, nullptr to not move it
+     */
+    void setParallaxDepth (const glm::vec2* depth);
+    /**
+     * @param output Where to draw instead of the destination, nullptr to draw to the destination
+     */
+    void setDirectOutput (const DirectOutput* output);
+    /**
+     * @param fbos Framebuffers nothing reads again in the frame after this pass, their contents are dropped once it
+     * draws so the driver doesn't have to keep them
+     */
+    void setDiscarded (std::vector<std::shared_ptr<const CFBO>> fbos);
     void setBlendingMode (BlendingMode blendingmode);
     [[nodiscard]] BlendingMode getBlendingMode () const;
-    [[nodiscard]] std::shared_ptr<const CFBO> resolveFBO (const std::string& name) const;
+    [[nodiscard]] std::shared_ptr<const CFBO> resolveFBO (Symbol name) const;
+    [[nodiscard]] std::shared_ptr<const CFBO> getDestination () const;
+    /**
+     * @return Every FBO this pass samples from when rendering
+     */
+    [[nodiscard]] std::vector<std::shared_ptr<const CFBO>> getSampledFBOs () const;
+    /**
+     * @return If the pass replaces the destination's contents instead of blending over them
+     */
+    [[nodiscard]] bool overwritesDestination () const;
+    /**
+     * @return If both passes draw to the same target with the same program and state, so one can follow the other
+     */
+    [[nodiscard]] bool isBatchableWith (const CPass& other) const;
+    /**
+     * Preprocesses the pass' shaders, it's only CPU work so the passes of a scene can do it in parallel on the JobPool
+     */
+    void prepareShaders ();
+    /**
+     * Gives the shaders to the ProgramCache, which translates them in the background until setupProgram ()
+     */
+    void setupShaders ();
+    /**
+     * Links the pass' program and looks up its uniforms, textures and attributes, throws if the program can't be built
+     */
+    void setupProgram ();
+    /**
+     * Works out which Dependency this pass has, setupProgram () has to be done and destination and input set already
+     */
+    void setupDependencies ();
+    /**
+     * @return Mask of Dependency values
+     */
+    [[nodiscard]] uint32_t getDependencies () const;
+    /**
+     * Compares the uniform values and textures this pass would render with against the ones of the previous call
+     *
+     * @return If rendering now could give a different result than the last time
+     */
+    bool haveInputsChanged ();
 
     [[nodiscard]] std::shared_ptr<const FBOProvider> getFBOProvider () const;
     [[nodiscard]] const CImage& getImage () const;
@@ -48,7 +130,29 @@ class CPass final : public Helpers::ContextAware {
     [[nodiscard]] std::optional<std::reference_wrapper<std::string>> getTarget () const;
     [[nodiscard]] Render::Shaders::Shader* getShader () const;
 
+    /**
+     * Queues the shaders a pass with these settings would use in the ProgramCache's warm-up, without creating it
+     *
+     * @param image
+     * @param pass
+     * @param override
+     */
+    static void warm (const CImage& image, const MaterialPass& pass, const ImageEffectPassOverride& override);
+
   private:
+    /**
+     * Compiles the constants that aren't bound to a user property into the sources, declared as const instead of
+     * uniform so the driver can fold them. Values the engine sets itself are left alone
+     *
+     * @param shader The shader the sources come from
+     * @param constants
+     * @param vertex
+     * @param fragment
+     */
+    static void bakeConstants (
+        const Render::Shaders::Shader& shader, const ShaderConstantMap& constants, std::string& vertex,
+        std::string& fragment);
+
     enum UniformType {
         Float = 0,
         Matrix3 = 1,
@@ -60,39 +164,35 @@ class CPass final : public Helpers::ContextAware {
         Double = 7
     };
 
-    class UniformEntry {
-      public:
-        UniformEntry (const GLint id, std::string name, UniformType type, const void* value, int count) :
-            id (id),
-            name (std::move (name)),
-            type (type),
-            value (value),
-            count (count) {}
-
-        const GLint id;
-        std::string name;
+    /**
+     * A uniform the pass sets, these live in a flat array so rendering walks them without chasing pointers
+     */
+    struct UniformEntry {
+        /** -1 for values the shader reads from the scene's FrameUniforms block */
+        GLint id;
         UniformType type;
-        const void* value;
         int count;
-    };
+        /** the value is a copy owned by the pass, the program keeps it after being uploaded */
+        bool constant;
+        /** where the value is read from when it's not a constant */
+        const void* value;
+        /** the value of constants */
+        alignas (double) std::array<uint8_t, sizeof (glm::mat4)> storage;
 
-    class ReferenceUniformEntry {
-      public:
-        ReferenceUniformEntry (const GLint id, std::string name, UniformType type, const void** value) :
-            id (id),
-            name (std::move (name)),
-            type (type),
-            value (value) {}
+        [[nodiscard]] const void* data () const {
+            return this->constant ? this->storage.data () : this->value;
+        }
+    };
 
-        const GLint id;
-        std::string name;
+    struct ReferenceUniformEntry {
+        GLint id;
         UniformType type;
         const void** value;
     };
 
     class AttribEntry {
       public:
-        AttribEntry (const GLint id, std::string name, GLint type, GLint elements, const GLuint* value) :
+        AttribEntry (const GLint id, std::string name, GLint type, GLint elements, const GLintptr* value) :
             id (id),
             name (std::move (name)),
             type (type),
@@ -103,18 +203,21 @@ class CPass final : public Helpers::ContextAware {
         std::string name;
         GLint type;
         GLint elements;
-        const GLuint* value;
+        /** offset of the data in the scene's GeometryArena */
+        const GLintptr* value;
     };
 
-    static GLuint compileShader (const char* shader, GLuint type);
-    void setupShaders ();
+    /** @return The combos of the pass plus the ones the image's texture requires */
+    static ComboMap getCombos (const CImage& image, const MaterialPass& pass);
     void setupShaderVariables ();
     void setupUniforms ();
     void setupTextureUniforms ();
     void setupAttributes ();
-    void addAttribute (const std::string& name, GLint type, GLint elements, const GLuint* value);
-    void addUniform (ShaderVariable* value);
-    void addUniform (const ShaderVariable* value, const DynamicValue* setting);
+    void addAttribute (const std::string& name, GLint type, GLint elements, const GLintptr* value);
+    /** Registers the parameter with its default value from the shader unit's parameter block */
+    void addUniform (const Shaders::ShaderParameters::Parameter& parameter, const Shaders::ShaderParameters& defaults);
+    /** Registers the parameter with the value of the setting, converted to the parameter's type */
+    void addUniform (const Shaders::ShaderParameters::Parameter& parameter, const DynamicValue* setting);
     void addUniform (const std::string& name, int value);
     void addUniform (const std::string& name, double value);
     void addUniform (const std::string& name, float value);
@@ -142,6 +245,9 @@ class CPass final : public Helpers::ContextAware {
     template <typename T> void addUniform (const std::string& name, UniformType type, T value);
     template <typename T> void addUniform (const std::string& name, UniformType type, T* value, int count = 1);
     template <typename T> void addUniform (const std::string& name, UniformType type, T** value);
+    /** @return The entry for the uniform, a new one if it was not added yet */
+    UniformEntry& emplaceUniform (Symbol name);
+    void removeUniform (Symbol name);
 
     void setupRenderFramebuffer () const;
     void setupRenderTexture ();
@@ -150,8 +256,9 @@ class CPass final : public Helpers::ContextAware {
     void setupRenderAttributes () const;
     void renderGeometry () const;
     void cleanupRenderSetup ();
+    void discardFramebuffers () const;
 
-    std::shared_ptr<const TextureProvider> resolveTexture (std::shared_ptr<const TextureProvider> expected, int index, std::shared_ptr<const TextureProvider> previous = nullptr);
+    std::shared_ptr<const TextureProvider> resolveTexture (std::shared_ptr<const TextureProvider> expected, int index, std::shared_ptr<const TextureProvider> previous = nullptr) const;
 
     CImage& m_image;
     std::shared_ptr<const FBOProvider> m_fboProvider;
@@ -162,13 +269,21 @@ class CPass final : public Helpers::ContextAware {
     std::map<int, std::shared_ptr<const CFBO>> m_fbos = {};
     std::map<std::string, int> m_combos = {};
     std::vector<AttribEntry*> m_attribs = {};
-    std::map<std::string, UniformEntry*> m_uniforms = {};
-    std::map<std::string, ReferenceUniformEntry*> m_referenceUniforms = {};
+    std::vector<UniformEntry> m_uniforms = {};
+    std::vector<ReferenceUniformEntry> m_referenceUniforms = {};
+    /** position of every uniform in m_uniforms and m_referenceUniforms, only used while setting them up */
+    std::unordered_map<Symbol, size_t> m_uniformIndices = {};
+    std::unordered_map<Symbol, size_t> m_referenceUniformIndices = {};
+    /** deregister the listeners that update constants bound to user properties */
+    std::vector<std::function<void ()>> m_propertyListeners = {};
     BlendingMode m_blendingmode = BlendingMode_Normal;
     const glm::mat4* m_modelViewProjectionMatrix;
     const glm::mat4* m_modelViewProjectionMatrixInverse;
     const glm::mat4* m_modelMatrix;
     const glm::mat4* m_viewProjectionMatrix;
+    const glm::vec2* m_parallaxDepth;
+    const DirectOutput* m_directOutput = nullptr;
+    std::vector<std::shared_ptr<const CFBO>> m_discarded = {};
 
     /**
      * Contains the final map of textures to be used
@@ -176,16 +291,32 @@ class CPass final : public Helpers::ContextAware {
     std::map<int, std::shared_ptr<const TextureProvider>> m_textures = {};
 
     Render::Shaders::Shader* m_shader = nullptr;
+    /** sources built by prepareShaders (), only kept until setupShaders () */
+    std::string m_vertexSource = {};
+    std::string m_fragmentSource = {};
 
     std::shared_ptr<const CFBO> m_drawTo = nullptr;
     std::shared_ptr<const TextureProvider> m_input = nullptr;
 
+    uint32_t m_dependencies = Dependency_None;
+    /** uniform values seen by the last haveInputsChanged () call, and the buffer the current ones are gathered in */
+    std::vector<uint8_t> m_inputValues = {};
+    std::vector<uint8_t> m_currentInputValues = {};
+    bool m_hasInputValues = false;
+    /** a texture was still a placeholder in the last haveInputsChanged () call */
+    bool m_streaming = false;
+
+    ProgramCache::Program* m_program = nullptr;
     GLuint m_programID;
+    /** uniforms the shaders declared that were moved into the scene's FrameUniforms block */
+    std::set<std::string> m_frameUniforms = {};
+    /** the constant uniforms are already stored in the program */
+    bool m_constantsUploaded = false;
 
     // shader variables used temporary
     GLint g_Texture0Rotation;
     GLint g_Texture0Translation;
-    GLuint a_TexCoord;
-    GLuint a_Position;
+    GLintptr a_TexCoord;
+    GLintptr a_Position;
 };
 } // namespace WallpaperEngine::Render::Objects::Effects
@@ -0,0 +1,684 @@
+#include "GPUParticleSimulator.h"
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/GPUResources.h"
+#include "WallpaperEngine/Render/Utils/NoiseUtils.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace WallpaperEngine::Render::Objects::Particles;
+using namespace WallpaperEngine::Data::Model;
+
+namespace {
+constexpr const char* STATE_LAYOUT = R"(
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aVelocity;
+layout (location = 2) in vec3 aRotation;
+layout (location = 3) in vec3 aColor;
+layout (location = 4) in float aAlpha;
+layout (location = 5) in float aSize;
+layout (location = 6) in float aFrame;
+layout (location = 7) in float aAge;
+layout (location = 8) in float aLifetime;
+layout (location = 9) in vec3 aInitialColor;
+layout (location = 10) in float aInitialAlpha;
+layout (location = 11) in float aInitialSize;
+layout (location = 12) in vec3 aNoisePos;
+)";
+
+/** component count of every attribute in the record, in location order */
+constexpr int RECORD_ATTRIBUTES [] = {3, 3, 3, 3, 1, 1, 1, 1, 1, 3, 1, 1, 3};
+
+/** names of the geometry shader outputs captured by transform feedback, in record order */
+constexpr const char* FEEDBACK_VARYINGS [] = {
+    "tfPosition", "tfVelocity", "tfRotation", "tfColor", "tfAlpha", "tfSize", "tfFrame",
+    "tfAge", "tfLifetime", "tfInitialColor", "tfInitialAlpha", "tfInitialSize", "tfNoisePos",
+};
+
+constexpr const char* UPDATE_HEADER = R"(
+#version 330 core
+uniform float u_Dt;
+uniform float u_Time;
+uniform usampler1D g_NoisePermutation;
+uniform int u_AnimationMode;
+uniform int u_AnimationFrames;
+uniform float u_AnimationDuration;
+uniform float u_AnimationSpeed;
+
+out vec3 vPosition;
+out vec3 vVelocity;
+out vec3 vRotation;
+out vec3 vColor;
+out float vAlpha;
+out float vSize;
+out float vFrame;
+out float vAge;
+out float vLifetime;
+out vec3 vInitialColor;
+out float vInitialAlpha;
+out float vInitialSize;
+out vec3 vNoisePos;
+
+// same perlin noise as Render/Utils/NoiseUtils.h evaluated analytically, the CPU samples it from CurlNoiseField
+int perm (int i) {
+    return int (texelFetch (g_NoisePermutation, i, 0).r);
+}
+
+float grad (int hash, float x, float y, float z) {
+    int h = hash & 15;
+    float u = h < 8 ? x : y;
+    float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+    return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+}
+
+float fade (float t) {
+    return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+}
+
+float perlin (vec3 p) {
+    ivec3 P = ivec3 (floor (p)) & 255;
+    p -= floor (p);
+    vec3 f = vec3 (fade (p.x), fade (p.y), fade (p.z));
+
+    int A = perm (P.x) + P.y;
+    int AA = perm (A) + P.z;
+    int AB = perm (A + 1) + P.z;
+    int B = perm (P.x + 1) + P.y;
+    int BA = perm (B) + P.z;
+    int BB = perm (B + 1) + P.z;
+
+    return mix (
+        mix (mix (grad (perm (AA), p.x, p.y, p.z), grad (perm (BA), p.x - 1.0, p.y, p.z), f.x),
+             mix (grad (perm (AB), p.x, p.y - 1.0, p.z), grad (perm (BB), p.x - 1.0, p.y - 1.0, p.z), f.x), f.y),
+        mix (mix (grad (perm (AA + 1), p.x, p.y, p.z - 1.0), grad (perm (BA + 1), p.x - 1.0, p.y, p.z - 1.0), f.x),
+             mix (grad (perm (AB + 1), p.x, p.y - 1.0, p.z - 1.0), grad (perm (BB + 1), p.x - 1.0, p.y - 1.0, p.z - 1.0), f.x), f.y),
+        f.z);
+}
+
+vec3 perlinVec3 (vec3 p) {
+    return vec3 (perlin (p), perlin (p + vec3 (89.2, 33.1, 57.3)), perlin (p + vec3 (100.3, 120.1, 142.2)));
+}
+
+vec3 curlNoise (vec3 p) {
+    // wider epsilon than the CPU version, single precision can't resolve 1e-4 steps
+    const float e = 1e-2;
+    vec3 dx = vec3 (e, 0.0, 0.0);
+    vec3 dy = vec3 (0.0, e, 0.0);
+    vec3 dz = vec3 (0.0, 0.0, e);
+
+    vec3 x0 = perlinVec3 (p - dx);
+    vec3 x1 = perlinVec3 (p + dx);
+    vec3 y0 = perlinVec3 (p - dy);
+    vec3 y1 = perlinVec3 (p + dy);
+    vec3 z0 = perlinVec3 (p - dz);
+    vec3 z1 = perlinVec3 (p + dz);
+
+    return vec3 (
+        (y1.z - y0.z) - (z1.y - z0.y),
+        (z1.x - z0.x) - (x1.z - x0.z),
+        (x1.y - x0.y) - (y1.x - y0.x)
+    ) / (2.0 * e);
+}
+
+float hash (vec3 p) {
+    return fract (sin (dot (p, vec3 (12.9898, 78.233, 37.719))) * 43758.5453);
+}
+
+float fadeValue (float life, float startTime, float endTime, float startValue, float endValue) {
+    if (life <= startTime)
+        return startValue;
+    if (life >= endTime)
+        return endValue;
+
+    return mix (startValue, endValue, (life - startTime) / (endTime - startTime));
+}
+)";
+
+constexpr const char* UPDATE_GEOMETRY = R"(
+#version 330 core
+layout (points) in;
+layout (points, max_vertices = 1) out;
+
+in vec3 vPosition [];
+in vec3 vVelocity [];
+in vec3 vRotation [];
+in vec3 vColor [];
+in float vAlpha [];
+in float vSize [];
+in float vFrame [];
+in float vAge [];
+in float vLifetime [];
+in vec3 vInitialColor [];
+in float vInitialAlpha [];
+in float vInitialSize [];
+in vec3 vNoisePos [];
+
+out vec3 tfPosition;
+out vec3 tfVelocity;
+out vec3 tfRotation;
+out vec3 tfColor;
+out float tfAlpha;
+out float tfSize;
+out float tfFrame;
+out float tfAge;
+out float tfLifetime;
+out vec3 tfInitialColor;
+out float tfInitialAlpha;
+out float tfInitialSize;
+out vec3 tfNoisePos;
+
+void main () {
+    // dead particles are not captured, this keeps the state buffer compact
+    if (vAge [0] >= vLifetime [0])
+        return;
+
+    tfPosition = vPosition [0];
+    tfVelocity = vVelocity [0];
+    tfRotation = vRotation [0];
+    tfColor = vColor [0];
+    tfAlpha = vAlpha [0];
+    tfSize = vSize [0];
+    tfFrame = vFrame [0];
+    tfAge = vAge [0];
+    tfLifetime = vLifetime [0];
+    tfInitialColor = vInitialColor [0];
+    tfInitialAlpha = vInitialAlpha [0];
+    tfInitialSize = vInitialSize [0];
+    tfNoisePos = vNoisePos [0];
+    EmitVertex ();
+}
+)";
+
+GLuint compileShader (const GLenum type, const std::string& source) {
+    const char* sources [] = {source.c_str ()};
+    const GLuint shader = glCreateShader (type);
+
+    glShaderSource (shader, 1, sources, nullptr);
+    glCompileShader (shader);
+
+    GLint success;
+    glGetShaderiv (shader, GL_COMPILE_STATUS, &success);
+
+    if (!success) {
+        char infoLog [1024];
+        glGetShaderInfoLog (shader, sizeof (infoLog), nullptr, infoLog);
+        sLog.error ("GPU particle shader compilation failed: ", infoLog);
+        glDeleteShader (shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+std::string uniformName (size_t index, const char* name) {
+    return "u_Op" + std::to_string (index) + "_" + name;
+}
+} // namespace
+
+GPUParticleSimulator::GPUParticleSimulator (
+    const uint32_t capacity, std::vector<ParticleOperator> operators, const GPUAnimationSettings animation) :
+    m_operators (std::move (operators)),
+    m_animation (animation),
+    m_capacity (capacity) {}
+
+GPUParticleSimulator::~GPUParticleSimulator () {
+    sGPUResources.remove (this);
+    glDeleteProgram (this->m_program);
+    glDeleteTextures (1, &this->m_noiseTexture);
+    glDeleteBuffers (2, this->m_stateBuffers);
+    glDeleteVertexArrays (2, this->m_stateVaos);
+    glDeleteTransformFeedbacks (2, this->m_feedbacks);
+    glDeleteQueries (2, this->m_queries);
+    glDeleteBuffers (1, &this->m_spawnBuffer);
+    glDeleteVertexArrays (1, &this->m_spawnVao);
+}
+
+bool GPUParticleSimulator::canSimulate (const Particle& particle, const bool trails) {
+    // trails are expanded on the CPU from the particle velocity, angular velocity isn't part of the
+    // GPU record and control point attraction depends on per-frame mouse updates that stay on the CPU
+    if (trails)
+        return false;
+
+    for (const auto& op : particle.operators) {
+        if (!op)
+            continue;
+
+        if (!op->is<MovementOperator> () && !op->is<AlphaFadeOperator> () && !op->is<SizeChangeOperator> () &&
+            !op->is<AlphaChangeOperator> () && !op->is<ColorChangeOperator> () &&
+            !op->is<TurbulenceOperator> () && !op->is<VortexOperator> ())
+            return false;
+    }
+
+    return true;
+}
+
+bool GPUParticleSimulator::setup () {
+    // drawing the captured state without reading the count back needs transform feedback objects
+    if (!GLEW_ARB_transform_feedback2) {
+        sLog.out ("GPU particle simulation not available: missing GL_ARB_transform_feedback2");
+        return false;
+    }
+
+    const GLuint vertexShader = compileShader (GL_VERTEX_SHADER, this->buildUpdateShader ());
+    const GLuint geometryShader = compileShader (GL_GEOMETRY_SHADER, UPDATE_GEOMETRY);
+
+    if (vertexShader == 0 || geometryShader == 0) {
+        glDeleteShader (vertexShader);
+        glDeleteShader (geometryShader);
+        return false;
+    }
+
+    this->m_program = glCreateProgram ();
+    glAttachShader (this->m_program, vertexShader);
+    glAttachShader (this->m_program, geometryShader);
+    glTransformFeedbackVaryings (
+        this->m_program, std::size (FEEDBACK_VARYINGS), FEEDBACK_VARYINGS, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram (this->m_program);
+    glDeleteShader (vertexShader);
+    glDeleteShader (geometryShader);
+
+    GLint success;
+    glGetProgramiv (this->m_program, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        char infoLog [1024];
+        glGetProgramInfoLog (this->m_program, sizeof (infoLog), nullptr, infoLog);
+        sLog.error ("GPU particle program linking failed: ", infoLog);
+        glDeleteProgram (this->m_program);
+        this->m_program = 0;
+        return false;
+    }
+
+    this->m_uniformDt = glGetUniformLocation (this->m_program, "u_Dt");
+    this->m_uniformTime = glGetUniformLocation (this->m_program, "u_Time");
+    this->m_uniformNoise = glGetUniformLocation (this->m_program, "g_NoisePermutation");
+    this->m_uniformAnimationMode = glGetUniformLocation (this->m_program, "u_AnimationMode");
+    this->m_uniformAnimationFrames = glGetUniformLocation (this->m_program, "u_AnimationFrames");
+    this->m_uniformAnimationDuration = glGetUniformLocation (this->m_program, "u_AnimationDuration");
+    this->m_uniformAnimationSpeed = glGetUniformLocation (this->m_program, "u_AnimationSpeed");
+    this->setupOperatorUniforms ();
+
+    // permutation table for the perlin noise
+    glGenTextures (1, &this->m_noiseTexture);
+    glBindTexture (GL_TEXTURE_1D, this->m_noiseTexture);
+    glTexImage1D (
+        GL_TEXTURE_1D, 0, GL_R8UI, std::size (Utils::PERLIN_PERM), 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+        Utils::PERLIN_PERM);
+    glTexParameteri (GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri (GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture (GL_TEXTURE_1D, 0);
+
+    const GLsizeiptr stateSize = static_cast<GLsizeiptr> (this->m_capacity) * RECORD_FLOATS * sizeof (float);
+
+    glGenBuffers (2, this->m_stateBuffers);
+    glGenVertexArrays (2, this->m_stateVaos);
+    glGenTransformFeedbacks (2, this->m_feedbacks);
+    glGenQueries (2, this->m_queries);
+
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer (GL_ARRAY_BUFFER, this->m_stateBuffers [i]);
+        glBufferData (GL_ARRAY_BUFFER, stateSize, nullptr, GL_DYNAMIC_COPY);
+        this->setupVertexArray (this->m_stateVaos [i], this->m_stateBuffers [i]);
+
+        glBindTransformFeedback (GL_TRANSFORM_FEEDBACK, this->m_feedbacks [i]);
+        glBindBufferBase (GL_TRANSFORM_FEEDBACK_BUFFER, 0, this->m_stateBuffers [i]);
+    }
+
+    glBindTransformFeedback (GL_TRANSFORM_FEEDBACK, 0);
+
+    glGenBuffers (1, &this->m_spawnBuffer);
+    glGenVertexArrays (1, &this->m_spawnVao);
+    glBindBuffer (GL_ARRAY_BUFFER, this->m_spawnBuffer);
+    glBufferData (GL_ARRAY_BUFFER, stateSize, nullptr, GL_STREAM_DRAW);
+    this->setupVertexArray (this->m_spawnVao, this->m_spawnBuffer);
+
+    // both state buffers and the spawn one
+    sGPUResources.add (this, WallpaperEngine::Render::GPUResources::Type_Buffer, stateSize * 3, "particle state");
+
+    glBindBuffer (GL_ARRAY_BUFFER, 0);
+
+    this->m_spawnData.reserve (static_cast<size_t> (this->m_capacity) * RECORD_FLOATS);
+
+    return true;
+}
+
+void GPUParticleSimulator::setupVertexArray (const GLuint vao, const GLuint buffer) const {
+    constexpr GLsizei stride = RECORD_FLOATS * sizeof (float);
+    size_t offset = 0;
+
+    glBindVertexArray (vao);
+    glBindBuffer (GL_ARRAY_BUFFER, buffer);
+
+    for (GLuint location = 0; location < std::size (RECORD_ATTRIBUTES); location++) {
+        glEnableVertexAttribArray (location);
+        glVertexAttribPointer (
+            location, RECORD_ATTRIBUTES [location], GL_FLOAT, GL_FALSE, stride,
+            reinterpret_cast<void*> (offset * sizeof (float)));
+        offset += RECORD_ATTRIBUTES [location];
+    }
+
+    glBindVertexArray (0);
+}
+
+std::string GPUParticleSimulator::buildUpdateShader () const {
+    std::string uniforms;
+    std::string body;
+
+    for (size_t i = 0; i < this->m_operators.size (); i++) {
+        const auto& op = this->m_operators [i];
+        const auto name = [i] (const char* field) { return uniformName (i, field); };
+
+        if (std::holds_alternative<Operators::Movement> (op)) {
+            uniforms += "uniform float " + name ("Drag") + ";\n";
+            uniforms += "uniform vec3 " + name ("Gravity") + ";\n";
+            uniforms += "uniform float " + name ("Speed") + ";\n";
+            body += "    velocity += (-" + name ("Drag") + " * velocity + " + name ("Gravity") + ") * " +
+                    name ("Speed") + " * u_Dt;\n";
+            body += "    position += velocity * u_Dt;\n";
+        } else if (std::holds_alternative<Operators::AlphaFade> (op)) {
+            uniforms += "uniform float " + name ("FadeIn") + ";\n";
+            uniforms += "uniform float " + name ("FadeOut") + ";\n";
+            body += "    if (life <= " + name ("FadeIn") + ")\n";
+            body += "        alpha = aInitialAlpha * fadeValue (life, 0.0, " + name ("FadeIn") + ", 0.0, 1.0);\n";
+            body += "    else if (life > " + name ("FadeOut") + ")\n";
+            body += "        alpha = aInitialAlpha * (1.0 - fadeValue (life, " + name ("FadeOut") +
+                    ", 1.0, 0.0, 1.0));\n";
+            body += "    else\n";
+            body += "        alpha = aInitialAlpha;\n";
+        } else if (const auto* change = std::get_if<Operators::ValueChange> (&op)) {
+            const bool size = change->target == Operators::ValueChange::Size;
+
+            uniforms += "uniform vec4 " + name ("Change") + ";\n";
+            body += std::string ("    ") + (size ? "size = aInitialSize" : "alpha = aInitialAlpha") +
+                    " * fadeValue (life, " + name ("Change") + ".x, " + name ("Change") + ".y, " +
+                    name ("Change") + ".z, " + name ("Change") + ".w);\n";
+        } else if (std::holds_alternative<Operators::ColorChange> (op)) {
+            uniforms += "uniform vec2 " + name ("Time") + ";\n";
+            uniforms += "uniform vec3 " + name ("Start") + ";\n";
+            uniforms += "uniform vec3 " + name ("End") + ";\n";
+            body += "    color = aInitialColor * vec3 (\n";
+            for (const char* c : {"r", "g", "b"}) {
+                body += std::string ("        fadeValue (life, ") + name ("Time") + ".x, " + name ("Time") +
+                        ".y, " + name ("Start") + "." + c + ", " + name ("End") + "." + c + ")" +
+                        (c [0] == 'b' ? "\n" : ",\n");
+            }
+            body += "    );\n";
+        } else if (std::holds_alternative<Operators::Turbulence> (op)) {
+            // x = scale, y = speed, z = phase, w = time scale
+            uniforms += "uniform vec4 " + name ("Turbulence") + ";\n";
+            body += "    {\n";
+            body += "        vec4 t = " + name ("Turbulence") + ";\n";
+            body += "        if (length (noisePos) < 0.001 && aAge < 0.001)\n";
+            body += "            noisePos = position * t.x * 2.0 + (vec3 (hash (position + u_Time), hash (position - "
+                    "u_Time), hash (position.zxy + u_Time)) * 10.0 - 5.0);\n";
+            body += "        noisePos += normalize (velocity + vec3 (0.001)) * t.y * t.x * u_Dt;\n";
+            body += "        vec3 sampled = noisePos;\n";
+            body += "        sampled.x += t.z + t.w * u_Time;\n";
+            body += "        vec3 acceleration = curlNoise (sampled);\n";
+            body += "        if (length (acceleration) > 0.0)\n";
+            body += "            acceleration = normalize (acceleration) * t.y;\n";
+            body += "        velocity += acceleration * u_Dt;\n";
+            body += "    }\n";
+        } else if (std::holds_alternative<Operators::Vortex> (op)) {
+            // distances and speeds packed as inner, outer, speed inner, speed outer
+            uniforms += "uniform int " + name ("Active") + ";\n";
+            uniforms += "uniform vec3 " + name ("Axis") + ";\n";
+            uniforms += "uniform vec3 " + name ("Center") + ";\n";
+            uniforms += "uniform vec4 " + name ("Vortex") + ";\n";
+            body += "    if (" + name ("Active") + " == 1) {\n";
+            body += "        vec4 v = " + name ("Vortex") + ";\n";
+            body += "        vec3 toParticle = position - " + name ("Center") + ";\n";
+            body += "        float dist = length (toParticle);\n";
+            body += "        vec3 direct = -cross (" + name ("Axis") + ", toParticle);\n";
+            body += "        float disMid = v.y - v.x + 0.1;\n";
+            body += "        if (length (direct) > 0.001) {\n";
+            body += "            float speed = (disMid < 0.0 || dist < v.x) ? v.z : (dist > v.y ? v.w : mix (v.z, "
+                    "v.w, (dist - v.x) / disMid));\n";
+            body += "            velocity += normalize (direct) * speed * u_Dt;\n";
+            body += "        }\n";
+            body += "    }\n";
+        }
+    }
+
+    return std::string (UPDATE_HEADER) + STATE_LAYOUT + uniforms + R"(
+void main () {
+    vec3 position = aPosition;
+    vec3 velocity = aVelocity;
+    vec3 rotation = aRotation;
+    vec3 color = aColor;
+    float alpha = aAlpha;
+    float size = aSize;
+    float frame = aFrame;
+    float age = aAge + u_Dt;
+    vec3 noisePos = aNoisePos;
+    float life = aLifetime > 0.0 ? (age / aLifetime) : 1.0;
+
+)" + body + R"(
+    if (u_AnimationFrames > 0) {
+        float frames = float (u_AnimationFrames);
+
+        if (u_AnimationMode == 2) {
+            if (frame < 0.0)
+                frame = floor (hash (aPosition + aInitialColor + vec3 (aLifetime)) * frames);
+        } else if (u_AnimationMode == 1) {
+            frame = min (life * frames * u_AnimationSpeed, frames - 1.0);
+        } else if (u_AnimationDuration > 0.0) {
+            float cyclePos = mod (age * u_AnimationSpeed, u_AnimationDuration) / u_AnimationDuration;
+            frame = mod (cyclePos * frames, frames);
+        } else {
+            frame = mod (life * frames * u_AnimationSpeed, frames);
+        }
+    }
+
+    vPosition = position;
+    vVelocity = velocity;
+    vRotation = rotation;
+    vColor = color;
+    vAlpha = alpha;
+    vSize = size;
+    vFrame = frame;
+    vAge = age;
+    vLifetime = aLifetime;
+    vInitialColor = aInitialColor;
+    vInitialAlpha = aInitialAlpha;
+    vInitialSize = aInitialSize;
+    vNoisePos = noisePos;
+}
+)";
+}
+
+void GPUParticleSimulator::setupOperatorUniforms () {
+    this->m_operatorUniforms.clear ();
+
+    for (size_t i = 0; i < this->m_operators.size (); i++) {
+        const auto& op = this->m_operators [i];
+        std::vector<const char*> names;
+
+        if (std::holds_alternative<Operators::Movement> (op))
+            names = {"Drag", "Gravity", "Speed"};
+        else if (std::holds_alternative<Operators::AlphaFade> (op))
+            names = {"FadeIn", "FadeOut"};
+        else if (std::holds_alternative<Operators::ValueChange> (op))
+            names = {"Change"};
+        else if (std::holds_alternative<Operators::ColorChange> (op))
+            names = {"Time", "Start", "End"};
+        else if (std::holds_alternative<Operators::Turbulence> (op))
+            names = {"Turbulence"};
+        else if (std::holds_alternative<Operators::Vortex> (op))
+            names = {"Active", "Axis", "Center", "Vortex"};
+
+        std::vector<GLint> locations;
+
+        for (const char* name : names)
+            locations.push_back (glGetUniformLocation (this->m_program, uniformName (i, name).c_str ()));
+
+        this->m_operatorUniforms.push_back (std::move (locations));
+    }
+}
+
+void GPUParticleSimulator::updateOperatorUniforms (const OperatorFrame& frame) {
+    for (size_t i = 0; i < this->m_operators.size (); i++) {
+        auto& op = this->m_operators [i];
+        const auto& loc = this->m_operatorUniforms [i];
+
+        std::visit ([&frame] (auto& impl) { impl.prepare (frame); }, op);
+
+        if (const auto* movement = std::get_if<Operators::Movement> (&op)) {
+            glUniform1f (loc [0], movement->drag);
+            glUniform3fv (loc [1], 1, glm::value_ptr (movement->gravity));
+            glUniform1f (loc [2], movement->speed);
+        } else if (const auto* fade = std::get_if<Operators::AlphaFade> (&op)) {
+            glUniform1f (loc [0], fade->fadeInTime);
+            glUniform1f (loc [1], fade->fadeOutTime);
+        } else if (const auto* change = std::get_if<Operators::ValueChange> (&op)) {
+            glUniform4f (loc [0], change->startTime, change->endTime, change->startValue, change->endValue);
+        } else if (const auto* color = std::get_if<Operators::ColorChange> (&op)) {
+            glUniform2f (loc [0], color->startTime, color->endTime);
+            glUniform3fv (loc [1], 1, glm::value_ptr (color->startValue));
+            glUniform3fv (loc [2], 1, glm::value_ptr (color->endValue));
+        } else if (const auto* turbulence = std::get_if<Operators::Turbulence> (&op)) {
+            glUniform4f (loc [0], turbulence->scale, turbulence->speed, turbulence->phase, turbulence->timeScale);
+        } else if (const auto* vortex = std::get_if<Operators::Vortex> (&op)) {
+            glUniform1i (loc [0], vortex->active ? 1 : 0);
+            glUniform3fv (loc [1], 1, glm::value_ptr (vortex->axis));
+            glUniform3fv (loc [2], 1, glm::value_ptr (vortex->center));
+            glUniform4f (
+                loc [3], vortex->distanceInner, vortex->distanceOuter, vortex->speedInner, vortex->speedOuter);
+        }
+    }
+}
+
+void GPUParticleSimulator::uploadSpawned (const ParticlePool& spawned) {
+    const uint32_t count = spawned.getCount ();
+
+    this->m_spawnData.resize (static_cast<size_t> (count) * RECORD_FLOATS);
+
+    float* out = this->m_spawnData.data ();
+
+    const auto write = [&out] (const glm::vec3& value) {
+        *out++ = value.x;
+        *out++ = value.y;
+        *out++ = value.z;
+    };
+
+    for (uint32_t i = 0; i < count; i++) {
+        write (spawned.position [i]);
+        write (spawned.velocity [i]);
+        write (spawned.rotation [i]);
+        write (spawned.color [i]);
+        *out++ = spawned.alpha [i];
+        *out++ = spawned.size [i];
+        *out++ = spawned.frame [i];
+        *out++ = spawned.age [i];
+        *out++ = spawned.lifetime [i];
+        write (spawned.initialColor [i]);
+        *out++ = spawned.initialAlpha [i];
+        *out++ = spawned.initialSize [i];
+        write (spawned.noisePos [i]);
+    }
+
+    glBindBuffer (GL_ARRAY_BUFFER, this->m_spawnBuffer);
+    // orphan the previous contents so the driver doesn't have to wait for last frame's pass
+    glBufferData (
+        GL_ARRAY_BUFFER, static_cast<GLsizeiptr> (this->m_capacity) * RECORD_FLOATS * sizeof (float), nullptr,
+        GL_STREAM_DRAW);
+    glBufferSubData (
+        GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr> (this->m_spawnData.size () * sizeof (float)),
+        this->m_spawnData.data ());
+    glBindBuffer (GL_ARRAY_BUFFER, 0);
+}
+
+void GPUParticleSimulator::simulate (RenderState& state, ParticlePool& spawned, const OperatorFrame& frame) {
+    const uint32_t spawnCount = spawned.getCount ();
+    const int source = this->m_current;
+    const int destination = 1 - this->m_current;
+
+    // pick up any finished query without waiting for the GPU
+    for (int i = 0; i < 2; i++) {
+        if (!this->m_queryPending [i])
+            continue;
+
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv (this->m_queries [i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available == GL_FALSE)
+            continue;
+
+        GLuint written = 0;
+        glGetQueryObjectuiv (this->m_queries [i], GL_QUERY_RESULT, &written);
+        this->m_aliveEstimate = written;
+        this->m_queryPending [i] = false;
+    }
+
+    if (spawnCount > 0)
+        this->uploadSpawned (spawned);
+
+    spawned.clear ();
+
+    if (!this->m_hasState && spawnCount == 0)
+        return;
+
+#if !NDEBUG
+    glPushDebugGroup (GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Simulate GPU particles");
+#endif /* DEBUG */
+
+    state.useProgram (this->m_program);
+    glUniform1f (this->m_uniformDt, frame.dt);
+    glUniform1f (this->m_uniformTime, frame.time);
+    glUniform1i (this->m_uniformNoise, 0);
+    glUniform1i (this->m_uniformAnimationMode, static_cast<int> (this->m_animation.mode));
+    glUniform1i (this->m_uniformAnimationFrames, this->m_animation.frames);
+    glUniform1f (this->m_uniformAnimationDuration, this->m_animation.duration);
+    glUniform1f (this->m_uniformAnimationSpeed, this->m_animation.speed);
+    this->updateOperatorUniforms (frame);
+
+    state.bindTexture (0, this->m_noiseTexture, GL_NONE, GL_TEXTURE_1D);
+
+    glEnable (GL_RASTERIZER_DISCARD);
+    glBindTransformFeedback (GL_TRANSFORM_FEEDBACK, this->m_feedbacks [destination]);
+    glBeginQuery (GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, this->m_queries [destination]);
+    glBeginTransformFeedback (GL_POINTS);
+
+    // advance the alive particles first, then append the new ones after them
+    if (this->m_hasState) {
+        state.bindVertexArray (this->m_stateVaos [source]);
+        glDrawTransformFeedback (GL_POINTS, this->m_feedbacks [source]);
+    }
+
+    if (spawnCount > 0) {
+        state.bindVertexArray (this->m_spawnVao);
+        glDrawArrays (GL_POINTS, 0, static_cast<GLsizei> (spawnCount));
+    }
+
+    glEndTransformFeedback ();
+    glEndQuery (GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    glBindTransformFeedback (GL_TRANSFORM_FEEDBACK, 0);
+    glDisable (GL_RASTERIZER_DISCARD);
+
+#if !NDEBUG
+    glPopDebugGroup ();
+#endif /* DEBUG */
+
+    this->m_queryPending [destination] = true;
+    this->m_current = destination;
+    this->m_hasState = true;
+}
+
+void GPUParticleSimulator::draw (RenderState& state) const {
+    if (!this->m_hasState)
+        return;
+
+    state.bindVertexArray (this->m_stateVaos [this->m_current]);
+    glDrawTransformFeedback (GL_POINTS, this->m_feedbacks [this->m_current]);
+}
+
+uint32_t GPUParticleSimulator::getAliveEstimate () const {
+    return this->m_aliveEstimate;
+}
+
+uint32_t GPUParticleSimulator::getCapacity () const {
+    return this->m_capacity;
+}
+
+const char* GPUParticleSimulator::getStateLayout () {
+    return STATE_LAYOUT;
+}
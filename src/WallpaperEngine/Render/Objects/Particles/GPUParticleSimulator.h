@@ -0,0 +1,125 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+#include "WallpaperEngine/Data/Model/Object.h"
+#include "WallpaperEngine/Render/RenderState.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticleOperators.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticlePool.h"
+
+namespace WallpaperEngine::Render::Objects::Particles {
+/**
+ * Spritesheet animation settings the simulation needs to keep frames up to date
+ */
+struct GPUAnimationSettings {
+    enum Mode {
+        Loop = 0,
+        Once = 1,
+        RandomFrame = 2,
+    };
+
+    Mode mode = Loop;
+    int frames = 0;
+    float duration = 0.0f;
+    float speed = 1.0f;
+};
+
+/**
+ * Keeps particle state in GPU buffers and simulates it with transform feedback
+ *
+ * Emitters and initializers still run on the CPU, the particles they spawn every frame are appended to the
+ * GPU state in the same transform feedback pass that advances the already-alive particles. Dead particles
+ * are dropped by a geometry shader so the state buffer is always compact and can be drawn as-is
+ * with glDrawTransformFeedback without reading the particle count back
+ */
+class GPUParticleSimulator {
+  public:
+    /** Floats per particle record in the state buffers */
+    static constexpr int RECORD_FLOATS = 25;
+
+    GPUParticleSimulator (uint32_t capacity, std::vector<ParticleOperator> operators, GPUAnimationSettings animation);
+    ~GPUParticleSimulator ();
+
+    /**
+     * @param particle
+     * @param trails If the particle uses a trail renderer
+     *
+     * @return If every operator and renderer of the particle system can run on the GPU backend
+     */
+    [[nodiscard]] static bool canSimulate (const Data::Model::Particle& particle, bool trails);
+
+    /**
+     * Compiles the simulation program and creates the state buffers
+     *
+     * @return false if the driver doesn't support the backend, the caller should use the CPU simulation instead
+     */
+    bool setup ();
+
+    /**
+     * Appends the particles currently in the pool to the GPU state and advances the whole simulation
+     *
+     * @param state
+     * @param spawned Particles emitted this frame, the pool is cleared after upload
+     * @param frame
+     */
+    void simulate (RenderState& state, ParticlePool& spawned, const OperatorFrame& frame);
+
+    /**
+     * Draws the current state as GL_POINTS, the attribute layout matches getStateLayout ()
+     *
+     * @param state
+     */
+    void draw (RenderState& state) const;
+
+    /**
+     * @return Estimate of alive particles, lags a couple frames behind as it's read without stalling
+     */
+    [[nodiscard]] uint32_t getAliveEstimate () const;
+    [[nodiscard]] uint32_t getCapacity () const;
+
+    /**
+     * @return Vertex shader inputs matching the record layout, to be used by the render program
+     */
+    [[nodiscard]] static const char* getStateLayout ();
+
+  private:
+    void setupVertexArray (GLuint vao, GLuint buffer) const;
+    std::string buildUpdateShader () const;
+    void setupOperatorUniforms ();
+    void updateOperatorUniforms (const OperatorFrame& frame);
+    void uploadSpawned (const ParticlePool& spawned);
+
+    std::vector<ParticleOperator> m_operators;
+    /** uniform locations for every operator, in the order they're set in updateOperatorUniforms */
+    std::vector<std::vector<GLint>> m_operatorUniforms = {};
+    GPUAnimationSettings m_animation;
+    uint32_t m_capacity;
+
+    GLuint m_program = 0;
+    GLuint m_noiseTexture = 0;
+    GLuint m_stateBuffers [2] = {0, 0};
+    GLuint m_stateVaos [2] = {0, 0};
+    GLuint m_feedbacks [2] = {0, 0};
+    GLuint m_queries [2] = {0, 0};
+    GLuint m_spawnBuffer = 0;
+    GLuint m_spawnVao = 0;
+
+    GLint m_uniformDt = -1;
+    GLint m_uniformTime = -1;
+    GLint m_uniformNoise = -1;
+    GLint m_uniformAnimationMode = -1;
+    GLint m_uniformAnimationFrames = -1;
+    GLint m_uniformAnimationDuration = -1;
+    GLint m_uniformAnimationSpeed = -1;
+
+    /** index of the buffer holding the latest state */
+    int m_current = 0;
+    /** if the current buffer holds any state yet */
+    bool m_hasState = false;
+    bool m_queryPending [2] = {false, false};
+    uint32_t m_aliveEstimate = 0;
+    std::vector<float> m_spawnData = {};
+};
+} // namespace WallpaperEngine::Render::Objects::Particles
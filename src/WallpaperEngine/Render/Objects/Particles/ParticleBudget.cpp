@@ -0,0 +1,52 @@
+#include "ParticleBudget.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace WallpaperEngine::Render::Objects::Particles;
+
+ParticleBudget::ParticleBudget (const uint32_t maxParticles, const uint32_t maxMicroseconds) :
+    m_maxParticles (maxParticles),
+    m_maxMicroseconds (maxMicroseconds) {}
+
+void ParticleBudget::update (const uint32_t aliveParticles, const uint32_t microseconds) {
+    if (!this->isEnabled ())
+        return;
+
+    const auto elapsed = static_cast<float> (microseconds);
+
+    this->m_averageMicroseconds =
+        this->m_averageMicroseconds == 0.0f ? elapsed : this->m_averageMicroseconds * 0.9f + elapsed * 0.1f;
+
+    // usage of the most constrained budget, above 1 means over budget
+    float usage = 0.0f;
+
+    if (this->m_maxParticles > 0)
+        usage = std::max (usage, static_cast<float> (aliveParticles) / static_cast<float> (this->m_maxParticles));
+    if (this->m_maxMicroseconds > 0)
+        usage = std::max (usage, this->m_averageMicroseconds / static_cast<float> (this->m_maxMicroseconds));
+
+    if (usage > 1.0f)
+        this->m_scale *= std::max (1.0f - DECREASE_STEP, 1.0f / usage);
+    else if (usage < RECOVER_THRESHOLD)
+        this->m_scale += INCREASE_STEP;
+
+    this->m_scale = std::clamp (this->m_scale, MIN_SCALE, 1.0f);
+
+    if (std::abs (this->m_scale - this->m_loggedScale) >= 0.1f || (this->m_scale == 1.0f && this->m_loggedScale != 1.0f)) {
+        sLog.out (
+            "Particle budget scale ", this->m_scale, " (", aliveParticles, " particles, ",
+            static_cast<uint32_t> (this->m_averageMicroseconds), "us per frame)");
+
+        this->m_loggedScale = this->m_scale;
+    }
+}
+
+bool ParticleBudget::isEnabled () const {
+    return this->m_maxParticles > 0 || this->m_maxMicroseconds > 0;
+}
+
+float ParticleBudget::getScale () const {
+    return this->m_scale;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+namespace WallpaperEngine::Render::Objects::Particles {
+/**
+ * Keeps the particle systems of a scene within a live particle count and simulation time budget
+ *
+ * The scene reports every frame how many particles were alive and how long simulating them took, and the
+ * systems scale their emission rate, particle limit and trail subdivision by getScale (). The scale drops a bit
+ * every frame the budget is exceeded and climbs back slower once there's room again, so it settles instead
+ * of oscillating between both ends
+ */
+class ParticleBudget {
+  public:
+    /** Systems never go below this fraction of their authored values */
+    static constexpr float MIN_SCALE = 0.1f;
+    /** Largest change applied in a single frame when over budget */
+    static constexpr float DECREASE_STEP = 0.02f;
+    /** Change applied every frame while comfortably under budget */
+    static constexpr float INCREASE_STEP = 0.01f;
+    /** Usage below this fraction of the budget lets the scale grow again */
+    static constexpr float RECOVER_THRESHOLD = 0.85f;
+
+    /**
+     * @param maxParticles Live particles allowed, 0 for no limit
+     * @param maxMicroseconds Simulation time allowed per frame, 0 for no limit
+     */
+    explicit ParticleBudget (uint32_t maxParticles = 0, uint32_t maxMicroseconds = 0);
+
+    /**
+     * Feeds the measurements of the last frame
+     *
+     * @param aliveParticles
+     * @param microseconds
+     */
+    void update (uint32_t aliveParticles, uint32_t microseconds);
+
+    /** @return If there's any limit to enforce */
+    [[nodiscard]] bool isEnabled () const;
+    [[nodiscard]] float getScale () const;
+
+  private:
+    uint32_t m_maxParticles;
+    uint32_t m_maxMicroseconds;
+    /** frame times are noisy, the governor reacts to a moving average */
+    float m_averageMicroseconds = 0.0f;
+    float m_scale = 1.0f;
+    float m_loggedScale = 1.0f;
+};
+} // namespace WallpaperEngine::Render::Objects::Particles
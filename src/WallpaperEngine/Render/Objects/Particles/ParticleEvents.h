@@ -0,0 +1,23 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace WallpaperEngine::Render::Objects::Particles {
+/**
+ * Where the particles of a system were emitted and where they died during its last update
+ *
+ * Child systems consume the whole queue in one go after their parent's update, so a burst of a thousand deaths
+ * is a single pass over the child's emitters instead of a thousand independent spawns. Positions are in the
+ * space of the system that produced them
+ */
+struct ParticleEvents {
+    std::vector<glm::vec3> spawned = {};
+    std::vector<glm::vec3> died = {};
+
+    void clear () {
+        this->spawned.clear ();
+        this->died.clear ();
+    }
+};
+} // namespace WallpaperEngine::Render::Objects::Particles
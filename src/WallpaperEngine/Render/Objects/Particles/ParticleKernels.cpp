@@ -0,0 +1,406 @@
+#include "ParticleKernels.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PARTICLE_KERNELS_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define PARTICLE_KERNELS_NEON 1
+#endif
+
+using namespace WallpaperEngine::Render::Objects::Particles;
+
+// the vector kernels walk the vec3 streams as flat float arrays
+static_assert (sizeof (glm::vec3) == sizeof (float) * 3);
+
+namespace {
+constexpr float PI = 3.14159265358979323846f;
+constexpr float TWO_PI = PI * 2.0f;
+constexpr float INV_TWO_PI = 1.0f / TWO_PI;
+
+/**
+ * Per-component constants repeated so they can be loaded straight into 4 or 8 wide registers,
+ * 24 floats is the smallest run where the xyz pattern lines up with three 8-wide registers
+ */
+struct Vec3Pattern {
+    alignas (32) float values [24];
+
+    explicit Vec3Pattern (const glm::vec3& value) {
+        for (int i = 0; i < 24; i++)
+            values [i] = value [i % 3];
+    }
+};
+
+// ========== SCALAR ==========
+
+void movementScalar (
+    float* position, float* velocity, size_t start, size_t n, float k, const Vec3Pattern& gravity, float dt) {
+    for (size_t i = start; i < n; i++) {
+        velocity [i] = velocity [i] * k + gravity.values [i % 3];
+        position [i] += velocity [i] * dt;
+    }
+}
+
+void angularScalar (
+    float* rotation, float* angularVelocity, size_t start, size_t n, float k, const Vec3Pattern& force, float dt) {
+    for (size_t i = start; i < n; i++) {
+        angularVelocity [i] = angularVelocity [i] * k + force.values [i % 3];
+
+        const float r = rotation [i] + angularVelocity [i] * dt;
+
+        rotation [i] = r - TWO_PI * std::floor ((r + PI) * INV_TWO_PI);
+    }
+}
+
+void fadeScalar (
+    float* out, const float* initial, const float* age, const float* lifetime, size_t start, size_t n,
+    float startTime, float endTime, float startValue, float endValue) {
+    const float range = endTime - startTime;
+    const float delta = endValue - startValue;
+
+    for (size_t i = start; i < n; i++) {
+        const float life = lifetime [i] > 0.0f ? (age [i] / lifetime [i]) : 1.0f;
+        float multiplier;
+
+        if (life <= startTime)
+            multiplier = startValue;
+        else if (life >= endTime)
+            multiplier = endValue;
+        else
+            multiplier = startValue + ((life - startTime) / range) * delta;
+
+        out [i] = initial [i] * multiplier;
+    }
+}
+
+void movementScalarEntry (float* position, float* velocity, size_t n, float k, const Vec3Pattern& gravity, float dt) {
+    movementScalar (position, velocity, 0, n, k, gravity, dt);
+}
+
+void angularScalarEntry (
+    float* rotation, float* angularVelocity, size_t n, float k, const Vec3Pattern& force, float dt) {
+    angularScalar (rotation, angularVelocity, 0, n, k, force, dt);
+}
+
+void fadeScalarEntry (
+    float* out, const float* initial, const float* age, const float* lifetime, size_t n, float startTime,
+    float endTime, float startValue, float endValue) {
+    fadeScalar (out, initial, age, lifetime, 0, n, startTime, endTime, startValue, endValue);
+}
+
+#if PARTICLE_KERNELS_X86
+// ========== SSE4.1 ==========
+
+__attribute__ ((target ("sse4.1"))) void movementSSE (
+    float* position, float* velocity, size_t n, float k, const Vec3Pattern& gravity, float dt) {
+    const __m128 vk = _mm_set1_ps (k);
+    const __m128 vdt = _mm_set1_ps (dt);
+    const __m128 g0 = _mm_load_ps (gravity.values);
+    const __m128 g1 = _mm_load_ps (gravity.values + 4);
+    const __m128 g2 = _mm_load_ps (gravity.values + 8);
+    size_t i = 0;
+
+    for (; i + 12 <= n; i += 12) {
+        const __m128 v0 = _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (velocity + i), vk), g0);
+        const __m128 v1 = _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (velocity + i + 4), vk), g1);
+        const __m128 v2 = _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (velocity + i + 8), vk), g2);
+
+        _mm_storeu_ps (velocity + i, v0);
+        _mm_storeu_ps (velocity + i + 4, v1);
+        _mm_storeu_ps (velocity + i + 8, v2);
+        _mm_storeu_ps (position + i, _mm_add_ps (_mm_loadu_ps (position + i), _mm_mul_ps (v0, vdt)));
+        _mm_storeu_ps (position + i + 4, _mm_add_ps (_mm_loadu_ps (position + i + 4), _mm_mul_ps (v1, vdt)));
+        _mm_storeu_ps (position + i + 8, _mm_add_ps (_mm_loadu_ps (position + i + 8), _mm_mul_ps (v2, vdt)));
+    }
+
+    movementScalar (position, velocity, i, n, k, gravity, dt);
+}
+
+__attribute__ ((target ("sse4.1"))) inline __m128 wrapAngleSSE (__m128 r) {
+    const __m128 turns = _mm_floor_ps (_mm_mul_ps (_mm_add_ps (r, _mm_set1_ps (PI)), _mm_set1_ps (INV_TWO_PI)));
+
+    return _mm_sub_ps (r, _mm_mul_ps (turns, _mm_set1_ps (TWO_PI)));
+}
+
+__attribute__ ((target ("sse4.1"))) void angularSSE (
+    float* rotation, float* angularVelocity, size_t n, float k, const Vec3Pattern& force, float dt) {
+    const __m128 vk = _mm_set1_ps (k);
+    const __m128 vdt = _mm_set1_ps (dt);
+    const __m128 f [3] = {
+        _mm_load_ps (force.values), _mm_load_ps (force.values + 4), _mm_load_ps (force.values + 8)};
+    size_t i = 0;
+
+    for (; i + 12 <= n; i += 12) {
+        for (int j = 0; j < 3; j++) {
+            float* av = angularVelocity + i + j * 4;
+            float* r = rotation + i + j * 4;
+            const __m128 v = _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (av), vk), f [j]);
+
+            _mm_storeu_ps (av, v);
+            _mm_storeu_ps (r, wrapAngleSSE (_mm_add_ps (_mm_loadu_ps (r), _mm_mul_ps (v, vdt))));
+        }
+    }
+
+    angularScalar (rotation, angularVelocity, i, n, k, force, dt);
+}
+
+__attribute__ ((target ("sse4.1"))) void fadeSSE (
+    float* out, const float* initial, const float* age, const float* lifetime, size_t n, float startTime,
+    float endTime, float startValue, float endValue) {
+    const __m128 vstart = _mm_set1_ps (startTime);
+    const __m128 vend = _mm_set1_ps (endTime);
+    const __m128 vstartValue = _mm_set1_ps (startValue);
+    const __m128 vendValue = _mm_set1_ps (endValue);
+    const __m128 vinvRange = _mm_set1_ps (1.0f / (endTime - startTime));
+    const __m128 vdelta = _mm_set1_ps (endValue - startValue);
+    const __m128 zero = _mm_setzero_ps ();
+    const __m128 one = _mm_set1_ps (1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        const __m128 l = _mm_loadu_ps (lifetime + i);
+        const __m128 life = _mm_blendv_ps (one, _mm_div_ps (_mm_loadu_ps (age + i), l), _mm_cmpgt_ps (l, zero));
+        __m128 multiplier = _mm_add_ps (vstartValue, _mm_mul_ps (_mm_mul_ps (_mm_sub_ps (life, vstart), vinvRange), vdelta));
+
+        multiplier = _mm_blendv_ps (multiplier, vendValue, _mm_cmpge_ps (life, vend));
+        multiplier = _mm_blendv_ps (multiplier, vstartValue, _mm_cmple_ps (life, vstart));
+
+        _mm_storeu_ps (out + i, _mm_mul_ps (_mm_loadu_ps (initial + i), multiplier));
+    }
+
+    fadeScalar (out, initial, age, lifetime, i, n, startTime, endTime, startValue, endValue);
+}
+
+// ========== AVX2 ==========
+
+__attribute__ ((target ("avx2"))) void movementAVX2 (
+    float* position, float* velocity, size_t n, float k, const Vec3Pattern& gravity, float dt) {
+    const __m256 vk = _mm256_set1_ps (k);
+    const __m256 vdt = _mm256_set1_ps (dt);
+    const __m256 g0 = _mm256_load_ps (gravity.values);
+    const __m256 g1 = _mm256_load_ps (gravity.values + 8);
+    const __m256 g2 = _mm256_load_ps (gravity.values + 16);
+    size_t i = 0;
+
+    for (; i + 24 <= n; i += 24) {
+        const __m256 v0 = _mm256_add_ps (_mm256_mul_ps (_mm256_loadu_ps (velocity + i), vk), g0);
+        const __m256 v1 = _mm256_add_ps (_mm256_mul_ps (_mm256_loadu_ps (velocity + i + 8), vk), g1);
+        const __m256 v2 = _mm256_add_ps (_mm256_mul_ps (_mm256_loadu_ps (velocity + i + 16), vk), g2);
+
+        _mm256_storeu_ps (velocity + i, v0);
+        _mm256_storeu_ps (velocity + i + 8, v1);
+        _mm256_storeu_ps (velocity + i + 16, v2);
+        _mm256_storeu_ps (position + i, _mm256_add_ps (_mm256_loadu_ps (position + i), _mm256_mul_ps (v0, vdt)));
+        _mm256_storeu_ps (
+            position + i + 8, _mm256_add_ps (_mm256_loadu_ps (position + i + 8), _mm256_mul_ps (v1, vdt)));
+        _mm256_storeu_ps (
+            position + i + 16, _mm256_add_ps (_mm256_loadu_ps (position + i + 16), _mm256_mul_ps (v2, vdt)));
+    }
+
+    movementScalar (position, velocity, i, n, k, gravity, dt);
+}
+
+__attribute__ ((target ("avx2"))) inline __m256 wrapAngleAVX2 (__m256 r) {
+    const __m256 turns =
+        _mm256_floor_ps (_mm256_mul_ps (_mm256_add_ps (r, _mm256_set1_ps (PI)), _mm256_set1_ps (INV_TWO_PI)));
+
+    return _mm256_sub_ps (r, _mm256_mul_ps (turns, _mm256_set1_ps (TWO_PI)));
+}
+
+__attribute__ ((target ("avx2"))) void angularAVX2 (
+    float* rotation, float* angularVelocity, size_t n, float k, const Vec3Pattern& force, float dt) {
+    const __m256 vk = _mm256_set1_ps (k);
+    const __m256 vdt = _mm256_set1_ps (dt);
+    const __m256 f [3] = {
+        _mm256_load_ps (force.values), _mm256_load_ps (force.values + 8), _mm256_load_ps (force.values + 16)};
+    size_t i = 0;
+
+    for (; i + 24 <= n; i += 24) {
+        for (int j = 0; j < 3; j++) {
+            float* av = angularVelocity + i + j * 8;
+            float* r = rotation + i + j * 8;
+            const __m256 v = _mm256_add_ps (_mm256_mul_ps (_mm256_loadu_ps (av), vk), f [j]);
+
+            _mm256_storeu_ps (av, v);
+            _mm256_storeu_ps (r, wrapAngleAVX2 (_mm256_add_ps (_mm256_loadu_ps (r), _mm256_mul_ps (v, vdt))));
+        }
+    }
+
+    angularScalar (rotation, angularVelocity, i, n, k, force, dt);
+}
+
+__attribute__ ((target ("avx2"))) void fadeAVX2 (
+    float* out, const float* initial, const float* age, const float* lifetime, size_t n, float startTime,
+    float endTime, float startValue, float endValue) {
+    const __m256 vstart = _mm256_set1_ps (startTime);
+    const __m256 vend = _mm256_set1_ps (endTime);
+    const __m256 vstartValue = _mm256_set1_ps (startValue);
+    const __m256 vendValue = _mm256_set1_ps (endValue);
+    const __m256 vinvRange = _mm256_set1_ps (1.0f / (endTime - startTime));
+    const __m256 vdelta = _mm256_set1_ps (endValue - startValue);
+    const __m256 zero = _mm256_setzero_ps ();
+    const __m256 one = _mm256_set1_ps (1.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        const __m256 l = _mm256_loadu_ps (lifetime + i);
+        const __m256 life = _mm256_blendv_ps (
+            one, _mm256_div_ps (_mm256_loadu_ps (age + i), l), _mm256_cmp_ps (l, zero, _CMP_GT_OQ));
+        __m256 multiplier = _mm256_add_ps (
+            vstartValue, _mm256_mul_ps (_mm256_mul_ps (_mm256_sub_ps (life, vstart), vinvRange), vdelta));
+
+        multiplier = _mm256_blendv_ps (multiplier, vendValue, _mm256_cmp_ps (life, vend, _CMP_GE_OQ));
+        multiplier = _mm256_blendv_ps (multiplier, vstartValue, _mm256_cmp_ps (life, vstart, _CMP_LE_OQ));
+
+        _mm256_storeu_ps (out + i, _mm256_mul_ps (_mm256_loadu_ps (initial + i), multiplier));
+    }
+
+    fadeScalar (out, initial, age, lifetime, i, n, startTime, endTime, startValue, endValue);
+}
+#endif /* PARTICLE_KERNELS_X86 */
+
+#if PARTICLE_KERNELS_NEON
+// ========== NEON ==========
+
+void movementNEON (float* position, float* velocity, size_t n, float k, const Vec3Pattern& gravity, float dt) {
+    const float32x4_t vk = vdupq_n_f32 (k);
+    const float32x4_t vdt = vdupq_n_f32 (dt);
+    const float32x4_t g [3] = {
+        vld1q_f32 (gravity.values), vld1q_f32 (gravity.values + 4), vld1q_f32 (gravity.values + 8)};
+    size_t i = 0;
+
+    for (; i + 12 <= n; i += 12) {
+        for (int j = 0; j < 3; j++) {
+            float* v = velocity + i + j * 4;
+            float* p = position + i + j * 4;
+            const float32x4_t nv = vmlaq_f32 (g [j], vld1q_f32 (v), vk);
+
+            vst1q_f32 (v, nv);
+            vst1q_f32 (p, vmlaq_f32 (vld1q_f32 (p), nv, vdt));
+        }
+    }
+
+    movementScalar (position, velocity, i, n, k, gravity, dt);
+}
+
+void angularNEON (float* rotation, float* angularVelocity, size_t n, float k, const Vec3Pattern& force, float dt) {
+    const float32x4_t vk = vdupq_n_f32 (k);
+    const float32x4_t vdt = vdupq_n_f32 (dt);
+    const float32x4_t f [3] = {vld1q_f32 (force.values), vld1q_f32 (force.values + 4), vld1q_f32 (force.values + 8)};
+    size_t i = 0;
+
+    for (; i + 12 <= n; i += 12) {
+        for (int j = 0; j < 3; j++) {
+            float* av = angularVelocity + i + j * 4;
+            float* r = rotation + i + j * 4;
+            const float32x4_t v = vmlaq_f32 (f [j], vld1q_f32 (av), vk);
+            const float32x4_t nr = vmlaq_f32 (vld1q_f32 (r), v, vdt);
+            const float32x4_t turns = vrndmq_f32 (vmulq_f32 (vaddq_f32 (nr, vdupq_n_f32 (PI)), vdupq_n_f32 (INV_TWO_PI)));
+
+            vst1q_f32 (av, v);
+            vst1q_f32 (r, vmlsq_f32 (nr, turns, vdupq_n_f32 (TWO_PI)));
+        }
+    }
+
+    angularScalar (rotation, angularVelocity, i, n, k, force, dt);
+}
+
+void fadeNEON (
+    float* out, const float* initial, const float* age, const float* lifetime, size_t n, float startTime,
+    float endTime, float startValue, float endValue) {
+    const float32x4_t vstart = vdupq_n_f32 (startTime);
+    const float32x4_t vend = vdupq_n_f32 (endTime);
+    const float32x4_t vstartValue = vdupq_n_f32 (startValue);
+    const float32x4_t vendValue = vdupq_n_f32 (endValue);
+    const float32x4_t vinvRange = vdupq_n_f32 (1.0f / (endTime - startTime));
+    const float32x4_t vdelta = vdupq_n_f32 (endValue - startValue);
+    const float32x4_t zero = vdupq_n_f32 (0.0f);
+    const float32x4_t one = vdupq_n_f32 (1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t l = vld1q_f32 (lifetime + i);
+        const float32x4_t life = vbslq_f32 (vcgtq_f32 (l, zero), vdivq_f32 (vld1q_f32 (age + i), l), one);
+        float32x4_t multiplier = vmlaq_f32 (vstartValue, vmulq_f32 (vsubq_f32 (life, vstart), vinvRange), vdelta);
+
+        multiplier = vbslq_f32 (vcgeq_f32 (life, vend), vendValue, multiplier);
+        multiplier = vbslq_f32 (vcleq_f32 (life, vstart), vstartValue, multiplier);
+
+        vst1q_f32 (out + i, vmulq_f32 (vld1q_f32 (initial + i), multiplier));
+    }
+
+    fadeScalar (out, initial, age, lifetime, i, n, startTime, endTime, startValue, endValue);
+}
+#endif /* PARTICLE_KERNELS_NEON */
+
+struct KernelTable {
+    void (*movement) (float*, float*, size_t, float, const Vec3Pattern&, float);
+    void (*angular) (float*, float*, size_t, float, const Vec3Pattern&, float);
+    void (*fade) (float*, const float*, const float*, const float*, size_t, float, float, float, float);
+    const char* name;
+};
+
+KernelTable selectKernels () {
+#if PARTICLE_KERNELS_X86
+    __builtin_cpu_init ();
+
+    if (__builtin_cpu_supports ("avx2"))
+        return {movementAVX2, angularAVX2, fadeAVX2, "AVX2"};
+    if (__builtin_cpu_supports ("sse4.1"))
+        return {movementSSE, angularSSE, fadeSSE, "SSE4.1"};
+#elif PARTICLE_KERNELS_NEON
+    return {movementNEON, angularNEON, fadeNEON, "NEON"};
+#endif
+
+    return {movementScalarEntry, angularScalarEntry, fadeScalarEntry, "scalar"};
+}
+
+const KernelTable& kernels () {
+    static const KernelTable table = [] {
+        const KernelTable selected = selectKernels ();
+
+        sLog.debug ("Particle kernels using ", selected.name);
+
+        return selected;
+    }();
+
+    return table;
+}
+} // namespace
+
+void Kernels::integrateMovement (
+    glm::vec3* position, glm::vec3* velocity, const uint32_t count, const float drag, const glm::vec3& gravity,
+    const float speed, const float dt) {
+    // v += (-drag * v + g) * speed * dt folds into v = v * k + g * speed * dt
+    const float k = 1.0f - drag * speed * dt;
+    const Vec3Pattern pattern (gravity * (speed * dt));
+
+    kernels ().movement (
+        reinterpret_cast<float*> (position), reinterpret_cast<float*> (velocity), static_cast<size_t> (count) * 3, k,
+        pattern, dt);
+}
+
+void Kernels::integrateAngularMovement (
+    glm::vec3* rotation, glm::vec3* angularVelocity, const uint32_t count, const float drag, const glm::vec3& force,
+    const float dt) {
+    const float k = 1.0f - drag * dt;
+    const Vec3Pattern pattern (force * dt);
+
+    kernels ().angular (
+        reinterpret_cast<float*> (rotation), reinterpret_cast<float*> (angularVelocity),
+        static_cast<size_t> (count) * 3, k, pattern, dt);
+}
+
+void Kernels::fadeOverLifetime (
+    float* out, const float* initial, const float* age, const float* lifetime, const uint32_t count,
+    const float startTime, const float endTime, const float startValue, const float endValue) {
+    kernels ().fade (out, initial, age, lifetime, count, startTime, endTime, startValue, endValue);
+}
+
+const char* Kernels::getInstructionSet () {
+    return kernels ().name;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <cstdint>
+
+namespace WallpaperEngine::Render::Objects::Particles::Kernels {
+/**
+ * Integrates drag + gravity for the given particles
+ *
+ * Equivalent to velocity += ((-drag * velocity) + gravity) * speed * dt; position += velocity * dt;
+ */
+void integrateMovement (
+    glm::vec3* position, glm::vec3* velocity, uint32_t count, float drag, const glm::vec3& gravity, float speed,
+    float dt);
+
+/**
+ * Integrates angular drag + force and wraps the resulting rotation into [-pi, pi)
+ */
+void integrateAngularMovement (
+    glm::vec3* rotation, glm::vec3* angularVelocity, uint32_t count, float drag, const glm::vec3& force, float dt);
+
+/**
+ * Writes initial * fade (start, end, startValue, endValue) based on the lifetime position of every particle,
+ * used by both size and alpha change operators
+ */
+void fadeOverLifetime (
+    float* out, const float* initial, const float* age, const float* lifetime, uint32_t count, float startTime,
+    float endTime, float startValue, float endValue);
+
+/**
+ * @return The name of the instruction set the kernels were dispatched to
+ */
+const char* getInstructionSet ();
+} // namespace WallpaperEngine::Render::Objects::Particles::Kernels
@@ -0,0 +1,349 @@
+#include "ParticleOperators.h"
+#include "ParticleKernels.h"
+#include "WallpaperEngine/Threading/JobPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+using namespace WallpaperEngine::Render::Objects::Particles;
+
+namespace {
+// Helper: Linear interpolation
+inline float lerp (float t, float a, float b) {
+    return a + t * (b - a);
+}
+
+// Helper: Fade value change over lifetime
+inline float fadeValue (float life, float startTime, float endTime, float startValue, float endValue) {
+    if (life <= startTime)
+        return startValue;
+    else if (life >= endTime)
+        return endValue;
+    else {
+        float t = (life - startTime) / (endTime - startTime);
+        return lerp (t, startValue, endValue);
+    }
+}
+} // namespace
+
+// ========== MOVEMENT ==========
+
+void Operators::Movement::prepare (const OperatorFrame& frame) {
+    this->speed = this->speedValue->getFloat ();
+    this->drag = this->dragValue->getFloat ();
+    this->gravity = this->gravityValue->getVec3 ();
+    // Flip gravity Y for centered space
+    this->gravity.y = -this->gravity.y;
+    this->dt = frame.dt;
+}
+
+void Operators::Movement::apply (ParticlePool& particles, const uint32_t begin, const uint32_t end) {
+    // Apply drag and gravity, then update velocity and position
+    Kernels::integrateMovement (
+        particles.position.data () + begin, particles.velocity.data () + begin, end - begin, this->drag,
+        this->gravity, this->speed, this->dt);
+}
+
+void Operators::AngularMovement::prepare (const OperatorFrame& frame) {
+    this->drag = this->dragValue->getFloat ();
+    this->force = this->forceValue->getVec3 ();
+    this->dt = frame.dt;
+}
+
+void Operators::AngularMovement::apply (ParticlePool& particles, const uint32_t begin, const uint32_t end) {
+    // Rotation is wrapped to [-pi, pi) to prevent floating-point precision issues
+    Kernels::integrateAngularMovement (
+        particles.rotation.data () + begin, particles.angularVelocity.data () + begin, end - begin, this->drag,
+        this->force, this->dt);
+}
+
+// ========== LIFETIME ==========
+
+void Operators::AlphaFade::prepare (const OperatorFrame& frame) {
+    this->fadeInTime = this->fadeInTimeValue->getFloat ();
+    this->fadeOutTime = this->fadeOutTimeValue->getFloat ();
+}
+
+void Operators::AlphaFade::apply (ParticlePool& particles, const uint32_t begin, const uint32_t end) {
+    float* alpha = particles.alpha.data ();
+    const float* initialAlpha = particles.initialAlpha.data ();
+
+    for (uint32_t i = begin; i < end; i++) {
+        float life = particles.getLifetimePos (i);
+
+        if (life <= this->fadeInTime) {
+            float fade = fadeValue (life, 0.0f, this->fadeInTime, 0.0f, 1.0f);
+            alpha [i] = initialAlpha [i] * fade;
+        } else if (life > this->fadeOutTime) {
+            float fade = 1.0f - fadeValue (life, this->fadeOutTime, 1.0f, 0.0f, 1.0f);
+            alpha [i] = initialAlpha [i] * fade;
+        } else {
+            alpha [i] = initialAlpha [i];
+        }
+    }
+}
+
+void Operators::ValueChange::prepare (const OperatorFrame& frame) {
+    this->startTime = this->startTimeValue->getFloat ();
+    this->endTime = this->endTimeValue->getFloat ();
+    this->startValue = this->startValueValue->getFloat ();
+    this->endValue = this->endValueValue->getFloat ();
+}
+
+void Operators::ValueChange::apply (ParticlePool& particles, const uint32_t begin, const uint32_t end) {
+    float* out = this->target == Size ? particles.size.data () : particles.alpha.data ();
+    const float* initial = this->target == Size ? particles.initialSize.data () : particles.initialAlpha.data ();
+
+    Kernels::fadeOverLifetime (
+        out + begin, initial + begin, particles.age.data () + begin, particles.lifetime.data () + begin,
+        end - begin, this->startTime, this->endTime, this->startValue, this->endValue);
+}
+
+void Operators::ColorChange::prepare (const OperatorFrame& frame) {
+    this->startTime = this->startTimeValue->getFloat ();
+    this->endTime = this->endTimeValue->getFloat ();
+    this->startValue = this->startValueValue->getVec3 ();
+    this->endValue = this->endValueValue->getVec3 ();
+}
+
+void Operators::ColorChange::apply (ParticlePool& particles, const uint32_t begin, const uint32_t end) {
+    glm::vec3* particleColor = particles.color.data ();
+    const glm::vec3* initialColor = particles.initialColor.data ();
+
+    for (uint32_t i = begin; i < end; i++) {
+        float life = particles.getLifetimePos (i);
+
+        glm::vec3 color;
+        color.r = fadeValue (life, this->startTime, this->endTime, this->startValue.r, this->endValue.r);
+        color.g = fadeValue (life, this->startTime, this->endTime, this->startValue.g, this->endValue.g);
+        color.b = fadeValue (life, this->startTime, this->endTime, this->startValue.b, this->endValue.b);
+
+        particleColor [i] = initialColor [i] * color;
+    }
+}
+
+// ========== FORCES ==========
+
+void Operators::Turbulence::prepare (const OperatorFrame& frame) {
+    this->scale = this->scaleValue->getFloat ();
+    this->timeScale = this->timeScaleValue->getFloat ();
+    this->time = frame.time;
+    this->dt = frame.dt;
+    this->seed = this->rng->next ();
+}
+
+void Operators::Turbulence::apply (ParticlePool& particles, const uint32_t begin, const uint32_t end) {
+    const glm::vec3* position = particles.position.data ();
+    glm::vec3* velocity = particles.velocity.data ();
+    glm::vec3* noisePos = particles.noisePos.data ();
+    const float* age = particles.age.data ();
+    // chunks may run on different threads, each one gets its own generator
+    ParticleRandom rng (this->seed + begin);
+
+    for (uint32_t i = begin; i < end; i++) {
+        // Initialize noise position if not set (for particles without turbulentvelocityrandom initializer)
+        if (glm::length (noisePos [i]) < 0.001f && age [i] < 0.001f) {
+            // Use particle position plus small random offset to break clustering
+            // for particles spawned at the same location
+            glm::vec3 randomOffset (
+                rng.range (-5.0f, 5.0f),
+                rng.range (-5.0f, 5.0f),
+                rng.range (-5.0f, 5.0f)
+            );
+            noisePos [i] = position [i] * this->scale * 2.0f + randomOffset;
+        }
+
+        // Advance noise position based on particle's current velocity direction
+        // This creates per-particle turbulence paths instead of uniform motion
+        glm::vec3 noiseVelocity = glm::normalize (velocity [i] + glm::vec3 (0.001f)) * this->speed * this->scale;
+        noisePos [i] += noiseVelocity * this->dt;
+
+        // Apply time-based phase shift
+        glm::vec3 sampledNoisePos = noisePos [i];
+        sampledNoisePos.x += this->phase + this->timeScale * this->time;
+
+        // Get curl noise acceleration
+        glm::vec3 acceleration = this->noise->sample (sampledNoisePos);
+
+        // Normalize and scale by speed
+        if (glm::length (acceleration) > 0.0f) {
+            acceleration = glm::normalize (acceleration) * this->speed;
+        }
+
+        // Apply acceleration (convert to velocity change over dt)
+        velocity [i] += acceleration * this->dt;
+    }
+}
+
+void Operators::Vortex::prepare (const OperatorFrame& frame) {
+    // Audio modulation (when implemented, this will sample from audio context)
+    float audioAmplitude = 0.0f; // TODO: Sample from AudioContext when audio processing is implemented
+
+    // If audio mode is enabled but no audio, skip vortex entirely
+    this->active = !(this->audioMode > 0 && audioAmplitude == 0.0f);
+
+    if (!this->active)
+        return;
+
+    this->axis = this->axisValue->getVec3 ();
+    glm::vec3 offset = this->offsetValue->getVec3 ();
+    this->distanceInner = this->distanceInnerValue->getFloat ();
+    this->distanceOuter = this->distanceOuterValue->getFloat ();
+    this->speedInner = this->speedInnerValue->getFloat ();
+    this->speedOuter = this->speedOuterValue->getFloat ();
+    this->dt = frame.dt;
+
+    // Apply audio modulation to speeds
+    if (this->audioMode > 0) {
+        this->speedInner *= (1.0f + audioAmplitude);
+        this->speedOuter *= (1.0f + audioAmplitude);
+    }
+
+    // Get vortex center from control point
+    if (this->controlPoint >= 0 && this->controlPoint < static_cast<int> (frame.controlPoints.size ())) {
+        this->center = frame.controlPoints [this->controlPoint].position + offset;
+    } else {
+        this->center = offset;
+    }
+
+    // Normalize axis
+    if (glm::length (this->axis) > 0.0f) {
+        this->axis = glm::normalize (this->axis);
+    } else {
+        this->axis = glm::vec3 (0.0f, 0.0f, 1.0f); // Default to Z-axis
+    }
+}
+
+void Operators::Vortex::apply (ParticlePool& particles, const uint32_t begin, const uint32_t end) {
+    if (!this->active)
+        return;
+
+    const glm::vec3* position = particles.position.data ();
+    glm::vec3* velocity = particles.velocity.data ();
+    const float disMid = this->distanceOuter - this->distanceInner + 0.1f;
+
+    for (uint32_t i = begin; i < end; i++) {
+        // Calculate distance from vortex center
+        glm::vec3 toParticle = position [i] - this->center;
+        float distance = glm::length (toParticle);
+
+        // Compute tangent direction (perpendicular to both axis and position vector)
+        // Negative cross product to match rotation direction
+        glm::vec3 direct = -glm::cross (this->axis, toParticle);
+        if (glm::length (direct) > 0.001f) {
+            direct = glm::normalize (direct);
+        } else {
+            continue; // Particle is on the axis
+        }
+
+        // Determine speed based on distance (matching KDE logic)
+        float speed = 0.0f;
+        if (disMid < 0 || distance < this->distanceInner) {
+            // Inside inner radius or invalid range - use inner speed
+            speed = this->speedInner;
+        } else if (distance > this->distanceOuter) {
+            // Outside outer radius - use outer speed
+            speed = this->speedOuter;
+        } else {
+            // Between inner and outer - interpolate
+            float t = (distance - this->distanceInner) / disMid;
+            speed = glm::mix (this->speedInner, this->speedOuter, t);
+        }
+
+        // Apply tangential velocity (spinning)
+        velocity [i] += direct * speed * this->dt;
+    }
+}
+
+void Operators::ControlPointAttract::prepare (const OperatorFrame& frame) {
+    // Get control point position
+    this->active = this->controlPoint >= 0 && this->controlPoint < static_cast<int> (frame.controlPoints.size ());
+
+    if (!this->active)
+        return;
+
+    this->center = frame.controlPoints [this->controlPoint].position + this->originValue->getVec3 ();
+    this->scale = this->scaleValue->getFloat ();
+    this->threshold = this->thresholdValue->getFloat ();
+    this->dt = frame.dt;
+}
+
+void Operators::ControlPointAttract::apply (ParticlePool& particles, const uint32_t begin, const uint32_t end) {
+    if (!this->active)
+        return;
+
+    const glm::vec3* position = particles.position.data ();
+    glm::vec3* velocity = particles.velocity.data ();
+
+    // Apply attraction force to all particles within threshold
+    for (uint32_t i = begin; i < end; i++) {
+        if (!particles.alive [i]) continue;
+
+        // Calculate distance and direction to control point
+        glm::vec3 toCenter = this->center - position [i];
+        float distance = glm::length (toCenter);
+
+        // Only apply force if within threshold
+        if (distance > 0.001f && distance < this->threshold) {
+            // Normalize direction
+            glm::vec3 direction = toCenter / distance;
+
+            // Apply constant force (scale value) in direction of control point
+            // Scale can be negative for repulsion, positive for attraction
+            velocity [i] += direction * this->scale * this->dt;
+
+            // For attraction (positive scale), apply velocity damping near center
+            // This slows particles down as they approach the control point
+            if (this->scale > 0 && distance < this->threshold * 0.1f) {
+                // Damping factor increases as particle gets closer (0.0 at threshold*0.1, 0.75 at distance 0)
+                float dampingFactor = 1.0f - (distance / (this->threshold * 0.1f)) * 0.75f;
+                velocity [i] *= (1.0f - dampingFactor * this->dt);
+            }
+        }
+    }
+}
+
+// ========== PIPELINE ==========
+
+void OperatorPipeline::add (ParticleOperator op) {
+    this->m_operators.push_back (std::move (op));
+}
+
+void OperatorPipeline::run (ParticlePool& particles, const OperatorFrame& frame) {
+    const uint32_t count = particles.getCount ();
+
+    if (count == 0 || this->m_operators.empty ())
+        return;
+
+    for (auto& op : this->m_operators)
+        std::visit ([&frame] (auto& impl) { impl.prepare (frame); }, op);
+
+    const auto applyChunks = [this, &particles] (const uint32_t first, const uint32_t last) {
+        for (uint32_t begin = first; begin < last; begin += CHUNK_SIZE) {
+            const uint32_t end = std::min (begin + CHUNK_SIZE, last);
+
+            for (auto& op : this->m_operators)
+                std::visit ([&particles, begin, end] (auto& impl) { impl.apply (particles, begin, end); }, op);
+        }
+    };
+
+    if (count < PARALLEL_THRESHOLD) {
+        applyChunks (0, count);
+        return;
+    }
+
+    sJobPool.parallelFor (count, JOB_SIZE, applyChunks);
+}
+
+bool OperatorPipeline::empty () const {
+    return this->m_operators.empty ();
+}
+
+size_t OperatorPipeline::size () const {
+    return this->m_operators.size ();
+}
+
+const std::vector<ParticleOperator>& OperatorPipeline::getOperators () const {
+    return this->m_operators;
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "WallpaperEngine/Data/Model/DynamicValue.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticlePool.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticleRandom.h"
+#include "WallpaperEngine/Render/Utils/CurlNoiseField.h"
+
+#include <glm/vec3.hpp>
+#include <cstddef>
+#include <variant>
+#include <vector>
+
+namespace WallpaperEngine::Render::Objects::Particles {
+using WallpaperEngine::Data::Model::DynamicValue;
+
+/**
+ * Control point runtime data
+ */
+struct ControlPointData {
+    glm::vec3 position {0.0f};
+    glm::vec3 offset {0.0f};
+    bool linkMouse {false};
+    bool worldSpace {false};
+};
+
+/**
+ * Per-frame state shared by every operator
+ */
+struct OperatorFrame {
+    const std::vector<ControlPointData>& controlPoints;
+    float time;
+    float dt;
+};
+
+/**
+ * Operator implementations
+ *
+ * Every operator reads its dynamic values once per frame in prepare () and then
+ * processes particles in [begin, end) in apply (), so the pipeline can run all of them
+ * over one chunk of particles before moving to the next
+ */
+namespace Operators {
+struct Movement {
+    const DynamicValue* speedValue;
+    const DynamicValue* dragValue;
+    const DynamicValue* gravityValue;
+
+    float speed = 0.0f;
+    float drag = 0.0f;
+    glm::vec3 gravity {0.0f};
+    float dt = 0.0f;
+
+    void prepare (const OperatorFrame& frame);
+    void apply (ParticlePool& particles, uint32_t begin, uint32_t end);
+};
+
+struct AngularMovement {
+    const DynamicValue* dragValue;
+    const DynamicValue* forceValue;
+
+    float drag = 0.0f;
+    glm::vec3 force {0.0f};
+    float dt = 0.0f;
+
+    void prepare (const OperatorFrame& frame);
+    void apply (ParticlePool& particles, uint32_t begin, uint32_t end);
+};
+
+struct AlphaFade {
+    const DynamicValue* fadeInTimeValue;
+    const DynamicValue* fadeOutTimeValue;
+
+    float fadeInTime = 0.0f;
+    float fadeOutTime = 0.0f;
+
+    void prepare (const OperatorFrame& frame);
+    void apply (ParticlePool& particles, uint32_t begin, uint32_t end);
+};
+
+/**
+ * Shared by sizechange and alphachange, only the target stream differs
+ */
+struct ValueChange {
+    enum Target {
+        Size = 0,
+        Alpha = 1
+    };
+
+    Target target;
+    const DynamicValue* startTimeValue;
+    const DynamicValue* endTimeValue;
+    const DynamicValue* startValueValue;
+    const DynamicValue* endValueValue;
+
+    float startTime = 0.0f;
+    float endTime = 0.0f;
+    float startValue = 0.0f;
+    float endValue = 0.0f;
+
+    void prepare (const OperatorFrame& frame);
+    void apply (ParticlePool& particles, uint32_t begin, uint32_t end);
+};
+
+struct ColorChange {
+    const DynamicValue* startTimeValue;
+    const DynamicValue* endTimeValue;
+    const DynamicValue* startValueValue;
+    const DynamicValue* endValueValue;
+
+    float startTime = 0.0f;
+    float endTime = 0.0f;
+    glm::vec3 startValue {0.0f};
+    glm::vec3 endValue {0.0f};
+
+    void prepare (const OperatorFrame& frame);
+    void apply (ParticlePool& particles, uint32_t begin, uint32_t end);
+};
+
+struct Turbulence {
+    const DynamicValue* scaleValue;
+    const DynamicValue* timeScaleValue;
+    /** random phase for noise offset */
+    float phase;
+    float speed;
+    ParticleRandom* rng;
+    const Utils::CurlNoiseField* noise;
+
+    /** drawn from rng every frame, chunks derive their own generator from it so they can run in parallel */
+    uint32_t seed = 0;
+    float scale = 0.0f;
+    float timeScale = 0.0f;
+    float time = 0.0f;
+    float dt = 0.0f;
+
+    void prepare (const OperatorFrame& frame);
+    void apply (ParticlePool& particles, uint32_t begin, uint32_t end);
+};
+
+struct Vortex {
+    int controlPoint;
+    int audioMode;
+    const DynamicValue* axisValue;
+    const DynamicValue* offsetValue;
+    const DynamicValue* distanceInnerValue;
+    const DynamicValue* distanceOuterValue;
+    const DynamicValue* speedInnerValue;
+    const DynamicValue* speedOuterValue;
+
+    bool active = false;
+    glm::vec3 axis {0.0f, 0.0f, 1.0f};
+    glm::vec3 center {0.0f};
+    float distanceInner = 0.0f;
+    float distanceOuter = 0.0f;
+    float speedInner = 0.0f;
+    float speedOuter = 0.0f;
+    float dt = 0.0f;
+
+    void prepare (const OperatorFrame& frame);
+    void apply (ParticlePool& particles, uint32_t begin, uint32_t end);
+};
+
+struct ControlPointAttract {
+    int controlPoint;
+    const DynamicValue* originValue;
+    const DynamicValue* scaleValue;
+    const DynamicValue* thresholdValue;
+
+    bool active = false;
+    glm::vec3 center {0.0f};
+    float scale = 0.0f;
+    float threshold = 0.0f;
+    float dt = 0.0f;
+
+    void prepare (const OperatorFrame& frame);
+    void apply (ParticlePool& particles, uint32_t begin, uint32_t end);
+};
+} // namespace Operators
+
+using ParticleOperator = std::variant<
+    Operators::Movement, Operators::AngularMovement, Operators::AlphaFade, Operators::ValueChange,
+    Operators::ColorChange, Operators::Turbulence, Operators::Vortex, Operators::ControlPointAttract>;
+
+/**
+ * Runs the operators of a particle system as a single fused pass
+ *
+ * Instead of every operator walking the whole pool, the pool is split in chunks small enough to stay in cache
+ * and the full operator list is applied to one chunk before moving on to the next one. Dispatch goes through
+ * std::visit so each call resolves to the concrete operator without type erasure. Big systems hand groups
+ * of chunks to the job pool, operators never share state between chunks
+ */
+class OperatorPipeline {
+  public:
+    /** Particles processed by every operator before moving to the next chunk */
+    static constexpr uint32_t CHUNK_SIZE = 256;
+    /** Particles handed to a single job when the pipeline runs in parallel */
+    static constexpr uint32_t JOB_SIZE = CHUNK_SIZE * 8;
+    /** Below this amount of particles the job overhead isn't worth it */
+    static constexpr uint32_t PARALLEL_THRESHOLD = JOB_SIZE * 2;
+
+    void add (ParticleOperator op);
+    void run (ParticlePool& particles, const OperatorFrame& frame);
+
+    [[nodiscard]] bool empty () const;
+    [[nodiscard]] size_t size () const;
+    [[nodiscard]] const std::vector<ParticleOperator>& getOperators () const;
+
+  private:
+    std::vector<ParticleOperator> m_operators = {};
+};
+} // namespace WallpaperEngine::Render::Objects::Particles
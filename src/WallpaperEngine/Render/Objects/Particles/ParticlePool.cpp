@@ -0,0 +1,204 @@
+#include "ParticlePool.h"
+
+#include <algorithm>
+
+using namespace WallpaperEngine::Render::Objects::Particles;
+
+void ParticlePool::reserve (const uint32_t capacity) {
+    this->position.resize (capacity);
+    this->previousPosition.resize (capacity);
+    this->velocity.resize (capacity);
+    this->rotation.resize (capacity);
+    this->angularVelocity.resize (capacity);
+    this->color.resize (capacity);
+    this->alpha.resize (capacity);
+    this->size.resize (capacity);
+    this->frame.resize (capacity);
+    this->lifetime.resize (capacity);
+    this->age.resize (capacity);
+    this->noisePos.resize (capacity);
+    this->initialColor.resize (capacity);
+    this->initialAlpha.resize (capacity);
+    this->initialSize.resize (capacity);
+    this->initialLifetime.resize (capacity);
+    this->alive.resize (capacity);
+    this->m_survivors.reserve (capacity);
+
+    this->m_capacity = capacity;
+    this->m_limit = capacity;
+    this->m_count = 0;
+}
+
+uint32_t ParticlePool::spawn () {
+    const uint32_t index = this->m_count++;
+
+    this->position [index] = glm::vec3 (0.0f);
+    this->previousPosition [index] = glm::vec3 (0.0f);
+    this->velocity [index] = glm::vec3 (0.0f);
+    this->rotation [index] = glm::vec3 (0.0f);
+    this->angularVelocity [index] = glm::vec3 (0.0f);
+    this->color [index] = glm::vec3 (1.0f);
+    this->alpha [index] = 1.0f;
+    this->size [index] = 20.0f;
+    this->frame [index] = -1.0f;
+    this->lifetime [index] = 1.0f;
+    this->age [index] = 0.0f;
+    this->noisePos [index] = glm::vec3 (0.0f);
+    this->initialColor [index] = glm::vec3 (1.0f);
+    this->initialAlpha [index] = 1.0f;
+    this->initialSize [index] = 20.0f;
+    this->initialLifetime [index] = 1.0f;
+    this->alive [index] = true;
+
+    return index;
+}
+
+uint32_t ParticlePool::compact (std::vector<glm::vec3>* died) {
+    // everything before the first dead particle is already in place
+    uint32_t first = 0;
+
+    while (first < this->m_count && this->isAlive (first))
+        first++;
+
+    if (first == this->m_count)
+        return 0;
+
+    this->m_survivors.clear ();
+
+    if (died != nullptr)
+        died->push_back (this->position [first]);
+
+    for (uint32_t i = first + 1; i < this->m_count; i++) {
+        if (this->isAlive (i))
+            this->m_survivors.push_back (i);
+        else if (died != nullptr)
+            died->push_back (this->position [i]);
+    }
+
+    const auto compactStream = [this, first] (auto& stream) {
+        uint32_t target = first;
+
+        for (const uint32_t source : this->m_survivors)
+            stream [target++] = stream [source];
+    };
+
+    compactStream (this->position);
+    compactStream (this->previousPosition);
+    compactStream (this->velocity);
+    compactStream (this->rotation);
+    compactStream (this->angularVelocity);
+    compactStream (this->color);
+    compactStream (this->alpha);
+    compactStream (this->size);
+    compactStream (this->frame);
+    compactStream (this->lifetime);
+    compactStream (this->age);
+    compactStream (this->noisePos);
+    compactStream (this->initialColor);
+    compactStream (this->initialAlpha);
+    compactStream (this->initialSize);
+    compactStream (this->initialLifetime);
+
+    const uint32_t count = first + static_cast<uint32_t> (this->m_survivors.size ());
+    const uint32_t removed = this->m_count - count;
+
+    // survivors are alive by definition, only the freed tail needs clearing
+    std::fill (this->alive.begin () + first, this->alive.begin () + count, 1);
+    std::fill (this->alive.begin () + count, this->alive.begin () + this->m_count, 0);
+    this->m_count = count;
+
+    return removed;
+}
+
+void ParticlePool::clear () {
+    std::fill_n (this->alive.begin (), this->m_count, 0);
+    this->m_count = 0;
+}
+
+void ParticlePool::storePreviousPositions () {
+    std::copy_n (this->position.begin (), this->m_count, this->previousPosition.begin ());
+}
+
+void ParticlePool::write (std::ostream& out) const {
+    const auto writeStream = [this, &out] (const auto& stream) {
+        out.write (reinterpret_cast<const char*> (stream.data ()), sizeof (stream [0]) * this->m_count);
+    };
+
+    out.write (reinterpret_cast<const char*> (&this->m_capacity), sizeof (this->m_capacity));
+    out.write (reinterpret_cast<const char*> (&this->m_count), sizeof (this->m_count));
+
+    writeStream (this->position);
+    writeStream (this->previousPosition);
+    writeStream (this->velocity);
+    writeStream (this->rotation);
+    writeStream (this->angularVelocity);
+    writeStream (this->color);
+    writeStream (this->alpha);
+    writeStream (this->size);
+    writeStream (this->frame);
+    writeStream (this->lifetime);
+    writeStream (this->age);
+    writeStream (this->noisePos);
+    writeStream (this->initialColor);
+    writeStream (this->initialAlpha);
+    writeStream (this->initialSize);
+    writeStream (this->initialLifetime);
+}
+
+bool ParticlePool::read (std::istream& in) {
+    uint32_t capacity = 0;
+    uint32_t count = 0;
+
+    this->clear ();
+
+    in.read (reinterpret_cast<char*> (&capacity), sizeof (capacity));
+    in.read (reinterpret_cast<char*> (&count), sizeof (count));
+
+    if (!in || capacity != this->m_capacity || count > capacity)
+        return false;
+
+    const auto readStream = [&in, count] (auto& stream) {
+        in.read (reinterpret_cast<char*> (stream.data ()), sizeof (stream [0]) * count);
+    };
+
+    readStream (this->position);
+    readStream (this->previousPosition);
+    readStream (this->velocity);
+    readStream (this->rotation);
+    readStream (this->angularVelocity);
+    readStream (this->color);
+    readStream (this->alpha);
+    readStream (this->size);
+    readStream (this->frame);
+    readStream (this->lifetime);
+    readStream (this->age);
+    readStream (this->noisePos);
+    readStream (this->initialColor);
+    readStream (this->initialAlpha);
+    readStream (this->initialSize);
+    readStream (this->initialLifetime);
+
+    if (!in)
+        return false;
+
+    std::fill_n (this->alive.begin (), count, 1);
+    this->m_count = count;
+
+    return true;
+}
+
+void ParticlePool::setLimit (const uint32_t limit) {
+    this->m_limit = std::min (limit, this->m_capacity);
+}
+
+uint32_t ParticlePool::getCount () const {
+    return this->m_count;
+}
+
+uint32_t ParticlePool::getCapacity () const {
+    return this->m_capacity;
+}
+
+bool ParticlePool::isFull () const {
+    return this->m_count >= this->m_limit;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace WallpaperEngine::Render::Objects::Particles {
+/**
+ * Structure-of-arrays storage for the particles of a single system
+ *
+ * Every attribute lives in its own contiguous stream so emitters, initializers and operators
+ * only pull the fields they actually touch into cache. Live particles are always packed at the
+ * beginning of the streams ([0, count)) in spawn order, dead ones are removed in bulk by compact ()
+ */
+class ParticlePool {
+  public:
+    /**
+     * Resizes every stream to hold up to capacity particles, drops any live particle
+     *
+     * @param capacity
+     */
+    void reserve (uint32_t capacity);
+
+    /**
+     * Takes the next free slot and resets it to the default particle state
+     *
+     * @return The index of the new particle
+     */
+    uint32_t spawn ();
+
+    /**
+     * Removes every particle that is no longer alive, keeping the order of the rest
+     *
+     * Streams are compacted one after the other, so each pass walks a single array instead of touching
+     * every attribute of a particle at once
+     *
+     * @param died Receives the position of every removed particle when not nullptr
+     *
+     * @return The amount of particles removed
+     */
+    uint32_t compact (std::vector<glm::vec3>* died = nullptr);
+
+    /**
+     * Kills every particle in the pool
+     */
+    void clear ();
+
+    /**
+     * Copies the current position of every live particle into previousPosition
+     */
+    void storePreviousPositions ();
+
+    /**
+     * Writes the live particles in a binary format only read () understands
+     *
+     * @param out
+     */
+    void write (std::ostream& out) const;
+
+    /**
+     * Replaces the live particles with the ones written by write ()
+     *
+     * @param in
+     *
+     * @return false if the data is truncated or was written by a pool of a different capacity, the pool is
+     *         left empty in that case
+     */
+    bool read (std::istream& in);
+
+    /**
+     * Limits how many particles can be alive before the pool reports itself as full,
+     * the limit is clamped to the capacity and reset by reserve ()
+     *
+     * @param limit
+     */
+    void setLimit (uint32_t limit);
+
+    [[nodiscard]] uint32_t getCount () const;
+    [[nodiscard]] uint32_t getCapacity () const;
+    [[nodiscard]] bool isFull () const;
+
+    /**
+     * @param index
+     * @return Normalized lifetime position (0.0 to 1.0)
+     */
+    [[nodiscard]] float getLifetimePos (uint32_t index) const {
+        return this->lifetime [index] > 0.0f ? (this->age [index] / this->lifetime [index]) : 1.0f;
+    }
+
+    [[nodiscard]] bool isAlive (uint32_t index) const {
+        return this->alive [index] && this->age [index] < this->lifetime [index];
+    }
+
+    // position and movement
+    std::vector<glm::vec3> position = {};
+    /** position before the last simulation step, rendering interpolates between both */
+    std::vector<glm::vec3> previousPosition = {};
+    std::vector<glm::vec3> velocity = {};
+
+    // rotation
+    std::vector<glm::vec3> rotation = {};
+    std::vector<glm::vec3> angularVelocity = {};
+
+    // visual properties
+    std::vector<glm::vec3> color = {};
+    std::vector<float> alpha = {};
+    std::vector<float> size = {};
+    /** current animation frame, negative until the first animation update */
+    std::vector<float> frame = {};
+
+    // lifetime in seconds
+    std::vector<float> lifetime = {};
+    std::vector<float> age = {};
+
+    /** position in the noise field used for turbulent movement */
+    std::vector<glm::vec3> noisePos = {};
+
+    // values at spawn time, used as base for multipliers
+    std::vector<glm::vec3> initialColor = {};
+    std::vector<float> initialAlpha = {};
+    std::vector<float> initialSize = {};
+    std::vector<float> initialLifetime = {};
+
+    std::vector<uint8_t> alive = {};
+
+  private:
+    uint32_t m_count = 0;
+    uint32_t m_capacity = 0;
+    uint32_t m_limit = 0;
+    /** indices of the particles kept by compact (), kept around to avoid allocating every frame */
+    std::vector<uint32_t> m_survivors = {};
+};
+} // namespace WallpaperEngine::Render::Objects::Particles
@@ -0,0 +1,128 @@
+#include "ParticleRandom.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PARTICLE_RANDOM_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define PARTICLE_RANDOM_NEON 1
+#endif
+
+using namespace WallpaperEngine::Render::Objects::Particles;
+
+namespace {
+using LaneState = uint32_t [4][ParticleRandom::LANES];
+
+/**
+ * Advances every lane groups times, writing LANES numbers per step to out
+ */
+void generate (LaneState& s, uint32_t* out, const uint32_t groups) {
+#if PARTICLE_RANDOM_SSE2
+    __m128i s0 = _mm_load_si128 (reinterpret_cast<const __m128i*> (s [0]));
+    __m128i s1 = _mm_load_si128 (reinterpret_cast<const __m128i*> (s [1]));
+    __m128i s2 = _mm_load_si128 (reinterpret_cast<const __m128i*> (s [2]));
+    __m128i s3 = _mm_load_si128 (reinterpret_cast<const __m128i*> (s [3]));
+
+    for (uint32_t g = 0; g < groups; g++) {
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (out + g * ParticleRandom::LANES), _mm_add_epi32 (s0, s3));
+
+        const __m128i t = _mm_slli_epi32 (s1, 9);
+
+        s2 = _mm_xor_si128 (s2, s0);
+        s3 = _mm_xor_si128 (s3, s1);
+        s1 = _mm_xor_si128 (s1, s2);
+        s0 = _mm_xor_si128 (s0, s3);
+        s2 = _mm_xor_si128 (s2, t);
+        s3 = _mm_or_si128 (_mm_slli_epi32 (s3, 11), _mm_srli_epi32 (s3, 21));
+    }
+
+    _mm_store_si128 (reinterpret_cast<__m128i*> (s [0]), s0);
+    _mm_store_si128 (reinterpret_cast<__m128i*> (s [1]), s1);
+    _mm_store_si128 (reinterpret_cast<__m128i*> (s [2]), s2);
+    _mm_store_si128 (reinterpret_cast<__m128i*> (s [3]), s3);
+#elif PARTICLE_RANDOM_NEON
+    uint32x4_t s0 = vld1q_u32 (s [0]);
+    uint32x4_t s1 = vld1q_u32 (s [1]);
+    uint32x4_t s2 = vld1q_u32 (s [2]);
+    uint32x4_t s3 = vld1q_u32 (s [3]);
+
+    for (uint32_t g = 0; g < groups; g++) {
+        vst1q_u32 (out + g * ParticleRandom::LANES, vaddq_u32 (s0, s3));
+
+        const uint32x4_t t = vshlq_n_u32 (s1, 9);
+
+        s2 = veorq_u32 (s2, s0);
+        s3 = veorq_u32 (s3, s1);
+        s1 = veorq_u32 (s1, s2);
+        s0 = veorq_u32 (s0, s3);
+        s2 = veorq_u32 (s2, t);
+        s3 = vorrq_u32 (vshlq_n_u32 (s3, 11), vshrq_n_u32 (s3, 21));
+    }
+
+    vst1q_u32 (s [0], s0);
+    vst1q_u32 (s [1], s1);
+    vst1q_u32 (s [2], s2);
+    vst1q_u32 (s [3], s3);
+#else
+    for (uint32_t g = 0; g < groups; g++) {
+        for (uint32_t lane = 0; lane < ParticleRandom::LANES; lane++) {
+            out [g * ParticleRandom::LANES + lane] = s [0][lane] + s [3][lane];
+
+            const uint32_t t = s [1][lane] << 9;
+
+            s [2][lane] ^= s [0][lane];
+            s [3][lane] ^= s [1][lane];
+            s [1][lane] ^= s [2][lane];
+            s [0][lane] ^= s [3][lane];
+            s [2][lane] ^= t;
+            s [3][lane] = (s [3][lane] << 11) | (s [3][lane] >> 21);
+        }
+    }
+#endif
+}
+} // namespace
+
+ParticleRandom::ParticleRandom (const uint64_t seed) {
+    this->seed (seed);
+}
+
+void ParticleRandom::seed (uint64_t seed) {
+    for (auto& word : this->m_state) {
+        for (uint32_t lane = 0; lane < LANES; lane += 2) {
+            const uint64_t value = mix (seed++);
+
+            word [lane] = static_cast<uint32_t> (value);
+            word [lane + 1] = static_cast<uint32_t> (value >> 32);
+        }
+    }
+
+    // an all zero lane would only ever produce zeros
+    for (uint32_t lane = 0; lane < LANES; lane++)
+        if ((this->m_state [0][lane] | this->m_state [1][lane] | this->m_state [2][lane] | this->m_state [3][lane]) == 0)
+            this->m_state [0][lane] = 1;
+
+    this->m_position = BATCH_SIZE;
+}
+
+uint64_t ParticleRandom::mix (uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+
+    return value ^ (value >> 31);
+}
+
+const char* ParticleRandom::getInstructionSet () {
+#if PARTICLE_RANDOM_SSE2
+    return "SSE2";
+#elif PARTICLE_RANDOM_NEON
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+void ParticleRandom::refill () {
+    generate (this->m_state, this->m_batch, BATCH_SIZE / LANES);
+    this->m_position = 0;
+}
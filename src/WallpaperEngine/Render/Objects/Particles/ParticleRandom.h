@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <cstdint>
+#include <utility>
+
+namespace WallpaperEngine::Render::Objects::Particles {
+/**
+ * Small and fast random generator for particle systems
+ *
+ * Runs LANES independent xoshiro128+ streams side by side so a whole group of numbers is produced with a couple
+ * of vector instructions. Draws are served from a batch of BATCH_SIZE numbers that is refilled when exhausted.
+ * Every instruction set produces the exact same sequence, so a fixed seed gives the same simulation everywhere
+ */
+class ParticleRandom {
+  public:
+    /** Streams generated in parallel */
+    static constexpr uint32_t LANES = 4;
+    /** Numbers generated on every refill */
+    static constexpr uint32_t BATCH_SIZE = 64;
+
+    explicit ParticleRandom (uint64_t seed = 0);
+
+    void seed (uint64_t seed);
+
+    /**
+     * @return 32 random bits
+     */
+    uint32_t next () {
+        if (this->m_position == BATCH_SIZE)
+            this->refill ();
+
+        return this->m_batch [this->m_position++];
+    }
+
+    /**
+     * @return Random float in [0, 1)
+     */
+    float uniform () {
+        // the upper bits of xoshiro128+ are the good ones
+        return static_cast<float> (this->next () >> 8) * 0x1.0p-24f;
+    }
+
+    /**
+     * @return Random float between min and max, the bounds can come in any order
+     */
+    float range (float min, float max) {
+        if (max < min)
+            std::swap (min, max);
+
+        return min + this->uniform () * (max - min);
+    }
+
+    /**
+     * @return Random vector with every component between the ones in min and max
+     */
+    glm::vec3 range (const glm::vec3& min, const glm::vec3& max) {
+        const float x = this->range (min.x, max.x);
+        const float y = this->range (min.y, max.y);
+
+        return {x, y, this->range (min.z, max.z)};
+    }
+
+    /**
+     * @return Random integer in [0, bound)
+     */
+    uint32_t below (const uint32_t bound) {
+        return static_cast<uint32_t> ((static_cast<uint64_t> (this->next ()) * bound) >> 32);
+    }
+
+    /**
+     * splitmix64 finalizer, spreads similar seeds (like sequential ids) over the whole state space
+     */
+    static uint64_t mix (uint64_t value);
+
+    /**
+     * @return Name of the instruction set the lanes run on
+     */
+    static const char* getInstructionSet ();
+
+  private:
+    void refill ();
+
+    /** xoshiro128+ state, one row per state word, one column per lane */
+    alignas (16) uint32_t m_state [4][LANES] = {};
+    alignas (16) uint32_t m_batch [BATCH_SIZE] = {};
+    uint32_t m_position = BATCH_SIZE;
+};
+} // namespace WallpaperEngine::Render::Objects::Particles
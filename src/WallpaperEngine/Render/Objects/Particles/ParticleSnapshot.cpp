@@ -0,0 +1,102 @@
+#include "ParticleSnapshot.h"
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/Objects/CParticle.h"
+#include "WallpaperEngine/Render/Utils/CacheDirectory.h"
+
+#include <fstream>
+
+using namespace WallpaperEngine::Render;
+using namespace WallpaperEngine::Render::Objects;
+using namespace WallpaperEngine::Render::Objects::Particles;
+
+namespace {
+template <typename T> void writeValue (std::ostream& out, const T& value) {
+    out.write (reinterpret_cast<const char*> (&value), sizeof (value));
+}
+
+template <typename T> T readValue (std::istream& in) {
+    T value {};
+
+    in.read (reinterpret_cast<char*> (&value), sizeof (value));
+
+    return value;
+}
+} // namespace
+
+std::filesystem::path ParticleSnapshot::getPath (const std::string& key) {
+    const std::filesystem::path cache = Utils::getCacheDirectory ();
+
+    if (cache.empty ())
+        return {};
+
+    return cache / "particles" / (key + ".bin");
+}
+
+bool ParticleSnapshot::restore (
+    const std::filesystem::path& path, const uint32_t seconds, const std::vector<CParticle*>& systems
+) {
+    std::ifstream in (path, std::ios::binary);
+
+    if (!in)
+        return false;
+
+    bool restored = readValue<uint32_t> (in) == MAGIC && readValue<uint32_t> (in) == VERSION &&
+                    readValue<uint32_t> (in) == seconds && readValue<uint32_t> (in) == systems.size ();
+
+    for (const auto& system : systems) {
+        restored = restored && readValue<int32_t> (in) == system->getId () && system->readState (in);
+    }
+
+    // a partial restore would leave some systems pre-warmed and others not, start them all from scratch
+    if (!restored) {
+        sLog.out ("Particle snapshot ", path, " doesn't match the background, simulating again");
+
+        for (const auto& system : systems)
+            system->clearState ();
+    }
+
+    return restored;
+}
+
+void ParticleSnapshot::store (
+    const std::filesystem::path& path, const uint32_t seconds, const std::vector<CParticle*>& systems
+) {
+    std::error_code ec;
+
+    std::filesystem::create_directories (path.parent_path (), ec);
+
+    if (ec) {
+        sLog.error ("Cannot create particle snapshot directory ", path.parent_path (), ": ", ec.message ());
+        return;
+    }
+
+    // write somewhere else first so an interrupted write never leaves a truncated snapshot behind
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream out (temporary, std::ios::binary | std::ios::trunc);
+
+        writeValue<uint32_t> (out, MAGIC);
+        writeValue<uint32_t> (out, VERSION);
+        writeValue<uint32_t> (out, seconds);
+        writeValue<uint32_t> (out, static_cast<uint32_t> (systems.size ()));
+
+        for (const auto& system : systems) {
+            writeValue<int32_t> (out, system->getId ());
+            system->writeState (out);
+        }
+
+        if (!out) {
+            sLog.error ("Cannot write particle snapshot ", temporary);
+            out.close ();
+            std::filesystem::remove (temporary, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename (temporary, path, ec);
+
+    if (ec)
+        sLog.error ("Cannot store particle snapshot ", path, ": ", ec.message ());
+}
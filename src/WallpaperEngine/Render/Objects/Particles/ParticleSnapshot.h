@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace WallpaperEngine::Render::Objects {
+class CParticle;
+}
+
+namespace WallpaperEngine::Render::Objects::Particles {
+/**
+ * On-disk cache of the particle systems of a background after pre-warming them
+ *
+ * The file stores every CPU simulated system in render order, tagged with its object id, so a background whose
+ * systems changed since the snapshot was taken (or that was pre-warmed for a different length) is simulated again
+ * instead of restoring particles that don't belong to it
+ */
+class ParticleSnapshot {
+  public:
+    /**
+     * @param key Unique name of the background, usually its workshop id
+     *
+     * @return Where the snapshot for the background is stored, empty if there's no cache directory
+     */
+    static std::filesystem::path getPath (const std::string& key);
+
+    /**
+     * Restores the particles of every system from the snapshot
+     *
+     * @param path
+     * @param seconds Pre-warm length the snapshot must have been taken with
+     * @param systems
+     *
+     * @return If the snapshot matched and every system was restored, systems are left empty otherwise
+     */
+    static bool restore (const std::filesystem::path& path, uint32_t seconds, const std::vector<CParticle*>& systems);
+
+    /**
+     * Writes the particles of every system to the snapshot, replacing the previous one
+     *
+     * @param path
+     * @param seconds Pre-warm length the systems were simulated for
+     * @param systems
+     */
+    static void store (const std::filesystem::path& path, uint32_t seconds, const std::vector<CParticle*>& systems);
+
+  private:
+    static constexpr uint32_t MAGIC = 0x5350574c; // "LWPS"
+    static constexpr uint32_t VERSION = 1;
+};
+} // namespace WallpaperEngine::Render::Objects::Particles
@@ -0,0 +1,104 @@
+#include "ParticleSort.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "WallpaperEngine/Threading/JobPool.h"
+
+using namespace WallpaperEngine::Render::Objects::Particles;
+
+uint32_t ParticleSort::floatKey (const float value) {
+    uint32_t bits;
+
+    memcpy (&bits, &value, sizeof (bits));
+
+    // negative floats grow the other way as integers, flipping all their bits turns them around and below the rest
+    return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+}
+
+void ParticleSort::sort (std::vector<uint32_t>& keys, std::vector<uint32_t>& indices) {
+    const auto count = static_cast<uint32_t> (keys.size ());
+
+    if (count < 2)
+        return;
+
+    const uint32_t chunks = count < PARALLEL_THRESHOLD ? 1 : (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const uint32_t chunkSize = (count + chunks - 1) / chunks;
+    const auto forEachChunk = [chunks] (const std::function<void (uint32_t)>& job) {
+        if (chunks == 1) {
+            job (0);
+            return;
+        }
+
+        sJobPool.parallelFor (chunks, 1, [&job] (const uint32_t begin, const uint32_t end) {
+            for (uint32_t chunk = begin; chunk < end; chunk++)
+                job (chunk);
+        });
+    };
+
+    this->m_keys.resize (count);
+    this->m_indices.resize (count);
+    this->m_offsets.resize (chunks);
+
+    bool inScratch = false;
+
+    for (uint32_t shift = 0; shift < 32; shift += RADIX_BITS) {
+        const uint32_t* sourceKeys = inScratch ? this->m_keys.data () : keys.data ();
+        const uint32_t* sourceIndices = inScratch ? this->m_indices.data () : indices.data ();
+        uint32_t* targetKeys = inScratch ? keys.data () : this->m_keys.data ();
+        uint32_t* targetIndices = inScratch ? indices.data () : this->m_indices.data ();
+
+        forEachChunk ([&] (const uint32_t chunk) {
+            auto& counts = this->m_offsets [chunk];
+            const uint32_t end = std::min (count, (chunk + 1) * chunkSize);
+
+            counts.fill (0);
+
+            for (uint32_t i = chunk * chunkSize; i < end; i++)
+                counts [(sourceKeys [i] >> shift) & (BUCKETS - 1)]++;
+        });
+
+        // a digit every key shares doesn't move anything, usually the case for the top ones
+        const uint32_t first = (sourceKeys [0] >> shift) & (BUCKETS - 1);
+        uint32_t shared = 0;
+
+        for (const auto& counts : this->m_offsets)
+            shared += counts [first];
+
+        if (shared == count)
+            continue;
+
+        // buckets in order, and inside every bucket the chunks in order, which is what keeps the sort stable
+        uint32_t offset = 0;
+
+        for (uint32_t bucket = 0; bucket < BUCKETS; bucket++) {
+            for (auto& counts : this->m_offsets) {
+                const uint32_t size = counts [bucket];
+
+                counts [bucket] = offset;
+                offset += size;
+            }
+        }
+
+        forEachChunk ([&] (const uint32_t chunk) {
+            auto& offsets = this->m_offsets [chunk];
+            const uint32_t end = std::min (count, (chunk + 1) * chunkSize);
+
+            for (uint32_t i = chunk * chunkSize; i < end; i++) {
+                const uint32_t target = offsets [(sourceKeys [i] >> shift) & (BUCKETS - 1)]++;
+
+                targetKeys [target] = sourceKeys [i];
+                targetIndices [target] = sourceIndices [i];
+            }
+        });
+
+        inScratch = !inScratch;
+    }
+
+    // the vectors are the same size, handing over the buffers is cheaper than copying back
+    if (inScratch) {
+        keys.swap (this->m_keys);
+        indices.swap (this->m_indices);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace WallpaperEngine::Render::Objects::Particles {
+/**
+ * LSD radix sort of particle indices by 32 bit keys, equal keys keep their order
+ *
+ * Big arrays are split in chunks that are counted and scattered in parallel on the JobPool, every chunk writes to its
+ * own part of every bucket so they never share a counter. The scratch space is kept between calls, so sorting the
+ * same system every frame doesn't allocate
+ */
+class ParticleSort {
+  public:
+    /**
+     * @param value
+     *
+     * @return A key that sorts the same way as the float does
+     */
+    [[nodiscard]] static uint32_t floatKey (float value);
+
+    /**
+     * Sorts the keys ascending, moving the index at the same position along with every key
+     *
+     * @param keys
+     * @param indices Same size as keys
+     */
+    void sort (std::vector<uint32_t>& keys, std::vector<uint32_t>& indices);
+
+  private:
+    static constexpr uint32_t RADIX_BITS = 8;
+    static constexpr uint32_t BUCKETS = 1 << RADIX_BITS;
+    /** arrays smaller than this are sorted on the calling thread, splitting them costs more than it saves */
+    static constexpr uint32_t PARALLEL_THRESHOLD = 16384;
+    static constexpr uint32_t CHUNK_SIZE = 8192;
+
+    std::vector<uint32_t> m_keys = {};
+    std::vector<uint32_t> m_indices = {};
+    /** per chunk counts of every bucket, then where the chunk writes its first key of it */
+    std::vector<std::array<uint32_t, BUCKETS>> m_offsets = {};
+};
+} // namespace WallpaperEngine::Render::Objects::Particles
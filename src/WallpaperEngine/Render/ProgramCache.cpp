@@ -0,0 +1,590 @@
+#include "ProgramCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ranges>
+#include <stdexcept>
+#include <sstream>
+#include <tuple>
+
+#include "WallpaperEngine/Debugging/LoadReport.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/FrameUniforms.h"
+#include "WallpaperEngine/Render/GPUResources.h"
+#include "WallpaperEngine/Render/ShaderCache.h"
+#include "WallpaperEngine/Render/Shaders/GLSLContext.h"
+#include "WallpaperEngine/Threading/JobPool.h"
+
+using namespace WallpaperEngine::Render;
+
+namespace {
+/**
+ * Lists a linked program in the GPUResources, the driver's binary is the closest thing to its size there is
+ */
+void track (const ProgramCache::Program& program, const std::string& label) {
+    GLint length = 0;
+
+    if (GLEW_ARB_get_program_binary)
+        glGetProgramiv (program.id, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    sGPUResources.add (&program, GPUResources::Type_Program, static_cast<uint64_t> (length), label);
+}
+} // namespace
+
+ProgramCache::ProgramCache (const bool persistent, const bool spirv, const bool optimize) :
+    m_persistent (persistent),
+    m_spirv (spirv),
+    m_optimize (optimize) {}
+
+ProgramCache::~ProgramCache () {
+    // the jobs hold on to the records, they cannot go away while one of them is running
+    for (const auto& pending : this->m_pending)
+        sJobPool.wait (pending->translation);
+
+    for (const auto& warming : this->m_warming)
+        sJobPool.wait (warming->translation);
+
+    for (const auto& program : this->m_programs | std::views::values)
+        sGPUResources.remove (&program);
+}
+
+ProgramCache::Program& ProgramCache::get (
+    const std::string& vertex, const std::string& fragment, const std::string& label
+) {
+    auto it = this->m_programs.find ({vertex, fragment});
+
+    if (it == this->m_programs.end ()) {
+        it = this->m_programs.emplace (std::make_pair (vertex, fragment), Program {}).first;
+
+        const auto warming = std::ranges::find_if (this->m_warming, [&vertex, &fragment] (const auto& cur) {
+            return cur->vertexSource == vertex && cur->fragmentSource == fragment;
+        });
+
+        // a variant that was being warmed up is needed now, no need to translate it twice
+        if (warming != this->m_warming.end ()) {
+            this->m_pending.push_back (std::move (*warming));
+            this->m_warming.erase (warming);
+        } else {
+            this->m_pending.push_back (this->createPending (vertex, fragment, label));
+        }
+
+        auto& pending = *this->m_pending.back ();
+
+        pending.program = &it->second;
+
+        if (!pending.submitted)
+            submit (pending, false);
+    }
+
+    it->second.users++;
+
+    return it->second;
+}
+
+void ProgramCache::build () {
+    // whatever finished warming up is in the ShaderCache already
+    std::erase_if (this->m_warming, [] (const auto& cur) {
+        return cur->submitted && cur->translation.isDone ();
+    });
+
+    if (!this->m_pending.empty ()) {
+        const auto buildStart = std::chrono::steady_clock::now ();
+
+        for (const auto& pending : this->m_pending)
+            sJobPool.wait (pending->translation);
+
+        // the drivers work on them all at once, so they can only be timed together
+        const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_ShaderLink, 0, this->m_pending.size ());
+
+        if (GLEW_KHR_parallel_shader_compile)
+            glMaxShaderCompilerThreadsKHR (0xFFFFFFFF);
+
+        std::vector<Pending*> building;
+
+        for (const auto& pending : this->m_pending)
+            building.push_back (pending.get ());
+
+        while (!building.empty ()) {
+            // every compile and link is started before checking any of them so drivers with parallel compile
+            // can work on all of them at once
+            for (Pending* pending : building)
+                start (*pending);
+
+            std::vector<Pending*> refused;
+
+            for (Pending* pending : building) {
+                try {
+                    finish (*pending);
+                    track (*pending->program, pending->label);
+                } catch (std::runtime_error&) {
+                    // the error is already printed, the passes using the program find out through its id
+                    discard (*pending);
+
+                    if (pending->entry.source != ShaderCache::Source_Translated)
+                        refused.push_back (pending);
+                }
+            }
+
+            // the driver didn't like the sources, the next way of building them usually sorts that out
+            for (Pending* pending : refused) {
+                sLog.debug ("Driver refused the shaders of ", pending->label, ", building them another way");
+
+                sJobPool.submit (pending->translation, [pending] {
+                    fallBack (*pending);
+                });
+            }
+
+            for (Pending* pending : refused)
+                sJobPool.wait (pending->translation);
+
+            building = std::move (refused);
+        }
+
+        this->m_pending.clear ();
+        this->m_buildTime += std::chrono::steady_clock::now () - buildStart;
+    }
+
+    // only now that what's on screen is ready the likely variants get the job pool
+    for (const auto& warming : this->m_warming) {
+        if (!warming->submitted)
+            submit (*warming, true);
+    }
+}
+
+void ProgramCache::warm (const std::string& vertex, const std::string& fragment, const std::string& label) {
+    // the translation would be thrown away without the ShaderCache
+    if (!this->m_persistent || this->m_programs.contains ({vertex, fragment}))
+        return;
+
+    const bool queued = std::ranges::any_of (this->m_warming, [&vertex, &fragment] (const auto& cur) {
+        return cur->vertexSource == vertex && cur->fragmentSource == fragment;
+    });
+
+    if (queued)
+        return;
+
+    this->m_warming.push_back (this->createPending (vertex, fragment, label));
+}
+
+std::unique_ptr<ProgramCache::Pending> ProgramCache::createPending (
+    const std::string& vertex, const std::string& fragment, const std::string& label
+) const {
+    auto pending = std::make_unique<Pending> ();
+
+    pending->vertexSource = vertex;
+    pending->fragmentSource = fragment;
+    pending->label = label;
+    pending->path = this->m_persistent ? ShaderCache::getPath (vertex, fragment) : std::filesystem::path {};
+    pending->spirv = this->m_spirv && GLEW_ARB_gl_spirv;
+    pending->optimize = this->m_optimize;
+
+    return pending;
+}
+
+void ProgramCache::submit (Pending& pending, const bool warm) {
+    // both are created on first use, make sure that doesn't happen on the workers
+    (void) Shaders::GLSLContext::get ();
+    (void) ShaderCache::getDriver ();
+
+    pending.submitted = true;
+
+    sJobPool.submit (pending.translation, [&pending, warm] {
+        translate (pending, !warm);
+
+        // there's no binary until something links it, the translation is the part worth keeping
+        if (warm && !pending.cached && !pending.path.empty ())
+            ShaderCache::store (pending.path, pending.entry);
+    });
+}
+
+void ProgramCache::release (Program& program) {
+    // never drop a program a translation job may still be writing to
+    this->build ();
+
+    if (--program.users > 0)
+        return;
+
+    const auto it = std::ranges::find_if (this->m_programs, [&program] (const auto& cur) {
+        return &cur.second == &program;
+    });
+
+    sGPUResources.remove (&program);
+    glDeleteProgram (program.id);
+
+    if (it != this->m_programs.end ())
+        this->m_programs.erase (it);
+}
+
+std::chrono::steady_clock::duration ProgramCache::getBuildTime () const {
+    return this->m_buildTime;
+}
+
+GLint ProgramCache::Program::getUniformLocation (const std::string& name) {
+    const auto it = this->m_uniformLocations.find (name);
+
+    if (it != this->m_uniformLocations.end ())
+        return it->second;
+
+    // everything the program uses is in the table already
+    if (this->m_reflected)
+        return -1;
+
+    const GLint location = glGetUniformLocation (this->id, name.c_str ());
+
+    this->m_uniformLocations.emplace (name, location);
+
+    return location;
+}
+
+GLint ProgramCache::Program::getAttribLocation (const std::string& name) {
+    const auto it = this->m_attribLocations.find (name);
+
+    if (it != this->m_attribLocations.end ())
+        return it->second;
+
+    if (this->m_reflected)
+        return -1;
+
+    const GLint location = glGetAttribLocation (this->id, name.c_str ());
+
+    this->m_attribLocations.emplace (name, location);
+
+    return location;
+}
+
+void ProgramCache::translate (Pending& pending, const bool native) {
+    TRACE_SCOPE ("ProgramCache::translate");
+
+    ShaderCache::Entry& entry = pending.entry;
+
+    pending.cached = !pending.path.empty () && ShaderCache::load (pending.path, entry);
+
+    // SPIR-V is only any good if the driver takes it and it's enabled
+    if (pending.cached && entry.source == ShaderCache::Source_Spirv && !pending.spirv) {
+        pending.cached = false;
+        entry = {};
+    }
+
+    // the cached glsl is good no matter the driver, if it was not translated it's tried as is again
+    if (pending.cached)
+        return;
+
+    if (native) {
+        entry.vertex = pending.vertexSource;
+        entry.fragment = pending.fragmentSource;
+        entry.source = ShaderCache::Source_Preprocessed;
+        return;
+    }
+
+    const Debugging::LoadReport::Scope report (
+        Debugging::LoadReport::Stage_ShaderTranslate, pending.vertexSource.size () + pending.fragmentSource.size ());
+
+    std::tie (entry.vertex, entry.fragment) =
+        Shaders::GLSLContext::get ().toGlsl (pending.vertexSource, pending.fragmentSource, pending.optimize);
+    entry.source = ShaderCache::Source_Translated;
+}
+
+void ProgramCache::fallBack (Pending& pending) {
+    const Debugging::LoadReport::Scope report (
+        Debugging::LoadReport::Stage_ShaderTranslate, pending.vertexSource.size () + pending.fragmentSource.size ());
+    ShaderCache::Entry& entry = pending.entry;
+
+    // a binary would come from the sources that just failed
+    pending.cached = false;
+    entry.binaryFormat = GL_NONE;
+    entry.binary.clear ();
+    entry.uniforms.clear ();
+    entry.attributes.clear ();
+
+    if (entry.source == ShaderCache::Source_Preprocessed && pending.spirv) {
+        Shaders::GLSLContext::Spirv spirv;
+
+        // the block has to end up where FrameUniforms binds it, there's no moving it after linking
+        const bool usable =
+            Shaders::GLSLContext::get ().toSpirv (pending.vertexSource, pending.fragmentSource, spirv) &&
+            std::ranges::all_of (spirv.blocks, [] (const auto& block) {
+                return block.second == static_cast<int32_t> (FrameUniforms::BINDING);
+            });
+
+        if (usable) {
+            entry.vertex.assign (
+                reinterpret_cast<const char*> (spirv.vertex.data ()), spirv.vertex.size () * sizeof (uint32_t));
+            entry.fragment.assign (
+                reinterpret_cast<const char*> (spirv.fragment.data ()), spirv.fragment.size () * sizeof (uint32_t));
+            entry.uniforms = std::move (spirv.uniforms);
+            entry.attributes = std::move (spirv.attributes);
+            entry.source = ShaderCache::Source_Spirv;
+            return;
+        }
+    }
+
+    std::tie (entry.vertex, entry.fragment) =
+        Shaders::GLSLContext::get ().toGlsl (pending.vertexSource, pending.fragmentSource, pending.optimize);
+    entry.source = ShaderCache::Source_Translated;
+}
+
+void ProgramCache::start (Pending& pending) {
+    const ShaderCache::Entry& entry = pending.entry;
+
+    if (pending.cached && !entry.binary.empty ()) {
+        if (const GLuint programID = loadBinary (entry, pending.label); programID != GL_NONE) {
+            pending.program->id = programID;
+            return;
+        }
+
+        sLog.debug ("Cached program binary for ", pending.label, " was rejected by the driver, linking again");
+    }
+
+    if (entry.source == ShaderCache::Source_Spirv) {
+        pending.vertexShader = loadSpirv (entry.vertex, GL_VERTEX_SHADER);
+        pending.fragmentShader = loadSpirv (entry.fragment, GL_FRAGMENT_SHADER);
+    } else {
+        pending.vertexShader = compileShader (entry.vertex.c_str (), GL_VERTEX_SHADER);
+        pending.fragmentShader = compileShader (entry.fragment.c_str (), GL_FRAGMENT_SHADER);
+    }
+    // create the final program
+    const GLuint programID = glCreateProgram ();
+
+    if (GLEW_ARB_get_program_binary)
+        glProgramParameteri (programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    // link the shaders together
+    glAttachShader (programID, pending.vertexShader);
+    glAttachShader (programID, pending.fragmentShader);
+    glLinkProgram (programID);
+
+    pending.program->id = programID;
+}
+
+void ProgramCache::finish (Pending& pending) {
+    TRACE_SCOPE ("ProgramCache::finish");
+
+    // loaded straight from the binary, nothing else to do
+    if (pending.vertexShader == GL_NONE) {
+        reflect (pending);
+        return;
+    }
+
+    const GLuint programID = pending.program->id;
+    const bool quiet = pending.entry.source != ShaderCache::Source_Translated;
+
+    checkShader (pending.vertexShader, pending.entry.vertex, quiet);
+    checkShader (pending.fragmentShader, pending.entry.fragment, quiet);
+
+    // check that the shader was properly linked
+    GLint result = GL_FALSE;
+    int infoLogLength = 0;
+
+    glGetProgramiv (programID, GL_LINK_STATUS, &result);
+    glGetProgramiv (programID, GL_INFO_LOG_LENGTH, &infoLogLength);
+
+    if (infoLogLength > 0) {
+        const auto logBuffer = new char [infoLogLength + 1];
+        // ensure logBuffer ends with a \0
+        memset (logBuffer, 0, infoLogLength + 1);
+        // get information about the error
+        glGetProgramInfoLog (programID, infoLogLength, nullptr, logBuffer);
+        // throw an exception about the issue
+        const std::string message = logBuffer;
+        // free the buffer
+        delete [] logBuffer;
+        if (result == GL_FALSE && quiet) {
+            throw std::runtime_error (message);
+        } else if (result == GL_FALSE) {
+            // shader compilation failed completely, throw an exception
+            sLog.exception (message);
+        } else {
+            // some warning was emitted, log the error and keep chuging along
+            sLog.error (message);
+        }
+    }
+
+    reflect (pending);
+
+#if !NDEBUG
+    glObjectLabel (GL_PROGRAM, programID, -1, pending.label.c_str ());
+    glObjectLabel (GL_SHADER, pending.vertexShader, -1, (pending.label + ".vert").c_str ());
+    glObjectLabel (GL_SHADER, pending.fragmentShader, -1, (pending.label + ".frag").c_str ());
+#endif /* DEBUG */
+
+    // after being liked shaders can be dettached and deleted
+    glDetachShader (programID, pending.vertexShader);
+    glDetachShader (programID, pending.fragmentShader);
+
+    glDeleteShader (pending.vertexShader);
+    glDeleteShader (pending.fragmentShader);
+
+    if (pending.path.empty ())
+        return;
+
+    ShaderCache::Entry entry = pending.entry;
+
+    entry.binaryFormat = GL_NONE;
+    entry.binary.clear ();
+
+    if (GLEW_ARB_get_program_binary) {
+        GLint length = 0;
+
+        glGetProgramiv (programID, GL_PROGRAM_BINARY_LENGTH, &length);
+        entry.binary.resize (length);
+
+        if (length > 0)
+            glGetProgramBinary (programID, length, nullptr, &entry.binaryFormat, entry.binary.data ());
+    }
+
+    ShaderCache::store (pending.path, entry);
+}
+
+void ProgramCache::discard (Pending& pending) {
+    sGPUResources.remove (pending.program);
+    glDeleteShader (pending.vertexShader);
+    glDeleteShader (pending.fragmentShader);
+    glDeleteProgram (pending.program->id);
+
+    pending.vertexShader = GL_NONE;
+    pending.fragmentShader = GL_NONE;
+    pending.program->id = GL_NONE;
+    pending.program->m_uniformLocations.clear ();
+    pending.program->m_attribLocations.clear ();
+    pending.program->m_reflected = false;
+}
+
+void ProgramCache::reflect (Pending& pending) {
+    Program& program = *pending.program;
+
+    program.m_uniformLocations.clear ();
+    program.m_attribLocations.clear ();
+    program.m_reflected = true;
+
+    // the driver knows nothing about names in SPIR-V, only glslang does
+    if (pending.entry.source == ShaderCache::Source_Spirv) {
+        program.m_uniformLocations.insert (pending.entry.uniforms.begin (), pending.entry.uniforms.end ());
+        program.m_attribLocations.insert (pending.entry.attributes.begin (), pending.entry.attributes.end ());
+        return;
+    }
+
+    GLint count = 0;
+    GLint length = 0;
+
+    glGetProgramiv (program.id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv (program.id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &length);
+
+    std::vector<GLchar> name (std::max (length, 1));
+
+    for (GLint i = 0; i < count; i++) {
+        GLint size = 0;
+        GLenum type = GL_NONE;
+        GLsizei written = 0;
+
+        glGetActiveUniform (program.id, i, static_cast<GLsizei> (name.size ()), &written, &size, &type, name.data ());
+
+        const std::string uniform (name.data (), written);
+        const GLint location = glGetUniformLocation (program.id, uniform.c_str ());
+
+        // members of the FrameUniforms block are not set one by one
+        if (location == -1)
+            continue;
+
+        program.m_uniformLocations.emplace (uniform, location);
+
+        // arrays are looked up by their name alone too
+        if (uniform.ends_with ("[0]"))
+            program.m_uniformLocations.emplace (uniform.substr (0, uniform.size () - 3), location);
+    }
+
+    glGetProgramiv (program.id, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv (program.id, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &length);
+
+    name.resize (std::max (length, 1));
+
+    for (GLint i = 0; i < count; i++) {
+        GLint size = 0;
+        GLenum type = GL_NONE;
+        GLsizei written = 0;
+
+        glGetActiveAttrib (program.id, i, static_cast<GLsizei> (name.size ()), &written, &size, &type, name.data ());
+
+        const std::string attribute (name.data (), written);
+
+        program.m_attribLocations.emplace (attribute, glGetAttribLocation (program.id, attribute.c_str ()));
+    }
+}
+
+GLuint ProgramCache::loadSpirv (const std::string& module, GLuint type) {
+    const GLuint shaderID = glCreateShader (type);
+
+    glShaderBinary (
+        1, &shaderID, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, module.data (), static_cast<GLsizei> (module.size ()));
+    glSpecializeShaderARB (shaderID, "main", 0, nullptr, nullptr);
+
+    return shaderID;
+}
+
+GLuint ProgramCache::compileShader (const char* shader, GLuint type) {
+    // reserve shaders in OpenGL
+    const GLuint shaderID = glCreateShader (type);
+
+    glShaderSource (shaderID, 1, &shader, nullptr);
+    glCompileShader (shaderID);
+
+    return shaderID;
+}
+
+void ProgramCache::checkShader (GLuint shaderID, const std::string& shader, const bool quiet) {
+    GLint result = GL_FALSE;
+    int infoLogLength = 0;
+
+    // ensure the shader was correctly compiled
+    glGetShaderiv (shaderID, GL_COMPILE_STATUS, &result);
+    glGetShaderiv (shaderID, GL_INFO_LOG_LENGTH, &infoLogLength);
+
+    if (infoLogLength > 0) {
+        const auto logBuffer = new char [infoLogLength + 1];
+        // ensure logBuffer ends with a \0
+        memset (logBuffer, 0, infoLogLength + 1);
+        // get information about the error
+        glGetShaderInfoLog (shaderID, infoLogLength, nullptr, logBuffer);
+        // throw an exception about the issue
+        std::stringstream buffer;
+        buffer << logBuffer << std::endl << "Compiled source code:" << std::endl << shader;
+        // free the buffer
+        delete [] logBuffer;
+
+        if (result == GL_FALSE && quiet) {
+            throw std::runtime_error (buffer.str ());
+        } else if (result == GL_FALSE) {
+            // shader compilation failed completely, throw an exception
+            sLog.exception (buffer.str ());
+        } else {
+            // some warning was emitted, log the error and keep chuging along
+            sLog.error (buffer.str ());
+        }
+    }
+}
+
+GLuint ProgramCache::loadBinary (const ShaderCache::Entry& entry, const std::string& label) {
+    if (!GLEW_ARB_get_program_binary)
+        return GL_NONE;
+
+    const GLuint programID = glCreateProgram ();
+
+    glProgramBinary (
+        programID, entry.binaryFormat, entry.binary.data (), static_cast<GLsizei> (entry.binary.size ()));
+
+    GLint result = GL_FALSE;
+
+    glGetProgramiv (programID, GL_LINK_STATUS, &result);
+
+    // drivers can refuse binaries from the same version string after an update, nothing wrong with that
+    if (result == GL_FALSE) {
+        glDeleteProgram (programID);
+        return GL_NONE;
+    }
+
+#if !NDEBUG
+    glObjectLabel (GL_PROGRAM, programID, -1, label.c_str ());
+#endif /* DEBUG */
+
+    return programID;
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "ShaderCache.h"
+#include "WallpaperEngine/Threading/JobPool.h"
+
+namespace WallpaperEngine::Render {
+/**
+ * Translates, compiles and links every distinct pair of shader sources once
+ *
+ * Layers using the same material with the same combos end up with the exact same shaders, sharing a program
+ * between their passes (on any of the wallpapers being displayed) skips the translation and link of the copies,
+ * the uniform and attribute lookups, and lets consecutive draws keep the program bound. Uniform values live in the program so a pass using a shared one has to set its values
+ * again whenever another pass drew with it in between, Program::lastUser keeps track of that
+ *
+ * Most drivers take the preprocessed sources as they are, so those are compiled first and only the programs the
+ * driver refuses go through the translation to plain GLSL 330 (glslang to SPIR-V and SPIRV-Cross back). When
+ * enabled and GL_ARB_gl_spirv is there the SPIR-V is handed to the driver instead, with glslang's reflection
+ * standing in for the name lookups the driver can't do on it
+ *
+ * Programs are also kept in the ShaderCache between runs along with which of the two ways worked, so a source
+ * seen before skips the failed attempt and, when the driver supports program binaries, the compile and link too
+ *
+ * Building is split in two so loading a scene scales with the cores available: get () hands the cache lookup
+ * and any translation to the job pool (it's pure CPU work, no GL involved) and build () waits for all of them
+ * and does the GL side on the calling thread, starting every compile before checking any so GL_KHR_parallel_shader_compile can help
+ *
+ * Variants that are not shown yet but likely will be (like effects toggled through a user property) can be given
+ * to warm (), they are translated on the job pool once the programs in use are built and the result goes to the
+ * ShaderCache, so showing them later doesn't stall on the translation. Compiling the sources as they are needs
+ * the GL thread, so these always get the translation, which is known to work
+ */
+class ProgramCache {
+  public:
+    /**
+     * @param persistent If programs should be looked up in and stored to the ShaderCache
+     * @param spirv If programs the driver can't compile as they are should be given to it as SPIR-V when
+     *              GL_ARB_gl_spirv is available, instead of translating them back to GLSL
+     * @param optimize If the SPIR-V should go through SPIRV-Tools' optimizer before being translated back to GLSL,
+     *                 only does anything when built with it
+     */
+    ProgramCache (bool persistent, bool spirv, bool optimize);
+    ~ProgramCache ();
+
+    ProgramCache (const ProgramCache&) = delete;
+    ProgramCache& operator= (const ProgramCache&) = delete;
+
+    struct Program {
+        GLuint id = 0;
+        /** whatever uploaded its uniform values into the program last */
+        const void* lastUser = nullptr;
+        /** passes holding the program, it's deleted once the last one releases it */
+        uint32_t users = 0;
+
+        /**
+         * Same as glGetUniformLocation, but looked up in the table of active uniforms built once the program
+         * is linked. Names the program doesn't use are -1 without asking the driver
+         */
+        GLint getUniformLocation (const std::string& name);
+        /**
+         * Same as glGetAttribLocation, but looked up in the table of active attributes built once the program
+         * is linked
+         */
+        GLint getAttribLocation (const std::string& name);
+
+      private:
+        friend class ProgramCache;
+
+        std::map<std::string, GLint> m_uniformLocations = {};
+        std::map<std::string, GLint> m_attribLocations = {};
+        /** the tables hold every active uniform and attribute */
+        bool m_reflected = false;
+    };
+
+    /**
+     * @param vertex Vertex shader source, before translation to the GLSL version in use
+     * @param fragment Fragment shader source, before translation to the GLSL version in use
+     * @param label Name for the program in debug output
+     *
+     * @return The program for these sources, has to be given back with release (). The id is only valid after
+     *         build (), sources not seen before are translated in the background until then
+     */
+    Program& get (const std::string& vertex, const std::string& fragment, const std::string& label);
+
+    /**
+     * Waits for every translation started by get () and compiles and links the results, programs that failed
+     * to build are left with id GL_NONE. Variants given to warm () start translating after that
+     */
+    void build ();
+
+    /**
+     * Queues the translation of a program that is not used yet but might be, so it's already in the ShaderCache
+     * once get () asks for it. Does nothing if the ShaderCache is not in use
+     *
+     * @param vertex Vertex shader source, before translation to the GLSL version in use
+     * @param fragment Fragment shader source, before translation to the GLSL version in use
+     * @param label Name for the program in debug output
+     */
+    void warm (const std::string& vertex, const std::string& fragment, const std::string& label);
+
+    /**
+     * Stops using a program returned by get (), deleting it if nothing else uses it
+     *
+     * @param program
+     */
+    void release (Program& program);
+
+    /**
+     * @return Time build () spent waiting for translations and compiling, linking or loading programs
+     */
+    [[nodiscard]] std::chrono::steady_clock::duration getBuildTime () const;
+
+  private:
+    /**
+     * A program returned by get () that is not built yet, or a variant given to warm ()
+     */
+    struct Pending {
+        /** nullptr for variants given to warm () that nothing asked for yet */
+        Program* program = nullptr;
+        std::string vertexSource = {};
+        std::string fragmentSource = {};
+        std::string label = {};
+        /** where the program is stored in the ShaderCache, empty if it's not used */
+        std::filesystem::path path = {};
+        /** the sources to compile, and the binary if the entry came from the ShaderCache */
+        ShaderCache::Entry entry = {};
+        bool cached = false;
+        GLuint vertexShader = GL_NONE;
+        GLuint fragmentShader = GL_NONE;
+        /** if SPIR-V can be given to the driver */
+        bool spirv = false;
+        /** if the translation should run the SPIR-V through the optimizer */
+        bool optimize = false;
+        /** the translation job, if one was submitted */
+        Threading::JobPool::Group translation = {};
+        bool submitted = false;
+    };
+
+    /**
+     * @return The program for these sources, its translation not started yet
+     */
+    std::unique_ptr<Pending> createPending (
+        const std::string& vertex, const std::string& fragment, const std::string& label) const;
+    /**
+     * Hands the cache lookup and translation to the job pool
+     *
+     * @param pending
+     * @param warm If it's a variant given to warm (), it's translated and stored in the ShaderCache straight away
+     */
+    static void submit (Pending& pending, bool warm);
+
+    /**
+     * Runs on the job pool: looks the program up in the ShaderCache or prepares the sources to compile
+     *
+     * @param pending
+     * @param native If the sources should be tried as they are before translating them
+     */
+    static void translate (Pending& pending, bool native);
+    /** Runs on the job pool: builds the sources the driver refused again the next way, SPIR-V or translated GLSL */
+    static void fallBack (Pending& pending);
+    /** Starts compiling and linking the sources in the entry */
+    static void start (Pending& pending);
+    /**
+     * Checks the result of start (), throws if the program couldn't be built. Failures of sources that were
+     * not translated are not logged, these are tried again with the translation
+     */
+    static void finish (Pending& pending);
+    /** Deletes whatever start () created for a program that couldn't be built */
+    static void discard (Pending& pending);
+    /**
+     * Fills the program's location tables with its active uniforms and attributes, asking the driver or,
+     * for SPIR-V, taking what glslang assigned
+     */
+    static void reflect (Pending& pending);
+    /** @return The shader for the SPIR-V module, specialized and ready to link */
+    static GLuint loadSpirv (const std::string& module, GLuint type);
+    static GLuint compileShader (const char* shader, GLuint type);
+    /**
+     * @param shaderID
+     * @param shader Source code for the error message
+     * @param quiet If a failed compile should throw without logging it
+     */
+    static void checkShader (GLuint shaderID, const std::string& shader, bool quiet);
+    /** @return The program built from the cached binary, GL_NONE if the driver didn't take it */
+    static GLuint loadBinary (const ShaderCache::Entry& entry, const std::string& label);
+
+    std::map<std::pair<std::string, std::string>, Program> m_programs = {};
+    std::vector<std::unique_ptr<Pending>> m_pending = {};
+    /** variants given to warm (), the ones with a finished translation are dropped on the next build () */
+    std::vector<std::unique_ptr<Pending>> m_warming = {};
+    bool m_persistent;
+    bool m_spirv;
+    bool m_optimize;
+    std::chrono::steady_clock::duration m_buildTime = {};
+};
+} // namespace WallpaperEngine::Render
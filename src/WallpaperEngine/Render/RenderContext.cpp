@@ -1,20 +1,35 @@
+#include <algorithm>
 #include <iostream>
+#include <ranges>
+#include <set>
 
 #include <GL/glew.h>
 
 #include "CWallpaper.h"
 #include "RenderContext.h"
+#include "VideoSource.h"
 
 #include "WallpaperEngine/Data/Model/Project.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
 
 namespace WallpaperEngine::Render {
 RenderContext::RenderContext (Drivers::VideoDriver& driver, WallpaperApplication& app) :
     m_driver (driver),
     m_app (app),
-    m_textureCache (new TextureCache (*this)) {}
-
-void RenderContext::render (Drivers::Output::OutputViewport* viewport) {
+    m_textureCache (new TextureCache (*this)),
+    m_programCache (
+        app.getContext ().settings.general.shaderCache, app.getContext ().settings.general.spirv,
+        app.getContext ().settings.general.optimizeShaders),
+    m_profiler (app.getContext ().settings.general.profile),
+    m_stats (
+        !app.getContext ().settings.general.statsSocket.empty () ||
+        !app.getContext ().settings.general.metrics.empty ()) {}
+
+bool RenderContext::render (Drivers::Output::OutputViewport* viewport) {
     viewport->makeCurrent ();
+    this->m_textureCache->update ();
+    // anything outside the render (texture loads, browser paints...) may have touched the GL state since the last frame
+    this->m_renderState.invalidate ();
 
 #if !NDEBUG
     const std::string str = "Rendering to output " + viewport->name;
@@ -25,18 +40,71 @@ void RenderContext::render (Drivers::Output::OutputViewport* viewport) {
     // search the background in the viewport selection
 
     // render the background
-    if (const auto ref = this->m_wallpapers.find (viewport->name); ref != this->m_wallpapers.end ())
-        ref->second->render (viewport->viewport, this->getOutput ().renderVFlip ());
+    bool changed = true;
+
+    if (const auto ref = this->m_wallpapers.find (viewport->name); ref != this->m_wallpapers.end ()) {
+        FrameStats::Scope stats (this->m_stats, FrameStats::Phase_Render);
+
+        changed = ref->second->render (viewport->viewport, this->getOutput ().renderVFlip ());
+
+        // a wallpaper shared with other screens might have rendered new frames while this one was not drawn
+        auto& presented = this->m_presentedVersions [viewport->name];
+
+        changed = changed || presented != ref->second->getFrameVersion ();
+        presented = ref->second->getFrameVersion ();
+    }
 
 #if !NDEBUG
     glPopDebugGroup ();
 #endif /* DEBUG */
 
-    viewport->swapOutput ();
+    // the output still shows this exact frame, no need to present it again
+    if (changed) {
+        TRACE_SCOPE ("OutputViewport::swapOutput");
+        FrameStats::Scope stats (this->m_stats, FrameStats::Phase_Present);
+
+        viewport->swapOutput ();
+    }
+
+    return changed;
+}
+
+void RenderContext::beginFrame () {
+    this->m_frame++;
+    this->m_profiler.beginFrame ();
+
+    if (this->m_stats.beginFrame ()) {
+        uint64_t framebufferBytes = 0;
+        // screens mirroring each other share the wallpaper
+        std::set<const CWallpaper*> counted = {};
+
+        for (const auto& wallpaper : this->m_wallpapers | std::views::values)
+            if (counted.insert (wallpaper.get ()).second)
+                framebufferBytes += wallpaper->getFramebufferBytes ();
+
+        std::vector<FrameStats::Output> outputs;
+
+        for (const auto& [screen, project] : this->m_app.getBackgrounds ())
+            outputs.push_back ({
+                .screen = screen,
+                .workshopId = project->workshopId,
+                .visible = this->m_app.isVisible (screen),
+            });
+
+        this->m_stats.publish (
+            this->m_textureCache->getResidentBytes (), framebufferBytes, this->m_profiler.getFrameTime (),
+            std::move (outputs));
+    }
+}
+
+uint64_t RenderContext::getFrame () const {
+    return this->m_frame;
 }
 
 void RenderContext::setWallpaper (const std::string& display, std::shared_ptr <CWallpaper> wallpaper) {
     this->m_wallpapers.insert_or_assign (display, wallpaper);
+    // the new wallpaper's versions have nothing to do with the old one's
+    this->m_presentedVersions.erase (display);
 }
 
 void RenderContext::setPause (const bool newState) const {
@@ -44,6 +112,12 @@ void RenderContext::setPause (const bool newState) const {
         wallpaper->setPause (newState);
 }
 
+void RenderContext::updatePaused () const {
+    for (const auto& video : this->m_videos | std::views::values)
+        if (const auto source = video.lock ())
+            source->releaseIfIdle ();
+}
+
 Input::InputContext& RenderContext::getInputContext () const {
     return this->m_driver.getInputContext ();
 }
@@ -60,11 +134,69 @@ const Drivers::Output::Output& RenderContext::getOutput () const {
     return this->m_driver.getOutput ();
 }
 
-std::shared_ptr<const TextureProvider> RenderContext::resolveTexture (const std::string& name) const {
-    return this->m_textureCache->resolve (name);
+std::shared_ptr<const TextureProvider> RenderContext::resolveTexture (
+    const std::string& name, const Data::Model::Project& project
+) const {
+    return this->m_textureCache->resolve (name, project);
+}
+
+std::shared_ptr<VideoSource> RenderContext::acquireVideo (const std::filesystem::path& path) {
+    if (const auto it = this->m_videos.find (path); it != this->m_videos.end ())
+        if (auto source = it->second.lock ())
+            return source;
+
+    // the same file on several screens is decoded once
+    auto source = std::make_shared<VideoSource> (*this, path);
+
+    this->m_videos.insert_or_assign (path, source);
+
+    return source;
+}
+
+float RenderContext::getMotionFPS (const std::string& screen, const float limit) const {
+    const auto it = this->m_wallpapers.find (screen);
+
+    return it == this->m_wallpapers.end () ? limit : it->second->getMotionFPS (limit);
+}
+
+float RenderContext::getMotionFPS (const float limit) const {
+    float result = 0.0f;
+
+    for (const auto& wallpaper : this->m_wallpapers | std::views::values)
+        result = std::max (result, wallpaper->getMotionFPS (limit));
+
+    return this->m_wallpapers.empty () ? limit : result;
+}
+
+bool RenderContext::isStreaming () const {
+    return this->m_textureCache->isStreaming ();
 }
 
 const std::map<std::string, std::shared_ptr <CWallpaper>>& RenderContext::getWallpapers () const {
     return this->m_wallpapers;
 }
+
+RenderState& RenderContext::getRenderState () {
+    return this->m_renderState;
+}
+
+ProgramCache& RenderContext::getProgramCache () {
+    return this->m_programCache;
+}
+
+TextureCache& RenderContext::getTextureCache () {
+    return *this->m_textureCache;
+}
+
+const TextureCache& RenderContext::getTextureCache () const {
+    return *this->m_textureCache;
+}
+
+GPUProfiler& RenderContext::getProfiler () {
+    return this->m_profiler;
+}
+
+FrameStats& RenderContext::getStats () {
+    return this->m_stats;
+}
 } // namespace WallpaperEngine::Render
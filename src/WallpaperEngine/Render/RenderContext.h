@@ -1,9 +1,14 @@
 #pragma once
 
+#include <filesystem>
 #include <glm/vec4.hpp>
 #include <vector>
 #include <memory>
 
+#include "FrameStats.h"
+#include "GPUProfiler.h"
+#include "ProgramCache.h"
+#include "RenderState.h"
 #include "TextureCache.h"
 #include "WallpaperEngine/Application/WallpaperApplication.h"
 #include "WallpaperEngine/Input/InputContext.h"
@@ -29,30 +34,96 @@ class OutputViewport;
 
 class CWallpaper;
 class TextureCache;
+class VideoSource;
 
 class RenderContext {
   public:
     RenderContext (Drivers::VideoDriver& driver, WallpaperApplication& app);
 
-    void render (Drivers::Output::OutputViewport* viewport);
+    /**
+     * Renders the wallpaper assigned to the viewport, only presenting it if the frame changed
+     *
+     * @param viewport
+     *
+     * @return If a new frame was presented
+     */
+    bool render (Drivers::Output::OutputViewport* viewport);
+    /**
+     * Starts a new frame, wallpapers shown on several viewports only render their scene on the first one of a frame
+     */
+    void beginFrame ();
+    /** @return The number of the current frame, see beginFrame () */
+    [[nodiscard]] uint64_t getFrame () const;
     void setWallpaper (const std::string& display, std::shared_ptr <CWallpaper> wallpaper);
     void setPause (bool newState) const;
+    /**
+     * Called every now and then while paused, lets paused videos release their decoders
+     */
+    void updatePaused () const;
     [[nodiscard]] Input::InputContext& getInputContext () const;
     [[nodiscard]] const WallpaperApplication& getApp () const;
     [[nodiscard]] const Drivers::VideoDriver& getDriver () const;
     [[nodiscard]] const Drivers::Output::Output& getOutput () const;
-    [[nodiscard]] std::shared_ptr<const TextureProvider> resolveTexture (const std::string& name) const;
+    /**
+     * @param name
+     * @param project The project of the wallpaper the texture is for, its container is searched first
+     *
+     * @return The texture from the TextureCache
+     */
+    [[nodiscard]] std::shared_ptr<const TextureProvider> resolveTexture (
+        const std::string& name, const Data::Model::Project& project) const;
+    /**
+     * @param path Physical path of the video
+     *
+     * @return The decoder every wallpaper showing this file shares, created if nothing uses it yet
+     */
+    [[nodiscard]] std::shared_ptr<VideoSource> acquireVideo (const std::filesystem::path& path);
+    /**
+     * @param screen
+     * @param limit The highest frame rate allowed
+     *
+     * @return Frames a second the wallpaper on the screen needs, see CWallpaper::getMotionFPS ()
+     */
+    [[nodiscard]] float getMotionFPS (const std::string& screen, float limit) const;
+    /**
+     * @param limit The highest frame rate allowed
+     *
+     * @return Frames a second the fastest moving wallpaper needs, for drivers that draw every screen at once
+     */
+    [[nodiscard]] float getMotionFPS (float limit) const;
+    /** @return If textures are still being streamed in, see TextureCache::update () */
+    [[nodiscard]] bool isStreaming () const;
     [[nodiscard]] const std::map<std::string, std::shared_ptr <CWallpaper>>& getWallpapers () const;
+    [[nodiscard]] RenderState& getRenderState ();
+    [[nodiscard]] ProgramCache& getProgramCache ();
+    [[nodiscard]] TextureCache& getTextureCache ();
+    [[nodiscard]] const TextureCache& getTextureCache () const;
+    [[nodiscard]] GPUProfiler& getProfiler ();
+    [[nodiscard]] FrameStats& getStats ();
 
   private:
     /** Video driver in use */
     Drivers::VideoDriver& m_driver;
     /** Maps screen -> wallpaper list */
     std::map<std::string, std::shared_ptr <CWallpaper>> m_wallpapers = {};
+    /** Maps screen -> frame version of its wallpaper last presented there */
+    std::map<std::string, uint64_t> m_presentedVersions = {};
+    /** Current frame, starts at 1 so new wallpapers (frame 0) always render their first one */
+    uint64_t m_frame = 1;
     /** App that holds the render context */
     WallpaperApplication& m_app;
     /** Texture cache for the render */
     TextureCache* m_textureCache = nullptr;
+    /** GL state shadowed for the draws of every wallpaper */
+    RenderState m_renderState = {};
+    /** Shader programs shared by every wallpaper */
+    ProgramCache m_programCache;
+    /** Video decoders in use, they go away with the last wallpaper showing them */
+    std::map<std::filesystem::path, std::weak_ptr<VideoSource>> m_videos = {};
+    /** GPU time of every object, only measured with --profile */
+    GPUProfiler m_profiler;
+    /** Frame times, draws and memory use, only counted with --stats-socket */
+    FrameStats m_stats;
 };
 } // namespace Render
 } // namespace WallpaperEngine
@@ -0,0 +1,276 @@
+#include "RenderGraph.h"
+#include "TransientFBOPool.h"
+
+#include "WallpaperEngine/Render/Objects/CImage.h"
+#include "WallpaperEngine/Render/Objects/CParticle.h"
+#include "WallpaperEngine/Render/Objects/Effects/CPass.h"
+#include "WallpaperEngine/Render/Wallpapers/CScene.h"
+
+using namespace WallpaperEngine::Render;
+
+RenderGraph::RenderGraph (Wallpapers::CScene& scene) :
+    m_scene (scene) {}
+
+RenderGraph::Stats RenderGraph::compile () {
+    Stats stats = {};
+
+    this->build ();
+
+    stats.removedPasses = this->removeDeadPasses ();
+    stats.cachedImages = this->planCaching ();
+    stats.cullableImages = this->planCulling ();
+    this->shareStorage (stats);
+
+    return stats;
+}
+
+void RenderGraph::build () {
+    this->m_nodes.clear ();
+    this->m_external.clear ();
+    this->m_fbos.clear ();
+    this->m_cached.clear ();
+
+    // the scene's framebuffer ends up on screen
+    this->track (this->m_scene.getFBO ());
+    this->m_external.insert (this->m_scene.getFBO ().get ());
+
+    for (const auto& object : this->m_scene.getObjectsByRenderOrder ()) {
+        if (object->is<Objects::CParticle> ()) {
+            std::vector<std::shared_ptr<const TextureProvider>> textures = {};
+
+            object->as<Objects::CParticle> ()->getTextures (textures);
+
+            for (const auto& texture : textures) {
+                if (const auto fbo = std::dynamic_pointer_cast<const CFBO> (texture)) {
+                    this->track (fbo);
+                    this->m_external.insert (fbo.get ());
+                }
+            }
+
+            continue;
+        }
+
+        if (!object->is<Objects::CImage> ())
+            continue;
+
+        auto* image = object->as<Objects::CImage> ();
+
+        for (const auto& pass : image->getPasses ()) {
+            const auto destination = pass->getDestination ();
+
+            if (destination == nullptr)
+                continue;
+
+            Node node = {
+                .image = image,
+                .pass = pass,
+                .destination = destination.get (),
+                .sampled = {},
+                .overwrites = pass->overwritesDestination (),
+            };
+
+            this->track (destination);
+
+            for (const auto& fbo : pass->getSampledFBOs ()) {
+                this->track (fbo);
+                node.sampled.push_back (fbo.get ());
+            }
+
+            this->m_nodes.push_back (std::move (node));
+        }
+    }
+}
+
+uint32_t RenderGraph::removeDeadPasses () {
+    uint32_t removed = 0;
+    bool changed = true;
+
+    // removing a pass can leave the ones feeding it without readers, so keep going until nothing changes
+    while (changed) {
+        changed = false;
+
+        std::map<const CFBO*, uint32_t> readers = {};
+
+        for (const auto& node : this->m_nodes) {
+            if (!node.alive)
+                continue;
+
+            // a pass reading its own output doesn't make anyone else need it
+            for (const auto& fbo : node.sampled)
+                if (fbo != node.destination)
+                    readers [fbo]++;
+        }
+
+        for (auto& node : this->m_nodes) {
+            if (!node.alive || this->m_external.contains (node.destination) || readers [node.destination] > 0)
+                continue;
+
+            node.alive = false;
+            changed = true;
+            removed++;
+        }
+    }
+
+    for (const auto& node : this->m_nodes)
+        if (!node.alive)
+            node.image->removePass (node.pass);
+
+    std::erase_if (this->m_nodes, [] (const Node& node) { return !node.alive; });
+
+    return removed;
+}
+
+uint32_t RenderGraph::planCaching () {
+    std::map<const CFBO*, std::set<const Objects::CImage*>> writers = {};
+    std::map<Objects::CImage*, bool> cacheable = {};
+
+    for (const auto& node : this->m_nodes)
+        writers [node.destination].insert (node.image);
+
+    for (const auto& node : this->m_nodes) {
+        // passes drawing on the scene run every frame anyway, it's cleared before rendering
+        if (this->m_external.contains (node.destination))
+            continue;
+
+        bool& enabled = cacheable.try_emplace (node.image, true).first->second;
+
+        // these would render again every frame, keeping their framebuffers out of the pool for nothing
+        if (node.pass->getDependencies () &
+            (Objects::Effects::CPass::Dependency_Time | Objects::Effects::CPass::Dependency_AnimatedTexture))
+            enabled = false;
+
+        // anything written by other images (or the scene itself) can change without this image knowing
+        for (const auto& fbo : node.sampled) {
+            const auto written = writers.find (fbo);
+
+            if (this->m_external.contains (fbo) ||
+                (written != writers.end () && (written->second.size () > 1 || !written->second.contains (node.image))))
+                enabled = false;
+        }
+    }
+
+    uint32_t cached = 0;
+
+    for (const auto& [image, enabled] : cacheable) {
+        image->setCacheable (enabled);
+
+        if (!enabled)
+            continue;
+
+        cached++;
+
+        for (const auto& node : this->m_nodes)
+            if (node.image == image && !this->m_external.contains (node.destination))
+                this->m_cached.insert (node.destination);
+    }
+
+    return cached;
+}
+
+uint32_t RenderGraph::planCulling () {
+    std::map<const CFBO*, std::set<const Objects::CImage*>> readers = {};
+    std::map<Objects::CImage*, bool> cullable = {};
+
+    for (const auto& node : this->m_nodes)
+        for (const auto& fbo : node.sampled)
+            readers [fbo].insert (node.image);
+
+    for (const auto& node : this->m_nodes) {
+        bool& enabled = cullable.try_emplace (node.image, true).first->second;
+
+        // the scene's framebuffer is where the image shows up, the pass drawing there is clipped anyway
+        if (node.destination == this->m_scene.getFBO ().get ())
+            continue;
+
+        // anything else it writes can't be missed by other images when it skips a frame
+        const auto read = readers.find (node.destination);
+
+        if (this->m_external.contains (node.destination) ||
+            (read != readers.end () && (read->second.size () > 1 || !read->second.contains (node.image))))
+            enabled = false;
+    }
+
+    uint32_t result = 0;
+
+    for (const auto& [image, enabled] : cullable) {
+        image->setCullable (enabled);
+        result += enabled;
+    }
+
+    return result;
+}
+
+void RenderGraph::shareStorage (Stats& stats) {
+    std::map<const CFBO*, Lifetime> lifetimes = {};
+
+    for (const auto& [fbo, shared] : this->m_fbos)
+        lifetimes [fbo].fbo = shared;
+
+    for (int index = 0; index < static_cast<int> (this->m_nodes.size ()); index++) {
+        const auto& node = this->m_nodes [index];
+
+        for (const auto& fbo : node.sampled) {
+            auto& lifetime = lifetimes [fbo];
+
+            lifetime.persistent |= lifetime.firstWrite == -1;
+            lifetime.lastUse = index;
+        }
+
+        auto& lifetime = lifetimes [node.destination];
+
+        // blending over the destination reads it too
+        lifetime.persistent |= !node.overwrites && lifetime.firstWrite == -1;
+
+        if (lifetime.firstWrite == -1)
+            lifetime.firstWrite = index;
+
+        lifetime.lastUse = index;
+    }
+
+    // replay the frame, transient framebuffers borrow storage when first written and give it back after their last use
+    std::vector<std::vector<const Lifetime*>> starting (this->m_nodes.size ());
+    std::vector<std::vector<const Lifetime*>> ending (this->m_nodes.size ());
+    uint64_t residentBytes = 0;
+
+    for (const auto& [fbo, lifetime] : lifetimes) {
+        if (lifetime.persistent && lifetime.firstWrite != -1 && !this->m_external.contains (fbo))
+            stats.feedbackFBOs++;
+
+        if (lifetime.persistent || lifetime.firstWrite == -1 || this->m_external.contains (fbo) ||
+            this->m_cached.contains (fbo)) {
+            residentBytes += TransientFBOPool::getSize (*fbo);
+            continue;
+        }
+
+        starting [lifetime.firstWrite].push_back (&lifetime);
+        ending [lifetime.lastUse].push_back (&lifetime);
+    }
+
+    TransientFBOPool pool;
+    std::map<const Lifetime*, std::shared_ptr<const CFBO>> storage = {};
+
+    for (size_t index = 0; index < this->m_nodes.size (); index++) {
+        for (const auto& lifetime : starting [index])
+            storage [lifetime] = pool.borrow (lifetime->fbo);
+
+        std::vector<std::shared_ptr<const CFBO>> discarded = {};
+
+        for (const auto& lifetime : ending [index]) {
+            pool.giveBack (storage [lifetime]);
+            discarded.push_back (lifetime->fbo);
+        }
+
+        this->m_nodes [index].pass->setDiscarded (std::move (discarded));
+    }
+
+    stats.sharedFBOs = pool.getReusedCount ();
+    stats.savedBytes = pool.getReusedBytes ();
+    stats.transientBytes = pool.getAllocatedBytes ();
+    stats.peakTransientBytes = pool.getPeakBytes ();
+    stats.residentBytes = residentBytes + pool.getAllocatedBytes ();
+}
+
+void RenderGraph::track (const std::shared_ptr<const CFBO>& fbo) {
+    if (fbo != nullptr)
+        this->m_fbos.emplace (fbo.get (), fbo);
+}
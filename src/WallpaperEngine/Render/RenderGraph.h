@@ -0,0 +1,100 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "CFBO.h"
+
+namespace WallpaperEngine::Render::Objects {
+class CImage;
+}
+
+namespace WallpaperEngine::Render::Objects::Effects {
+class CPass;
+}
+
+namespace WallpaperEngine::Render::Wallpapers {
+class CScene;
+}
+
+namespace WallpaperEngine::Render {
+/**
+ * Compiles the effect passes of every image in a scene into a single graph and optimizes it
+ *
+ * Images build their pass lists on their own, each effect getting full-sized framebuffers whether anything
+ * ends up reading them or not. Looking at the whole scene in render order allows to:
+ *  - drop passes that write into framebuffers nothing samples (like the chain of a hidden layer nothing references)
+ *  - find images that only sample their own framebuffers and static textures, these keep the result of their
+ *    off-screen passes between frames and only render them again when a uniform they use changes
+ *  - let framebuffers whose contents are never needed at the same time share a single texture, borrowing
+ *    it from a TransientFBOPool while they're in use
+ *  - find images nothing else reads the framebuffers of, these skip all their passes while they're out of view
+ *  - tell the pass that last reads one of those framebuffers in a frame that its contents can be dropped
+ *
+ * Framebuffers read before being written in a frame keep state between frames, those and the ones
+ * used outside of images (the scene's, particle textures...) are never shared
+ */
+class RenderGraph {
+  public:
+    struct Stats {
+        uint32_t removedPasses = 0;
+        uint32_t cachedImages = 0;
+        /** images that can skip rendering while out of view */
+        uint32_t cullableImages = 0;
+        uint32_t sharedFBOs = 0;
+        uint64_t savedBytes = 0;
+        /** storage handed out to framebuffers that only live during part of the frame */
+        uint64_t transientBytes = 0;
+        /** most transient storage in use at the same time within a frame */
+        uint64_t peakTransientBytes = 0;
+        /** storage of every framebuffer the scene's passes use */
+        uint64_t residentBytes = 0;
+        /** framebuffers that keep state between frames and are written again every frame, like trails */
+        uint32_t feedbackFBOs = 0;
+    };
+
+    explicit RenderGraph (Wallpapers::CScene& scene);
+
+    /**
+     * Builds the graph off the current passes of the scene's images and applies the optimizations
+     *
+     * @return What was optimized
+     */
+    Stats compile ();
+
+  private:
+    struct Node {
+        Objects::CImage* image;
+        Objects::Effects::CPass* pass;
+        const CFBO* destination;
+        std::vector<const CFBO*> sampled;
+        bool overwrites;
+        bool alive = true;
+    };
+
+    struct Lifetime {
+        std::shared_ptr<const CFBO> fbo = nullptr;
+        int firstWrite = -1;
+        int lastUse = -1;
+        /** read before written in the frame, so its contents have to survive until the next one */
+        bool persistent = false;
+    };
+
+    void build ();
+    uint32_t removeDeadPasses ();
+    uint32_t planCaching ();
+    uint32_t planCulling ();
+    void shareStorage (Stats& stats);
+    void track (const std::shared_ptr<const CFBO>& fbo);
+
+    Wallpapers::CScene& m_scene;
+    std::vector<Node> m_nodes = {};
+    /** framebuffers used outside of the graph, never removed nor shared */
+    std::set<const CFBO*> m_external = {};
+    std::map<const CFBO*, std::shared_ptr<const CFBO>> m_fbos = {};
+    /** framebuffers written by the off-screen passes of cached images, their contents have to survive frames */
+    std::set<const CFBO*> m_cached = {};
+};
+} // namespace WallpaperEngine::Render
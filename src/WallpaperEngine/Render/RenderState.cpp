@@ -0,0 +1,111 @@
+#include "RenderState.h"
+
+using namespace WallpaperEngine::Render;
+
+RenderState::RenderState () {
+    this->invalidate ();
+}
+
+void RenderState::useProgram (const GLuint program) {
+    if (this->m_program == program)
+        return;
+
+    glUseProgram (program);
+    this->m_program = program;
+}
+
+void RenderState::bindVertexArray (const GLuint vao) {
+    if (this->m_vao == vao)
+        return;
+
+    glBindVertexArray (vao);
+    this->m_vao = vao;
+}
+
+void RenderState::bindTexture (const uint32_t unit, const GLuint texture, const GLuint sampler, const GLenum target) {
+    // samplers are bound straight to the unit, no need to switch to it
+    if (unit >= TEXTURE_UNITS) {
+        glBindSampler (unit, sampler);
+    } else if (this->m_samplers [unit] != sampler) {
+        glBindSampler (unit, sampler);
+        this->m_samplers [unit] = sampler;
+    }
+
+    const bool shadowed = target == GL_TEXTURE_2D && unit < TEXTURE_UNITS;
+
+    if (shadowed && this->m_textures [unit] == texture)
+        return;
+
+    this->activeTexture (unit);
+    glBindTexture (target, texture);
+
+    if (shadowed)
+        this->m_textures [unit] = texture;
+}
+
+void RenderState::setBlending (const bool enabled) {
+    setCapability (GL_BLEND, enabled, this->m_blending);
+}
+
+void RenderState::setBlendFunc (const GLenum srcRGB, const GLenum dstRGB, const GLenum srcAlpha, const GLenum dstAlpha) {
+    const std::array<GLenum, 4> func = {srcRGB, dstRGB, srcAlpha, dstAlpha};
+
+    if (this->m_blendFunc == func)
+        return;
+
+    glBlendFuncSeparate (srcRGB, dstRGB, srcAlpha, dstAlpha);
+    this->m_blendFunc = func;
+}
+
+void RenderState::setDepthTest (const bool enabled) {
+    setCapability (GL_DEPTH_TEST, enabled, this->m_depthTest);
+}
+
+void RenderState::setDepthMask (const bool enabled) {
+    const Toggle value = enabled ? Toggle::Enabled : Toggle::Disabled;
+
+    if (this->m_depthMask == value)
+        return;
+
+    glDepthMask (enabled ? GL_TRUE : GL_FALSE);
+    this->m_depthMask = value;
+}
+
+void RenderState::setCullFace (const bool enabled) {
+    setCapability (GL_CULL_FACE, enabled, this->m_cullFace);
+}
+
+void RenderState::invalidate () {
+    this->m_program = UNKNOWN;
+    this->m_vao = UNKNOWN;
+    this->m_activeTexture = UNKNOWN;
+    this->m_textures.fill (UNKNOWN);
+    this->m_samplers.fill (UNKNOWN);
+    this->m_blendFunc.fill (UNKNOWN);
+    this->m_blending = Toggle::Unknown;
+    this->m_depthTest = Toggle::Unknown;
+    this->m_depthMask = Toggle::Unknown;
+    this->m_cullFace = Toggle::Unknown;
+}
+
+void RenderState::setCapability (const GLenum capability, const bool enabled, Toggle& current) {
+    const Toggle value = enabled ? Toggle::Enabled : Toggle::Disabled;
+
+    if (current == value)
+        return;
+
+    if (enabled)
+        glEnable (capability);
+    else
+        glDisable (capability);
+
+    current = value;
+}
+
+void RenderState::activeTexture (const uint32_t unit) {
+    if (this->m_activeTexture == unit)
+        return;
+
+    glActiveTexture (GL_TEXTURE0 + unit);
+    this->m_activeTexture = unit;
+}
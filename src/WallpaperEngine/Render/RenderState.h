@@ -0,0 +1,71 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstdint>
+
+namespace WallpaperEngine::Render {
+/**
+ * Shadow copy of the GL state touched by the draw calls
+ *
+ * Every setter compares against the last value it issued and only reaches the driver when something changes,
+ * so consecutive draws sharing program, blending or textures don't repeat the calls, and nothing has to query
+ * the driver to save and restore state around a draw. Anything that changes GL state behind its back
+ * (mpv, texture uploads, etc.) must call invalidate () so the next setter re-issues its value
+ */
+class RenderState {
+  public:
+    /** Texture units shadowed, binds to units above this go straight to the driver */
+    static constexpr uint32_t TEXTURE_UNITS = 16;
+
+    RenderState ();
+
+    void useProgram (GLuint program);
+    void bindVertexArray (GLuint vao);
+    /**
+     * Binds a texture and sampler to the given unit, switching the active texture unit only if needed
+     *
+     * @param unit Texture unit index (not the GL_TEXTUREn enum)
+     * @param texture
+     * @param sampler GL_NONE to sample with the texture's own parameters
+     * @param target
+     */
+    void bindTexture (uint32_t unit, GLuint texture, GLuint sampler = GL_NONE, GLenum target = GL_TEXTURE_2D);
+    void setBlending (bool enabled);
+    void setBlendFunc (GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+    void setDepthTest (bool enabled);
+    void setDepthMask (bool enabled);
+    void setCullFace (bool enabled);
+
+    /**
+     * Forgets everything known about the GL state, the next call to every setter reaches the driver
+     */
+    void invalidate ();
+
+  private:
+    /** Value no GL object or enum takes, marks state that has to be re-issued */
+    static constexpr GLuint UNKNOWN = ~0u;
+
+    enum class Toggle : uint8_t {
+        Unknown,
+        Disabled,
+        Enabled
+    };
+
+    static void setCapability (GLenum capability, bool enabled, Toggle& current);
+    void activeTexture (uint32_t unit);
+
+    GLuint m_program = UNKNOWN;
+    GLuint m_vao = UNKNOWN;
+    GLuint m_activeTexture = UNKNOWN;
+    /** 2D texture bound on every unit, other targets are not shadowed */
+    std::array<GLuint, TEXTURE_UNITS> m_textures {};
+    /** sampler bound on every unit, whatever the target of the texture */
+    std::array<GLuint, TEXTURE_UNITS> m_samplers {};
+    std::array<GLenum, 4> m_blendFunc {};
+    Toggle m_blending = Toggle::Unknown;
+    Toggle m_depthTest = Toggle::Unknown;
+    Toggle m_depthMask = Toggle::Unknown;
+    Toggle m_cullFace = Toggle::Unknown;
+};
+} // namespace WallpaperEngine::Render
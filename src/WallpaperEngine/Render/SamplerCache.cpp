@@ -0,0 +1,44 @@
+#include "SamplerCache.h"
+
+#include <array>
+#include <string>
+
+using namespace WallpaperEngine::Render;
+
+GLuint SamplerCache::get (const uint32_t flags) {
+    static std::array<GLuint, Flags_All + 1> samplers {};
+
+    GLuint& sampler = samplers [flags & Flags_All];
+
+    if (sampler == GL_NONE) {
+        glGenSamplers (1, &sampler);
+        setup (sampler, flags & Flags_All);
+    }
+
+    return sampler;
+}
+
+void SamplerCache::setup (const GLuint sampler, const uint32_t flags) {
+    const GLint wrap = flags & Flags_Clamp ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+
+    glSamplerParameteri (sampler, GL_TEXTURE_WRAP_S, wrap);
+    glSamplerParameteri (sampler, GL_TEXTURE_WRAP_T, wrap);
+
+    if (flags & Flags_Nearest) {
+        glSamplerParameteri (sampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glSamplerParameteri (
+            sampler, GL_TEXTURE_MIN_FILTER, flags & Flags_Mipmaps ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST);
+    } else {
+        glSamplerParameteri (sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glSamplerParameteri (
+            sampler, GL_TEXTURE_MIN_FILTER, flags & Flags_Mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    }
+
+    glSamplerParameterf (sampler, GL_TEXTURE_MAX_ANISOTROPY, 8.0f);
+
+#if !NDEBUG
+    const std::string label = "Sampler " + std::to_string (flags);
+
+    glObjectLabel (GL_SAMPLER, sampler, -1, label.c_str ());
+#endif /* DEBUG */
+}
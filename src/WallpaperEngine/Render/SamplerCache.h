@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include <GL/glew.h>
+
+namespace WallpaperEngine::Render {
+/**
+ * Sampler objects shared by every texture with the same wrapping and filtering
+ *
+ * Textures don't carry sampling state of their own, whoever binds one binds the sampler for its flags too. There's
+ * only a handful of combinations so the samplers are created on first use and live as long as the process
+ */
+class SamplerCache {
+  public:
+    enum Flags {
+        Flags_None = 0,
+        /** GL_CLAMP_TO_EDGE instead of GL_REPEAT */
+        Flags_Clamp = 1 << 0,
+        /** GL_NEAREST filtering instead of GL_LINEAR */
+        Flags_Nearest = 1 << 1,
+        /** the texture has mipmaps to filter between */
+        Flags_Mipmaps = 1 << 2,
+        Flags_All = Flags_Clamp | Flags_Nearest | Flags_Mipmaps,
+    };
+
+    /**
+     * @param flags Mask of Flags values
+     *
+     * @return The sampler for them, must be called on a thread with a GL context
+     */
+    static GLuint get (uint32_t flags);
+
+  private:
+    static void setup (GLuint sampler, uint32_t flags);
+};
+} // namespace WallpaperEngine::Render
@@ -0,0 +1,193 @@
+#include "ShaderCache.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/Utils/CacheDirectory.h"
+
+using namespace WallpaperEngine::Render;
+
+namespace {
+/** anything bigger can only come from a corrupt entry */
+constexpr uint32_t MAX_BLOB_SIZE = 64 * 1024 * 1024;
+
+template <typename T> void writeValue (std::ostream& out, const T& value) {
+    out.write (reinterpret_cast<const char*> (&value), sizeof (value));
+}
+
+template <typename T> T readValue (std::istream& in) {
+    T value {};
+
+    in.read (reinterpret_cast<char*> (&value), sizeof (value));
+
+    return value;
+}
+
+template <typename T> void writeBlob (std::ostream& out, const T& data) {
+    writeValue<uint32_t> (out, static_cast<uint32_t> (data.size ()));
+    out.write (data.data (), static_cast<std::streamsize> (data.size ()));
+}
+
+template <typename T> bool readBlob (std::istream& in, T& data) {
+    const auto size = readValue<uint32_t> (in);
+
+    if (!in || size > MAX_BLOB_SIZE)
+        return false;
+
+    data.resize (size);
+    in.read (data.data (), size);
+
+    return static_cast<bool> (in);
+}
+
+void writeLocations (std::ostream& out, const std::map<std::string, int32_t>& locations) {
+    writeValue<uint32_t> (out, static_cast<uint32_t> (locations.size ()));
+
+    for (const auto& [name, location] : locations) {
+        writeBlob (out, name);
+        writeValue<int32_t> (out, location);
+    }
+}
+
+bool readLocations (std::istream& in, std::map<std::string, int32_t>& locations) {
+    const auto count = readValue<uint32_t> (in);
+
+    if (!in || count > MAX_BLOB_SIZE)
+        return false;
+
+    locations.clear ();
+
+    for (uint32_t i = 0; i < count; i++) {
+        std::string name;
+
+        if (!readBlob (in, name))
+            return false;
+
+        locations.emplace (std::move (name), readValue<int32_t> (in));
+    }
+
+    return static_cast<bool> (in);
+}
+
+void hashBytes (uint64_t& hash, const std::string& data) {
+    for (const char c : data) {
+        hash ^= static_cast<uint8_t> (c);
+        hash *= 0x100000001b3ULL;
+    }
+}
+} // namespace
+
+std::filesystem::path ShaderCache::getPath (const std::string& vertex, const std::string& fragment) {
+    const std::filesystem::path cache = Utils::getCacheDirectory ();
+
+    if (cache.empty ())
+        return {};
+
+    std::ostringstream name;
+
+    name << std::hex << std::setw (16) << std::setfill ('0') << hash (vertex, fragment) << ".bin";
+
+    return cache / "shaders" / name.str ();
+}
+
+bool ShaderCache::load (const std::filesystem::path& path, Entry& entry) {
+    std::ifstream in (path, std::ios::binary);
+
+    if (!in)
+        return false;
+
+    if (readValue<uint32_t> (in) != MAGIC || readValue<uint32_t> (in) != VERSION)
+        return false;
+
+    std::string driver;
+
+    if (!readBlob (in, driver) || !readBlob (in, entry.vertex) || !readBlob (in, entry.fragment))
+        return false;
+
+    entry.source = static_cast<Source> (readValue<uint8_t> (in));
+
+    if (!readLocations (in, entry.uniforms) || !readLocations (in, entry.attributes))
+        return false;
+
+    entry.binaryFormat = readValue<GLenum> (in);
+
+    // the translated sources are portable, the binary is not
+    if (driver != getDriver () || !readBlob (in, entry.binary)) {
+        entry.binaryFormat = GL_NONE;
+        entry.binary.clear ();
+    }
+
+    return true;
+}
+
+void ShaderCache::store (const std::filesystem::path& path, const Entry& entry) {
+    std::error_code ec;
+
+    std::filesystem::create_directories (path.parent_path (), ec);
+
+    if (ec) {
+        sLog.error ("Cannot create shader cache directory ", path.parent_path (), ": ", ec.message ());
+        return;
+    }
+
+    // other instances might be reading the same entry, never let them see a partial one
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream out (temporary, std::ios::binary | std::ios::trunc);
+
+        writeValue<uint32_t> (out, MAGIC);
+        writeValue<uint32_t> (out, VERSION);
+        writeBlob (out, getDriver ());
+        writeBlob (out, entry.vertex);
+        writeBlob (out, entry.fragment);
+        writeValue<uint8_t> (out, entry.source);
+        writeLocations (out, entry.uniforms);
+        writeLocations (out, entry.attributes);
+        writeValue<GLenum> (out, entry.binaryFormat);
+        writeBlob (out, entry.binary);
+
+        if (!out) {
+            sLog.error ("Cannot write shader cache entry ", temporary);
+            out.close ();
+            std::filesystem::remove (temporary, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename (temporary, path, ec);
+
+    if (ec)
+        sLog.error ("Cannot store shader cache entry ", path, ": ", ec.message ());
+}
+
+uint64_t ShaderCache::hash (const std::string& vertex, const std::string& fragment) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    hashBytes (hash, vertex);
+    // keep "ab" + "c" and "a" + "bc" apart
+    hashBytes (hash, std::string (1, '\0'));
+    hashBytes (hash, fragment);
+
+    return hash;
+}
+
+const std::string& ShaderCache::getDriver () {
+    static const std::string driver = [] {
+        std::string result;
+
+        for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            if (const auto value = glGetString (name); value != nullptr)
+                result += reinterpret_cast<const char*> (value);
+
+            result += '\n';
+        }
+
+        return result;
+    } ();
+
+    return driver;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+namespace WallpaperEngine::Render {
+/**
+ * On-disk cache of the shader programs built by the ProgramCache
+ *
+ * Entries are keyed on the sources after preprocessing (so combos and constants are part of the key) and keep
+ * both the GLSL the translation produced and, when the driver supports it, the linked program binary. Binaries
+ * are only valid for the driver that produced them, so every entry is tagged with the GL vendor, renderer and
+ * version and one from a different driver falls back to the cached GLSL only
+ *
+ * The sources are either the preprocessed GLSL as is, when the driver compiled it, or what the driver needed
+ * instead (translated GLSL, or SPIR-V modules with GL_ARB_gl_spirv), Entry::source tells which one so the next
+ * launch goes straight to it
+ */
+class ShaderCache {
+  public:
+    enum Source : uint8_t {
+        /** the preprocessed GLSL */
+        Source_Preprocessed = 0,
+        /** GLSL 330 from glslang and SPIRV-Cross */
+        Source_Translated = 1,
+        /** SPIR-V modules from glslang, the words stored as bytes */
+        Source_Spirv = 2,
+    };
+
+    struct Entry {
+        /** vertex shader as compiled */
+        std::string vertex = {};
+        /** fragment shader as compiled */
+        std::string fragment = {};
+        Source source = Source_Preprocessed;
+        /** for Source_Spirv, the locations glslang gave the uniforms as the driver can't look them up */
+        std::map<std::string, int32_t> uniforms = {};
+        /** for Source_Spirv, the locations glslang gave the attributes */
+        std::map<std::string, int32_t> attributes = {};
+        GLenum binaryFormat = GL_NONE;
+        /** linked program, empty if it was not available or came from a different driver */
+        std::vector<char> binary = {};
+    };
+
+    /**
+     * @param vertex Vertex shader source, before translation
+     * @param fragment Fragment shader source, before translation
+     *
+     * @return Where the entry for these sources is stored, empty if there's no cache directory
+     */
+    static std::filesystem::path getPath (const std::string& vertex, const std::string& fragment);
+
+    /**
+     * @param path
+     * @param entry Filled in with the cached entry
+     *
+     * @return If there was an entry for the sources, entry.binary is left empty if it's from another driver
+     */
+    static bool load (const std::filesystem::path& path, Entry& entry);
+
+    /**
+     * Writes the entry, replacing any previous one
+     *
+     * @param path
+     * @param entry
+     */
+    static void store (const std::filesystem::path& path, const Entry& entry);
+
+    /**
+     * @return A 64-bit FNV-1a hash of both sources, stable between runs
+     */
+    static uint64_t hash (const std::string& vertex, const std::string& fragment);
+
+    /**
+     * @return Vendor, renderer and version of the driver in use, the first call must be on a thread with a GL context
+     */
+    static const std::string& getDriver ();
+
+  private:
+    static constexpr uint32_t MAGIC = 0x4353574c; // "LWSC"
+    static constexpr uint32_t VERSION = 3;
+};
+} // namespace WallpaperEngine::Render
@@ -9,6 +9,10 @@
 #include "SPIRV/GlslangToSpv.h"
 #include "spirv_glsl.hpp"
 
+#if ENABLE_SPIRV_OPT
+#include "spirv-tools/optimizer.hpp"
+#endif /* ENABLE_SPIRV_OPT */
+
 using namespace WallpaperEngine::Render::Shaders;
 
 TBuiltInResource BuiltInResource = {
@@ -117,6 +121,51 @@ TBuiltInResource BuiltInResource = {
     }
 };
 
+namespace {
+bool parseUnit (
+    glslang::TShader& unit, const char* const* source, EShLanguage stage, glslang::EShTargetLanguageVersion target
+) {
+    unit.setStrings (source, 1);
+    unit.setEntryPoint ("main");
+    unit.setEnvInput (glslang::EShSourceGlsl, stage, glslang::EShClientOpenGL, 330);
+    unit.setEnvClient (glslang::EShClientOpenGL, glslang::EShTargetOpenGL_450);
+    unit.setEnvTarget (glslang::EShTargetSpv, target);
+    unit.setAutoMapLocations (true);
+    unit.setAutoMapBindings (true);
+
+    if (unit.parse (&BuiltInResource, 100, false, EShMsgDefault))
+        return true;
+
+    if (stage == EShLangVertex) {
+        sLog.error ("GLSL vertex unit parsing Failed: ", unit.getInfoLog ());
+    } else {
+        sLog.error ("GLSL fragment unit parsing Failed: ", unit.getInfoLog ());
+    }
+
+    return false;
+}
+
+/**
+ * Runs SPIRV-Tools' -O recipe on the module, it's left as it was if the optimizer can't handle it
+ */
+void optimizeSpirv (std::vector<uint32_t>& spirv) {
+#if ENABLE_SPIRV_OPT
+    spvtools::Optimizer optimizer (SPV_ENV_UNIVERSAL_1_5);
+    spvtools::OptimizerOptions options;
+    std::vector<uint32_t> optimized;
+
+    // glslang's OpenGL flavour (loose uniforms) doesn't pass the Vulkan-minded validation, SPIRV-Cross copes with it
+    options.set_run_validator (false);
+    optimizer.RegisterPerformancePasses ();
+
+    if (optimizer.Run (spirv.data (), spirv.size (), &optimized, options))
+        spirv = std::move (optimized);
+    else
+        sLog.debug ("SPIR-V optimization failed, translating the module as it is");
+#endif /* ENABLE_SPIRV_OPT */
+}
+} // namespace
+
 GLSLContext::GLSLContext () {
     assert (this->sInstance == nullptr);
 
@@ -134,37 +183,21 @@ GLSLContext& GLSLContext::get () {
     return *sInstance;
 }
 
-std::pair<std::string, std::string> GLSLContext::toGlsl (const std::string& vertex, const std::string& fragment) {
+std::pair<std::string, std::string> GLSLContext::toGlsl (
+    const std::string& vertex, const std::string& fragment, const bool optimize
+) {
     glslang::TShader vertexShader (EShLangVertex);
+    glslang::TShader fragmentShader (EShLangFragment);
 
     const char* vertexSource = vertex.c_str();
-    vertexShader.setStrings(&vertexSource, 1);
-    vertexShader.setEntryPoint("main");
-    vertexShader.setEnvInput(glslang::EShSourceGlsl, EShLangVertex, glslang::EShClientOpenGL, 330);
-    vertexShader.setEnvClient(glslang::EShClientOpenGL, glslang::EShTargetOpenGL_450);
-    vertexShader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_5);
-    vertexShader.setAutoMapLocations (true);
-    vertexShader.setAutoMapBindings (true);
-
-    if (!vertexShader.parse (&BuiltInResource, 100, false, EShMsgDefault)) {
-        sLog.error ("GLSL vertex unit parsing Failed: ", vertexShader.getInfoLog());
+    const char* fragmentSource = fragment.c_str();
+
+    if (!parseUnit (vertexShader, &vertexSource, EShLangVertex, glslang::EShTargetSpv_1_5))
         return {"", ""};
-    }
-    glslang::TShader fragmentShader (EShLangFragment);
 
-    const char* fragmentSource = fragment.c_str();
-    fragmentShader.setStrings(&fragmentSource, 1);
-    fragmentShader.setEntryPoint("main");
-    fragmentShader.setEnvInput(glslang::EShSourceGlsl, EShLangFragment, glslang::EShClientOpenGL, 330);
-    fragmentShader.setEnvClient(glslang::EShClientOpenGL, glslang::EShTargetOpenGL_450);
-    fragmentShader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_5);
-    fragmentShader.setAutoMapLocations (true);
-    fragmentShader.setAutoMapBindings (true);
-
-    if (!fragmentShader.parse (&BuiltInResource, 100, false, EShMsgDefault)) {
-        sLog.error ("GLSL fragment unit parsing Failed: ", fragmentShader.getInfoLog());
+    if (!parseUnit (fragmentShader, &fragmentSource, EShLangFragment, glslang::EShTargetSpv_1_5))
         return {"", ""};
-    }
+
     glslang::TProgram program;
     program.addShader (&vertexShader);
     program.addShader (&fragmentShader);
@@ -177,6 +210,9 @@ std::pair<std::string, std::string> GLSLContext::toGlsl (const std::string& vert
     std::vector<uint32_t> spirv;
     glslang::GlslangToSpv (*program.getIntermediate (EShLangVertex), spirv);
 
+    if (optimize)
+        optimizeSpirv (spirv);
+
     spirv_cross::CompilerGLSL vertexCompiler (spirv);
     spirv_cross::CompilerGLSL::Options options;
     options.version = 330;
@@ -186,6 +222,9 @@ std::pair<std::string, std::string> GLSLContext::toGlsl (const std::string& vert
     spirv.clear ();
     glslang::GlslangToSpv (*program.getIntermediate (EShLangFragment), spirv);
 
+    if (optimize)
+        optimizeSpirv (spirv);
+
     spirv_cross::CompilerGLSL fragmentCompiler (spirv);
     options.version = 330;
     options.es = false;
@@ -195,4 +234,62 @@ std::pair<std::string, std::string> GLSLContext::toGlsl (const std::string& vert
 }
 
 
+bool GLSLContext::toSpirv (const std::string& vertex, const std::string& fragment, Spirv& output) {
+    glslang::TShader vertexShader (EShLangVertex);
+    glslang::TShader fragmentShader (EShLangFragment);
+
+    const char* vertexSource = vertex.c_str ();
+    const char* fragmentSource = fragment.c_str ();
+
+    // 1.0 is the only version GL_ARB_gl_spirv guarantees
+    if (!parseUnit (vertexShader, &vertexSource, EShLangVertex, glslang::EShTargetSpv_1_0))
+        return false;
+
+    if (!parseUnit (fragmentShader, &fragmentSource, EShLangFragment, glslang::EShTargetSpv_1_0))
+        return false;
+
+    glslang::TProgram program;
+    program.addShader (&vertexShader);
+    program.addShader (&fragmentShader);
+
+    // the locations and bindings have to be decided here, the driver won't do it for SPIR-V
+    if (!program.link (EShMsgDefault) || !program.mapIO () || !program.buildReflection ()) {
+        sLog.error ("Program Linking Failed: ", program.getInfoLog ());
+        return false;
+    }
+
+    output = {};
+
+    for (int i = 0; i < program.getNumUniformVariables (); i++) {
+        const glslang::TObjectReflection& uniform = program.getUniform (i);
+
+        // members of a block are not set one by one
+        if (uniform.index >= 0 || uniform.layoutLocation () == glslang::TQualifier::layoutLocationEnd)
+            continue;
+
+        output.uniforms.emplace (uniform.name, uniform.layoutLocation ());
+
+        // arrays are looked up by their name alone too
+        if (uniform.name.ends_with ("[0]"))
+            output.uniforms.emplace (uniform.name.substr (0, uniform.name.size () - 3), uniform.layoutLocation ());
+    }
+
+    for (int i = 0; i < program.getNumUniformBlocks (); i++) {
+        const glslang::TObjectReflection& block = program.getUniformBlock (i);
+
+        output.blocks.emplace (block.name, block.getBinding ());
+    }
+
+    for (int i = 0; i < program.getNumPipeInputs (); i++) {
+        const glslang::TObjectReflection& input = program.getPipeInput (i);
+
+        output.attributes.emplace (input.name, input.layoutLocation ());
+    }
+
+    glslang::GlslangToSpv (*program.getIntermediate (EShLangVertex), output.vertex);
+    glslang::GlslangToSpv (*program.getIntermediate (EShLangFragment), output.fragment);
+
+    return true;
+}
+
 std::unique_ptr <GLSLContext> GLSLContext::sInstance = nullptr;
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <ostream>
 #include <sstream>
@@ -17,10 +19,46 @@ class GLSLContext {
         UnitType_Fragment = 1
     };
 
+    /**
+     * A program compiled to SPIR-V, drivers don't look anything up by name in these so the locations
+     * glslang assigned are kept along with the modules
+     */
+    struct Spirv {
+        std::vector<uint32_t> vertex = {};
+        std::vector<uint32_t> fragment = {};
+        /** location of every uniform outside of a block */
+        std::map<std::string, int32_t> uniforms = {};
+        /** location of every vertex attribute */
+        std::map<std::string, int32_t> attributes = {};
+        /** binding point of every uniform block */
+        std::map<std::string, int32_t> blocks = {};
+    };
+
     GLSLContext ();
     ~GLSLContext ();
 
-    [[nodiscard]] std::pair<std::string, std::string> toGlsl (const std::string& vertex, const std::string& fragment);
+    /**
+     * Translates both units to plain GLSL 330 through SPIR-V
+     *
+     * @param vertex
+     * @param fragment
+     * @param optimize If SPIRV-Tools' performance passes should run on the SPIR-V in between, ignored when not
+     *                 built with it
+     *
+     * @return The translated units, both empty if the program could not be compiled
+     */
+    [[nodiscard]] std::pair<std::string, std::string> toGlsl (
+        const std::string& vertex, const std::string& fragment, bool optimize = false);
+    /**
+     * Compiles both units to SPIR-V 1.0 for GL_ARB_gl_spirv
+     *
+     * @param vertex
+     * @param fragment
+     * @param output
+     *
+     * @return If the program could be compiled
+     */
+    [[nodiscard]] bool toSpirv (const std::string& vertex, const std::string& fragment, Spirv& output);
 
     [[nodiscard]] static GLSLContext& get ();
 
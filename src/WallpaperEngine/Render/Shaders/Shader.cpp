@@ -6,7 +6,6 @@
 #include <WallpaperEngine/Render/Shaders/Shader.h>
 #include <regex>
 
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariable.h"
 
 #include "GLSLContext.h"
 #include "WallpaperEngine/Assets/AssetLoadException.h"
@@ -59,26 +58,9 @@ const std::map<std::string, int>& Shader::getCombos () const {
 }
 
 Shader::ParameterSearchResult Shader::findParameter (const std::string& name) const {
-    Variables::ShaderVariable* vertex = nullptr;
-    Variables::ShaderVariable* fragment = nullptr;
-
-    for (const auto& cur : this->m_vertex.getParameters ()) {
-        if (cur->getIdentifierName () == name) {
-            vertex = cur;
-            break;
-        }
-    }
-
-    for (const auto& cur : this->m_fragment.getParameters()) {
-        if (cur->getIdentifierName () == name) {
-            fragment = cur;
-            break;
-        }
-    }
-
     return {
-        .vertex = vertex,
-        .fragment = fragment,
+        .vertex = this->m_vertex.getParameters ().find (name),
+        .fragment = this->m_fragment.getParameters ().find (name),
     };
 }
 } // namespace WallpaperEngine::Render::Shaders
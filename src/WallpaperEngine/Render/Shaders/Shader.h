@@ -5,7 +5,7 @@
 #include <vector>
 
 #include "../TextureProvider.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariable.h"
+#include "WallpaperEngine/Render/Shaders/ShaderParameters.h"
 
 #include "ShaderUnit.h"
 #include "GLSLContext.h"
@@ -23,8 +23,8 @@ using namespace WallpaperEngine::Data::Model;
 class Shader {
   public:
     struct ParameterSearchResult {
-        Variables::ShaderVariable* vertex;
-        Variables::ShaderVariable* fragment;
+        const ShaderParameters::Parameter* vertex;
+        const ShaderParameters::Parameter* fragment;
     };
     /**
      * Compiler constructor, loads the given shader file and prepares
@@ -85,10 +85,6 @@ class Shader {
      * The shader file this instance is loading
      */
     std::string m_file;
-    /**
-     * The parameters the shader needs
-     */
-    std::vector<Variables::ShaderVariable*> m_parameters = {};
     /**
      * The combos the shader should be generated with
      */
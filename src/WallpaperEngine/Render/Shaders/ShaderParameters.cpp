@@ -0,0 +1,60 @@
+#include "ShaderParameters.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace WallpaperEngine::Render::Shaders;
+
+void* ShaderParameters::emplace (const Symbol name, std::string identifier, const Type type) {
+    this->m_parameters.push_back ({
+        .name = name,
+        .identifier = std::move (identifier),
+        .type = type,
+        .offset = static_cast<uint32_t> (this->m_block.size () * sizeof (glm::vec4)),
+    });
+
+    return &this->m_block.emplace_back (0.0f);
+}
+
+void ShaderParameters::add (const Symbol name, std::string identifier, const float value) {
+    memcpy (this->emplace (name, std::move (identifier), Float), &value, sizeof (value));
+}
+
+void ShaderParameters::add (const Symbol name, std::string identifier, const int value) {
+    // the bits are stored as they are, like an int in a uniform block
+    memcpy (this->emplace (name, std::move (identifier), Integer), &value, sizeof (value));
+}
+
+void ShaderParameters::add (const Symbol name, std::string identifier, const glm::vec2& value) {
+    memcpy (this->emplace (name, std::move (identifier), Vector2), &value, sizeof (value));
+}
+
+void ShaderParameters::add (const Symbol name, std::string identifier, const glm::vec3& value) {
+    memcpy (this->emplace (name, std::move (identifier), Vector3), &value, sizeof (value));
+}
+
+void ShaderParameters::add (const Symbol name, std::string identifier, const glm::vec4& value) {
+    memcpy (this->emplace (name, std::move (identifier), Vector4), &value, sizeof (value));
+}
+
+const ShaderParameters::Parameter* ShaderParameters::find (const std::string& identifier) const {
+    const auto it = std::ranges::find (this->m_parameters, identifier, &Parameter::identifier);
+
+    return it == this->m_parameters.end () ? nullptr : &*it;
+}
+
+std::vector<ShaderParameters::Parameter>::const_iterator ShaderParameters::begin () const {
+    return this->m_parameters.begin ();
+}
+
+std::vector<ShaderParameters::Parameter>::const_iterator ShaderParameters::end () const {
+    return this->m_parameters.end ();
+}
+
+size_t ShaderParameters::size () const {
+    return this->m_parameters.size ();
+}
+
+const void* ShaderParameters::getData () const {
+    return this->m_block.data ();
+}
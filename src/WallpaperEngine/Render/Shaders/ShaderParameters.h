@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "WallpaperEngine/Data/Utils/Symbol.h"
+
+namespace WallpaperEngine::Render::Shaders {
+using namespace WallpaperEngine::Data::Utils;
+
+/**
+ * The parameters a shader unit declares with their default values
+ *
+ * Defaults live in one contiguous block, a 16 byte slot per parameter laid out like a std140 array of vec4, so the
+ * whole block can be handed to a uniform buffer as is. The descriptions only keep the type and offset of each one
+ */
+class ShaderParameters {
+  public:
+    enum Type : uint8_t {
+        Float = 0,
+        Integer = 1,
+        Vector2 = 2,
+        Vector3 = 3,
+        Vector4 = 4,
+    };
+
+    struct Parameter {
+        /** The uniform's name in the shader */
+        Symbol name;
+        /** The name materials set the parameter with */
+        std::string identifier;
+        Type type;
+        /** Byte offset of the default value in the block */
+        uint32_t offset;
+    };
+
+    void add (Symbol name, std::string identifier, float value);
+    void add (Symbol name, std::string identifier, int value);
+    void add (Symbol name, std::string identifier, const glm::vec2& value);
+    void add (Symbol name, std::string identifier, const glm::vec3& value);
+    void add (Symbol name, std::string identifier, const glm::vec4& value);
+
+    /**
+     * @param identifier
+     *
+     * @return The parameter materials know under this name, nullptr if the shader doesn't have it
+     */
+    [[nodiscard]] const Parameter* find (const std::string& identifier) const;
+
+    /**
+     * @param parameter
+     *
+     * @return The default value of the parameter, has to be read as the type it was declared with
+     */
+    template <typename T> [[nodiscard]] T get (const Parameter& parameter) const {
+        static_assert (sizeof (T) <= sizeof (glm::vec4));
+
+        T value;
+
+        memcpy (&value, reinterpret_cast<const uint8_t*> (this->m_block.data ()) + parameter.offset, sizeof (T));
+
+        return value;
+    }
+
+    [[nodiscard]] std::vector<Parameter>::const_iterator begin () const;
+    [[nodiscard]] std::vector<Parameter>::const_iterator end () const;
+    [[nodiscard]] size_t size () const;
+
+    /**
+     * @return The default values, size () slots of 16 bytes
+     */
+    [[nodiscard]] const void* getData () const;
+
+  private:
+    /** Adds the description and a zeroed slot for its value, returns the slot */
+    void* emplace (Symbol name, std::string identifier, Type type);
+
+    std::vector<Parameter> m_parameters = {};
+    std::vector<glm::vec4> m_block = {};
+};
+} // namespace WallpaperEngine::Render::Shaders
@@ -1,21 +1,18 @@
 #include "ShaderUnit.h"
 
 #include "WallpaperEngine/Logging/Log.h"
-#include <regex>
+#include <cstring>
 #include <stack>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 #include <utility>
 
 #include "GLSLContext.h"
 #include "WallpaperEngine/Assets/AssetLoadException.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariable.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableFloat.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableInteger.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableVector2.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableVector3.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariableVector4.h"
 
 #include "WallpaperEngine/Data/Builders/VectorBuilder.h"
+#include "WallpaperEngine/Data/Utils/Symbol.h"
 #include "WallpaperEngine/FileSystem/Container.h"
 
 #define SHADER_HEADER(filename) "#version 330\n" \
@@ -50,8 +47,28 @@
 
 using namespace WallpaperEngine::Render;
 using namespace WallpaperEngine::Data::Builders;
+using namespace WallpaperEngine::Data::Utils;
 using namespace WallpaperEngine::Render::Shaders;
 
+namespace {
+std::string replaceAll (const std::string& source, std::string_view from, std::string_view to) {
+    std::string result;
+    size_t current = 0, start = 0;
+
+    result.reserve (source.size ());
+
+    while ((start = source.find (from, current)) != std::string::npos) {
+        result.append (source, current, start - current);
+        result.append (to);
+        current = start + from.size ();
+    }
+
+    result.append (source, current);
+
+    return result;
+}
+} // namespace
+
 ShaderUnit::ShaderUnit (
     const GLSLContext::UnitType type, std::string file, std::string content, const AssetLocator& assetLocator,
     const ShaderConstantMap& constants, const TextureMap& passTextures, const TextureMap& overrideTextures,
@@ -80,31 +97,23 @@ void ShaderUnit::preprocess () {
     this->preprocessRequires ();
 
     // replace gl_FragColor with the equivalent
-    const std::string from = "gl_FragColor";
-    const std::string to = "out_FragColor";
-
-    size_t start_pos = 0;
-    while ((start_pos = this->m_preprocessed.find (from, start_pos)) != std::string::npos) {
-        this->m_preprocessed.replace (start_pos, from.length (), to);
-        start_pos += to.length (); // Handles case where 'to' is a substring of 'from'
-    }
+    this->m_preprocessed = replaceAll (this->m_preprocessed, "gl_FragColor", "out_FragColor");
 }
 
 void ShaderUnit::preprocessVariables () {
-    this->m_preprocessed = this->m_content;
-    this->m_includes = "";
+    const std::string_view content = this->m_content;
 
     size_t start = 0, end = 0;
-    while ((end = this->m_preprocessed.find ('\n', start)) != std::string::npos) {
+    while ((end = content.find ('\n', start)) != std::string::npos) {
         // Extract a line from the string
-        std::string line = this->m_preprocessed.substr (start, end - start);
+        const std::string_view line = content.substr (start, end - start);
         const size_t combo = line.find("// [COMBO] ");
         const size_t uniform = line.find("uniform ");
         const size_t comment = line.find("// ");
         const size_t semicolon = line.find(';');
 
         if (combo != std::string::npos) {
-            this->parseComboConfiguration (line.substr(combo + strlen("// [COMBO] ")), 0);
+            this->parseComboConfiguration (std::string (line.substr(combo + strlen("// [COMBO] "))), 0);
         } else if (
             uniform != std::string::npos &&
             comment != std::string::npos &&
@@ -120,9 +129,9 @@ void ShaderUnit::preprocessVariables () {
 
                 if (previous_space != std::string::npos) {
                     // extract type and name
-                    std::string type = line.substr (previous_space + 1, last_space - previous_space - 1);
-                    std::string name = line.substr (last_space + 1, semicolon - last_space - 1);
-                    std::string json = line.substr (comment + 2);
+                    std::string type (line.substr (previous_space + 1, last_space - previous_space - 1));
+                    std::string name (line.substr (last_space + 1, semicolon - last_space - 1));
+                    std::string json (line.substr (comment + 2));
 
                     this->parseParameterConfiguration (type, name, json);
                 }
@@ -138,76 +147,18 @@ void ShaderUnit::preprocessIncludes () {
     size_t start = 0, end = 0;
     // prepare the include content
     while((start = this->m_preprocessed.find("#include", end)) != std::string::npos) {
-        // TODO: CHECK FOR ERRORS HERE, MALFORMED INCLUDES WILL NOT BE PROPERLY HANDLED
-        const size_t quoteStart = this->m_preprocessed.find_first_of ('"', start) + 1;
-        const size_t quoteEnd = this->m_preprocessed.find_first_of('"', quoteStart);
-        const std::string filename = this->m_preprocessed.substr(quoteStart, quoteEnd - quoteStart);
-
-        // some includes might not be present
-        // and that should not be treated as an error mainly because these could come from
-        // commented out content
-        std::string content;
-
-        try {
-            content += "// begin of include from file ";
-            content += filename;
-            content += "\n";
-            content += this->m_assetLocator.includeShader (filename);
-            content += "\n// end of included from file ";
-            content += filename;
-            content += "\n";
-        } catch (AssetLoadException&) {
-            content += "// tried including file ";
-            content += filename;
-            content += " but was not found\n";
-        }
+        const std::string filename = includeFilename (this->m_preprocessed, start);
 
         // replace the first two letters with a comment so the filelength doesn't change
-        this->m_preprocessed = this->m_preprocessed.replace (start, 2, "//");
+        this->m_preprocessed [start] = '/';
+        this->m_preprocessed [start + 1] = '/';
 
-        this->m_includes += content;
+        this->appendInclude (this->m_includes, filename, false, 0);
 
         // go to the end of the line
         end = start;
     }
 
-    // ensure the included files do not include other files
-    end = 0;
-
-    // then apply includes in-place
-    while((start = this->m_includes.find("#include", end)) != std::string::npos) {
-        const size_t lineEnd = this->m_includes.find_first_of ('\n', start);
-        // TODO: CHECK FOR ERRORS HERE, MALFORMED INCLUDES WILL NOT BE PROPERLY HANDLED
-        const size_t quoteStart = this->m_includes.find_first_of ('"', start) + 1;
-        const size_t quoteEnd = this->m_includes.find_first_of('"', quoteStart);
-        const std::string filename = this->m_includes.substr(quoteStart, quoteEnd - quoteStart);
-
-        // some includes might not be present
-        // and that should not be treated as an error mainly because these could come from
-        // commented out content
-        std::string content;
-
-        try {
-            content = "// begin of include from file ";
-            content += filename;
-            content += "\n";
-            content += this->m_assetLocator.includeShader (filename);
-            content += "\n// end of included from file ";
-            content += filename;
-            content += "\n";
-        } catch (AssetLoadException&) {
-            content = "// tried including file ";
-            content += filename;
-            content += " but was not found\n";
-        }
-
-        // file contents ready, replace things
-        this->m_includes = this->m_includes.replace (start, lineEnd - start,content);
-
-        // go back to the beginning of the line to properly continue detecting things
-        end = start;
-    }
-
     // search for the main function and add the includes before that for now
     end = 0;
     bool includesAdded = false;
@@ -258,28 +209,24 @@ void ShaderUnit::preprocessIncludes () {
 
         // start looking for #if and #endif results and add to the stack so we find the start of the current chain of ifdefs
         // and use that as point
-
-        // for this we'll use regex
-        const std::regex ifdef (R"((#if|#endif))");
-        std::smatch match;
         size_t current = 0;
 
-        while (std::regex_search (this->m_preprocessed.cbegin () + current, this->m_preprocessed.cend (), match, ifdef)) {
-            current += match.position ();
-
+        while ((current = this->m_preprocessed.find ('#', current)) != std::string::npos) {
             // if it's opening an #ifdef keep track of the start of the block
             // and that's it
-            if (this->m_preprocessed.substr (current, 3) == "#if") {
-                // go to the next character so the regex doesn't match with the same thing again
+            if (this->m_preprocessed.compare (current, 3, "#if") == 0) {
+                // go to the next character so the same directive isn't found again
                 ifdefStack.push (current++);
                 continue;
             }
 
-            // go to the next character so the regex doesn't match with the same thing again
+            const bool endif = this->m_preprocessed.compare (current, 6, "#endif") == 0;
+
+            // go to the next character so the same directive isn't found again
             current ++;
 
             // most likely a syntax error, but we'll ignore it for now...
-            if (ifdefStack.empty ()) {
+            if (!endif || ifdefStack.empty ()) {
                 continue;
             }
 
@@ -306,6 +253,59 @@ void ShaderUnit::preprocessIncludes () {
     }
 }
 
+void ShaderUnit::appendInclude (std::string& output, const std::string& filename, const bool nested, const int depth) const {
+    // a file including itself would never end
+    if (depth > MAX_INCLUDE_DEPTH)
+        sLog.exception ("Too many nested includes in shader unit ", this->m_file, " while including ", filename);
+
+    const size_t start = output.size ();
+
+    // some includes might not be present
+    // and that should not be treated as an error mainly because these could come from
+    // commented out content
+    try {
+        output += "// begin of include from file ";
+        output += filename;
+        output += "\n";
+        this->expandIncludes (output, this->m_assetLocator.includeShader (filename), depth + 1);
+        output += "\n// end of included from file ";
+        output += filename;
+        output += "\n";
+    } catch (AssetLoadException&) {
+        // nested includes never got the header, keep the output the same as it always was
+        if (nested)
+            output.resize (start);
+
+        output += "// tried including file ";
+        output += filename;
+        output += " but was not found\n";
+    }
+}
+
+void ShaderUnit::expandIncludes (std::string& output, std::string_view source, const int depth) const {
+    size_t current = 0, start = 0;
+
+    // every include line is replaced with the contents of the file, which is expanded the same way
+    while ((start = source.find ("#include", current)) != std::string::npos) {
+        const size_t lineEnd = source.find_first_of ('\n', start);
+
+        output.append (source.substr (current, start - current));
+        this->appendInclude (output, includeFilename (source, start), true, depth);
+
+        current = lineEnd == std::string::npos ? source.size () : lineEnd;
+    }
+
+    output.append (source.substr (current));
+}
+
+std::string ShaderUnit::includeFilename (std::string_view source, const size_t start) {
+    // TODO: CHECK FOR ERRORS HERE, MALFORMED INCLUDES WILL NOT BE PROPERLY HANDLED
+    const size_t quoteStart = source.find_first_of ('"', start) + 1;
+    const size_t quoteEnd = source.find_first_of ('"', quoteStart);
+
+    return std::string (source.substr (quoteStart, quoteEnd - quoteStart));
+}
+
 void ShaderUnit::preprocessRequires () {
     size_t start = 0, end = 0;
     // comment out requires
@@ -314,7 +314,8 @@ void ShaderUnit::preprocessRequires () {
         const size_t lineEnd = this->m_preprocessed.find_first_of('\n', start);
         sLog.out("Shader has a require block ", this->m_preprocessed.substr (start, lineEnd - start));
         // replace the first two letters with a comment so the filelength doesn't change
-        this->m_preprocessed = this->m_preprocessed.replace(start, 2, "//");
+        this->m_preprocessed [start] = '/';
+        this->m_preprocessed [start + 1] = '/';
 
         // go to the end of the line
         end = lineEnd;
@@ -375,25 +376,29 @@ void ShaderUnit::parseParameterConfiguration (
             sLog.exception ("Cannot parse parameter data for ", name, " in shader ", this->m_file);
     }
 
-    Variables::ShaderVariable* parameter = nullptr;
+    // only parameters materials can set are kept, their default goes in the unit's parameter block
+    const auto add = [this, &material, &name] (const auto value) {
+        if (material.has_value ())
+            this->m_parameters.add (Symbol (name), material->get <std::string> (), value);
+    };
 
     if (type == "vec4") {
-        parameter = new Variables::ShaderVariableVector4 (VectorBuilder::parse <glm::vec4> (defvalue->get <std::string> ()));
+        add (VectorBuilder::parse <glm::vec4> (defvalue->get_ref <const std::string&> ()));
     } else if (type == "vec3") {
-        parameter = new Variables::ShaderVariableVector3 (VectorBuilder::parse <glm::vec3> (*defvalue));
+        add (VectorBuilder::parse <glm::vec3> (defvalue->get_ref <const std::string&> ()));
     } else if (type == "vec2") {
-        parameter = new Variables::ShaderVariableVector2 (VectorBuilder::parse <glm::vec2> (*defvalue));
+        add (VectorBuilder::parse <glm::vec2> (defvalue->get_ref <const std::string&> ()));
     } else if (type == "float") {
         if (defvalue->is_string ()) {
-            parameter = new Variables::ShaderVariableFloat (std::stoi (defvalue->get<std::string> ()));
+            add (static_cast<float> (std::stoi (defvalue->get<std::string> ())));
         } else {
-            parameter = new Variables::ShaderVariableFloat (defvalue->get<float> ());
+            add (defvalue->get<float> ());
         }
     } else if (type == "int") {
         if (defvalue->is_string ()) {
-            parameter = new Variables::ShaderVariableInteger (std::stoi(defvalue->get<std::string> ()));
+            add (std::stoi(defvalue->get<std::string> ()));
         } else {
-            parameter = new Variables::ShaderVariableInteger (defvalue->get <int> ());
+            add (defvalue->get <int> ());
         }
     } else if (type == "sampler2D" || type == "sampler2DComparison") {
         // samplers can have special requirements, check what sampler we're working with and create definitions
@@ -487,14 +492,6 @@ void ShaderUnit::parseParameterConfiguration (
         return;
     } else {
         sLog.error ("Unknown parameter type: ", type, " for ", name, " in shader ", this->m_file);
-        return;
-    }
-
-    if (material.has_value () && parameter != nullptr) {
-        parameter->setIdentifierName (*material);
-        parameter->setName (name);
-
-        this->m_parameters.push_back (parameter);
     }
 }
 
@@ -527,58 +524,44 @@ const std::string& ShaderUnit::compile () {
         this->m_final += VERTEX_SHADER_DEFINES;
     }
 
-    std::map<std::string, bool> addedCombos;
+    // combo names are interned along with their uppercase form, each name is only uppercased once per process
+    std::unordered_set<Symbol> addedCombos;
 
     for (const auto& [name, value] : this->m_overrideCombos) {
-        std::string uppercase;
-        std::ranges::transform (name, std::back_inserter (uppercase), ::toupper);
+        const Symbol uppercase = Symbol (name).upper ();
 
-        if (!addedCombos.contains (uppercase)) {
-            this->m_final += DEFINE_COMBO (uppercase, value);
-            addedCombos.emplace (uppercase, true);
-        }
+        if (addedCombos.insert (uppercase).second)
+            this->m_final += DEFINE_COMBO (uppercase.str (), value);
     }
 
     // now add all the combos to the source
     for (const auto& [name, value] : this->m_combos) {
-        std::string uppercase;
-        std::ranges::transform (name, std::back_inserter (uppercase), ::toupper);
+        const Symbol uppercase = Symbol (name).upper ();
 
-        if (!addedCombos.contains (uppercase)) {
-            this->m_final += DEFINE_COMBO (uppercase, value);
-            addedCombos.emplace (uppercase, true);
-        }
+        if (addedCombos.insert (uppercase).second)
+            this->m_final += DEFINE_COMBO (uppercase.str (), value);
     }
 
     for (const auto& [name, value] : this->m_discoveredCombos) {
-        std::string uppercase;
-        std::ranges::transform (name, std::back_inserter (uppercase), ::toupper);
+        const Symbol uppercase = Symbol (name).upper ();
 
-        if (!addedCombos.contains (uppercase)) {
-            this->m_final += DEFINE_COMBO (uppercase, value);
-            addedCombos.emplace (uppercase, true);
-        }
+        if (addedCombos.insert (uppercase).second)
+            this->m_final += DEFINE_COMBO (uppercase.str (), value);
     }
 
     if (this->m_link != nullptr) {
         for (const auto& [name, value] : this->m_link->getCombos ()) {
-            std::string uppercase;
-            std::ranges::transform (name, std::back_inserter (uppercase), ::toupper);
+            const Symbol uppercase = Symbol (name).upper ();
 
-            if (!addedCombos.contains (uppercase)) {
-                this->m_final += DEFINE_COMBO (uppercase, value);
-                addedCombos.emplace (uppercase, true);
-            }
+            if (addedCombos.insert (uppercase).second)
+                this->m_final += DEFINE_COMBO (uppercase.str (), value);
         }
 
         for (const auto& [name, value] : this->m_link->getDiscoveredCombos ()) {
-            std::string uppercase;
-            std::ranges::transform (name, std::back_inserter (uppercase), ::toupper);
+            const Symbol uppercase = Symbol (name).upper ();
 
-            if (!addedCombos.contains (uppercase)) {
-                this->m_final += DEFINE_COMBO (uppercase, value);
-                addedCombos.emplace (uppercase, true);
-            }
+            if (addedCombos.insert (uppercase).second)
+                this->m_final += DEFINE_COMBO (uppercase.str (), value);
         }
     }
 
@@ -589,7 +572,7 @@ const std::string& ShaderUnit::compile () {
     return this->m_final;
 }
 
-const std::vector<Variables::ShaderVariable*>& ShaderUnit::getParameters () const {
+const ShaderParameters& ShaderUnit::getParameters () const {
     return this->m_parameters;
 }
 const TextureMap& ShaderUnit::getTextures () const {
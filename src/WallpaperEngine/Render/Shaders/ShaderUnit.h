@@ -3,11 +3,12 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include "GLSLContext.h"
 #include "WallpaperEngine/Data/JSON.h"
 #include "WallpaperEngine/Assets/AssetLocator.h"
-#include "WallpaperEngine/Render/Shaders/Variables/ShaderVariable.h"
+#include "WallpaperEngine/Render/Shaders/ShaderParameters.h"
 #include "nlohmann/json.hpp"
 
 #include "WallpaperEngine/Data/Model/Types.h"
@@ -47,7 +48,7 @@ class ShaderUnit {
     /**
      * @return The parameters the shader unit has as input
      */
-    [[nodiscard]] const std::vector<Variables::ShaderVariable*>& getParameters () const;
+    [[nodiscard]] const ShaderParameters& getParameters () const;
     /**
      * @return The textures this shader unit requires
      */
@@ -70,6 +71,9 @@ class ShaderUnit {
     void preprocess ();
 
   private:
+    /** Include files including others more than this are considered to be including themselves */
+    static constexpr int MAX_INCLUDE_DEPTH = 32;
+
     /**
      * Parses the input shader looking for possible combo values that are required for it to properly work
      */
@@ -78,6 +82,30 @@ class ShaderUnit {
      * Parses the input shader looking for include directives to extract the full list of included files
      */
     void preprocessIncludes ();
+    /**
+     * Appends the contents of an include file with the includes inside it already expanded
+     *
+     * @param output Where to append the contents
+     * @param filename The file to include
+     * @param nested If the include comes from another include file instead of the unit itself
+     * @param depth How many include files deep this include is
+     */
+    void appendInclude (std::string& output, const std::string& filename, bool nested, int depth) const;
+    /**
+     * Appends source to output replacing every include directive with the file's contents
+     *
+     * @param output Where to append the contents
+     * @param source The code to expand
+     * @param depth How many include files deep the source is
+     */
+    void expandIncludes (std::string& output, std::string_view source, int depth) const;
+    /**
+     * @param source
+     * @param start Position of the include directive in the source
+     *
+     * @return The file the include directive points to
+     */
+    static std::string includeFilename (std::string_view source, size_t start);
     /**
      * Parses the input shader lookin for require directives to comment them out for now
      */
@@ -125,7 +153,7 @@ class ShaderUnit {
     /**
      * The parameters the shader needs
      */
-    std::vector<Variables::ShaderVariable*> m_parameters = {};
+    ShaderParameters m_parameters = {};
     /**
      * Pre-defined values for the combos
      */
@@ -1,10 +0,0 @@
-#include "ShaderVariableInteger.h"
-
-#include <utility>
-
-using namespace WallpaperEngine::Render::Shaders::Variables;
-
-ShaderVariableInteger::ShaderVariableInteger (const int defaultValue, const std::string& name) :
-    ShaderVariable (defaultValue) {
-    this->setName (name);
-}
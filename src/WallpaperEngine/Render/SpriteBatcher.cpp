@@ -0,0 +1,101 @@
+#include "SpriteBatcher.h"
+
+#include <string>
+
+#include "WallpaperEngine/Render/CObject.h"
+#include "WallpaperEngine/Render/Objects/CImage.h"
+#include "WallpaperEngine/Render/Objects/Effects/CPass.h"
+
+using namespace WallpaperEngine::Render;
+
+SpriteBatcher::Stats SpriteBatcher::build (const std::vector<CObject*>& objects) {
+    Stats stats = {};
+
+    this->m_runs.clear ();
+
+    for (const auto& object : objects) {
+        const bool batchable = object->is<Objects::CImage> () && object->as<Objects::CImage> ()->isBatchable ();
+
+        if (batchable && !this->m_runs.empty () && this->m_runs.back ().batched) {
+            const auto& previous = *this->m_runs.back ().objects.back ()->as<Objects::CImage> ()->getPasses ().front ();
+
+            if (object->as<Objects::CImage> ()->getPasses ().front ()->isBatchableWith (previous)) {
+                this->m_runs.back ().objects.push_back (object);
+                continue;
+            }
+        }
+
+        // consecutive objects that can't be batched go in the same run, no point in splitting them
+        if (!batchable && !this->m_runs.empty () && !this->m_runs.back ().batched) {
+            this->m_runs.back ().objects.push_back (object);
+            continue;
+        }
+
+        this->m_runs.push_back ({.objects = {object}, .batched = batchable});
+    }
+
+    for (auto& run : this->m_runs) {
+        // a lone image gains nothing from the batch path
+        if (run.batched && run.objects.size () < 2)
+            run.batched = false;
+
+        if (!run.batched)
+            continue;
+
+        stats.batches++;
+        stats.batchedImages += run.objects.size ();
+    }
+
+    return stats;
+}
+
+void SpriteBatcher::render () const {
+    for (const auto& run : this->m_runs) {
+        if (run.batched) {
+            renderBatch (run.objects);
+            continue;
+        }
+
+        for (const auto& object : run.objects)
+            object->render ();
+    }
+}
+
+void SpriteBatcher::renderBatch (const std::vector<CObject*>& images) {
+#if !NDEBUG
+    const std::string str = "Rendering batch of " + std::to_string (images.size ()) + " images";
+
+    glPushDebugGroup (GL_DEBUG_SOURCE_APPLICATION, 0, -1, str.c_str ());
+#endif /* DEBUG */
+
+    // every pass in a batch is the last of its image
+    glColorMask (true, true, true, false);
+
+    // images hidden under an opaque layer are left out, the flags only look at the ones drawn
+    const auto nextDrawn = [&images] (size_t index) {
+        while (index < images.size () && images [index]->as<Objects::CImage> ()->isOccluded ())
+            index++;
+
+        return index;
+    };
+
+    bool first = true;
+
+    for (size_t index = nextDrawn (0); index < images.size ();) {
+        const size_t next = nextDrawn (index + 1);
+        uint32_t flags = Objects::Effects::CPass::Render_Full;
+
+        if (!first)
+            flags |= Objects::Effects::CPass::Render_KeepTarget;
+        if (next < images.size ())
+            flags |= Objects::Effects::CPass::Render_KeepAttributes;
+
+        images [index]->as<Objects::CImage> ()->getPasses ().front ()->render (flags);
+        first = false;
+        index = next;
+    }
+
+#if !NDEBUG
+    glPopDebugGroup ();
+#endif /* DEBUG */
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace WallpaperEngine::Render {
+class CObject;
+
+namespace Objects {
+class CImage;
+}
+
+/**
+ * Draws runs of consecutive single-pass layers that share program, target and blending back to back
+ *
+ * Layers without effects are a single pass drawing a quad on the scene, when a bunch of them in a row use
+ * the same material the framebuffer, viewport, blending and depth setup is done once for the whole run and
+ * the vertex attributes stay enabled between them, each one only binding its textures, uniforms and quad
+ */
+class SpriteBatcher {
+  public:
+    struct Stats {
+        uint32_t batches = 0;
+        uint32_t batchedImages = 0;
+    };
+
+    /**
+     * Splits the render order into objects drawn on their own and runs of compatible images,
+     * has to be called again whenever passes are added or removed
+     *
+     * @param objects The scene's objects by render order
+     *
+     * @return The runs found
+     */
+    Stats build (const std::vector<CObject*>& objects);
+
+    /**
+     * Renders every object in the order given to build ()
+     */
+    void render () const;
+
+  private:
+    struct Run {
+        std::vector<CObject*> objects = {};
+        bool batched = false;
+    };
+
+    static void renderBatch (const std::vector<CObject*>& images);
+
+    std::vector<Run> m_runs = {};
+};
+} // namespace WallpaperEngine::Render
@@ -0,0 +1,106 @@
+#include "StreamingBuffer.h"
+#include "GPUResources.h"
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Render;
+
+StreamingBuffer::StreamingBuffer (const size_t regionSize) : m_regionSize (regionSize) {
+    glGenBuffers (1, &this->m_buffer);
+    glBindBuffer (GL_COPY_WRITE_BUFFER, this->m_buffer);
+
+    if (GLEW_ARB_buffer_storage) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const GLsizeiptr size = static_cast<GLsizeiptr> (this->m_regionSize * REGION_COUNT);
+
+        glBufferStorage (GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+        this->m_storage = static_cast<char*> (glMapBufferRange (GL_COPY_WRITE_BUFFER, 0, size, flags));
+
+        if (this->m_storage == nullptr)
+            sLog.error ("Cannot map streaming buffer persistently, falling back to staged uploads");
+    }
+
+    if (this->m_storage == nullptr) {
+        // buffer storage is immutable, a new name is needed if the mapping failed after glBufferStorage
+        glDeleteBuffers (1, &this->m_buffer);
+        glGenBuffers (1, &this->m_buffer);
+        glBindBuffer (GL_COPY_WRITE_BUFFER, this->m_buffer);
+        glBufferData (GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr> (this->m_regionSize), nullptr, GL_STREAM_DRAW);
+        this->m_staging.resize (this->m_regionSize);
+    }
+
+    glBindBuffer (GL_COPY_WRITE_BUFFER, GL_NONE);
+
+    sGPUResources.add (
+        this, GPUResources::Type_Buffer, this->m_regionSize * (this->m_storage == nullptr ? 1 : REGION_COUNT),
+        "streaming");
+}
+
+StreamingBuffer::~StreamingBuffer () {
+    for (const auto& fence : this->m_fences)
+        if (fence != nullptr)
+            glDeleteSync (fence);
+
+    if (this->m_storage != nullptr) {
+        glBindBuffer (GL_COPY_WRITE_BUFFER, this->m_buffer);
+        glUnmapBuffer (GL_COPY_WRITE_BUFFER);
+        glBindBuffer (GL_COPY_WRITE_BUFFER, GL_NONE);
+    }
+
+    sGPUResources.remove (this);
+    glDeleteBuffers (1, &this->m_buffer);
+}
+
+void* StreamingBuffer::map () {
+    if (this->m_storage == nullptr)
+        return this->m_staging.data ();
+
+    if (!this->m_mapped) {
+        GLsync& fence = this->m_fences [this->m_region];
+
+        if (fence != nullptr) {
+            // the region is reused every third frame, this only blocks if the GPU is that far behind
+            while (glClientWaitSync (fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+
+            glDeleteSync (fence);
+            fence = nullptr;
+        }
+
+        this->m_mapped = true;
+    }
+
+    return this->m_storage + this->m_region * this->m_regionSize;
+}
+
+size_t StreamingBuffer::commit (const size_t bytes) {
+    if (this->m_storage != nullptr)
+        return this->m_region * this->m_regionSize;
+
+    glBindBuffer (GL_COPY_WRITE_BUFFER, this->m_buffer);
+    // orphan the previous contents so the upload doesn't wait for draws still reading them
+    glBufferData (GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr> (this->m_regionSize), nullptr, GL_STREAM_DRAW);
+    glBufferSubData (GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr> (bytes), this->m_staging.data ());
+    glBindBuffer (GL_COPY_WRITE_BUFFER, GL_NONE);
+
+    return 0;
+}
+
+void StreamingBuffer::fence () {
+    if (this->m_storage == nullptr)
+        return;
+
+    this->m_fences [this->m_region] = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    this->m_region = (this->m_region + 1) % REGION_COUNT;
+    this->m_mapped = false;
+}
+
+GLuint StreamingBuffer::getBuffer () const {
+    return this->m_buffer;
+}
+
+size_t StreamingBuffer::getRegionSize () const {
+    return this->m_regionSize;
+}
+
+bool StreamingBuffer::isPersistent () const {
+    return this->m_storage != nullptr;
+}
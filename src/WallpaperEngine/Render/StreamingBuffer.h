@@ -0,0 +1,69 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+namespace WallpaperEngine::Render {
+/**
+ * Buffer for geometry that is rewritten every frame
+ *
+ * The buffer is split in REGION_COUNT regions that are used in turns, when GL_ARB_buffer_storage is available
+ * the whole buffer is persistently mapped and the CPU writes straight into the region the GPU isn't reading from,
+ * with a fence per region to know when it can be reused. Without it the data is staged in memory and uploaded
+ * to an orphaned buffer, same as a plain glBufferData would do
+ *
+ * Usage every frame is map (), write up to getRegionSize () bytes, commit () and issue the draw calls reading
+ * from the returned offset, then fence (). The buffer is only ever bound to GL_COPY_WRITE_BUFFER internally so
+ * no vertex array state is touched, binding it as vertex or index data is up to the caller
+ */
+class StreamingBuffer {
+  public:
+    /** Regions in the ring, one being written, the others possibly still read by the GPU */
+    static constexpr int REGION_COUNT = 3;
+
+    /**
+     * @param regionSize Maximum bytes written per frame
+     */
+    explicit StreamingBuffer (size_t regionSize);
+    ~StreamingBuffer ();
+
+    StreamingBuffer (const StreamingBuffer&) = delete;
+    StreamingBuffer& operator= (const StreamingBuffer&) = delete;
+
+    /**
+     * Waits until the current region is no longer in use by the GPU
+     *
+     * @return Pointer to write the frame's data into
+     */
+    void* map ();
+
+    /**
+     * Makes the data written to the mapped pointer available to the GPU
+     *
+     * @param bytes Amount of bytes written
+     * @return Offset of the data in the buffer
+     */
+    size_t commit (size_t bytes);
+
+    /**
+     * Marks the current region as in use by the draw calls submitted so far and moves to the next one
+     */
+    void fence ();
+
+    [[nodiscard]] GLuint getBuffer () const;
+    [[nodiscard]] size_t getRegionSize () const;
+    /** @return If the buffer is persistently mapped instead of staging the data */
+    [[nodiscard]] bool isPersistent () const;
+
+  private:
+    size_t m_regionSize;
+    GLuint m_buffer = GL_NONE;
+    /** persistently mapped storage, nullptr when staging */
+    char* m_storage = nullptr;
+    std::vector<char> m_staging = {};
+    GLsync m_fences [REGION_COUNT] = {nullptr, nullptr, nullptr};
+    int m_region = 0;
+    bool m_mapped = false;
+};
+} // namespace WallpaperEngine::Render
@@ -1,52 +1,236 @@
 #include "TextureCache.h"
 
+#include <algorithm>
+
 #include "WallpaperEngine/FileSystem/Container.h"
 
 #include "CTexture.h"
 #include "WallpaperEngine/Assets/AssetLoadException.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
 #include "WallpaperEngine/Render/Helpers/ContextAware.h"
 
 #include "WallpaperEngine/Data/Model/Project.h"
 #include "WallpaperEngine/Data/Parsers/TextureParser.h"
+#include "WallpaperEngine/Logging/Log.h"
 
 using namespace WallpaperEngine::Render;
 using namespace WallpaperEngine::FileSystem;
 using namespace WallpaperEngine::Data::Parsers;
+using namespace WallpaperEngine::Data::Model;
+
+TextureCache::TextureCache (RenderContext& context) :
+    Helpers::ContextAware (context),
+    m_budget (static_cast<uint64_t> (context.getApp ().getContext ().settings.general.textureBudget) * 1024 * 1024) {}
+
+TextureCache::~TextureCache () {
+    // the decode jobs write into the textures
+    for (const auto& streaming : this->m_streaming)
+        sJobPool.wait (streaming->decode);
+
+    sJobPool.wait (this->m_stores);
+}
+
+std::shared_ptr<const TextureProvider> TextureCache::resolve (const std::string& filename, const Project& project) {
+    if (const auto found = this->m_textureCache.find ({&project, filename}); found != this->m_textureCache.end ())
+        return found->second.texture;
+
+    // cache hits are every frame, only actual loads are worth tracing
+    TRACE_SCOPE ("TextureCache::resolve");
+    std::shared_ptr<CTexture> texture = nullptr;
+
+    if (project.assetLocator->hasTexture (filename)) {
+        texture = this->load (filename, project);
+    } else {
+        // search for the texture in all the different containers just in case
+        for (const auto& other : this->getContext ().getApp ().getBackgrounds () | std::views::values) {
+            if (other.get () != &project && other->assetLocator->hasTexture (filename)) {
+                texture = this->load (filename, *other);
+                break;
+            }
+        }
+    }
+
+    if (texture == nullptr)
+        throw AssetLoadException ("Cannot find file", filename, std::error_code ());
+
+    this->m_textureCache.insert_or_assign (
+        std::make_pair (&project, filename), Entry {.texture = texture, .loaded = texture, .lastUsed = this->m_updates});
+
+    return texture;
+}
+
+std::shared_ptr<CTexture> TextureCache::load (const std::string& filename, const Project& project) {
+    Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_TextureRead);
+    const auto contents = project.assetLocator->texture (filename);
+    auto stream = BinaryReader (contents);
 
-TextureCache::TextureCache (RenderContext& context) : Helpers::ContextAware (context) {}
+    // Create metadata loader lambda that captures the assetLocator
+    // Note: Unlike texture() which prepends "materials/", readString() doesn't,
+    // so we need to construct the full path here
+    auto metadataLoader = [&project](const std::string& metaFilename) -> std::string {
+        std::filesystem::path fullPath = std::filesystem::path("materials") / metaFilename;
+        return project.assetLocator->readString (fullPath);
+    };
 
-std::shared_ptr<const TextureProvider> TextureCache::resolve (const std::string& filename) {
-    if (const auto found = this->m_textureCache.find (filename); found != this->m_textureCache.end ())
-        return found->second;
+    // reading goes through the containers so it stays here, the LZ4 blocks are decompressed by the job
+    auto parsedTexture = TextureParser::parse (stream, filename, metadataLoader, false);
 
-    // search for the texture in all the different containers just in case
-    for (const auto& project : this->getContext ().getApp ().getBackgrounds () | std::views::values) {
+    // the parser read the whole file, the compressed blocks are kept as they are
+    if (const auto read = contents->tellg (); read > 0)
+        report.addBytes (static_cast<uint64_t> (read));
+
+    const auto& settings = this->getContext ().getApp ().getContext ().settings.general;
+    auto texture = std::make_shared <CTexture> (
+        std::move (parsedTexture), true, settings.textureCompression, filename, settings.textureMaxSize);
+    auto& streaming = this->m_streaming.emplace_back (std::make_unique<Streaming> ());
+
+    streaming->texture = texture;
+
+    sJobPool.submit (streaming->decode, [record = streaming.get (), filename] {
         try {
-            const auto contents = project->assetLocator->texture (filename);
-            auto stream = BinaryReader (contents);
+            record->texture->decode ();
+        } catch (std::exception& e) {
+            sLog.error ("Cannot decode texture ", filename, ": ", e.what ());
+            record->failed = true;
+        }
+    });
+
+    return texture;
+}
+
+void TextureCache::store (
+    const std::string& name, const Project& project, std::shared_ptr<const TextureProvider> texture
+) {
+    this->m_textureCache.insert_or_assign (
+        std::make_pair (&project, name), Entry {.texture = std::move (texture), .loaded = nullptr, .lastUsed = 0});
+}
+
+void TextureCache::carryOver (
+    const Project& from, const Project& to, const std::set<std::filesystem::path>& changed
+) {
+    std::vector<std::pair<Key, Entry>> kept;
+
+    for (const auto& [key, entry] : this->m_textureCache) {
+        // the stored ones are the old wallpaper's render targets, the new one makes its own
+        if (key.first != &from || entry.loaded == nullptr)
+            continue;
+
+        const auto path = AssetLocator::texturePath (key.second);
+
+        if (changed.contains (path) || changed.contains (path.string () + "-json"))
+            continue;
+
+        kept.emplace_back (Key {&to, key.second}, entry);
+    }
+
+    for (auto& [key, entry] : kept)
+        this->m_textureCache.insert_or_assign (std::move (key), std::move (entry));
+}
+
+void TextureCache::update () {
+    this->m_updates++;
+    this->evict ();
+
+    const auto deadline = std::chrono::steady_clock::now () + UPLOAD_BUDGET;
+
+    // every texture gets drawn blurry before any of them gets its biggest levels
+    for (const auto& streaming : this->m_streaming) {
+        if (std::chrono::steady_clock::now () >= deadline)
+            return;
+        if (!streaming->decode.isDone () || streaming->failed || streaming->texture->isDrawable ())
+            continue;
 
-            // Create metadata loader lambda that captures the assetLocator
-            // Note: Unlike texture() which prepends "materials/", readString() doesn't,
-            // so we need to construct the full path here
-            auto metadataLoader = [&project](const std::string& metaFilename) -> std::string {
-                std::filesystem::path fullPath = std::filesystem::path("materials") / metaFilename;
-                return project->assetLocator->readString (fullPath);
-            };
+        streaming->texture->upload (deadline, true);
+    }
 
-            auto parsedTexture = TextureParser::parse (stream, filename, metadataLoader);
-            auto texture = std::make_shared <CTexture> (std::move (parsedTexture));
+    // uploads happen in request order, skipping the ones that are still decoding
+    for (auto it = this->m_streaming.begin (); it != this->m_streaming.end ();) {
+        if (std::chrono::steady_clock::now () >= deadline)
+            return;
 
-            this->store (filename, texture);
+        const auto& streaming = *it;
 
-            return texture;
-        } catch (AssetLoadException&) {
-            // ignored, this happens if we're looking at the wrong background
+        if (!streaming->decode.isDone ()) {
+            ++it;
+            continue;
         }
+
+        if (streaming->failed)
+            streaming->texture->discard ();
+        else if (!streaming->texture->upload (deadline))
+            return;
+
+        this->m_releasedBytes += streaming->texture->getReleasedBytes ();
+
+        // the first launch with compression stores what the driver made of the texture, off the render thread
+        if (auto entry = std::make_shared<TextureCompressionCache::Entry> (); streaming->texture->readBack (*entry)) {
+            sJobPool.submit (this->m_stores, [entry, path = streaming->texture->getCachePath ()] {
+                TextureCompressionCache::store (path, *entry);
+            });
+        }
+
+        it = this->m_streaming.erase (it);
+
+        if (this->m_streaming.empty ())
+            sLog.debug (
+                "Textures streamed in, ", this->m_releasedBytes / (1024 * 1024),
+                "MB of pixel data released from memory after upload");
     }
+}
+
+bool TextureCache::isStreaming () const {
+    return !this->m_streaming.empty ();
+}
+
+uint64_t TextureCache::getReleasedBytes () const {
+    return this->m_releasedBytes;
+}
+
+uint64_t TextureCache::getResidentBytes () const {
+    uint64_t bytes = 0;
 
-    throw AssetLoadException ("Cannot find file", filename, std::error_code ());
+    for (const auto& entry : this->m_textureCache | std::views::values)
+        if (entry.loaded != nullptr)
+            bytes += entry.loaded->getVideoMemory ();
+
+    return bytes;
 }
 
-void TextureCache::store (const std::string& name, std::shared_ptr<const TextureProvider> texture) {
-    this->m_textureCache.insert_or_assign (name, texture);
-}
\ No newline at end of file
+void TextureCache::evict () {
+    std::vector<decltype (this->m_textureCache)::iterator> unused;
+    uint64_t resident = 0;
+
+    for (auto it = this->m_textureCache.begin (); it != this->m_textureCache.end (); ++it) {
+        auto& entry = it->second;
+
+        if (entry.loaded == nullptr)
+            continue;
+
+        resident += entry.loaded->getVideoMemory ();
+
+        // the entry holds two references, anything over that is a wallpaper (or the streaming queue) using it
+        if (entry.texture.use_count () > 2)
+            entry.lastUsed = this->m_updates;
+        else if (entry.lastUsed != this->m_updates)
+            unused.push_back (it);
+    }
+
+    if (resident <= this->m_budget || unused.empty ())
+        return;
+
+    std::ranges::sort (unused, [] (const auto& a, const auto& b) {
+        return a->second.lastUsed < b->second.lastUsed;
+    });
+
+    for (const auto& it : unused) {
+        if (resident <= this->m_budget)
+            break;
+
+        sLog.debug (
+            "Evicting texture ", it->first.second, " unused for ", this->m_updates - it->second.lastUsed, " frames");
+
+        resident -= it->second.loaded->getVideoMemory ();
+        this->m_textureCache.erase (it);
+    }
+}
@@ -1,10 +1,16 @@
 #pragma once
 
-#include <map>
+#include <chrono>
+#include <filesystem>
+#include <set>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "TextureProvider.h"
+#include "WallpaperEngine/Data/Model/Types.h"
+#include "WallpaperEngine/Threading/JobPool.h"
 #include "WallpaperEngine/Render/Helpers/ContextAware.h"
 #include "WallpaperEngine/Render/RenderContext.h"
 
@@ -16,30 +22,124 @@ class ContextAware;
 }
 
 class RenderContext;
+class CTexture;
 
+/**
+ * Textures loaded by the wallpapers, looked up per project
+ *
+ * Textures no live wallpaper holds anymore (after a playlist switched away from theirs, for example) stay around
+ * so switching back is fast, until the video memory of the cached textures goes over the budget, then the ones
+ * unused for the longest are evicted first
+ */
 class TextureCache final : Helpers::ContextAware {
   public:
     explicit TextureCache (RenderContext& context);
+    ~TextureCache () override;
+
+    TextureCache (const TextureCache&) = delete;
+    TextureCache& operator= (const TextureCache&) = delete;
 
     /**
-     * Checks if the given texture was already loaded and returns it
-     * If the texture was not loaded yet, it tries to load it from the container
+     * Checks if the given texture was already loaded for the project and returns it
+     * If the texture was not loaded yet, it tries to load it from the project's container, then the other ones
+     *
+     * Textures loaded from the containers are streamed: the file is read and its metadata parsed right away,
+     * decompression and decoding happen on the JobPool and update () uploads them, until then they render
+     * as a placeholder
      *
      * @param filename
+     * @param project The project of the wallpaper the texture is for
      * @return
      */
-    std::shared_ptr<const TextureProvider> resolve (const std::string& filename);
+    std::shared_ptr<const TextureProvider> resolve (const std::string& filename, const Data::Model::Project& project);
 
     /**
-     * Registers a texture in the cache
+     * Registers a texture in the cache, these are never evicted
      *
      * @param name
+     * @param project
      * @param texture
      */
-    void store (const std::string& name, std::shared_ptr<const TextureProvider> texture);
+    void store (
+        const std::string& name, const Data::Model::Project& project, std::shared_ptr<const TextureProvider> texture);
+
+    /**
+     * Makes the textures loaded for one project available to another one loaded from the same folder, so reloading
+     * a background only reads the textures that changed again
+     *
+     * @param from The project the textures were loaded for
+     * @param to The project reloaded from the same folder
+     * @param changed Files changed since from was loaded, relative to the folder. Textures read from them are not
+     * carried over
+     */
+    void carryOver (
+        const Data::Model::Project& from, const Data::Model::Project& to, const std::set<std::filesystem::path>& changed);
+
+    /**
+     * Uploads the textures that finished decoding, spending about UPLOAD_BUDGET on it, and evicts the unused
+     * ones over the budget. Textures are made drawable first, the rest of their levels come after that.
+     * Has to be called on the render thread with the context current
+     */
+    void update ();
+
+    /**
+     * @return If any texture is still decoding or uploading
+     */
+    [[nodiscard]] bool isStreaming () const;
+
+    /**
+     * @return Bytes of pixel data the uploaded textures no longer keep in memory
+     */
+    [[nodiscard]] uint64_t getReleasedBytes () const;
+
+    /**
+     * @return Video memory taken by the cached textures
+     */
+    [[nodiscard]] uint64_t getResidentBytes () const;
 
   private:
-    /** Cached textures */
-    std::map<std::string, std::shared_ptr<const TextureProvider>> m_textureCache = {};
+    /** time update () can spend uploading per call, big textures are spread over several frames */
+    static constexpr std::chrono::microseconds UPLOAD_BUDGET {2000};
+
+    struct Streaming {
+        std::shared_ptr<CTexture> texture;
+        Threading::JobPool::Group decode;
+        /** set by the decode job if the texture couldn't be decoded, it stays as a placeholder */
+        bool failed = false;
+    };
+
+    /** textures in the order they were requested, the first ones are usually the ones the scene needs first */
+    std::vector<std::unique_ptr<Streaming>> m_streaming = {};
+    uint64_t m_releasedBytes = 0;
+    /** TextureCompressionCache entries being written */
+    Threading::JobPool::Group m_stores = {};
+
+    struct Entry {
+        std::shared_ptr<const TextureProvider> texture;
+        /** set for the textures loaded from the containers, the only ones that can be evicted */
+        std::shared_ptr<const CTexture> loaded;
+        /** update () call the texture was last held by something besides the cache */
+        uint64_t lastUsed = 0;
+    };
+
+    /**
+     * Reads the texture from the project's container and starts streaming it in
+     */
+    std::shared_ptr<CTexture> load (const std::string& filename, const Data::Model::Project& project);
+    void evict ();
+
+    using Key = std::pair<const Data::Model::Project*, std::string>;
+
+    struct KeyHash {
+        size_t operator() (const Key& key) const {
+            return std::hash<const void*> {} (key.first) ^ (std::hash<std::string> {} (key.second) << 1);
+        }
+    };
+
+    /** Cached textures per project */
+    std::unordered_map<Key, Entry, KeyHash> m_textureCache = {};
+    /** video memory the loaded textures may take before unused ones are evicted */
+    uint64_t m_budget;
+    uint64_t m_updates = 0;
 };
 } // namespace WallpaperEngine::Render
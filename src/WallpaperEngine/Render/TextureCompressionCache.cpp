@@ -0,0 +1,185 @@
+#include "TextureCompressionCache.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/Utils/CacheDirectory.h"
+
+using namespace WallpaperEngine::Render;
+
+namespace {
+/** anything bigger can only come from a corrupt entry */
+constexpr uint32_t MAX_LEVEL_SIZE = 256 * 1024 * 1024;
+constexpr uint32_t MAX_COUNT = 4096;
+
+template <typename T> void writeValue (std::ostream& out, const T& value) {
+    out.write (reinterpret_cast<const char*> (&value), sizeof (value));
+}
+
+template <typename T> T readValue (std::istream& in) {
+    T value {};
+
+    in.read (reinterpret_cast<char*> (&value), sizeof (value));
+
+    return value;
+}
+
+void hashBytes (uint64_t& hash, const char* data, const size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<uint8_t> (data [i]);
+        hash *= 0x100000001b3ULL;
+    }
+}
+} // namespace
+
+bool TextureCompressionCache::isEligible (const Texture& header) {
+    if (header.freeImageFormat == FIF_UNKNOWN && header.format != TextureFormat_ARGB8888)
+        return false;
+
+    const auto first = header.images.find (0);
+
+    if (first == header.images.end () || first->second.empty ())
+        return false;
+
+    const auto& mipmap = *first->second.front ();
+
+    // whole blocks only, partial ones are not supported everywhere
+    return mipmap.width % 4 == 0 && mipmap.height % 4 == 0 && mipmap.width * mipmap.height >= MIN_PIXELS;
+}
+
+std::filesystem::path TextureCompressionCache::getPath (const Texture& header) {
+    const std::filesystem::path cache = Utils::getCacheDirectory ();
+
+    if (cache.empty ())
+        return {};
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (const auto& [index, mipmaps] : header.images) {
+        for (const auto& mipmap : mipmaps) {
+            // the stored bytes, whichever form they're still in
+            if (mipmap->compressedData != nullptr)
+                hashBytes (hash, mipmap->compressedData.get (), mipmap->compressedSize);
+            else if (mipmap->uncompressedData != nullptr)
+                hashBytes (hash, mipmap->uncompressedData.get (), mipmap->uncompressedSize);
+
+            hashBytes (hash, reinterpret_cast<const char*> (&mipmap->width), sizeof (mipmap->width));
+            hashBytes (hash, reinterpret_cast<const char*> (&mipmap->height), sizeof (mipmap->height));
+        }
+    }
+
+    std::ostringstream name;
+
+    name << std::hex << std::setw (16) << std::setfill ('0') << hash << ".bin";
+
+    return cache / "textures" / name.str ();
+}
+
+bool TextureCompressionCache::load (const std::filesystem::path& path, Entry& entry) {
+    std::ifstream in (path, std::ios::binary);
+
+    if (!in)
+        return false;
+
+    if (readValue<uint32_t> (in) != MAGIC || readValue<uint32_t> (in) != VERSION)
+        return false;
+
+    entry.format = readValue<GLenum> (in);
+
+    // entries from a driver with other formats are of no use here
+    if (entry.format != getFormat ())
+        return false;
+
+    const auto images = readValue<uint32_t> (in);
+
+    if (!in || images > MAX_COUNT)
+        return false;
+
+    entry.images.resize (images);
+
+    for (auto& levels : entry.images) {
+        const auto count = readValue<uint32_t> (in);
+
+        if (!in || count > MAX_COUNT)
+            return false;
+
+        levels.resize (count);
+
+        for (auto& level : levels) {
+            level.width = readValue<int32_t> (in);
+            level.height = readValue<int32_t> (in);
+
+            const auto size = readValue<uint32_t> (in);
+
+            if (!in || size > MAX_LEVEL_SIZE)
+                return false;
+
+            level.data.resize (size);
+            in.read (level.data.data (), size);
+        }
+    }
+
+    return static_cast<bool> (in);
+}
+
+void TextureCompressionCache::store (const std::filesystem::path& path, const Entry& entry) {
+    std::error_code ec;
+
+    std::filesystem::create_directories (path.parent_path (), ec);
+
+    if (ec) {
+        sLog.error ("Cannot create texture cache directory ", path.parent_path (), ": ", ec.message ());
+        return;
+    }
+
+    // other instances might be reading the same entry, never let them see a partial one
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream out (temporary, std::ios::binary | std::ios::trunc);
+
+        writeValue<uint32_t> (out, MAGIC);
+        writeValue<uint32_t> (out, VERSION);
+        writeValue<GLenum> (out, entry.format);
+        writeValue<uint32_t> (out, static_cast<uint32_t> (entry.images.size ()));
+
+        for (const auto& levels : entry.images) {
+            writeValue<uint32_t> (out, static_cast<uint32_t> (levels.size ()));
+
+            for (const auto& level : levels) {
+                writeValue<int32_t> (out, level.width);
+                writeValue<int32_t> (out, level.height);
+                writeValue<uint32_t> (out, static_cast<uint32_t> (level.data.size ()));
+                out.write (level.data.data (), static_cast<std::streamsize> (level.data.size ()));
+            }
+        }
+
+        if (!out) {
+            sLog.error ("Cannot write texture cache entry ", temporary);
+            out.close ();
+            std::filesystem::remove (temporary, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename (temporary, path, ec);
+
+    if (ec)
+        sLog.error ("Cannot store texture cache entry ", path, ": ", ec.message ());
+}
+
+GLenum TextureCompressionCache::getFormat () {
+    static const GLenum format = [] () -> GLenum {
+        if (GLEW_ARB_texture_compression_bptc)
+            return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+        if (GLEW_EXT_texture_compression_s3tc)
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+        return GL_NONE;
+    } ();
+
+    return format;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "WallpaperEngine/Data/Assets/Texture.h"
+
+namespace WallpaperEngine::Render {
+using namespace WallpaperEngine::Data::Assets;
+
+/**
+ * On-disk cache of RGBA8 textures compressed by the driver
+ *
+ * Uncompressed textures (raw RGBA8 and every PNG/JPEG one) take 4 bytes per pixel of video memory. With the cache
+ * enabled the first launch hands their pixels to the driver with a compressed internal format (BC7 when
+ * GL_ARB_texture_compression_bptc is there, DXT5 otherwise), reads back the blocks it produced and stores them,
+ * later launches upload those blocks directly. Entries are keyed on a hash of the texture's stored mipmaps, so
+ * the same file in different backgrounds shares one entry
+ */
+class TextureCompressionCache {
+  public:
+    struct Level {
+        int32_t width = 0;
+        int32_t height = 0;
+        std::vector<char> data = {};
+    };
+
+    struct Entry {
+        /** compressed internal format the blocks are in */
+        GLenum format = GL_NONE;
+        /** levels of every image in the texture */
+        std::vector<std::vector<Level>> images = {};
+    };
+
+    /**
+     * @param header
+     *
+     * @return If the texture is uncompressed and big enough to be worth compressing
+     */
+    static bool isEligible (const Texture& header);
+
+    /**
+     * @param header The texture as parsed, before its mipmaps are released
+     *
+     * @return Where the entry for the texture is stored, empty if there's no cache directory
+     */
+    static std::filesystem::path getPath (const Texture& header);
+
+    /**
+     * @param path
+     * @param entry Filled in with the cached entry
+     *
+     * @return If there was an entry in the format getFormat () returns
+     */
+    static bool load (const std::filesystem::path& path, Entry& entry);
+
+    /**
+     * Writes the entry, replacing any previous one
+     *
+     * @param path
+     * @param entry
+     */
+    static void store (const std::filesystem::path& path, const Entry& entry);
+
+    /**
+     * @return The format textures are compressed to, GL_NONE if the driver has none, GLEW has to be initialized
+     */
+    static GLenum getFormat ();
+
+  private:
+    static constexpr uint32_t MAGIC = 0x5443574c; // "LWCT"
+    static constexpr uint32_t VERSION = 1;
+    /** smaller textures don't save enough to be worth the readback */
+    static constexpr uint32_t MIN_PIXELS = 256 * 256;
+};
+} // namespace WallpaperEngine::Render
@@ -4,6 +4,7 @@
 #include <memory>
 
 #include <GL/glew.h>
+#include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
 
 #include "WallpaperEngine/Data/Assets/Texture.h"
@@ -78,5 +79,34 @@ class TextureProvider {
      * @return Duration of spritesheet animation in seconds
      */
     [[nodiscard]] virtual float getSpritesheetDuration () const = 0;
+    /**
+     * @return If the texture holds its real contents, textures still streaming in render as a placeholder
+     */
+    [[nodiscard]] virtual bool isReady () const {
+        return true;
+    }
+    /**
+     * @param time Seconds into the animation, already wrapped to its length
+     * @return The frame of an animated texture to show at that time, nullptr if there's none
+     */
+    [[nodiscard]] virtual const Frame* getFrameAt (double time) const {
+        return nullptr;
+    }
+    /**
+     * Textures that pack several images in the same GL texture keep each one in a band of it
+     *
+     * @param imageIndex
+     * @return Scale and offset that take a vertical texture coordinate of the image to the GL texture
+     */
+    [[nodiscard]] virtual glm::vec2 getImageMapping (uint32_t imageIndex) const {
+        return {1.0f, 0.0f};
+    }
+    /**
+     * @param flags SamplerCache::Flags wanted on top of the texture's own ones
+     * @return The sampler to bind along the texture, GL_NONE if it's sampled with its own parameters
+     */
+    [[nodiscard]] virtual GLuint getSampler (uint32_t flags = 0) const {
+        return GL_NONE;
+    }
 };
 } // namespace WallpaperEngine::Render
\ No newline at end of file
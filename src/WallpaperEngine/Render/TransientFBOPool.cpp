@@ -0,0 +1,63 @@
+#include "TransientFBOPool.h"
+
+#include <algorithm>
+
+using namespace WallpaperEngine::Render;
+
+std::shared_ptr<const CFBO> TransientFBOPool::borrow (const std::shared_ptr<const CFBO>& fbo) {
+    const uint64_t size = getSize (*fbo);
+    auto& available = this->m_free [getKey (*fbo)];
+
+    this->m_liveBytes += size;
+    this->m_peakBytes = std::max (this->m_peakBytes, this->m_liveBytes);
+
+    if (available.empty ()) {
+        // nothing to reuse, the framebuffer's own storage joins the pool
+        this->m_allocatedBytes += size;
+        return fbo;
+    }
+
+    auto storage = std::move (available.back ());
+    available.pop_back ();
+
+    // every FBO is created mutable by the FBOProvider, the pool only gets to see them through the passes
+    std::const_pointer_cast<CFBO> (fbo)->shareStorage (storage);
+
+    this->m_reusedCount++;
+    this->m_reusedBytes += size;
+
+    return storage;
+}
+
+void TransientFBOPool::giveBack (const std::shared_ptr<const CFBO>& storage) {
+    this->m_liveBytes -= getSize (*storage);
+    this->m_free [getKey (*storage)].push_back (storage);
+}
+
+uint64_t TransientFBOPool::getAllocatedBytes () const {
+    return this->m_allocatedBytes;
+}
+
+uint64_t TransientFBOPool::getPeakBytes () const {
+    return this->m_peakBytes;
+}
+
+uint32_t TransientFBOPool::getReusedCount () const {
+    return this->m_reusedCount;
+}
+
+uint64_t TransientFBOPool::getReusedBytes () const {
+    return this->m_reusedBytes;
+}
+
+uint64_t TransientFBOPool::getSize (const CFBO& fbo) {
+    return static_cast<uint64_t> (fbo.getTextureWidth (0)) * fbo.getTextureHeight (0) *
+           CFBO::getPixelSize (fbo.getFormat ());
+}
+
+TransientFBOPool::Key TransientFBOPool::getKey (const CFBO& fbo) {
+    return {
+        fbo.getTextureWidth (0), fbo.getTextureHeight (0), fbo.getRealWidth (), fbo.getRealHeight (),
+        fbo.getFormat (), fbo.getFlags ()
+    };
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "CFBO.h"
+
+namespace WallpaperEngine::Render {
+/**
+ * Hands out render target storage to framebuffers that only need their contents for part of a frame
+ *
+ * Storage is keyed by size, format and flags: borrowing takes a free texture of the same shape
+ * if there's one, and giving it back makes it available to the next framebuffer that starts
+ * being used later in the frame. The pool keeps track of how much storage is live at once
+ * so the peak can be reported
+ */
+class TransientFBOPool {
+  public:
+    /**
+     * Makes the framebuffer render into pooled storage until it's given back
+     *
+     * @param fbo
+     *
+     * @return The framebuffer that owns the storage, fbo itself if there was nothing free to reuse
+     */
+    std::shared_ptr<const CFBO> borrow (const std::shared_ptr<const CFBO>& fbo);
+
+    /**
+     * Returns storage obtained from borrow () so other framebuffers can use it
+     *
+     * @param storage
+     */
+    void giveBack (const std::shared_ptr<const CFBO>& storage);
+
+    /** @return Bytes of every texture owned by the pool */
+    [[nodiscard]] uint64_t getAllocatedBytes () const;
+    /** @return Highest amount of bytes borrowed at the same time */
+    [[nodiscard]] uint64_t getPeakBytes () const;
+    /** @return Framebuffers that reused storage instead of keeping their own */
+    [[nodiscard]] uint32_t getReusedCount () const;
+    /** @return Bytes that would have been allocated without the pool */
+    [[nodiscard]] uint64_t getReusedBytes () const;
+
+    static uint64_t getSize (const CFBO& fbo);
+
+  private:
+    using Key = std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, TextureFormat, uint32_t>;
+
+    static Key getKey (const CFBO& fbo);
+
+    std::map<Key, std::vector<std::shared_ptr<const CFBO>>> m_free = {};
+    uint64_t m_allocatedBytes = 0;
+    uint64_t m_liveBytes = 0;
+    uint64_t m_peakBytes = 0;
+    uint32_t m_reusedCount = 0;
+    uint64_t m_reusedBytes = 0;
+};
+} // namespace WallpaperEngine::Render
@@ -0,0 +1,17 @@
+#include "CacheDirectory.h"
+
+#include <cstdlib>
+
+std::filesystem::path WallpaperEngine::Render::Utils::getCacheDirectory () {
+    std::filesystem::path cache;
+
+    if (const char* xdgCacheHome = getenv ("XDG_CACHE_HOME"); xdgCacheHome != nullptr && *xdgCacheHome != '\0') {
+        cache = xdgCacheHome;
+    } else if (const char* home = getenv ("HOME"); home != nullptr && *home != '\0') {
+        cache = std::filesystem::path (home) / ".cache";
+    } else {
+        return {};
+    }
+
+    return cache / "linux-wallpaperengine";
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <filesystem>
+
+namespace WallpaperEngine::Render::Utils {
+/**
+ * @return The directory the application keeps its caches in ($XDG_CACHE_HOME or ~/.cache), empty if neither is set
+ */
+std::filesystem::path getCacheDirectory ();
+} // namespace WallpaperEngine::Render::Utils
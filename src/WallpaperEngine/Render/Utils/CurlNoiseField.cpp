@@ -0,0 +1,101 @@
+#include "CurlNoiseField.h"
+#include "NoiseUtils.h"
+
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Threading/JobPool.h"
+
+#include <chrono>
+#include <cmath>
+
+using namespace WallpaperEngine::Render::Utils;
+
+std::unique_ptr<CurlNoiseField> CurlNoiseField::sInstance = nullptr;
+
+CurlNoiseField::CurlNoiseField () : m_samples (SIZE * SIZE * SIZE) {
+    const auto start = std::chrono::steady_clock::now ();
+    std::vector<glm::vec3> potential (SIZE * SIZE * SIZE);
+
+    // same three offset channels as perlinNoiseVec3 ()
+    sJobPool.parallelFor (SIZE, 1, [&potential] (const uint32_t begin, const uint32_t end) {
+        constexpr float step = 1.0f / RESOLUTION;
+
+        for (int z = static_cast<int> (begin); z < static_cast<int> (end); z++) {
+            for (int y = 0; y < SIZE; y++) {
+                for (int x = 0; x < SIZE; x++) {
+                    const float px = x * step;
+                    const float py = y * step;
+                    const float pz = z * step;
+
+                    potential [index (x, y, z)] = glm::vec3 (
+                        perlinNoisef (px, py, pz, PERIOD),
+                        perlinNoisef (px + 89.2f, py + 33.1f, pz + 57.3f, PERIOD),
+                        perlinNoisef (px + 100.3f, py + 120.1f, pz + 142.2f, PERIOD)
+                    );
+                }
+            }
+        }
+    });
+
+    // central differences between neighbouring cells, the grid wraps so the borders need no special case
+    sJobPool.parallelFor (SIZE, 1, [this, &potential] (const uint32_t begin, const uint32_t end) {
+        constexpr float scale = RESOLUTION / 2.0f;
+
+        for (int z = static_cast<int> (begin); z < static_cast<int> (end); z++) {
+            for (int y = 0; y < SIZE; y++) {
+                for (int x = 0; x < SIZE; x++) {
+                    const glm::vec3& x0 = potential [index (x - 1, y, z)];
+                    const glm::vec3& x1 = potential [index (x + 1, y, z)];
+                    const glm::vec3& y0 = potential [index (x, y - 1, z)];
+                    const glm::vec3& y1 = potential [index (x, y + 1, z)];
+                    const glm::vec3& z0 = potential [index (x, y, z - 1)];
+                    const glm::vec3& z1 = potential [index (x, y, z + 1)];
+
+                    this->m_samples [index (x, y, z)] = glm::vec3 (
+                        (y1.z - y0.z) - (z1.y - z0.y),
+                        (z1.x - z0.x) - (x1.z - x0.z),
+                        (x1.y - x0.y) - (y1.x - y0.x)
+                    ) * scale;
+                }
+            }
+        }
+    });
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (
+        std::chrono::steady_clock::now () - start);
+
+    sLog.debug ("Baked curl noise field in ", elapsed.count (), "ms");
+}
+
+glm::vec3 CurlNoiseField::sample (const glm::vec3& position) const {
+    const float gx = position.x * RESOLUTION;
+    const float gy = position.y * RESOLUTION;
+    const float gz = position.z * RESOLUTION;
+    const float fx = std::floor (gx);
+    const float fy = std::floor (gy);
+    const float fz = std::floor (gz);
+    const int x = static_cast<int> (fx);
+    const int y = static_cast<int> (fy);
+    const int z = static_cast<int> (fz);
+    const float tx = gx - fx;
+    const float ty = gy - fy;
+    const float tz = gz - fz;
+
+    const auto lerp = [] (const glm::vec3& a, const glm::vec3& b, const float t) {
+        return a + (b - a) * t;
+    };
+
+    const glm::vec3 c00 = lerp (this->m_samples [index (x, y, z)], this->m_samples [index (x + 1, y, z)], tx);
+    const glm::vec3 c10 = lerp (this->m_samples [index (x, y + 1, z)], this->m_samples [index (x + 1, y + 1, z)], tx);
+    const glm::vec3 c01 = lerp (this->m_samples [index (x, y, z + 1)], this->m_samples [index (x + 1, y, z + 1)], tx);
+    const glm::vec3 c11 =
+        lerp (this->m_samples [index (x, y + 1, z + 1)], this->m_samples [index (x + 1, y + 1, z + 1)], tx);
+
+    return lerp (lerp (c00, c10, ty), lerp (c01, c11, ty), tz);
+}
+
+const CurlNoiseField& CurlNoiseField::get () {
+    if (sInstance == nullptr)
+        sInstance = std::make_unique<CurlNoiseField> ();
+
+    return *sInstance;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <memory>
+#include <vector>
+
+namespace WallpaperEngine::Render::Utils {
+/**
+ * Curl noise baked once into a tiling grid
+ *
+ * The potential is perlin noise repeating every PERIOD units, so the grid covers the whole noise space and any
+ * position (scrolled over time or not) maps into it. Sampling is a trilinear blend of the eight closest cells
+ * instead of the eighteen noise evaluations curlNoise () needs
+ */
+class CurlNoiseField {
+  public:
+    /** Noise units covered by the grid before it repeats */
+    static constexpr int PERIOD = 8;
+    /** Grid cells per noise unit */
+    static constexpr int RESOLUTION = 8;
+    /** Cells on every side of the grid */
+    static constexpr int SIZE = PERIOD * RESOLUTION;
+
+    CurlNoiseField ();
+
+    /**
+     * @param position Position in noise space
+     *
+     * @return The curl of the noise at that position
+     */
+    [[nodiscard]] glm::vec3 sample (const glm::vec3& position) const;
+
+    /**
+     * Bakes the field the first time it's called, do that from a single thread before sampling from many
+     */
+    static const CurlNoiseField& get ();
+
+  private:
+    static constexpr int index (const int x, const int y, const int z) {
+        return ((z & (SIZE - 1)) * SIZE + (y & (SIZE - 1))) * SIZE + (x & (SIZE - 1));
+    }
+
+    std::vector<glm::vec3> m_samples;
+
+    static std::unique_ptr<CurlNoiseField> sInstance;
+};
+} // namespace WallpaperEngine::Render::Utils
@@ -116,6 +116,62 @@ inline glm::vec3 perlinNoiseVec3(const glm::vec3& p) {
     );
 }
 
+// Single precision gradient, same results as perlinGrad without the branches
+inline float perlinGradf(int hash, float x, float y, float z) {
+    const int h = hash & 0xF;
+    const float u = h < 8 ? x : y;
+    const float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+inline float perlinEasef(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+// Single precision perlin noise repeating every period units (power of two up to 256)
+inline float perlinNoisef(float x, float y, float z, int period = 256) {
+    const int mask = period - 1;
+    const float fx = std::floor(x);
+    const float fy = std::floor(y);
+    const float fz = std::floor(z);
+
+    const int X0 = static_cast<int>(fx) & mask;
+    const int Y0 = static_cast<int>(fy) & mask;
+    const int Z0 = static_cast<int>(fz) & mask;
+    const int X1 = (X0 + 1) & mask;
+    const int Y1 = (Y0 + 1) & mask;
+    const int Z1 = (Z0 + 1) & mask;
+
+    x -= fx;
+    y -= fy;
+    z -= fz;
+
+    const float u = perlinEasef(x);
+    const float v = perlinEasef(y);
+    const float w = perlinEasef(z);
+
+    // every lattice corner is wrapped on its own so the noise tiles, matches perlinNoise for period 256
+    const auto hash = [](int cx, int cy, int cz) {
+        return PERLIN_PERM[PERLIN_PERM[PERLIN_PERM[cx] + cy] + cz];
+    };
+    const auto lerp = [](float t, float a, float b) {
+        return a + t * (b - a);
+    };
+
+    return lerp(w,
+        lerp(v,
+            lerp(u, perlinGradf(hash(X0, Y0, Z0), x, y, z),
+                    perlinGradf(hash(X1, Y0, Z0), x - 1, y, z)),
+            lerp(u, perlinGradf(hash(X0, Y1, Z0), x, y - 1, z),
+                    perlinGradf(hash(X1, Y1, Z0), x - 1, y - 1, z))),
+        lerp(v,
+            lerp(u, perlinGradf(hash(X0, Y0, Z1), x, y, z - 1),
+                    perlinGradf(hash(X1, Y0, Z1), x - 1, y, z - 1)),
+            lerp(u, perlinGradf(hash(X0, Y1, Z1), x, y - 1, z - 1),
+                    perlinGradf(hash(X1, Y1, Z1), x - 1, y - 1, z - 1))));
+}
+
 // Curl noise - smooth, swirling patterns ideal for fluid-like particle motion
 inline glm::vec3 curlNoise(const glm::vec3& p) {
     const float e = 1e-4f;
@@ -0,0 +1,350 @@
+#include "VideoSource.h"
+
+#include <algorithm>
+#include <ranges>
+#include <vector>
+
+#include <glm/common.hpp>
+
+#include "WallpaperEngine/Debugging/LoadReport.h"
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/RenderContext.h"
+
+using namespace WallpaperEngine::Render;
+
+namespace {
+void* getProcAddress (void* ctx, const char* name) {
+    return static_cast<VideoSource*> (ctx)->getContext ().getDriver ().getProcAddress (name);
+}
+} // namespace
+
+VideoSource::VideoSource (RenderContext& context, std::filesystem::path path) :
+    ContextAware (context),
+    m_path (std::move (path)) {
+    const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_Video);
+    const auto& settings = this->getContext ().getApp ().getContext ().settings;
+    double volume = settings.audio.volume * 100.0 / 128.0;
+
+    // create mpv contexts
+    this->m_mpv = mpv_create ();
+
+    if (this->m_mpv == nullptr)
+        sLog.exception ("Could not create mpv context");
+
+    mpv_set_option_string (this->m_mpv, "terminal", "yes");
+    mpv_set_option_string (this->m_mpv, "msg-level", "all=v");
+    mpv_set_option_string (this->m_mpv, "input-cursor", "no");
+    mpv_set_option_string (this->m_mpv, "cursor-autohide", "no");
+    mpv_set_option_string (this->m_mpv, "config", "no");
+    mpv_set_option_string (this->m_mpv, "fbo-format", "rgba8");
+    mpv_set_option_string (this->m_mpv, "vo", "libmpv");
+    // stays around without a file, see releaseIfIdle ()
+    mpv_set_option_string (this->m_mpv, "idle", "yes");
+
+    if (mpv_initialize (this->m_mpv) < 0)
+        sLog.exception ("Could not initialize mpv context");
+
+    mpv_set_option_string (this->m_mpv, "hwdec", settings.render.hwdec.c_str ());
+    mpv_set_option_string (this->m_mpv, "loop", "inf");
+    mpv_set_option (this->m_mpv, "volume", MPV_FORMAT_DOUBLE, &volume);
+
+    if (!settings.audio.enabled) {
+        mpv_set_option_string (this->m_mpv, "mute", "yes");
+    }
+
+    // initialize gl context for mpv
+    mpv_opengl_init_params gl_init_params {getProcAddress, this};
+    std::vector<mpv_render_param> params = {
+        {MPV_RENDER_PARAM_API_TYPE, const_cast<char*> (MPV_RENDER_API_TYPE_OPENGL)},
+        {MPV_RENDER_PARAM_OPENGL_INIT_PARAMS, &gl_init_params},
+    };
+
+    // without the native display mpv can't set up VAAPI's interop and falls back to copying frames back from the GPU
+    if (void* display = this->getContext ().getDriver ().getWaylandDisplay (); display != nullptr)
+        params.push_back ({MPV_RENDER_PARAM_WL_DISPLAY, display});
+    else if (void* display = this->getContext ().getDriver ().getX11Display (); display != nullptr)
+        params.push_back ({MPV_RENDER_PARAM_X11_DISPLAY, display});
+
+    params.push_back ({MPV_RENDER_PARAM_INVALID, nullptr});
+
+    if (mpv_render_context_create (&this->m_mpvGl, this->m_mpv, params.data ()) < 0)
+        sLog.exception ("Failed to initialize MPV's GL context");
+
+    mpv_render_context_set_update_callback (this->m_mpvGl, &VideoSource::onUpdate, this);
+
+    this->load ();
+
+    if (!settings.audio.enabled) {
+        const char* mutecommand [] = {"set", "mute", "yes", nullptr};
+
+        mpv_command (this->m_mpv, mutecommand);
+    }
+
+    glGenTextures (1, &this->m_texture);
+    glGenFramebuffers (1, &this->m_framebuffer);
+    glBindTexture (GL_TEXTURE_2D, this->m_texture);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, this->m_size.x, this->m_size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindFramebuffer (GL_FRAMEBUFFER, this->m_framebuffer);
+    glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->m_texture, 0);
+    glBindFramebuffer (GL_FRAMEBUFFER, GL_NONE);
+}
+
+VideoSource::~VideoSource () {
+    // freeing the render context stops the update callbacks, the GL context is still current here
+    if (this->m_mpvGl != nullptr)
+        mpv_render_context_free (this->m_mpvGl);
+    if (this->m_mpv != nullptr)
+        mpv_terminate_destroy (this->m_mpv);
+
+    glDeleteFramebuffers (1, &this->m_framebuffer);
+    glDeleteTextures (1, &this->m_texture);
+}
+
+void VideoSource::load () {
+    // the start option applies to the next file loaded, the position is kept across the unload
+    if (this->m_unloaded) {
+        mpv_set_property_string (this->m_mpv, "start", std::to_string (this->m_resumePosition).c_str ());
+        this->m_restoring = true;
+    }
+
+    // build the path to the video file
+    const char* command [] = {"loadfile", this->m_path.c_str (), nullptr};
+
+    if (mpv_command (this->m_mpv, command) < 0)
+        sLog.exception ("Cannot load video to play");
+
+    this->m_unloaded = false;
+}
+
+void VideoSource::releaseIfIdle () {
+    const int delay = this->getContext ().getApp ().getContext ().settings.render.videoUnloadDelay;
+
+    if (!this->m_paused || this->m_unloaded || delay <= 0 ||
+        std::chrono::steady_clock::now () - this->m_pausedAt < std::chrono::seconds (delay))
+        return;
+
+    if (mpv_get_property (this->m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &this->m_resumePosition) < 0)
+        this->m_resumePosition = 0.0;
+
+    // stopping uninitializes the decoder, taking its (hardware) surfaces with it, the render context stays
+    const char* command [] = {"stop", nullptr};
+
+    mpv_command (this->m_mpv, command);
+    this->m_unloaded = true;
+
+    sLog.out ("Video ", this->m_path.filename (), " unloaded while paused, it resumes at ", this->m_resumePosition,
+              "s");
+}
+
+void VideoSource::setConsumer (const void* consumer, const glm::ivec2 size) {
+    auto& entry = this->m_consumers [consumer];
+
+    if (entry.size == size)
+        return;
+
+    entry.size = size;
+    this->updateSize ();
+}
+
+void VideoSource::removeConsumer (const void* consumer) {
+    this->m_consumers.erase (consumer);
+    this->updateSize ();
+}
+
+void VideoSource::setPause (const void* consumer, const bool paused) {
+    this->m_consumers [consumer].paused = paused;
+
+    // a video shown somewhere else keeps playing
+    const bool newState = std::ranges::all_of (
+        this->m_consumers, [] (const auto& entry) { return entry.second.paused; });
+
+    if (this->m_paused == newState)
+        return;
+
+    this->m_paused = newState;
+    this->m_pausedAt = std::chrono::steady_clock::now ();
+
+    int pause = newState;
+
+    mpv_set_property (this->m_mpv, "pause", MPV_FORMAT_FLAG, &pause);
+
+    // the last frame stays in the texture until the file is open again
+    if (!newState && this->m_unloaded)
+        this->load ();
+}
+
+void VideoSource::updateSize () {
+    if (this->m_videoSize.x <= 0 || this->m_videoSize.y <= 0)
+        return;
+
+    glm::ivec2 size = this->m_videoSize;
+
+    // nothing is gained rendering more pixels than the biggest consumer shows, the video keeps its aspect ratio
+    if (!this->getContext ().getApp ().getContext ().settings.render.nativeVideoSize) {
+        double scale = 0.0;
+
+        for (const auto& consumer : this->m_consumers | std::views::values)
+            scale = std::max ({scale, static_cast<double> (consumer.size.x) / this->m_videoSize.x,
+                               static_cast<double> (consumer.size.y) / this->m_videoSize.y});
+
+        if (scale > 0.0 && scale < 1.0)
+            size = glm::max (glm::ivec2 (glm::dvec2 (this->m_videoSize) * scale + 0.5), glm::ivec2 (1));
+    }
+
+    if (size == this->m_size)
+        return;
+
+    this->m_size = size;
+    this->m_resized = true;
+
+    // reconfigure the texture
+    glBindTexture (GL_TEXTURE_2D, this->m_texture);
+    glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, this->m_size.x, this->m_size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    this->updateFilter ();
+}
+
+void VideoSource::updateFilter () {
+    if (!this->getContext ().getApp ().getContext ().settings.render.downscaleVideo || this->m_decoder.empty ())
+        return;
+
+    std::string filter;
+
+    // scaling right after the decoder keeps the frames' memory and everything mpv does with them at the output size
+    if (this->m_size != this->m_videoSize) {
+        const std::string size = std::to_string (this->m_size.x) + ":" + std::to_string (this->m_size.y);
+        const bool copied = this->m_decoder.ends_with ("-copy");
+
+        // hardware frames have to be scaled where they are, a CPU filter would copy them back
+        if (this->m_decoder == "no" || copied)
+            filter = "scale=" + size;
+        else if (this->m_decoder.starts_with ("vaapi"))
+            filter = "scale_vaapi=" + size;
+        else if (this->m_decoder.starts_with ("nvdec") || this->m_decoder.starts_with ("cuda"))
+            filter = "scale_cuda=" + size;
+    }
+
+    if (filter == this->m_filter)
+        return;
+
+    this->m_filter = filter;
+
+    // the filter chain is rebuilt right away, a failing filter just leaves the frames at full size
+    if (mpv_set_property_string (this->m_mpv, "vf", filter.c_str ()) < 0)
+        sLog.error ("Cannot downscale video ", this->m_path.filename (), " with ", filter);
+}
+
+void VideoSource::logDecoder () {
+    char* current = mpv_get_property_string (this->m_mpv, "hwdec-current");
+    const std::string decoder = current != nullptr ? current : "no";
+
+    mpv_free (current);
+
+    if (decoder == this->m_decoder)
+        return;
+
+    this->m_decoder = decoder;
+
+    const std::string& requested = this->getContext ().getApp ().getContext ().settings.render.hwdec;
+
+    if (decoder == "no" || decoder.empty ()) {
+        // mpv's own log (msg-level) says why each hardware decoder was skipped
+        if (requested != "no")
+            sLog.out ("Video ", this->m_path.filename (), " is decoded in software, hwdec ", requested,
+                      " found no usable hardware decoder");
+    } else if (decoder.ends_with ("-copy")) {
+        sLog.out ("Video ", this->m_path.filename (), " is decoded with ", decoder,
+                  ", frames are copied back to the CPU. Try --hwdec with vaapi or nvdec for zero-copy decoding");
+    } else {
+        sLog.out ("Video ", this->m_path.filename (), " is decoded with ", decoder);
+    }
+}
+
+void VideoSource::onUpdate (void* data) {
+    const auto source = static_cast<VideoSource*> (data);
+
+    // no mpv calls are allowed in here, the render thread asks mpv what changed on its next frame
+    source->m_updatePending = true;
+    source->getContext ().getDriver ().wakeUp ();
+}
+
+void VideoSource::update () {
+    // every consumer calls this, the first one of the frame does the work
+    if (this->m_lastUpdate == this->getContext ().getFrame ())
+        return;
+
+    this->m_lastUpdate = this->getContext ().getFrame ();
+
+    // read any and all the events available
+    while (this->m_mpv) {
+        const mpv_event* event = mpv_wait_event (this->m_mpv, 0);
+
+        if (event == nullptr || event->event_id == MPV_EVENT_NONE)
+            break;
+
+        // we do not care about any of the events
+        if (event->event_id == MPV_EVENT_VIDEO_RECONFIG) {
+            int64_t width, height;
+
+            // the decoder's size, dwidth would be the one after the scale filter
+            if (mpv_get_property (this->m_mpv, "video-dec-params/dw", MPV_FORMAT_INT64, &width) >= 0 &&
+                mpv_get_property (this->m_mpv, "video-dec-params/dh", MPV_FORMAT_INT64, &height) >= 0 &&
+                width > 0 && height > 0) {
+                this->m_videoSize = {width, height};
+                this->updateSize ();
+            }
+
+            this->logDecoder ();
+            this->updateFilter ();
+        } else if (event->event_id == MPV_EVENT_FILE_LOADED && this->m_restoring) {
+            // looping seeks back to the start, but a reload after this would start at the old position again
+            mpv_set_property_string (this->m_mpv, "start", "none");
+            this->m_restoring = false;
+        }
+    }
+
+    // mpv only has a new frame for the video's own frame rate, the texture keeps the last one until then
+    if (!this->m_updatePending.exchange (false) && !this->m_resized)
+        return;
+
+    const uint64_t flags = mpv_render_context_update (this->m_mpvGl);
+
+    if (!(flags & MPV_RENDER_UPDATE_FRAME) && !this->m_resized)
+        return;
+
+    this->m_resized = false;
+
+    mpv_opengl_fbo fbo {static_cast<int> (this->m_framebuffer), this->m_size.x, this->m_size.y, GL_RGBA8};
+
+    // no need to flip as it'll be handled by the wallpaper rendering code
+    int flip_y = 0;
+    // mpv would otherwise sleep until the frame's display time, holding up every other screen's wallpaper with it
+    int block = 0;
+
+    mpv_render_param params [] = {
+        {MPV_RENDER_PARAM_OPENGL_FBO, &fbo},
+        {MPV_RENDER_PARAM_FLIP_Y, &flip_y},
+        {MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block},
+        {MPV_RENDER_PARAM_INVALID, nullptr},
+    };
+
+    mpv_render_context_render (this->m_mpvGl, params);
+
+    // mpv leaves its own program, textures and blending behind
+    this->getContext ().getRenderState ().invalidate ();
+    this->m_frameVersion++;
+}
+
+glm::ivec2 VideoSource::getSize () const {
+    return this->m_size;
+}
+
+GLuint VideoSource::getFramebuffer () const {
+    return this->m_framebuffer;
+}
+
+uint64_t VideoSource::getFrameVersion () const {
+    return this->m_frameVersion;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+
+#include <GL/glew.h>
+#include <glm/vec2.hpp>
+#include <mpv/client.h>
+#include <mpv/render_gl.h>
+
+#include "WallpaperEngine/Render/Helpers/ContextAware.h"
+
+namespace WallpaperEngine::Render {
+/**
+ * One mpv decoder for a video file, shared by everything showing the same file
+ *
+ * Frames are rendered into a texture of the source's own, every consumer copies the frames it hasn't seen yet out
+ * of it. The texture is as big as the video, or with --video-size screen as big as the biggest consumer needs
+ */
+class VideoSource : public Helpers::ContextAware {
+  public:
+    /**
+     * @param context
+     * @param path Physical path of the video, as mpv opens it
+     */
+    VideoSource (RenderContext& context, std::filesystem::path path);
+    ~VideoSource () override;
+
+    VideoSource (const VideoSource&) = delete;
+    VideoSource& operator= (const VideoSource&) = delete;
+
+    /**
+     * Registers or updates a consumer, the decode size follows the biggest one
+     *
+     * @param consumer Anything that identifies the consumer
+     * @param size Size the consumer shows the video at
+     */
+    void setConsumer (const void* consumer, glm::ivec2 size);
+    /**
+     * @param consumer
+     */
+    void removeConsumer (const void* consumer);
+    /**
+     * The video only pauses once every consumer is paused
+     *
+     * @param consumer
+     * @param paused
+     */
+    void setPause (const void* consumer, bool paused);
+    /**
+     * Renders the next frame if mpv has one, only does anything on the first call of every RenderContext frame
+     */
+    void update ();
+    /**
+     * Unloads the video once it has been paused for --video-unload-after, which frees the decoder and its hardware
+     * surfaces. Resuming loads it again at the same position
+     */
+    void releaseIfIdle ();
+
+    /** @return Size of the frames in the texture */
+    [[nodiscard]] glm::ivec2 getSize () const;
+    /** @return Framebuffer with the latest frame attached */
+    [[nodiscard]] GLuint getFramebuffer () const;
+    /** @return Increases every time the texture gets a new frame */
+    [[nodiscard]] uint64_t getFrameVersion () const;
+
+  private:
+    struct Consumer {
+        glm::ivec2 size = {0, 0};
+        bool paused = false;
+    };
+
+    /** Called by mpv from its own threads when it has something new to render */
+    static void onUpdate (void* data);
+    /** Logs the decoder mpv picked whenever it changes, so copying back hardware decoders show up */
+    void logDecoder ();
+    /** Works out the texture size from the video's and the consumers' and resizes it if needed */
+    void updateSize ();
+    /** Sets up the video filter that scales decoded frames down to the texture's size, with --video-downscale */
+    void updateFilter ();
+    /** Opens the file in mpv, at m_resumePosition if it was unloaded before */
+    void load ();
+
+    std::filesystem::path m_path;
+    mpv_handle* m_mpv = nullptr;
+    mpv_render_context* m_mpvGl = nullptr;
+
+    GLuint m_texture = GL_NONE;
+    GLuint m_framebuffer = GL_NONE;
+
+    std::map<const void*, Consumer> m_consumers = {};
+    /** Size of the decoded video, 0 until mpv knows */
+    glm::ivec2 m_videoSize = {0, 0};
+    /** Size of the texture */
+    glm::ivec2 m_size = {16, 16};
+    bool m_paused = false;
+    /** When the video was paused, for releaseIfIdle () */
+    std::chrono::steady_clock::time_point m_pausedAt = {};
+    /** The file was unloaded by releaseIfIdle () */
+    bool m_unloaded = false;
+    /** The file was loaded again at m_resumePosition, the start option has to go once it's open */
+    bool m_restoring = false;
+    /** Playback position in seconds when the file was unloaded */
+    double m_resumePosition = 0.0;
+
+    /** Set by mpv when mpv_render_context_update () might report a new frame */
+    std::atomic<bool> m_updatePending = true;
+    /** The texture was resized, it has nothing until mpv renders again */
+    bool m_resized = true;
+    /** RenderContext frame the last update () ran on */
+    uint64_t m_lastUpdate = 0;
+    uint64_t m_frameVersion = 0;
+    /** Last decoder logged by logDecoder () */
+    std::string m_decoder;
+    /** Video filter currently set by updateFilter () */
+    std::string m_filter;
+};
+} // namespace WallpaperEngine::Render
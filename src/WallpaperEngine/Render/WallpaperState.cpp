@@ -166,6 +166,27 @@ int WallpaperState::getProjectionHeight () const {
     return this->m_projection.height;
 }
 
+bool WallpaperState::coversViewport () const {
+    const auto inside = [] (const float start, const float end) {
+        return std::min (start, end) >= 0.0f && std::max (start, end) <= 1.0f;
+    };
+
+    // UVs outside of the texture show the clamping mode's border
+    return inside (this->m_UVs.ustart, this->m_UVs.uend) && inside (this->m_UVs.vstart, this->m_UVs.vend);
+}
+
+glm::mat4 WallpaperState::getOutputTransform () const {
+    glm::mat4 result (1.0f);
+
+    // the viewport's top-left corner shows (ustart, vstart) and its bottom-right corner (uend, vend)
+    result [0][0] = 1.0f / (this->m_UVs.uend - this->m_UVs.ustart);
+    result [1][1] = 1.0f / (this->m_UVs.vstart - this->m_UVs.vend);
+    result [3][0] = (1.0f - 2.0f * this->m_UVs.ustart) * result [0][0] - 1.0f;
+    result [3][1] = (1.0f - 2.0f * this->m_UVs.vend) * result [1][1] - 1.0f;
+
+    return result;
+}
+
 void WallpaperState::updateState (const glm::ivec4& viewport, const bool& vflip, const int& projectionWidth,
                                    const int& projectionHeight) {
     this->m_viewport.width = viewport.z;
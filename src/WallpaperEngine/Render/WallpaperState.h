@@ -2,12 +2,25 @@
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
 
 #include "TextureProvider.h"
 
 namespace WallpaperEngine::Render {
 using namespace WallpaperEngine::Data::Assets;
+/**
+ * Where a scene draws its last layer when it skips copying its framebuffer to the output
+ */
+struct DirectOutput {
+    GLuint framebuffer;
+    glm::ivec4 viewport;
+    /** takes the scene's clip space to the output's, the same thing the copy's texture coordinates do */
+    glm::mat4 transform;
+
+    bool operator== (const DirectOutput&) const = default;
+};
+
 /**
  * Represents current wallpaper state
  */
@@ -68,6 +81,16 @@ class WallpaperState {
      */
     template <WallpaperState::TextureUVsScaling> void updateTextureUVs ();
 
+    /**
+     * @return If the texture fills the whole viewport, nothing outside of it would be shown
+     */
+    [[nodiscard]] bool coversViewport () const;
+
+    /**
+     * @return The transform from the scene's clip space to the viewport's that matches the texture UVs
+     */
+    [[nodiscard]] glm::mat4 getOutputTransform () const;
+
     // Updates state with provided values
     void updateState (const glm::ivec4& viewport, const bool& vflip, const int& projectionWidth,
                       const int& projectionHeight);
@@ -1,14 +1,25 @@
+#include "WallpaperEngine/Audio/Drivers/Recorders/PlaybackRecorder.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
 #include "WallpaperEngine/Render/Objects/CImage.h"
 #include "WallpaperEngine/Render/Objects/CSound.h"
 #include "WallpaperEngine/Render/Objects/CParticle.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticleSnapshot.h"
 
+#include "WallpaperEngine/Render/RenderGraph.h"
 #include "WallpaperEngine/Render/WallpaperState.h"
 
 #include "CScene.h"
 #include "WallpaperEngine/Logging/Log.h"
 
 #include "WallpaperEngine/Data/Model/Wallpaper.h"
-#include "WallpaperEngine/Data/Parsers/ObjectParser.h"
+
+#include "WallpaperEngine/Threading/JobPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <ranges>
+#include <set>
 
 extern float g_Time;
 extern float g_TimeLast;
@@ -16,9 +27,7 @@ extern float g_TimeLast;
 using namespace WallpaperEngine;
 using namespace WallpaperEngine::Render;
 using namespace WallpaperEngine::Data::Model;
-using namespace WallpaperEngine::Data::Parsers;
 using namespace WallpaperEngine::Render::Wallpapers;
-using JSON = WallpaperEngine::Data::JSON::JSON;
 
 CScene::CScene (
     const Wallpaper& wallpaper, RenderContext& context, AudioContext& audioContext,
@@ -42,9 +51,25 @@ CScene::CScene (
 
     this->m_parallaxDisplacement = {0, 0};
 
+    const auto& general = this->getContext ().getApp ().getContext ().settings.general;
+    // lowered by the power profile, the scene is built again when it changes
+    const auto& power = this->getContext ().getApp ().getContext ().state.power;
+    uint32_t particleBudget = general.particleBudget;
+
+    if (power.particleBudget > 0)
+        particleBudget = particleBudget == 0 ? power.particleBudget : std::min (particleBudget, power.particleBudget);
+
+    this->m_particleBudget = Objects::Particles::ParticleBudget (particleBudget, general.particleTimeBudget);
+
     // TODO: CONVERSION
     this->m_camera->setOrthogonalProjection (width, height);
 
+    float renderScale = this->chooseRenderScale ();
+
+    if (power.renderScale != 1.0f)
+        renderScale = std::max (0.25f, renderScale * power.renderScale);
+
+    this->setRenderScale (renderScale);
     // setup framebuffers here as they're required for the scene setup
     this->setupFramebuffers ();
 
@@ -61,15 +86,122 @@ CScene::CScene (
 
     glClearColor (clearColor.r, clearColor.g, clearColor.b, 1.0f);
 
-    // create all objects based off their dependencies
-    for (const auto& object : scene->objects)
-        this->createObject (*object);
+    this->prefetchAssets ();
+
+    // index the objects by id once so dependencies are resolved without walking the whole list every time
+    this->m_objectPositions.reserve (scene->objects.size ());
+    this->m_objectsCreated.assign (scene->objects.size (), false);
+    this->m_objectsOrdered.assign (scene->objects.size (), false);
+
+    for (size_t position = 0; position < scene->objects.size (); position++)
+        this->m_objectPositions.emplace (scene->objects [position]->id, position);
+
+    // the rest is built by loadStep (), right away or a slice every frame
+}
+
+bool CScene::loadStep (const std::chrono::steady_clock::time_point deadline) {
+    // every step is finished once started, so at least one runs whatever the deadline
+    do {
+        switch (this->m_loadStage) {
+            case LoadStage_Objects: this->loadObjects (); break;
+            case LoadStage_Shaders: this->loadShaders (); break;
+            case LoadStage_Framebuffers: this->loadFramebuffers (); break;
+            case LoadStage_Programs: this->loadPrograms (); break;
+            case LoadStage_Prewarm:
+                // the render thread has better things to do than waiting on the workers, unless there's no deadline
+                if (!this->m_prewarm.isDone () && deadline != std::chrono::steady_clock::time_point::max ())
+                    return false;
+
+                this->loadFinish ();
+                break;
+            case LoadStage_Done: break;
+        }
+    } while (this->m_loadStage != LoadStage_Done && std::chrono::steady_clock::now () < deadline);
+
+    return this->m_loadStage == LoadStage_Done;
+}
+
+void CScene::loadObjects () {
+    const auto scene = this->getWallpaperData ().as <Scene> ();
+
+    // create all objects based off their dependencies, one at a time
+    if (this->m_loadPosition < scene->objects.size ()) {
+        this->createObject (*scene->objects [this->m_loadPosition++]);
+        return;
+    }
 
     // copy over objects by render order
     for (const auto& object : scene->objects) {
         this->addObjectToRenderOrder (*object);
     }
 
+    // only needed while building the scene
+    this->m_objectPositions = {};
+    this->m_objectsCreated = {};
+    this->m_objectsOrdered = {};
+
+    // objects are created one by one as they depend on each other, but most of the CPU time goes into preprocessing
+    // the shaders of their passes, which doesn't need GL, so that runs on every core and only the hand-off is serial
+    for (const auto& object : this->m_objects | std::views::values)
+        if (object->is<Objects::CImage> ())
+            this->m_loadImages.emplace_back (object->as<Objects::CImage> ());
+
+    sJobPool.parallelFor (static_cast<uint32_t> (this->m_loadImages.size ()), 1, [this] (const uint32_t begin, const uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+            this->m_loadImages [i]->prepareShaders ();
+    });
+
+    this->m_loadPosition = 0;
+    this->m_loadStage = LoadStage_Shaders;
+}
+
+void CScene::loadShaders () {
+    if (this->m_loadPosition < this->m_loadImages.size ()) {
+        this->m_loadImages [this->m_loadPosition++]->setupShaders ();
+        return;
+    }
+
+    const auto scene = this->getWallpaperData ().as <Scene> ();
+    const auto& general = this->getContext ().getApp ().getContext ().settings.general;
+
+    // pre-warm the particle systems on the worker threads while the rest of the scene loads
+    if (general.particlePrewarm > 0) {
+        for (const auto& particle : this->m_particlesByRenderOrder)
+            if (particle->canPrewarm ())
+                this->m_prewarming.emplace_back (particle);
+
+        if (general.particleCache && !this->m_prewarming.empty ()) {
+            const auto& workshopId = scene->project.workshopId;
+            // backgrounds that are not from the workshop have a negative id
+            const std::string key = !workshopId.empty () && workshopId [0] != '-'
+                ? workshopId
+                : std::to_string (std::hash<std::string> {} (scene->project.title));
+
+            this->m_prewarmSnapshot = Objects::Particles::ParticleSnapshot::getPath (key);
+        }
+
+        if (!this->m_prewarmSnapshot.empty () &&
+            Objects::Particles::ParticleSnapshot::restore (
+                this->m_prewarmSnapshot, general.particlePrewarm, this->m_prewarming)) {
+            sLog.out ("Restored pre-warmed particles from ", this->m_prewarmSnapshot);
+            this->m_prewarming.clear ();
+        } else {
+            const auto seconds = static_cast<float> (general.particlePrewarm);
+
+            for (const auto& particle : this->m_prewarming)
+                sJobPool.submit (this->m_prewarm, [particle, seconds] () { particle->prewarm (seconds); });
+        }
+    }
+
+    this->m_loadStage = LoadStage_Framebuffers;
+}
+
+void CScene::loadFramebuffers () {
+    const auto scene = this->getWallpaperData ().as <Scene> ();
+    const auto& power = this->getContext ().getApp ().getContext ().state.power;
+    const uint32_t sceneWidth = this->m_camera->getWidth ();
+    const uint32_t sceneHeight = this->m_camera->getHeight ();
+
     // create extra framebuffers for the bloom effect
     this->_rt_4FrameBuffer =
         this->create ("_rt_4FrameBuffer", TextureFormat_ARGB8888, TextureFlags_ClampUVs, 1.0,
@@ -80,98 +212,191 @@ CScene::CScene (
     this->_rt_Bloom = this->create ("_rt_Bloom", TextureFormat_ARGB8888, TextureFlags_ClampUVs,
                                        1.0, {sceneWidth / 8, sceneHeight / 8}, {sceneWidth / 8, sceneHeight / 8});
 
-    //
-    // Had to get a little creative with the effects to achieve the same bloom effect without any custom code
-    // this custom image loads some effect files from the virtual container to achieve the same bloom effect
-    // this approach requires of two extra draw calls due to the way the effect works in official WPE
-    // (it renders directly to the screen, whereas here we never do that from a scene)
-    //
-
-    const auto bloomOrigin = glm::vec3 { sceneWidth / 2, sceneHeight / 2, 0.0f };
-    const auto bloomSize = glm::vec2 { sceneWidth, sceneHeight };
-
-    const JSON bloom = {
-        {"image", "models/wpenginelinux.json"},
-        {"name", "bloomimagewpenginelinux"},
-        {"visible", true},
-        {"scale", "1.0 1.0 1.0"},
-        {"angles", "0.0 0.0 0.0"},
-        {"origin", std::to_string (bloomOrigin.x) + " " + std::to_string (bloomOrigin.y) + " " + std::to_string(bloomOrigin.z)},
-        {"size", std::to_string (bloomSize.x) + " " + std::to_string (bloomSize.y)},
-        {"id", -1},
-        {"effects",
-            JSON::array (
-                {
-                    {
-                        {"file", "effects/wpenginelinux/bloomeffect.json"},
-                        {"id", 15242000},
-                        {"name", ""},
-                        {"passes",
-                             JSON::array (
-                                 {
-                                     {
-                                         {"constantshadervalues",
-                                             {
-                                                 {"bloomstrength", this->getScene ().camera.bloom.strength->value->getFloat ()},
-                                                 {"bloomthreshold", this->getScene ().camera.bloom.threshold->value->getFloat ()}
-                                             }
-                                         }
-                                     },
-                                     {
-                                         {"constantshadervalues",
-                                            {
-                                                {"bloomstrength", this->getScene ().camera.bloom.strength->value->getFloat ()},
-                                                {"bloomthreshold", this->getScene ().camera.bloom.threshold->value->getFloat ()}
-                                            }
-                                        }
-                                     },
-                                     {
-                                         {"constantshadervalues",
-                                             {
-                                                 {"bloomstrength", this->getScene ().camera.bloom.strength->value->getFloat ()},
-                                                 {"bloomthreshold", this->getScene ().camera.bloom.threshold->value->getFloat ()}
-                                             }
-                                         }
-                                     }
-                                 }
-                             )
-                        }
-                    }
-                }
-            )
+    if (scene->camera.bloom.enabled->value->getBool ()) {
+        this->m_bloom = std::make_unique<BloomPass> (*this, sceneWidth, sceneHeight, power.bloomLevels);
+        this->m_bloomEntry = this->getContext ().getProfiler ().registerEntry ("bloom");
+
+        if (!this->m_bloom->setup ()) {
+            sLog.error ("Cannot setup bloom, the scene renders without it");
+            this->m_bloom = nullptr;
         }
+    }
+
+    this->m_loadPosition = 0;
+    this->m_loadStage = LoadStage_Programs;
+}
+
+void CScene::loadPrograms () {
+    if (this->m_loadPosition >= this->m_loadImages.size ()) {
+        this->m_loadStage = LoadStage_Prewarm;
+        return;
+    }
+
+    // the shaders of every pass were translated in the background while the rest of the scene was set up
+    const auto image = this->m_loadImages [this->m_loadPosition++];
+
+    try {
+        image->setupPrograms ();
+    } catch (std::runtime_error&) {
+        // this error message is already printed, so just show extra info about it
+        sLog.error ("Cannot setup image ", image->getImage ().name);
+    }
+}
+
+void CScene::loadFinish () {
+    const auto& general = this->getContext ().getApp ().getContext ().settings.general;
+
+    // with every image set up the passes of the whole scene can be optimized together
+    const auto stats = RenderGraph (*this).compile ();
+
+    this->m_sharedFramebufferBytes = stats.savedBytes;
+
+    if (stats.removedPasses > 0 || stats.sharedFBOs > 0) {
+        sLog.out (
+            "Render graph removed ", stats.removedPasses, " unused passes, ", stats.sharedFBOs,
+            " framebuffers share storage (", stats.savedBytes / (1024 * 1024), "MB saved)");
+    }
+
+    sLog.debug (stats.cachedImages, " static layers keep their effects between frames");
+    sLog.debug (stats.cullableImages, " layers skip their effects while out of view");
+    sLog.debug (
+        "Render targets use ", stats.residentBytes / (1024 * 1024), "MB, ", stats.transientBytes / (1024 * 1024),
+        "MB of it transient with a peak of ", stats.peakTransientBytes / (1024 * 1024), "MB live within a frame");
+
+    const auto batches = this->m_spriteBatcher.build (this->m_objectsByRenderOrder);
+
+    sLog.debug (batches.batchedImages, " layers drawn in ", batches.batches, " batches");
+
+    // a scene without these only renders again when one of the layers' inputs changes
+    this->m_alwaysChanging = !this->m_particlesByRenderOrder.empty () || stats.feedbackFBOs > 0;
+
+    // the spectrum is only captured and analyzed while a pass that survived the render graph reads it
+    this->m_usesAudio = std::ranges::any_of (this->m_objects | std::views::values, [] (const CObject* object) {
+        return object->is<Objects::CImage> () &&
+               std::ranges::any_of (object->as<Objects::CImage> ()->getPasses (), [] (const Objects::Effects::CPass* pass) {
+                   return pass->getDependencies () & Objects::Effects::CPass::Dependency_Audio;
+               });
+    });
+
+    if (this->m_usesAudio)
+        this->getAudioContext ().getRecorder ().setConsumer (this, false);
+
+    if (!this->m_prewarming.empty ()) {
+        sJobPool.wait (this->m_prewarm);
+
+        if (!this->m_prewarmSnapshot.empty ())
+            Objects::Particles::ParticleSnapshot::store (
+                this->m_prewarmSnapshot, general.particlePrewarm, this->m_prewarming);
+    }
+
+    this->m_loadImages = {};
+    this->m_prewarming = {};
+    this->m_loadStage = LoadStage_Done;
+}
+
+CScene::~CScene () {
+    // a scene dropped while it was still built can't go away under the particles being pre-warmed
+    sJobPool.wait (this->m_prewarm);
+
+    if (this->m_usesAudio)
+        this->getAudioContext ().getRecorder ().removeConsumer (this);
+}
+
+void CScene::setPause (const bool newState) {
+    if (this->m_usesAudio)
+        this->getAudioContext ().getRecorder ().setConsumer (this, newState);
+}
+
+void CScene::prefetchAssets () const {
+    std::set<std::string> textures = {};
+    std::set<std::string> shaders = {};
+
+    const auto addTextures = [&textures] (const TextureMap& map) {
+        for (const auto& name : map | std::views::values)
+            // render targets and aliases are not files
+            if (!name.empty () && !name.starts_with ("_rt_") && !name.starts_with ("_alias_"))
+                textures.emplace (name);
     };
+    const auto addMaterial = [&shaders, &addTextures] (const Material* material) {
+        if (material == nullptr)
+            return;
 
-    // create image for bloom passes
-    if (scene->camera.bloom.enabled->value->getBool ()) {
-        this->m_bloomObjectData = ObjectParser::parse (bloom, scene->project);
-        this->m_bloomObject = this->createObject (*this->m_bloomObjectData);
+        for (const auto& pass : material->passes) {
+            if (!pass->shader.empty ())
+                shaders.emplace (pass->shader);
 
-        this->m_objectsByRenderOrder.push_back (this->m_bloomObject);
+            addTextures (pass->textures);
+        }
+    };
+
+    for (const auto& object : this->getScene ().objects) {
+        if (object->is<Image> ()) {
+            const auto image = object->as<Image> ();
+
+            if (image->model != nullptr)
+                addMaterial (image->model->material.get ());
+
+            for (const auto& effect : image->effects) {
+                for (const auto& pass : effect->effect->passes) {
+                    if (pass->material.has_value ())
+                        addMaterial (pass->material->get ());
+
+                    addTextures (pass->binds);
+                }
+
+                for (const auto& override : effect->passOverrides)
+                    addTextures (override->textures);
+            }
+        } else if (object->is<Particle> ()) {
+            const auto particle = object->as<Particle> ();
+
+            if (particle->material != nullptr)
+                addMaterial (particle->material->material.get ());
+        }
     }
+
+    const auto& assets = *this->getScene ().project.assetLocator;
+    const std::vector<std::string> textureList (textures.begin (), textures.end ());
+    const std::vector<std::string> shaderList (shaders.begin (), shaders.end ());
+
+    // the hints themselves don't block, but finding the files can on slow mounts
+    sJobPool.parallelFor (static_cast<uint32_t> (textureList.size ()), 8, [&] (const uint32_t begin, const uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+            assets.prefetchTexture (textureList [i]);
+    });
+    sJobPool.parallelFor (static_cast<uint32_t> (shaderList.size ()), 8, [&] (const uint32_t begin, const uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+            assets.prefetchShader (shaderList [i]);
+    });
+
+    sLog.debug ("Prefetching ", textureList.size (), " textures and ", shaderList.size (), " shaders");
 }
 
 Render::CObject* CScene::createObject (const Object& object) {
     Render::CObject* renderObject = nullptr;
 
-    // ensure the item is not loaded already
+    // ensure the item is not loaded already, objects that were skipped are only looked at once too
     if (const auto current = this->m_objects.find (object.id); current != this->m_objects.end ())
         return current->second;
 
+    if (const auto position = this->m_objectPositions.find (object.id); position != this->m_objectPositions.end ()) {
+        if (this->m_objectsCreated [position->second])
+            return nullptr;
+
+        // marked before the dependencies so cycles between objects end here
+        this->m_objectsCreated [position->second] = true;
+    }
+
+    const auto& objects = this->getScene ().objects;
+
     // check dependencies too!
     for (const auto& cur : object.dependencies) {
         // self-dependency is a possibility...
         if (cur == object.id)
             continue;
 
-        const auto dep = std::ranges::find_if (this->getScene ().objects,
-            [&cur] (const auto& o) {
-                return o->id == cur;
-            }
-        );
-
-        if (dep != this->getScene ().objects.end ())
-            this->createObject (**dep);
+        if (const auto dep = this->m_objectPositions.find (cur); dep != this->m_objectPositions.end ())
+            this->createObject (*objects [dep->second]);
     }
 
     if (object.is<Image> ()) {
@@ -217,6 +442,18 @@ void CScene::addObjectToRenderOrder (const Object& object) {
     if (obj == this->m_objects.end ())
         return;
 
+    const auto position = this->m_objectPositions.find (object.id);
+
+    // ensure we're added only once to the render list, marked before the dependencies so cycles end here
+    if (position != this->m_objectPositions.end ()) {
+        if (this->m_objectsOrdered [position->second])
+            return;
+
+        this->m_objectsOrdered [position->second] = true;
+    }
+
+    const auto& objects = this->getScene ().objects;
+
     // take into account any dependency first
     for (const auto& dep : object.dependencies) {
         // self-dependency is possible
@@ -225,36 +462,26 @@ void CScene::addObjectToRenderOrder (const Object& object) {
         }
 
         // add the dependency to the list if it's created
-        auto depIt = std::ranges::find_if (this->getScene ().objects,
-            [&dep] (const auto& o) {
-                return o->id == dep;
-            }
-        );
-
-        if (depIt != this->getScene ().objects.end ()) {
-            this->addObjectToRenderOrder (**depIt);
+        if (const auto depIt = this->m_objectPositions.find (dep); depIt != this->m_objectPositions.end ()) {
+            this->addObjectToRenderOrder (*objects [depIt->second]);
         } else {
             sLog.error ("Cannot find dependency ", dep, " for object ", object.id);
         }
     }
 
-    // ensure we're added only once to the render list
-    const auto renderIt = std::ranges::find_if (this->m_objectsByRenderOrder,
-        [&object] (const auto& o) {
-            return o->getId () == object.id;
-        }
-    );
+    this->m_objectsByRenderOrder.emplace_back (obj->second);
 
-    if (renderIt == this->m_objectsByRenderOrder.end ()) {
-        this->m_objectsByRenderOrder.emplace_back (obj->second);
-    }
+    if (obj->second->is<Objects::CParticle> ())
+        this->m_particlesByRenderOrder.emplace_back (obj->second->as<Objects::CParticle> ());
 }
 
 Camera& CScene::getCamera () const {
     return *this->m_camera;
 }
 
-void CScene::renderFrame (const glm::ivec4& viewport) {
+bool CScene::renderFrame (const glm::ivec4& viewport) {
+    TRACE_SCOPE ("CScene::renderFrame");
+
     // ensure the virtual mouse position is up to date
     this->updateMouse (viewport);
 
@@ -269,15 +496,157 @@ void CScene::renderFrame (const glm::ivec4& viewport) {
             glm::mix (this->m_parallaxDisplacement, (this->m_mousePosition * amount) * influence, delay);
     }
 
+    const DirectOutput* output = this->getDirectOutput ();
+    Objects::CImage* outputImage =
+        output == nullptr ? nullptr : this->m_objectsByRenderOrder.back ()->as<Objects::CImage> ();
+
+    // moving the last layer between the scene and the output leaves neither with the whole frame
+    if (outputImage != this->m_outputImage || (output != nullptr && *output != this->m_appliedOutput)) {
+        if (this->m_outputImage != nullptr)
+            this->m_outputImage->setDirectOutput (nullptr);
+        if (outputImage != nullptr)
+            outputImage->setDirectOutput (output);
+
+        this->m_outputImage = outputImage;
+        this->m_appliedOutput = output == nullptr ? DirectOutput {} : *output;
+        this->m_frameValid = false;
+    }
+
+    bool changed = this->m_alwaysChanging || !this->m_frameValid;
+
+    // every image has to look at its inputs, even if the frame is known to change already
+    for (const auto& cur : this->m_objectsByRenderOrder)
+        if (cur->is<Objects::CImage> ())
+            changed = cur->as<Objects::CImage> ()->updateChanges () || changed;
+
+    // same inputs, same result: what's in the framebuffer is still good
+    if (!changed)
+        return false;
+
+    this->m_frameValid = true;
+
+    // the values every pass shares go up once, the passes only set what's specific to them
+    this->m_frameUniforms.update (
+        g_Time, g_Daytime, this->m_mousePosition, this->m_mousePositionLast, this->m_parallaxDisplacement,
+        this->m_camera->getViewProjection (), this->getAudioContext ().getRecorder ());
+    this->m_frameUniforms.use ();
+
     // use the scene's framebuffer by default
     glBindFramebuffer (GL_FRAMEBUFFER, this->getWallpaperFramebuffer ());
     // ensure we render over the whole framebuffer
     glViewport (0, 0, this->m_sceneFBO->getRealWidth (), this->m_sceneFBO->getRealHeight ());
 
-    glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // render targets only have a color attachment, layers are drawn back to front without depth
+    glClear (GL_COLOR_BUFFER_BIT);
 
-    for (const auto& cur : this->m_objectsByRenderOrder)
-        cur->render ();
+    // simulate every particle system at once, only the draw calls have to wait for the render loop
+    if (!this->m_particlesByRenderOrder.empty ()) {
+        FrameStats& frameStats = this->getContext ().getStats ();
+        FrameStats::Scope stats (frameStats, FrameStats::Phase_Particles);
+        Threading::JobPool::Group group;
+        const float budgetScale = this->m_particleBudget.getScale ();
+
+        for (const auto& particle : this->m_particlesByRenderOrder) {
+            particle->setBudgetScale (budgetScale);
+            particle->beginFrame ();
+        }
+
+        const auto start = std::chrono::steady_clock::now ();
+
+        for (const auto& particle : this->m_particlesByRenderOrder)
+            sJobPool.submit (group, [particle] () { particle->prepare (); });
+
+        sJobPool.wait (group);
+
+        if (this->m_particleBudget.isEnabled () || frameStats.isEnabled ()) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds> (
+                std::chrono::steady_clock::now () - start);
+            uint32_t alive = 0;
+
+            for (const auto& particle : this->m_particlesByRenderOrder)
+                alive += particle->getAliveCount ();
+
+            this->m_particleBudget.update (alive, static_cast<uint32_t> (elapsed.count ()));
+            frameStats.addParticles (alive);
+        }
+    }
+
+    this->updateOcclusion ();
+    this->m_spriteBatcher.render ();
+
+    if (this->m_bloom != nullptr) {
+        GPUProfiler::Scope profile (this->getContext ().getProfiler (), this->m_bloomEntry);
+
+        this->m_bloom->render (
+            this->getContext ().getRenderState (), *this->m_sceneFBO,
+            this->getScene ().camera.bloom.strength->value->getFloat (),
+            this->getScene ().camera.bloom.threshold->value->getFloat ());
+        this->getContext ().getStats ().addDraws (this->m_bloom->getDrawCount ());
+    }
+
+    return true;
+}
+
+void CScene::updateOcclusion () {
+    bool hidden = false;
+
+    // walking down from the top, nothing under a layer that overwrites the whole scene can be seen
+    for (const auto& object : this->m_objectsByRenderOrder | std::views::reverse) {
+        if (!object->is<Objects::CImage> ())
+            continue;
+
+        auto* image = object->as<Objects::CImage> ();
+
+        image->setOccluded (hidden);
+        hidden = hidden || image->hidesScene ();
+    }
+}
+
+bool CScene::canRenderToOutput () {
+    // previews are read back from the scene's framebuffer, bloom goes over every layer
+    if (!this->getContext ().getApp ().getContext ().settings.screenshot.previews.empty () ||
+        this->m_bloom != nullptr || this->m_objectsByRenderOrder.empty ())
+        return false;
+
+    // screens mirroring the scene copy it from the framebuffer
+    const auto screens = std::ranges::count_if (
+        this->getContext ().getWallpapers () | std::views::values,
+        [this] (const auto& wallpaper) { return wallpaper.get () == this; });
+
+    if (screens != 1)
+        return false;
+
+    const CObject* last = this->m_objectsByRenderOrder.back ();
+
+    return last->is<Objects::CImage> () && last->as<Objects::CImage> ()->coversScene ();
+}
+
+float CScene::chooseRenderScale () const {
+    const float scale = this->getContext ().getApp ().getContext ().settings.render.renderScale;
+
+    if (scale > 0.0f)
+        return scale;
+
+    float largest = 0.0f;
+
+    // the scene covers each viewport with its scaling mode, so fill has to be enough for the tightest fit
+    for (const auto& viewport : this->getContext ().getOutput ().getViewports () | std::views::values) {
+        largest = std::max ({
+            largest,
+            static_cast<float> (viewport->viewport.z) / static_cast<float> (this->getWidth ()),
+            static_cast<float> (viewport->viewport.w) / static_cast<float> (this->getHeight ())
+        });
+    }
+
+    if (largest == 0.0f)
+        return 1.0f;
+
+    const float result = std::clamp (largest, 0.25f, 1.0f);
+
+    if (result < 1.0f)
+        sLog.out ("Rendering scene at ", result, " of its size to match the screen");
+
+    return result;
 }
 
 void CScene::updateMouse (const glm::ivec4& viewport) {
@@ -315,6 +684,10 @@ int CScene::getHeight () const {
     return this->m_camera->getHeight ();
 }
 
+uint64_t CScene::getFramebufferBytes () const {
+    return CWallpaper::getFramebufferBytes () - this->m_sharedFramebufferBytes;
+}
+
 const glm::vec2* CScene::getMousePosition () const {
     return &this->m_mousePosition;
 }
@@ -330,3 +703,7 @@ const glm::vec2* CScene::getParallaxDisplacement () const {
 const std::vector<CObject*>& CScene::getObjectsByRenderOrder () const {
     return this->m_objectsByRenderOrder;
 }
+
+GeometryArena& CScene::getGeometry () {
+    return this->m_geometry;
+}
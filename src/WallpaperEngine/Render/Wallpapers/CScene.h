@@ -1,14 +1,29 @@
 #pragma once
 
+#include "WallpaperEngine/Render/BloomPass.h"
 #include "WallpaperEngine/Render/Camera.h"
 
 #include "WallpaperEngine/Render/CWallpaper.h"
+#include "WallpaperEngine/Render/FrameUniforms.h"
+#include "WallpaperEngine/Render/GeometryArena.h"
+#include "WallpaperEngine/Render/SpriteBatcher.h"
+#include "WallpaperEngine/Render/Objects/Particles/ParticleBudget.h"
+#include "WallpaperEngine/Threading/JobPool.h"
+
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
 
 namespace WallpaperEngine::Render {
 class Camera;
 class CObject;
 }
 
+namespace WallpaperEngine::Render::Objects {
+class CImage;
+class CParticle;
+}
+
 namespace WallpaperEngine::Render::Wallpapers {
 using namespace WallpaperEngine::Data::Model;
 
@@ -18,6 +33,7 @@ class CScene final : public CWallpaper {
         const Wallpaper& wallpaper, RenderContext& context, AudioContext& audioContext,
         const WallpaperState::TextureUVsScaling& scalingMode,
         const uint32_t& clampMode);
+    ~CScene () override;
 
     [[nodiscard]] Camera& getCamera () const;
 
@@ -25,28 +41,105 @@ class CScene final : public CWallpaper {
 
     [[nodiscard]] int getWidth () const override;
     [[nodiscard]] int getHeight () const override;
+    /**
+     * @return Video memory of the framebuffers, the ones sharing storage through the render graph counted once
+     */
+    [[nodiscard]] uint64_t getFramebufferBytes () const override;
 
     const glm::vec2* getMousePosition () const;
     const glm::vec2* getMousePositionLast () const;
     const glm::vec2* getParallaxDisplacement () const;
 
     [[nodiscard]] const std::vector<CObject*>& getObjectsByRenderOrder () const;
+    [[nodiscard]] GeometryArena& getGeometry ();
+
+    void setPause (bool newState) override;
 
   protected:
-    void renderFrame (const glm::ivec4& viewport) override;
+    bool loadStep (std::chrono::steady_clock::time_point deadline) override;
+    bool renderFrame (const glm::ivec4& viewport) override;
+    [[nodiscard]] bool canRenderToOutput () override;
     void updateMouse (const glm::ivec4& viewport);
 
     friend class CWallpaper;
 
   private:
+    /** What loadStep () builds next, in this order */
+    enum LoadStage {
+        /** one object at a time, then the render order and the shaders preprocessed on every core */
+        LoadStage_Objects = 0,
+        /** one image's shaders at a time, then the particles start pre-warming */
+        LoadStage_Shaders = 1,
+        LoadStage_Framebuffers = 2,
+        /** one image's programs at a time */
+        LoadStage_Programs = 3,
+        /** waits for the particles, then the render graph and batches are built */
+        LoadStage_Prewarm = 4,
+        LoadStage_Done = 5
+    };
+
+    void loadObjects ();
+    void loadShaders ();
+    void loadFramebuffers ();
+    void loadPrograms ();
+    void loadFinish ();
+    /**
+     * Walks the objects of the scene for every texture and shader their materials and effects use and starts
+     * reading them in the background, so creating the objects finds them in the page cache
+     */
+    void prefetchAssets () const;
+    /**
+     * @return The render scale the settings ask for, for auto the one that matches the biggest viewport, never
+     *         rendering over the scene's own size
+     */
+    [[nodiscard]] float chooseRenderScale () const;
+    /**
+     * Finds the topmost image hiding the whole scene and marks the images under it as occluded
+     */
+    void updateOcclusion ();
     Render::CObject* createObject (const Object& object);
     void addObjectToRenderOrder (const Object& object);
 
     std::unique_ptr<Camera> m_camera;
-    ObjectUniquePtr m_bloomObjectData;
-    CObject* m_bloomObject = nullptr;
+    /** camera bloom, nullptr if the scene has it disabled */
+    std::unique_ptr<BloomPass> m_bloom = nullptr;
+    GPUProfiler::Entry m_bloomEntry = 0;
+    /** video memory the render graph saved by having framebuffers share storage */
+    uint64_t m_sharedFramebufferBytes = 0;
     std::map<int, CObject*> m_objects = {};
+    /** position of every object in the scene's list by id, only kept while the objects are created */
+    std::unordered_map<int, size_t> m_objectPositions = {};
+    /** objects createObject and addObjectToRenderOrder already went through, by position in the scene's list */
+    std::vector<bool> m_objectsCreated = {};
+    std::vector<bool> m_objectsOrdered = {};
+    LoadStage m_loadStage = LoadStage_Objects;
+    /** the object or image the current stage goes on with */
+    size_t m_loadPosition = 0;
+    /** the scene's images, only kept while the scene is built */
+    std::vector<Objects::CImage*> m_loadImages = {};
+    /** particle systems pre-warming on the workers and the snapshot they're stored to once done */
+    Threading::JobPool::Group m_prewarm;
+    std::vector<Objects::CParticle*> m_prewarming = {};
+    std::filesystem::path m_prewarmSnapshot = {};
     std::vector<CObject*> m_objectsByRenderOrder = {};
+    /** particle systems in m_objectsByRenderOrder, simulated in parallel before rendering */
+    std::vector<Objects::CParticle*> m_particlesByRenderOrder = {};
+    Objects::Particles::ParticleBudget m_particleBudget;
+    /** static vertex data of every layer's quads */
+    GeometryArena m_geometry;
+    /** per-frame values every pass reads from the same uniform block */
+    FrameUniforms m_frameUniforms;
+    /** m_objectsByRenderOrder split in runs of layers that share their draw setup */
+    SpriteBatcher m_spriteBatcher;
+    /** something in the scene changes every frame no matter the inputs (particles, feedback effects...) */
+    bool m_alwaysChanging = false;
+    /** a pass reads g_AudioSpectrum*, so the recorder has to capture while the scene isn't paused */
+    bool m_usesAudio = false;
+    /** the scene's framebuffer holds a frame rendered with the current inputs */
+    bool m_frameValid = false;
+    /** the last layer when it's drawn to the output instead of the scene, and the output it was given */
+    Objects::CImage* m_outputImage = nullptr;
+    DirectOutput m_appliedOutput = {};
     glm::vec2 m_mousePosition = {};
     glm::vec2 m_mousePositionLast = {};
     glm::vec2 m_parallaxDisplacement = {};
@@ -1,9 +1,10 @@
 #pragma once
 
+#include <memory>
+
 #include "WallpaperEngine/Audio/AudioStream.h"
 #include "WallpaperEngine/Render/CWallpaper.h"
-#include <mpv/client.h>
-#include <mpv/render_gl.h>
+#include "WallpaperEngine/Render/VideoSource.h"
 
 namespace WallpaperEngine::Render::Wallpapers {
 class CVideo final : public CWallpaper {
@@ -12,6 +13,7 @@ class CVideo final : public CWallpaper {
         const Wallpaper& wallpaper, RenderContext& context, AudioContext& audioContext,
         const WallpaperState::TextureUVsScaling& scalingMode,
         const uint32_t& clampMode);
+    ~CVideo () override;
 
     const Video& getVideo () const;
 
@@ -22,13 +24,15 @@ class CVideo final : public CWallpaper {
     void setSize (int width, int height);
 
   protected:
-    void renderFrame (const glm::ivec4& viewport) override;
+    bool renderFrame (const glm::ivec4& viewport) override;
 
     friend class CWallpaper;
 
   private:
-    mpv_handle* m_mpv = nullptr;
-    mpv_render_context* m_mpvGl = nullptr;
+    /** Decoder shared with every other wallpaper playing the same file */
+    std::shared_ptr<VideoSource> m_source = nullptr;
+    /** Frame version of the source last copied into the framebuffer */
+    uint64_t m_copiedVersion = 0;
 
     bool m_paused = false;
     int64_t m_width = 16;
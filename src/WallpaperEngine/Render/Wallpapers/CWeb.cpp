@@ -2,10 +2,14 @@
 // https://github.com/if1live/cef-gl-example
 // https://github.com/andmcgregor/cefgui
 #include "CWeb.h"
+#include "WallpaperEngine/WebBrowser/CEF/RenderProcessHandler.h"
 #include "WallpaperEngine/WebBrowser/CEF/WPSchemeHandlerFactory.h"
 
+#include "WallpaperEngine/Audio/Drivers/Recorders/PlaybackRecorder.h"
 #include "WallpaperEngine/Data/Model/Project.h"
 #include "WallpaperEngine/Data/Model/Wallpaper.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
+#include "WallpaperEngine/Logging/Log.h"
 
 using namespace WallpaperEngine::Render;
 using namespace WallpaperEngine::Render::Wallpapers;
@@ -20,17 +24,30 @@ CWeb::CWeb (
 ) :
     CWallpaper (wallpaper, context, audioContext, scalingMode, clampMode),
     m_browserContext (browserContext) {
+    const Debugging::LoadReport::Scope report (Debugging::LoadReport::Stage_Web);
     // setup framebuffers
     this->setupFramebuffers ();
 
     CefWindowInfo window_info;
     window_info.SetAsWindowless (0);
 
+    // with shared textures Chromium rasterizes on the GPU and hands over dmabufs instead of a CPU buffer
+    if (context.getApp ().getContext ().settings.render.acceleratedWebPaint) {
+        if (RenderHandler::supportsAcceleratedPaint ())
+            window_info.shared_texture_enabled = true;
+        else
+            sLog.error ("Accelerated web paint needs an EGL context that can import dmabufs, painting on the CPU");
+    }
+
     this->m_renderHandler = new WebBrowser::CEF::RenderHandler (this);
 
+    const int maximumFPS = context.getApp ().getContext ().settings.render.maximumFPS;
+    const int refreshRate = context.getDriver ().getRefreshRate ();
+
     CefBrowserSettings browserSettings;
-    // documentaion says that 60 fps is maximum value
-    browserSettings.windowless_frame_rate = std::max (60, context.getApp ().getContext ().settings.render.maximumFPS);
+    // painting faster than the screens refresh would only produce frames nobody gets to see
+    this->m_frameRate = refreshRate > 0 ? std::min (maximumFPS, refreshRate) : maximumFPS;
+    browserSettings.windowless_frame_rate = this->m_frameRate;
 
     this->m_client = new WebBrowser::CEF::BrowserClient (m_renderHandler);
     // use the custom scheme for the wallpaper's files
@@ -38,8 +55,8 @@ CWeb::CWeb (
         WPSchemeHandlerFactory::generateSchemeName(this->getWeb ().project.workshopId) +
         "://root/" +
         this->getWeb().filename;
-    this->m_browser =
-        CefBrowserHost::CreateBrowserSync (window_info, this->m_client, htmlURL, browserSettings, nullptr, nullptr);
+    // CEF runs on its own thread, the browser shows up in the client once it's created there
+    CefBrowserHost::CreateBrowser (window_info, this->m_client, htmlURL, browserSettings, nullptr, nullptr);
 }
 
 void CWeb::setSize (const int width, const int height) {
@@ -55,11 +72,38 @@ void CWeb::setSize (const int width, const int height) {
     glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, this->getWidth (), this->getHeight (), 0, GL_RGBA, GL_UNSIGNED_BYTE,
                   nullptr);
 
-    // Notify cef that it was resized(maybe it's not even needed)
-    this->m_browser->GetHost ()->WasResized ();
+    this->m_renderHandler->setSize (this->m_width, this->m_height);
+
+    // Notify cef that it was resized so it lays the page out again
+    if (const auto browser = this->m_client->getBrowser ())
+        browser->GetHost ()->WasResized ();
+}
+
+void CWeb::setPause (const bool newState) {
+    if (this->m_paused == newState)
+        return;
+
+    this->m_paused = newState;
+
+    const auto browser = this->m_client->getBrowser ();
+
+    if (browser == nullptr)
+        return;
+
+    const auto host = browser->GetHost ();
+
+    // a hidden browser stops painting and requestAnimationFrame, timers get throttled down to almost nothing
+    if (this->getContext ().getApp ().getContext ().settings.render.suspendPausedWeb)
+        host->WasHidden (newState);
+
+    host->SetWindowlessFrameRate (newState ? 1 : this->m_frameRate);
+    host->SetAudioMuted (newState);
+
+    if (this->m_audioListener)
+        this->getAudioContext ().getRecorder ().setConsumer (this, newState);
 }
 
-void CWeb::renderFrame (const glm::ivec4& viewport) {
+bool CWeb::renderFrame (const glm::ivec4& viewport) {
     // ensure the viewport matches the window size, and resize if needed
     if (viewport.z != this->getWidth () || viewport.w != this->getHeight ()) {
         this->setSize (viewport.z, viewport.w);
@@ -67,25 +111,26 @@ void CWeb::renderFrame (const glm::ivec4& viewport) {
 
     // ensure the virtual mouse position is up to date
     this->updateMouse (viewport);
+    this->updateAudio ();
     // use the scene's framebuffer by default
     glBindFramebuffer (GL_FRAMEBUFFER, this->getWallpaperFramebuffer ());
     // ensure we render over the whole framebuffer
     glViewport (0, 0, this->getWidth (), this->getHeight ());
 
-    // Cef processes all messages, including OnPaint, which renders frame
-    // If there is no OnPaint in message loop, we will not update(render) frame
-    //  This means some frames will not have OnPaint call in cef messageLoop
-    //  Because of that glClear will result in flickering on higher fps
-    //  Do not use glClear until some method to control rendering with cef is supported
-    // We might actually try to use cef to execute javascript, and not using off-screen rendering at all
-    // But for now let it be like this
+    // CEF paints on its own thread whenever the page changes, this only uploads what it painted since the last frame
+    //  The texture keeps the last paint, so glClear would result in flickering on frames without one
     //  glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    CefDoMessageLoopWork ();
+    return this->m_renderHandler->upload ();
 }
 
 void CWeb::updateMouse (const glm::ivec4& viewport) {
     // update virtual mouse position first
     auto& input = this->getContext ().getInputContext ().getMouseInput ();
+    const uint64_t generation = input.generation ();
+
+    // the browser already knows where the pointer is, every event is a round trip to the renderer process
+    if (generation == this->m_mouseGeneration && viewport == this->m_mouseViewport)
+        return;
 
     const glm::dvec2 position = input.position ();
     const auto leftClick = input.leftClick();
@@ -96,25 +141,73 @@ void CWeb::updateMouse (const glm::ivec4& viewport) {
     evt.x = std::clamp (static_cast<int> (position.x - viewport.x), 0, viewport.z);
     // Convert from OpenGL coordinates (Y=0 at bottom) to CEF coordinates (Y=0 at top)
     evt.y = viewport.w - std::clamp (static_cast<int> (position.y - viewport.y), 0, viewport.w);
+    const auto browser = this->m_client->getBrowser ();
+
+    // still being created
+    if (browser == nullptr)
+        return;
+
     // Send mouse position to cef
-    this->m_browser->GetHost ()->SendMouseMoveEvent (evt, false);
+    browser->GetHost ()->SendMouseMoveEvent (evt, false);
 
     // TODO: ANY OTHER MOUSE EVENTS TO SEND?
     if (leftClick != this->m_leftClick) {
-        this->m_browser->GetHost ()->SendMouseClickEvent (evt, CefBrowserHost::MouseButtonType::MBT_LEFT, leftClick == WallpaperEngine::Input::MouseClickStatus::Released, 1);
+        browser->GetHost ()->SendMouseClickEvent (evt, CefBrowserHost::MouseButtonType::MBT_LEFT, leftClick == WallpaperEngine::Input::MouseClickStatus::Released, 1);
     }
 
     if (rightClick != this->m_rightClick) {
-        this->m_browser->GetHost ()->SendMouseClickEvent (evt, CefBrowserHost::MouseButtonType::MBT_RIGHT, rightClick == WallpaperEngine::Input::MouseClickStatus::Released, 1);
+        browser->GetHost ()->SendMouseClickEvent (evt, CefBrowserHost::MouseButtonType::MBT_RIGHT, rightClick == WallpaperEngine::Input::MouseClickStatus::Released, 1);
     }
 
     this->m_leftClick = leftClick;
     this->m_rightClick = rightClick;
+    this->m_mouseGeneration = generation;
+    this->m_mouseViewport = viewport;
+}
+
+void CWeb::updateAudio () {
+    auto& recorder = this->getAudioContext ().getRecorder ();
+    const bool listening = this->m_client->hasAudioListener ();
+
+    // the spectrum is only recorded while some page or scene wants it
+    if (listening != this->m_audioListener) {
+        this->m_audioListener = listening;
+
+        if (listening)
+            recorder.setConsumer (this, this->m_paused);
+        else
+            recorder.removeConsumer (this);
+    }
+
+    // at most once per frame and only when the spectrum moved on to a new analysis
+    if (!listening || recorder.getGeneration () == this->m_audioGeneration)
+        return;
+
+    const auto browser = this->m_client->getBrowser ();
+
+    if (browser == nullptr)
+        return;
+
+    this->m_audioGeneration = recorder.getGeneration ();
+
+    float samples [RenderProcessHandler::AUDIO_SAMPLES];
+
+    std::copy_n (recorder.audio64Left, 64, samples);
+    std::copy_n (recorder.audio64Right, 64, samples + 64);
+
+    // the floats go over as they are, nothing is formatted into a script for V8 to parse
+    const CefRefPtr<CefProcessMessage> message =
+        CefProcessMessage::Create (RenderProcessHandler::AUDIO_SAMPLES_MESSAGE);
+
+    message->GetArgumentList ()->SetBinary (0, CefBinaryValue::Create (samples, sizeof (samples)));
+    browser->GetMainFrame ()->SendProcessMessage (PID_RENDERER, message);
 }
 
 CWeb::~CWeb () {
-    CefDoMessageLoopWork ();
-    this->m_browser->GetHost ()->CloseBrowser (true);
+    if (this->m_audioListener)
+        this->getAudioContext ().getRecorder ().removeConsumer (this);
 
-    delete this->m_renderHandler;
+    // the browser might still paint while closing, and the handler outlives this as long as CEF holds on to it
+    this->m_renderHandler->detach ();
+    this->m_client->close ();
 }
@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -36,10 +37,13 @@ class CWeb : public CWallpaper
         [[nodiscard]] int getHeight () const override { return this->m_height; }
 
         void setSize (int width, int height);
+        void setPause (bool newState) override;
 
     protected:
-        void renderFrame (const glm::ivec4& viewport) override;
+        bool renderFrame (const glm::ivec4& viewport) override;
         void updateMouse (const glm::ivec4& viewport);
+        /** Sends the page the spectrum when it has an audio listener and there's a new analysis */
+        void updateAudio ();
         const Web& getWeb () const {
             return *this->getWallpaperData ().as<Web> ();
         }
@@ -48,15 +52,26 @@ class CWeb : public CWallpaper
 
     private:
         WallpaperEngine::WebBrowser::WebBrowserContext& m_browserContext;
-        CefRefPtr<CefBrowser> m_browser = nullptr;
         CefRefPtr<WallpaperEngine::WebBrowser::CEF::BrowserClient> m_client = nullptr;
-        WallpaperEngine::WebBrowser::CEF::RenderHandler* m_renderHandler = nullptr;
+        CefRefPtr<WallpaperEngine::WebBrowser::CEF::RenderHandler> m_renderHandler = nullptr;
+
+        /** Frame rate the browser paints at while not paused */
+        int m_frameRate = 60;
+        bool m_paused = false;
 
         int m_width = 16;
         int m_height = 17;
 
         WallpaperEngine::Input::MouseClickStatus m_leftClick = Input::Released;
         WallpaperEngine::Input::MouseClickStatus m_rightClick = Input::Released;
+        /** pointer events and viewport the browser last heard about, nothing is sent until one of them changes */
+        uint64_t m_mouseGeneration = UINT64_MAX;
+        glm::ivec4 m_mouseViewport = {};
+
+        /** If the page registered an audio listener, the recorder has this as a consumer then */
+        bool m_audioListener = false;
+        /** recorder generation the page last got the spectrum of */
+        uint64_t m_audioGeneration = 0;
 
         glm::vec2 m_mousePosition = {};
         glm::vec2 m_mousePositionLast = {};
@@ -0,0 +1,239 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <lz4.h>
+
+#include "WallpaperEngine/Assets/AssetLocator.h"
+#include "WallpaperEngine/Data/Builders/VectorBuilder.h"
+#include "WallpaperEngine/Data/Assets/Package.h"
+#include "WallpaperEngine/Data/Assets/Texture.h"
+#include "WallpaperEngine/Data/Model/Object.h"
+#include "WallpaperEngine/Data/Model/Project.h"
+#include "WallpaperEngine/Data/Parsers/ObjectParser.h"
+#include "WallpaperEngine/Data/Parsers/PackageParser.h"
+#include "WallpaperEngine/Data/Parsers/TextureParser.h"
+#include "WallpaperEngine/Data/Utils/MemoryStream.h"
+#include "WallpaperEngine/FileSystem/Container.h"
+
+using namespace WallpaperEngine::Assets;
+using namespace WallpaperEngine::Data::Assets;
+using namespace WallpaperEngine::Data::Builders;
+using namespace WallpaperEngine::Data::Model;
+using namespace WallpaperEngine::Data::Parsers;
+using namespace WallpaperEngine::Data::Utils;
+using namespace WallpaperEngine::FileSystem;
+
+namespace {
+void writeUInt32 (std::string& out, const uint32_t value) {
+    out.append (reinterpret_cast<const char*> (&value), sizeof (value));
+}
+
+void writeSizedString (std::string& out, const std::string& value) {
+    writeUInt32 (out, static_cast<uint32_t> (value.size ()));
+    out.append (value);
+}
+
+/** A stream over the fixture that doesn't copy it, so only the parsing itself is measured */
+ReadStreamSharedPtr view (const std::string& fixture) {
+    return std::make_shared<MemoryStream> (fixture.data (), fixture.size (), nullptr);
+}
+
+/**
+ * An ARGB8888 .tex with a full mip chain of LZ4 compressed mips, filled with a noisy gradient so it compresses about
+ * as well as real backgrounds do
+ */
+std::string buildTexture (const uint32_t size) {
+    std::string out;
+
+    out.append ("TEXV0005", 9);
+    out.append ("TEXI0001", 9);
+    writeUInt32 (out, TextureFormat_ARGB8888);
+    writeUInt32 (out, 0);
+    writeUInt32 (out, size);
+    writeUInt32 (out, size);
+    writeUInt32 (out, size);
+    writeUInt32 (out, size);
+    writeUInt32 (out, 0);
+    out.append ("TEXB0002", 9);
+    // image count
+    writeUInt32 (out, 1);
+
+    const auto mips = static_cast<uint32_t> (std::log2 (size)) + 1;
+    uint32_t seed = 1;
+
+    writeUInt32 (out, mips);
+
+    for (uint32_t mip = 0, width = size; mip < mips; mip++, width /= 2) {
+        std::string pixels (static_cast<size_t> (width) * width * 4, '\0');
+
+        for (size_t i = 0; i < pixels.size (); i++) {
+            seed = seed * 1664525 + 1013904223;
+            pixels [i] = static_cast<char> ((i / 4 % width) * 255 / width + (seed >> 29));
+        }
+
+        std::string compressed (LZ4_compressBound (static_cast<int> (pixels.size ())), '\0');
+        const int compressedSize = LZ4_compress_default (
+            pixels.data (), compressed.data (), static_cast<int> (pixels.size ()),
+            static_cast<int> (compressed.size ()));
+
+        writeUInt32 (out, width);
+        writeUInt32 (out, width);
+        // lz4 compression
+        writeUInt32 (out, 1);
+        writeUInt32 (out, static_cast<uint32_t> (pixels.size ()));
+        writeUInt32 (out, static_cast<uint32_t> (compressedSize));
+        out.append (compressed.data (), compressedSize);
+    }
+
+    return out;
+}
+
+/** The header and file list of a .pkg as big as the ones bundled with the bigger backgrounds, contents left out */
+std::string buildPackage (const uint32_t files) {
+    std::string out;
+    uint32_t offset = 0;
+
+    writeSizedString (out, "PKGV0019");
+    writeUInt32 (out, files);
+
+    for (uint32_t i = 0; i < files; i++) {
+        const std::string layer = std::to_string (i);
+
+        writeSizedString (out, "materials/effects/layer" + layer + "/texture_" + layer + ".tex");
+        writeUInt32 (out, offset);
+        writeUInt32 (out, 4096);
+        offset += 4096;
+    }
+
+    return out;
+}
+
+/**
+ * A project whose assets live in the VFS with the models and materials the objects built by buildObjects () use
+ */
+Project buildProject () {
+    auto container = std::make_unique<Container> ();
+    auto& vfs = container->getVFS ();
+
+    for (int i = 0; i < 4; i++) {
+        const std::string name = "layer" + std::to_string (i);
+
+        vfs.add ("models/" + name + ".json", JSON {{"material", "materials/" + name + ".json"}, {"autosize", true}});
+        vfs.add (
+            "materials/" + name + ".json",
+            JSON {{"passes", JSON::array ({JSON {
+                {"blending", "translucent"},
+                {"cullmode", "nocull"},
+                {"depthtest", "disabled"},
+                {"depthwrite", "disabled"},
+                {"shader", "genericimage2"},
+                {"textures", JSON::array ({name})},
+                {"combos", {{"ALPHATOCOVERAGE", 0}}},
+            }})}});
+    }
+
+    return Project {
+        .title = "benchmark",
+        .type = Project::Type_Scene,
+        .assetLocator = std::make_unique<AssetLocator> (std::move (container)),
+    };
+}
+
+/** The objects of a scene, mostly images with a few sounds like the usual layered background */
+JSON buildObjects (const int count) {
+    JSON objects = JSON::array ();
+
+    for (int i = 0; i < count; i++) {
+        JSON object = {
+            {"id", i},
+            {"name", "object" + std::to_string (i)},
+            {"origin", "960.00000 540.00000 0.00000"},
+            {"scale", "1.00000 1.00000 1.00000"},
+            {"angles", "0.00000 0.00000 0.00000"},
+            {"visible", true},
+        };
+
+        if (i % 8 == 7) {
+            object ["sound"] = JSON::array ({"sounds/ambience.mp3"});
+            object ["playbackmode"] = "loop";
+        } else {
+            object ["image"] = "models/layer" + std::to_string (i % 4) + ".json";
+            object ["size"] = "1920.00000 1080.00000";
+            object ["alpha"] = 1.0;
+            object ["color"] = "1.00000 1.00000 1.00000";
+        }
+
+        objects.push_back (std::move (object));
+    }
+
+    return objects;
+}
+} // namespace
+
+TEST_CASE("TextureParser") {
+    const std::string texture = buildTexture (2048);
+
+    BENCHMARK("parse 2048x2048 with LZ4 mips") {
+        return TextureParser::parse (BinaryReader (view (texture)));
+    };
+
+    BENCHMARK("parse 2048x2048 without decompressing") {
+        return TextureParser::parse (BinaryReader (view (texture)), false);
+    };
+}
+
+TEST_CASE("PackageParser") {
+    const std::string package = buildPackage (5000);
+
+    BENCHMARK("parse 5000 entries") {
+        return PackageParser::parse (view (package));
+    };
+}
+
+TEST_CASE("ObjectParser") {
+    const Project project = buildProject ();
+    const JSON objects = buildObjects (64);
+    const std::string scene = objects.dump ();
+
+    BENCHMARK("parse scene JSON with 64 objects") {
+        return JSON::parse (scene);
+    };
+
+    BENCHMARK("parse 64 objects") {
+        std::vector<ObjectUniquePtr> result = {};
+
+        result.reserve (objects.size ());
+
+        for (const auto& object : objects)
+            result.push_back (ObjectParser::parse (object, project));
+
+        return result;
+    };
+}
+
+TEST_CASE("VectorBuilder") {
+    // the strings every object has a few of, written the way the editor does
+    std::vector<std::string> vectors = {};
+
+    for (int i = 0; i < 10000; i++)
+        vectors.push_back (std::to_string (i) + ".00000 " + std::to_string (i % 1080) + ".50000 -0.25000");
+
+    CHECK(VectorBuilder::parse <glm::vec3> (vectors [1081]) == glm::vec3 (1081.0f, 1.5f, -0.25f));
+    CHECK(VectorBuilder::parse <glm::ivec4> ("255 128 0 +1") == glm::ivec4 (255, 128, 0, 1));
+    CHECK(VectorBuilder::preparseSize ("1 2 3 4") == 4);
+    CHECK_THROWS(VectorBuilder::parse <glm::vec2> ("1 2 3"));
+
+    BENCHMARK("parse 10000 vec3") {
+        glm::vec3 sum (0.0f);
+
+        for (const auto& vector : vectors)
+            sum += VectorBuilder::parse <glm::vec3> (vector);
+
+        return sum;
+    };
+}
@@ -0,0 +1,39 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "WallpaperEngine/Debugging/AllocationProfiler.h"
+
+using namespace WallpaperEngine::Debugging;
+
+TEST_CASE("Allocation profiler counts the allocations of the thread that started it") {
+    AllocationProfiler::start ();
+
+    const auto value = std::make_unique<int> (1);
+    const auto values = std::make_unique<int[]> (16);
+
+    AllocationProfiler::stop ();
+
+    CHECK(AllocationProfiler::count () == 2);
+}
+
+TEST_CASE("Allocation profiler ignores other threads and stopped ones") {
+    std::thread other;
+
+    AllocationProfiler::start ();
+    // the thread's state is allocated by this one, only what it does after starting shouldn't count
+    other = std::thread ([] {
+        std::vector<int> values (64);
+    });
+    const uint64_t started = AllocationProfiler::count ();
+    other.join ();
+    const uint64_t joined = AllocationProfiler::count ();
+    AllocationProfiler::stop ();
+
+    const auto value = std::make_unique<int> (1);
+
+    CHECK(joined == started);
+    CHECK(AllocationProfiler::count () == joined);
+}
@@ -0,0 +1,85 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "WallpaperEngine/Audio/MixKernels.h"
+#include "WallpaperEngine/Audio/SampleRing.h"
+
+using namespace WallpaperEngine::Audio;
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("Mix kernels accumulate scaled samples and clip the result") {
+    // odd length so the scalar tail after the vector loop is covered too
+    std::vector<float> mix (1027, 0.5f);
+    std::vector<float> samples (mix.size ());
+
+    for (size_t i = 0; i < samples.size (); i++) {
+        samples [i] = static_cast<float> (i % 7) * 0.25f - 0.75f;
+    }
+
+    Kernels::accumulate (mix.data (), samples.data (), mix.size (), 2.0f);
+    Kernels::clip (mix.data (), mix.size ());
+
+    for (size_t i = 0; i < mix.size (); i++) {
+        const float expected = std::clamp (0.5f + samples [i] * 2.0f, -1.0f, 1.0f);
+
+        REQUIRE_THAT(mix [i], WithinAbs (expected, 1e-6));
+    }
+}
+
+TEST_CASE("SampleRing keeps data in order across the wrap around") {
+    SampleRing ring (100);
+    std::vector<uint8_t> out (ring.capacity ());
+    uint8_t next = 0;
+    uint8_t expected = 0;
+
+    REQUIRE(ring.capacity () == 128);
+
+    for (int round = 0; round < 10; round++) {
+        std::vector<uint8_t> in (90);
+
+        for (auto& value : in) {
+            value = next++;
+        }
+
+        REQUIRE(ring.write (in.data (), in.size ()) == in.size ());
+        // only what's left fits
+        CHECK(ring.write (in.data (), in.size ()) == 38);
+
+        const size_t read = ring.read (out.data (), out.size ());
+
+        REQUIRE(read == 128);
+        REQUIRE(ring.available () == 0);
+
+        for (size_t i = 0; i < 90; i++) {
+            REQUIRE(out [i] == expected++);
+        }
+
+        // the second write started over from the beginning of in
+        REQUIRE(std::memcmp (&out [90], in.data (), 38) == 0);
+    }
+}
+
+TEST_CASE("SampleRing clear drops what was written before it") {
+    SampleRing ring (64);
+    std::vector<uint8_t> in (48);
+    std::vector<uint8_t> out (64);
+
+    for (size_t i = 0; i < in.size (); i++) {
+        in [i] = static_cast<uint8_t> (i);
+    }
+
+    REQUIRE(ring.write (in.data (), in.size ()) == 48);
+
+    ring.clear ();
+
+    REQUIRE(ring.available () == 0);
+    // the reader didn't skip the cleared bytes yet, they can't be written over
+    REQUIRE(ring.space () == 16);
+    REQUIRE(ring.write (in.data (), 8) == 8);
+    REQUIRE(ring.read (out.data (), out.size ()) == 8);
+    REQUIRE(std::memcmp (out.data (), in.data (), 8) == 0);
+    REQUIRE(ring.space () == 64);
+}
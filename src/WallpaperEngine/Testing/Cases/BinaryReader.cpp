@@ -0,0 +1,55 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include "WallpaperEngine/Data/Utils/BinaryReader.h"
+#include "WallpaperEngine/Data/Utils/MemoryStream.h"
+
+using namespace WallpaperEngine::Data::Utils;
+
+namespace {
+std::string fixture () {
+    std::string data;
+    const auto append = [&data] (const uint32_t value) {
+        data.append (reinterpret_cast<const char*> (&value), sizeof (value));
+    };
+    const float number = 1.5f;
+
+    append (0xDEADBEEF);
+    append (5);
+    data.append ("PKGV1");
+    data.append ("texture.tex");
+    data.push_back ('\0');
+    data.append (reinterpret_cast<const char*> (&number), sizeof (number));
+    // cut short, only half of an integer left
+    data.append ("\x01\x02", 2);
+
+    return data;
+}
+
+void check (const BinaryReader& reader) {
+    CHECK(reader.nextUInt32 () == 0xDEADBEEF);
+    CHECK(reader.nextSizedStringView () == "PKGV1");
+    CHECK(reader.nextNullTerminatedString () == "texture.tex");
+    CHECK(reader.nextFloat () == 1.5f);
+    CHECK(reader.base ().tellg () == static_cast<std::streamoff> (fixture ().size () - 2));
+    // reading past the end fails the stream either way
+    std::ignore = reader.nextUInt32 ();
+    CHECK(reader.base ().fail ());
+}
+} // namespace
+
+TEST_CASE("BinaryReader reads memory the same as any other stream") {
+    const std::string data = fixture ();
+
+    SECTION("memory") {
+        check (BinaryReader (std::make_shared<MemoryStream> (data.data (), data.size (), nullptr)));
+    }
+
+    SECTION("stream") {
+        check (BinaryReader (std::make_shared<std::istringstream> (data)));
+    }
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+#include "WallpaperEngine/Data/Model/DynamicValue.h"
+
+using namespace WallpaperEngine::Data::Model;
+
+TEST_CASE("DynamicValue converts between representations when read") {
+    DynamicValue value (2.75f);
+
+    CHECK(value.getType () == DynamicValue::Float);
+    CHECK(value.getInt () == 2);
+    CHECK(value.getVec3 () == glm::vec3 (2.75f));
+    CHECK(value.getIVec4 () == glm::ivec4 (2));
+    CHECK(value.getBool ());
+
+    value.update (glm::vec2 (0.5f, 3.0f));
+
+    CHECK(value.getVec4 () == glm::vec4 (0.5f, 3.0f, 0.0f, 0.0f));
+    CHECK(value.getIVec3 () == glm::ivec3 (0, 3, 0));
+    CHECK(value.getFloat () == 0.5f);
+    CHECK(value.getBool ());
+
+    value.update (glm::ivec3 (16777217, -4, 9));
+
+    CHECK(value.getIVec4 () == glm::ivec4 (16777217, -4, 9, 0));
+    CHECK(value.getInt () == 16777217);
+    CHECK(value.getVec2 () == glm::vec2 (16777217.0f, -4.0f));
+}
+
+TEST_CASE("DynamicValue keeps strings and listeners aside") {
+    DynamicValue source;
+    DynamicValue target;
+    int notified = 0;
+
+    target.attachCondition ({.name = "mode", .condition = "fast"});
+    target.connect (&source);
+
+    const auto deregister = target.listen ([&notified] (const DynamicValue&) { notified++; });
+
+    source.update (std::string ("fast"));
+    // strings don't propagate on their own
+    CHECK(notified == 0);
+
+    target.update (source);
+
+    CHECK(notified == 1);
+    CHECK(target.getType () == DynamicValue::String);
+    CHECK(target.getBool ());
+    CHECK(target.getVec4 () == glm::vec4 (0.0f));
+
+    source.update (1);
+
+    CHECK(notified == 2);
+    CHECK(target.getInt () == 1);
+    CHECK(source.getString ().empty ());
+
+    deregister ();
+    source.update ();
+
+    CHECK(notified == 2);
+    CHECK(target.getType () == DynamicValue::Null);
+}
+
+TEST_CASE("DynamicValue batches deliver each change once, sources first") {
+    DynamicValue property (1.0f);
+    DynamicValue setting;
+    DynamicValue material;
+    std::vector<float> seen;
+
+    setting.connect (&property);
+    material.connect (&setting);
+
+    const auto deregister = material.listen ([&seen] (const DynamicValue& value) { seen.push_back (value.getFloat ()); });
+
+    {
+        DynamicValue::Batch batch;
+
+        // queued deepest first on purpose, the flush still goes from the property down
+        material.update (5.0f);
+        property.update (2.0f);
+        property.update (3.0f);
+
+        CHECK(setting.getFloat () == 1.0f);
+    }
+
+    CHECK(seen.empty ());
+
+    DynamicValue::flush ();
+
+    CHECK(setting.getFloat () == 3.0f);
+    CHECK(material.getFloat () == 3.0f);
+    CHECK(seen == std::vector<float> {3.0f});
+
+    deregister ();
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "WallpaperEngine/Render/FrameUniforms.h"
+
+using namespace WallpaperEngine::Render;
+
+TEST_CASE("FrameUniforms moves shared declarations into the block") {
+    std::string source = "#version 330\n"
+                         "uniform float g_Time;\n"
+                         "uniform float g_AudioSpectrum16Left[16]; // comment\n"
+                         "void main () {}\n";
+    std::set<std::string> replaced = {};
+
+    REQUIRE(FrameUniforms::rewrite (source, replaced));
+
+    CHECK(replaced == std::set<std::string> {"g_Time", "g_AudioSpectrum16Left"});
+    CHECK(source.starts_with ("#version 330\nlayout(std140) uniform g_FrameGlobals {"));
+    CHECK(source.find ("uniform float g_Time;") == std::string::npos);
+    CHECK(source.find ("#define g_Time g_Frame.time\n") != std::string::npos);
+    CHECK(source.find ("#define g_AudioSpectrum16Left g_Frame.audioSpectrum16Left\n") != std::string::npos);
+}
+
+TEST_CASE("FrameUniforms keeps declarations that don't match the block") {
+    const std::string original = "#version 330\n"
+                                 "uniform vec4 g_Time;\n"
+                                 "uniform float g_AudioSpectrum16Left[32];\n"
+                                 "uniform vec2 g_PointerPositionOffset;\n";
+    std::string source = original;
+    std::set<std::string> replaced = {};
+
+    CHECK_FALSE(FrameUniforms::rewrite (source, replaced));
+    CHECK(replaced.empty ());
+    CHECK(source == original);
+}
+
+TEST_CASE("FrameUniforms tells apart variables sharing a prefix") {
+    std::string source = "#version 330\n"
+                         "uniform vec2 g_PointerPositionLast;\n";
+    std::set<std::string> replaced = {};
+
+    REQUIRE(FrameUniforms::rewrite (source, replaced));
+    CHECK(replaced == std::set<std::string> {"g_PointerPositionLast"});
+    CHECK(source.find ("#define g_PointerPosition ") == std::string::npos);
+}
+
+TEST_CASE("FrameUniforms adds the parallax offset after the vertex shader's main") {
+    std::string source = "#version 330\n"
+                         "uniform float g_Time;\n"
+                         "void main (void) { gl_Position = vec4 (g_Time); }\n";
+    std::set<std::string> replaced = {};
+
+    REQUIRE(FrameUniforms::rewrite (source, replaced));
+    REQUIRE(FrameUniforms::injectParallax (source));
+
+    // declared once even though both found a reason to
+    CHECK(source.find ("uniform g_FrameGlobals {") == source.rfind ("uniform g_FrameGlobals {"));
+    CHECK(source.find ("void parallaxMain () { gl_Position") != std::string::npos);
+    CHECK(source.find ("uniform vec2 g_ParallaxDepth;") != std::string::npos);
+    CHECK(source.find ("parallaxMain ();\n") > source.find ("void parallaxMain ()"));
+}
@@ -0,0 +1,43 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+#include "WallpaperEngine/Render/GPUResources.h"
+
+using namespace WallpaperEngine::Render;
+
+TEST_CASE("GPU resources are totalled per type and per owner") {
+    const int texture = 0;
+    const int framebuffer = 0;
+    const std::string owner = "Some background";
+    const uint64_t textures = sGPUResources.getBytes (GPUResources::Type_Texture);
+    const uint64_t framebuffers = sGPUResources.getBytes (GPUResources::Type_Framebuffer);
+
+    {
+        GPUResources::Owner scope (owner);
+
+        sGPUResources.add (&texture, GPUResources::Type_Texture, 0, "materials/test.tex", "RGBA8");
+        sGPUResources.add (&framebuffer, GPUResources::Type_Framebuffer, 1024, "_rt_test", "RGBA8");
+    }
+
+    // streamed textures only take memory once uploaded
+    sGPUResources.resize (&texture, 4096);
+
+    CHECK(sGPUResources.getBytes (GPUResources::Type_Texture) == textures + 4096);
+    CHECK(sGPUResources.getBytes (GPUResources::Type_Framebuffer) == framebuffers + 1024);
+
+    std::ostringstream dump;
+
+    sGPUResources.dump (dump);
+
+    CHECK(dump.str ().find ("Some background") != std::string::npos);
+    CHECK(dump.str ().find ("materials/test.tex (RGBA8)") != std::string::npos);
+
+    sGPUResources.remove (&texture);
+    sGPUResources.remove (&framebuffer);
+    // removing twice is harmless, shared render targets can be released by more than one owner
+    sGPUResources.remove (&framebuffer);
+
+    CHECK(sGPUResources.getBytes (GPUResources::Type_Texture) == textures);
+    CHECK(sGPUResources.getBytes (GPUResources::Type_Framebuffer) == framebuffers);
+}
@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+
+#include "WallpaperEngine/Debugging/InputRecording.h"
+
+using namespace WallpaperEngine::Debugging;
+
+TEST_CASE ("Input recordings play back the frames they recorded") {
+    const auto path = std::filesystem::temp_directory_path () / "wallpaperengine-input-recording.bin";
+
+    {
+        InputRecording recording (path, 1234);
+        InputRecording::Frame frame;
+
+        for (int i = 0; i < 4; i++) {
+            frame.time = static_cast<float> (i) / 30.0f;
+            frame.daytime = 0.5f;
+            frame.mouse = {i * 10.0, 20.0};
+            frame.leftClick = i == 2 ? WallpaperEngine::Input::Clicked : WallpaperEngine::Input::Released;
+            // the spectrum only changes on the second frame
+            frame.spectrum [5] = i >= 1 ? 0.75f : 0.0f;
+
+            if (i == 3)
+                frame.properties = {{"color", "1 0 0"}};
+
+            recording.write (frame);
+        }
+    }
+
+    InputRecording recording (path);
+    InputRecording::Frame frame;
+
+    CHECK(recording.isReplaying ());
+    CHECK(recording.getSeed () == 1234);
+
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(recording.read (frame));
+        CHECK(frame.time == static_cast<float> (i) / 30.0f);
+        CHECK(frame.mouse.x == i * 10.0);
+        CHECK(frame.leftClick == (i == 2 ? WallpaperEngine::Input::Clicked : WallpaperEngine::Input::Released));
+        CHECK(frame.hasSpectrum == (i == 1));
+        // frames without a spectrum of their own keep the last one
+        CHECK(frame.spectrum [5] == (i >= 1 ? 0.75f : 0.0f));
+        CHECK(frame.properties.size () == (i == 3 ? 1 : 0));
+    }
+
+    CHECK_FALSE(recording.read (frame));
+
+    std::filesystem::remove (path);
+}
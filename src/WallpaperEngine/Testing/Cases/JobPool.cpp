@@ -0,0 +1,63 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <vector>
+
+#include "WallpaperEngine/Threading/JobPool.h"
+
+using namespace WallpaperEngine::Threading;
+
+TEST_CASE("JobPool runs every submitted job before wait returns") {
+    JobPool pool (3);
+    JobPool::Group group;
+    std::atomic<int> counter = 0;
+
+    for (int i = 0; i < 1000; i++) {
+        pool.submit (group, [&counter] () { counter++; });
+    }
+
+    pool.wait (group);
+    CHECK(counter == 1000);
+}
+
+TEST_CASE("JobPool parallelFor covers the whole range exactly once") {
+    JobPool pool (3);
+    std::vector<int> hits (10007, 0);
+
+    pool.parallelFor (hits.size (), 64, [&hits] (uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            hits [i]++;
+        }
+    });
+
+    for (const int hit : hits) {
+        REQUIRE(hit == 1);
+    }
+}
+
+TEST_CASE("JobPool supports nested waits from inside jobs") {
+    JobPool pool (2);
+    JobPool::Group outer;
+    std::atomic<int> counter = 0;
+
+    for (int i = 0; i < 8; i++) {
+        pool.submit (outer, [&pool, &counter] () {
+            pool.parallelFor (256, 16, [&counter] (uint32_t begin, uint32_t end) {
+                counter += static_cast<int> (end - begin);
+            });
+        });
+    }
+
+    pool.wait (outer);
+    CHECK(counter == 8 * 256);
+}
+
+TEST_CASE("JobPool without workers runs jobs on the waiting thread") {
+    JobPool pool (0);
+    JobPool::Group group;
+    int counter = 0;
+
+    pool.submit (group, [&counter] () { counter++; });
+    pool.wait (group);
+
+    CHECK(counter == 1);
+}
@@ -0,0 +1,50 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+
+#include "WallpaperEngine/Render/WallpaperState.h"
+
+using namespace WallpaperEngine::Render;
+
+namespace {
+/**
+ * @return Where the point of the scene at the given texture coordinates ends up in the viewport's clip space
+ */
+glm::vec2 place (const WallpaperState& state, const float u, const float v) {
+    const glm::vec4 clip = state.getOutputTransform () * glm::vec4 (u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.0f, 1.0f);
+
+    return {clip.x, clip.y};
+}
+} // namespace
+
+TEST_CASE("Output transform puts the UVs' corners on the viewport's corners") {
+    WallpaperState state (WallpaperState::TextureUVsScaling::ZoomFillUVs, 0);
+
+    // a 16:9 scene filling a 4:3 screen gets its sides cropped
+    state.updateState ({0, 0, 1600, 1200}, false, 1920, 1080);
+
+    const auto uvs = state.getTextureUVs ();
+
+    REQUIRE(state.coversViewport ());
+    CHECK(place (state, uvs.ustart, uvs.vstart).x == Catch::Approx (-1.0f));
+    CHECK(place (state, uvs.ustart, uvs.vstart).y == Catch::Approx (1.0f));
+    CHECK(place (state, uvs.uend, uvs.vend).x == Catch::Approx (1.0f));
+    CHECK(place (state, uvs.uend, uvs.vend).y == Catch::Approx (-1.0f));
+}
+
+TEST_CASE("Output transform flips the scene for flipped outputs") {
+    WallpaperState state (WallpaperState::TextureUVsScaling::StretchUVs, 0);
+
+    state.updateState ({0, 0, 1920, 1080}, true, 1920, 1080);
+
+    CHECK(place (state, 0.0f, 1.0f).y == Catch::Approx (-1.0f));
+    CHECK(place (state, 0.0f, 0.0f).y == Catch::Approx (1.0f));
+}
+
+TEST_CASE("Letterboxed scenes don't cover the viewport") {
+    WallpaperState state (WallpaperState::TextureUVsScaling::ZoomFitUVs, 0);
+
+    state.updateState ({0, 0, 1600, 1200}, false, 1920, 1080);
+
+    CHECK_FALSE(state.coversViewport ());
+}
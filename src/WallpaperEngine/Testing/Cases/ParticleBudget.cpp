@@ -0,0 +1,64 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "WallpaperEngine/Render/Objects/Particles/ParticleBudget.h"
+
+using namespace WallpaperEngine::Render::Objects::Particles;
+
+TEST_CASE("ParticleBudget without limits never scales") {
+    ParticleBudget budget;
+
+    for (int i = 0; i < 100; i++) {
+        budget.update (1000000, 1000000);
+    }
+
+    CHECK_FALSE(budget.isEnabled ());
+    CHECK(budget.getScale () == 1.0f);
+}
+
+TEST_CASE("ParticleBudget scales down while over budget and stops at the minimum") {
+    ParticleBudget budget (1000, 0);
+
+    budget.update (2000, 0);
+    const float first = budget.getScale ();
+
+    CHECK(first < 1.0f);
+    CHECK(first >= 1.0f - ParticleBudget::DECREASE_STEP);
+
+    for (int i = 0; i < 1000; i++) {
+        budget.update (2000, 0);
+    }
+
+    CHECK(budget.getScale () == ParticleBudget::MIN_SCALE);
+}
+
+TEST_CASE("ParticleBudget recovers once usage drops") {
+    ParticleBudget budget (0, 1000);
+
+    for (int i = 0; i < 100; i++) {
+        budget.update (0, 5000);
+    }
+
+    REQUIRE(budget.getScale () < 1.0f);
+
+    for (int i = 0; i < 1000; i++) {
+        budget.update (0, 100);
+    }
+
+    CHECK(budget.getScale () == 1.0f);
+}
+
+TEST_CASE("ParticleBudget holds the scale inside the hysteresis band") {
+    ParticleBudget budget (1000, 0);
+
+    for (int i = 0; i < 10; i++) {
+        budget.update (2000, 0);
+    }
+
+    const float scale = budget.getScale ();
+
+    for (int i = 0; i < 100; i++) {
+        budget.update (950, 0);
+    }
+
+    CHECK(budget.getScale () == scale);
+}
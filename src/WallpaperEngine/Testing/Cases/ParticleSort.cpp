@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "WallpaperEngine/Render/Objects/Particles/ParticleSort.h"
+
+using namespace WallpaperEngine::Render::Objects::Particles;
+
+TEST_CASE("ParticleSort float keys keep the order of the floats") {
+    const std::vector<float> values = {-1000.0f, -1.5f, -0.0f, 0.0f, 0.25f, 1.0f, 3.0e10f};
+
+    for (size_t i = 1; i < values.size (); i++) {
+        CHECK(ParticleSort::floatKey (values [i - 1]) <= ParticleSort::floatKey (values [i]));
+    }
+}
+
+TEST_CASE("ParticleSort sorts big arrays like a stable sort would") {
+    ParticleSort sorter;
+    std::mt19937 random (1234);
+
+    // once below the parallel threshold and once split in chunks
+    for (const uint32_t count : {1000u, 100000u}) {
+        std::vector<uint32_t> keys (count);
+        std::vector<uint32_t> indices (count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            // few distinct keys so plenty of them are equal
+            keys [i] = ParticleSort::floatKey (static_cast<float> (random () % 512) - 256.0f);
+            indices [i] = i;
+        }
+
+        std::vector<std::pair<uint32_t, uint32_t>> expected (count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            expected [i] = {keys [i], indices [i]};
+        }
+
+        std::stable_sort (expected.begin (), expected.end (), [] (const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+
+        sorter.sort (keys, indices);
+
+        for (uint32_t i = 0; i < count; i++) {
+            REQUIRE(keys [i] == expected [i].first);
+            REQUIRE(indices [i] == expected [i].second);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "WallpaperEngine/Testing/Harnesses/RenderHarness.h"
+
+using namespace WallpaperEngine::Testing::Harnesses;
+
+namespace {
+/** growth allowed between the end of the first cycle and the end of the last one */
+constexpr int64_t MAX_RSS_GROWTH = 32 * 1024 * 1024;
+constexpr int64_t MAX_VIDEO_MEMORY_GROWTH = 64 * 1024 * 1024;
+
+struct Sample {
+    int64_t rss;
+    /** -1 if the driver can't tell, only NVIDIA drivers report it */
+    int64_t videoMemory;
+    GLObjects objects;
+};
+
+Sample sample () {
+    Sample result = {0, -1, GLShims::objects ()};
+    std::ifstream statm ("/proc/self/statm");
+    int64_t size = 0;
+    int64_t resident = 0;
+
+    statm >> size >> resident;
+    result.rss = resident * sysconf (_SC_PAGESIZE);
+
+    if (GLEW_NVX_gpu_memory_info) {
+        GLint total = 0;
+        GLint available = 0;
+
+        glGetIntegerv (GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &total);
+        glGetIntegerv (GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+
+        // reported in KB
+        result.videoMemory = static_cast<int64_t> (total - available) * 1024;
+    }
+
+    return result;
+}
+
+std::vector<std::filesystem::path> playlist (const char* items) {
+    std::vector<std::filesystem::path> result = {};
+    std::istringstream stream (items);
+    std::string item;
+
+    while (std::getline (stream, item, ':'))
+        if (!item.empty ())
+            result.emplace_back (item);
+
+    return result;
+}
+
+int environment (const char* variable, const int fallback) {
+    const char* value = std::getenv (variable);
+
+    return value == nullptr ? fallback : std::atoi (value);
+}
+} // namespace
+
+// meant to run for hours against real backgrounds, so it only runs when they're given through the environment:
+// WPE_TEST_SOAK_PLAYLIST is a colon separated list of backgrounds, WPE_TEST_SOAK_CYCLES how many times to go through
+// all of them and WPE_TEST_SOAK_SECONDS how long each one is shown
+TEST_CASE("Cycling through a playlist doesn't grow memory or GL objects") {
+    const char* items = std::getenv ("WPE_TEST_SOAK_PLAYLIST");
+
+    if (items == nullptr) {
+        WARN("WPE_TEST_SOAK_PLAYLIST isn't set, point it to a few backgrounds separated by colons");
+        return;
+    }
+
+    const auto backgrounds = playlist (items);
+    const int cycles = environment ("WPE_TEST_SOAK_CYCLES", 20);
+    const auto shown = std::chrono::seconds (environment ("WPE_TEST_SOAK_SECONDS", 2));
+
+    REQUIRE(backgrounds.size () > 1);
+    REQUIRE(cycles > 1);
+
+    const auto harness = std::unique_ptr<RenderHarness> (RenderHarness::build (backgrounds.front ()));
+    Sample first = {};
+
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        for (const auto& background : backgrounds) {
+            harness->load (background);
+
+            for (const auto until = std::chrono::steady_clock::now () + shown;
+                 std::chrono::steady_clock::now () < until;)
+                harness->frame ();
+        }
+
+        // the caches fill up during the first cycle, everything after it should be reused
+        if (cycle == 0)
+            first = sample ();
+    }
+
+    const Sample last = sample ();
+
+    CAPTURE(first.rss, last.rss, first.videoMemory, last.videoMemory);
+    CHECK(last.objects.textures == first.objects.textures);
+    CHECK(last.objects.buffers == first.objects.buffers);
+    CHECK(last.objects.programs == first.objects.programs);
+    CHECK(last.objects.framebuffers == first.objects.framebuffers);
+    CHECK(last.objects.renderbuffers == first.objects.renderbuffers);
+    CHECK(last.rss - first.rss <= MAX_RSS_GROWTH);
+
+    if (first.videoMemory >= 0)
+        CHECK(last.videoMemory - first.videoMemory <= MAX_VIDEO_MEMORY_GROWTH);
+}
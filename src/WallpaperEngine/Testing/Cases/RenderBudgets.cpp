@@ -0,0 +1,78 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <memory>
+
+#include "WallpaperEngine/Debugging/AllocationProfiler.h"
+#include "WallpaperEngine/Testing/Harnesses/RenderHarness.h"
+
+using namespace WallpaperEngine::Debugging;
+using namespace WallpaperEngine::Testing::Harnesses;
+
+namespace {
+/**
+ * @return The harness rendering the background the environment variable points to, nullptr if it's not set
+ */
+std::unique_ptr<RenderHarness> buildFromEnvironment (const char* variable) {
+    const char* background = std::getenv (variable);
+
+    if (background == nullptr)
+        return nullptr;
+
+    return std::unique_ptr<RenderHarness> (RenderHarness::build (background));
+}
+
+/**
+ * Renders until the textures are in and the caches built, the frames after that are the steady state
+ */
+void settle (RenderHarness& harness) {
+    for (int i = 0; i < 600 && harness.isStreaming (); i++)
+        harness.frame ();
+
+    for (int i = 0; i < 10; i++)
+        harness.frame ();
+}
+} // namespace
+
+// scenes aren't shipped with the repo, these run against a background given through the environment
+TEST_CASE("Static scenes don't query or upload anything once settled") {
+    const auto harness = buildFromEnvironment ("WPE_TEST_STATIC_SCENE");
+
+    if (harness == nullptr) {
+        WARN("WPE_TEST_STATIC_SCENE isn't set, point it to a scene without particles or animated layers");
+        return;
+    }
+
+    settle (*harness);
+
+    const GLCounters first = harness->frame ();
+    const GLCounters second = harness->frame ();
+
+    CHECK(first.queries == 0);
+    CHECK(first.bufferUploads == 0);
+    CHECK(first.bufferUploadBytes == 0);
+    // nothing changes between frames, so neither does the work
+    CHECK(second.drawCalls == first.drawCalls);
+    CHECK(second.programBinds == first.programBinds);
+    CHECK(second.textureBinds == first.textureBinds);
+}
+
+TEST_CASE("Static scenes don't allocate once settled") {
+    const auto harness = buildFromEnvironment ("WPE_TEST_STATIC_SCENE");
+
+    if (harness == nullptr) {
+        WARN("WPE_TEST_STATIC_SCENE isn't set, point it to a scene without particles or animated layers");
+        return;
+    }
+
+    settle (*harness);
+
+    AllocationProfiler::start ();
+
+    for (int i = 0; i < 10; i++)
+        harness->frame ();
+
+    AllocationProfiler::stop ();
+
+    CHECK(AllocationProfiler::count () == 0);
+}
@@ -0,0 +1,294 @@
+#include "GLShims.h"
+
+#include <GL/glew.h>
+#include <dlfcn.h>
+
+using namespace WallpaperEngine::Testing::Harnesses;
+
+namespace {
+GLCounters counted = {};
+GLObjects alive = {};
+
+/**
+ * @return The function the tests binary's own definition hides
+ */
+template <typename T> T next (const char* name) {
+    return reinterpret_cast<T> (dlsym (RTLD_NEXT, name));
+}
+
+/**
+ * @return How many of the names aren't zero, deleting zero is ignored by GL
+ */
+int64_t named (const GLsizei n, const GLuint* names) {
+    int64_t result = 0;
+
+    for (GLsizei i = 0; i < n; i++)
+        result += names [i] != 0;
+
+    return result;
+}
+
+/**
+ * Puts the shim in front of the function GLEW points to, glewInit running again undoes it
+ */
+template <typename T> void hook (T& pointer, T& real, T shim) {
+    if (pointer == shim)
+        return;
+
+    real = pointer;
+    pointer = shim;
+}
+
+PFNGLUSEPROGRAMPROC realUseProgram = nullptr;
+PFNGLBUFFERDATAPROC realBufferData = nullptr;
+PFNGLBUFFERSUBDATAPROC realBufferSubData = nullptr;
+PFNGLMAPBUFFERRANGEPROC realMapBufferRange = nullptr;
+PFNGLDRAWARRAYSINSTANCEDPROC realDrawArraysInstanced = nullptr;
+PFNGLDRAWELEMENTSINSTANCEDPROC realDrawElementsInstanced = nullptr;
+PFNGLDRAWTRANSFORMFEEDBACKPROC realDrawTransformFeedback = nullptr;
+PFNGLGETUNIFORMLOCATIONPROC realGetUniformLocation = nullptr;
+PFNGLGETATTRIBLOCATIONPROC realGetAttribLocation = nullptr;
+PFNGLGETPROGRAMIVPROC realGetProgramiv = nullptr;
+PFNGLGETSHADERIVPROC realGetShaderiv = nullptr;
+PFNGLGETQUERYOBJECTIVPROC realGetQueryObjectiv = nullptr;
+PFNGLGETQUERYOBJECTUIVPROC realGetQueryObjectuiv = nullptr;
+PFNGLGENBUFFERSPROC realGenBuffers = nullptr;
+PFNGLDELETEBUFFERSPROC realDeleteBuffers = nullptr;
+PFNGLCREATEPROGRAMPROC realCreateProgram = nullptr;
+PFNGLDELETEPROGRAMPROC realDeleteProgram = nullptr;
+PFNGLGENFRAMEBUFFERSPROC realGenFramebuffers = nullptr;
+PFNGLDELETEFRAMEBUFFERSPROC realDeleteFramebuffers = nullptr;
+PFNGLGENRENDERBUFFERSPROC realGenRenderbuffers = nullptr;
+PFNGLDELETERENDERBUFFERSPROC realDeleteRenderbuffers = nullptr;
+
+void GLAPIENTRY shimUseProgram (const GLuint program) {
+    counted.programBinds++;
+    realUseProgram (program);
+}
+
+void GLAPIENTRY shimBufferData (const GLenum target, const GLsizeiptr size, const void* data, const GLenum usage) {
+    // only allocating the storage doesn't send anything
+    if (data != nullptr) {
+        counted.bufferUploads++;
+        counted.bufferUploadBytes += size;
+    }
+
+    realBufferData (target, size, data, usage);
+}
+
+void GLAPIENTRY shimBufferSubData (const GLenum target, const GLintptr offset, const GLsizeiptr size,
+                                   const void* data) {
+    counted.bufferUploads++;
+    counted.bufferUploadBytes += size;
+    realBufferSubData (target, offset, size, data);
+}
+
+void* GLAPIENTRY shimMapBufferRange (const GLenum target, const GLintptr offset, const GLsizeiptr length,
+                                     const GLbitfield access) {
+    if (access & GL_MAP_WRITE_BIT) {
+        counted.bufferUploads++;
+        counted.bufferUploadBytes += length;
+    }
+
+    return realMapBufferRange (target, offset, length, access);
+}
+
+void GLAPIENTRY shimDrawArraysInstanced (const GLenum mode, const GLint first, const GLsizei count,
+                                         const GLsizei instances) {
+    counted.drawCalls++;
+    realDrawArraysInstanced (mode, first, count, instances);
+}
+
+void GLAPIENTRY shimDrawElementsInstanced (const GLenum mode, const GLsizei count, const GLenum type,
+                                           const void* indices, const GLsizei instances) {
+    counted.drawCalls++;
+    realDrawElementsInstanced (mode, count, type, indices, instances);
+}
+
+void GLAPIENTRY shimDrawTransformFeedback (const GLenum mode, const GLuint id) {
+    counted.drawCalls++;
+    realDrawTransformFeedback (mode, id);
+}
+
+GLint GLAPIENTRY shimGetUniformLocation (const GLuint program, const GLchar* name) {
+    counted.queries++;
+    return realGetUniformLocation (program, name);
+}
+
+GLint GLAPIENTRY shimGetAttribLocation (const GLuint program, const GLchar* name) {
+    counted.queries++;
+    return realGetAttribLocation (program, name);
+}
+
+void GLAPIENTRY shimGetProgramiv (const GLuint program, const GLenum name, GLint* params) {
+    counted.queries++;
+    realGetProgramiv (program, name, params);
+}
+
+void GLAPIENTRY shimGetShaderiv (const GLuint shader, const GLenum name, GLint* params) {
+    counted.queries++;
+    realGetShaderiv (shader, name, params);
+}
+
+void GLAPIENTRY shimGetQueryObjectiv (const GLuint id, const GLenum name, GLint* params) {
+    counted.queries++;
+    realGetQueryObjectiv (id, name, params);
+}
+
+void GLAPIENTRY shimGetQueryObjectuiv (const GLuint id, const GLenum name, GLuint* params) {
+    counted.queries++;
+    realGetQueryObjectuiv (id, name, params);
+}
+
+void GLAPIENTRY shimGenBuffers (const GLsizei n, GLuint* buffers) {
+    alive.buffers += n;
+    realGenBuffers (n, buffers);
+}
+
+void GLAPIENTRY shimDeleteBuffers (const GLsizei n, const GLuint* buffers) {
+    alive.buffers -= named (n, buffers);
+    realDeleteBuffers (n, buffers);
+}
+
+GLuint GLAPIENTRY shimCreateProgram () {
+    const GLuint program = realCreateProgram ();
+
+    alive.programs += program != 0;
+
+    return program;
+}
+
+void GLAPIENTRY shimDeleteProgram (const GLuint program) {
+    alive.programs -= program != 0;
+    realDeleteProgram (program);
+}
+
+void GLAPIENTRY shimGenFramebuffers (const GLsizei n, GLuint* framebuffers) {
+    alive.framebuffers += n;
+    realGenFramebuffers (n, framebuffers);
+}
+
+void GLAPIENTRY shimDeleteFramebuffers (const GLsizei n, const GLuint* framebuffers) {
+    alive.framebuffers -= named (n, framebuffers);
+    realDeleteFramebuffers (n, framebuffers);
+}
+
+void GLAPIENTRY shimGenRenderbuffers (const GLsizei n, GLuint* renderbuffers) {
+    alive.renderbuffers += n;
+    realGenRenderbuffers (n, renderbuffers);
+}
+
+void GLAPIENTRY shimDeleteRenderbuffers (const GLsizei n, const GLuint* renderbuffers) {
+    alive.renderbuffers -= named (n, renderbuffers);
+    realDeleteRenderbuffers (n, renderbuffers);
+}
+} // namespace
+
+extern "C" {
+GLAPI void GLAPIENTRY glDrawArrays (const GLenum mode, const GLint first, const GLsizei count) {
+    static const auto real = next<decltype (&glDrawArrays)> ("glDrawArrays");
+
+    counted.drawCalls++;
+    real (mode, first, count);
+}
+
+GLAPI void GLAPIENTRY glDrawElements (const GLenum mode, const GLsizei count, const GLenum type, const void* indices) {
+    static const auto real = next<decltype (&glDrawElements)> ("glDrawElements");
+
+    counted.drawCalls++;
+    real (mode, count, type, indices);
+}
+
+GLAPI void GLAPIENTRY glBindTexture (const GLenum target, const GLuint texture) {
+    static const auto real = next<decltype (&glBindTexture)> ("glBindTexture");
+
+    counted.textureBinds++;
+    real (target, texture);
+}
+
+GLAPI void GLAPIENTRY glGetIntegerv (const GLenum name, GLint* data) {
+    static const auto real = next<decltype (&glGetIntegerv)> ("glGetIntegerv");
+
+    counted.queries++;
+    real (name, data);
+}
+
+GLAPI void GLAPIENTRY glGetFloatv (const GLenum name, GLfloat* data) {
+    static const auto real = next<decltype (&glGetFloatv)> ("glGetFloatv");
+
+    counted.queries++;
+    real (name, data);
+}
+
+GLAPI void GLAPIENTRY glGetBooleanv (const GLenum name, GLboolean* data) {
+    static const auto real = next<decltype (&glGetBooleanv)> ("glGetBooleanv");
+
+    counted.queries++;
+    real (name, data);
+}
+
+GLAPI void GLAPIENTRY glGetTexLevelParameteriv (const GLenum target, const GLint level, const GLenum name,
+                                                GLint* params) {
+    static const auto real = next<decltype (&glGetTexLevelParameteriv)> ("glGetTexLevelParameteriv");
+
+    counted.queries++;
+    real (target, level, name, params);
+}
+
+GLAPI void GLAPIENTRY glGenTextures (const GLsizei n, GLuint* textures) {
+    static const auto real = next<decltype (&glGenTextures)> ("glGenTextures");
+
+    alive.textures += n;
+    real (n, textures);
+}
+
+GLAPI void GLAPIENTRY glDeleteTextures (const GLsizei n, const GLuint* textures) {
+    static const auto real = next<decltype (&glDeleteTextures)> ("glDeleteTextures");
+
+    alive.textures -= named (n, textures);
+    real (n, textures);
+}
+
+GLAPI GLenum GLAPIENTRY glGetError () {
+    static const auto real = next<decltype (&glGetError)> ("glGetError");
+
+    counted.queries++;
+    return real ();
+}
+}
+
+void GLShims::install () {
+    hook (__glewUseProgram, realUseProgram, shimUseProgram);
+    hook (__glewBufferData, realBufferData, shimBufferData);
+    hook (__glewBufferSubData, realBufferSubData, shimBufferSubData);
+    hook (__glewMapBufferRange, realMapBufferRange, shimMapBufferRange);
+    hook (__glewDrawArraysInstanced, realDrawArraysInstanced, shimDrawArraysInstanced);
+    hook (__glewDrawElementsInstanced, realDrawElementsInstanced, shimDrawElementsInstanced);
+    hook (__glewDrawTransformFeedback, realDrawTransformFeedback, shimDrawTransformFeedback);
+    hook (__glewGetUniformLocation, realGetUniformLocation, shimGetUniformLocation);
+    hook (__glewGetAttribLocation, realGetAttribLocation, shimGetAttribLocation);
+    hook (__glewGetProgramiv, realGetProgramiv, shimGetProgramiv);
+    hook (__glewGetShaderiv, realGetShaderiv, shimGetShaderiv);
+    hook (__glewGetQueryObjectiv, realGetQueryObjectiv, shimGetQueryObjectiv);
+    hook (__glewGetQueryObjectuiv, realGetQueryObjectuiv, shimGetQueryObjectuiv);
+    hook (__glewGenBuffers, realGenBuffers, shimGenBuffers);
+    hook (__glewDeleteBuffers, realDeleteBuffers, shimDeleteBuffers);
+    hook (__glewCreateProgram, realCreateProgram, shimCreateProgram);
+    hook (__glewDeleteProgram, realDeleteProgram, shimDeleteProgram);
+    hook (__glewGenFramebuffers, realGenFramebuffers, shimGenFramebuffers);
+    hook (__glewDeleteFramebuffers, realDeleteFramebuffers, shimDeleteFramebuffers);
+    hook (__glewGenRenderbuffers, realGenRenderbuffers, shimGenRenderbuffers);
+    hook (__glewDeleteRenderbuffers, realDeleteRenderbuffers, shimDeleteRenderbuffers);
+}
+
+void GLShims::reset () {
+    counted = {};
+}
+
+const GLCounters& GLShims::counters () {
+    return counted;
+}
+
+const GLObjects& GLShims::objects () {
+    return alive;
+}
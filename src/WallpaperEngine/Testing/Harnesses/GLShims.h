@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+namespace WallpaperEngine::Testing::Harnesses {
+/**
+ * GL work counted by the shims since the last reset
+ */
+struct GLCounters {
+    /** glDraw* calls, instanced and transform feedback draws included */
+    uint32_t drawCalls = 0;
+    /** glUseProgram calls */
+    uint32_t programBinds = 0;
+    /** glBindTexture calls */
+    uint32_t textureBinds = 0;
+    /** glBufferData, glBufferSubData and glMapBufferRange calls that write to a buffer */
+    uint32_t bufferUploads = 0;
+    /** bytes those calls sent to the GPU */
+    uint64_t bufferUploadBytes = 0;
+    /** glGet* and glGetError calls, every one of them waits on the driver */
+    uint32_t queries = 0;
+};
+
+/**
+ * GL objects alive right now, counted from the names created and deleted through the shims since install ()
+ */
+struct GLObjects {
+    int64_t textures = 0;
+    int64_t buffers = 0;
+    int64_t programs = 0;
+    int64_t framebuffers = 0;
+    int64_t renderbuffers = 0;
+
+    bool operator== (const GLObjects&) const = default;
+};
+
+/**
+ * Shims in front of the GL functions the counters follow
+ *
+ * GL 1.1 functions are exported by libGL itself, so the tests binary defines its own versions that count and
+ * forward to the real ones; everything newer goes through GLEW's function pointers, which install () swaps for
+ * counting versions
+ */
+class GLShims {
+  public:
+    /**
+     * Puts the shims in front of GLEW's function pointers, has to run after glewInit
+     */
+    static void install ();
+    /**
+     * Starts counting from zero again
+     */
+    static void reset ();
+    /**
+     * @return What was counted since the last reset
+     */
+    [[nodiscard]] static const GLCounters& counters ();
+    /**
+     * @return The GL objects alive, reset () doesn't touch these
+     */
+    [[nodiscard]] static const GLObjects& objects ();
+};
+} // namespace WallpaperEngine::Testing::Harnesses
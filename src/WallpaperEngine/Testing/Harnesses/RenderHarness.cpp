@@ -1,15 +1,38 @@
 #include "RenderHarness.h"
 
+#include "WallpaperEngine/Render/Drivers/Detectors/FullScreenDetector.h"
+#include "WallpaperEngine/Render/RenderContext.h"
+
+#include <list>
+#include <string>
+#include <vector>
+
+extern float g_Time;
+extern float g_TimeLast;
+
 using namespace WallpaperEngine::Testing::Harnesses;
 
-const char* argv[] = {
-    "",
-};
+namespace {
+// the context keeps pointing at its arguments, so they have to outlive it
+std::list<std::string> backgrounds;
+std::list<std::vector<const char*>> arguments;
+} // namespace
 
 RenderHarness::RenderHarness(ApplicationContext* context, WallpaperApplication* app) :
     m_context (context),
-    m_app (app),
-    m_driver (*context, *app) {
+    m_app (app) {
+    // the app renders through the testing driver instead of picking one for the session
+    auto driver = std::make_unique<TestingOpenGLDriver> (*context, *app);
+
+    this->m_driver = driver.get ();
+    this->m_app->m_videoDriver = std::move (driver);
+    this->m_app->m_fullScreenDetector =
+        std::make_unique<WallpaperEngine::Render::Drivers::Detectors::FullScreenDetector> (*context);
+
+    GLShims::install ();
+
+    this->m_app->setupAudio ();
+    this->m_app->prepareOutputs ();
 }
 
 RenderHarness::~RenderHarness() {
@@ -18,11 +41,39 @@ RenderHarness::~RenderHarness() {
 }
 
 RenderHarness* RenderHarness::build (std::filesystem::path base) {
+    const auto& background = backgrounds.emplace_back (base.string ());
+    auto& argv = arguments.emplace_back (std::vector<const char*> {
+        "", "--silent", "--noautomute", background.c_str (),
+    });
+
     // build context, app and return a harness that owns it
-    auto context = new ApplicationContext (1, const_cast<char**> (argv));
+    auto context = new ApplicationContext (static_cast<int> (argv.size ()), const_cast<char**> (argv.data ()));
+
+    context->loadSettingsFromArgv ();
 
     return new RenderHarness (
         context,
         new WallpaperApplication (*context)
     );
-}
\ No newline at end of file
+}
+
+GLCounters RenderHarness::frame () {
+    g_TimeLast = g_Time;
+    g_Time = this->m_driver->getRenderTime ();
+
+    this->m_app->m_renderContext->beginFrame ();
+
+    GLShims::reset ();
+    this->m_driver->dispatchEventQueue ();
+
+    return GLShims::counters ();
+}
+
+void RenderHarness::load (const std::filesystem::path& background) {
+    // window mode only has the default screen
+    this->m_app->switchWallpaper ("default", background);
+}
+
+bool RenderHarness::isStreaming () const {
+    return this->m_app->m_renderContext->isStreaming ();
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "WallpaperEngine/Testing/Harnesses/GLShims.h"
 #include "WallpaperEngine/Testing/Render/TestingOpenGLDriver.h"
 
 namespace WallpaperEngine::Testing::Harnesses {
@@ -13,15 +14,37 @@ using namespace WallpaperEngine::Testing::Render;
  */
 class RenderHarness {
   public:
+    /**
+     * @param base The background to render
+     */
     static RenderHarness* build (std::filesystem::path base);
 
     ~RenderHarness ();
+
+    /**
+     * Renders one frame the way the main loop does
+     *
+     * @return The GL work that frame took
+     */
+    GLCounters frame ();
+    /**
+     * Switches to another background the way a playlist does
+     *
+     * @param background The background to render from now on
+     */
+    void load (const std::filesystem::path& background);
+    /**
+     * @return If textures are still streaming in, frames until they're done aren't representative
+     */
+    [[nodiscard]] bool isStreaming () const;
+
   protected:
     RenderHarness (ApplicationContext* context, WallpaperApplication* app);
 
   private:
-    TestingOpenGLDriver m_driver;
     ApplicationContext* m_context;
     WallpaperApplication* m_app;
+    /** owned by the app, like the drivers it creates itself */
+    TestingOpenGLDriver* m_driver = nullptr;
 };
 } // namespace WallpaperEngine::Testing::Harnesses
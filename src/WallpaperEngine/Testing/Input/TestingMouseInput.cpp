@@ -16,4 +16,7 @@ MouseClickStatus TestingMouseInput::leftClick () const {
 
 MouseClickStatus TestingMouseInput::rightClick () const {
     return MouseClickStatus::Released;
-}
\ No newline at end of file
+}
+uint64_t TestingMouseInput::generation () const {
+    return 0;
+}
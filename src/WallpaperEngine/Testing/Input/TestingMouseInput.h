@@ -11,5 +11,6 @@ class TestingMouseInput final : public MouseInput {
     [[nodiscard]] glm::dvec2 position () const override;
     [[nodiscard]] MouseClickStatus leftClick () const override;
     [[nodiscard]] MouseClickStatus rightClick () const override;
+    [[nodiscard]] uint64_t generation () const override;
 };
 } // namespace WallpaperEngine::Testing::Input
@@ -24,6 +24,9 @@ TestingOpenGLDriver::TestingOpenGLDriver(ApplicationContext& context, WallpaperA
     glfwWindowHint (GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint (GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint (GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // wallpapers are drawn into framebuffers without depth and copied over, the window doesn't need any
+    glfwWindowHint (GLFW_DEPTH_BITS, 0);
+    glfwWindowHint (GLFW_STENCIL_BITS, 0);
     glfwWindowHint (GLFW_VISIBLE, GLFW_FALSE);
     // set X11-specific hints
     glfwWindowHintString (GLFW_X11_CLASS_NAME, "linux-wallpaperengine debug window");
@@ -111,7 +114,7 @@ void TestingOpenGLDriver::dispatchEventQueue () {
     // get the start time of the frame
     startTime = this->getRenderTime ();
     // clear the screen
-    glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClear (GL_COLOR_BUFFER_BIT);
 
     for (const auto& [screen, viewport] : this->m_output->getViewports ())
         this->getApp ().update (viewport);
@@ -0,0 +1,210 @@
+#include "JobPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "WallpaperEngine/Logging/Log.h"
+
+using namespace WallpaperEngine::Threading;
+
+std::unique_ptr<JobPool> JobPool::sInstance = nullptr;
+JobPool::Priority JobPool::sPriority = Priority_Normal;
+
+namespace {
+/** queue owned by the current thread, only set on worker threads */
+thread_local int32_t tlsWorkerQueue = -1;
+
+/** glibc has no wrapper for ioprio_set, these come from linux/ioprio.h */
+constexpr int IOPRIO_WHO_PROCESS = 1;
+constexpr int IOPRIO_CLASS_SHIFT = 13;
+constexpr int IOPRIO_CLASS_BE = 2;
+constexpr int IOPRIO_CLASS_IDLE = 3;
+/** niceness Priority_Low adds to the one the process already has */
+constexpr int LOW_NICE = 10;
+
+/**
+ * Lowers the priority of the calling thread, Linux schedules threads on their own so the rest of the process
+ * keeps its own
+ *
+ * @return If both the CPU and I/O priorities could be changed
+ */
+bool applyPriority (const JobPool::Priority priority) {
+    const auto thread = static_cast<id_t> (syscall (SYS_gettid));
+    bool applied;
+    int ioprio;
+
+    if (priority == JobPool::Priority_Idle) {
+        constexpr sched_param param = {.sched_priority = 0};
+
+        applied = pthread_setschedparam (pthread_self (), SCHED_IDLE, &param) == 0;
+        ioprio = IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT;
+    } else {
+        errno = 0;
+
+        // -1 is a valid niceness, errno tells it apart from a failure
+        const int current = getpriority (PRIO_PROCESS, thread);
+
+        applied = errno == 0 && setpriority (PRIO_PROCESS, thread, std::min (current + LOW_NICE, 19)) == 0;
+        // best-effort class, lowest of its 8 levels
+        ioprio = IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT | 7;
+    }
+
+    return syscall (SYS_ioprio_set, IOPRIO_WHO_PROCESS, thread, ioprio) == 0 && applied;
+}
+} // namespace
+
+JobPool::JobPool (const uint32_t threads, const Priority priority) {
+    for (uint32_t i = 0; i <= threads; i++)
+        this->m_queues.push_back (std::make_unique<Queue> ());
+
+    for (uint32_t i = 0; i < threads; i++)
+        this->m_workers.emplace_back (&JobPool::workerMain, this, i, priority);
+}
+
+JobPool::~JobPool () {
+    {
+        std::lock_guard lock (this->m_sleepMutex);
+        this->m_stop = true;
+    }
+
+    this->m_wake.notify_all ();
+
+    for (auto& worker : this->m_workers)
+        worker.join ();
+}
+
+void JobPool::submit (Group& group, Job job) {
+    const uint32_t queue = tlsWorkerQueue >= 0
+        ? static_cast<uint32_t> (tlsWorkerQueue)
+        : this->m_nextQueue.fetch_add (1, std::memory_order_relaxed) % this->m_queues.size ();
+
+    group.m_pending.fetch_add (1, std::memory_order_relaxed);
+
+    {
+        // taken so a worker that just found nothing to do can't miss this wake up
+        std::lock_guard lock (this->m_sleepMutex);
+        this->m_queued.fetch_add (1, std::memory_order_release);
+    }
+
+    {
+        std::lock_guard lock (this->m_queues [queue]->mutex);
+        this->m_queues [queue]->entries.push_back ({&group, std::move (job)});
+    }
+
+    this->m_wake.notify_one ();
+}
+
+void JobPool::wait (Group& group) {
+    const uint32_t queue = tlsWorkerQueue >= 0 ? static_cast<uint32_t> (tlsWorkerQueue) : this->m_workers.size ();
+
+    while (group.m_pending.load (std::memory_order_acquire) > 0) {
+        // jobs of this group might already be running elsewhere, keep the core busy meanwhile
+        if (!this->runNext (queue))
+            std::this_thread::yield ();
+    }
+}
+
+void JobPool::parallelFor (const uint32_t count, const uint32_t grainSize, const RangeJob& job) {
+    const uint32_t grain = std::max (grainSize, 1u);
+
+    if (count <= grain || this->m_workers.empty ()) {
+        job (0, count);
+        return;
+    }
+
+    Group group;
+
+    for (uint32_t begin = 0; begin < count; begin += grain) {
+        const uint32_t end = std::min (begin + grain, count);
+
+        this->submit (group, [&job, begin, end] () { job (begin, end); });
+    }
+
+    this->wait (group);
+}
+
+uint32_t JobPool::getThreadCount () const {
+    return this->m_workers.size ();
+}
+
+JobPool& JobPool::get () {
+    if (sInstance == nullptr) {
+        // the thread using the pool works on jobs too while waiting
+        const uint32_t cores = std::thread::hardware_concurrency ();
+
+        sInstance = std::make_unique<JobPool> (cores > 1 ? cores - 1 : 0, sPriority);
+    }
+
+    return *sInstance;
+}
+
+void JobPool::setPriority (const Priority priority) {
+    sPriority = priority;
+}
+
+void JobPool::workerMain (const uint32_t index, const Priority priority) {
+    tlsWorkerQueue = static_cast<int32_t> (index);
+
+    // every worker fails the same way, once in the log is enough
+    if (priority != Priority_Normal && !applyPriority (priority) && index == 0)
+        sLog.error ("Cannot lower the priority of the worker threads: ", strerror (errno));
+
+    while (true) {
+        if (this->runNext (index))
+            continue;
+
+        std::unique_lock lock (this->m_sleepMutex);
+
+        this->m_wake.wait (lock, [this] () {
+            return this->m_stop || this->m_queued.load (std::memory_order_acquire) > 0;
+        });
+
+        if (this->m_stop)
+            return;
+    }
+}
+
+bool JobPool::runNext (const uint32_t queue) {
+    Entry entry;
+    bool found = false;
+
+    // own queue first, newest job as it's the most likely to be in cache
+    {
+        auto& own = *this->m_queues [queue];
+        std::lock_guard lock (own.mutex);
+
+        if (!own.entries.empty ()) {
+            entry = std::move (own.entries.back ());
+            own.entries.pop_back ();
+            found = true;
+        }
+    }
+
+    // otherwise steal the oldest job from someone else
+    for (size_t i = 1; !found && i < this->m_queues.size (); i++) {
+        auto& victim = *this->m_queues [(queue + i) % this->m_queues.size ()];
+        std::lock_guard lock (victim.mutex);
+
+        if (!victim.entries.empty ()) {
+            entry = std::move (victim.entries.front ());
+            victim.entries.pop_front ();
+            found = true;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    this->m_queued.fetch_sub (1, std::memory_order_relaxed);
+    entry.job ();
+    entry.group->m_pending.fetch_sub (1, std::memory_order_acq_rel);
+
+    return true;
+}
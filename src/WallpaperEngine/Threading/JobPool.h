@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WallpaperEngine::Threading {
+/**
+ * Work-stealing thread pool for short CPU-only jobs
+ *
+ * Every worker owns a queue, jobs submitted from a worker go to its own queue and are taken LIFO, idle
+ * workers steal FIFO from the others. Threads waiting on a group run queued jobs instead of blocking,
+ * so jobs can submit and wait on nested jobs without starving the pool
+ */
+class JobPool {
+  public:
+    using Job = std::function<void ()>;
+    using RangeJob = std::function<void (uint32_t begin, uint32_t end)>;
+
+    /**
+     * How the workers are scheduled against everything else running on the system, the threads waiting on groups
+     * (like the render thread) keep their own
+     */
+    enum Priority {
+        /** same as the thread that created the pool */
+        Priority_Normal = 0,
+        /** nice 10 and the lowest best-effort I/O priority */
+        Priority_Low = 1,
+        /** only gets the CPU and disk when nothing else wants them (SCHED_IDLE and the idle I/O class) */
+        Priority_Idle = 2
+    };
+
+    /**
+     * Set of jobs that can be waited on together
+     */
+    class Group {
+        friend class JobPool;
+
+        std::atomic<uint32_t> m_pending {0};
+
+      public:
+        /** @return If every job submitted to the group finished, without running any of them */
+        [[nodiscard]] bool isDone () const {
+            return this->m_pending.load (std::memory_order_acquire) == 0;
+        }
+    };
+
+    /**
+     * @param threads Worker threads to start, the thread calling wait () also runs jobs
+     * @param priority
+     */
+    explicit JobPool (uint32_t threads, Priority priority = Priority_Normal);
+    ~JobPool ();
+
+    JobPool (const JobPool&) = delete;
+    JobPool& operator= (const JobPool&) = delete;
+
+    void submit (Group& group, Job job);
+
+    /**
+     * Runs queued jobs until every job in the group finished
+     *
+     * @param group
+     */
+    void wait (Group& group);
+
+    /**
+     * Splits [0, count) in ranges of grainSize and runs them in parallel, returns once all of them are done
+     *
+     * @param count
+     * @param grainSize
+     * @param job
+     */
+    void parallelFor (uint32_t count, uint32_t grainSize, const RangeJob& job);
+
+    [[nodiscard]] uint32_t getThreadCount () const;
+
+    static JobPool& get ();
+    /**
+     * Sets the priority of the shared pool's workers, only works before its first use
+     *
+     * @param priority
+     */
+    static void setPriority (Priority priority);
+
+  private:
+    struct Entry {
+        Group* group = nullptr;
+        Job job;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Entry> entries;
+    };
+
+    void workerMain (uint32_t index, Priority priority);
+    /**
+     * Runs one job, taken from the given queue or stolen from any other
+     *
+     * @return If a job was run
+     */
+    bool runNext (uint32_t queue);
+
+    /** one queue per worker plus one shared by every other thread */
+    std::vector<std::unique_ptr<Queue>> m_queues = {};
+    std::vector<std::thread> m_workers = {};
+    std::atomic<uint32_t> m_queued {0};
+    std::atomic<uint32_t> m_nextQueue {0};
+    std::atomic<bool> m_stop {false};
+    std::mutex m_sleepMutex = {};
+    std::condition_variable m_wake = {};
+
+    static std::unique_ptr<JobPool> sInstance;
+    static Priority sPriority;
+};
+} // namespace WallpaperEngine::Threading
+
+#define sJobPool (WallpaperEngine::Threading::JobPool::get ())
@@ -1,5 +1,10 @@
 #include "BrowserClient.h"
 
+#include <chrono>
+
+#include "RenderProcessHandler.h"
+#include "WallpaperEngine/Logging/Log.h"
+
 using namespace WallpaperEngine::WebBrowser::CEF;
 
 BrowserClient::BrowserClient(CefRefPtr<CefRenderHandler> ptr) :
@@ -7,4 +12,76 @@ BrowserClient::BrowserClient(CefRefPtr<CefRenderHandler> ptr) :
 
 CefRefPtr<CefRenderHandler> BrowserClient::GetRenderHandler() {
     return m_renderHandler;
-}
\ No newline at end of file
+}
+
+CefRefPtr<CefLifeSpanHandler> BrowserClient::GetLifeSpanHandler() {
+    return this;
+}
+
+bool BrowserClient::OnProcessMessageReceived(
+    CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, CefProcessId source_process,
+    CefRefPtr<CefProcessMessage> message
+) {
+    if (message->GetName() != RenderProcessHandler::AUDIO_LISTENER_MESSAGE)
+        return false;
+
+    this->m_audioListener = message->GetArgumentList()->GetBool(0);
+    return true;
+}
+
+void BrowserClient::OnAfterCreated(CefRefPtr<CefBrowser> browser) {
+    bool closing;
+
+    {
+        std::lock_guard lock(this->m_mutex);
+
+        this->m_browser = browser;
+        closing = this->m_closing;
+    }
+
+    // the wallpaper went away before the browser was ready, closing might call OnBeforeClose right away
+    if (closing)
+        browser->GetHost()->CloseBrowser(true);
+}
+
+void BrowserClient::OnBeforeClose(CefRefPtr<CefBrowser> browser) {
+    {
+        std::lock_guard lock(this->m_mutex);
+
+        this->m_browser = nullptr;
+        this->m_closed = true;
+    }
+
+    this->m_closedCondition.notify_all();
+}
+
+CefRefPtr<CefBrowser> BrowserClient::getBrowser() {
+    std::lock_guard lock(this->m_mutex);
+
+    return this->m_closing ? nullptr : this->m_browser;
+}
+
+bool BrowserClient::hasAudioListener() const {
+    return this->m_audioListener;
+}
+
+void BrowserClient::close() {
+    CefRefPtr<CefBrowser> browser;
+
+    {
+        std::lock_guard lock(this->m_mutex);
+
+        this->m_closing = true;
+        browser = this->m_browser;
+    }
+
+    // otherwise OnAfterCreated closes it
+    if (browser != nullptr)
+        browser->GetHost()->CloseBrowser(true);
+
+    std::unique_lock lock(this->m_mutex);
+
+    // CefShutdown () expects every browser to be closed, a stuck page shouldn't hang the exit either
+    if (!this->m_closedCondition.wait_for(lock, std::chrono::seconds(5), [this] { return this->m_closed; }))
+        sLog.error("Timed out waiting for the web background's browser to close");
+}
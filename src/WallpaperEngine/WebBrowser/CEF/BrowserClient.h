@@ -1,21 +1,54 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 #include "include/cef_client.h"
 
 namespace WallpaperEngine::WebBrowser::CEF {
 // *************************************************************************
 //! \brief Provide access to browser-instance-specific callbacks. A single
 //! CefClient instance can be shared among any number of browsers.
+//!
+//! Browsers are created asynchronously on CEF's UI thread, the client keeps
+//! track of the browser so the render thread can get to it once it's there.
 // *************************************************************************
-class BrowserClient: public CefClient
+class BrowserClient: public CefClient, public CefLifeSpanHandler
 {
   public:
     explicit BrowserClient(CefRefPtr<CefRenderHandler> ptr);
 
     [[nodiscard]] CefRefPtr<CefRenderHandler> GetRenderHandler() override;
+    [[nodiscard]] CefRefPtr<CefLifeSpanHandler> GetLifeSpanHandler() override;
+
+    //! \brief CefClient interface
+    //! Keeps track of the page registering an audio listener (see RenderProcessHandler).
+    bool OnProcessMessageReceived(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
+                                  CefProcessId source_process, CefRefPtr<CefProcessMessage> message) override;
+
+    //! \brief CefLifeSpanHandler interface
+    void OnAfterCreated(CefRefPtr<CefBrowser> browser) override;
+    //! \brief CefLifeSpanHandler interface
+    void OnBeforeClose(CefRefPtr<CefBrowser> browser) override;
+
+    //! \brief The browser, nullptr until CEF is done creating it
+    [[nodiscard]] CefRefPtr<CefBrowser> getBrowser();
+    //! \brief If the page wants the audio spectrum, can be called from any thread
+    [[nodiscard]] bool hasAudioListener() const;
+    //! \brief Closes the browser (even if it's still being created) and waits for it to be gone
+    void close();
 
     CefRefPtr<CefRenderHandler> m_renderHandler = nullptr;
 
     IMPLEMENT_REFCOUNTING(BrowserClient);
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_closedCondition;
+    CefRefPtr<CefBrowser> m_browser = nullptr;
+    bool m_closing = false;
+    bool m_closed = false;
+    std::atomic<bool> m_audioListener = false;
 };
-} // namespace WallpaperEngine::WebBrowser::CEF
\ No newline at end of file
+} // namespace WallpaperEngine::WebBrowser::CEF
@@ -1,32 +1,360 @@
 #include "RenderHandler.h"
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Render/GPUResources.h"
+
+#ifdef ENABLE_WAYLAND
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif /* ENABLE_WAYLAND */
+
 using namespace WallpaperEngine::WebBrowser::CEF;
 
+#ifdef ENABLE_WAYLAND
+namespace {
+using EGLImageTargetTexture2DOES = void (*) (GLenum target, void* image);
+
+constexpr uint32_t fourcc (const char a, const char b, const char c, const char d) {
+    return static_cast<uint32_t> (a) | static_cast<uint32_t> (b) << 8 | static_cast<uint32_t> (c) << 16 |
+           static_cast<uint32_t> (d) << 24;
+}
+
+/** DRM_FORMAT_ARGB8888 and DRM_FORMAT_ABGR8888, the byte order of BGRA and RGBA frames */
+constexpr uint32_t DRM_FORMAT_BGRA = fourcc ('A', 'R', '2', '4');
+constexpr uint32_t DRM_FORMAT_RGBA = fourcc ('A', 'B', '2', '4');
+/** DRM_FORMAT_MOD_INVALID, the buffer has no explicit modifier */
+constexpr uint64_t DRM_MODIFIER_INVALID = 0x00ffffffffffffffull;
+
+constexpr EGLint PLANE_ATTRIBUTES [][5] = {
+    {EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT, EGL_DMA_BUF_PLANE0_PITCH_EXT,
+     EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT},
+    {EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT, EGL_DMA_BUF_PLANE1_PITCH_EXT,
+     EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT},
+    {EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE2_OFFSET_EXT, EGL_DMA_BUF_PLANE2_PITCH_EXT,
+     EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT},
+    {EGL_DMA_BUF_PLANE3_FD_EXT, EGL_DMA_BUF_PLANE3_OFFSET_EXT, EGL_DMA_BUF_PLANE3_PITCH_EXT,
+     EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT},
+};
+} // namespace
+#endif /* ENABLE_WAYLAND */
+
 RenderHandler::RenderHandler (WallpaperEngine::Render::Wallpapers::CWeb* webdata) :
-    m_webdata (webdata) {}
+    m_webdata (webdata),
+    m_width (webdata->getWidth ()),
+    m_height (webdata->getHeight ()) {}
+
+RenderHandler::~RenderHandler () {
+    closeFrame (this->m_pendingFrame);
+
+    sGPUResources.remove (this);
+
+    if (this->m_pixelBuffer != 0)
+        glDeleteBuffers (1, &this->m_pixelBuffer);
+    if (this->m_importFramebuffer != 0)
+        glDeleteFramebuffers (1, &this->m_importFramebuffer);
+    if (this->m_importTexture != 0)
+        glDeleteTextures (1, &this->m_importTexture);
+}
 
 // Required by CEF
 void RenderHandler::GetViewRect (CefRefPtr<CefBrowser> browser, CefRect& rect) {
-    rect = CefRect (0, 0, this->m_webdata->getWidth (), this->m_webdata->getHeight ());
+    std::lock_guard lock (this->m_mutex);
+
+    // CEF doesn't take empty views
+    rect = CefRect (0, 0, std::max (this->m_width, 1), std::max (this->m_height, 1));
 }
 
-// Will be executed in CEF message loop
+// Will be executed in CEF's UI thread
 void RenderHandler::OnPaint (CefRefPtr<CefBrowser> browser, PaintElementType type, const RectList& dirtyRects,
                                    const void* buffer, const int width, const int height) {
+    // popups (like <select> lists) would need a texture of their own
+    if (type != PET_VIEW)
+        return;
+
+    const WallpaperEngine::Render::Drivers::VideoDriver* driver;
+
+    {
+        std::lock_guard lock (this->m_mutex);
+
+        // painted before the last resize, the texture is already the new size and a paint for that one is on its way
+        if (this->m_webdata == nullptr || width != this->m_width || height != this->m_height)
+            return;
+
+        driver = &this->m_webdata->getContext ().getDriver ();
+
+        const size_t size = static_cast<size_t> (width) * height * 4;
+        const auto* source = static_cast<const uint8_t*> (buffer);
+
+        if (this->m_pixels.size () != size) {
+            // a new size invalidates everything painted before
+            this->m_pixels.assign (source, source + size);
+            this->m_dirtyRects = {CefRect (0, 0, width, height)};
+        } else {
+            // the rectangles keep the layout of the full buffer so the texture uploads can use it as it is
+            for (const CefRect& rect : dirtyRects) {
+                for (int y = rect.y; y < rect.y + rect.height; y++) {
+                    const size_t offset = (static_cast<size_t> (y) * width + rect.x) * 4;
+
+                    memcpy (this->m_pixels.data () + offset, source + offset, static_cast<size_t> (rect.width) * 4);
+                }
+
+                this->m_dirtyRects.push_back (rect);
+            }
+        }
+    }
+
+    // only once the lock is gone, upload () doesn't wait for it and would miss the paint otherwise
+    driver->wakeUp ();
+}
+
+// Will be executed in CEF's UI thread
+void RenderHandler::OnAcceleratedPaint (CefRefPtr<CefBrowser> browser, PaintElementType type,
+                                        const RectList& dirtyRects, const CefAcceleratedPaintInfo& info) {
+    if (type != PET_VIEW)
+        return;
+
+    std::unique_lock lock (this->m_mutex);
+
+    if (this->m_webdata == nullptr || this->m_importFailed)
+        return;
+
+    const auto* driver = &this->m_webdata->getContext ().getDriver ();
+
+    // the render thread didn't get to the last one, only the newest frame matters
+    closeFrame (this->m_pendingFrame);
+
+    AcceleratedFrame& frame = this->m_pendingFrame;
+
+    // the fds are closed by CEF once this returns, the import happens later on the render thread
+    frame.planes = std::min<int> (info.plane_count, frame.fds.size ());
+    frame.modifier = info.modifier;
+    frame.format = info.format;
+    frame.width = this->m_width;
+    frame.height = this->m_height;
+
+    for (int i = 0; i < frame.planes; i++) {
+        frame.fds [i] = dup (info.planes [i].fd);
+        frame.offsets [i] = info.planes [i].offset;
+        frame.strides [i] = info.planes [i].stride;
+    }
+
+    this->m_hasPendingFrame = true;
+    lock.unlock ();
+    driver->wakeUp ();
+}
+
+bool RenderHandler::upload () {
+    AcceleratedFrame frame;
+    bool painted = false;
+
+    {
+        std::unique_lock lock (this->m_mutex, std::try_to_lock);
+
+        // CEF is copying a paint in, it wakes the render loop up once it's done and the next frame takes it
+        //  waiting here would hold up every other screen for as long as the copy takes
+        if (!lock.owns_lock ())
+            return false;
+
+        if (!this->m_dirtyRects.empty ()) {
+            this->uploadPixels ();
+            painted = true;
+        }
+
+        if (this->m_hasPendingFrame) {
+            std::swap (frame, this->m_pendingFrame);
+            this->m_hasPendingFrame = false;
+        }
+    }
+
+    // importing doesn't touch anything CEF's thread uses, it can paint the next frame meanwhile
+    if (frame.planes > 0) {
+        this->importFrame (frame);
+        closeFrame (frame);
+        painted = true;
+    }
+
+    return painted;
+}
+
+void RenderHandler::setSize (const int width, const int height) {
+    std::lock_guard lock (this->m_mutex);
+
+    this->m_width = width;
+    this->m_height = height;
+    // whatever was painted at the old size doesn't fit the texture anymore
+    this->m_dirtyRects.clear ();
+    this->m_pixels.clear ();
+    closeFrame (this->m_pendingFrame);
+    this->m_hasPendingFrame = false;
+}
+
+void RenderHandler::detach () {
+    std::lock_guard lock (this->m_mutex);
+
+    this->m_webdata = nullptr;
+}
+
+void RenderHandler::uploadPixels () {
+    const size_t size = this->m_pixels.size ();
+
+    if (this->m_pixelBuffer == 0)
+        glGenBuffers (1, &this->m_pixelBuffer);
+
+    glBindBuffer (GL_PIXEL_UNPACK_BUFFER, this->m_pixelBuffer);
+
+    if (size != this->m_pixelBufferSize) {
+        glBufferData (GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        this->m_pixelBufferSize = size;
+        sGPUResources.add (this, WallpaperEngine::Render::GPUResources::Type_Buffer, size, "web page upload");
+    }
+
+    // invalidating lets the driver hand out new memory while the last paint is still being uploaded
+    auto* pixels = static_cast<uint8_t*> (
+        glMapBufferRange (GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+    if (pixels == nullptr) {
+        glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+        return;
+    }
+
+    for (const CefRect& rect : this->m_dirtyRects) {
+        for (int y = rect.y; y < rect.y + rect.height; y++) {
+            const size_t offset = (static_cast<size_t> (y) * this->m_width + rect.x) * 4;
+
+            memcpy (pixels + offset, this->m_pixels.data () + offset, static_cast<size_t> (rect.width) * 4);
+        }
+    }
+
+    glUnmapBuffer (GL_PIXEL_UNPACK_BUFFER);
+
     glActiveTexture (GL_TEXTURE0);
     glBindTexture (GL_TEXTURE_2D, this->texture ());
-    glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_BGRA_EXT, GL_UNSIGNED_BYTE, buffer);
+    glPixelStorei (GL_UNPACK_ROW_LENGTH, this->m_width);
+
+    for (const CefRect& rect : this->m_dirtyRects) {
+        const size_t offset = (static_cast<size_t> (rect.y) * this->m_width + rect.x) * 4;
+
+        // with an unpack buffer bound the pointer is an offset into it
+        glTexSubImage2D (GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, GL_BGRA, GL_UNSIGNED_BYTE,
+                         reinterpret_cast<const void*> (offset));
+    }
+
+    glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
     glBindTexture (GL_TEXTURE_2D, 0);
+    glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+
+    this->m_dirtyRects.clear ();
 }
 
-int RenderHandler::getWidth() const {
-    return this->m_webdata->getWidth ();
+void RenderHandler::importFrame (const AcceleratedFrame& frame) {
+#ifdef ENABLE_WAYLAND
+    // the browser was resized after this one was painted
+    if (frame.width != this->m_webdata->getWidth () || frame.height != this->m_webdata->getHeight ())
+        return;
+
+    const EGLDisplay display = eglGetCurrentDisplay ();
+    const auto imageTargetTexture =
+        reinterpret_cast<EGLImageTargetTexture2DOES> (eglGetProcAddress ("glEGLImageTargetTexture2DOES"));
+    std::vector<EGLint> attributes = {
+        EGL_WIDTH, frame.width,
+        EGL_HEIGHT, frame.height,
+        EGL_LINUX_DRM_FOURCC_EXT,
+        static_cast<EGLint> (frame.format == CEF_COLOR_TYPE_RGBA_8888 ? DRM_FORMAT_RGBA : DRM_FORMAT_BGRA),
+    };
+
+    for (int i = 0; i < frame.planes; i++) {
+        const auto& plane = PLANE_ATTRIBUTES [i];
+
+        attributes.insert (attributes.end (), {
+            plane [0], frame.fds [i],
+            plane [1], static_cast<EGLint> (frame.offsets [i]),
+            plane [2], static_cast<EGLint> (frame.strides [i]),
+        });
+
+        if (frame.modifier != DRM_MODIFIER_INVALID) {
+            attributes.insert (attributes.end (), {
+                plane [3], static_cast<EGLint> (frame.modifier & 0xffffffff),
+                plane [4], static_cast<EGLint> (frame.modifier >> 32),
+            });
+        }
+    }
+
+    attributes.push_back (EGL_NONE);
+
+    const auto createImage = reinterpret_cast<PFNEGLCREATEIMAGEKHRPROC> (eglGetProcAddress ("eglCreateImageKHR"));
+    const auto destroyImage = reinterpret_cast<PFNEGLDESTROYIMAGEKHRPROC> (eglGetProcAddress ("eglDestroyImageKHR"));
+    const EGLImageKHR image = createImage == nullptr || destroyImage == nullptr || imageTargetTexture == nullptr
+                                  ? EGL_NO_IMAGE_KHR
+                                  : createImage (display, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr,
+                                                 attributes.data ());
+
+    if (image == EGL_NO_IMAGE_KHR) {
+        sLog.error ("Cannot import the web background's frame, EGL error ", eglGetError (),
+                    ". Run without --accelerated-web-paint");
+
+        std::lock_guard lock (this->m_mutex);
+        this->m_importFailed = true;
+        return;
+    }
+
+    if (this->m_importTexture == 0) {
+        glGenTextures (1, &this->m_importTexture);
+        glGenFramebuffers (1, &this->m_importFramebuffer);
+    }
+
+    glBindTexture (GL_TEXTURE_2D, this->m_importTexture);
+    imageTargetTexture (GL_TEXTURE_2D, image);
+    glBindTexture (GL_TEXTURE_2D, 0);
+
+    // Chromium reuses its buffers, so the frame is copied out instead of being kept around
+    glBindFramebuffer (GL_READ_FRAMEBUFFER, this->m_importFramebuffer);
+    glFramebufferTexture2D (GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->m_importTexture, 0);
+    glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->m_webdata->getWallpaperFramebuffer ());
+    glBlitFramebuffer (0, 0, frame.width, frame.height, 0, 0, frame.width, frame.height, GL_COLOR_BUFFER_BIT,
+                       GL_NEAREST);
+    // CWeb::renderFrame () left the wallpaper's framebuffer bound for both
+    glBindFramebuffer (GL_FRAMEBUFFER, this->m_webdata->getWallpaperFramebuffer ());
+
+    destroyImage (display, image);
+#endif /* ENABLE_WAYLAND */
+}
+
+void RenderHandler::closeFrame (AcceleratedFrame& frame) {
+    for (int& fd : frame.fds) {
+        if (fd != -1)
+            close (fd);
+
+        fd = -1;
+    }
+
+    frame.planes = 0;
 }
 
-int RenderHandler::getHeight() const {
-    return this->m_webdata->getHeight ();
+bool RenderHandler::supportsAcceleratedPaint () {
+#ifdef ENABLE_WAYLAND
+    const EGLDisplay display = eglGetCurrentDisplay ();
+
+    // GLX contexts (X11) have no way to take a dmabuf
+    if (display == EGL_NO_DISPLAY)
+        return false;
+
+    const char* extensions = eglQueryString (display, EGL_EXTENSIONS);
+
+    return extensions != nullptr &&
+           std::string (extensions).find ("EGL_EXT_image_dma_buf_import") != std::string::npos &&
+           eglGetProcAddress ("glEGLImageTargetTexture2DOES") != nullptr;
+#else
+    return false;
+#endif /* ENABLE_WAYLAND */
 }
 
 GLuint RenderHandler::texture () const {
-    return this->m_webdata->getWallpaperFramebuffer();
-}
\ No newline at end of file
+    // the texture CWeb::setSize () keeps at the browser's size
+    return this->m_webdata->getWallpaperTexture ();
+}
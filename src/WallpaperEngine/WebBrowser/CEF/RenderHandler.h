@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <mutex>
+#include <vector>
+
 #include "WallpaperEngine/Render/Wallpapers/CWeb.h"
 #include "include/cef_browser.h"
 
@@ -10,32 +14,94 @@ class CWeb;
 namespace WallpaperEngine::WebBrowser::CEF {
 // *************************************************************************
 //! \brief Private implementation to handle CEF events to draw the web page.
+//!
+//! CEF runs its own message loop, so the paints arrive on CEF's UI thread.
+//! They're only copied there, upload () puts them in the OpenGL texture on
+//! the render thread.
 // *************************************************************************
 class RenderHandler : public CefRenderHandler {
   public:
     explicit RenderHandler (WallpaperEngine::Render::Wallpapers::CWeb* webdata);
 
-    //! \brief
-    ~RenderHandler () override = default;
+    //! \brief Releases the pixel buffer the paints go through
+    ~RenderHandler () override;
 
     //! \brief CefRenderHandler interface
     void GetViewRect (CefRefPtr<CefBrowser> browser, CefRect& rect) override;
 
     //! \brief CefRenderHandler interface
-    //! Update the OpenGL texture.
+    //! Keeps a copy of the dirty rectangles for the next upload ().
     void OnPaint (CefRefPtr<CefBrowser> browser, PaintElementType type, const RectList& dirtyRects, const void* buffer,
                   int width, int height) override;
 
+    //! \brief CefRenderHandler interface
+    //! Keeps the dmabuf Chromium painted on the GPU for the next upload () to import.
+    void OnAcceleratedPaint (CefRefPtr<CefBrowser> browser, PaintElementType type, const RectList& dirtyRects,
+                             const CefAcceleratedPaintInfo& info) override;
+
+    //! \brief If the current context can import dmabufs, so browsers can be created with shared textures
+    [[nodiscard]] static bool supportsAcceleratedPaint ();
+
+    //! \brief Puts whatever was painted since the last call in the OpenGL texture, has to run on the render thread
+    //! \return If anything was painted
+    bool upload ();
+
+    //! \brief Size the page is laid out at from now on, the texture must already have it
+    void setSize (int width, int height);
+
+    //! \brief Stops using the wallpaper, CEF might still paint a closing browser after it's gone
+    void detach ();
+
     //! \brief CefBase interface
     IMPLEMENT_REFCOUNTING (RenderHandler);
 
   private:
-    WallpaperEngine::Render::Wallpapers::CWeb* m_webdata = nullptr;
+    //! \brief A dmabuf frame waiting to be imported, the fds are duplicates owned by it
+    struct AcceleratedFrame {
+        std::array<int, 4> fds = {-1, -1, -1, -1};
+        std::array<uint32_t, 4> offsets = {};
+        std::array<uint32_t, 4> strides = {};
+        int planes = 0;
+        uint64_t modifier = 0;
+        cef_color_type_t format = CEF_COLOR_TYPE_BGRA_8888;
+        int width = 0;
+        int height = 0;
+    };
 
-    [[nodiscard]] int getWidth () const;
-    [[nodiscard]] int getHeight () const;
+    WallpaperEngine::Render::Wallpapers::CWeb* m_webdata = nullptr;
 
     //! \brief Return the OpenGL texture handle
     [[nodiscard]] GLuint texture () const;
+
+    //! \brief Uploads the pending dirty rectangles of the software paints, m_mutex must be held
+    void uploadPixels ();
+    //! \brief Imports the frame and copies it into the OpenGL texture
+    void importFrame (const AcceleratedFrame& frame);
+    //! \brief Closes the duplicated fds of the frame
+    static void closeFrame (AcceleratedFrame& frame);
+
+    //! \brief Guards everything shared between CEF's UI thread and the render thread
+    std::mutex m_mutex;
+    //! \brief Size of the page, shared with CEF's UI thread
+    int m_width = 0;
+    int m_height = 0;
+    //! \brief The page as of the last software paint, only the dirty rectangles are kept up to date
+    std::vector<uint8_t> m_pixels;
+    //! \brief Rectangles painted since the last upload ()
+    std::vector<CefRect> m_dirtyRects;
+    //! \brief Latest accelerated paint not imported yet, older ones are dropped
+    AcceleratedFrame m_pendingFrame;
+    bool m_hasPendingFrame = false;
+
+    //! \brief Pixel unpack buffer the dirty rectangles are copied to, so the driver uploads them on its own time
+    GLuint m_pixelBuffer = 0;
+    //! \brief Size the pixel buffer was allocated with, 0 while there's none
+    size_t m_pixelBufferSize = 0;
+    //! \brief Texture the dmabufs of accelerated paints are bound to
+    GLuint m_importTexture = 0;
+    //! \brief Framebuffer the imported texture is blitted from
+    GLuint m_importFramebuffer = 0;
+    //! \brief Set once a dmabuf couldn't be imported, so the error is logged only once
+    bool m_importFailed = false;
 };
-} // namespace WallpaperEngine::WebBrowser::CEF
\ No newline at end of file
+} // namespace WallpaperEngine::WebBrowser::CEF
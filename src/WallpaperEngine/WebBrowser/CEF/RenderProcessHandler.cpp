@@ -0,0 +1,102 @@
+#include "RenderProcessHandler.h"
+
+using namespace WallpaperEngine::WebBrowser::CEF;
+
+RenderProcessHandler::RegisterAudioListener::RegisterAudioListener (RenderProcessHandler& handler, const int browser) :
+    m_handler (handler),
+    m_browser (browser) {}
+
+bool RenderProcessHandler::RegisterAudioListener::Execute (
+    const CefString& name, CefRefPtr<CefV8Value> object, const CefV8ValueList& arguments,
+    CefRefPtr<CefV8Value>& retval, CefString& exception
+) {
+    if (arguments.size () != 1 || !arguments [0]->IsFunction ()) {
+        exception = "wallpaperRegisterAudioListener expects a function";
+        return true;
+    }
+
+    const CefRefPtr<CefV8Context> context = CefV8Context::GetCurrentContext ();
+    const bool listening = this->m_handler.m_audioListeners.contains (this->m_browser);
+
+    // the same array is handed to the listener on every call, only its values change
+    const CefRefPtr<CefV8Value> samples = CefV8Value::CreateArray (AUDIO_SAMPLES);
+
+    for (int i = 0; i < AUDIO_SAMPLES; i++)
+        samples->SetValue (i, CefV8Value::CreateDouble (0.0));
+
+    this->m_handler.m_audioListeners [this->m_browser] = {
+        .context = context,
+        .callback = arguments [0],
+        .samples = samples,
+    };
+
+    if (!listening)
+        notifyListener (context->GetFrame (), true);
+
+    return true;
+}
+
+void RenderProcessHandler::OnContextCreated (
+    CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, CefRefPtr<CefV8Context> context
+) {
+    // the spectrum only goes to the page itself, not to whatever it embeds
+    if (!frame->IsMain ())
+        return;
+
+    const CefRefPtr<CefV8Handler> handler = new RegisterAudioListener (*this, browser->GetIdentifier ());
+
+    context->GetGlobal ()->SetValue (
+        "wallpaperRegisterAudioListener", CefV8Value::CreateFunction ("wallpaperRegisterAudioListener", handler),
+        V8_PROPERTY_ATTRIBUTE_READONLY);
+}
+
+void RenderProcessHandler::OnContextReleased (
+    CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, CefRefPtr<CefV8Context> context
+) {
+    const auto listener = this->m_audioListeners.find (browser->GetIdentifier ());
+
+    // navigating away drops the listener, the next page has to register its own
+    if (listener == this->m_audioListeners.end () || !listener->second.context->IsSame (context))
+        return;
+
+    this->m_audioListeners.erase (listener);
+    notifyListener (frame, false);
+}
+
+bool RenderProcessHandler::OnProcessMessageReceived (
+    CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, CefProcessId source_process,
+    CefRefPtr<CefProcessMessage> message
+) {
+    if (message->GetName () != AUDIO_SAMPLES_MESSAGE)
+        return false;
+
+    const auto listener = this->m_audioListeners.find (browser->GetIdentifier ());
+    const CefRefPtr<CefBinaryValue> binary = message->GetArgumentList ()->GetBinary (0);
+    float samples [AUDIO_SAMPLES];
+
+    // samples that were on their way while the page went away are of no use to anyone
+    if (listener == this->m_audioListeners.end () || binary == nullptr || binary->GetSize () != sizeof (samples))
+        return true;
+
+    binary->GetData (samples, sizeof (samples), 0);
+
+    const AudioListener& audio = listener->second;
+
+    if (!audio.context->Enter ())
+        return true;
+
+    for (int i = 0; i < AUDIO_SAMPLES; i++)
+        audio.samples->SetValue (i, CefV8Value::CreateDouble (samples [i]));
+
+    audio.callback->ExecuteFunction (nullptr, {audio.samples});
+    audio.context->Exit ();
+
+    return true;
+}
+
+void RenderProcessHandler::notifyListener (CefRefPtr<CefFrame> frame, const bool listening) {
+    const CefRefPtr<CefProcessMessage> message = CefProcessMessage::Create (AUDIO_LISTENER_MESSAGE);
+
+    message->GetArgumentList ()->SetBool (0, listening);
+    frame->SendProcessMessage (PID_BROWSER, message);
+}
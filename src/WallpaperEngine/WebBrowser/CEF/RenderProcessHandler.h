@@ -0,0 +1,69 @@
+#pragma once
+
+#include <map>
+
+#include "include/cef_render_process_handler.h"
+#include "include/cef_v8.h"
+
+namespace WallpaperEngine::WebBrowser::CEF {
+// *************************************************************************
+//! \brief Wallpaper Engine's JavaScript API, runs in the renderer processes.
+//!
+//! Pages get window.wallpaperRegisterAudioListener (), the browser process
+//! is told once a page registers a listener and only then starts sending
+//! the spectrum as a binary process message (see CWeb). Every message
+//! reuses the same JavaScript array, nothing is formatted or parsed.
+// *************************************************************************
+class RenderProcessHandler : public CefRenderProcessHandler {
+  public:
+    //! \brief Sent to the browser process with a bool, if the page has an audio listener now
+    static constexpr const char* AUDIO_LISTENER_MESSAGE = "wallpaperAudioListener";
+    //! \brief Sent to the renderer process with the spectrum as a binary value of AUDIO_SAMPLES floats
+    static constexpr const char* AUDIO_SAMPLES_MESSAGE = "wallpaperAudioSamples";
+    //! \brief 64 bands for the left channel followed by 64 for the right one, as Wallpaper Engine hands them out
+    static constexpr int AUDIO_SAMPLES = 128;
+
+    //! \brief CefRenderProcessHandler interface
+    void OnContextCreated (CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
+                           CefRefPtr<CefV8Context> context) override;
+    //! \brief CefRenderProcessHandler interface
+    void OnContextReleased (CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
+                            CefRefPtr<CefV8Context> context) override;
+    //! \brief CefRenderProcessHandler interface
+    bool OnProcessMessageReceived (CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame,
+                                   CefProcessId source_process, CefRefPtr<CefProcessMessage> message) override;
+
+    //! \brief CefBase interface
+    IMPLEMENT_REFCOUNTING (RenderProcessHandler);
+
+  private:
+    //! \brief The page's audio listener and the array it's called with
+    struct AudioListener {
+        CefRefPtr<CefV8Context> context;
+        CefRefPtr<CefV8Value> callback;
+        CefRefPtr<CefV8Value> samples;
+    };
+
+    //! \brief Implements window.wallpaperRegisterAudioListener () for one browser
+    class RegisterAudioListener : public CefV8Handler {
+      public:
+        RegisterAudioListener (RenderProcessHandler& handler, int browser);
+
+        //! \brief CefV8Handler interface
+        bool Execute (const CefString& name, CefRefPtr<CefV8Value> object, const CefV8ValueList& arguments,
+                      CefRefPtr<CefV8Value>& retval, CefString& exception) override;
+
+        IMPLEMENT_REFCOUNTING (RegisterAudioListener);
+
+      private:
+        RenderProcessHandler& m_handler;
+        int m_browser;
+    };
+
+    //! \brief Lets the browser process know if it has to send the spectrum to the browser
+    static void notifyListener (CefRefPtr<CefFrame> frame, bool listening);
+
+    //! \brief Listeners by browser identifier, only touched on the renderer's main thread
+    std::map<int, AudioListener> m_audioListeners = {};
+};
+} // namespace WallpaperEngine::WebBrowser::CEF
@@ -21,6 +21,11 @@ void SubprocessApp::OnRegisterCustomSchemes (CefRawPtr <CefSchemeRegistrar> regi
     }
 }
 
+CefRefPtr<CefRenderProcessHandler> SubprocessApp::GetRenderProcessHandler () {
+    // only used by the renderer processes, it's what gives the pages Wallpaper Engine's JavaScript API
+    return this->m_renderProcessHandler;
+}
+
 const WallpaperEngine::Application::WallpaperApplication& SubprocessApp::getApplication () const {
     return this->m_application;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "RenderProcessHandler.h"
 #include "WPSchemeHandlerFactory.h"
 #include "WallpaperEngine/WebBrowser/WebBrowserContext.h"
 #include "include/cef_app.h"
@@ -14,6 +15,7 @@ class SubprocessApp : public CefApp {
     explicit SubprocessApp (WallpaperEngine::Application::WallpaperApplication& application);
 
     void OnRegisterCustomSchemes (CefRawPtr <CefSchemeRegistrar> registrar) override;
+    [[nodiscard]] CefRefPtr<CefRenderProcessHandler> GetRenderProcessHandler () override;
 
   protected:
     const WallpaperEngine::Application::WallpaperApplication& getApplication () const;
@@ -21,6 +23,7 @@ class SubprocessApp : public CefApp {
 
   private:
     std::map<std::string, WPSchemeHandlerFactory*> m_handlerFactories = {};
+    CefRefPtr<RenderProcessHandler> m_renderProcessHandler = new RenderProcessHandler ();
     WallpaperEngine::Application::WallpaperApplication& m_application;
     IMPLEMENT_REFCOUNTING (SubprocessApp);
     DISALLOW_COPY_AND_ASSIGN (SubprocessApp);
@@ -1,11 +1,14 @@
 #include "WPSchemeHandler.h"
 #include "WallpaperEngine/Assets/AssetLoadException.h"
-#include <iostream>
+
+#include <algorithm>
+#include <charconv>
 
 #include "MimeTypes.h"
 #include "include/cef_parser.h"
 
 #include "WallpaperEngine/Data/Model/Project.h"
+#include "WallpaperEngine/Logging/Log.h"
 
 using namespace WallpaperEngine::WebBrowser::CEF;
 
@@ -19,9 +22,8 @@ bool WPSchemeHandler::Open(CefRefPtr<CefRequest> request,
                              CefRefPtr<CefCallback> callback) {
     DCHECK(!CefCurrentlyOn(TID_UI) && !CefCurrentlyOn(TID_IO));
 
-#if !NDEBUG
-    std::cout << "Processing request for path " << request->GetURL ().c_str () << std::endl;
-#endif
+    LOG_DEBUG ("Processing request for path ", request->GetURL ().ToString ());
+
     // url contains the full path, we need to get rid of the protocol
     // otherwise files won't be found
     CefURLParts parts;
@@ -45,12 +47,21 @@ bool WPSchemeHandler::Open(CefRefPtr<CefRequest> request,
             this->m_mimeType = mime;
         }
 
+        // the streams are views over the mapped files, opening them doesn't read anything yet
         this->m_contents = this->m_assetLoader.read (file);
-        callback->Continue ();
+        this->m_contents->seekg (0, std::ios::end);
+        this->m_size = this->m_contents->tellg ();
+        this->m_remaining = this->m_size;
+
+        if (const std::string range = request->GetHeaderByName ("Range"); !range.empty ()) {
+            this->m_rangeRequested = true;
+            this->m_rangeInvalid = !this->parseRange (range);
+        }
+
+        this->m_contents->seekg (this->m_rangeStart, std::ios::beg);
     } catch (AssetLoadException&) {
-#if !NDEBUG
-        std::cout << "Cannot read file " << file << std::endl;
-#endif
+        LOG_DEBUG ("Cannot read file ", file);
+        this->m_contents = nullptr;
     }
 
     handle_request = true;
@@ -58,6 +69,55 @@ bool WPSchemeHandler::Open(CefRefPtr<CefRequest> request,
     return true;
 }
 
+bool WPSchemeHandler::parseRange (const std::string& header) {
+    constexpr std::string_view prefix = "bytes=";
+
+    // multiple ranges would need a multipart response, media elements only ever ask for one
+    if (!header.starts_with (prefix) || header.find (',') != std::string::npos)
+        return false;
+
+    const std::string_view spec = std::string_view (header).substr (prefix.size ());
+    const size_t dash = spec.find ('-');
+
+    if (dash == std::string_view::npos)
+        return false;
+
+    const std::string_view first = spec.substr (0, dash);
+    const std::string_view last = spec.substr (dash + 1);
+    int64_t start = 0;
+    int64_t end = this->m_size - 1;
+
+    const auto parse = [] (const std::string_view value, int64_t& out) {
+        const auto [ptr, error] = std::from_chars (value.data (), value.data () + value.size (), out);
+
+        return error == std::errc () && ptr == value.data () + value.size ();
+    };
+
+    if (first.empty ()) {
+        // bytes=-N asks for the last N bytes
+        int64_t suffix = 0;
+
+        if (!parse (last, suffix) || suffix <= 0)
+            return false;
+
+        start = std::max<int64_t> (0, this->m_size - suffix);
+    } else {
+        if (!parse (first, start))
+            return false;
+        if (!last.empty () && !parse (last, end))
+            return false;
+
+        end = std::min (end, this->m_size - 1);
+    }
+
+    if (start >= this->m_size || start > end)
+        return false;
+
+    this->m_rangeStart = start;
+    this->m_remaining = end - start + 1;
+
+    return true;
+}
 
 void WPSchemeHandler::GetResponseHeaders(CefRefPtr<CefResponse> response,
                          int64_t& response_length,
@@ -72,34 +132,74 @@ void WPSchemeHandler::GetResponseHeaders(CefRefPtr<CefResponse> response,
     }
 
     response->SetMimeType (this->m_mimeType);
-    response->SetStatus (200);
+    response->SetHeaderByName ("Accept-Ranges", "bytes", true);
+
+    if (this->m_rangeInvalid) {
+        response->SetStatus (416);
+        response->SetStatusText ("Range Not Satisfiable");
+        response->SetHeaderByName ("Content-Range", "bytes */" + std::to_string (this->m_size), true);
+        response_length = 0;
+        this->m_remaining = 0;
+        return;
+    }
 
-    // signals an unknown-length file
-    response_length = -1;
+    if (this->m_rangeRequested) {
+        response->SetStatus (206);
+        response->SetStatusText ("Partial Content");
+        response->SetHeaderByName (
+            "Content-Range",
+            "bytes " + std::to_string (this->m_rangeStart) + "-" +
+                std::to_string (this->m_rangeStart + this->m_remaining - 1) + "/" + std::to_string (this->m_size),
+            true);
+    } else {
+        response->SetStatus (200);
+    }
+
+    // knowing the length lets media elements work out the duration and where to seek to
+    response_length = this->m_remaining;
 }
 
 void WPSchemeHandler::Cancel () {
     CEF_REQUIRE_IO_THREAD();
 }
 
+bool WPSchemeHandler::Skip(int64_t bytes_to_skip, int64_t& bytes_skipped,
+                             CefRefPtr<CefResourceSkipCallback> callback) {
+    DCHECK(!CefCurrentlyOn(TID_UI) && !CefCurrentlyOn(TID_IO));
+
+    if (!this->m_contents || bytes_to_skip > this->m_remaining) {
+        bytes_skipped = ERR_FAILED;
+        return false;
+    }
+
+    this->m_contents->seekg (bytes_to_skip, std::ios::cur);
+    this->m_remaining -= bytes_to_skip;
+    bytes_skipped = bytes_to_skip;
+
+    return true;
+}
+
 bool WPSchemeHandler::Read(void* data_out, int bytes_to_read, int& bytes_read,
                              CefRefPtr<CefResourceReadCallback> callback) {
     DCHECK(!CefCurrentlyOn(TID_UI) && !CefCurrentlyOn(TID_IO));
 
     bytes_read = 0;
 
-    if (this->m_contents->eof ()) {
+    if (!this->m_contents || this->m_remaining <= 0 || this->m_contents->eof ()) {
         return false;
     }
 
     try {
-        this->m_contents->read (static_cast<std::istream::char_type*> (data_out), bytes_to_read);
+        this->m_contents->read (
+            static_cast<std::istream::char_type*> (data_out),
+            std::min<int64_t> (bytes_to_read, this->m_remaining));
     } catch (std::ios::failure&) {
         bytes_read = -1;
         return false;
     }
 
     bytes_read = this->m_contents->gcount ();
+    this->m_remaining -= bytes_read;
 
-    return true;
-}
\ No newline at end of file
+    return bytes_read > 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 #include "WallpaperEngine/Assets/AssetLocator.h"
@@ -18,6 +19,9 @@ using namespace WallpaperEngine::Data::Model;
 
 /**
  * wp{id}:// actual handler called by cef to access files
+ *
+ * Files are streamed out of the background's mappings as Chromium reads them, and single byte ranges are served
+ * so media elements can seek without reading everything before the position
  */
 class WPSchemeHandler : public CefResourceHandler {
   public:
@@ -33,15 +37,35 @@ class WPSchemeHandler : public CefResourceHandler {
 
     void Cancel() override;
 
+    bool Skip(int64_t bytes_to_skip, int64_t& bytes_skipped,
+               CefRefPtr<CefResourceSkipCallback> callback) override;
+
     bool Read(void* data_out, int bytes_to_read, int& bytes_read,
                CefRefPtr<CefResourceReadCallback> callback) override;
 
   private:
+    /**
+     * Parses a "bytes=" Range header against the file's size
+     *
+     * @return If a satisfiable range was requested, m_rangeStart and m_remaining are updated if so
+     */
+    bool parseRange (const std::string& header);
+
     const Project& m_project;
 
     const AssetLocator& m_assetLoader;
     ReadStreamSharedPtr m_contents = nullptr;
     std::string m_mimeType;
+    /** Size of the whole file */
+    int64_t m_size = 0;
+    /** First byte served, not 0 only for range requests */
+    int64_t m_rangeStart = 0;
+    /** Bytes left to serve */
+    int64_t m_remaining = 0;
+    /** If a Range header was sent, the response is a 206 or a 416 then */
+    bool m_rangeRequested = false;
+    /** If the requested range is outside the file */
+    bool m_rangeInvalid = false;
 
 
     IMPLEMENT_REFCOUNTING(WPSchemeHandler);
@@ -83,6 +83,8 @@ WebBrowserContext::WebBrowserContext (WallpaperEngine::Application::WallpaperApp
     //  CefString(&settings.browser_subprocess_path) = "path/to/client"
     cef_string_utf8_to_utf16(cache_path.c_str(), cache_path.length(), &settings.root_cache_path);
     settings.windowless_rendering_enabled = true;
+    // CEF gets a UI thread of its own, so pages keep working (and painting) no matter how long a frame takes
+    settings.multi_threaded_message_loop = true;
 #if defined(CEF_NO_SANDBOX)
     settings.no_sandbox = true;
 #endif
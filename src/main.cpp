@@ -3,7 +3,10 @@
 
 #include "WallpaperEngine/Application/ApplicationContext.h"
 #include "WallpaperEngine/Application/WallpaperApplication.h"
+#include "WallpaperEngine/Debugging/LoadReport.h"
+#include "WallpaperEngine/Debugging/Tracer.h"
 #include "WallpaperEngine/Logging/Log.h"
+#include "WallpaperEngine/Threading/JobPool.h"
 
 WallpaperEngine::Application::WallpaperApplication* app;
 
@@ -40,15 +43,33 @@ int main (int argc, char* argv[]) {
 
         if (enableLogging) {
             initLogging ();
+            // the render thread only queues its lines, writing them is left to the log's own thread
+            sLog.startWriter ();
         }
 
         WallpaperEngine::Application::ApplicationContext appContext (argc, argv);
 
         appContext.loadSettingsFromArgv ();
 
+        // the pool starts its workers on first use, which is while creating the app
+        if (appContext.settings.render.workerPriority == "low")
+            WallpaperEngine::Threading::JobPool::setPriority (WallpaperEngine::Threading::JobPool::Priority_Low);
+        else if (appContext.settings.render.workerPriority == "idle")
+            WallpaperEngine::Threading::JobPool::setPriority (WallpaperEngine::Threading::JobPool::Priority_Idle);
+
+        // loading starts with the app, so the counting has to start before it
+        if (appContext.settings.general.loadReport)
+            sLoadReport.enable ();
+
+#if TRACING
+        // started before the app so loading the backgrounds shows up too
+        if (!appContext.settings.general.trace.empty ())
+            sTracer.start (appContext.settings.general.trace);
+#endif /* TRACING */
+
         app = new WallpaperEngine::Application::WallpaperApplication (appContext);
 
-        // halt if the list-properties option was specified
+        // halt if the list-properties option was specified, everything was printed while loading without a GL context
         if (appContext.settings.general.onlyListProperties) {
             delete app;
             return 0;
@@ -69,6 +90,8 @@ int main (int argc, char* argv[]) {
 
         delete app;
 
+        sTracer.stop ();
+
         return 0;
     } catch (const std::exception& e) {
         std::cerr << e.what () << std::endl;
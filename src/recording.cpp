@@ -4,11 +4,15 @@
 
 #include "recording.h"
 
+#include <array>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <deque>
 #include <iostream>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -17,6 +21,7 @@ extern "C" {
 #include <libavformat/avformat.h>
 #include <libswscale/swscale.h>
 #include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
 }
 
 const int FPS = 30;
@@ -35,7 +40,151 @@ AVFormatContext *format_context = nullptr;
 AVStream *video_stream = nullptr;
 SwsContext *sws_context = nullptr;
 AVFrame *video_frame = nullptr;
-AVFrame* rgb_frame = nullptr;
+AVPacket *video_packet = nullptr;
+
+// frames read back at the same time, the oldest one is usually done by the time its buffer comes around again
+constexpr size_t READBACK_BUFFERS = 3;
+// frames waiting for the encoder before the render loop has to wait for it, keeps memory in check at 4K
+constexpr size_t QUEUED_FRAMES = 8;
+
+std::array<GLuint, READBACK_BUFFERS> readback_buffers = {};
+std::array<GLsync, READBACK_BUFFERS> readback_fences = {};
+size_t readback_index = 0;
+size_t frame_size = 0;
+
+// frames copied out of the pixel pack buffers, the encoder thread takes them from the front of the queue
+std::deque<std::vector<uint8_t>> queued_frames;
+std::vector<std::vector<uint8_t>> free_frames;
+std::mutex queue_mutex;
+std::condition_variable queue_changed;
+bool encoder_stopping = false;
+std::thread encoder_thread;
+
+static int write_packets() {
+    int ret = 0;
+
+    // the encoder keeps a few frames to itself (b-frames, lookahead), there isn't a packet for every frame sent
+    while ((ret = avcodec_receive_packet(video_codec_context, video_packet)) >= 0) {
+        av_packet_rescale_ts(video_packet, video_codec_context->time_base, video_stream->time_base);
+        video_packet->stream_index = video_stream->index;
+
+        ret = av_interleaved_write_frame(format_context, video_packet);
+        av_packet_unref(video_packet);
+
+        if (ret < 0) {
+            std::cerr << "Error writing video packet: " << ret << std::endl;
+            return -1;
+        }
+    }
+
+    if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+        std::cerr << "Error receiving video packet: " << ret << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
+
+static int encode_frame(const uint8_t *rgba_data) {
+    const uint8_t* source[4] = {};
+    int sourceLinesize[4] = {};
+
+    av_image_fill_arrays(
+        const_cast<uint8_t**>(source), sourceLinesize, rgba_data, AV_PIX_FMT_RGBA, SOURCE_WIDTH, SOURCE_HEIGHT, 1);
+
+    // the encoder might still hold on to the last frame
+    if (av_frame_make_writable(video_frame) < 0) {
+        std::cerr << "Error making video frame writable" << std::endl;
+        return -1;
+    }
+
+    sws_scale(sws_context, source, sourceLinesize, 0, SOURCE_HEIGHT, video_frame->data, video_frame->linesize);
+
+    video_frame->pts = frame_count++;
+
+    if (int ret = avcodec_send_frame(video_codec_context, video_frame); ret < 0) {
+        std::cerr << "Error sending video frame: " << ret << std::endl;
+        return -1;
+    }
+
+    return write_packets();
+}
+
+static void run_encoder() {
+    while (true) {
+        std::vector<uint8_t> frame;
+
+        {
+            std::unique_lock lock(queue_mutex);
+
+            queue_changed.wait(lock, [] { return !queued_frames.empty() || encoder_stopping; });
+
+            if (queued_frames.empty())
+                return;
+
+            frame = std::move(queued_frames.front());
+            queued_frames.pop_front();
+        }
+
+        queue_changed.notify_all();
+
+        encode_frame(frame.data());
+
+        std::lock_guard lock(queue_mutex);
+        free_frames.push_back(std::move(frame));
+    }
+}
+
+/**
+ * Maps the pixel pack buffer once its readback is done and queues a copy of it for the encoder
+ */
+static void collect_readback(size_t index) {
+    GLsync& fence = readback_fences[index];
+
+    if (fence == nullptr)
+        return;
+
+    // every frame counts for a recording, so unlike the X11 output this waits instead of dropping it
+    glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(fence);
+    fence = nullptr;
+
+    std::vector<uint8_t> frame;
+
+    {
+        // the encoder fell behind, wait for it to free up some space
+        std::unique_lock lock(queue_mutex);
+
+        queue_changed.wait(lock, [] { return queued_frames.size() < QUEUED_FRAMES; });
+
+        if (!free_frames.empty()) {
+            frame = std::move(free_frames.back());
+            free_frames.pop_back();
+        }
+    }
+
+    frame.resize(frame_size);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_buffers[index]);
+
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame_size, GL_MAP_READ_BIT);
+
+    if (pixels != nullptr) {
+        memcpy(frame.data(), pixels, frame_size);
+    } else {
+        std::cerr << "Error mapping the readback buffer" << std::endl;
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+
+    {
+        std::lock_guard lock(queue_mutex);
+        queued_frames.push_back(std::move(frame));
+    }
+
+    queue_changed.notify_all();
+}
 
 int init_encoder(const char *output_file, int sourceWidth, int sourceHeight) {
     float factor = 512.0f / (float) sourceWidth;
@@ -52,10 +201,10 @@ int init_encoder(const char *output_file, int sourceWidth, int sourceHeight) {
         return -1;
     }
 
-    // Video codec: VP8
+    // Video codec: VP9
     video_codec = avcodec_find_encoder(AV_CODEC_ID_VP9);
     if (!video_codec) {
-        std::cerr << "VP8 codec not found!" << std::endl;
+        std::cerr << "VP9 codec not found!" << std::endl;
         return -1;
     }
 
@@ -75,9 +224,13 @@ int init_encoder(const char *output_file, int sourceWidth, int sourceHeight) {
     video_codec_context->max_b_frames = 1;
     video_codec_context->qmin = 10;
     video_codec_context->qmax = 40;
+    // libvpx only uses more than one core with row based multithreading, cpu-used trades some size for speed
+    video_codec_context->thread_count = 0;
+    av_opt_set(video_codec_context->priv_data, "row-mt", "1", 0);
+    av_opt_set(video_codec_context->priv_data, "cpu-used", "4", 0);
 
     if (avcodec_open2(video_codec_context, video_codec, nullptr) < 0) {
-        std::cerr << "Error opening VP8 codec" << std::endl;
+        std::cerr << "Error opening VP9 codec" << std::endl;
         return -1;
     }
 
@@ -115,79 +268,87 @@ int init_encoder(const char *output_file, int sourceWidth, int sourceHeight) {
     video_frame->height = HEIGHT;
     av_frame_get_buffer(video_frame, 0);
 
-    rgb_frame = av_frame_alloc();
+    video_packet = av_packet_alloc();
 
-    rgb_frame->format = AV_PIX_FMT_RGB24;
-    rgb_frame->width = SOURCE_WIDTH;
-    rgb_frame->height = SOURCE_HEIGHT;
-
-    // Set up YUV conversion context (RGB to YUV)
-    sws_context = sws_getContext(SOURCE_WIDTH, SOURCE_HEIGHT, AV_PIX_FMT_RGB24,
+    // Set up YUV conversion context (RGBA to YUV)
+    sws_context = sws_getContext(SOURCE_WIDTH, SOURCE_HEIGHT, AV_PIX_FMT_RGBA,
                                  WIDTH, HEIGHT, AV_PIX_FMT_YUV420P,
                                  SWS_BICUBIC, nullptr, nullptr, nullptr);
 
-    return 0;
-}
-
-int write_video_frame(const uint8_t *rgb_data) {
-    av_image_fill_arrays(rgb_frame->data, rgb_frame->linesize, rgb_data, AV_PIX_FMT_RGB24, SOURCE_WIDTH, SOURCE_HEIGHT, 1);
+    // RGBA is what drivers can copy without converting on the CPU
+    frame_size = static_cast<size_t>(SOURCE_WIDTH) * SOURCE_HEIGHT * 4;
 
-    sws_scale(sws_context, rgb_frame->data, rgb_frame->linesize, 0, SOURCE_HEIGHT, video_frame->data, video_frame->linesize);
+    glGenBuffers(READBACK_BUFFERS, readback_buffers.data());
 
-    // Send the frame to the encoder
-    int ret = avcodec_send_frame(video_codec_context, video_frame);
-    if (ret < 0) {
-        std::cerr << "Error sending video frame: " << ret << std::endl;
-        return -1;
+    for (const GLuint buffer : readback_buffers) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frame_size, nullptr, GL_STREAM_READ);
     }
 
-    AVPacket packet;
-    av_init_packet(&packet);
-    packet.data = nullptr;
-    packet.size = 0;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
 
-    // Receive the encoded packet from the encoder
-    ret = avcodec_receive_packet(video_codec_context, &packet);
-    if (ret < 0) {
-        std::cerr << "Error receiving video packet: " << ret << std::endl;
-        return -1;
-    }
+    encoder_stopping = false;
+    encoder_thread = std::thread(run_encoder);
 
-    packet.stream_index = video_stream->index;
-    // Set the PTS and DTS values
-    packet.pts = av_rescale_q(frame_count, video_codec_context->time_base, video_stream->time_base);
-    packet.dts = packet.pts;  // For simplicity, you can set DTS equal to PTS for now
-    packet.duration = av_rescale_q(1, video_codec_context->time_base, video_stream->time_base);
+    return 0;
+}
 
-    // Increment frame counter
-    frame_count++;
-    // Write the encoded video packet to the file
-    ret = av_interleaved_write_frame(format_context, &packet);
-    if (ret < 0) {
-        std::cerr << "Error writing video packet: " << ret << std::endl;
-        return -1;
-    }
+int capture_video_frame(GLuint framebuffer) {
+    // the buffer about to be reused holds the oldest frame still on its way
+    collect_readback(readback_index);
 
-    // Ensure that the packet is freed
-    av_packet_unref(&packet);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_buffers[readback_index]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    // with a pack buffer bound this only queues the copy, nothing waits for the frame to finish rendering
+    glReadPixels(0, 0, SOURCE_WIDTH, SOURCE_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+
+    readback_fences[readback_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback_index = (readback_index + 1) % READBACK_BUFFERS;
 
     return 0;
 }
 
 int close_encoder() {
+    // the background stopped before recording started
+    if (video_codec_context == nullptr)
+        return 0;
+
+    // Collect the frames still being read back, oldest first
+    for (size_t i = 0; i < READBACK_BUFFERS; i++)
+        collect_readback((readback_index + i) % READBACK_BUFFERS);
+
+    {
+        std::lock_guard lock(queue_mutex);
+        encoder_stopping = true;
+    }
+
+    queue_changed.notify_all();
+
+    if (encoder_thread.joinable())
+        encoder_thread.join();
+
     // Write any remaining frames (flush encoder)
-    avcodec_flush_buffers(video_codec_context);
+    avcodec_send_frame(video_codec_context, nullptr);
+    write_packets();
 
     // Write the trailer
     av_write_trailer(format_context);
 
     // Clean up
+    glDeleteBuffers(READBACK_BUFFERS, readback_buffers.data());
+    avio_closep(&format_context->pb);
     avcodec_free_context(&video_codec_context);
     avformat_free_context(format_context);
     av_frame_free(&video_frame);
+    av_packet_free(&video_packet);
     sws_freeContext(sws_context);
 
+    queued_frames.clear();
+    free_frames.clear();
+
     return 0;
 }
 
-#endif /* DEMOMODE */
\ No newline at end of file
+#endif /* DEMOMODE */
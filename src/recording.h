@@ -6,11 +6,20 @@
 #include <cstdlib>
 #include <vector>
 
+#include <GL/glew.h>
+
 extern const int FPS;
 extern const int FRAME_COUNT;
 
 int init_encoder(const char *output_file, int sourceWidth, int sourceHeight);
-int write_video_frame(const uint8_t *rgb_data);
+/**
+ * Starts reading the framebuffer back into a pixel pack buffer, frames read back earlier are handed to the
+ * encoder thread as they finish so neither the readback nor the encoding stall the render loop
+ */
+int capture_video_frame(GLuint framebuffer);
+/**
+ * Waits for every frame still being read back or encoded and writes the end of the file
+ */
 int close_encoder();
 
-#endif /* DEMOMODE */
\ No newline at end of file
+#endif /* DEMOMODE */
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+Runs every background in a folder of workshop items through --benchmark and compares the results against a baseline
+from an earlier run, flagging the backgrounds that got slower by more than the threshold.
+
+Usually run through the benchmarks target: cmake --build build --target benchmarks
+"""
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+# metric name -> how to get it from the results, all of them are lower is better
+METRICS = {
+    "load ms": lambda r: r["loadMs"],
+    "shader ms": lambda r: r["shaderMs"],
+    "texture MB": lambda r: r["textureMB"],
+    "cpu p50": lambda r: r["cpuMs"]["p50"],
+    "cpu p99": lambda r: r["cpuMs"]["p99"],
+    "gpu p50": lambda r: r["gpuMs"]["p50"] if r["gpuMs"] else None,
+    "gpu p99": lambda r: r["gpuMs"]["p99"] if r["gpuMs"] else None,
+}
+
+# differences under these are noise no matter the percentage, a 0.1ms frame going to 0.2ms isn't a regression
+MINIMUM_DIFFERENCE = {
+    "load ms": 50.0,
+    "shader ms": 20.0,
+    "texture MB": 1.0,
+}
+MINIMUM_FRAME_DIFFERENCE = 0.25
+
+
+def run(binary, background, frames, timeout):
+    try:
+        process = subprocess.run(
+            [binary, "--silent", "--benchmark", str(frames), background],
+            stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True, timeout=timeout,
+        )
+    except subprocess.TimeoutExpired:
+        return None
+
+    # the results are the only line that's a JSON object
+    for line in reversed(process.stdout.splitlines()):
+        if line.startswith("{\"frames\""):
+            return json.loads(line)
+
+    return None
+
+
+def is_regression(metric, old, new, threshold):
+    if old is None or new is None:
+        return False
+
+    if new - old < MINIMUM_DIFFERENCE.get(metric, MINIMUM_FRAME_DIFFERENCE):
+        return False
+
+    return new > old * (1.0 + threshold / 100.0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--binary", required=True, help="linux-wallpaperengine executable to run")
+    parser.add_argument("--corpus", required=True, help="folder with one workshop item per subfolder")
+    parser.add_argument("--baseline", required=True, help="results to compare against, written if it doesn't exist")
+    parser.add_argument("--output", help="where to write the results of this run")
+    parser.add_argument("--frames", type=int, default=600, help="frames to render per background")
+    parser.add_argument("--threshold", type=float, default=10.0, help="percent a metric can grow before it's flagged")
+    parser.add_argument("--timeout", type=float, default=300.0, help="seconds a background can take before it's skipped")
+    parser.add_argument("--update-baseline", action="store_true", help="replace the baseline with this run")
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.corpus):
+        sys.exit(f"The corpus folder {args.corpus} doesn't exist, set BENCHMARK_CORPUS to a folder of workshop items")
+
+    backgrounds = sorted(
+        entry for entry in os.listdir(args.corpus)
+        if os.path.isfile(os.path.join(args.corpus, entry, "project.json"))
+    )
+    results = {}
+
+    for index, background in enumerate(backgrounds, 1):
+        print(f"[{index}/{len(backgrounds)}] {background}", flush=True)
+        result = run(args.binary, os.path.join(args.corpus, background), args.frames, args.timeout)
+
+        if result is None:
+            print("  failed or timed out, skipping", flush=True)
+            continue
+
+        results[background] = result
+
+    if args.output:
+        os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+
+        with open(args.output, "w") as file:
+            json.dump(results, file, indent=2)
+
+    baseline = None
+
+    if os.path.isfile(args.baseline) and not args.update_baseline:
+        with open(args.baseline) as file:
+            baseline = json.load(file)
+
+    if baseline is None:
+        os.makedirs(os.path.dirname(os.path.abspath(args.baseline)), exist_ok=True)
+
+        with open(args.baseline, "w") as file:
+            json.dump(results, file, indent=2)
+
+        print(f"Stored {len(results)} results as the baseline in {args.baseline}")
+        return 0
+
+    names = list(METRICS)
+    width = max([len(name) for name in backgrounds] + [len("background")])
+    print()
+    print("background".ljust(width) + "".join(f"  {name:>18}" for name in names))
+
+    regressions = []
+
+    for background, result in results.items():
+        old = baseline.get(background)
+        row = background.ljust(width)
+
+        for name in names:
+            new = METRICS[name](result)
+            previous = METRICS[name](old) if old else None
+
+            if new is None:
+                cell = "-"
+            elif previous is None or previous == 0:
+                cell = f"{new:.2f}"
+            else:
+                cell = f"{new:.2f} ({(new - previous) / previous * 100.0:+.0f}%)"
+
+                if is_regression(name, previous, new, args.threshold):
+                    cell = "!" + cell
+                    regressions.append((background, name, previous, new))
+
+            row += f"  {cell:>18}"
+
+        print(row)
+
+    print()
+
+    if not regressions:
+        print(f"No regressions over {args.threshold:.0f}% in {len(results)} backgrounds")
+        return 0
+
+    print(f"{len(regressions)} regressions over {args.threshold:.0f}%:")
+
+    for background, name, previous, new in regressions:
+        print(f"  {background} {name}: {previous:.2f} -> {new:.2f}")
+
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
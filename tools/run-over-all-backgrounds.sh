@@ -17,6 +17,11 @@ for folder in ~/.steam/steam/steamapps/workshop/content/431960/*; do
     # run and wait for it to finish
     $1 $bgid 2>&1 | grep -v "Error receiving video packet: " > output/$bgid.log
 
+    # with BENCHMARK=<frames> also time the background, the results are printed as a single JSON line
+    if [ -n "$BENCHMARK" ]; then
+      $1 --benchmark "$BENCHMARK" $bgid 2>/dev/null | grep "^{\"frames\"" > output/$bgid.benchmark.json
+    fi
+
     if [ -f "output.webm" ]; then
       # move output.webm to the output folder with the right name
       mv output.webm output/$bgid.webm